@@ -2,11 +2,13 @@
 #define HEMLOCK_AST_H
 
 #include <stdint.h>  // For int64_t
+#include <stddef.h>  // For size_t
 
 // Forward declarations
 typedef struct Expr Expr;
 typedef struct Stmt Stmt;
 typedef struct Type Type;
+typedef struct LazyBody LazyBody;
 
 // ========== EXPRESSION TYPES ==========
 
@@ -128,7 +130,8 @@ struct Expr {
             Expr **param_defaults;  // Default value expressions (NULL if required)
             int num_params;
             Type *return_type;
-            Stmt *body;
+            Stmt *body;             // NULL while lazy_body is still encoded
+            LazyBody *lazy_body;    // Set by ast_deserialize_lazy (see ast_serialize.h)
         } function;
         struct {
             Expr **elements;
@@ -340,6 +343,39 @@ struct Stmt {
     } as;
 };
 
+// ========== AST ARENA ==========
+
+// Nodes, strings and child arrays of one parse can be carved out of an
+// arena instead of the heap. While an arena is active on the calling thread,
+// the constructors and the parser allocate from it, strings are interned in
+// its symbol table, and expr_free/stmt_free/type_free do nothing: the whole
+// tree goes away with ast_arena_free. With no active arena everything is
+// malloc'd and freed node by node, as before.
+typedef struct AstArena AstArena;
+
+AstArena* ast_arena_new(void);
+void ast_arena_free(AstArena *arena);
+
+// Make arena (or NULL) the active arena of this thread; returns the previous one
+AstArena* ast_arena_use(AstArena *arena);
+
+// Active arena of this thread (NULL in malloc mode)
+AstArena* ast_arena_current(void);
+
+// Allocators used for everything an AST owns
+void* ast_alloc(size_t size);
+void* ast_realloc(void *ptr, size_t old_size, size_t new_size);
+char* ast_strdup(const char *str);
+char* ast_strndup(const char *str, size_t len);
+void ast_free(void *ptr);
+
+// Make room for one more element in a growable child array
+void* ast_array_grow(void *array, int count, int *capacity, size_t elem_size);
+
+// Bytes allocated for a node: the header plus its own union member
+size_t expr_node_size(ExprType type);
+size_t stmt_node_size(StmtType type);
+
 // ========== CONSTRUCTORS ==========
 
 // Expression constructors
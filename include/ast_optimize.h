@@ -0,0 +1,31 @@
+#ifndef HEMLOCK_AST_OPTIMIZE_H
+#define HEMLOCK_AST_OPTIMIZE_H
+
+#include "ast.h"
+
+// AST optimization pass
+//
+// Runs on every parsed program before it reaches the interpreter or the C
+// code generator, so both backends see the same tree:
+//   - folds operators on literals with the interpreter's numeric promotion
+//     rules (i32 literals, i64 beyond the i32 range, f64 for floats); a fold
+//     is skipped whenever the result would overflow, divide by zero or come
+//     back as a literal of a different type
+//   - replaces reads of `const` bindings that hold a literal with the literal
+//   - folds string interpolation of literal parts into plain strings
+//   - drops `if`/ternary branches and `while` loops with a literal bool
+//     condition
+//   - replaces `Enum.VARIANT` with the variant's i32 value
+//
+// Rewritten nodes come from the active AST arena (see ast.h) and replaced
+// nodes are freed when there is none. Declarations are always kept, so
+// exports, const assignment errors and enum type checks behave as before.
+
+// Optimize a program in place. Does nothing while the pass is disabled.
+void ast_optimize(Stmt **statements, int count);
+
+// Enable or disable the pass for this process (enabled by default)
+void ast_optimize_set_enabled(int enabled);
+int ast_optimize_enabled(void);
+
+#endif // HEMLOCK_AST_OPTIMIZE_H
@@ -9,7 +9,9 @@
 #define HMLC_MAGIC 0x434C4D48
 
 // Version of the binary format
-#define HMLC_VERSION 1
+// 2: each function body is preceded by its encoded size (u32), so a loader
+//    can leave bodies undecoded until first call. Version 1 files still load.
+#define HMLC_VERSION 2
 
 // Flags for compilation options
 #define HMLC_FLAG_DEBUG     0x0001  // Include line numbers
@@ -42,6 +44,9 @@ typedef struct {
     uint16_t flags;          // Compilation flags
 } SerializeContext;
 
+// A .hmlc image loaded with ast_deserialize_lazy
+typedef struct HmlcImage HmlcImage;
+
 // Deserialization context
 typedef struct {
     const uint8_t *data;     // Input data
@@ -50,6 +55,8 @@ typedef struct {
     char **strings;          // Reconstructed string table
     uint32_t string_count;   // Number of strings
     uint16_t flags;          // Flags from header
+    uint16_t version;        // Format version from header
+    HmlcImage *image;        // Set when function bodies are left encoded
 } DeserializeContext;
 
 // ========== PUBLIC API ==========
@@ -77,6 +84,58 @@ uint8_t* ast_serialize(Stmt **statements, int stmt_count, uint16_t flags, size_t
  */
 Stmt** ast_deserialize(const uint8_t *data, size_t data_size, int *out_count);
 
+/**
+ * Deserialize binary data to AST without reporting errors
+ *
+ * Validates the header, checksum and lengths; used where bad data is
+ * expected and handled, such as the module cache.
+ *
+ * @param data       Binary data buffer
+ * @param data_size  Size of data buffer
+ * @param out_count  Output: number of statements
+ * @param error      Output: reason for failure when NULL is returned
+ * @return           Array of statement pointers (caller must free)
+ *                   Returns NULL on error
+ */
+Stmt** ast_try_deserialize(const uint8_t *data, size_t data_size, int *out_count,
+                           const char **error);
+
+/**
+ * Deserialize binary data to AST, leaving function bodies encoded
+ *
+ * Only top-level code and function signatures are decoded. Each function
+ * body stays in the data until lazy_body_load is first called for it, so a
+ * large program starts without decoding code it never runs. Version 1 data
+ * has no body sizes and is decoded eagerly.
+ *
+ * Call with the AST's arena active (ast_arena_use); bodies decoded later
+ * are allocated from the same arena. The data, the image and the arena
+ * must all outlive the returned AST.
+ *
+ * @param data       Binary data buffer (borrowed, typically a mapping)
+ * @param data_size  Size of data buffer
+ * @param out_count  Output: number of statements
+ * @param image      Output: image to free with hmlc_image_free after use
+ * @return           Array of statement pointers, NULL on error
+ */
+Stmt** ast_deserialize_lazy(const uint8_t *data, size_t data_size, int *out_count,
+                            HmlcImage **image);
+
+/**
+ * Decode a function body left encoded by ast_deserialize_lazy
+ *
+ * Safe to call from several threads; the body is decoded once.
+ *
+ * @param lazy       Expr function's lazy_body
+ * @return           The body, or NULL if its encoding is invalid
+ */
+Stmt* lazy_body_load(LazyBody *lazy);
+
+/**
+ * Free an image returned by ast_deserialize_lazy (not the data or arena)
+ */
+void hmlc_image_free(HmlcImage *image);
+
 /**
  * Serialize AST to a file
  *
@@ -0,0 +1,28 @@
+#ifndef HEMLOCK_CACHE_DIR_H
+#define HEMLOCK_CACHE_DIR_H
+
+#include <stddef.h>
+
+// Per-user cache locations shared by the interpreter, hemlockc and the LSP
+//
+// Every cache lives in its own directory under $XDG_CACHE_HOME/hemlock (or
+// ~/.cache/hemlock). XDG says relative paths are invalid, so a relative
+// XDG_CACHE_HOME is ignored. Set HEMLOCK_NO_CACHE=1 to turn every cache off.
+
+#define CACHE_BUILD_ID_LEN 96
+
+// Cache directory for one kind of data (e.g. "modules"), malloc'd, or NULL
+// when caching is off or there is no absolute cache root. The directory is
+// not created.
+char* cache_dir_path(const char *kind);
+
+// Identity of the running binary: the version plus the size and mtime of
+// /proc/self/exe (the build date where that isn't available), so a rebuilt
+// binary never reads entries an older one wrote. out holds
+// CACHE_BUILD_ID_LEN bytes.
+void cache_build_id(char *out);
+
+// Create a directory and its parents. Returns 1 on success.
+int cache_make_dirs(const char *dir);
+
+#endif // HEMLOCK_CACHE_DIR_H
@@ -0,0 +1,28 @@
+#ifndef HEMLOCK_FNV1A_H
+#define HEMLOCK_FNV1A_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// FNV-1a, 64-bit
+//
+// The one byte hash behind hemlock's in-memory tables and on-disk cache
+// keys, so keys computed by the interpreter, hemlockc, the bundler and the
+// LSP can't diverge. Start with HML_FNV1A64_OFFSET as the seed, or pass a
+// previous result to continue hashing more bytes. Tables that want 32 bits
+// use the low half.
+
+#define HML_FNV1A64_OFFSET 0xcbf29ce484222325ULL
+#define HML_FNV1A64_PRIME  0x100000001b3ULL
+
+static inline uint64_t hml_fnv1a64(const void *data, size_t len, uint64_t seed) {
+    const unsigned char *p = (const unsigned char *)data;
+    uint64_t h = seed;
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= HML_FNV1A64_PRIME;
+    }
+    return h;
+}
+
+#endif // HEMLOCK_FNV1A_H
@@ -105,7 +105,8 @@ typedef struct {
     Expr **param_defaults;  // Default value expressions (NULL for required params)
     int num_params;
     Type *return_type;
-    Stmt *body;
+    Stmt *body;                // NULL until lazy_body is decoded (use function_body)
+    LazyBody *lazy_body;       // Body still encoded in a .hmlc image
     Environment *closure_env;  // CAPTURED ENVIRONMENT
     int ref_count;             // Reference count for memory management
 } Function;
@@ -153,6 +154,7 @@ typedef struct {
     int sender_waiting;         // Flag: sender is blocked waiting for receiver
     int receiver_waiting;       // Flag: receiver is blocked waiting for sender
     void *rendezvous;           // pthread_cond_t for rendezvous completion
+    int notify_fd;              // Readiness fd written on send/close (-1 if not watched by an event loop)
 } Channel;
 
 // Forward declare TypeKind from ast.h
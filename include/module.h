@@ -21,19 +21,37 @@ typedef struct Module {
     ModuleState state;           // Current state
     Stmt **statements;           // Parsed AST
     int num_statements;
+    AstArena *arena;             // Owns the AST
     Environment *exports_env;    // Environment containing exported values
     char **export_names;         // List of exported names
     int num_exports;
     int export_capacity;         // Capacity of export_names array
 } Module;
 
+// Hash table slot: absolute path (owned by the value) and the value
+typedef struct {
+    const char *path;
+    void *value;
+} PathSlot;
+
+// Open-addressing hash table keyed by absolute path
+typedef struct {
+    PathSlot *slots;
+    int capacity;                // Power of two
+    int count;
+} PathIndex;
+
+typedef struct ModulePrefetch ModulePrefetch;
+
 // Module cache structure
 typedef struct ModuleCache {
-    Module **modules;            // Array of modules
+    Module **modules;            // Array of modules, in load order
     int count;
     int capacity;
+    PathIndex index;             // absolute_path -> Module
     char *current_dir;           // Current working directory for relative imports
     char *stdlib_path;           // Path to standard library directory
+    ModulePrefetch *prefetch;    // Modules parsed ahead of load_module (or NULL)
 } ModuleCache;
 
 // Public interface
@@ -53,4 +71,18 @@ void execute_module(Module *module, ModuleCache *cache, Environment *global_env,
 // High-level API
 int execute_file_with_modules(const char *file_path, Environment *global_env, int argc, char **argv, ExecutionContext *ctx);
 
+// Run only the beginning of a file (used by snapshots, see snapshot.h)
+typedef struct {
+    // Number of leading top-level statements of the main module to execute,
+    // or -1 to stop without running anything
+    int (*prefix_length)(Module *main_module, void *data);
+    // Called after the prefix has run, while every module's AST is still loaded;
+    // its result is returned by execute_file_prefix
+    int (*finish)(Module *main_module, Environment *main_env, void *data);
+    void *data;
+} ModulePrefixHook;
+
+int execute_file_prefix(const char *file_path, Environment *global_env, const ModulePrefixHook *hook,
+                        ExecutionContext *ctx);
+
 #endif // HEMLOCK_MODULE_H
@@ -0,0 +1,24 @@
+#ifndef HEMLOCK_PARSE_CACHE_H
+#define HEMLOCK_PARSE_CACHE_H
+
+#include "ast.h"
+#include <stddef.h>
+
+// On-disk cache of parsed modules
+//
+// Each module file's AST (the main script and its imports) is kept as a
+// .hmlc blob under $XDG_CACHE_HOME/hemlock/modules (or
+// ~/.cache/hemlock/modules), one entry per absolute path. An entry is used
+// only when the interpreter version and binary, the path and the source size
+// and hash all match; anything else is a miss and the module is parsed as
+// usual. Set HEMLOCK_NO_CACHE=1 to turn the cache off.
+
+// Look up the AST for a module source. Returns NULL on a miss.
+Stmt** parse_cache_load(const char *absolute_path, const char *source, size_t source_len,
+                        int *stmt_count);
+
+// Store the AST for a module source. Failures are ignored.
+void parse_cache_store(const char *absolute_path, const char *source, size_t source_len,
+                       Stmt **statements, int stmt_count);
+
+#endif // HEMLOCK_PARSE_CACHE_H
@@ -11,10 +11,23 @@ typedef struct {
     Token previous;
     int had_error;
     int panic_mode;
+    int quiet;          // Record errors without printing them
+
+    // Called for every reported error (NULL when unused)
+    void (*on_error)(void *data, const Token *token, const char *message);
+    void *on_error_data;
 } Parser;
 
 // Public interface
 void parser_init(Parser *parser, Lexer *lexer);
 Stmt** parse_program(Parser *parser, int *stmt_count);
 
+// Statement-at-a-time parsing, for callers that track where each top-level
+// statement starts and ends (parse_program is a loop over these).
+// parser_synchronize skips to the next statement boundary after an error;
+// parse_statement parses one statement and always consumes at least one
+// token, so a loop over it terminates on malformed input.
+void parser_synchronize(Parser *parser);
+Stmt* parse_statement(Parser *parser);
+
 #endif // HEMLOCK_PARSER_H
\ No newline at end of file
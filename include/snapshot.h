@@ -0,0 +1,46 @@
+#ifndef HEMLOCK_SNAPSHOT_H
+#define HEMLOCK_SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Startup heap snapshots
+//
+// `hemlock --snapshot out.hsnap app.hml` runs app.hml and its imports up to
+// the snapshot point, then writes everything reachable from the main
+// module's environment to out.hsnap: environment chains, strings, buffers,
+// arrays, objects and functions, plus the object and enum type registries.
+// `hemlock out.hsnap` restores that heap and continues with the statements
+// after the snapshot point, skipping module initialization entirely.
+//
+// The snapshot point is the top-level statement `snapshot_point();` in the
+// main file (a no-op in normal runs). Without one, the snapshot is taken
+// after the last top-level import. Statements after the point may not
+// import or export.
+//
+// The image holds no pointers: heap values are numbered and function ASTs
+// (bodies, parameter defaults, object type field defaults) are stored as one
+// .hmlc blob, decoded lazily from the mapping like a .hmlc file. Builtins are
+// stored by name and FFI functions by library and signature, and both are
+// bound again on load; `args` and the builtin constants come from the new
+// process. Values tied to the process (files, sockets, pointers, tasks and
+// channels) cannot be snapshotted.
+
+// Magic number for snapshot images ("HSNP" in little-endian)
+#define SNAPSHOT_MAGIC 0x504E5348
+
+// Run a file up to its snapshot point and write the image.
+// Returns 0 on success; errors are reported on stderr.
+int snapshot_create(const char *file_path, const char *output_path, int argc, char **argv);
+
+// Check whether data starts like a snapshot image
+int is_snapshot_data(const uint8_t *data, size_t size);
+
+// Check whether a file is a snapshot image
+int is_snapshot_file(const char *path);
+
+// Restore an image (borrowed; typically a mapping that outlives the call)
+// and run the rest of the program. Returns 0 on success.
+int snapshot_run(const uint8_t *data, size_t size, int argc, char **argv);
+
+#endif // HEMLOCK_SNAPSHOT_H
@@ -0,0 +1,7 @@
+#ifndef HEMLOCK_VERSION_H
+#define HEMLOCK_VERSION_H
+
+// Interpreter version, shown by --version and part of the module cache key
+#define HEMLOCK_VERSION "1.0.0"
+
+#endif // HEMLOCK_VERSION_H
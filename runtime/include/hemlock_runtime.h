@@ -371,6 +371,8 @@ HmlValue hml_open(HmlValue path, HmlValue mode);
 HmlValue hml_file_read(HmlValue file, HmlValue size);
 HmlValue hml_file_read_all(HmlValue file);
 HmlValue hml_file_write(HmlValue file, HmlValue data);
+HmlValue hml_file_read_bytes(HmlValue file, HmlValue size);
+HmlValue hml_file_write_bytes(HmlValue file, HmlValue data);
 HmlValue hml_file_seek(HmlValue file, HmlValue position);
 HmlValue hml_file_tell(HmlValue file);
 void hml_file_close(HmlValue file);
@@ -455,6 +457,15 @@ HmlValue hml_zlib_compress_bound(HmlValue source_len);
 HmlValue hml_crc32_val(HmlValue data);
 HmlValue hml_adler32_val(HmlValue data);
 
+// Streaming compression (Deflater/Inflater handles)
+HmlValue hml_deflate_new(HmlValue format, HmlValue level);
+HmlValue hml_inflate_new(HmlValue format, HmlValue as_string);
+HmlValue hml_zstream_update(HmlValue stream, HmlValue chunk);
+HmlValue hml_zstream_flush(HmlValue stream);
+HmlValue hml_zstream_finish(HmlValue stream);
+HmlValue hml_zstream_done(HmlValue stream);
+HmlValue hml_zstream_free(HmlValue stream);
+
 // Compression builtin wrappers
 HmlValue hml_builtin_zlib_compress(HmlClosureEnv *env, HmlValue data, HmlValue level);
 HmlValue hml_builtin_zlib_decompress(HmlClosureEnv *env, HmlValue data, HmlValue max_size);
@@ -463,6 +474,163 @@ HmlValue hml_builtin_gzip_decompress(HmlClosureEnv *env, HmlValue data, HmlValue
 HmlValue hml_builtin_zlib_compress_bound(HmlClosureEnv *env, HmlValue source_len);
 HmlValue hml_builtin_crc32(HmlClosureEnv *env, HmlValue data);
 HmlValue hml_builtin_adler32(HmlClosureEnv *env, HmlValue data);
+HmlValue hml_builtin_deflate_new(HmlClosureEnv *env, HmlValue format, HmlValue level);
+HmlValue hml_builtin_inflate_new(HmlClosureEnv *env, HmlValue format, HmlValue as_string);
+HmlValue hml_builtin_zstream_update(HmlClosureEnv *env, HmlValue stream, HmlValue chunk);
+HmlValue hml_builtin_zstream_flush(HmlClosureEnv *env, HmlValue stream);
+HmlValue hml_builtin_zstream_finish(HmlClosureEnv *env, HmlValue stream);
+HmlValue hml_builtin_zstream_done(HmlClosureEnv *env, HmlValue stream);
+HmlValue hml_builtin_zstream_free(HmlClosureEnv *env, HmlValue stream);
+
+// ========== HASH OPERATIONS ==========
+
+// Incremental hashers (@stdlib/hash)
+HmlValue hml_hasher_new(HmlValue algorithm, HmlValue seed);
+HmlValue hml_hasher_update(HmlValue hasher, HmlValue data);
+HmlValue hml_hasher_update_file(HmlValue hasher, HmlValue path);
+HmlValue hml_hasher_digest(HmlValue hasher);
+HmlValue hml_hasher_hex_digest(HmlValue hasher);
+HmlValue hml_hasher_value(HmlValue hasher);
+HmlValue hml_hasher_reset(HmlValue hasher);
+HmlValue hml_hasher_free(HmlValue hasher);
+
+// Hasher builtin wrappers
+HmlValue hml_builtin_hasher_new(HmlClosureEnv *env, HmlValue algorithm, HmlValue seed);
+HmlValue hml_builtin_hasher_update(HmlClosureEnv *env, HmlValue hasher, HmlValue data);
+HmlValue hml_builtin_hasher_update_file(HmlClosureEnv *env, HmlValue hasher, HmlValue path);
+HmlValue hml_builtin_hasher_digest(HmlClosureEnv *env, HmlValue hasher);
+HmlValue hml_builtin_hasher_hex_digest(HmlClosureEnv *env, HmlValue hasher);
+HmlValue hml_builtin_hasher_value(HmlClosureEnv *env, HmlValue hasher);
+HmlValue hml_builtin_hasher_reset(HmlClosureEnv *env, HmlValue hasher);
+HmlValue hml_builtin_hasher_free(HmlClosureEnv *env, HmlValue hasher);
+
+// ========== REGEX OPERATIONS ==========
+
+// Native regex engine (@stdlib/regex); re is a handle or a pattern string
+HmlValue hml_regex_new(HmlValue pattern, HmlValue flags);
+HmlValue hml_regex_free(HmlValue handle);
+HmlValue hml_regex_test(HmlValue re, HmlValue flags, HmlValue text);
+HmlValue hml_regex_find(HmlValue re, HmlValue flags, HmlValue text, HmlValue start);
+HmlValue hml_regex_find_all(HmlValue re, HmlValue flags, HmlValue text, HmlValue limit);
+HmlValue hml_regex_captures(HmlValue re, HmlValue flags, HmlValue text, HmlValue start);
+HmlValue hml_regex_replace(HmlValue re, HmlValue flags, HmlValue text, HmlValue replacement, HmlValue limit);
+HmlValue hml_regex_split(HmlValue re, HmlValue flags, HmlValue text, HmlValue limit);
+
+// Regex builtin wrappers
+HmlValue hml_builtin_regex_new(HmlClosureEnv *env, HmlValue pattern, HmlValue flags);
+HmlValue hml_builtin_regex_free(HmlClosureEnv *env, HmlValue handle);
+HmlValue hml_builtin_regex_test(HmlClosureEnv *env, HmlValue re, HmlValue flags, HmlValue text);
+HmlValue hml_builtin_regex_find(HmlClosureEnv *env, HmlValue re, HmlValue flags, HmlValue text, HmlValue start);
+HmlValue hml_builtin_regex_find_all(HmlClosureEnv *env, HmlValue re, HmlValue flags, HmlValue text, HmlValue limit);
+HmlValue hml_builtin_regex_captures(HmlClosureEnv *env, HmlValue re, HmlValue flags, HmlValue text, HmlValue start);
+HmlValue hml_builtin_regex_replace(HmlClosureEnv *env, HmlValue re, HmlValue flags, HmlValue text,
+                                   HmlValue replacement, HmlValue limit);
+HmlValue hml_builtin_regex_split(HmlClosureEnv *env, HmlValue re, HmlValue flags, HmlValue text, HmlValue limit);
+
+// ========== HTTP CLIENT OPERATIONS ==========
+
+// Persistent HTTP/1.1 client (@stdlib/http)
+HmlValue hml_http_client_new(HmlValue timeout_ms, HmlValue max_idle, HmlValue verify_tls);
+HmlValue hml_http_client_free(HmlValue client);
+HmlValue hml_http_client_stats(HmlValue client);
+HmlValue hml_http_request(HmlValue client, HmlValue method, HmlValue url, HmlValue headers, HmlValue body);
+HmlValue hml_http_response_status(HmlValue resp);
+HmlValue hml_http_response_headers(HmlValue resp);
+HmlValue hml_http_response_read(HmlValue resp, HmlValue max_bytes);
+HmlValue hml_http_response_body(HmlValue resp);
+HmlValue hml_http_response_close(HmlValue resp);
+
+// HTTP client builtin wrappers
+HmlValue hml_builtin_http_client_new(HmlClosureEnv *env, HmlValue timeout_ms, HmlValue max_idle, HmlValue verify_tls);
+HmlValue hml_builtin_http_client_free(HmlClosureEnv *env, HmlValue client);
+HmlValue hml_builtin_http_client_stats(HmlClosureEnv *env, HmlValue client);
+HmlValue hml_builtin_http_request(HmlClosureEnv *env, HmlValue client, HmlValue method, HmlValue url,
+                                  HmlValue headers, HmlValue body);
+HmlValue hml_builtin_http_response_status(HmlClosureEnv *env, HmlValue resp);
+HmlValue hml_builtin_http_response_headers(HmlClosureEnv *env, HmlValue resp);
+HmlValue hml_builtin_http_response_read(HmlClosureEnv *env, HmlValue resp, HmlValue max_bytes);
+HmlValue hml_builtin_http_response_body(HmlClosureEnv *env, HmlValue resp);
+HmlValue hml_builtin_http_response_close(HmlClosureEnv *env, HmlValue resp);
+
+// ========== HTTP SERVER OPERATIONS ==========
+
+// Native HTTP/1.1 server (@stdlib/http HttpServer)
+HmlValue hml_http_server_new(HmlValue host, HmlValue port, HmlValue handler, HmlValue config);
+HmlValue hml_http_server_port(HmlValue server);
+HmlValue hml_http_server_stats(HmlValue server);
+HmlValue hml_http_server_close(HmlValue server);
+
+// HTTP server builtin wrappers
+HmlValue hml_builtin_http_server_new(HmlClosureEnv *env, HmlValue host, HmlValue port, HmlValue handler, HmlValue config);
+HmlValue hml_builtin_http_server_port(HmlClosureEnv *env, HmlValue server);
+HmlValue hml_builtin_http_server_stats(HmlClosureEnv *env, HmlValue server);
+HmlValue hml_builtin_http_server_close(HmlClosureEnv *env, HmlValue server);
+
+// ========== LOG SINK OPERATIONS ==========
+
+// Buffered log output (@stdlib/logging)
+HmlValue hml_log_sink_open(HmlValue target, HmlValue config);
+HmlValue hml_log_sink_write(HmlValue sink, HmlValue line);
+HmlValue hml_log_sink_flush(HmlValue sink);
+HmlValue hml_log_sink_stats(HmlValue sink);
+HmlValue hml_log_sink_close(HmlValue sink);
+HmlValue hml_log_timestamp(void);
+HmlValue hml_log_json(HmlValue time, HmlValue level, HmlValue message, HmlValue data);
+
+// Log sink builtin wrappers
+HmlValue hml_builtin_log_sink_open(HmlClosureEnv *env, HmlValue target, HmlValue config);
+HmlValue hml_builtin_log_sink_write(HmlClosureEnv *env, HmlValue sink, HmlValue line);
+HmlValue hml_builtin_log_sink_flush(HmlClosureEnv *env, HmlValue sink);
+HmlValue hml_builtin_log_sink_stats(HmlClosureEnv *env, HmlValue sink);
+HmlValue hml_builtin_log_sink_close(HmlClosureEnv *env, HmlValue sink);
+HmlValue hml_builtin_log_timestamp(HmlClosureEnv *env);
+HmlValue hml_builtin_log_json(HmlClosureEnv *env, HmlValue time, HmlValue level, HmlValue message, HmlValue data);
+
+// ========== SUBPROCESS OPERATIONS ==========
+
+// Streaming child processes (@stdlib/process Process)
+HmlValue hml_process_spawn(HmlValue argv, HmlValue options);
+HmlValue hml_process_pid(HmlValue proc);
+HmlValue hml_process_read(HmlValue proc, HmlValue stream, HmlValue max_bytes, HmlValue timeout_ms);
+HmlValue hml_process_read_line(HmlValue proc, HmlValue stream);
+HmlValue hml_process_write(HmlValue proc, HmlValue data);
+HmlValue hml_process_close_stdin(HmlValue proc);
+HmlValue hml_process_poll(HmlValue procs, HmlValue timeout_ms);
+HmlValue hml_process_wait(HmlValue proc, HmlValue timeout_ms);
+HmlValue hml_process_kill(HmlValue proc, HmlValue signal);
+HmlValue hml_process_communicate(HmlValue proc, HmlValue input);
+HmlValue hml_process_close(HmlValue proc);
+
+// Subprocess builtin wrappers
+HmlValue hml_builtin_process_spawn(HmlClosureEnv *env, HmlValue argv, HmlValue options);
+HmlValue hml_builtin_process_pid(HmlClosureEnv *env, HmlValue proc);
+HmlValue hml_builtin_process_read(HmlClosureEnv *env, HmlValue proc, HmlValue stream,
+                                  HmlValue max_bytes, HmlValue timeout_ms);
+HmlValue hml_builtin_process_read_line(HmlClosureEnv *env, HmlValue proc, HmlValue stream);
+HmlValue hml_builtin_process_write(HmlClosureEnv *env, HmlValue proc, HmlValue data);
+HmlValue hml_builtin_process_close_stdin(HmlClosureEnv *env, HmlValue proc);
+HmlValue hml_builtin_process_poll(HmlClosureEnv *env, HmlValue procs, HmlValue timeout_ms);
+HmlValue hml_builtin_process_wait(HmlClosureEnv *env, HmlValue proc, HmlValue timeout_ms);
+HmlValue hml_builtin_process_kill(HmlClosureEnv *env, HmlValue proc, HmlValue signal);
+HmlValue hml_builtin_process_communicate(HmlClosureEnv *env, HmlValue proc, HmlValue input);
+HmlValue hml_builtin_process_close(HmlClosureEnv *env, HmlValue proc);
+
+// ========== ENCODING OPERATIONS ==========
+
+HmlValue hml_base64_encode(HmlValue data);
+HmlValue hml_base64_decode(HmlValue data);
+HmlValue hml_hex_encode(HmlValue data);
+HmlValue hml_hex_decode(HmlValue data);
+HmlValue hml_url_encode(HmlValue data);
+HmlValue hml_url_decode(HmlValue data);
+
+// Encoding builtin wrappers
+HmlValue hml_builtin_base64_encode(HmlClosureEnv *env, HmlValue data);
+HmlValue hml_builtin_base64_decode(HmlClosureEnv *env, HmlValue data);
+HmlValue hml_builtin_hex_encode(HmlClosureEnv *env, HmlValue data);
+HmlValue hml_builtin_hex_decode(HmlClosureEnv *env, HmlValue data);
+HmlValue hml_builtin_url_encode(HmlClosureEnv *env, HmlValue data);
+HmlValue hml_builtin_url_decode(HmlClosureEnv *env, HmlValue data);
 
 // ========== INTERNAL HELPER OPERATIONS ==========
 
@@ -501,6 +669,7 @@ void hml_socket_close(HmlValue socket_val);
 // Socket I/O
 HmlValue hml_socket_send(HmlValue socket_val, HmlValue data);
 HmlValue hml_socket_recv(HmlValue socket_val, HmlValue size);
+HmlValue hml_socket_send_file(HmlValue socket_val, HmlValue source, HmlValue offset, HmlValue length);
 HmlValue hml_socket_sendto(HmlValue socket_val, HmlValue address, HmlValue port, HmlValue data);
 HmlValue hml_socket_recvfrom(HmlValue socket_val, HmlValue size);
 
@@ -523,6 +692,7 @@ HmlValue hml_builtin_socket_connect(HmlClosureEnv *env, HmlValue socket_val, Hml
 HmlValue hml_builtin_socket_close(HmlClosureEnv *env, HmlValue socket_val);
 HmlValue hml_builtin_socket_send(HmlClosureEnv *env, HmlValue socket_val, HmlValue data);
 HmlValue hml_builtin_socket_recv(HmlClosureEnv *env, HmlValue socket_val, HmlValue size);
+HmlValue hml_builtin_socket_send_file(HmlClosureEnv *env, HmlValue socket_val, HmlValue source, HmlValue offset, HmlValue length);
 HmlValue hml_builtin_socket_sendto(HmlClosureEnv *env, HmlValue socket_val, HmlValue address, HmlValue port, HmlValue data);
 HmlValue hml_builtin_socket_recvfrom(HmlClosureEnv *env, HmlValue socket_val, HmlValue size);
 HmlValue hml_builtin_socket_setsockopt(HmlClosureEnv *env, HmlValue socket_val, HmlValue level, HmlValue option, HmlValue value);
@@ -605,6 +775,11 @@ void* hml_ffi_sym(HmlValue lib, const char *name);
 // types array contains: [return_type, arg1_type, arg2_type, ...]
 HmlValue hml_ffi_call(void *func_ptr, HmlValue *args, int num_args, HmlFFIType *types);
 
+// Argument/return conversions used by direct (prototype-typed) extern fn calls
+void* hml_ffi_arg_ptr(HmlValue val);
+char* hml_ffi_arg_string(HmlValue val);
+HmlValue hml_ffi_ret_string(const char *s);
+
 // ========== FFI CALLBACKS ==========
 
 // Opaque handle for FFI callback
@@ -6,6 +6,7 @@
  */
 
 #include "../include/hemlock_runtime.h"
+#include "../../src/shared/send_file_core.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -3721,11 +3722,66 @@ HmlValue hml_file_write(HmlValue file, HmlValue data) {
     }
 
     const char *str = "";
-    if (data.type == HML_VAL_STRING) {
+    size_t len = 0;
+    if (data.type == HML_VAL_STRING && data.as.as_string) {
         str = data.as.as_string->data;
+        len = (size_t)data.as.as_string->length;
+    }
+
+    size_t bytes_written = fwrite(str, 1, len, (FILE*)fh->fp);
+    return hml_val_i32((int32_t)bytes_written);
+}
+
+// read_bytes(size: i32): buffer - read binary data
+HmlValue hml_file_read_bytes(HmlValue file, HmlValue size) {
+    if (file.type != HML_VAL_FILE) {
+        fprintf(stderr, "Error: read_bytes() expects file object\n");
+        exit(1);
+    }
+
+    HmlFileHandle *fh = file.as.as_file;
+    if (fh->closed) {
+        hml_runtime_error("Cannot read from closed file '%s'", fh->path);
+    }
+    if (!hml_is_integer(size)) {
+        hml_runtime_error("read_bytes() expects 1 integer argument (size)");
+    }
+
+    int32_t read_size = hml_to_i32(size);
+    if (read_size <= 0) {
+        return hml_val_buffer(0);
+    }
+
+    HmlValue result = hml_val_buffer(read_size);
+    size_t bytes_read = fread(result.as.as_buffer->data, 1, read_size, (FILE*)fh->fp);
+    if (ferror((FILE*)fh->fp)) {
+        hml_release(&result);
+        hml_runtime_error("Read error on file '%s': %s", fh->path, strerror(errno));
+    }
+    result.as.as_buffer->length = (int)bytes_read;
+    return result;
+}
+
+// write_bytes(data: buffer): i32 - write binary data
+HmlValue hml_file_write_bytes(HmlValue file, HmlValue data) {
+    if (file.type != HML_VAL_FILE) {
+        fprintf(stderr, "Error: write_bytes() expects file object\n");
+        exit(1);
+    }
+
+    HmlFileHandle *fh = file.as.as_file;
+    if (fh->closed) {
+        hml_runtime_error("Cannot write to closed file '%s'", fh->path);
+    }
+    if (data.type != HML_VAL_BUFFER || !data.as.as_buffer) {
+        hml_runtime_error("write_bytes() expects buffer argument");
     }
 
-    size_t bytes_written = fwrite(str, 1, strlen(str), (FILE*)fh->fp);
+    HmlBuffer *buf = data.as.as_buffer;
+    size_t bytes_written = fwrite(buf->data, 1, buf->length, (FILE*)fh->fp);
+    if (ferror((FILE*)fh->fp)) {
+        hml_runtime_error("Write error on file '%s': %s", fh->path, strerror(errno));
+    }
     return hml_val_i32((int32_t)bytes_written);
 }
 
@@ -5181,6 +5237,80 @@ HmlValue hml_socket_recv(HmlValue socket_val, HmlValue size) {
     return result;
 }
 
+// ========== ZERO-COPY FILE TRANSFER ==========
+
+// socket.send_file(source, offset, length) -> i64 (bytes sent)
+// source is a file, path, or fd; null offset/length mean 0 / rest of file.
+// Pipes are read from their current position, so offset must be 0.
+// Short results on non-blocking sockets report partial progress. The
+// transfer is send_file_fd() from src/shared/send_file_core.c.
+HmlValue hml_socket_send_file(HmlValue socket_val, HmlValue source, HmlValue offset_val, HmlValue length_val) {
+    if (socket_val.type != HML_VAL_SOCKET || !socket_val.as.as_socket) {
+        hml_runtime_error("send_file() expects a socket");
+    }
+    HmlSocket *sock = socket_val.as.as_socket;
+
+    if (sock->closed) {
+        hml_runtime_error("Cannot send on closed socket");
+    }
+
+    int64_t offset = 0;
+    int64_t length = -1;
+    if (offset_val.type != HML_VAL_NULL) {
+        if (!hml_is_integer(offset_val) || hml_to_i64(offset_val) < 0) {
+            hml_runtime_error("send_file() offset must be a non-negative integer");
+        }
+        offset = hml_to_i64(offset_val);
+    }
+    if (length_val.type != HML_VAL_NULL) {
+        if (!hml_is_integer(length_val) || hml_to_i64(length_val) < 0) {
+            hml_runtime_error("send_file() length must be a non-negative integer");
+        }
+        length = hml_to_i64(length_val);
+    }
+
+    int in_fd;
+    int owns_fd = 0;
+    const char *what = "file";
+    if (source.type == HML_VAL_FILE && source.as.as_file) {
+        HmlFileHandle *file = source.as.as_file;
+        if (file->closed) {
+            hml_runtime_error("send_file() source file is closed");
+        }
+        fflush((FILE*)file->fp);  // Make buffered writes visible to the kernel
+        in_fd = fileno((FILE*)file->fp);
+        what = file->path;
+        if ((fcntl(in_fd, F_GETFL) & O_ACCMODE) == O_WRONLY) {
+            // Write-only handle: read the same file through a fresh descriptor
+            in_fd = open(file->path, O_RDONLY | O_CLOEXEC);
+            if (in_fd < 0) {
+                hml_runtime_error("Failed to open '%s': %s", file->path, strerror(errno));
+            }
+            owns_fd = 1;
+        }
+    } else if (source.type == HML_VAL_STRING && source.as.as_string) {
+        what = hml_to_string_ptr(source);
+        in_fd = open(what, O_RDONLY | O_CLOEXEC);
+        if (in_fd < 0) {
+            hml_runtime_error("Failed to open '%s': %s", what, strerror(errno));
+        }
+        owns_fd = 1;
+    } else if (hml_is_integer(source)) {
+        in_fd = hml_to_i32(source);
+    } else {
+        hml_runtime_error("send_file() source must be a file, path, or file descriptor");
+    }
+
+    int err = 0;
+    int64_t sent = send_file_fd(sock->fd, in_fd, offset, length, &err);
+    if (owns_fd) close(in_fd);
+
+    if (sent < 0) {
+        hml_runtime_error("Failed to send file '%s': %s", what, strerror(err));
+    }
+    return hml_val_i64(sent);
+}
+
 // socket.sendto(address, port, data) -> i32
 HmlValue hml_socket_sendto(HmlValue socket_val, HmlValue address, HmlValue port, HmlValue data) {
     if (socket_val.type != HML_VAL_SOCKET || !socket_val.as.as_socket) {
@@ -5545,6 +5675,23 @@ HmlValue hml_ffi_call(void *func_ptr, HmlValue *args, int num_args, HmlFFIType *
     return ret;
 }
 
+// Conversions for direct extern fn calls (same rules as hml_value_to_ffi)
+void* hml_ffi_arg_ptr(HmlValue val) {
+    if (val.type == HML_VAL_PTR) return val.as.as_ptr;
+    if (val.type == HML_VAL_BUFFER) return val.as.as_buffer->data;
+    return NULL;
+}
+
+char* hml_ffi_arg_string(HmlValue val) {
+    if (val.type == HML_VAL_STRING && val.as.as_string) return val.as.as_string->data;
+    return NULL;
+}
+
+HmlValue hml_ffi_ret_string(const char *s) {
+    if (s) return hml_val_string(s);
+    return hml_val_null();
+}
+
 // ========== FFI CALLBACKS ==========
 
 // Structure for FFI callback handle
@@ -5977,7 +6124,7 @@ HmlValue hml_zlib_compress(HmlValue data, HmlValue level_val) {
         hml_runtime_error("zlib_compress() first argument must be string");
     }
 
-    int level = (int)level_val.as.as_i32;
+    int level = hml_to_i32(level_val);
     if (level < -1 || level > 9) {
         hml_runtime_error("zlib_compress() level must be -1 to 9");
     }
@@ -6023,7 +6170,7 @@ HmlValue hml_zlib_decompress(HmlValue data, HmlValue max_size_val) {
         hml_runtime_error("zlib_decompress() first argument must be buffer");
     }
 
-    size_t max_size = (size_t)max_size_val.as.as_i64;
+    size_t max_size = (size_t)hml_to_i64(max_size_val);
     HmlBuffer *buf = data.as.as_buffer;
 
     // Handle empty input
@@ -6067,7 +6214,7 @@ HmlValue hml_gzip_compress(HmlValue data, HmlValue level_val) {
         hml_runtime_error("gzip_compress() first argument must be string");
     }
 
-    int level = (int)level_val.as.as_i32;
+    int level = hml_to_i32(level_val);
     if (level < -1 || level > 9) {
         hml_runtime_error("gzip_compress() level must be -1 to 9");
     }
@@ -6133,7 +6280,7 @@ HmlValue hml_gzip_decompress(HmlValue data, HmlValue max_size_val) {
         hml_runtime_error("gzip_decompress() first argument must be buffer");
     }
 
-    size_t max_size = (size_t)max_size_val.as.as_i64;
+    size_t max_size = (size_t)hml_to_i64(max_size_val);
     HmlBuffer *buf = data.as.as_buffer;
 
     // Handle empty input
@@ -6198,7 +6345,7 @@ HmlValue hml_gzip_decompress(HmlValue data, HmlValue max_size_val) {
 
 // zlib_compress_bound(source_len: i64) -> i64
 HmlValue hml_zlib_compress_bound(HmlValue source_len_val) {
-    uLong source_len = (uLong)source_len_val.as.as_i64;
+    uLong source_len = (uLong)hml_to_i64(source_len_val);
     uLong bound = compressBound(source_len);
     return hml_val_i64((int64_t)bound);
 }
@@ -6229,6 +6376,226 @@ HmlValue hml_adler32_val(HmlValue data) {
     return hml_val_u32((uint32_t)adler);
 }
 
+// ========== STREAMING COMPRESSION ==========
+
+#define HML_ZSTREAM_OUT_CHUNK 16384
+
+typedef struct {
+    z_stream strm;
+    int deflate;        // 1 = Deflater, 0 = Inflater
+    int multi_member;   // Inflater: continue across concatenated gzip members
+    int as_string;      // Inflater: return strings instead of buffers
+    int finished;       // Deflater: finish() called; Inflater: end of stream seen
+    int closed;         // z_stream released
+} HmlZStream;
+
+static int hml_zstream_window_bits(HmlValue format, int allow_auto) {
+    const char *name = hml_to_string_ptr(format);
+    if (!name) return 0;
+    if (strcmp(name, "zlib") == 0) return 15;
+    if (strcmp(name, "gzip") == 0) return 15 + 16;
+    if (strcmp(name, "raw") == 0) return -15;
+    if (allow_auto && strcmp(name, "auto") == 0) return 15 + 32;
+    return 0;
+}
+
+static HmlZStream* hml_zstream_get(HmlValue val, const char *fn_name) {
+    if (val.type != HML_VAL_PTR || !val.as.as_ptr) {
+        hml_runtime_error("%s() expects a compression stream handle", fn_name);
+    }
+    HmlZStream *zs = (HmlZStream *)val.as.as_ptr;
+    if (zs->closed) {
+        hml_runtime_error("%s() called on closed compression stream", fn_name);
+    }
+    return zs;
+}
+
+static HmlValue hml_zstream_output(HmlZStream *zs, const char *out, size_t len) {
+    if (zs->as_string) {
+        char *str = malloc(len + 1);
+        if (!str) {
+            hml_runtime_error("inflate failed: memory allocation failed");
+        }
+        memcpy(str, out, len);
+        str[len] = '\0';
+        return hml_val_string_owned(str, (int)len, (int)len + 1);
+    }
+    HmlValue buf = hml_val_buffer((int)len);
+    if (len > 0) {
+        memcpy(buf.as.as_buffer->data, out, len);
+    }
+    return buf;
+}
+
+// Run the stream over `data` with the given flush mode and return its output
+static HmlValue hml_zstream_pump(HmlZStream *zs, const void *data, size_t len, int flush) {
+    const char *op = zs->deflate ? "deflate" : "inflate";
+    size_t cap = HML_ZSTREAM_OUT_CHUNK;
+    size_t size = 0;
+    char *out = malloc(cap);
+    if (!out) {
+        hml_runtime_error("%s failed: memory allocation failed", op);
+    }
+
+    zs->strm.next_in = (Bytef *)data;
+    zs->strm.avail_in = (uInt)len;
+
+    for (;;) {
+        if (cap - size < HML_ZSTREAM_OUT_CHUNK) {
+            cap *= 2;
+            char *grown = realloc(out, cap);
+            if (!grown) {
+                free(out);
+                hml_runtime_error("%s failed: memory allocation failed", op);
+            }
+            out = grown;
+        }
+        zs->strm.next_out = (Bytef *)(out + size);
+        zs->strm.avail_out = (uInt)(cap - size);
+
+        int ret = zs->deflate ? deflate(&zs->strm, flush) : inflate(&zs->strm, flush);
+        size = cap - zs->strm.avail_out;
+
+        if (ret == Z_STREAM_END) {
+            if (zs->deflate) break;
+            // A gzip file may hold several concatenated members
+            if (zs->multi_member && zs->strm.avail_in > 0) {
+                inflateReset(&zs->strm);
+                continue;
+            }
+            zs->finished = 1;
+            break;
+        }
+        if (ret == Z_BUF_ERROR) {
+            if (zs->strm.avail_out == 0) continue;  // Needs more output space
+            break;                                  // Needs more input
+        }
+        if (ret != Z_OK) {
+            const char *msg = zs->strm.msg ? zs->strm.msg : "corrupted or invalid data";
+            if (ret == Z_NEED_DICT) msg = "preset dictionary required";
+            else if (ret == Z_MEM_ERROR) msg = "memory allocation failed";
+            free(out);
+            hml_runtime_error("%s failed: %s", op, msg);
+        }
+        // Input consumed and output not full: nothing more is pending
+        if (zs->strm.avail_in == 0 && zs->strm.avail_out > 0 && flush != Z_FINISH) break;
+    }
+
+    HmlValue result = hml_zstream_output(zs, out, size);
+    free(out);
+    return result;
+}
+
+// deflate_new(format: string, level: i32) -> ptr
+HmlValue hml_deflate_new(HmlValue format, HmlValue level_val) {
+    int bits = hml_zstream_window_bits(format, 0);
+    if (bits == 0) {
+        hml_runtime_error("deflate_new() format must be \"zlib\", \"gzip\" or \"raw\"");
+    }
+    int level = hml_to_i32(level_val);
+    if (level < -1 || level > 9) {
+        hml_runtime_error("deflate_new() level must be -1 to 9");
+    }
+
+    HmlZStream *zs = calloc(1, sizeof(HmlZStream));
+    if (!zs) {
+        hml_runtime_error("deflate_new() memory allocation failed");
+    }
+    zs->deflate = 1;
+    if (deflateInit2(&zs->strm, level, Z_DEFLATED, bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        free(zs);
+        hml_runtime_error("deflate_new() failed to initialize zlib stream");
+    }
+    return hml_val_ptr(zs);
+}
+
+// inflate_new(format: string, as_string: bool) -> ptr
+HmlValue hml_inflate_new(HmlValue format, HmlValue as_string) {
+    int bits = hml_zstream_window_bits(format, 1);
+    if (bits == 0) {
+        hml_runtime_error("inflate_new() format must be \"zlib\", \"gzip\", \"raw\" or \"auto\"");
+    }
+
+    HmlZStream *zs = calloc(1, sizeof(HmlZStream));
+    if (!zs) {
+        hml_runtime_error("inflate_new() memory allocation failed");
+    }
+    zs->multi_member = bits > 15;
+    zs->as_string = hml_to_bool(as_string);
+    if (inflateInit2(&zs->strm, bits) != Z_OK) {
+        free(zs);
+        hml_runtime_error("inflate_new() failed to initialize zlib stream");
+    }
+    return hml_val_ptr(zs);
+}
+
+// zstream_update(stream: ptr, chunk: string | buffer) -> buffer | string
+HmlValue hml_zstream_update(HmlValue stream, HmlValue chunk) {
+    HmlZStream *zs = hml_zstream_get(stream, "zstream_update");
+    if (zs->deflate && zs->finished) {
+        hml_runtime_error("zstream_update() called after finish()");
+    }
+
+    const void *data;
+    size_t len;
+    if (chunk.type == HML_VAL_STRING && chunk.as.as_string) {
+        data = chunk.as.as_string->data;
+        len = chunk.as.as_string->length;
+    } else if (chunk.type == HML_VAL_BUFFER && chunk.as.as_buffer) {
+        data = chunk.as.as_buffer->data;
+        len = chunk.as.as_buffer->length;
+    } else {
+        hml_runtime_error("zstream_update() chunk must be string or buffer");
+    }
+
+    // Data after the end of a compressed stream is ignored
+    if (zs->finished) len = 0;
+
+    return hml_zstream_pump(zs, data, len, Z_NO_FLUSH);
+}
+
+// zstream_flush(stream: ptr) -> buffer
+HmlValue hml_zstream_flush(HmlValue stream) {
+    HmlZStream *zs = hml_zstream_get(stream, "zstream_flush");
+    if (!zs->deflate || zs->finished) {
+        return hml_zstream_output(zs, NULL, 0);
+    }
+    return hml_zstream_pump(zs, NULL, 0, Z_SYNC_FLUSH);
+}
+
+// zstream_finish(stream: ptr) -> buffer | string
+HmlValue hml_zstream_finish(HmlValue stream) {
+    HmlZStream *zs = hml_zstream_get(stream, "zstream_finish");
+    if (!zs->deflate) {
+        if (!zs->finished) {
+            hml_runtime_error("inflate failed: unexpected end of compressed data");
+        }
+        return hml_zstream_output(zs, NULL, 0);
+    }
+    if (zs->finished) {
+        return hml_zstream_output(zs, NULL, 0);
+    }
+    HmlValue result = hml_zstream_pump(zs, NULL, 0, Z_FINISH);
+    zs->finished = 1;
+    return result;
+}
+
+// zstream_done(stream: ptr) -> bool
+HmlValue hml_zstream_done(HmlValue stream) {
+    HmlZStream *zs = hml_zstream_get(stream, "zstream_done");
+    return hml_val_bool(zs->finished);
+}
+
+// zstream_free(stream: ptr) -> null
+HmlValue hml_zstream_free(HmlValue stream) {
+    HmlZStream *zs = hml_zstream_get(stream, "zstream_free");
+    if (zs->deflate) deflateEnd(&zs->strm);
+    else inflateEnd(&zs->strm);
+    // Handles may outlive close(); keep the struct so reuse is detected
+    zs->closed = 1;
+    return hml_val_null();
+}
+
 // Compression builtin wrappers
 HmlValue hml_builtin_zlib_compress(HmlClosureEnv *env, HmlValue data, HmlValue level) {
     (void)env;
@@ -6265,6 +6632,41 @@ HmlValue hml_builtin_adler32(HmlClosureEnv *env, HmlValue data) {
     return hml_adler32_val(data);
 }
 
+HmlValue hml_builtin_deflate_new(HmlClosureEnv *env, HmlValue format, HmlValue level) {
+    (void)env;
+    return hml_deflate_new(format, level);
+}
+
+HmlValue hml_builtin_inflate_new(HmlClosureEnv *env, HmlValue format, HmlValue as_string) {
+    (void)env;
+    return hml_inflate_new(format, as_string);
+}
+
+HmlValue hml_builtin_zstream_update(HmlClosureEnv *env, HmlValue stream, HmlValue chunk) {
+    (void)env;
+    return hml_zstream_update(stream, chunk);
+}
+
+HmlValue hml_builtin_zstream_flush(HmlClosureEnv *env, HmlValue stream) {
+    (void)env;
+    return hml_zstream_flush(stream);
+}
+
+HmlValue hml_builtin_zstream_finish(HmlClosureEnv *env, HmlValue stream) {
+    (void)env;
+    return hml_zstream_finish(stream);
+}
+
+HmlValue hml_builtin_zstream_done(HmlClosureEnv *env, HmlValue stream) {
+    (void)env;
+    return hml_zstream_done(stream);
+}
+
+HmlValue hml_builtin_zstream_free(HmlClosureEnv *env, HmlValue stream) {
+    (void)env;
+    return hml_zstream_free(stream);
+}
+
 #else /* !HML_HAVE_ZLIB */
 
 // Stub implementations when zlib is not available
@@ -6303,6 +6705,41 @@ HmlValue hml_adler32_val(HmlValue data) {
     hml_runtime_error("adler32() not available - zlib not installed");
 }
 
+HmlValue hml_deflate_new(HmlValue format, HmlValue level) {
+    (void)format; (void)level;
+    hml_runtime_error("deflate_new() not available - zlib not installed");
+}
+
+HmlValue hml_inflate_new(HmlValue format, HmlValue as_string) {
+    (void)format; (void)as_string;
+    hml_runtime_error("inflate_new() not available - zlib not installed");
+}
+
+HmlValue hml_zstream_update(HmlValue stream, HmlValue chunk) {
+    (void)stream; (void)chunk;
+    hml_runtime_error("zstream_update() not available - zlib not installed");
+}
+
+HmlValue hml_zstream_flush(HmlValue stream) {
+    (void)stream;
+    hml_runtime_error("zstream_flush() not available - zlib not installed");
+}
+
+HmlValue hml_zstream_finish(HmlValue stream) {
+    (void)stream;
+    hml_runtime_error("zstream_finish() not available - zlib not installed");
+}
+
+HmlValue hml_zstream_done(HmlValue stream) {
+    (void)stream;
+    hml_runtime_error("zstream_done() not available - zlib not installed");
+}
+
+HmlValue hml_zstream_free(HmlValue stream) {
+    (void)stream;
+    hml_runtime_error("zstream_free() not available - zlib not installed");
+}
+
 HmlValue hml_builtin_zlib_compress(HmlClosureEnv *env, HmlValue data, HmlValue level) {
     (void)env;
     return hml_zlib_compress(data, level);
@@ -6338,6 +6775,41 @@ HmlValue hml_builtin_adler32(HmlClosureEnv *env, HmlValue data) {
     return hml_adler32_val(data);
 }
 
+HmlValue hml_builtin_deflate_new(HmlClosureEnv *env, HmlValue format, HmlValue level) {
+    (void)env;
+    return hml_deflate_new(format, level);
+}
+
+HmlValue hml_builtin_inflate_new(HmlClosureEnv *env, HmlValue format, HmlValue as_string) {
+    (void)env;
+    return hml_inflate_new(format, as_string);
+}
+
+HmlValue hml_builtin_zstream_update(HmlClosureEnv *env, HmlValue stream, HmlValue chunk) {
+    (void)env;
+    return hml_zstream_update(stream, chunk);
+}
+
+HmlValue hml_builtin_zstream_flush(HmlClosureEnv *env, HmlValue stream) {
+    (void)env;
+    return hml_zstream_flush(stream);
+}
+
+HmlValue hml_builtin_zstream_finish(HmlClosureEnv *env, HmlValue stream) {
+    (void)env;
+    return hml_zstream_finish(stream);
+}
+
+HmlValue hml_builtin_zstream_done(HmlClosureEnv *env, HmlValue stream) {
+    (void)env;
+    return hml_zstream_done(stream);
+}
+
+HmlValue hml_builtin_zstream_free(HmlClosureEnv *env, HmlValue stream) {
+    (void)env;
+    return hml_zstream_free(stream);
+}
+
 #endif /* HML_HAVE_ZLIB */
 
 // ========== INTERNAL HELPER OPERATIONS ==========
@@ -6516,6 +6988,11 @@ HmlValue hml_builtin_socket_recv(HmlClosureEnv *env, HmlValue socket_val, HmlVal
     return hml_socket_recv(socket_val, size);
 }
 
+HmlValue hml_builtin_socket_send_file(HmlClosureEnv *env, HmlValue socket_val, HmlValue source, HmlValue offset, HmlValue length) {
+    (void)env;
+    return hml_socket_send_file(socket_val, source, offset, length);
+}
+
 HmlValue hml_builtin_socket_sendto(HmlClosureEnv *env, HmlValue socket_val, HmlValue address, HmlValue port, HmlValue data) {
     (void)env;
     return hml_socket_sendto(socket_val, address, port, data);
@@ -0,0 +1,118 @@
+/*
+ * Hemlock Runtime Library - Encoding
+ *
+ * Base64, hex and URL builtins on string/buffer bytes, on top of the shared
+ * core in src/shared/encoding_core.c, which holds the scalar codecs and the
+ * SSSE3/AVX2/SSE2 kernels.
+ */
+
+#include "../include/hemlock_runtime.h"
+#include "../../src/shared/encoding_core.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void hml_encoding_input(HmlValue val, const char *name, const uint8_t **data, size_t *len) {
+    if (val.type == HML_VAL_STRING && val.as.as_string) {
+        *data = (const uint8_t *)val.as.as_string->data;
+        *len = (size_t)val.as.as_string->length;
+    } else if (val.type == HML_VAL_BUFFER && val.as.as_buffer) {
+        *data = (const uint8_t *)val.as.as_buffer->data;
+        *len = (size_t)val.as.as_buffer->length;
+    } else {
+        hml_runtime_error("%s() requires string or buffer argument", name);
+    }
+}
+
+static HmlValue hml_run_encoder(HmlValue input, const char *name,
+                                EncodeFn fn,
+                                size_t (*out_size)(size_t)) {
+    const uint8_t *data = NULL;
+    size_t len = 0;
+    hml_encoding_input(input, name, &data, &len);
+
+    size_t cap = out_size(len) + 1;
+    char *out = malloc(cap);
+    if (!out) {
+        hml_runtime_error("%s() memory allocation failed", name);
+    }
+    long n = fn(data, len, out);
+    out[n] = '\0';
+    return hml_val_string_owned(out, (int)n, (int)cap);
+}
+
+static HmlValue hml_run_decoder(HmlValue input, const char *name,
+                                DecodeFn fn,
+                                size_t (*out_size)(size_t)) {
+    const uint8_t *data = NULL;
+    size_t len = 0;
+    hml_encoding_input(input, name, &data, &len);
+
+    size_t cap = out_size(len) + 1;
+    char *out = malloc(cap);
+    if (!out) {
+        hml_runtime_error("%s() memory allocation failed", name);
+    }
+    const char *err = NULL;
+    long n = fn(data, len, (uint8_t *)out, &err);
+    if (n < 0) {
+        free(out);
+        hml_runtime_error("%s", err);
+    }
+    out[n] = '\0';
+    return hml_val_string_owned(out, (int)n, (int)cap);
+}
+
+HmlValue hml_base64_encode(HmlValue data) {
+    return hml_run_encoder(data, "base64_encode", base64_encode_bytes, base64_encoded_size);
+}
+
+HmlValue hml_base64_decode(HmlValue data) {
+    return hml_run_decoder(data, "base64_decode", base64_decode_bytes, base64_decoded_size);
+}
+
+HmlValue hml_hex_encode(HmlValue data) {
+    return hml_run_encoder(data, "hex_encode", hex_encode_bytes, hex_encoded_size);
+}
+
+HmlValue hml_hex_decode(HmlValue data) {
+    return hml_run_decoder(data, "hex_decode", hex_decode_bytes, hex_decoded_size);
+}
+
+HmlValue hml_url_encode(HmlValue data) {
+    return hml_run_encoder(data, "url_encode", url_encode_bytes, url_encoded_size);
+}
+
+HmlValue hml_url_decode(HmlValue data) {
+    return hml_run_decoder(data, "url_decode", url_decode_bytes, url_decoded_size);
+}
+
+HmlValue hml_builtin_base64_encode(HmlClosureEnv *env, HmlValue data) {
+    (void)env;
+    return hml_base64_encode(data);
+}
+
+HmlValue hml_builtin_base64_decode(HmlClosureEnv *env, HmlValue data) {
+    (void)env;
+    return hml_base64_decode(data);
+}
+
+HmlValue hml_builtin_hex_encode(HmlClosureEnv *env, HmlValue data) {
+    (void)env;
+    return hml_hex_encode(data);
+}
+
+HmlValue hml_builtin_hex_decode(HmlClosureEnv *env, HmlValue data) {
+    (void)env;
+    return hml_hex_decode(data);
+}
+
+HmlValue hml_builtin_url_encode(HmlClosureEnv *env, HmlValue data) {
+    (void)env;
+    return hml_url_encode(data);
+}
+
+HmlValue hml_builtin_url_decode(HmlClosureEnv *env, HmlValue data) {
+    (void)env;
+    return hml_url_decode(data);
+}
@@ -0,0 +1,174 @@
+/*
+ * Hemlock Runtime Library - Incremental Hashers
+ *
+ * Builtins for @stdlib/hash on top of the shared core in
+ * src/shared/hash_core.c, which holds the algorithms (OpenSSL EVP digests,
+ * zlib crc32, murmur3/fnv1a/djb2) and file streaming. update() reads
+ * string/buffer bytes in place, so input size never affects memory use.
+ */
+
+#include "../include/hemlock_runtime.h"
+#include "../../src/shared/hash_core.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static Hasher *hml_hasher_get(HmlValue val, const char *fn_name) {
+    if (val.type != HML_VAL_PTR || !val.as.as_ptr) {
+        hml_runtime_error("%s() expects a hasher handle", fn_name);
+    }
+    Hasher *hs = (Hasher *)val.as.as_ptr;
+    if (hs->closed) {
+        hml_runtime_error("%s() called on closed hasher", fn_name);
+    }
+    return hs;
+}
+
+// Finalize a copy of the state into out; returns the digest length
+static int hml_hasher_finish(Hasher *hs, unsigned char *out) {
+    int len = hasher_finish(hs, out);
+    if (len < 0) {
+        hml_runtime_error("hasher_digest() failed to finalize digest");
+    }
+    return len;
+}
+
+// hasher_new(algorithm: string, seed: i32) -> ptr
+HmlValue hml_hasher_new(HmlValue algorithm, HmlValue seed) {
+    if (algorithm.type != HML_VAL_STRING || !algorithm.as.as_string || !hml_is_numeric(seed)) {
+        hml_runtime_error("hasher_new() expects (string algorithm, integer seed)");
+    }
+    const char *name = algorithm.as.as_string->data;
+    int algo = hasher_algo(name);
+    if (algo < 0) {
+        hml_runtime_error("hasher_new() unknown algorithm '%s'", name);
+    }
+    char err[HASHER_ERR_LEN];
+    Hasher *hs = hasher_new((HasherAlgo)algo, (uint32_t)hml_to_i64(seed), err);
+    if (!hs) {
+        hml_runtime_error("hasher_new() %s", err);
+    }
+    return hml_val_ptr(hs);
+}
+
+// hasher_update(hasher: ptr, data: string | buffer) -> null
+HmlValue hml_hasher_update(HmlValue hasher, HmlValue data) {
+    Hasher *hs = hml_hasher_get(hasher, "hasher_update");
+    if (data.type == HML_VAL_STRING && data.as.as_string) {
+        hasher_feed(hs, data.as.as_string->data, (size_t)data.as.as_string->length);
+    } else if (data.type == HML_VAL_BUFFER && data.as.as_buffer) {
+        hasher_feed(hs, data.as.as_buffer->data, (size_t)data.as.as_buffer->length);
+    } else {
+        hml_runtime_error("hasher_update() data must be string or buffer");
+    }
+    return hml_val_null();
+}
+
+// hasher_update_file(hasher: ptr, path: string) -> i64 bytes read
+HmlValue hml_hasher_update_file(HmlValue hasher, HmlValue path) {
+    Hasher *hs = hml_hasher_get(hasher, "hasher_update_file");
+    if (path.type != HML_VAL_STRING || !path.as.as_string) {
+        hml_runtime_error("hasher_update_file() path must be a string");
+    }
+
+    char err[HASHER_ERR_LEN];
+    int64_t total = hasher_feed_file(hs, path.as.as_string->data, err);
+    if (total < 0) {
+        hml_runtime_error("%s", err);
+    }
+    return hml_val_i64(total);
+}
+
+// hasher_digest(hasher: ptr) -> buffer
+HmlValue hml_hasher_digest(HmlValue hasher) {
+    Hasher *hs = hml_hasher_get(hasher, "hasher_digest");
+    unsigned char md[HASHER_MAX_DIGEST];
+    int len = hml_hasher_finish(hs, md);
+    HmlValue buf = hml_val_buffer(len);
+    memcpy(buf.as.as_buffer->data, md, (size_t)len);
+    return buf;
+}
+
+// hasher_hex_digest(hasher: ptr) -> string
+HmlValue hml_hasher_hex_digest(HmlValue hasher) {
+    Hasher *hs = hml_hasher_get(hasher, "hasher_hex_digest");
+    unsigned char md[HASHER_MAX_DIGEST];
+    int len = hml_hasher_finish(hs, md);
+
+    static const char hex_chars[] = "0123456789abcdef";
+    char *hex = malloc((size_t)len * 2 + 1);
+    if (!hex) {
+        hml_runtime_error("hasher_hex_digest() memory allocation failed");
+    }
+    for (int i = 0; i < len; i++) {
+        hex[i * 2] = hex_chars[md[i] >> 4];
+        hex[i * 2 + 1] = hex_chars[md[i] & 15];
+    }
+    hex[len * 2] = '\0';
+    return hml_val_string_owned(hex, len * 2, len * 2 + 1);
+}
+
+// hasher_value(hasher: ptr) -> u32
+HmlValue hml_hasher_value(HmlValue hasher) {
+    Hasher *hs = hml_hasher_get(hasher, "hasher_value");
+    if (hs->md != NULL) {
+        hml_runtime_error("hasher_value() is only available for 32-bit hashes; use digest()");
+    }
+    return hml_val_u32(hasher_value32(hs));
+}
+
+// hasher_reset(hasher: ptr) -> null
+HmlValue hml_hasher_reset(HmlValue hasher) {
+    Hasher *hs = hml_hasher_get(hasher, "hasher_reset");
+    hasher_reset(hs);
+    return hml_val_null();
+}
+
+// hasher_free(hasher: ptr) -> null
+HmlValue hml_hasher_free(HmlValue hasher) {
+    Hasher *hs = hml_hasher_get(hasher, "hasher_free");
+    // Handles may outlive close(); keep the struct so reuse is detected
+    hasher_close(hs);
+    return hml_val_null();
+}
+
+// Hasher builtin wrappers
+HmlValue hml_builtin_hasher_new(HmlClosureEnv *env, HmlValue algorithm, HmlValue seed) {
+    (void)env;
+    return hml_hasher_new(algorithm, seed);
+}
+
+HmlValue hml_builtin_hasher_update(HmlClosureEnv *env, HmlValue hasher, HmlValue data) {
+    (void)env;
+    return hml_hasher_update(hasher, data);
+}
+
+HmlValue hml_builtin_hasher_update_file(HmlClosureEnv *env, HmlValue hasher, HmlValue path) {
+    (void)env;
+    return hml_hasher_update_file(hasher, path);
+}
+
+HmlValue hml_builtin_hasher_digest(HmlClosureEnv *env, HmlValue hasher) {
+    (void)env;
+    return hml_hasher_digest(hasher);
+}
+
+HmlValue hml_builtin_hasher_hex_digest(HmlClosureEnv *env, HmlValue hasher) {
+    (void)env;
+    return hml_hasher_hex_digest(hasher);
+}
+
+HmlValue hml_builtin_hasher_value(HmlClosureEnv *env, HmlValue hasher) {
+    (void)env;
+    return hml_hasher_value(hasher);
+}
+
+HmlValue hml_builtin_hasher_reset(HmlClosureEnv *env, HmlValue hasher) {
+    (void)env;
+    return hml_hasher_reset(hasher);
+}
+
+HmlValue hml_builtin_hasher_free(HmlClosureEnv *env, HmlValue hasher) {
+    (void)env;
+    return hml_hasher_free(hasher);
+}
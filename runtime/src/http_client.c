@@ -0,0 +1,251 @@
+/*
+ * Hemlock Runtime Library - HTTP Client
+ *
+ * Builtins for the @stdlib/http client on top of the shared core in
+ * src/shared/http_client_core.c, which keeps the connection pool and
+ * speaks HTTP/1.1.
+ */
+
+#include "../include/hemlock_runtime.h"
+#include "../../src/shared/http_client_core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ========== BUILTINS ==========
+
+static HttpClient* http_client_get(HmlValue val, const char *fn_name) {
+    if (val.type != HML_VAL_PTR || !val.as.as_ptr) {
+        hml_runtime_error("%s() expects an HTTP client handle", fn_name);
+    }
+    HttpClient *client = (HttpClient*)val.as.as_ptr;
+    if (http_client_closed(client)) {
+        hml_runtime_error("%s() called on closed HTTP client", fn_name);
+    }
+    return client;
+}
+
+static HttpResponse* http_response_get(HmlValue val, const char *fn_name) {
+    if (val.type != HML_VAL_PTR || !val.as.as_ptr) {
+        hml_runtime_error("%s() expects an HTTP response handle", fn_name);
+    }
+    return (HttpResponse*)val.as.as_ptr;
+}
+
+// http_client_new(timeout_ms, max_idle_per_host, verify_tls) -> ptr
+HmlValue hml_http_client_new(HmlValue timeout_ms, HmlValue max_idle, HmlValue verify_tls) {
+    if (!hml_is_numeric(timeout_ms) || !hml_is_numeric(max_idle) || verify_tls.type != HML_VAL_BOOL) {
+        hml_runtime_error("http_client_new() expects (integer, integer, bool)");
+    }
+    int timeout = hml_to_i32(timeout_ms);
+    int idle = hml_to_i32(max_idle);
+    if (timeout <= 0 || idle < 0) {
+        hml_runtime_error("http_client_new() timeout must be positive and max_idle_per_host non-negative");
+    }
+    HttpClient *client = http_client_create(timeout, idle, verify_tls.as.as_bool);
+    if (!client) {
+        hml_runtime_error("http_client_new() memory allocation failed");
+    }
+    return hml_val_ptr(client);
+}
+
+// http_client_free(client): close the pool and release the client
+HmlValue hml_http_client_free(HmlValue handle) {
+    http_client_close(http_client_get(handle, "http_client_free"));
+    return hml_val_null();
+}
+
+// http_client_stats(client) -> { opened, reused, idle }
+HmlValue hml_http_client_stats(HmlValue handle) {
+    HttpClient *client = http_client_get(handle, "http_client_stats");
+    long opened, reused;
+    int idle;
+    http_client_stats(client, &opened, &reused, &idle);
+
+    HmlValue obj = hml_val_object();
+    hml_object_set_field(obj, "opened", hml_val_i32((int32_t)opened));
+    hml_object_set_field(obj, "reused", hml_val_i32((int32_t)reused));
+    hml_object_set_field(obj, "idle", hml_val_i32(idle));
+    return obj;
+}
+
+// http_request(client, method, url, headers, body) -> response handle
+// headers: null, array of "Name: value" strings, or object of name -> value
+// body: null, string or buffer
+HmlValue hml_http_request(HmlValue handle, HmlValue method, HmlValue url, HmlValue headers, HmlValue body) {
+    HttpClient *client = http_client_get(handle, "http_request");
+    if (method.type != HML_VAL_STRING || !method.as.as_string ||
+        url.type != HML_VAL_STRING || !url.as.as_string) {
+        hml_runtime_error("http_request() method and url must be strings");
+    }
+
+    const char *body_data = NULL;
+    size_t body_len = 0;
+    if (body.type == HML_VAL_STRING && body.as.as_string) {
+        body_data = body.as.as_string->data;
+        body_len = (size_t)body.as.as_string->length;
+    } else if (body.type == HML_VAL_BUFFER && body.as.as_buffer) {
+        body_data = body.as.as_buffer->data;
+        body_len = (size_t)body.as.as_buffer->length;
+    } else if (body.type != HML_VAL_NULL) {
+        hml_runtime_error("http_request() body must be a string, buffer or null");
+    }
+
+    char verb[HTTP_METHOD_MAX];
+    if (http_method_normalize(method.as.as_string->data, verb) != 0) {
+        hml_runtime_error("http_request() invalid method '%s'", method.as.as_string->data);
+    }
+
+    size_t hlen = 0, hcap = 256;
+    char *block = malloc(hcap);
+    block[0] = '\0';
+    int bad = 0;
+    if (headers.type == HML_VAL_ARRAY && headers.as.as_array) {
+        HmlArray *arr = headers.as.as_array;
+        for (int i = 0; i < arr->length && !bad; i++) {
+            HmlValue h = arr->elements[i];
+            if (h.type != HML_VAL_STRING || !h.as.as_string) {
+                bad = 1;
+                break;
+            }
+            bad = http_header_block_append(&block, &hlen, &hcap, h.as.as_string->data,
+                                           (size_t)h.as.as_string->length) != 0;
+        }
+    } else if (headers.type == HML_VAL_OBJECT && headers.as.as_object) {
+        HmlObject *obj = headers.as.as_object;
+        for (int i = 0; i < obj->num_fields && !bad; i++) {
+            HmlValue vs = hml_to_string(obj->field_values[i]);
+            const char *v = vs.as.as_string ? vs.as.as_string->data : "";
+            size_t line_len = strlen(obj->field_names[i]) + 2 + strlen(v);
+            char *line = malloc(line_len + 1);
+            snprintf(line, line_len + 1, "%s: %s", obj->field_names[i], v);
+            bad = http_header_block_append(&block, &hlen, &hcap, line, line_len) != 0;
+            free(line);
+            hml_release(&vs);
+        }
+    } else if (headers.type != HML_VAL_NULL) {
+        bad = 1;
+    }
+    if (bad) {
+        free(block);
+        hml_runtime_error("http_request() headers must be an array of \"Name: value\" strings or an object of single-line values");
+    }
+
+    char err[HTTP_ERR_LEN];
+    HttpResponse *resp = http_client_request(client, verb, url.as.as_string->data, block, body_data, body_len, err);
+    free(block);
+    if (!resp) {
+        hml_runtime_error("HTTP request failed: %s %s: %s", verb, url.as.as_string->data, err);
+    }
+    return hml_val_ptr(resp);
+}
+
+// http_response_status(resp) -> i32
+HmlValue hml_http_response_status(HmlValue handle) {
+    HttpResponse *resp = http_response_get(handle, "http_response_status");
+    return hml_val_i32(http_response_status(resp));
+}
+
+// http_response_headers(resp) -> object of lowercased name -> value
+HmlValue hml_http_response_headers(HmlValue handle) {
+    HttpResponse *resp = http_response_get(handle, "http_response_headers");
+    HmlValue obj = hml_val_object();
+    for (int i = 0; i < http_response_header_count(resp); i++) {
+        HmlValue v = hml_val_string(http_response_header_value(resp, i));
+        hml_object_set_field(obj, http_response_header_name(resp, i), v);
+        hml_release(&v);
+    }
+    return obj;
+}
+
+// http_response_read(resp, max) -> string of up to max body bytes, "" at end
+HmlValue hml_http_response_read(HmlValue handle, HmlValue max_bytes) {
+    HttpResponse *resp = http_response_get(handle, "http_response_read");
+    if (!hml_is_numeric(max_bytes) || hml_to_i32(max_bytes) <= 0) {
+        hml_runtime_error("http_response_read() max_bytes must be positive");
+    }
+    int max = hml_to_i32(max_bytes);
+    if (http_response_finished(resp)) {
+        return hml_val_string("");
+    }
+    char *out = malloc((size_t)max + 1);
+    if (!out) {
+        hml_runtime_error("http_response_read() memory allocation failed");
+    }
+    char err[HTTP_ERR_LEN];
+    ssize_t n = http_response_read(resp, out, (size_t)max, err);
+    if (n < 0) {
+        free(out);
+        hml_runtime_error("HTTP read failed: %s", err);
+    }
+    out[n] = '\0';
+    return hml_val_string_owned(out, (int)n, max + 1);
+}
+
+// http_response_body(resp) -> rest of the body as a string
+HmlValue hml_http_response_body(HmlValue handle) {
+    HttpResponse *resp = http_response_get(handle, "http_response_body");
+    size_t len, cap;
+    char err[HTTP_ERR_LEN];
+    char *out = http_response_read_all(resp, &len, &cap, err);
+    if (!out) {
+        hml_runtime_error("HTTP read failed: %s", err);
+    }
+    return hml_val_string_owned(out, (int)len, (int)cap);
+}
+
+// http_response_close(resp): reuse the connection if the body was read to
+// the end, otherwise close it
+HmlValue hml_http_response_close(HmlValue handle) {
+    HttpResponse *resp = http_response_get(handle, "http_response_close");
+    http_response_close(resp);
+    return hml_val_null();
+}
+
+// ========== BUILTIN WRAPPERS ==========
+
+HmlValue hml_builtin_http_client_new(HmlClosureEnv *env, HmlValue timeout_ms, HmlValue max_idle, HmlValue verify_tls) {
+    (void)env;
+    return hml_http_client_new(timeout_ms, max_idle, verify_tls);
+}
+
+HmlValue hml_builtin_http_client_free(HmlClosureEnv *env, HmlValue client) {
+    (void)env;
+    return hml_http_client_free(client);
+}
+
+HmlValue hml_builtin_http_client_stats(HmlClosureEnv *env, HmlValue client) {
+    (void)env;
+    return hml_http_client_stats(client);
+}
+
+HmlValue hml_builtin_http_request(HmlClosureEnv *env, HmlValue client, HmlValue method, HmlValue url,
+                                  HmlValue headers, HmlValue body) {
+    (void)env;
+    return hml_http_request(client, method, url, headers, body);
+}
+
+HmlValue hml_builtin_http_response_status(HmlClosureEnv *env, HmlValue resp) {
+    (void)env;
+    return hml_http_response_status(resp);
+}
+
+HmlValue hml_builtin_http_response_headers(HmlClosureEnv *env, HmlValue resp) {
+    (void)env;
+    return hml_http_response_headers(resp);
+}
+
+HmlValue hml_builtin_http_response_read(HmlClosureEnv *env, HmlValue resp, HmlValue max_bytes) {
+    (void)env;
+    return hml_http_response_read(resp, max_bytes);
+}
+
+HmlValue hml_builtin_http_response_body(HmlClosureEnv *env, HmlValue resp) {
+    (void)env;
+    return hml_http_response_body(resp);
+}
+
+HmlValue hml_builtin_http_response_close(HmlClosureEnv *env, HmlValue resp) {
+    (void)env;
+    return hml_http_response_close(resp);
+}
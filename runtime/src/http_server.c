@@ -0,0 +1,356 @@
+/*
+ * Hemlock Runtime Library - HTTP Server
+ *
+ * Builtins for the @stdlib/http server on top of the shared core in
+ * src/shared/http_server_core.c, which owns the sockets, parses requests
+ * and frames responses. Workers call back here to turn each request into
+ * an object, call the Hemlock handler and write its result.
+ */
+
+#include "../include/hemlock_runtime.h"
+#include "../../src/shared/http_server_core.h"
+#include <pthread.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HTTPD_HAVE_EPOLL
+
+// ========== HEMLOCK BOUNDARY ==========
+
+// Compiled code keeps its exception handlers on one process-wide stack, so
+// handler calls are serialized; parsing and socket I/O still run in parallel
+static pthread_mutex_t httpd_call_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static HmlValue httpd_string(const char *data, size_t len) {
+    char *copy = malloc(len + 1);
+    if (!copy) {
+        fprintf(stderr, "Runtime error: Memory allocation failed\n");
+        exit(1);
+    }
+    memcpy(copy, data, len);
+    copy[len] = '\0';
+    return hml_val_string_owned(copy, (int)len, (int)len + 1);
+}
+
+// Set a field and drop our reference to the value
+static void httpd_object_add(HmlValue obj, const char *name, HmlValue value) {
+    hml_object_set_field(obj, name, value);
+    hml_release(&value);
+}
+
+static HmlValue* httpd_field(HmlObject *obj, const char *name) {
+    for (int i = 0; i < obj->num_fields; i++) {
+        if (strcmp(obj->field_names[i], name) == 0) {
+            return &obj->field_values[i];
+        }
+    }
+    return NULL;
+}
+
+// { method, target, path, query, version, headers, body }
+static HmlValue httpd_request_value(HttpdConn *c) {
+    HmlValue headers = hml_val_object();
+    int num_headers = httpd_request_header_count(c);
+    for (int i = 0; i < num_headers; i++) {
+        const char *raw_name, *value;
+        size_t name_len, value_len;
+        httpd_request_header(c, i, &raw_name, &name_len, &value, &value_len);
+        char *name = strndup(raw_name, name_len);
+        HmlValue *old = httpd_field(headers.as.as_object, name);
+        if (!old) {
+            httpd_object_add(headers, name, httpd_string(value, value_len));
+            free(name);
+            continue;
+        }
+        // Repeated fields are joined with ", " as in the client
+        HmlString *prev = old->as.as_string;
+        size_t len = (size_t)prev->length + 2 + value_len;
+        char *merged = malloc(len + 1);
+        if (!merged) {
+            fprintf(stderr, "Runtime error: Memory allocation failed\n");
+            exit(1);
+        }
+        memcpy(merged, prev->data, (size_t)prev->length);
+        memcpy(merged + prev->length, ", ", 2);
+        memcpy(merged + prev->length + 2, value, value_len);
+        merged[len] = '\0';
+        httpd_object_add(headers, name, hml_val_string_owned(merged, (int)len, (int)len + 1));
+        free(name);
+    }
+
+    size_t method_len, target_len, body_len;
+    const char *method = httpd_request_method(c, &method_len);
+    const char *target = httpd_request_target(c, &target_len);
+    const char *body = httpd_request_body(c, &body_len);
+    const char *query = memchr(target, '?', target_len);
+    size_t path_len = query ? (size_t)(query - target) : target_len;
+
+    HmlValue req = hml_val_object();
+    httpd_object_add(req, "method", httpd_string(method, method_len));
+    httpd_object_add(req, "target", httpd_string(target, target_len));
+    httpd_object_add(req, "path", httpd_string(target, path_len));
+    httpd_object_add(req, "query", query ? httpd_string(query + 1, target_len - path_len - 1) : httpd_string("", 0));
+    httpd_object_add(req, "version", httpd_string(httpd_request_version(c), 8));
+    httpd_object_add(req, "headers", headers);
+    httpd_object_add(req, "body", httpd_string(body, body_len));
+    return req;
+}
+
+static int httpd_body_bytes(HmlValue body, const char **data, size_t *len, const char **type) {
+    if (body.type == HML_VAL_NULL) {
+        *data = "";
+        *len = 0;
+    } else if (body.type == HML_VAL_STRING) {
+        *data = body.as.as_string->data;
+        *len = (size_t)body.as.as_string->length;
+        *type = "text/plain; charset=utf-8";
+    } else if (body.type == HML_VAL_BUFFER) {
+        *data = (const char*)body.as.as_buffer->data;
+        *len = (size_t)body.as.as_buffer->length;
+        *type = "application/octet-stream";
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+// Write the handler's result: a string or buffer (200), null (204), or an
+// object { status?, headers?, body? }. Returns 0 for anything else.
+static int httpd_render_response(HttpdConn *c, HmlValue result) {
+    int status = 200;
+    const char *body = "";
+    size_t body_len = 0;
+    const char *type = NULL;
+    HmlValue *headers = NULL;
+
+    if (result.type == HML_VAL_NULL) {
+        status = 204;
+    } else if (result.type == HML_VAL_OBJECT) {
+        HmlObject *obj = result.as.as_object;
+        HmlValue *field = httpd_field(obj, "status");
+        if (field && field->type != HML_VAL_NULL) {
+            if (!hml_is_integer(*field)) return 0;
+            int64_t s = hml_to_i64(*field);
+            if (s < 200 || s > 599) return 0;
+            status = (int)s;
+        }
+        field = httpd_field(obj, "body");
+        if (field && !httpd_body_bytes(*field, &body, &body_len, &type)) {
+            return 0;
+        }
+        headers = httpd_field(obj, "headers");
+    } else if (!httpd_body_bytes(result, &body, &body_len, &type)) {
+        return 0;
+    }
+
+    httpd_response_begin(c, status);
+    int ok = 1;
+    if (headers && headers->type == HML_VAL_OBJECT) {
+        HmlObject *h = headers->as.as_object;
+        for (int i = 0; i < h->num_fields && ok; i++) {
+            HmlValue value = hml_to_string(h->field_values[i]);
+            ok = httpd_response_header(c, h->field_names[i], strlen(h->field_names[i]),
+                                       value.as.as_string->data, (size_t)value.as.as_string->length);
+            hml_release(&value);
+        }
+    } else if (headers && headers->type == HML_VAL_ARRAY) {
+        // "Name: value" strings, as the client accepts
+        HmlArray *h = headers->as.as_array;
+        for (int i = 0; i < h->length && ok; i++) {
+            HmlValue line = h->elements[i];
+            ok = line.type == HML_VAL_STRING &&
+                 httpd_response_header_line(c, line.as.as_string->data, (size_t)line.as.as_string->length);
+        }
+    } else if (headers && headers->type != HML_VAL_NULL) {
+        ok = 0;
+    }
+    if (!ok) {
+        httpd_response_cancel(c);
+        return 0;
+    }
+    httpd_response_end(c, body, body_len, type);
+    return 1;
+}
+
+// Call the handler with the request. Returns its result (owned by the
+// caller); *failed is set when it threw.
+static HmlValue httpd_call_handler(HmlValue handler, HmlValue req, int *failed) {
+    HmlValue result = hml_val_null();
+    int num_args = handler.type == HML_VAL_FUNCTION && handler.as.as_function->num_params == 0 ? 0 : 1;
+
+    pthread_mutex_lock(&httpd_call_lock);
+    HmlExceptionContext *ex = hml_exception_push();
+    if (setjmp(ex->exception_buf) == 0) {
+        result = hml_call_function(handler, &req, num_args);
+        *failed = 0;
+    } else {
+        HmlValue msg = hml_to_string(ex->exception_value);
+        fprintf(stderr, "Warning: Exception in HTTP handler: %s\n", msg.as.as_string->data);
+        hml_release(&msg);
+        *failed = 1;
+    }
+    hml_exception_pop();
+    pthread_mutex_unlock(&httpd_call_lock);
+    return result;
+}
+
+// Serve one request on a worker; 0 has the core answer 500
+static int httpd_serve_request(void *data, void *worker, HttpdConn *c) {
+    (void)worker;
+    HmlValue req = httpd_request_value(c);
+    int failed = 0;
+    HmlValue result = httpd_call_handler(*(HmlValue*)data, req, &failed);
+    if (!failed && !httpd_render_response(c, result)) {
+        fprintf(stderr, "Warning: HTTP handler returned an invalid response\n");
+        failed = 1;
+    }
+    hml_release(&result);
+    hml_release(&req);
+    return !failed;
+}
+
+static void httpd_release_handler(void *data) {
+    hml_release((HmlValue*)data);
+    free(data);
+}
+
+static int64_t httpd_config_int(HmlValue config, const char *name, int64_t fallback) {
+    if (config.type != HML_VAL_OBJECT) {
+        return fallback;
+    }
+    HmlValue *field = httpd_field(config.as.as_object, name);
+    if (!field || !hml_is_integer(*field)) {
+        return fallback;
+    }
+    return hml_to_i64(*field);
+}
+
+static HttpServer* http_server_get(HmlValue val, const char *fn_name) {
+    if (val.type != HML_VAL_PTR || !val.as.as_ptr) {
+        hml_runtime_error("%s() expects an HTTP server handle", fn_name);
+    }
+    HttpServer *srv = (HttpServer*)val.as.as_ptr;
+    if (httpd_server_closed(srv)) {
+        hml_runtime_error("%s() called on closed HTTP server", fn_name);
+    }
+    return srv;
+}
+
+#endif  // HTTPD_HAVE_EPOLL
+
+// ========== PUBLIC API ==========
+
+// http_server_new(host, port, handler, config) -> server handle
+// config: { workers, max_body, idle_timeout } (missing fields use defaults)
+HmlValue hml_http_server_new(HmlValue host, HmlValue port_val, HmlValue handler, HmlValue config) {
+    if (host.type != HML_VAL_STRING || !hml_is_integer(port_val) || handler.type != HML_VAL_FUNCTION) {
+        hml_runtime_error("http_server_new() expects 4 arguments (host, port, handler, config)");
+    }
+#ifdef HTTPD_HAVE_EPOLL
+    int64_t port = hml_to_i64(port_val);
+    int64_t workers = httpd_config_int(config, "workers", 4);
+    int64_t max_body = httpd_config_int(config, "max_body", 8 * 1024 * 1024);
+    int64_t idle_timeout = httpd_config_int(config, "idle_timeout", 60);
+    if (port < 0 || port > 65535) {
+        hml_runtime_error("http_server_new() port must be between 0 and 65535");
+    }
+    if (workers < 1 || workers > 1024) {
+        hml_runtime_error("http_server_new() workers must be between 1 and 1024");
+    }
+    if (max_body < 0 || idle_timeout < 0) {
+        hml_runtime_error("http_server_new() max_body and idle_timeout must not be negative");
+    }
+
+    HmlValue *data = malloc(sizeof(HmlValue));
+    if (!data) {
+        hml_runtime_error("http_server_new() memory allocation failed");
+    }
+    *data = handler;
+    hml_retain(data);
+    HttpdHandler hooks = { data, NULL, NULL, httpd_serve_request, httpd_release_handler };
+
+    char err[HTTPD_ERR_LEN];
+    HttpServer *srv = httpd_server_start(host.as.as_string->data, (int)port, (int)workers,
+                                         (size_t)max_body, (int)idle_timeout, &hooks, err);
+    if (!srv) {
+        httpd_release_handler(data);
+        hml_runtime_error("HttpServer: %s", err);
+    }
+    return hml_val_ptr(srv);
+#else
+    (void)config;
+    hml_runtime_error("HttpServer requires epoll (Linux only)");
+    return hml_val_null();
+#endif
+}
+
+// http_server_port(server) -> i32 (the bound port, useful with port 0)
+HmlValue hml_http_server_port(HmlValue server) {
+#ifdef HTTPD_HAVE_EPOLL
+    HttpServer *srv = http_server_get(server, "http_server_port");
+    return hml_val_i32(httpd_server_port(srv));
+#else
+    (void)server;
+    hml_runtime_error("HttpServer requires epoll (Linux only)");
+    return hml_val_null();
+#endif
+}
+
+// http_server_stats(server) -> { connections, active, requests }
+HmlValue hml_http_server_stats(HmlValue server) {
+#ifdef HTTPD_HAVE_EPOLL
+    HttpServer *srv = http_server_get(server, "http_server_stats");
+    long connections, requests;
+    int active;
+    httpd_server_stats(srv, &connections, &active, &requests);
+    HmlValue obj = hml_val_object();
+    httpd_object_add(obj, "connections", hml_val_i64(connections));
+    httpd_object_add(obj, "active", hml_val_i32(active));
+    httpd_object_add(obj, "requests", hml_val_i64(requests));
+    return obj;
+#else
+    (void)server;
+    hml_runtime_error("HttpServer requires epoll (Linux only)");
+    return hml_val_null();
+#endif
+}
+
+// http_server_close(server): stop accepting, finish requests in progress and
+// close every connection
+HmlValue hml_http_server_close(HmlValue server) {
+#ifdef HTTPD_HAVE_EPOLL
+    HttpServer *srv = http_server_get(server, "http_server_close");
+    if (httpd_server_is_current(srv)) {
+        hml_runtime_error("HttpServer cannot be closed from its own handler");
+    }
+    httpd_server_close(srv);
+#else
+    (void)server;
+    hml_runtime_error("HttpServer requires epoll (Linux only)");
+#endif
+    return hml_val_null();
+}
+
+// ========== BUILTIN WRAPPERS ==========
+
+HmlValue hml_builtin_http_server_new(HmlClosureEnv *env, HmlValue host, HmlValue port, HmlValue handler, HmlValue config) {
+    (void)env;
+    return hml_http_server_new(host, port, handler, config);
+}
+
+HmlValue hml_builtin_http_server_port(HmlClosureEnv *env, HmlValue server) {
+    (void)env;
+    return hml_http_server_port(server);
+}
+
+HmlValue hml_builtin_http_server_stats(HmlClosureEnv *env, HmlValue server) {
+    (void)env;
+    return hml_http_server_stats(server);
+}
+
+HmlValue hml_builtin_http_server_close(HmlClosureEnv *env, HmlValue server) {
+    (void)env;
+    return hml_http_server_close(server);
+}
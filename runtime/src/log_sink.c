@@ -0,0 +1,233 @@
+/*
+ * Hemlock Runtime Library - Log Sink
+ *
+ * Builtins for @stdlib/logging on top of the shared core in
+ * src/shared/log_sink_core.c, which owns the line ring and the writer
+ * thread, plus the JSON line formatter.
+ */
+
+#include "../include/hemlock_runtime.h"
+#include "../../src/shared/log_sink_core.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static HmlValue* log_config_field(HmlValue config, const char *name) {
+    if (config.type != HML_VAL_OBJECT) {
+        return NULL;
+    }
+    HmlObject *obj = config.as.as_object;
+    for (int i = 0; i < obj->num_fields; i++) {
+        if (strcmp(obj->field_names[i], name) == 0) {
+            return &obj->field_values[i];
+        }
+    }
+    return NULL;
+}
+
+static int64_t log_config_int(HmlValue config, const char *name, int64_t fallback) {
+    HmlValue *field = log_config_field(config, name);
+    if (!field || !hml_is_integer(*field)) {
+        return fallback;
+    }
+    return hml_to_i64(*field);
+}
+
+static int log_config_bool(HmlValue config, const char *name, int fallback) {
+    HmlValue *field = log_config_field(config, name);
+    if (!field || field->type != HML_VAL_BOOL) {
+        return fallback;
+    }
+    return field->as.as_bool;
+}
+
+static void log_object_add(HmlValue obj, const char *name, HmlValue value) {
+    hml_object_set_field(obj, name, value);
+    hml_release(&value);
+}
+
+static LogSink* log_sink_get(HmlValue val, const char *fn_name) {
+    if (val.type != HML_VAL_PTR || !val.as.as_ptr) {
+        hml_runtime_error("%s() expects a log sink handle", fn_name);
+    }
+    LogSink *s = (LogSink*)val.as.as_ptr;
+    if (log_sink_closed(s)) {
+        hml_runtime_error("%s() called on closed log sink", fn_name);
+    }
+    return s;
+}
+
+// Serialize val to a malloc'd JSON string (circular references throw)
+static char* log_json_value(HmlValue val) {
+    HmlValue json = hml_serialize(val);
+    char *out = strdup(json.as.as_string->data);
+    hml_release(&json);
+    return out;
+}
+
+// ========== PUBLIC API ==========
+
+// log_sink_open(target, config) -> sink handle
+// target: "stdout", "stderr" or a file path (opened for append)
+// config: { buffered, capacity, batch_bytes, flush_ms, block } (missing fields use defaults)
+HmlValue hml_log_sink_open(HmlValue target_val, HmlValue config) {
+    if (target_val.type != HML_VAL_STRING) {
+        hml_runtime_error("log_sink_open() expects 2 arguments (target, config)");
+    }
+    int buffered = log_config_bool(config, "buffered", 1);
+    int block = log_config_bool(config, "block", 1);
+    int64_t capacity = log_config_int(config, "capacity", 8192);
+    int64_t batch_bytes = log_config_int(config, "batch_bytes", 64 * 1024);
+    int64_t flush_ms = log_config_int(config, "flush_ms", 100);
+    if (capacity < 1 || capacity > LOG_SINK_MAX_CAPACITY) {
+        hml_runtime_error("log_sink_open() capacity must be between 1 and %d", LOG_SINK_MAX_CAPACITY);
+    }
+    if (batch_bytes < 1 || flush_ms < 1 || flush_ms > 60000) {
+        hml_runtime_error("log_sink_open() batch_bytes must be positive and flush_ms between 1 and 60000");
+    }
+
+    char err[LOG_SINK_ERR_LEN];
+    LogSink *s = log_sink_open(target_val.as.as_string->data, buffered, block, (size_t)capacity,
+                               (size_t)batch_bytes, (int)flush_ms, err);
+    if (!s) {
+        hml_runtime_error("%s", err);
+    }
+    return hml_val_ptr(s);
+}
+
+// log_sink_write(sink, line) -> bool (false if the line was dropped)
+HmlValue hml_log_sink_write(HmlValue sink, HmlValue line_val) {
+    LogSink *s = log_sink_get(sink, "log_sink_write");
+    if (line_val.type != HML_VAL_STRING) {
+        hml_runtime_error("log_sink_write() expects 2 arguments (sink, line)");
+    }
+    HmlString *str = line_val.as.as_string;
+    size_t len = (size_t)str->length;
+    char *line = malloc(len + 1);
+    if (!line) {
+        hml_runtime_error("log_sink_write() memory allocation failed");
+    }
+    memcpy(line, str->data, len);
+    line[len] = '\n';
+    return hml_val_bool(log_sink_write(s, line, len + 1));
+}
+
+// log_sink_flush(sink): wait until every queued line has been written
+HmlValue hml_log_sink_flush(HmlValue sink) {
+    LogSink *s = log_sink_get(sink, "log_sink_flush");
+    log_sink_flush(s);
+    return hml_val_null();
+}
+
+// log_sink_stats(sink) -> { written, dropped, pending }
+HmlValue hml_log_sink_stats(HmlValue sink) {
+    LogSink *s = log_sink_get(sink, "log_sink_stats");
+    int64_t written, dropped, pending;
+    log_sink_stats(s, &written, &dropped, &pending);
+    HmlValue obj = hml_val_object();
+    log_object_add(obj, "written", hml_val_i64(written));
+    log_object_add(obj, "dropped", hml_val_i64(dropped));
+    log_object_add(obj, "pending", hml_val_i64(pending));
+    return obj;
+}
+
+// log_sink_close(sink): flush, stop the writer and close an opened file
+HmlValue hml_log_sink_close(HmlValue sink) {
+    LogSink *s = log_sink_get(sink, "log_sink_close");
+    log_sink_close(s);
+    return hml_val_null();
+}
+
+// log_timestamp() -> "YYYY-MM-DDTHH:MM:SS.mmmZ" (UTC)
+HmlValue hml_log_timestamp(void) {
+    char *out = malloc(LOG_TIMESTAMP_LEN);
+    if (!out) {
+        hml_runtime_error("log_timestamp() memory allocation failed");
+    }
+    int len = log_timestamp_format(out);
+    return hml_val_string_owned(out, len, LOG_TIMESTAMP_LEN);
+}
+
+// log_json(time, level, message, data) -> one JSON line
+// {"time":...,"level":...,"msg":...} followed by the fields of data when it
+// is an object, or a "data" field for any other non-null value. time may be
+// null to leave it out.
+HmlValue hml_log_json(HmlValue time_val, HmlValue level_val, HmlValue msg_val, HmlValue data) {
+    if (level_val.type != HML_VAL_STRING || msg_val.type != HML_VAL_STRING ||
+        (time_val.type != HML_VAL_STRING && time_val.type != HML_VAL_NULL)) {
+        hml_runtime_error("log_json() expects 4 arguments (time, level, message, data)");
+    }
+    char *extra = data.type != HML_VAL_NULL ? log_json_value(data) : NULL;
+    char *time_str = time_val.type == HML_VAL_STRING ? log_json_value(time_val) : NULL;
+    char *level = log_json_value(level_val);
+    char *msg = log_json_value(msg_val);
+
+    size_t cap = strlen(level) + strlen(msg) + 48;
+    if (time_str) cap += strlen(time_str);
+    if (extra) cap += strlen(extra);
+    char *out = malloc(cap);
+    if (!out) {
+        hml_runtime_error("log_json() memory allocation failed");
+    }
+    size_t len = 0;
+    out[len++] = '{';
+    if (time_str) {
+        len += (size_t)snprintf(out + len, cap - len, "\"time\":%s,", time_str);
+    }
+    len += (size_t)snprintf(out + len, cap - len, "\"level\":%s,\"msg\":%s", level, msg);
+    if (extra && data.type == HML_VAL_OBJECT) {
+        // Splice the object's fields in after msg
+        if (strcmp(extra, "{}") != 0) {
+            len += (size_t)snprintf(out + len, cap - len, ",%s", extra + 1);
+            len--;  // Drop the object's closing brace
+        }
+    } else if (extra) {
+        len += (size_t)snprintf(out + len, cap - len, ",\"data\":%s", extra);
+    }
+    out[len++] = '}';
+    out[len] = '\0';
+
+    free(time_str);
+    free(level);
+    free(msg);
+    free(extra);
+    return hml_val_string_owned(out, (int)len, (int)cap);
+}
+
+// ========== BUILTIN WRAPPERS ==========
+
+HmlValue hml_builtin_log_sink_open(HmlClosureEnv *env, HmlValue target, HmlValue config) {
+    (void)env;
+    return hml_log_sink_open(target, config);
+}
+
+HmlValue hml_builtin_log_sink_write(HmlClosureEnv *env, HmlValue sink, HmlValue line) {
+    (void)env;
+    return hml_log_sink_write(sink, line);
+}
+
+HmlValue hml_builtin_log_sink_flush(HmlClosureEnv *env, HmlValue sink) {
+    (void)env;
+    return hml_log_sink_flush(sink);
+}
+
+HmlValue hml_builtin_log_sink_stats(HmlClosureEnv *env, HmlValue sink) {
+    (void)env;
+    return hml_log_sink_stats(sink);
+}
+
+HmlValue hml_builtin_log_sink_close(HmlClosureEnv *env, HmlValue sink) {
+    (void)env;
+    return hml_log_sink_close(sink);
+}
+
+HmlValue hml_builtin_log_timestamp(HmlClosureEnv *env) {
+    (void)env;
+    return hml_log_timestamp();
+}
+
+HmlValue hml_builtin_log_json(HmlClosureEnv *env, HmlValue time, HmlValue level, HmlValue message, HmlValue data) {
+    (void)env;
+    return hml_log_json(time, level, message, data);
+}
@@ -0,0 +1,323 @@
+/*
+ * Hemlock Runtime Library - Regular Expressions
+ *
+ * Builtins for @stdlib/regex on top of the shared engine in
+ * src/shared/regex_engine.c.
+ */
+
+#include "../include/hemlock_runtime.h"
+#include "../../src/shared/regex_engine.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ========== BUILTINS ==========
+
+typedef struct {
+    HmlRegex *re;
+    int closed;
+} HmlRegexHandle;
+
+// Resolve a regex argument: a handle from regex_new, or a pattern string
+// compiled through the cache with the given flags. The caller releases it.
+static HmlRegex* regex_arg(HmlValue re, HmlValue flags, const char *fn_name) {
+    if (re.type == HML_VAL_STRING && re.as.as_string) {
+        if (!hml_is_numeric(flags)) {
+            hml_runtime_error("%s() flags must be an integer", fn_name);
+            return NULL;
+        }
+        const char *error = NULL;
+        HmlRegex *compiled = hml_re_acquire(re.as.as_string->data, re.as.as_string->length,
+                                           hml_to_i32(flags), &error);
+        if (!compiled) hml_runtime_error("Regex compilation failed: %s", error);
+        return compiled;
+    }
+    if (re.type != HML_VAL_PTR || re.as.as_ptr == NULL) {
+        hml_runtime_error("%s() expects a regex handle or pattern string", fn_name);
+        return NULL;
+    }
+    HmlRegexHandle *h = (HmlRegexHandle*)re.as.as_ptr;
+    if (h->closed) {
+        hml_runtime_error("%s() called on freed regex", fn_name);
+        return NULL;
+    }
+    hml_re_retain(h->re);
+    return h->re;
+}
+
+static HmlValue regex_substring(const char *text, int start, int end) {
+    int len = end - start;
+    char *s = malloc(len + 1);
+    if (!s) {
+        hml_runtime_error("regex: memory allocation failed");
+        return hml_val_null();
+    }
+    memcpy(s, text + start, len);
+    s[len] = '\0';
+    return hml_val_string_owned(s, len, len + 1);
+}
+
+// { start, end, text } for one match or group
+static HmlValue regex_match_value(const char *text, int start, int end) {
+    HmlValue obj = hml_val_object();
+    HmlValue str = regex_substring(text, start, end);
+    hml_object_set_field(obj, "start", hml_val_i32(start));
+    hml_object_set_field(obj, "end", hml_val_i32(end));
+    hml_object_set_field(obj, "text", str);
+    hml_release(&str);
+    return obj;
+}
+
+static void regex_push(HmlValue arr, HmlValue val) {
+    hml_array_push(arr, val);
+    hml_release(&val);
+}
+
+// Search state shared by the builtins below
+typedef struct {
+    HmlRegex *re;
+    HmlRegexVM vm;
+    int *caps;
+    const char *text;
+    int len;
+} HmlRegexRun;
+
+static int regex_run_begin(HmlRegexRun *run, HmlValue re, HmlValue flags, HmlValue text, const char *fn_name) {
+    if (text.type != HML_VAL_STRING || !text.as.as_string) {
+        hml_runtime_error("%s() text must be a string", fn_name);
+        return 0;
+    }
+    run->re = regex_arg(re, flags, fn_name);
+    if (!run->re) return 0;
+    run->text = text.as.as_string->data;
+    run->len = text.as.as_string->length;
+    run->caps = malloc(sizeof(int) * hml_re_groups(run->re) * 2);
+    if (!run->caps || !hml_re_vm_init(&run->vm, run->re)) {
+        hml_runtime_error("%s() out of memory", fn_name);
+        return 0;
+    }
+    return 1;
+}
+
+static void regex_run_end(HmlRegexRun *run) {
+    if (!run->re) return;
+    hml_re_vm_free(&run->vm);
+    free(run->caps);
+    hml_re_release(run->re);
+}
+
+static int regex_limit_arg(HmlValue val, const char *fn_name) {
+    if (!hml_is_numeric(val) || hml_to_i32(val) < 0) {
+        hml_runtime_error("%s() limit must be a non-negative integer", fn_name);
+        return -1;
+    }
+    return hml_to_i32(val);
+}
+
+HmlValue hml_regex_new(HmlValue pattern, HmlValue flags) {
+    if (pattern.type != HML_VAL_STRING || !pattern.as.as_string || !hml_is_numeric(flags)) {
+        hml_runtime_error("regex_new() expects (string pattern, integer flags)");
+        return hml_val_null();
+    }
+    const char *error = NULL;
+    HmlRegex *re = hml_re_acquire(pattern.as.as_string->data, pattern.as.as_string->length,
+                                 hml_to_i32(flags), &error);
+    if (!re) {
+        hml_runtime_error("Regex compilation failed: %s", error);
+        return hml_val_null();
+    }
+    HmlRegexHandle *h = malloc(sizeof(HmlRegexHandle));
+    if (!h) {
+        hml_re_release(re);
+        hml_runtime_error("regex_new() out of memory");
+        return hml_val_null();
+    }
+    h->re = re;
+    h->closed = 0;
+    return hml_val_ptr(h);
+}
+
+HmlValue hml_regex_free(HmlValue handle) {
+    if (handle.type != HML_VAL_PTR || handle.as.as_ptr == NULL) {
+        hml_runtime_error("regex_free() expects a regex handle");
+        return hml_val_null();
+    }
+    HmlRegexHandle *h = (HmlRegexHandle*)handle.as.as_ptr;
+    if (!h->closed) {
+        h->closed = 1;
+        hml_re_release(h->re);
+        h->re = NULL;
+    }
+    return hml_val_null();
+}
+
+HmlValue hml_regex_test(HmlValue re, HmlValue flags, HmlValue text) {
+    if (text.type != HML_VAL_STRING || !text.as.as_string) {
+        hml_runtime_error("regex_test() text must be a string");
+        return hml_val_null();
+    }
+    HmlRegex *compiled = regex_arg(re, flags, "regex_test");
+    if (!compiled) return hml_val_null();
+    int found = hml_re_test(compiled, (const unsigned char*)text.as.as_string->data, text.as.as_string->length);
+    hml_re_release(compiled);
+    return hml_val_bool(found);
+}
+
+HmlValue hml_regex_find(HmlValue re, HmlValue flags, HmlValue text, HmlValue start) {
+    if (!hml_is_numeric(start)) {
+        hml_runtime_error("regex_find() start must be an integer");
+        return hml_val_null();
+    }
+    HmlRegexRun run = {0};
+    HmlValue result = hml_val_null();
+    int from = hml_to_i32(start);
+    if (regex_run_begin(&run, re, flags, text, "regex_find") && from >= 0 && from <= run.len &&
+        hml_re_search(run.re, &run.vm, (const unsigned char*)run.text, run.len, from, run.caps)) {
+        result = regex_match_value(run.text, run.caps[0], run.caps[1]);
+    }
+    regex_run_end(&run);
+    return result;
+}
+
+HmlValue hml_regex_find_all(HmlValue re, HmlValue flags, HmlValue text, HmlValue limit) {
+    HmlRegexRun run = {0};
+    int max = regex_limit_arg(limit, "regex_find_all");
+    if (max < 0 || !regex_run_begin(&run, re, flags, text, "regex_find_all")) {
+        regex_run_end(&run);
+        return hml_val_null();
+    }
+    HmlValue arr = hml_val_array();
+    int pos = 0, prev_end = -1, count = 0;
+    while ((max == 0 || count < max) &&
+           hml_re_next(run.re, &run.vm, (const unsigned char*)run.text, run.len, &pos, &prev_end, run.caps)) {
+        regex_push(arr, regex_match_value(run.text, run.caps[0], run.caps[1]));
+        count++;
+    }
+    regex_run_end(&run);
+    return arr;
+}
+
+HmlValue hml_regex_captures(HmlValue re, HmlValue flags, HmlValue text, HmlValue start) {
+    if (!hml_is_numeric(start)) {
+        hml_runtime_error("regex_captures() start must be an integer");
+        return hml_val_null();
+    }
+    HmlRegexRun run = {0};
+    HmlValue result = hml_val_null();
+    int from = hml_to_i32(start);
+    if (regex_run_begin(&run, re, flags, text, "regex_captures") && from >= 0 && from <= run.len &&
+        hml_re_search(run.re, &run.vm, (const unsigned char*)run.text, run.len, from, run.caps)) {
+        result = hml_val_array();
+        for (int g = 0; g < hml_re_groups(run.re); g++) {
+            int s = run.caps[g * 2], e = run.caps[g * 2 + 1];
+            if (s >= 0 && e >= s) regex_push(result, regex_match_value(run.text, s, e));
+            else hml_array_push(result, hml_val_null());
+        }
+    }
+    regex_run_end(&run);
+    return result;
+}
+
+HmlValue hml_regex_replace(HmlValue re, HmlValue flags, HmlValue text, HmlValue replacement, HmlValue limit) {
+    if (replacement.type != HML_VAL_STRING || !replacement.as.as_string) {
+        hml_runtime_error("regex_replace() replacement must be a string");
+        return hml_val_null();
+    }
+    HmlRegexRun run = {0};
+    int max = regex_limit_arg(limit, "regex_replace");
+    if (max < 0 || !regex_run_begin(&run, re, flags, text, "regex_replace")) {
+        regex_run_end(&run);
+        return hml_val_null();
+    }
+    HmlRegexOut out = {0};
+    hml_re_out(&out, "", 0);
+    int pos = 0, prev_end = -1, last = 0, count = 0;
+    while ((max == 0 || count < max) &&
+           hml_re_next(run.re, &run.vm, (const unsigned char*)run.text, run.len, &pos, &prev_end, run.caps)) {
+        hml_re_out(&out, run.text + last, run.caps[0] - last);
+        hml_re_expand(&out, replacement.as.as_string->data, replacement.as.as_string->length,
+                      run.text, run.caps, hml_re_groups(run.re));
+        last = run.caps[1];
+        count++;
+    }
+    hml_re_out(&out, run.text + last, run.len - last);
+    regex_run_end(&run);
+    if (out.failed) {
+        free(out.data);
+        hml_runtime_error("regex_replace() memory allocation failed");
+        return hml_val_null();
+    }
+    return hml_val_string_owned(out.data, out.len, out.cap);
+}
+
+HmlValue hml_regex_split(HmlValue re, HmlValue flags, HmlValue text, HmlValue limit) {
+    HmlRegexRun run = {0};
+    int max = regex_limit_arg(limit, "regex_split");
+    if (max < 0 || !regex_run_begin(&run, re, flags, text, "regex_split")) {
+        regex_run_end(&run);
+        return hml_val_null();
+    }
+    HmlValue arr = hml_val_array();
+    if (run.len == 0) {
+        regex_push(arr, regex_substring(run.text, 0, 0));
+        regex_run_end(&run);
+        return arr;
+    }
+    int pos = 0, prev_end = -1, beg = 0, end = 0, count = 0;
+    while ((max == 0 || count < max - 1) &&
+           hml_re_next(run.re, &run.vm, (const unsigned char*)run.text, run.len, &pos, &prev_end, run.caps)) {
+        end = run.caps[0];
+        // An empty match at the very start does not produce an empty piece
+        if (run.caps[1] != 0) {
+            regex_push(arr, regex_substring(run.text, beg, end));
+            count++;
+        }
+        beg = run.caps[1];
+    }
+    if (end != run.len) regex_push(arr, regex_substring(run.text, beg, run.len));
+    regex_run_end(&run);
+    return arr;
+}
+
+// Builtin wrappers
+
+HmlValue hml_builtin_regex_new(HmlClosureEnv *env, HmlValue pattern, HmlValue flags) {
+    (void)env;
+    return hml_regex_new(pattern, flags);
+}
+
+HmlValue hml_builtin_regex_free(HmlClosureEnv *env, HmlValue handle) {
+    (void)env;
+    return hml_regex_free(handle);
+}
+
+HmlValue hml_builtin_regex_test(HmlClosureEnv *env, HmlValue re, HmlValue flags, HmlValue text) {
+    (void)env;
+    return hml_regex_test(re, flags, text);
+}
+
+HmlValue hml_builtin_regex_find(HmlClosureEnv *env, HmlValue re, HmlValue flags, HmlValue text, HmlValue start) {
+    (void)env;
+    return hml_regex_find(re, flags, text, start);
+}
+
+HmlValue hml_builtin_regex_find_all(HmlClosureEnv *env, HmlValue re, HmlValue flags, HmlValue text, HmlValue limit) {
+    (void)env;
+    return hml_regex_find_all(re, flags, text, limit);
+}
+
+HmlValue hml_builtin_regex_captures(HmlClosureEnv *env, HmlValue re, HmlValue flags, HmlValue text, HmlValue start) {
+    (void)env;
+    return hml_regex_captures(re, flags, text, start);
+}
+
+HmlValue hml_builtin_regex_replace(HmlClosureEnv *env, HmlValue re, HmlValue flags, HmlValue text,
+                                   HmlValue replacement, HmlValue limit) {
+    (void)env;
+    return hml_regex_replace(re, flags, text, replacement, limit);
+}
+
+HmlValue hml_builtin_regex_split(HmlClosureEnv *env, HmlValue re, HmlValue flags, HmlValue text, HmlValue limit) {
+    (void)env;
+    return hml_regex_split(re, flags, text, limit);
+}
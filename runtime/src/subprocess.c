@@ -0,0 +1,444 @@
+/*
+ * Hemlock Runtime Library - Subprocesses
+ *
+ * Builtins for @stdlib/process on top of the shared core in
+ * src/shared/subprocess_core.c, which spawns children and drives their
+ * pipes.
+ */
+
+#include "../include/hemlock_runtime.h"
+#include "../../src/shared/subprocess_core.h"
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ========== BUILTINS ==========
+
+static Process* proc_get(HmlValue val, const char *fn_name, int allow_closed) {
+    if (val.type != HML_VAL_PTR || !val.as.as_ptr) {
+        hml_runtime_error("%s() expects a process handle", fn_name);
+    }
+    Process *proc = (Process*)val.as.as_ptr;
+    if (proc->closed && !allow_closed) {
+        hml_runtime_error("%s() called on closed process", fn_name);
+    }
+    return proc;
+}
+
+static HmlValue* proc_field(HmlObject *obj, const char *name) {
+    for (int i = 0; i < obj->num_fields; i++) {
+        if (strcmp(obj->field_names[i], name) == 0) {
+            return &obj->field_values[i];
+        }
+    }
+    return NULL;
+}
+
+static ProcStream* proc_stream_get(Process *proc, HmlValue name, const char *fn_name) {
+    ProcStream *s = name.type == HML_VAL_STRING ? proc_stream_named(proc, name.as.as_string->data) : NULL;
+    if (!s) {
+            hml_runtime_error("%s() stream must be \"stdout\" or \"stderr\"", fn_name);
+    }
+    return s;
+}
+
+static void proc_add_field(HmlValue obj, const char *name, HmlValue value) {
+    hml_object_set_field(obj, name, value);
+    hml_release(&value);
+}
+
+static void proc_add_status(HmlValue obj, Process *proc) {
+    int exit_code, term_signal;
+    proc_exit_status(proc, &exit_code, &term_signal);
+    proc_add_field(obj, "exit_code", hml_val_i32(exit_code));
+    proc_add_field(obj, "signal", hml_val_i32(term_signal));
+}
+
+// Parse a stdin/stdout/stderr option:
+//   null / "inherit", "pipe", "null", { file, append? },
+//   "stdout" (stderr only) or a process handle (stdin only)
+// Returns 0, or -1 with a message in err.
+static int proc_parse_redirect(HmlValue spec, int stream, ProcRedirect *r, char *err, size_t err_len) {
+    static const char *names[] = {"stdin", "stdout", "stderr"};
+    memset(r, 0, sizeof(*r));
+    r->fd = -1;
+    if (spec.type == HML_VAL_NULL) {
+        return 0;
+    }
+    if (spec.type == HML_VAL_STRING) {
+        const char *s = spec.as.as_string->data;
+        if (strcmp(s, "inherit") == 0) {
+            return 0;
+        }
+        if (strcmp(s, "pipe") == 0) {
+            r->kind = PROC_PIPE;
+            return 0;
+        }
+        if (strcmp(s, "null") == 0) {
+            r->kind = PROC_NULL;
+            return 0;
+        }
+        if (strcmp(s, "stdout") == 0 && stream == 2) {
+            r->kind = PROC_STDOUT;
+            return 0;
+        }
+    } else if (spec.type == HML_VAL_PTR && spec.as.as_ptr && stream == 0) {
+        return proc_redirect_from(r, (Process*)spec.as.as_ptr, err, err_len);
+    } else if (spec.type == HML_VAL_OBJECT) {
+        HmlValue *file = proc_field(spec.as.as_object, "file");
+        HmlValue *append = proc_field(spec.as.as_object, "append");
+        if (file && file->type == HML_VAL_STRING) {
+            int append_mode = append && append->type == HML_VAL_BOOL && append->as.as_bool;
+            return proc_redirect_file(r, stream, file->as.as_string->data, append_mode, err, err_len);
+        }
+    }
+    snprintf(err, err_len, "invalid %s option (expected \"inherit\", \"pipe\", \"null\", { file }%s)",
+             names[stream], stream == 0 ? " or a process" : stream == 2 ? " or \"stdout\"" : "");
+    return -1;
+}
+
+// process_spawn(argv, options) -> process handle
+// options: { cwd, env, stdin, stdout, stderr } (null or missing fields use defaults)
+HmlValue hml_process_spawn(HmlValue argv_val, HmlValue options) {
+    if (argv_val.type != HML_VAL_ARRAY || argv_val.as.as_array->length == 0) {
+        hml_runtime_error("process_spawn() argv must be a non-empty array of strings");
+    }
+    HmlArray *argv_arr = argv_val.as.as_array;
+    for (int i = 0; i < argv_arr->length; i++) {
+        if (argv_arr->elements[i].type != HML_VAL_STRING) {
+            hml_runtime_error("process_spawn() argv must be a non-empty array of strings");
+        }
+    }
+    HmlObject *opts = options.type == HML_VAL_OBJECT ? options.as.as_object : NULL;
+    if (!opts && options.type != HML_VAL_NULL) {
+        hml_runtime_error("process_spawn() options must be an object or null");
+    }
+
+    const char *cwd = NULL;
+    HmlValue *cwd_val = opts ? proc_field(opts, "cwd") : NULL;
+    if (cwd_val && cwd_val->type != HML_VAL_NULL) {
+        if (cwd_val->type != HML_VAL_STRING) {
+            hml_runtime_error("process_spawn() cwd must be a string");
+        }
+        cwd = cwd_val->as.as_string->data;
+    }
+    HmlValue *env_val = opts ? proc_field(opts, "env") : NULL;
+    HmlObject *env_obj = NULL;
+    if (env_val && env_val->type != HML_VAL_NULL) {
+        if (env_val->type != HML_VAL_OBJECT) {
+            hml_runtime_error("process_spawn() env must be an object of strings");
+        }
+        env_obj = env_val->as.as_object;
+        for (int i = 0; i < env_obj->num_fields; i++) {
+            if (env_obj->field_values[i].type != HML_VAL_STRING) {
+                hml_runtime_error("process_spawn() env value '%s' must be a string", env_obj->field_names[i]);
+            }
+        }
+    }
+
+    static const char *stream_names[] = {"stdin", "stdout", "stderr"};
+    char err[PROC_ERR_LEN];
+    ProcRedirect redir[3];
+    memset(redir, 0, sizeof(redir));
+    for (int i = 0; i < 3; i++) {
+        HmlValue *spec = opts ? proc_field(opts, stream_names[i]) : NULL;
+        if (proc_parse_redirect(spec ? *spec : hml_val_null(), i, &redir[i], err, sizeof(err)) < 0) {
+            proc_redirect_release(redir, i);
+            hml_runtime_error("process_spawn() %s", err);
+        }
+    }
+
+    char **argv = malloc(sizeof(char*) * ((size_t)argv_arr->length + 1));
+    char **envp = NULL;
+    int env_count = env_obj ? env_obj->num_fields : 0;
+    if (env_obj) {
+        envp = calloc((size_t)env_count + 1, sizeof(char*));
+    }
+    int alloc_failed = !argv || (env_obj && !envp);
+    if (argv) {
+        for (int i = 0; i < argv_arr->length; i++) {
+            argv[i] = argv_arr->elements[i].as.as_string->data;
+        }
+        argv[argv_arr->length] = NULL;
+    }
+    for (int i = 0; envp && i < env_count; i++) {
+        const char *name = env_obj->field_names[i];
+        HmlString *value = env_obj->field_values[i].as.as_string;
+        size_t len = strlen(name) + (size_t)value->length + 2;
+        envp[i] = malloc(len);
+        if (!envp[i]) {
+            alloc_failed = 1;
+            break;
+        }
+        snprintf(envp[i], len, "%s=%s", name, value->data);
+    }
+
+    Process *proc = NULL;
+    if (!alloc_failed) {
+        proc = proc_spawn(argv, envp, cwd, redir, err, sizeof(err));
+    } else {
+        proc_redirect_release(redir, 3);
+        snprintf(err, sizeof(err), "memory allocation failed");
+    }
+    free(argv);
+    for (int i = 0; envp && i < env_count; i++) {
+        free(envp[i]);
+    }
+    free(envp);
+    if (!proc) {
+        hml_runtime_error("process_spawn() failed to start %s", err);
+    }
+    return hml_val_ptr(proc);
+}
+
+// process_pid(proc) -> i32
+HmlValue hml_process_pid(HmlValue handle) {
+    Process *proc = proc_get(handle, "process_pid", 1);
+    return hml_val_i32((int32_t)proc->pid);
+}
+
+// process_read(proc, stream, max, timeout_ms) -> up to max bytes,
+// "" at EOF, null if nothing arrived within timeout_ms (-1 waits forever)
+HmlValue hml_process_read(HmlValue handle, HmlValue stream, HmlValue max_bytes, HmlValue timeout_ms) {
+    Process *proc = proc_get(handle, "process_read", 0);
+    ProcStream *s = proc_stream_get(proc, stream, "process_read");
+    if (!hml_is_integer(max_bytes) || !hml_is_integer(timeout_ms)) {
+        hml_runtime_error("process_read() expects 4 arguments (process, stream, max_bytes, timeout_ms)");
+    }
+    int max = hml_to_i32(max_bytes);
+    if (max <= 0) {
+        hml_runtime_error("process_read() max_bytes must be positive");
+    }
+    char *out = malloc((size_t)max + 1);
+    if (!out) {
+        hml_runtime_error("process_read() memory allocation failed");
+    }
+    ssize_t n = proc_stream_read(s, out, (size_t)max, hml_to_i32(timeout_ms));
+    if (n == -2) {
+        free(out);
+        return hml_val_null();
+    }
+    if (n < 0) {
+        int saved = errno;
+        free(out);
+        hml_runtime_error("process_read() failed: %s", strerror(saved));
+    }
+    out[n] = '\0';
+    return hml_val_string_owned(out, (int)n, max + 1);
+}
+
+// process_read_line(proc, stream) -> next line without "\n", null at EOF
+HmlValue hml_process_read_line(HmlValue handle, HmlValue stream) {
+    Process *proc = proc_get(handle, "process_read_line", 0);
+    ProcStream *s = proc_stream_get(proc, stream, "process_read_line");
+    size_t len = 0;
+    int failed = 0;
+    char *line = proc_stream_line(s, &len, &failed);
+    if (failed) {
+        hml_runtime_error("process_read_line() failed: %s", strerror(errno));
+    }
+    if (!line) {
+        return hml_val_null();
+    }
+    return hml_val_string_owned(line, (int)len, (int)len + 1);
+}
+
+// process_write(proc, data): write a string or buffer to the child's stdin
+HmlValue hml_process_write(HmlValue handle, HmlValue data) {
+    Process *proc = proc_get(handle, "process_write", 0);
+    const char *bytes;
+    size_t len;
+    if (data.type == HML_VAL_STRING) {
+        bytes = data.as.as_string->data;
+        len = (size_t)data.as.as_string->length;
+    } else if (data.type == HML_VAL_BUFFER) {
+        bytes = (const char*)data.as.as_buffer->data;
+        len = (size_t)data.as.as_buffer->length;
+    } else {
+        hml_runtime_error("process_write() data must be a string or buffer");
+        return hml_val_null();
+    }
+    if (proc->in_fd < 0) {
+        hml_runtime_error("process_write() stdin is not an open pipe");
+    }
+    int rc = proc_write(proc, bytes, len);
+    if (rc != 0) {
+        hml_runtime_error("process_write() failed: %s", strerror(rc));
+    }
+    return hml_val_null();
+}
+
+// process_close_stdin(proc): send EOF to the child
+HmlValue hml_process_close_stdin(HmlValue handle) {
+    proc_close_stdin(proc_get(handle, "process_close_stdin", 1));
+    return hml_val_null();
+}
+
+// process_poll(procs, timeout_ms) -> [{ stdout, stderr }, ...]
+// Waits until any piped output of the given processes is readable (data or
+// EOF), at most timeout_ms (-1 waits forever), and reports which ones are
+HmlValue hml_process_poll(HmlValue procs_val, HmlValue timeout_ms) {
+    if (procs_val.type != HML_VAL_ARRAY || !hml_is_integer(timeout_ms)) {
+        hml_runtime_error("process_poll() expects 2 arguments (processes array, timeout_ms)");
+    }
+    HmlArray *procs = procs_val.as.as_array;
+    int count = procs->length;
+    Process **list = malloc(sizeof(Process*) * ((size_t)count + 1));
+    int *ready = malloc(sizeof(int) * ((size_t)count * 2 + 1));
+    if (!list || !ready) {
+        free(list);
+        free(ready);
+        hml_runtime_error("process_poll() memory allocation failed");
+    }
+    for (int i = 0; i < count; i++) {
+        list[i] = proc_get(procs->elements[i], "process_poll", 1);
+    }
+    if (proc_poll(list, count, hml_to_i32(timeout_ms), ready) < 0) {
+        free(list);
+        free(ready);
+        hml_runtime_error("process_poll() memory allocation failed");
+    }
+    HmlValue result = hml_val_array();
+    for (int i = 0; i < count; i++) {
+        HmlValue obj = hml_val_object();
+        proc_add_field(obj, "stdout", hml_val_bool(ready[i * 2]));
+        proc_add_field(obj, "stderr", hml_val_bool(ready[i * 2 + 1]));
+        hml_array_push(result, obj);
+        hml_release(&obj);
+    }
+    free(list);
+    free(ready);
+    return result;
+}
+
+// process_wait(proc, timeout_ms) -> { exit_code, signal }, or null if the
+// child is still running after timeout_ms (-1 waits forever)
+// exit_code is -1 when the child was killed by a signal
+HmlValue hml_process_wait(HmlValue handle, HmlValue timeout_ms) {
+    Process *proc = proc_get(handle, "process_wait", 1);
+    if (!hml_is_integer(timeout_ms)) {
+        hml_runtime_error("process_wait() expects 2 arguments (process, timeout_ms)");
+    }
+    int r = proc_reap(proc, hml_to_i32(timeout_ms));
+    if (r < 0) {
+        hml_runtime_error("process_wait() failed: %s", strerror(errno));
+    }
+    if (r == 0) {
+        return hml_val_null();
+    }
+    HmlValue obj = hml_val_object();
+    proc_add_status(obj, proc);
+    return obj;
+}
+
+// process_kill(proc, signal): signal the child (a no-op once it is reaped)
+HmlValue hml_process_kill(HmlValue handle, HmlValue signal) {
+    Process *proc = proc_get(handle, "process_kill", 1);
+    if (!hml_is_integer(signal)) {
+        hml_runtime_error("process_kill() expects 2 arguments (process, signal)");
+    }
+    if (proc_kill(proc, hml_to_i32(signal)) < 0) {
+        hml_runtime_error("process_kill() failed: %s", strerror(errno));
+    }
+    return hml_val_null();
+}
+
+// process_communicate(proc, input) -> { stdout, stderr, exit_code, signal }
+// Writes input (string, buffer or null) to stdin, closes it, reads both
+// output pipes to EOF and waits for the child to exit
+HmlValue hml_process_communicate(HmlValue handle, HmlValue input_val) {
+    Process *proc = proc_get(handle, "process_communicate", 0);
+    const char *input = NULL;
+    size_t input_len = 0;
+    if (input_val.type == HML_VAL_STRING) {
+        input = input_val.as.as_string->data;
+        input_len = (size_t)input_val.as.as_string->length;
+    } else if (input_val.type == HML_VAL_BUFFER) {
+        input = (const char*)input_val.as.as_buffer->data;
+        input_len = (size_t)input_val.as.as_buffer->length;
+    } else if (input_val.type != HML_VAL_NULL) {
+        hml_runtime_error("process_communicate() input must be a string, buffer or null");
+    }
+    if (input_len > 0 && proc->in_fd < 0) {
+        hml_runtime_error("process_communicate() stdin is not an open pipe");
+    }
+    ProcBuf out = {0}, err = {0};
+    int rc = proc_communicate(proc, input, input_len, &out, &err);
+    if (rc != 0) {
+        free(out.data);
+        free(err.data);
+        hml_runtime_error("process_communicate() failed: %s", strerror(rc));
+    }
+    HmlValue obj = hml_val_object();
+    proc_add_field(obj, "stdout", hml_val_string_owned(out.data, (int)out.len, (int)out.cap));
+    proc_add_field(obj, "stderr", hml_val_string_owned(err.data, (int)err.len, (int)err.cap));
+    proc_add_status(obj, proc);
+    return obj;
+}
+
+// process_close(proc): close the pipes held by the parent. The child keeps
+// running; wait() and kill() still work afterwards.
+HmlValue hml_process_close(HmlValue handle) {
+    proc_close(proc_get(handle, "process_close", 1));
+    return hml_val_null();
+}
+
+// ========== BUILTIN WRAPPERS ==========
+
+HmlValue hml_builtin_process_spawn(HmlClosureEnv *env, HmlValue argv, HmlValue options) {
+    (void)env;
+    return hml_process_spawn(argv, options);
+}
+
+HmlValue hml_builtin_process_pid(HmlClosureEnv *env, HmlValue proc) {
+    (void)env;
+    return hml_process_pid(proc);
+}
+
+HmlValue hml_builtin_process_read(HmlClosureEnv *env, HmlValue proc, HmlValue stream,
+                                  HmlValue max_bytes, HmlValue timeout_ms) {
+    (void)env;
+    return hml_process_read(proc, stream, max_bytes, timeout_ms);
+}
+
+HmlValue hml_builtin_process_read_line(HmlClosureEnv *env, HmlValue proc, HmlValue stream) {
+    (void)env;
+    return hml_process_read_line(proc, stream);
+}
+
+HmlValue hml_builtin_process_write(HmlClosureEnv *env, HmlValue proc, HmlValue data) {
+    (void)env;
+    return hml_process_write(proc, data);
+}
+
+HmlValue hml_builtin_process_close_stdin(HmlClosureEnv *env, HmlValue proc) {
+    (void)env;
+    return hml_process_close_stdin(proc);
+}
+
+HmlValue hml_builtin_process_poll(HmlClosureEnv *env, HmlValue procs, HmlValue timeout_ms) {
+    (void)env;
+    return hml_process_poll(procs, timeout_ms);
+}
+
+HmlValue hml_builtin_process_wait(HmlClosureEnv *env, HmlValue proc, HmlValue timeout_ms) {
+    (void)env;
+    return hml_process_wait(proc, timeout_ms);
+}
+
+HmlValue hml_builtin_process_kill(HmlClosureEnv *env, HmlValue proc, HmlValue signal) {
+    (void)env;
+    return hml_process_kill(proc, signal);
+}
+
+HmlValue hml_builtin_process_communicate(HmlClosureEnv *env, HmlValue proc, HmlValue input) {
+    (void)env;
+    return hml_process_communicate(proc, input);
+}
+
+HmlValue hml_builtin_process_close(HmlClosureEnv *env, HmlValue proc) {
+    (void)env;
+    return hml_process_close(proc);
+}
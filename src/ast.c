@@ -1,22 +1,295 @@
 #include "ast.h"
+#include "fnv1a.h"
 #include <stdlib.h>
 #include <string.h>
 
+// ========== AST ARENA ==========
+
+// Nodes are bump-allocated from 64KB chunks; anything larger than a quarter
+// chunk gets a chunk of its own. Strings are interned per arena, so every
+// occurrence of an identifier in a module shares one copy.
+
+#define ARENA_CHUNK_SIZE (64 * 1024)
+#define ARENA_ALIGN 8
+#define ARENA_ROUND(n) (((n) + (ARENA_ALIGN - 1)) & ~(size_t)(ARENA_ALIGN - 1))
+
+typedef struct ArenaChunk {
+    struct ArenaChunk *next;
+    size_t size;              // Usable bytes after the header
+} ArenaChunk;
+
+#define CHUNK_HEADER ARENA_ROUND(sizeof(ArenaChunk))
+
+typedef struct {
+    const char *str;
+    uint32_t hash;
+    uint32_t len;
+} InternSlot;
+
+struct AstArena {
+    ArenaChunk *chunks;       // Newest first; the head is the bump chunk
+    char *ptr;                // Next free byte in the bump chunk
+    char *end;                // End of the bump chunk
+    char *last;               // Most recent allocation (can grow in place)
+    InternSlot *symbols;      // Open-addressing table of interned strings
+    uint32_t symbol_capacity;
+    uint32_t symbol_count;
+};
+
+static __thread AstArena *current_arena = NULL;
+
+AstArena* ast_arena_new(void) {
+    AstArena *arena = calloc(1, sizeof(AstArena));
+    return arena;
+}
+
+void ast_arena_free(AstArena *arena) {
+    if (!arena) return;
+    ArenaChunk *chunk = arena->chunks;
+    while (chunk) {
+        ArenaChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    free(arena->symbols);
+    free(arena);
+}
+
+AstArena* ast_arena_use(AstArena *arena) {
+    AstArena *previous = current_arena;
+    current_arena = arena;
+    return previous;
+}
+
+AstArena* ast_arena_current(void) {
+    return current_arena;
+}
+
+static ArenaChunk* arena_chunk_new(size_t size) {
+    ArenaChunk *chunk = malloc(CHUNK_HEADER + size);
+    if (!chunk) {
+        abort();
+    }
+    chunk->size = size;
+    return chunk;
+}
+
+static void* arena_alloc(AstArena *arena, size_t size) {
+    size = ARENA_ROUND(size ? size : 1);
+    if (size > (size_t)(arena->end - arena->ptr)) {
+        if (size > ARENA_CHUNK_SIZE / 4) {
+            // Oversized: link it behind the bump chunk and keep bumping there
+            ArenaChunk *chunk = arena_chunk_new(size);
+            if (arena->chunks) {
+                chunk->next = arena->chunks->next;
+                arena->chunks->next = chunk;
+            } else {
+                chunk->next = NULL;
+                arena->chunks = chunk;
+            }
+            arena->last = NULL;
+            return (char *)chunk + CHUNK_HEADER;
+        }
+        ArenaChunk *chunk = arena_chunk_new(ARENA_CHUNK_SIZE);
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+        arena->ptr = (char *)chunk + CHUNK_HEADER;
+        arena->end = arena->ptr + ARENA_CHUNK_SIZE;
+    }
+    char *result = arena->ptr;
+    arena->ptr += size;
+    arena->last = result;
+    return result;
+}
+
+void* ast_alloc(size_t size) {
+    if (current_arena) {
+        return arena_alloc(current_arena, size);
+    }
+    return malloc(size);
+}
+
+void* ast_realloc(void *ptr, size_t old_size, size_t new_size) {
+    AstArena *arena = current_arena;
+    if (!arena) {
+        return realloc(ptr, new_size);
+    }
+    if (!ptr) {
+        return arena_alloc(arena, new_size);
+    }
+    // The latest allocation grows in place while the chunk has room
+    if (ptr == arena->last && ARENA_ROUND(new_size) <= (size_t)(arena->end - arena->last)) {
+        arena->ptr = arena->last + ARENA_ROUND(new_size);
+        return ptr;
+    }
+    void *result = arena_alloc(arena, new_size);
+    memcpy(result, ptr, old_size < new_size ? old_size : new_size);
+    return result;
+}
+
+void* ast_array_grow(void *array, int count, int *capacity, size_t elem_size) {
+    if (count < *capacity) {
+        return array;
+    }
+    int new_capacity = *capacity > 0 ? *capacity * 2 : 4;
+    array = ast_realloc(array, (size_t)*capacity * elem_size, (size_t)new_capacity * elem_size);
+    *capacity = new_capacity;
+    return array;
+}
+
+void ast_free(void *ptr) {
+    if (!current_arena) {
+        free(ptr);
+    }
+}
+
+static void intern_grow(AstArena *arena) {
+    uint32_t capacity = arena->symbol_capacity ? arena->symbol_capacity * 2 : 256;
+    InternSlot *slots = calloc(capacity, sizeof(InternSlot));
+    for (uint32_t i = 0; i < arena->symbol_capacity; i++) {
+        InternSlot *old = &arena->symbols[i];
+        if (!old->str) continue;
+        uint32_t j = old->hash & (capacity - 1);
+        while (slots[j].str) {
+            j = (j + 1) & (capacity - 1);
+        }
+        slots[j] = *old;
+    }
+    free(arena->symbols);
+    arena->symbols = slots;
+    arena->symbol_capacity = capacity;
+}
+
+static char* intern(AstArena *arena, const char *str, size_t len) {
+    if ((arena->symbol_count + 1) * 2 > arena->symbol_capacity) {
+        intern_grow(arena);
+    }
+    uint32_t hash = (uint32_t)hml_fnv1a64(str, len, HML_FNV1A64_OFFSET);
+    uint32_t mask = arena->symbol_capacity - 1;
+    uint32_t i = hash & mask;
+    while (arena->symbols[i].str) {
+        InternSlot *slot = &arena->symbols[i];
+        if (slot->hash == hash && slot->len == len && memcmp(slot->str, str, len) == 0) {
+            return (char *)slot->str;
+        }
+        i = (i + 1) & mask;
+    }
+    char *copy = arena_alloc(arena, len + 1);
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    arena->symbols[i].str = copy;
+    arena->symbols[i].hash = hash;
+    arena->symbols[i].len = (uint32_t)len;
+    arena->symbol_count++;
+    return copy;
+}
+
+char* ast_strndup(const char *str, size_t len) {
+    if (current_arena) {
+        return intern(current_arena, str, len);
+    }
+    char *copy = malloc(len + 1);
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+char* ast_strdup(const char *str) {
+    if (!str) return NULL;
+    return ast_strndup(str, strlen(str));
+}
+
+// ========== NODE SIZES ==========
+
+// A node only needs room for its own union member, so a bool literal does
+// not pay for the largest variant
+#define EXPR_SIZE(member) (offsetof(Expr, as) + sizeof(((Expr *)0)->as.member))
+#define STMT_SIZE(member) (offsetof(Stmt, as) + sizeof(((Stmt *)0)->as.member))
+
+size_t expr_node_size(ExprType type) {
+    switch (type) {
+        case EXPR_NUMBER: return EXPR_SIZE(number);
+        case EXPR_BOOL: return EXPR_SIZE(boolean);
+        case EXPR_STRING: return EXPR_SIZE(string);
+        case EXPR_RUNE: return EXPR_SIZE(rune);
+        case EXPR_IDENT: return EXPR_SIZE(ident);
+        case EXPR_NULL: return offsetof(Expr, as);
+        case EXPR_BINARY: return EXPR_SIZE(binary);
+        case EXPR_UNARY: return EXPR_SIZE(unary);
+        case EXPR_TERNARY: return EXPR_SIZE(ternary);
+        case EXPR_CALL: return EXPR_SIZE(call);
+        case EXPR_ASSIGN: return EXPR_SIZE(assign);
+        case EXPR_GET_PROPERTY: return EXPR_SIZE(get_property);
+        case EXPR_SET_PROPERTY: return EXPR_SIZE(set_property);
+        case EXPR_INDEX: return EXPR_SIZE(index);
+        case EXPR_INDEX_ASSIGN: return EXPR_SIZE(index_assign);
+        case EXPR_FUNCTION: return EXPR_SIZE(function);
+        case EXPR_ARRAY_LITERAL: return EXPR_SIZE(array_literal);
+        case EXPR_OBJECT_LITERAL: return EXPR_SIZE(object_literal);
+        case EXPR_PREFIX_INC: return EXPR_SIZE(prefix_inc);
+        case EXPR_PREFIX_DEC: return EXPR_SIZE(prefix_dec);
+        case EXPR_POSTFIX_INC: return EXPR_SIZE(postfix_inc);
+        case EXPR_POSTFIX_DEC: return EXPR_SIZE(postfix_dec);
+        case EXPR_AWAIT: return EXPR_SIZE(await_expr);
+        case EXPR_STRING_INTERPOLATION: return EXPR_SIZE(string_interpolation);
+        case EXPR_OPTIONAL_CHAIN: return EXPR_SIZE(optional_chain);
+        case EXPR_NULL_COALESCE: return EXPR_SIZE(null_coalesce);
+    }
+    return sizeof(Expr);
+}
+
+size_t stmt_node_size(StmtType type) {
+    switch (type) {
+        case STMT_LET: return STMT_SIZE(let);
+        case STMT_CONST: return STMT_SIZE(const_stmt);
+        case STMT_EXPR: return STMT_SIZE(expr);
+        case STMT_IF: return STMT_SIZE(if_stmt);
+        case STMT_WHILE: return STMT_SIZE(while_stmt);
+        case STMT_FOR: return STMT_SIZE(for_loop);
+        case STMT_FOR_IN: return STMT_SIZE(for_in);
+        case STMT_BREAK: return offsetof(Stmt, as);
+        case STMT_CONTINUE: return offsetof(Stmt, as);
+        case STMT_BLOCK: return STMT_SIZE(block);
+        case STMT_RETURN: return STMT_SIZE(return_stmt);
+        case STMT_DEFINE_OBJECT: return STMT_SIZE(define_object);
+        case STMT_ENUM: return STMT_SIZE(enum_decl);
+        case STMT_TRY: return STMT_SIZE(try_stmt);
+        case STMT_THROW: return STMT_SIZE(throw_stmt);
+        case STMT_SWITCH: return STMT_SIZE(switch_stmt);
+        case STMT_DEFER: return STMT_SIZE(defer_stmt);
+        case STMT_IMPORT: return STMT_SIZE(import_stmt);
+        case STMT_EXPORT: return STMT_SIZE(export_stmt);
+        case STMT_IMPORT_FFI: return STMT_SIZE(import_ffi);
+        case STMT_EXTERN_FN: return STMT_SIZE(extern_fn);
+    }
+    return sizeof(Stmt);
+}
+
+static Expr* expr_alloc(ExprType type) {
+    Expr *expr = ast_alloc(expr_node_size(type));
+    expr->type = type;
+    expr->line = 0;
+    return expr;
+}
+
+static Stmt* stmt_alloc(StmtType type) {
+    Stmt *stmt = ast_alloc(stmt_node_size(type));
+    stmt->type = type;
+    stmt->line = 0;
+    return stmt;
+}
+
 // ========== EXPRESSION CONSTRUCTORS ==========
 
 Expr* expr_number_int(int64_t value) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_NUMBER;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_NUMBER);
     expr->as.number.int_value = value;
     expr->as.number.is_float = 0;
     return expr;
 }
 
 Expr* expr_number_float(double value) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_NUMBER;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_NUMBER);
     expr->as.number.float_value = value;
     expr->as.number.is_float = 1;
     return expr;
@@ -27,48 +300,36 @@ Expr* expr_number(int value) {
 }
 
 Expr* expr_bool(int value) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_BOOL;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_BOOL);
     expr->as.boolean = value ? 1 : 0;
     return expr;
 }
 
 Expr* expr_string(const char *str) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_STRING;
-    expr->line = 0;
-    expr->as.string = strdup(str);
+    Expr *expr = expr_alloc(EXPR_STRING);
+    expr->as.string = ast_strdup(str);
     return expr;
 }
 
 Expr* expr_rune(uint32_t codepoint) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_RUNE;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_RUNE);
     expr->as.rune = codepoint;
     return expr;
 }
 
 Expr* expr_ident(const char *name) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_IDENT;
-    expr->line = 0;
-    expr->as.ident = strdup(name);
+    Expr *expr = expr_alloc(EXPR_IDENT);
+    expr->as.ident = ast_strdup(name);
     return expr;
 }
 
 Expr* expr_null(void) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_NULL;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_NULL);
     return expr;
 }
 
 Expr* expr_binary(Expr *left, BinaryOp op, Expr *right) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_BINARY;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_BINARY);
     expr->as.binary.left = left;
     expr->as.binary.op = op;
     expr->as.binary.right = right;
@@ -76,18 +337,14 @@ Expr* expr_binary(Expr *left, BinaryOp op, Expr *right) {
 }
 
 Expr* expr_unary(UnaryOp op, Expr *operand) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_UNARY;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_UNARY);
     expr->as.unary.op = op;
     expr->as.unary.operand = operand;
     return expr;
 }
 
 Expr* expr_ternary(Expr *condition, Expr *true_expr, Expr *false_expr) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_TERNARY;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_TERNARY);
     expr->as.ternary.condition = condition;
     expr->as.ternary.true_expr = true_expr;
     expr->as.ternary.false_expr = false_expr;
@@ -95,9 +352,7 @@ Expr* expr_ternary(Expr *condition, Expr *true_expr, Expr *false_expr) {
 }
 
 Expr* expr_call(Expr *func, Expr **args, int num_args) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_CALL;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_CALL);
     expr->as.call.func = func;
     expr->as.call.args = args;
     expr->as.call.num_args = num_args;
@@ -105,46 +360,36 @@ Expr* expr_call(Expr *func, Expr **args, int num_args) {
 }
 
 Expr* expr_assign(const char *name, Expr *value) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_ASSIGN;
-    expr->line = 0;
-    expr->as.assign.name = strdup(name);
+    Expr *expr = expr_alloc(EXPR_ASSIGN);
+    expr->as.assign.name = ast_strdup(name);
     expr->as.assign.value = value;
     return expr;
 }
 
 Expr* expr_get_property(Expr *object, const char *property) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_GET_PROPERTY;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_GET_PROPERTY);
     expr->as.get_property.object = object;
-    expr->as.get_property.property = strdup(property);
+    expr->as.get_property.property = ast_strdup(property);
     return expr;
 }
 
 Expr* expr_set_property(Expr *object, const char *property, Expr *value) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_SET_PROPERTY;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_SET_PROPERTY);
     expr->as.set_property.object = object;
-    expr->as.set_property.property = strdup(property);
+    expr->as.set_property.property = ast_strdup(property);
     expr->as.set_property.value = value;
     return expr;
 }
 
 Expr* expr_index(Expr *object, Expr *index) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_INDEX;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_INDEX);
     expr->as.index.object = object;
     expr->as.index.index = index;
     return expr;
 }
 
 Expr* expr_index_assign(Expr *object, Expr *index, Expr *value) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_INDEX_ASSIGN;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_INDEX_ASSIGN);
     expr->as.index_assign.object = object;
     expr->as.index_assign.index = index;
     expr->as.index_assign.value = value;
@@ -152,9 +397,7 @@ Expr* expr_index_assign(Expr *object, Expr *index, Expr *value) {
 }
 
 Expr* expr_function(int is_async, char **param_names, Type **param_types, Expr **param_defaults, int num_params, Type *return_type, Stmt *body) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_FUNCTION;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_FUNCTION);
     expr->as.function.is_async = is_async;
     expr->as.function.param_names = param_names;
     expr->as.function.param_types = param_types;
@@ -162,22 +405,19 @@ Expr* expr_function(int is_async, char **param_names, Type **param_types, Expr *
     expr->as.function.num_params = num_params;
     expr->as.function.return_type = return_type;
     expr->as.function.body = body;
+    expr->as.function.lazy_body = NULL;
     return expr;
 }
 
 Expr* expr_array_literal(Expr **elements, int num_elements) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_ARRAY_LITERAL;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_ARRAY_LITERAL);
     expr->as.array_literal.elements = elements;
     expr->as.array_literal.num_elements = num_elements;
     return expr;
 }
 
 Expr* expr_object_literal(char **field_names, Expr **field_values, int num_fields) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_OBJECT_LITERAL;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_OBJECT_LITERAL);
     expr->as.object_literal.field_names = field_names;
     expr->as.object_literal.field_values = field_values;
     expr->as.object_literal.num_fields = num_fields;
@@ -185,49 +425,37 @@ Expr* expr_object_literal(char **field_names, Expr **field_values, int num_field
 }
 
 Expr* expr_prefix_inc(Expr *operand) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_PREFIX_INC;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_PREFIX_INC);
     expr->as.prefix_inc.operand = operand;
     return expr;
 }
 
 Expr* expr_prefix_dec(Expr *operand) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_PREFIX_DEC;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_PREFIX_DEC);
     expr->as.prefix_dec.operand = operand;
     return expr;
 }
 
 Expr* expr_postfix_inc(Expr *operand) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_POSTFIX_INC;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_POSTFIX_INC);
     expr->as.postfix_inc.operand = operand;
     return expr;
 }
 
 Expr* expr_postfix_dec(Expr *operand) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_POSTFIX_DEC;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_POSTFIX_DEC);
     expr->as.postfix_dec.operand = operand;
     return expr;
 }
 
 Expr* expr_await(Expr *awaited_expr) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_AWAIT;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_AWAIT);
     expr->as.await_expr.awaited_expr = awaited_expr;
     return expr;
 }
 
 Expr* expr_string_interpolation(char **string_parts, Expr **expr_parts, int num_parts) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_STRING_INTERPOLATION;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_STRING_INTERPOLATION);
     expr->as.string_interpolation.string_parts = string_parts;
     expr->as.string_interpolation.expr_parts = expr_parts;
     expr->as.string_interpolation.num_parts = num_parts;
@@ -235,11 +463,9 @@ Expr* expr_string_interpolation(char **string_parts, Expr **expr_parts, int num_
 }
 
 Expr* expr_optional_chain_property(Expr *object, const char *property) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_OPTIONAL_CHAIN;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_OPTIONAL_CHAIN);
     expr->as.optional_chain.object = object;
-    expr->as.optional_chain.property = strdup(property);
+    expr->as.optional_chain.property = ast_strdup(property);
     expr->as.optional_chain.index = NULL;
     expr->as.optional_chain.args = NULL;
     expr->as.optional_chain.num_args = 0;
@@ -249,9 +475,7 @@ Expr* expr_optional_chain_property(Expr *object, const char *property) {
 }
 
 Expr* expr_optional_chain_index(Expr *object, Expr *index) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_OPTIONAL_CHAIN;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_OPTIONAL_CHAIN);
     expr->as.optional_chain.object = object;
     expr->as.optional_chain.property = NULL;
     expr->as.optional_chain.index = index;
@@ -263,9 +487,7 @@ Expr* expr_optional_chain_index(Expr *object, Expr *index) {
 }
 
 Expr* expr_optional_chain_call(Expr *object, Expr **args, int num_args) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_OPTIONAL_CHAIN;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_OPTIONAL_CHAIN);
     expr->as.optional_chain.object = object;
     expr->as.optional_chain.property = NULL;
     expr->as.optional_chain.index = NULL;
@@ -277,9 +499,7 @@ Expr* expr_optional_chain_call(Expr *object, Expr **args, int num_args) {
 }
 
 Expr* expr_null_coalesce(Expr *left, Expr *right) {
-    Expr *expr = malloc(sizeof(Expr));
-    expr->type = EXPR_NULL_COALESCE;
-    expr->line = 0;
+    Expr *expr = expr_alloc(EXPR_NULL_COALESCE);
     expr->as.null_coalesce.left = left;
     expr->as.null_coalesce.right = right;
     return expr;
@@ -288,7 +508,7 @@ Expr* expr_null_coalesce(Expr *left, Expr *right) {
 // ========== TYPE CONSTRUCTORS ==========
 
 Type* type_new(TypeKind kind) {
-    Type *type = malloc(sizeof(Type));
+    Type *type = ast_alloc(sizeof(Type));
     type->kind = kind;
     type->type_name = NULL;
     type->element_type = NULL;
@@ -296,7 +516,7 @@ Type* type_new(TypeKind kind) {
 }
 
 void type_free(Type *type) {
-    if (type) {
+    if (type && !current_arena) {
         if (type->type_name) {
             free(type->type_name);
         }
@@ -310,10 +530,8 @@ void type_free(Type *type) {
 // ========== STATEMENT CONSTRUCTORS ==========
 
 Stmt* stmt_let_typed(const char *name, Type *type_annotation, Expr *value) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_LET;
-    stmt->line = 0;
-    stmt->as.let.name = strdup(name);
+    Stmt *stmt = stmt_alloc(STMT_LET);
+    stmt->as.let.name = ast_strdup(name);
     stmt->as.let.type_annotation = type_annotation;  // Can be NULL
     stmt->as.let.value = value;
     return stmt;
@@ -324,10 +542,8 @@ Stmt* stmt_let(const char *name, Expr *value) {
 }
 
 Stmt* stmt_const_typed(const char *name, Type *type_annotation, Expr *value) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_CONST;
-    stmt->line = 0;
-    stmt->as.const_stmt.name = strdup(name);
+    Stmt *stmt = stmt_alloc(STMT_CONST);
+    stmt->as.const_stmt.name = ast_strdup(name);
     stmt->as.const_stmt.type_annotation = type_annotation;  // Can be NULL
     stmt->as.const_stmt.value = value;
     return stmt;
@@ -338,9 +554,7 @@ Stmt* stmt_const(const char *name, Expr *value) {
 }
 
 Stmt* stmt_if(Expr *condition, Stmt *then_branch, Stmt *else_branch) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_IF;
-    stmt->line = 0;
+    Stmt *stmt = stmt_alloc(STMT_IF);
     stmt->as.if_stmt.condition = condition;
     stmt->as.if_stmt.then_branch = then_branch;
     stmt->as.if_stmt.else_branch = else_branch;
@@ -348,18 +562,14 @@ Stmt* stmt_if(Expr *condition, Stmt *then_branch, Stmt *else_branch) {
 }
 
 Stmt* stmt_while(Expr *condition, Stmt *body) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_WHILE;
-    stmt->line = 0;
+    Stmt *stmt = stmt_alloc(STMT_WHILE);
     stmt->as.while_stmt.condition = condition;
     stmt->as.while_stmt.body = body;
     return stmt;
 }
 
 Stmt* stmt_for(Stmt *initializer, Expr *condition, Expr *increment, Stmt *body) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_FOR;
-    stmt->line = 0;
+    Stmt *stmt = stmt_alloc(STMT_FOR);
     stmt->as.for_loop.initializer = initializer;
     stmt->as.for_loop.condition = condition;
     stmt->as.for_loop.increment = increment;
@@ -368,9 +578,7 @@ Stmt* stmt_for(Stmt *initializer, Expr *condition, Expr *increment, Stmt *body)
 }
 
 Stmt* stmt_for_in(char *key_var, char *value_var, Expr *iterable, Stmt *body) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_FOR_IN;
-    stmt->line = 0;
+    Stmt *stmt = stmt_alloc(STMT_FOR_IN);
     stmt->as.for_in.key_var = key_var;
     stmt->as.for_in.value_var = value_var;
     stmt->as.for_in.iterable = iterable;
@@ -379,50 +587,38 @@ Stmt* stmt_for_in(char *key_var, char *value_var, Expr *iterable, Stmt *body) {
 }
 
 Stmt* stmt_break(void) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_BREAK;
-    stmt->line = 0;
+    Stmt *stmt = stmt_alloc(STMT_BREAK);
     return stmt;
 }
 
 Stmt* stmt_continue(void) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_CONTINUE;
-    stmt->line = 0;
+    Stmt *stmt = stmt_alloc(STMT_CONTINUE);
     return stmt;
 }
 
 Stmt* stmt_block(Stmt **statements, int count) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_BLOCK;
-    stmt->line = 0;
+    Stmt *stmt = stmt_alloc(STMT_BLOCK);
     stmt->as.block.statements = statements;
     stmt->as.block.count = count;
     return stmt;
 }
 
 Stmt* stmt_expr(Expr *expr) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_EXPR;
-    stmt->line = 0;
+    Stmt *stmt = stmt_alloc(STMT_EXPR);
     stmt->as.expr = expr;
     return stmt;
 }
 
 Stmt* stmt_return(Expr *value) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_RETURN;
-    stmt->line = 0;
+    Stmt *stmt = stmt_alloc(STMT_RETURN);
     stmt->as.return_stmt.value = value;
     return stmt;
 }
 
 Stmt* stmt_define_object(const char *name, char **field_names, Type **field_types,
                          int *field_optional, Expr **field_defaults, int num_fields) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_DEFINE_OBJECT;
-    stmt->line = 0;
-    stmt->as.define_object.name = strdup(name);
+    Stmt *stmt = stmt_alloc(STMT_DEFINE_OBJECT);
+    stmt->as.define_object.name = ast_strdup(name);
     stmt->as.define_object.field_names = field_names;
     stmt->as.define_object.field_types = field_types;
     stmt->as.define_object.field_optional = field_optional;
@@ -432,10 +628,8 @@ Stmt* stmt_define_object(const char *name, char **field_names, Type **field_type
 }
 
 Stmt* stmt_enum(const char *name, char **variant_names, Expr **variant_values, int num_variants) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_ENUM;
-    stmt->line = 0;
-    stmt->as.enum_decl.name = strdup(name);
+    Stmt *stmt = stmt_alloc(STMT_ENUM);
+    stmt->as.enum_decl.name = ast_strdup(name);
     stmt->as.enum_decl.variant_names = variant_names;
     stmt->as.enum_decl.variant_values = variant_values;
     stmt->as.enum_decl.num_variants = num_variants;
@@ -443,9 +637,7 @@ Stmt* stmt_enum(const char *name, char **variant_names, Expr **variant_values, i
 }
 
 Stmt* stmt_try(Stmt *try_block, char *catch_param, Stmt *catch_block, Stmt *finally_block) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_TRY;
-    stmt->line = 0;
+    Stmt *stmt = stmt_alloc(STMT_TRY);
     stmt->as.try_stmt.try_block = try_block;
     stmt->as.try_stmt.catch_param = catch_param;
     stmt->as.try_stmt.catch_block = catch_block;
@@ -454,17 +646,13 @@ Stmt* stmt_try(Stmt *try_block, char *catch_param, Stmt *catch_block, Stmt *fina
 }
 
 Stmt* stmt_throw(Expr *value) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_THROW;
-    stmt->line = 0;
+    Stmt *stmt = stmt_alloc(STMT_THROW);
     stmt->as.throw_stmt.value = value;
     return stmt;
 }
 
 Stmt* stmt_switch(Expr *expr, Expr **case_values, Stmt **case_bodies, int num_cases) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_SWITCH;
-    stmt->line = 0;
+    Stmt *stmt = stmt_alloc(STMT_SWITCH);
     stmt->as.switch_stmt.expr = expr;
     stmt->as.switch_stmt.case_values = case_values;
     stmt->as.switch_stmt.case_bodies = case_bodies;
@@ -473,42 +661,35 @@ Stmt* stmt_switch(Expr *expr, Expr **case_values, Stmt **case_bodies, int num_ca
 }
 
 Stmt* stmt_defer(Expr *call) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_DEFER;
+    Stmt *stmt = stmt_alloc(STMT_DEFER);
     stmt->as.defer_stmt.call = call;
     return stmt;
 }
 
 Stmt* stmt_import_named(char **import_names, char **import_aliases, int num_imports, const char *module_path) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_IMPORT;
-    stmt->line = 0;
+    Stmt *stmt = stmt_alloc(STMT_IMPORT);
     stmt->as.import_stmt.is_namespace = 0;
     stmt->as.import_stmt.namespace_name = NULL;
     stmt->as.import_stmt.import_names = import_names;
     stmt->as.import_stmt.import_aliases = import_aliases;
     stmt->as.import_stmt.num_imports = num_imports;
-    stmt->as.import_stmt.module_path = strdup(module_path);
+    stmt->as.import_stmt.module_path = ast_strdup(module_path);
     return stmt;
 }
 
 Stmt* stmt_import_namespace(const char *namespace_name, const char *module_path) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_IMPORT;
-    stmt->line = 0;
+    Stmt *stmt = stmt_alloc(STMT_IMPORT);
     stmt->as.import_stmt.is_namespace = 1;
-    stmt->as.import_stmt.namespace_name = strdup(namespace_name);
+    stmt->as.import_stmt.namespace_name = ast_strdup(namespace_name);
     stmt->as.import_stmt.import_names = NULL;
     stmt->as.import_stmt.import_aliases = NULL;
     stmt->as.import_stmt.num_imports = 0;
-    stmt->as.import_stmt.module_path = strdup(module_path);
+    stmt->as.import_stmt.module_path = ast_strdup(module_path);
     return stmt;
 }
 
 Stmt* stmt_export_declaration(Stmt *declaration) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_EXPORT;
-    stmt->line = 0;
+    Stmt *stmt = stmt_alloc(STMT_EXPORT);
     stmt->as.export_stmt.is_declaration = 1;
     stmt->as.export_stmt.is_reexport = 0;
     stmt->as.export_stmt.declaration = declaration;
@@ -520,9 +701,7 @@ Stmt* stmt_export_declaration(Stmt *declaration) {
 }
 
 Stmt* stmt_export_list(char **export_names, char **export_aliases, int num_exports) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_EXPORT;
-    stmt->line = 0;
+    Stmt *stmt = stmt_alloc(STMT_EXPORT);
     stmt->as.export_stmt.is_declaration = 0;
     stmt->as.export_stmt.is_reexport = 0;
     stmt->as.export_stmt.declaration = NULL;
@@ -534,32 +713,26 @@ Stmt* stmt_export_list(char **export_names, char **export_aliases, int num_expor
 }
 
 Stmt* stmt_export_reexport(char **export_names, char **export_aliases, int num_exports, const char *module_path) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_EXPORT;
-    stmt->line = 0;
+    Stmt *stmt = stmt_alloc(STMT_EXPORT);
     stmt->as.export_stmt.is_declaration = 0;
     stmt->as.export_stmt.is_reexport = 1;
     stmt->as.export_stmt.declaration = NULL;
     stmt->as.export_stmt.export_names = export_names;
     stmt->as.export_stmt.export_aliases = export_aliases;
     stmt->as.export_stmt.num_exports = num_exports;
-    stmt->as.export_stmt.module_path = strdup(module_path);
+    stmt->as.export_stmt.module_path = ast_strdup(module_path);
     return stmt;
 }
 
 Stmt* stmt_import_ffi(const char *library_path) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_IMPORT_FFI;
-    stmt->line = 0;
-    stmt->as.import_ffi.library_path = strdup(library_path);
+    Stmt *stmt = stmt_alloc(STMT_IMPORT_FFI);
+    stmt->as.import_ffi.library_path = ast_strdup(library_path);
     return stmt;
 }
 
 Stmt* stmt_extern_fn(const char *function_name, Type **param_types, int num_params, Type *return_type) {
-    Stmt *stmt = malloc(sizeof(Stmt));
-    stmt->type = STMT_EXTERN_FN;
-    stmt->line = 0;
-    stmt->as.extern_fn.function_name = strdup(function_name);
+    Stmt *stmt = stmt_alloc(STMT_EXTERN_FN);
+    stmt->as.extern_fn.function_name = ast_strdup(function_name);
     stmt->as.extern_fn.param_types = param_types;
     stmt->as.extern_fn.num_params = num_params;
     stmt->as.extern_fn.return_type = return_type;
@@ -615,7 +788,7 @@ Expr* expr_clone(const Expr *expr) {
             );
 
         case EXPR_CALL: {
-            Expr **args_copy = malloc(sizeof(Expr*) * expr->as.call.num_args);
+            Expr **args_copy = ast_alloc(sizeof(Expr*) * expr->as.call.num_args);
             for (int i = 0; i < expr->as.call.num_args; i++) {
                 args_copy[i] = expr_clone(expr->as.call.args[i]);
             }
@@ -664,7 +837,7 @@ Expr* expr_clone(const Expr *expr) {
             return NULL;
 
         case EXPR_ARRAY_LITERAL: {
-            Expr **elements_copy = malloc(sizeof(Expr*) * expr->as.array_literal.num_elements);
+            Expr **elements_copy = ast_alloc(sizeof(Expr*) * expr->as.array_literal.num_elements);
             for (int i = 0; i < expr->as.array_literal.num_elements; i++) {
                 elements_copy[i] = expr_clone(expr->as.array_literal.elements[i]);
             }
@@ -675,10 +848,10 @@ Expr* expr_clone(const Expr *expr) {
         }
 
         case EXPR_OBJECT_LITERAL: {
-            char **field_names_copy = malloc(sizeof(char*) * expr->as.object_literal.num_fields);
-            Expr **field_values_copy = malloc(sizeof(Expr*) * expr->as.object_literal.num_fields);
+            char **field_names_copy = ast_alloc(sizeof(char*) * expr->as.object_literal.num_fields);
+            Expr **field_values_copy = ast_alloc(sizeof(Expr*) * expr->as.object_literal.num_fields);
             for (int i = 0; i < expr->as.object_literal.num_fields; i++) {
-                field_names_copy[i] = strdup(expr->as.object_literal.field_names[i]);
+                field_names_copy[i] = ast_strdup(expr->as.object_literal.field_names[i]);
                 field_values_copy[i] = expr_clone(expr->as.object_literal.field_values[i]);
             }
             return expr_object_literal(
@@ -706,13 +879,13 @@ Expr* expr_clone(const Expr *expr) {
         case EXPR_STRING_INTERPOLATION: {
             // Clone string parts
             int n = expr->as.string_interpolation.num_parts;
-            char **new_string_parts = malloc(sizeof(char*) * (n + 1));
+            char **new_string_parts = ast_alloc(sizeof(char*) * (n + 1));
             for (int i = 0; i <= n; i++) {
-                new_string_parts[i] = strdup(expr->as.string_interpolation.string_parts[i]);
+                new_string_parts[i] = ast_strdup(expr->as.string_interpolation.string_parts[i]);
             }
 
             // Clone expr parts
-            Expr **new_expr_parts = malloc(sizeof(Expr*) * n);
+            Expr **new_expr_parts = ast_alloc(sizeof(Expr*) * n);
             for (int i = 0; i < n; i++) {
                 new_expr_parts[i] = expr_clone(expr->as.string_interpolation.expr_parts[i]);
             }
@@ -729,7 +902,7 @@ Expr* expr_clone(const Expr *expr) {
             } else if (expr->as.optional_chain.is_call) {
                 Expr **args_copy = NULL;
                 if (expr->as.optional_chain.num_args > 0) {
-                    args_copy = malloc(sizeof(Expr*) * expr->as.optional_chain.num_args);
+                    args_copy = ast_alloc(sizeof(Expr*) * expr->as.optional_chain.num_args);
                     for (int i = 0; i < expr->as.optional_chain.num_args; i++) {
                         args_copy[i] = expr_clone(expr->as.optional_chain.args[i]);
                     }
@@ -758,8 +931,10 @@ Expr* expr_clone(const Expr *expr) {
 
 // ========== CLEANUP ==========
 
+// Arena nodes are released all at once by ast_arena_free
+
 void expr_free(Expr *expr) {
-    if (!expr) return;
+    if (!expr || current_arena) return;
     
     switch (expr->type) {
         case EXPR_IDENT:
@@ -911,7 +1086,7 @@ void expr_free(Expr *expr) {
 }
 
 void stmt_free(Stmt *stmt) {
-    if (!stmt) return;
+    if (!stmt || current_arena) return;
     
     switch (stmt->type) {
         case STMT_LET:
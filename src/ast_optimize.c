@@ -0,0 +1,976 @@
+#include "ast_optimize.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <math.h>
+
+// ========== SETTINGS ==========
+
+static int optimize_on = 1;
+
+void ast_optimize_set_enabled(int enabled) {
+    optimize_on = enabled;
+}
+
+int ast_optimize_enabled(void) {
+    return optimize_on;
+}
+
+// ========== BINDINGS ==========
+
+// A const or enum declaration whose value may be propagated. The first walk
+// over the program only records how each one is used; the second walk
+// rewrites reads that come after the declaration.
+typedef struct {
+    Stmt *decl;            // STMT_CONST or STMT_ENUM
+    int assigned;          // Target of an assignment, ++ or --
+    int read_as_value;     // Read other than as an operand
+    int read_as_object;    // Read other than as the object of `name.member`
+    int ready;             // Second walk has passed the declaration
+    Expr *value;           // Literal held by a const (NULL if not propagated)
+    int32_t *variants;     // Variant values of an enum (NULL if not inlined)
+} OptDecl;
+
+typedef struct {
+    const char *name;
+    OptDecl *decl;         // NULL for bindings that are never propagated
+} OptName;
+
+// One interpreter environment: module, function call, loop iteration or catch
+typedef struct OptScope {
+    OptName *names;
+    int count;
+    int capacity;
+    struct OptScope *parent;
+} OptScope;
+
+typedef struct {
+    int rewrite;           // 0 while recording uses, 1 while rewriting
+    OptScope *scope;
+    OptDecl **decls;       // Open addressing by declaration pointer
+    size_t decl_capacity;
+    size_t decl_count;
+} Optimizer;
+
+// How an identifier is read, which decides whether a literal copy is safe:
+// strings are mutable, so a const string is only copied when every read
+// consumes it as an operand, and an enum namespace object only when it is
+// never used for anything but reading a variant.
+typedef enum {
+    USE_VALUE,      // Stored, passed, returned, mutated...
+    USE_OPERAND,    // Operand of an operator, interpolation part, index read
+    USE_OBJECT,     // Object of a property read
+    USE_TARGET,     // Assigned, incremented or decremented
+} OptUse;
+
+static size_t decl_hash(const Stmt *decl) {
+    return (size_t)(((uintptr_t)decl >> 3) * 0x9E3779B97F4A7C15ULL);
+}
+
+static OptDecl* decl_get(Optimizer *o, Stmt *decl) {
+    if ((o->decl_count + 1) * 2 > o->decl_capacity) {
+        size_t capacity = o->decl_capacity ? o->decl_capacity * 2 : 64;
+        OptDecl **decls = calloc(capacity, sizeof(OptDecl*));
+        for (size_t i = 0; i < o->decl_capacity; i++) {
+            OptDecl *d = o->decls[i];
+            if (d) {
+                size_t j = decl_hash(d->decl) & (capacity - 1);
+                while (decls[j]) {
+                    j = (j + 1) & (capacity - 1);
+                }
+                decls[j] = d;
+            }
+        }
+        free(o->decls);
+        o->decls = decls;
+        o->decl_capacity = capacity;
+    }
+
+    size_t mask = o->decl_capacity - 1;
+    for (size_t i = decl_hash(decl) & mask;; i = (i + 1) & mask) {
+        OptDecl *d = o->decls[i];
+        if (!d) {
+            d = calloc(1, sizeof(OptDecl));
+            d->decl = decl;
+            o->decls[i] = d;
+            o->decl_count++;
+            return d;
+        }
+        if (d->decl == decl) {
+            return d;
+        }
+    }
+}
+
+static void scope_push(Optimizer *o, OptScope *scope) {
+    memset(scope, 0, sizeof(*scope));
+    scope->parent = o->scope;
+    o->scope = scope;
+}
+
+static void scope_pop(Optimizer *o) {
+    OptScope *scope = o->scope;
+    o->scope = scope->parent;
+    free(scope->names);
+}
+
+static int same_name(const char *a, const char *b) {
+    return a == b || (a[0] == b[0] && strcmp(a, b) == 0);
+}
+
+// Declare a name in the current environment. A name declared twice in one
+// environment is never propagated.
+static void scope_declare(Optimizer *o, const char *name, Stmt *decl) {
+    OptScope *scope = o->scope;
+    for (int i = 0; i < scope->count; i++) {
+        if (same_name(scope->names[i].name, name)) {
+            scope->names[i].decl = NULL;
+            return;
+        }
+    }
+    if (scope->count >= scope->capacity) {
+        scope->capacity = scope->capacity ? scope->capacity * 2 : 16;
+        scope->names = realloc(scope->names, sizeof(OptName) * scope->capacity);
+    }
+    scope->names[scope->count].name = name;
+    scope->names[scope->count].decl = decl ? decl_get(o, decl) : NULL;
+    scope->count++;
+}
+
+static OptName* scope_lookup(Optimizer *o, const char *name) {
+    for (OptScope *scope = o->scope; scope; scope = scope->parent) {
+        for (int i = 0; i < scope->count; i++) {
+            if (same_name(scope->names[i].name, name)) {
+                return &scope->names[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+// Binding a declaration statement introduces, if it is still propagatable
+static OptDecl* scope_decl_for(Optimizer *o, const char *name, Stmt *decl) {
+    OptName *binding = scope_lookup(o, name);
+    if (binding && binding->decl && binding->decl->decl == decl) {
+        return binding->decl;
+    }
+    return NULL;
+}
+
+// Declare the names a statement binds in the current environment. Blocks,
+// if/else, switch and try/finally run in the enclosing environment, so their
+// declarations land there too, but only the environment's own statement
+// list (top_level) runs unconditionally and may define a propagated value.
+static void collect_decls(Optimizer *o, Stmt *stmt, int top_level) {
+    if (!stmt) return;
+
+    switch (stmt->type) {
+        case STMT_LET:
+            scope_declare(o, stmt->as.let.name, NULL);
+            break;
+        case STMT_CONST:
+            scope_declare(o, stmt->as.const_stmt.name,
+                          top_level && !stmt->as.const_stmt.type_annotation ? stmt : NULL);
+            break;
+        case STMT_ENUM:
+            scope_declare(o, stmt->as.enum_decl.name, top_level ? stmt : NULL);
+            break;
+        case STMT_EXTERN_FN:
+            scope_declare(o, stmt->as.extern_fn.function_name, NULL);
+            break;
+        case STMT_IMPORT:
+            if (stmt->as.import_stmt.is_namespace) {
+                scope_declare(o, stmt->as.import_stmt.namespace_name, NULL);
+            } else {
+                for (int i = 0; i < stmt->as.import_stmt.num_imports; i++) {
+                    const char *alias = stmt->as.import_stmt.import_aliases
+                                        ? stmt->as.import_stmt.import_aliases[i] : NULL;
+                    scope_declare(o, alias ? alias : stmt->as.import_stmt.import_names[i], NULL);
+                }
+            }
+            break;
+        case STMT_EXPORT:
+            if (stmt->as.export_stmt.is_declaration) {
+                collect_decls(o, stmt->as.export_stmt.declaration, top_level);
+            }
+            break;
+        case STMT_BLOCK:
+            for (int i = 0; i < stmt->as.block.count; i++) {
+                collect_decls(o, stmt->as.block.statements[i], 0);
+            }
+            break;
+        case STMT_IF:
+            collect_decls(o, stmt->as.if_stmt.then_branch, 0);
+            collect_decls(o, stmt->as.if_stmt.else_branch, 0);
+            break;
+        case STMT_SWITCH:
+            for (int i = 0; i < stmt->as.switch_stmt.num_cases; i++) {
+                collect_decls(o, stmt->as.switch_stmt.case_bodies[i], 0);
+            }
+            break;
+        case STMT_TRY:
+            collect_decls(o, stmt->as.try_stmt.try_block, 0);
+            collect_decls(o, stmt->as.try_stmt.finally_block, 0);
+            break;
+        default:
+            break;
+    }
+}
+
+// ========== LITERALS ==========
+
+static int fits_i32(int64_t value) {
+    return value >= INT32_MIN && value <= INT32_MAX;
+}
+
+static int is_int_literal(const Expr *expr) {
+    return expr->type == EXPR_NUMBER && !expr->as.number.is_float;
+}
+
+static int is_literal(const Expr *expr) {
+    switch (expr->type) {
+        case EXPR_NUMBER:
+        case EXPR_BOOL:
+        case EXPR_STRING:
+        case EXPR_RUNE:
+        case EXPR_NULL:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// Text of a literal as print() and interpolation format it, or NULL
+static char* literal_text(const Expr *expr) {
+    char buffer[64];
+    switch (expr->type) {
+        case EXPR_STRING:
+            return strdup(expr->as.string);
+        case EXPR_BOOL:
+            return strdup(expr->as.boolean ? "true" : "false");
+        case EXPR_NUMBER:
+            if (expr->as.number.is_float) {
+                snprintf(buffer, sizeof(buffer), "%g", expr->as.number.float_value);
+            } else if (fits_i32(expr->as.number.int_value)) {
+                snprintf(buffer, sizeof(buffer), "%d", (int32_t)expr->as.number.int_value);
+            } else {
+                snprintf(buffer, sizeof(buffer), "%" PRId64, expr->as.number.int_value);
+            }
+            return strdup(buffer);
+        default:
+            return NULL;
+    }
+}
+
+static char* concat(const char *a, const char *b) {
+    size_t a_len = strlen(a);
+    size_t b_len = strlen(b);
+    char *result = malloc(a_len + b_len + 1);
+    memcpy(result, a, a_len);
+    memcpy(result + a_len, b, b_len + 1);
+    return result;
+}
+
+static Expr* string_literal(char *text) {
+    Expr *expr = expr_string(text);
+    free(text);
+    return expr;
+}
+
+// Put a new node in place of an old one, keeping its source line
+static Expr* replace_expr(Expr *old, Expr *with) {
+    with->line = old->line;
+    expr_free(old);
+    return with;
+}
+
+// ========== FOLDING ==========
+
+// An integer literal is i32 when it fits and i64 otherwise (see EXPR_NUMBER
+// in the interpreter), so a folded value is only kept when it lands on the
+// same side of the i32 range as the operation's result type.
+static Expr* fold_int(int64_t value, int wide) {
+    if (fits_i32(value) == wide) {
+        return NULL;
+    }
+    return expr_number_int(value);
+}
+
+static Expr* fold_ints(BinaryOp op, int64_t l, int64_t r, int wide) {
+    int64_t value;
+    switch (op) {
+        case OP_ADD:
+            return __builtin_add_overflow(l, r, &value) ? NULL : fold_int(value, wide);
+        case OP_SUB:
+            return __builtin_sub_overflow(l, r, &value) ? NULL : fold_int(value, wide);
+        case OP_MUL:
+            return __builtin_mul_overflow(l, r, &value) ? NULL : fold_int(value, wide);
+        case OP_DIV:
+        case OP_MOD:
+            // Division by zero stays a runtime error
+            if (r == 0 || (l == INT64_MIN && r == -1)) return NULL;
+            return fold_int(op == OP_DIV ? l / r : l % r, wide);
+        case OP_EQUAL:          return expr_bool(l == r);
+        case OP_NOT_EQUAL:      return expr_bool(l != r);
+        case OP_LESS:           return expr_bool(l < r);
+        case OP_LESS_EQUAL:     return expr_bool(l <= r);
+        case OP_GREATER:        return expr_bool(l > r);
+        case OP_GREATER_EQUAL:  return expr_bool(l >= r);
+        case OP_BIT_AND:        return fold_int(l & r, wide);
+        case OP_BIT_OR:         return fold_int(l | r, wide);
+        case OP_BIT_XOR:        return fold_int(l ^ r, wide);
+        case OP_BIT_LSHIFT:
+            if (l < 0 || r < 0 || r >= (wide ? 63 : 31) || l > (INT64_MAX >> r)) return NULL;
+            return fold_int(l << r, wide);
+        case OP_BIT_RSHIFT:
+            if (l < 0 || r < 0 || r >= (wide ? 64 : 32)) return NULL;
+            return fold_int(l >> r, wide);
+        default:
+            return NULL;
+    }
+}
+
+// Any float operand promotes the operation to f64
+static Expr* fold_floats(BinaryOp op, double l, double r) {
+    double value;
+    switch (op) {
+        case OP_ADD: value = l + r; break;
+        case OP_SUB: value = l - r; break;
+        case OP_MUL: value = l * r; break;
+        case OP_DIV:
+            if (r == 0.0) return NULL;
+            value = l / r;
+            break;
+        case OP_EQUAL:          return expr_bool(l == r);
+        case OP_NOT_EQUAL:      return expr_bool(l != r);
+        case OP_LESS:           return expr_bool(l < r);
+        case OP_LESS_EQUAL:     return expr_bool(l <= r);
+        case OP_GREATER:        return expr_bool(l > r);
+        case OP_GREATER_EQUAL:  return expr_bool(l >= r);
+        default:
+            return NULL;
+    }
+    return isfinite(value) ? expr_number_float(value) : NULL;
+}
+
+static double number_as_double(const Expr *expr) {
+    return expr->as.number.is_float ? expr->as.number.float_value
+                                    : (double)expr->as.number.int_value;
+}
+
+static Expr* fold_binary(Expr *expr) {
+    Expr *left = expr->as.binary.left;
+    Expr *right = expr->as.binary.right;
+    BinaryOp op = expr->as.binary.op;
+
+    if (left->type == EXPR_NUMBER && right->type == EXPR_NUMBER) {
+        if (left->as.number.is_float || right->as.number.is_float) {
+            return fold_floats(op, number_as_double(left), number_as_double(right));
+        }
+        int64_t l = left->as.number.int_value;
+        int64_t r = right->as.number.int_value;
+        return fold_ints(op, l, r, !fits_i32(l) || !fits_i32(r));
+    }
+
+    if (left->type == EXPR_BOOL && right->type == EXPR_BOOL) {
+        int l = left->as.boolean;
+        int r = right->as.boolean;
+        switch (op) {
+            case OP_EQUAL:      return expr_bool(l == r);
+            case OP_NOT_EQUAL:  return expr_bool(l != r);
+            case OP_AND:        return expr_bool(l && r);
+            case OP_OR:         return expr_bool(l || r);
+            default:            return NULL;
+        }
+    }
+
+    if (left->type == EXPR_STRING && right->type == EXPR_STRING) {
+        switch (op) {
+            case OP_ADD:
+                return string_literal(concat(left->as.string, right->as.string));
+            case OP_EQUAL:
+                return expr_bool(strcmp(left->as.string, right->as.string) == 0);
+            case OP_NOT_EQUAL:
+                return expr_bool(strcmp(left->as.string, right->as.string) != 0);
+            default:
+                return NULL;
+        }
+    }
+
+    // String + number or bool formats the other operand like print()
+    if (op == OP_ADD && (left->type == EXPR_STRING || right->type == EXPR_STRING)) {
+        const Expr *other = left->type == EXPR_STRING ? right : left;
+        if (other->type != EXPR_NUMBER && other->type != EXPR_BOOL) {
+            return NULL;
+        }
+        char *text = literal_text(other);
+        char *result = left->type == EXPR_STRING ? concat(left->as.string, text)
+                                                 : concat(text, right->as.string);
+        free(text);
+        return string_literal(result);
+    }
+
+    return NULL;
+}
+
+static Expr* fold_unary(Expr *expr) {
+    Expr *operand = expr->as.unary.operand;
+
+    switch (expr->as.unary.op) {
+        case UNARY_NOT:
+            if (operand->type == EXPR_BOOL) {
+                return expr_bool(!operand->as.boolean);
+            }
+            return NULL;
+
+        case UNARY_NEGATE:
+            if (operand->type != EXPR_NUMBER) return NULL;
+            if (operand->as.number.is_float) {
+                return expr_number_float(-operand->as.number.float_value);
+            }
+            if (operand->as.number.int_value == INT64_MIN) return NULL;
+            return fold_int(-operand->as.number.int_value, !fits_i32(operand->as.number.int_value));
+
+        case UNARY_BIT_NOT:
+            if (!is_int_literal(operand)) return NULL;
+            return fold_int(~operand->as.number.int_value, !fits_i32(operand->as.number.int_value));
+    }
+    return NULL;
+}
+
+// Merge literal interpolation parts into the surrounding text
+static Expr* fold_interpolation(Expr *expr) {
+    int num_parts = expr->as.string_interpolation.num_parts;
+    char **string_parts = expr->as.string_interpolation.string_parts;
+    Expr **expr_parts = expr->as.string_interpolation.expr_parts;
+
+    int kept = 0;
+    for (int i = 0; i < num_parts; i++) {
+        Expr *part = expr_parts[i];
+        if (part->type != EXPR_STRING && part->type != EXPR_NUMBER && part->type != EXPR_BOOL) {
+            kept++;
+        }
+    }
+    if (kept == num_parts) {
+        return expr;
+    }
+
+    char **new_strings = ast_alloc(sizeof(char*) * (kept + 1));
+    Expr **new_exprs = kept ? ast_alloc(sizeof(Expr*) * kept) : NULL;
+    int count = 0;
+    char *text = strdup(string_parts[0]);
+    for (int i = 0; i < num_parts; i++) {
+        char *part_text = literal_text(expr_parts[i]);
+        if (part_text) {
+            char *joined = concat(text, part_text);
+            free(text);
+            free(part_text);
+            text = joined;
+        } else {
+            new_strings[count] = ast_strdup(text);
+            new_exprs[count] = expr_parts[i];
+            expr_parts[i] = NULL;  // Moved to the new node
+            count++;
+            free(text);
+            text = strdup("");
+        }
+        char *joined = concat(text, string_parts[i + 1]);
+        free(text);
+        text = joined;
+    }
+
+    if (count == 0) {
+        ast_free(new_strings);
+        return replace_expr(expr, string_literal(text));
+    }
+    new_strings[count] = ast_strdup(text);
+    free(text);
+    return replace_expr(expr, expr_string_interpolation(new_strings, new_exprs, count));
+}
+
+// ========== WALK ==========
+
+static Expr* opt_expr(Optimizer *o, Expr *expr, OptUse use);
+static Stmt* opt_stmt(Optimizer *o, Stmt *stmt, int top_level);
+
+// Statements that run directly in a new environment (function, loop and
+// catch bodies)
+static Stmt* opt_body(Optimizer *o, Stmt *body) {
+    if (!body) return NULL;
+    if (body->type != STMT_BLOCK) {
+        collect_decls(o, body, 1);
+        return opt_stmt(o, body, 1);
+    }
+    for (int i = 0; i < body->as.block.count; i++) {
+        collect_decls(o, body->as.block.statements[i], 1);
+    }
+    for (int i = 0; i < body->as.block.count; i++) {
+        body->as.block.statements[i] = opt_stmt(o, body->as.block.statements[i], 1);
+    }
+    return body;
+}
+
+static Expr* opt_ident(Optimizer *o, Expr *expr, OptUse use) {
+    OptName *binding = scope_lookup(o, expr->as.ident);
+    OptDecl *decl = binding ? binding->decl : NULL;
+    if (!decl) {
+        return expr;
+    }
+    if (!o->rewrite) {
+        if (use == USE_TARGET) decl->assigned = 1;
+        if (use != USE_OPERAND) decl->read_as_value = 1;
+        if (use != USE_OBJECT) decl->read_as_object = 1;
+        return expr;
+    }
+    if (use == USE_TARGET || !decl->ready || !decl->value) {
+        return expr;
+    }
+    return replace_expr(expr, expr_clone(decl->value));
+}
+
+// Operand of ++/--: the place itself is never rewritten
+static Expr* opt_target(Optimizer *o, Expr *target) {
+    switch (target->type) {
+        case EXPR_IDENT:
+            return opt_ident(o, target, USE_TARGET);
+        case EXPR_GET_PROPERTY:
+            target->as.get_property.object = opt_expr(o, target->as.get_property.object, USE_VALUE);
+            return target;
+        case EXPR_INDEX:
+            target->as.index.object = opt_expr(o, target->as.index.object, USE_VALUE);
+            target->as.index.index = opt_expr(o, target->as.index.index, USE_OPERAND);
+            return target;
+        default:
+            return opt_expr(o, target, USE_VALUE);
+    }
+}
+
+// `Enum.VARIANT` of an inlined enum, or NULL
+static Expr* enum_variant(Optimizer *o, Expr *expr) {
+    Expr *object = expr->as.get_property.object;
+    if (object->type != EXPR_IDENT) return NULL;
+    OptName *binding = scope_lookup(o, object->as.ident);
+    OptDecl *decl = binding ? binding->decl : NULL;
+    if (!decl || !decl->ready || !decl->variants) return NULL;
+
+    Stmt *enum_decl = decl->decl;
+    for (int i = 0; i < enum_decl->as.enum_decl.num_variants; i++) {
+        if (strcmp(enum_decl->as.enum_decl.variant_names[i], expr->as.get_property.property) == 0) {
+            return expr_number_int(decl->variants[i]);
+        }
+    }
+    return NULL;
+}
+
+static Expr* opt_expr(Optimizer *o, Expr *expr, OptUse use) {
+    if (!expr) return NULL;
+
+    switch (expr->type) {
+        case EXPR_NUMBER:
+        case EXPR_BOOL:
+        case EXPR_STRING:
+        case EXPR_RUNE:
+        case EXPR_NULL:
+            return expr;
+
+        case EXPR_IDENT:
+            return opt_ident(o, expr, use);
+
+        case EXPR_ASSIGN: {
+            OptName *binding = scope_lookup(o, expr->as.assign.name);
+            if (binding && binding->decl) {
+                binding->decl->assigned = 1;
+            }
+            expr->as.assign.value = opt_expr(o, expr->as.assign.value, USE_VALUE);
+            return expr;
+        }
+
+        case EXPR_BINARY: {
+            expr->as.binary.left = opt_expr(o, expr->as.binary.left, USE_OPERAND);
+            expr->as.binary.right = opt_expr(o, expr->as.binary.right, USE_OPERAND);
+            Expr *folded = o->rewrite ? fold_binary(expr) : NULL;
+            return folded ? replace_expr(expr, folded) : expr;
+        }
+
+        case EXPR_UNARY: {
+            expr->as.unary.operand = opt_expr(o, expr->as.unary.operand, USE_OPERAND);
+            Expr *folded = o->rewrite ? fold_unary(expr) : NULL;
+            return folded ? replace_expr(expr, folded) : expr;
+        }
+
+        case EXPR_TERNARY: {
+            expr->as.ternary.condition = opt_expr(o, expr->as.ternary.condition, USE_OPERAND);
+            Expr *condition = expr->as.ternary.condition;
+            if (o->rewrite && condition->type == EXPR_BOOL) {
+                Expr **taken = condition->as.boolean ? &expr->as.ternary.true_expr
+                                                     : &expr->as.ternary.false_expr;
+                Expr *kept = *taken;
+                *taken = NULL;
+                expr_free(expr);
+                return opt_expr(o, kept, use);
+            }
+            expr->as.ternary.true_expr = opt_expr(o, expr->as.ternary.true_expr, USE_VALUE);
+            expr->as.ternary.false_expr = opt_expr(o, expr->as.ternary.false_expr, USE_VALUE);
+            return expr;
+        }
+
+        case EXPR_CALL: {
+            // Method calls may mutate their object
+            Expr *func = expr->as.call.func;
+            if (func->type == EXPR_GET_PROPERTY) {
+                func->as.get_property.object = opt_expr(o, func->as.get_property.object, USE_VALUE);
+            } else {
+                expr->as.call.func = opt_expr(o, func, USE_VALUE);
+            }
+            for (int i = 0; i < expr->as.call.num_args; i++) {
+                expr->as.call.args[i] = opt_expr(o, expr->as.call.args[i], USE_VALUE);
+            }
+            return expr;
+        }
+
+        case EXPR_GET_PROPERTY: {
+            Expr *variant = o->rewrite ? enum_variant(o, expr) : NULL;
+            if (variant) {
+                return replace_expr(expr, variant);
+            }
+            expr->as.get_property.object = opt_expr(o, expr->as.get_property.object, USE_OBJECT);
+            return expr;
+        }
+
+        case EXPR_SET_PROPERTY:
+            expr->as.set_property.object = opt_expr(o, expr->as.set_property.object, USE_VALUE);
+            expr->as.set_property.value = opt_expr(o, expr->as.set_property.value, USE_VALUE);
+            return expr;
+
+        case EXPR_INDEX:
+            expr->as.index.object = opt_expr(o, expr->as.index.object, USE_OPERAND);
+            expr->as.index.index = opt_expr(o, expr->as.index.index, USE_OPERAND);
+            return expr;
+
+        case EXPR_INDEX_ASSIGN:
+            expr->as.index_assign.object = opt_expr(o, expr->as.index_assign.object, USE_VALUE);
+            expr->as.index_assign.index = opt_expr(o, expr->as.index_assign.index, USE_OPERAND);
+            expr->as.index_assign.value = opt_expr(o, expr->as.index_assign.value, USE_VALUE);
+            return expr;
+
+        case EXPR_FUNCTION: {
+            // Bodies still encoded in a lazily loaded image are left alone
+            if (!expr->as.function.body) {
+                return expr;
+            }
+            OptScope scope;
+            scope_push(o, &scope);
+            scope_declare(o, "self", NULL);
+            for (int i = 0; i < expr->as.function.num_params; i++) {
+                scope_declare(o, expr->as.function.param_names[i], NULL);
+            }
+            for (int i = 0; i < expr->as.function.num_params; i++) {
+                expr->as.function.param_defaults[i] =
+                    opt_expr(o, expr->as.function.param_defaults[i], USE_VALUE);
+            }
+            expr->as.function.body = opt_body(o, expr->as.function.body);
+            scope_pop(o);
+            return expr;
+        }
+
+        case EXPR_ARRAY_LITERAL:
+            for (int i = 0; i < expr->as.array_literal.num_elements; i++) {
+                expr->as.array_literal.elements[i] =
+                    opt_expr(o, expr->as.array_literal.elements[i], USE_VALUE);
+            }
+            return expr;
+
+        case EXPR_OBJECT_LITERAL:
+            for (int i = 0; i < expr->as.object_literal.num_fields; i++) {
+                expr->as.object_literal.field_values[i] =
+                    opt_expr(o, expr->as.object_literal.field_values[i], USE_VALUE);
+            }
+            return expr;
+
+        case EXPR_PREFIX_INC:
+            expr->as.prefix_inc.operand = opt_target(o, expr->as.prefix_inc.operand);
+            return expr;
+        case EXPR_PREFIX_DEC:
+            expr->as.prefix_dec.operand = opt_target(o, expr->as.prefix_dec.operand);
+            return expr;
+        case EXPR_POSTFIX_INC:
+            expr->as.postfix_inc.operand = opt_target(o, expr->as.postfix_inc.operand);
+            return expr;
+        case EXPR_POSTFIX_DEC:
+            expr->as.postfix_dec.operand = opt_target(o, expr->as.postfix_dec.operand);
+            return expr;
+
+        case EXPR_AWAIT:
+            expr->as.await_expr.awaited_expr = opt_expr(o, expr->as.await_expr.awaited_expr, USE_VALUE);
+            return expr;
+
+        case EXPR_STRING_INTERPOLATION:
+            for (int i = 0; i < expr->as.string_interpolation.num_parts; i++) {
+                expr->as.string_interpolation.expr_parts[i] =
+                    opt_expr(o, expr->as.string_interpolation.expr_parts[i], USE_OPERAND);
+            }
+            return o->rewrite ? fold_interpolation(expr) : expr;
+
+        case EXPR_OPTIONAL_CHAIN:
+            expr->as.optional_chain.object = opt_expr(o, expr->as.optional_chain.object, USE_VALUE);
+            expr->as.optional_chain.index = opt_expr(o, expr->as.optional_chain.index, USE_OPERAND);
+            for (int i = 0; i < expr->as.optional_chain.num_args; i++) {
+                expr->as.optional_chain.args[i] =
+                    opt_expr(o, expr->as.optional_chain.args[i], USE_VALUE);
+            }
+            return expr;
+
+        case EXPR_NULL_COALESCE: {
+            expr->as.null_coalesce.left = opt_expr(o, expr->as.null_coalesce.left, USE_VALUE);
+            expr->as.null_coalesce.right = opt_expr(o, expr->as.null_coalesce.right, USE_VALUE);
+            Expr *left = expr->as.null_coalesce.left;
+            if (o->rewrite && is_literal(left)) {
+                Expr **taken = left->type == EXPR_NULL ? &expr->as.null_coalesce.right
+                                                       : &expr->as.null_coalesce.left;
+                Expr *kept = *taken;
+                *taken = NULL;
+                expr_free(expr);
+                return kept;
+            }
+            return expr;
+        }
+    }
+    return expr;
+}
+
+static Stmt* empty_block(Stmt *old) {
+    Stmt *block = stmt_block(NULL, 0);
+    block->line = old->line;
+    stmt_free(old);
+    return block;
+}
+
+// A const's value may stand in for its reads once it is a literal; strings
+// additionally need every read to be an operand (see OptUse)
+static void define_const(Optimizer *o, Stmt *stmt) {
+    OptDecl *decl = scope_decl_for(o, stmt->as.const_stmt.name, stmt);
+    if (!decl) return;
+    Expr *value = stmt->as.const_stmt.value;
+    if (!decl->assigned && is_literal(value) &&
+        (value->type != EXPR_STRING || !decl->read_as_value)) {
+        decl->value = value;
+    }
+    decl->ready = 1;
+}
+
+// Variant values are computed like the interpreter does: explicit values
+// must be i32 and later variants count up from the last one
+static void define_enum(Optimizer *o, Stmt *stmt) {
+    OptDecl *decl = scope_decl_for(o, stmt->as.enum_decl.name, stmt);
+    if (!decl) return;
+    decl->ready = 1;
+    if (decl->assigned || decl->read_as_object) return;
+
+    int num_variants = stmt->as.enum_decl.num_variants;
+    int32_t *variants = malloc(sizeof(int32_t) * (num_variants ? num_variants : 1));
+    int64_t next = 0;
+    for (int i = 0; i < num_variants; i++) {
+        Expr *value = stmt->as.enum_decl.variant_values[i];
+        if (value) {
+            if (!is_int_literal(value) || !fits_i32(value->as.number.int_value)) {
+                free(variants);
+                return;
+            }
+            next = value->as.number.int_value;
+        } else if (!fits_i32(next)) {
+            free(variants);
+            return;
+        }
+        variants[i] = (int32_t)next;
+        next++;
+    }
+    decl->variants = variants;
+}
+
+static Stmt* opt_stmt(Optimizer *o, Stmt *stmt, int top_level) {
+    if (!stmt) return NULL;
+
+    switch (stmt->type) {
+        case STMT_LET:
+            stmt->as.let.value = opt_expr(o, stmt->as.let.value, USE_VALUE);
+            return stmt;
+
+        case STMT_CONST:
+            stmt->as.const_stmt.value = opt_expr(o, stmt->as.const_stmt.value, USE_VALUE);
+            if (o->rewrite && top_level) {
+                define_const(o, stmt);
+            }
+            return stmt;
+
+        case STMT_EXPR:
+            stmt->as.expr = opt_expr(o, stmt->as.expr, USE_VALUE);
+            return stmt;
+
+        case STMT_IF: {
+            stmt->as.if_stmt.condition = opt_expr(o, stmt->as.if_stmt.condition, USE_OPERAND);
+            Expr *condition = stmt->as.if_stmt.condition;
+            if (o->rewrite && condition->type == EXPR_BOOL) {
+                // Branches share the enclosing environment, so the taken
+                // branch can stand on its own
+                Stmt **taken = condition->as.boolean ? &stmt->as.if_stmt.then_branch
+                                                     : &stmt->as.if_stmt.else_branch;
+                Stmt *kept = *taken;
+                *taken = NULL;
+                if (!kept) {
+                    return empty_block(stmt);
+                }
+                stmt_free(stmt);
+                return opt_stmt(o, kept, 0);
+            }
+            stmt->as.if_stmt.then_branch = opt_stmt(o, stmt->as.if_stmt.then_branch, 0);
+            stmt->as.if_stmt.else_branch = opt_stmt(o, stmt->as.if_stmt.else_branch, 0);
+            return stmt;
+        }
+
+        case STMT_WHILE: {
+            stmt->as.while_stmt.condition = opt_expr(o, stmt->as.while_stmt.condition, USE_OPERAND);
+            Expr *condition = stmt->as.while_stmt.condition;
+            if (o->rewrite && condition->type == EXPR_BOOL && !condition->as.boolean) {
+                return empty_block(stmt);
+            }
+            OptScope scope;
+            scope_push(o, &scope);
+            stmt->as.while_stmt.body = opt_body(o, stmt->as.while_stmt.body);
+            scope_pop(o);
+            return stmt;
+        }
+
+        case STMT_FOR: {
+            OptScope loop_scope;
+            scope_push(o, &loop_scope);
+            collect_decls(o, stmt->as.for_loop.initializer, 1);
+            stmt->as.for_loop.initializer = opt_stmt(o, stmt->as.for_loop.initializer, 1);
+            stmt->as.for_loop.condition = opt_expr(o, stmt->as.for_loop.condition, USE_OPERAND);
+            OptScope body_scope;
+            scope_push(o, &body_scope);
+            stmt->as.for_loop.body = opt_body(o, stmt->as.for_loop.body);
+            scope_pop(o);
+            stmt->as.for_loop.increment = opt_expr(o, stmt->as.for_loop.increment, USE_VALUE);
+            scope_pop(o);
+            return stmt;
+        }
+
+        case STMT_FOR_IN: {
+            stmt->as.for_in.iterable = opt_expr(o, stmt->as.for_in.iterable, USE_VALUE);
+            OptScope scope;
+            scope_push(o, &scope);
+            if (stmt->as.for_in.key_var) {
+                scope_declare(o, stmt->as.for_in.key_var, NULL);
+            }
+            scope_declare(o, stmt->as.for_in.value_var, NULL);
+            stmt->as.for_in.body = opt_body(o, stmt->as.for_in.body);
+            scope_pop(o);
+            return stmt;
+        }
+
+        case STMT_BLOCK:
+            for (int i = 0; i < stmt->as.block.count; i++) {
+                stmt->as.block.statements[i] = opt_stmt(o, stmt->as.block.statements[i], 0);
+            }
+            return stmt;
+
+        case STMT_RETURN:
+            stmt->as.return_stmt.value = opt_expr(o, stmt->as.return_stmt.value, USE_VALUE);
+            return stmt;
+
+        case STMT_ENUM:
+            for (int i = 0; i < stmt->as.enum_decl.num_variants; i++) {
+                stmt->as.enum_decl.variant_values[i] =
+                    opt_expr(o, stmt->as.enum_decl.variant_values[i], USE_VALUE);
+            }
+            if (o->rewrite && top_level) {
+                define_enum(o, stmt);
+            }
+            return stmt;
+
+        case STMT_TRY:
+            stmt->as.try_stmt.try_block = opt_stmt(o, stmt->as.try_stmt.try_block, 0);
+            if (stmt->as.try_stmt.catch_block) {
+                OptScope scope;
+                scope_push(o, &scope);
+                if (stmt->as.try_stmt.catch_param) {
+                    scope_declare(o, stmt->as.try_stmt.catch_param, NULL);
+                }
+                stmt->as.try_stmt.catch_block = opt_body(o, stmt->as.try_stmt.catch_block);
+                scope_pop(o);
+            }
+            stmt->as.try_stmt.finally_block = opt_stmt(o, stmt->as.try_stmt.finally_block, 0);
+            return stmt;
+
+        case STMT_THROW:
+            stmt->as.throw_stmt.value = opt_expr(o, stmt->as.throw_stmt.value, USE_VALUE);
+            return stmt;
+
+        case STMT_SWITCH:
+            stmt->as.switch_stmt.expr = opt_expr(o, stmt->as.switch_stmt.expr, USE_VALUE);
+            for (int i = 0; i < stmt->as.switch_stmt.num_cases; i++) {
+                stmt->as.switch_stmt.case_values[i] =
+                    opt_expr(o, stmt->as.switch_stmt.case_values[i], USE_VALUE);
+                stmt->as.switch_stmt.case_bodies[i] =
+                    opt_stmt(o, stmt->as.switch_stmt.case_bodies[i], 0);
+            }
+            return stmt;
+
+        case STMT_DEFER:
+            stmt->as.defer_stmt.call = opt_expr(o, stmt->as.defer_stmt.call, USE_VALUE);
+            return stmt;
+
+        case STMT_EXPORT:
+            if (stmt->as.export_stmt.is_declaration) {
+                stmt->as.export_stmt.declaration =
+                    opt_stmt(o, stmt->as.export_stmt.declaration, top_level);
+            }
+            return stmt;
+
+        // Object type field defaults are evaluated wherever an instance is
+        // built, so they are left as written
+        case STMT_DEFINE_OBJECT:
+        case STMT_BREAK:
+        case STMT_CONTINUE:
+        case STMT_IMPORT:
+        case STMT_IMPORT_FFI:
+        case STMT_EXTERN_FN:
+            return stmt;
+    }
+    return stmt;
+}
+
+// ========== ENTRY POINT ==========
+
+// Walk the module twice with the same scopes: the first walk records how
+// every const and enum is used, the second rewrites the tree.
+static void opt_program(Optimizer *o, Stmt **statements, int count) {
+    OptScope scope;
+    scope_push(o, &scope);
+    for (int i = 0; i < count; i++) {
+        collect_decls(o, statements[i], 1);
+    }
+    for (int i = 0; i < count; i++) {
+        statements[i] = opt_stmt(o, statements[i], 1);
+    }
+    scope_pop(o);
+}
+
+void ast_optimize(Stmt **statements, int count) {
+    if (!optimize_on || !statements) return;
+
+    Optimizer o = {0};
+    opt_program(&o, statements, count);
+    o.rewrite = 1;
+    opt_program(&o, statements, count);
+
+    for (size_t i = 0; i < o.decl_capacity; i++) {
+        if (o.decls[i]) {
+            free(o.decls[i]->variants);
+            free(o.decls[i]);
+        }
+    }
+    free(o.decls);
+}
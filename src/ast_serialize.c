@@ -2,6 +2,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <pthread.h>
+#include <zlib.h>
 
 // ========== INTERNAL HELPERS ==========
 
@@ -12,6 +14,31 @@
 // Marker for NULL pointers in serialized data
 #define NULL_MARKER 0xFF
 
+// Size of the fixed header; the checksum covers everything after it
+#define HEADER_SIZE 20
+#define CHECKSUM_OFFSET 16
+
+// ========== LAZY BODIES ==========
+
+// A function body left encoded in an image
+struct LazyBody {
+    HmlcImage *image;
+    size_t offset;           // Start of the encoded body in the image data
+    uint32_t size;           // Encoded size
+    Stmt *body;              // Decoded body, published with release ordering
+};
+
+struct HmlcImage {
+    const uint8_t *data;     // Borrowed image data
+    size_t data_size;
+    char **strings;          // String table, shared by every body
+    uint32_t string_count;
+    uint16_t flags;
+    uint16_t version;
+    AstArena *arena;         // Arena the bodies are decoded into
+    pthread_mutex_t lock;    // Serializes decoding (and so use of the arena)
+};
+
 // ========== STRING TABLE ==========
 
 static void string_table_init(StringTable *table) {
@@ -130,6 +157,13 @@ static void write_bytes(SerializeContext *ctx, const void *data, size_t len) {
     ctx->buffer_size += len;
 }
 
+// Overwrite a u32 written earlier (used for sizes known only afterwards)
+static void patch_u32(SerializeContext *ctx, size_t at, uint32_t val) {
+    for (int i = 0; i < 4; i++) {
+        ctx->buffer[at + i] = (uint8_t)(val >> (i * 8));
+    }
+}
+
 // ========== DESERIALIZATION CONTEXT ==========
 
 static void dctx_init(DeserializeContext *ctx, const uint8_t *data, size_t size) {
@@ -139,6 +173,8 @@ static void dctx_init(DeserializeContext *ctx, const uint8_t *data, size_t size)
     ctx->strings = NULL;
     ctx->string_count = 0;
     ctx->flags = 0;
+    ctx->version = HMLC_VERSION;
+    ctx->image = NULL;
 }
 
 static void dctx_free(DeserializeContext *ctx) {
@@ -205,7 +241,7 @@ static char* read_string_id(DeserializeContext *ctx) {
     uint32_t id = read_u32(ctx);
     if (id == UINT32_MAX) return NULL;
     if (id >= ctx->string_count) return NULL;
-    return strdup(ctx->strings[id]);
+    return ast_strdup(ctx->strings[id]);
 }
 
 // ========== FORWARD DECLARATIONS ==========
@@ -243,7 +279,7 @@ static Type* deserialize_type(DeserializeContext *ctx) {
     uint8_t kind_byte = read_u8(ctx);
     if (kind_byte == NULL_MARKER) return NULL;
 
-    Type *type = malloc(sizeof(Type));
+    Type *type = ast_alloc(sizeof(Type));
     type->kind = (TypeKind)kind_byte;
     type->type_name = NULL;
     type->element_type = NULL;
@@ -356,7 +392,7 @@ static void serialize_expr(SerializeContext *ctx, Expr *expr) {
             serialize_expr(ctx, expr->as.index_assign.value);
             break;
 
-        case EXPR_FUNCTION:
+        case EXPR_FUNCTION: {
             write_u8(ctx, expr->as.function.is_async ? 1 : 0);
             write_u32(ctx, (uint32_t)expr->as.function.num_params);
             for (int i = 0; i < expr->as.function.num_params; i++) {
@@ -365,8 +401,17 @@ static void serialize_expr(SerializeContext *ctx, Expr *expr) {
                 serialize_expr(ctx, expr->as.function.param_defaults ? expr->as.function.param_defaults[i] : NULL);
             }
             serialize_type(ctx, expr->as.function.return_type);
-            serialize_stmt(ctx, expr->as.function.body);
+            Stmt *body = expr->as.function.body;
+            if (!body && expr->as.function.lazy_body) {
+                body = lazy_body_load(expr->as.function.lazy_body);
+            }
+            // Body size first, so loaders can skip the body
+            size_t size_at = ctx->buffer_size;
+            write_u32(ctx, 0);
+            serialize_stmt(ctx, body);
+            patch_u32(ctx, size_at, (uint32_t)(ctx->buffer_size - size_at - 4));
             break;
+        }
 
         case EXPR_ARRAY_LITERAL:
             write_u32(ctx, (uint32_t)expr->as.array_literal.num_elements);
@@ -442,8 +487,10 @@ static Expr* deserialize_expr(DeserializeContext *ctx) {
     uint8_t type_byte = read_u8(ctx);
     if (type_byte == NULL_MARKER) return NULL;
 
-    Expr *expr = malloc(sizeof(Expr));
-    memset(expr, 0, sizeof(Expr));
+    // Nodes only get room for their own variant, as in the parser
+    size_t size = expr_node_size((ExprType)type_byte);
+    Expr *expr = ast_alloc(size);
+    memset(expr, 0, size);
     expr->type = (ExprType)type_byte;
 
     // Read line number if debug info present
@@ -504,7 +551,7 @@ static Expr* deserialize_expr(DeserializeContext *ctx) {
             expr->as.call.func = deserialize_expr(ctx);
             expr->as.call.num_args = (int)read_u32(ctx);
             if (expr->as.call.num_args > 0) {
-                expr->as.call.args = malloc(expr->as.call.num_args * sizeof(Expr*));
+                expr->as.call.args = ast_alloc(expr->as.call.num_args * sizeof(Expr*));
                 for (int i = 0; i < expr->as.call.num_args; i++) {
                     expr->as.call.args[i] = deserialize_expr(ctx);
                 }
@@ -544,9 +591,9 @@ static Expr* deserialize_expr(DeserializeContext *ctx) {
             expr->as.function.is_async = read_u8(ctx);
             expr->as.function.num_params = (int)read_u32(ctx);
             if (expr->as.function.num_params > 0) {
-                expr->as.function.param_names = malloc(expr->as.function.num_params * sizeof(char*));
-                expr->as.function.param_types = malloc(expr->as.function.num_params * sizeof(Type*));
-                expr->as.function.param_defaults = malloc(expr->as.function.num_params * sizeof(Expr*));
+                expr->as.function.param_names = ast_alloc(expr->as.function.num_params * sizeof(char*));
+                expr->as.function.param_types = ast_alloc(expr->as.function.num_params * sizeof(Type*));
+                expr->as.function.param_defaults = ast_alloc(expr->as.function.num_params * sizeof(Expr*));
                 for (int i = 0; i < expr->as.function.num_params; i++) {
                     expr->as.function.param_names[i] = read_string_id(ctx);
                     expr->as.function.param_types[i] = deserialize_type(ctx);
@@ -558,6 +605,20 @@ static Expr* deserialize_expr(DeserializeContext *ctx) {
                 expr->as.function.param_defaults = NULL;
             }
             expr->as.function.return_type = deserialize_type(ctx);
+            if (ctx->version >= 2) {
+                uint32_t body_size = read_u32(ctx);
+                if (ctx->image && dctx_has_bytes(ctx, body_size)) {
+                    // Leave the body encoded until the function is called
+                    LazyBody *lazy = ast_alloc(sizeof(LazyBody));
+                    lazy->image = ctx->image;
+                    lazy->offset = ctx->offset;
+                    lazy->size = body_size;
+                    lazy->body = NULL;
+                    expr->as.function.lazy_body = lazy;
+                    ctx->offset += body_size;
+                    break;
+                }
+            }
             expr->as.function.body = deserialize_stmt(ctx);
             break;
         }
@@ -565,7 +626,7 @@ static Expr* deserialize_expr(DeserializeContext *ctx) {
         case EXPR_ARRAY_LITERAL:
             expr->as.array_literal.num_elements = (int)read_u32(ctx);
             if (expr->as.array_literal.num_elements > 0) {
-                expr->as.array_literal.elements = malloc(expr->as.array_literal.num_elements * sizeof(Expr*));
+                expr->as.array_literal.elements = ast_alloc(expr->as.array_literal.num_elements * sizeof(Expr*));
                 for (int i = 0; i < expr->as.array_literal.num_elements; i++) {
                     expr->as.array_literal.elements[i] = deserialize_expr(ctx);
                 }
@@ -577,8 +638,8 @@ static Expr* deserialize_expr(DeserializeContext *ctx) {
         case EXPR_OBJECT_LITERAL:
             expr->as.object_literal.num_fields = (int)read_u32(ctx);
             if (expr->as.object_literal.num_fields > 0) {
-                expr->as.object_literal.field_names = malloc(expr->as.object_literal.num_fields * sizeof(char*));
-                expr->as.object_literal.field_values = malloc(expr->as.object_literal.num_fields * sizeof(Expr*));
+                expr->as.object_literal.field_names = ast_alloc(expr->as.object_literal.num_fields * sizeof(char*));
+                expr->as.object_literal.field_values = ast_alloc(expr->as.object_literal.num_fields * sizeof(Expr*));
                 for (int i = 0; i < expr->as.object_literal.num_fields; i++) {
                     expr->as.object_literal.field_names[i] = read_string_id(ctx);
                     expr->as.object_literal.field_values[i] = deserialize_expr(ctx);
@@ -612,8 +673,8 @@ static Expr* deserialize_expr(DeserializeContext *ctx) {
         case EXPR_STRING_INTERPOLATION: {
             expr->as.string_interpolation.num_parts = (int)read_u32(ctx);
             int n = expr->as.string_interpolation.num_parts;
-            expr->as.string_interpolation.string_parts = malloc((n + 1) * sizeof(char*));
-            expr->as.string_interpolation.expr_parts = malloc(n * sizeof(Expr*));
+            expr->as.string_interpolation.string_parts = ast_alloc((n + 1) * sizeof(char*));
+            expr->as.string_interpolation.expr_parts = ast_alloc(n * sizeof(Expr*));
             for (int i = 0; i <= n; i++) {
                 expr->as.string_interpolation.string_parts[i] = read_string_id(ctx);
             }
@@ -637,7 +698,7 @@ static Expr* deserialize_expr(DeserializeContext *ctx) {
                 expr->as.optional_chain.index = NULL;
                 expr->as.optional_chain.num_args = (int)read_u32(ctx);
                 if (expr->as.optional_chain.num_args > 0) {
-                    expr->as.optional_chain.args = malloc(expr->as.optional_chain.num_args * sizeof(Expr*));
+                    expr->as.optional_chain.args = ast_alloc(expr->as.optional_chain.num_args * sizeof(Expr*));
                     for (int i = 0; i < expr->as.optional_chain.num_args; i++) {
                         expr->as.optional_chain.args[i] = deserialize_expr(ctx);
                     }
@@ -821,8 +882,9 @@ static Stmt* deserialize_stmt(DeserializeContext *ctx) {
     uint8_t type_byte = read_u8(ctx);
     if (type_byte == NULL_MARKER) return NULL;
 
-    Stmt *stmt = malloc(sizeof(Stmt));
-    memset(stmt, 0, sizeof(Stmt));
+    size_t size = stmt_node_size((StmtType)type_byte);
+    Stmt *stmt = ast_alloc(size);
+    memset(stmt, 0, size);
     stmt->type = (StmtType)type_byte;
 
     // Read line number if debug info present
@@ -882,7 +944,7 @@ static Stmt* deserialize_stmt(DeserializeContext *ctx) {
         case STMT_BLOCK:
             stmt->as.block.count = (int)read_u32(ctx);
             if (stmt->as.block.count > 0) {
-                stmt->as.block.statements = malloc(stmt->as.block.count * sizeof(Stmt*));
+                stmt->as.block.statements = ast_alloc(stmt->as.block.count * sizeof(Stmt*));
                 for (int i = 0; i < stmt->as.block.count; i++) {
                     stmt->as.block.statements[i] = deserialize_stmt(ctx);
                 }
@@ -900,10 +962,10 @@ static Stmt* deserialize_stmt(DeserializeContext *ctx) {
             stmt->as.define_object.num_fields = (int)read_u32(ctx);
             int n = stmt->as.define_object.num_fields;
             if (n > 0) {
-                stmt->as.define_object.field_names = malloc(n * sizeof(char*));
-                stmt->as.define_object.field_types = malloc(n * sizeof(Type*));
-                stmt->as.define_object.field_optional = malloc(n * sizeof(int));
-                stmt->as.define_object.field_defaults = malloc(n * sizeof(Expr*));
+                stmt->as.define_object.field_names = ast_alloc(n * sizeof(char*));
+                stmt->as.define_object.field_types = ast_alloc(n * sizeof(Type*));
+                stmt->as.define_object.field_optional = ast_alloc(n * sizeof(int));
+                stmt->as.define_object.field_defaults = ast_alloc(n * sizeof(Expr*));
                 for (int i = 0; i < n; i++) {
                     stmt->as.define_object.field_names[i] = read_string_id(ctx);
                     stmt->as.define_object.field_types[i] = deserialize_type(ctx);
@@ -924,8 +986,8 @@ static Stmt* deserialize_stmt(DeserializeContext *ctx) {
             stmt->as.enum_decl.num_variants = (int)read_u32(ctx);
             int n = stmt->as.enum_decl.num_variants;
             if (n > 0) {
-                stmt->as.enum_decl.variant_names = malloc(n * sizeof(char*));
-                stmt->as.enum_decl.variant_values = malloc(n * sizeof(Expr*));
+                stmt->as.enum_decl.variant_names = ast_alloc(n * sizeof(char*));
+                stmt->as.enum_decl.variant_values = ast_alloc(n * sizeof(Expr*));
                 for (int i = 0; i < n; i++) {
                     stmt->as.enum_decl.variant_names[i] = read_string_id(ctx);
                     stmt->as.enum_decl.variant_values[i] = deserialize_expr(ctx);
@@ -953,8 +1015,8 @@ static Stmt* deserialize_stmt(DeserializeContext *ctx) {
             stmt->as.switch_stmt.num_cases = (int)read_u32(ctx);
             int n = stmt->as.switch_stmt.num_cases;
             if (n > 0) {
-                stmt->as.switch_stmt.case_values = malloc(n * sizeof(Expr*));
-                stmt->as.switch_stmt.case_bodies = malloc(n * sizeof(Stmt*));
+                stmt->as.switch_stmt.case_values = ast_alloc(n * sizeof(Expr*));
+                stmt->as.switch_stmt.case_bodies = ast_alloc(n * sizeof(Stmt*));
                 for (int i = 0; i < n; i++) {
                     stmt->as.switch_stmt.case_values[i] = deserialize_expr(ctx);
                     stmt->as.switch_stmt.case_bodies[i] = deserialize_stmt(ctx);
@@ -977,8 +1039,8 @@ static Stmt* deserialize_stmt(DeserializeContext *ctx) {
             stmt->as.import_stmt.num_imports = (int)read_u32(ctx);
             int n = stmt->as.import_stmt.num_imports;
             if (n > 0) {
-                stmt->as.import_stmt.import_names = malloc(n * sizeof(char*));
-                stmt->as.import_stmt.import_aliases = malloc(n * sizeof(char*));
+                stmt->as.import_stmt.import_names = ast_alloc(n * sizeof(char*));
+                stmt->as.import_stmt.import_aliases = ast_alloc(n * sizeof(char*));
                 for (int i = 0; i < n; i++) {
                     stmt->as.import_stmt.import_names[i] = read_string_id(ctx);
                     stmt->as.import_stmt.import_aliases[i] = read_string_id(ctx);
@@ -998,8 +1060,8 @@ static Stmt* deserialize_stmt(DeserializeContext *ctx) {
             stmt->as.export_stmt.num_exports = (int)read_u32(ctx);
             int n = stmt->as.export_stmt.num_exports;
             if (n > 0) {
-                stmt->as.export_stmt.export_names = malloc(n * sizeof(char*));
-                stmt->as.export_stmt.export_aliases = malloc(n * sizeof(char*));
+                stmt->as.export_stmt.export_names = ast_alloc(n * sizeof(char*));
+                stmt->as.export_stmt.export_aliases = ast_alloc(n * sizeof(char*));
                 for (int i = 0; i < n; i++) {
                     stmt->as.export_stmt.export_names[i] = read_string_id(ctx);
                     stmt->as.export_stmt.export_aliases[i] = read_string_id(ctx);
@@ -1020,7 +1082,7 @@ static Stmt* deserialize_stmt(DeserializeContext *ctx) {
             stmt->as.extern_fn.num_params = (int)read_u32(ctx);
             int n = stmt->as.extern_fn.num_params;
             if (n > 0) {
-                stmt->as.extern_fn.param_types = malloc(n * sizeof(Type*));
+                stmt->as.extern_fn.param_types = ast_alloc(n * sizeof(Type*));
                 for (int i = 0; i < n; i++) {
                     stmt->as.extern_fn.param_types[i] = deserialize_type(ctx);
                 }
@@ -1077,6 +1139,13 @@ uint8_t* ast_serialize(Stmt **statements, int stmt_count, uint16_t flags, size_t
 
     free(ast_data);
 
+    // Fill in the checksum now that the body is complete
+    uint32_t checksum = (uint32_t)crc32(0L, ctx.buffer + HEADER_SIZE,
+                                        (uInt)(ctx.buffer_size - HEADER_SIZE));
+    for (int i = 0; i < 4; i++) {
+        ctx.buffer[CHECKSUM_OFFSET + i] = (uint8_t)(checksum >> (i * 8));
+    }
+
     *out_size = ctx.buffer_size;
     uint8_t *result = ctx.buffer;
 
@@ -1085,21 +1154,27 @@ uint8_t* ast_serialize(Stmt **statements, int stmt_count, uint16_t flags, size_t
     return result;
 }
 
-Stmt** ast_deserialize(const uint8_t *data, size_t data_size, int *out_count) {
+// Decode a whole blob. With an image, function bodies are left encoded and
+// the string table moves to the image.
+static Stmt** deserialize_program(const uint8_t *data, size_t data_size, int *out_count,
+                                  HmlcImage *image, const char **error) {
     DeserializeContext ctx;
     dctx_init(&ctx, data, data_size);
 
     // Read and validate header
+    if (data_size < HEADER_SIZE) {
+        *error = "truncated header";
+        return NULL;
+    }
     uint32_t magic = read_u32(&ctx);
     if (magic != HMLC_MAGIC) {
-        fprintf(stderr, "Error: Invalid .hmlc file (bad magic number)\n");
+        *error = "bad magic number";
         return NULL;
     }
 
-    uint16_t version = read_u16(&ctx);
-    if (version > HMLC_VERSION) {
-        fprintf(stderr, "Error: .hmlc file version %d is newer than supported version %d\n",
-                version, HMLC_VERSION);
+    ctx.version = read_u16(&ctx);
+    if (ctx.version > HMLC_VERSION) {
+        *error = "newer format version";
         return NULL;
     }
 
@@ -1107,31 +1182,152 @@ Stmt** ast_deserialize(const uint8_t *data, size_t data_size, int *out_count) {
     ctx.string_count = read_u32(&ctx);
     uint32_t stmt_count = read_u32(&ctx);
     uint32_t checksum = read_u32(&ctx);
-    (void)checksum;  // TODO: validate checksum
+
+    // A zero checksum means none was computed
+    if (checksum != 0 &&
+        checksum != (uint32_t)crc32(0L, data + HEADER_SIZE, (uInt)(data_size - HEADER_SIZE))) {
+        *error = "checksum mismatch";
+        return NULL;
+    }
+
+    // Every string needs a length and every statement at least a tag byte
+    size_t remaining = data_size - HEADER_SIZE;
+    if (ctx.string_count > remaining / 4 || stmt_count > remaining) {
+        *error = "counts exceed data size";
+        return NULL;
+    }
 
     // Read string table
-    ctx.strings = malloc(ctx.string_count * sizeof(char*));
-    for (uint32_t i = 0; i < ctx.string_count; i++) {
+    uint32_t string_count = ctx.string_count;
+    ctx.strings = malloc((string_count ? string_count : 1) * sizeof(char*));
+    ctx.string_count = 0;
+    for (uint32_t i = 0; i < string_count; i++) {
         uint32_t len = read_u32(&ctx);
-        char *str = malloc(len + 1);
-        if (dctx_has_bytes(&ctx, len)) {
-            memcpy(str, ctx.data + ctx.offset, len);
-            ctx.offset += len;
+        if (!dctx_has_bytes(&ctx, len)) {
+            dctx_free(&ctx);
+            *error = "truncated string table";
+            return NULL;
         }
+        char *str = malloc(len + 1);
+        memcpy(str, ctx.data + ctx.offset, len);
+        ctx.offset += len;
         str[len] = '\0';
-        ctx.strings[i] = str;
+        ctx.strings[ctx.string_count++] = str;
+    }
+
+    if (image) {
+        image->data = data;
+        image->data_size = data_size;
+        image->flags = ctx.flags;
+        image->version = ctx.version;
+        ctx.image = image;
     }
 
     // Deserialize statements
-    Stmt **statements = malloc(stmt_count * sizeof(Stmt*));
+    Stmt **statements = ast_alloc((stmt_count ? stmt_count : 1) * sizeof(Stmt*));
     for (uint32_t i = 0; i < stmt_count; i++) {
         statements[i] = deserialize_stmt(&ctx);
     }
 
+    // Reads past the end return zeros, so a short body shows up here
+    if (ctx.offset != data_size) {
+        dctx_free(&ctx);
+        for (uint32_t i = 0; i < stmt_count; i++) {
+            if (statements[i]) {
+                stmt_free(statements[i]);
+            }
+        }
+        ast_free(statements);
+        *error = "body does not match its length";
+        return NULL;
+    }
+
+    if (image) {
+        image->strings = ctx.strings;
+        image->string_count = ctx.string_count;
+    } else {
+        dctx_free(&ctx);
+    }
+
     *out_count = (int)stmt_count;
+    return statements;
+}
+
+Stmt** ast_try_deserialize(const uint8_t *data, size_t data_size, int *out_count,
+                           const char **error) {
+    return deserialize_program(data, data_size, out_count, NULL, error);
+}
+
+Stmt** ast_deserialize_lazy(const uint8_t *data, size_t data_size, int *out_count,
+                            HmlcImage **image) {
+    HmlcImage *img = calloc(1, sizeof(HmlcImage));
+    img->arena = ast_arena_current();
+    pthread_mutex_init(&img->lock, NULL);
+
+    const char *error = NULL;
+    Stmt **statements = deserialize_program(data, data_size, out_count, img, &error);
+    if (statements == NULL) {
+        fprintf(stderr, "Error: Invalid .hmlc data (%s)\n", error);
+        hmlc_image_free(img);
+        *image = NULL;
+        return NULL;
+    }
+    *image = img;
+    return statements;
+}
+
+Stmt* lazy_body_load(LazyBody *lazy) {
+    Stmt *body = __atomic_load_n(&lazy->body, __ATOMIC_ACQUIRE);
+    if (body) {
+        return body;
+    }
+
+    HmlcImage *image = lazy->image;
+    pthread_mutex_lock(&image->lock);
+    body = lazy->body;
+    if (!body) {
+        DeserializeContext ctx;
+        dctx_init(&ctx, image->data, lazy->offset + lazy->size);
+        ctx.offset = lazy->offset;
+        ctx.strings = image->strings;
+        ctx.string_count = image->string_count;
+        ctx.flags = image->flags;
+        ctx.version = image->version;
+        ctx.image = image;
+
+        AstArena *previous = ast_arena_use(image->arena);
+        body = deserialize_stmt(&ctx);
+        ast_arena_use(previous);
+
+        // The body must end exactly where its recorded size says
+        if (ctx.offset != ctx.data_size) {
+            body = NULL;
+        } else {
+            __atomic_store_n(&lazy->body, body, __ATOMIC_RELEASE);
+        }
+    }
+    pthread_mutex_unlock(&image->lock);
+    return body;
+}
 
-    dctx_free(&ctx);
+void hmlc_image_free(HmlcImage *image) {
+    if (!image) return;
+    if (image->strings) {
+        for (uint32_t i = 0; i < image->string_count; i++) {
+            free(image->strings[i]);
+        }
+        free(image->strings);
+    }
+    pthread_mutex_destroy(&image->lock);
+    free(image);
+}
 
+Stmt** ast_deserialize(const uint8_t *data, size_t data_size, int *out_count) {
+    const char *error = NULL;
+    Stmt **statements = ast_try_deserialize(data, data_size, out_count, &error);
+    if (statements == NULL) {
+        fprintf(stderr, "Error: Invalid .hmlc data (%s)\n", error);
+    }
     return statements;
 }
 
@@ -9,6 +9,8 @@
 #include "../include/parser.h"
 #include "../include/lexer.h"
 #include "../include/ast_serialize.h"
+#include "../include/ast_optimize.h"
+#include "../include/fnv1a.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -115,8 +117,8 @@ static char* resolve_import_path(BundleContext *ctx, const char *importer_path,
     return absolute;
 }
 
-// Parse a module file
-static Stmt** parse_file(const char *path, int *stmt_count) {
+// Parse a module file into the bundle's arena
+static Stmt** parse_file(const char *path, int *stmt_count, AstArena *arena) {
     FILE *file = fopen(path, "r");
     if (!file) {
         fprintf(stderr, "Error: Cannot open file '%s'\n", path);
@@ -139,7 +141,12 @@ static Stmt** parse_file(const char *path, int *stmt_count) {
     Parser parser;
     parser_init(&parser, &lexer);
 
+    AstArena *previous = ast_arena_use(arena);
     Stmt **statements = parse_program(&parser, stmt_count);
+    if (!parser.had_error) {
+        ast_optimize(statements, *stmt_count);
+    }
+    ast_arena_use(previous);
     free(source);
 
     if (parser.had_error) {
@@ -197,18 +204,23 @@ static BundledModule* load_module_for_bundle(BundleContext *ctx, const char *abs
     module->is_flattened = 0;
     module->export_names = NULL;
     module->num_exports = 0;
+    module->imports = NULL;
+    module->removed = NULL;
+    module->num_removed = 0;
 
     // Add to bundle immediately (for cycle detection)
     add_module_to_bundle(ctx->bundle, module);
 
     // Parse the file
-    module->statements = parse_file(absolute_path, &module->num_statements);
+    module->statements = parse_file(absolute_path, &module->num_statements, ctx->bundle->arena);
     if (!module->statements) {
         return NULL;
     }
 
     // Collect exports
     collect_exports(module);
+    module->imports = calloc(module->num_statements ? module->num_statements : 1,
+                             sizeof(BundledModule*));
 
     // Recursively load imported modules
     for (int i = 0; i < module->num_statements; i++) {
@@ -228,6 +240,7 @@ static BundledModule* load_module_for_bundle(BundleContext *ctx, const char *abs
                         stmt->as.import_stmt.module_path, absolute_path);
                 return NULL;
             }
+            module->imports[i] = imported;
         }
         else if (stmt->type == STMT_EXPORT && stmt->as.export_stmt.is_reexport) {
             char *resolved = resolve_import_path(ctx, absolute_path, stmt->as.export_stmt.module_path);
@@ -241,6 +254,7 @@ static BundledModule* load_module_for_bundle(BundleContext *ctx, const char *abs
             if (!reexported) {
                 return NULL;
             }
+            module->imports[i] = reexported;
         }
     }
 
@@ -318,55 +332,8 @@ static int flatten_module(Bundle *bundle, BundledModule *module) {
 
     // First, flatten all dependencies
     for (int i = 0; i < module->num_statements; i++) {
-        Stmt *stmt = module->statements[i];
-
-        if (stmt->type == STMT_IMPORT) {
-            // Find the imported module by matching the import path
-            const char *import_path = stmt->as.import_stmt.module_path;
-
-            // Skip leading "./" for relative paths
-            if (strncmp(import_path, "./", 2) == 0) {
-                import_path += 2;
-            }
-
-            for (int j = 0; j < bundle->num_modules; j++) {
-                BundledModule *dep = bundle->modules[j];
-
-                // Match by checking if the module's path ends with the import path
-                // For @stdlib/X, match /stdlib/X.hml
-                // For relative paths, match the basename
-                int matches = 0;
-
-                if (strncmp(import_path, "@stdlib/", 8) == 0) {
-                    // Check for stdlib module: look for /stdlib/module_name.hml
-                    const char *module_name = import_path + 8;  // Skip "@stdlib/"
-                    char expected[256];
-                    snprintf(expected, sizeof(expected), "/stdlib/%s.hml", module_name);
-                    if (strstr(dep->absolute_path, expected)) {
-                        matches = 1;
-                    }
-                } else {
-                    // For relative imports, check if absolute path ends with /import_path.hml
-                    size_t path_len = strlen(dep->absolute_path);
-
-                    // Build expected suffix: /module_name.hml
-                    char expected_suffix[256];
-                    snprintf(expected_suffix, sizeof(expected_suffix), "/%s.hml", import_path);
-                    size_t suffix_len = strlen(expected_suffix);
-
-                    if (path_len >= suffix_len) {
-                        const char *actual_suffix = dep->absolute_path + path_len - suffix_len;
-                        if (strcmp(actual_suffix, expected_suffix) == 0) {
-                            matches = 1;
-                        }
-                    }
-                }
-
-                if (matches) {
-                    flatten_module(bundle, dep);
-                    break;
-                }
-            }
+        if (module->statements[i]->type == STMT_IMPORT && module->imports[i]) {
+            flatten_module(bundle, module->imports[i]);
         }
     }
 
@@ -375,7 +342,8 @@ static int flatten_module(Bundle *bundle, BundledModule *module) {
         Stmt *stmt = module->statements[i];
 
         // Skip import statements (dependencies already flattened)
-        if (stmt->type == STMT_IMPORT) {
+        // and declarations removed by tree shaking
+        if (stmt->type == STMT_IMPORT || (module->removed && module->removed[i])) {
             continue;
         }
 
@@ -396,12 +364,527 @@ static int flatten_module(Bundle *bundle, BundledModule *module) {
     return 0;
 }
 
+// ========== TREE SHAKING ==========
+
+// Flattening puts every module in one global scope, so reachability is
+// tracked by name: each top-level name maps to the statements that declare
+// it and to the names it stands for (import and export aliases). Roots are
+// the entry module and every statement that may have a side effect; walking
+// a kept statement marks each identifier and type name in it, including
+// those inside function bodies and object methods. Names are not resolved
+// against local scopes, so a local that shadows a global keeps the global
+// alive; that only costs size, never correctness.
+
+typedef struct {
+    Stmt *stmt;
+    unsigned char *keep;         // Keep flag of the statement in its module
+} ShakeDecl;
+
+typedef struct {
+    const char *name;
+    ShakeDecl *decls;
+    int num_decls;
+    int decl_capacity;
+    const char **aliases;        // Names this one refers to
+    int num_aliases;
+    int alias_capacity;
+    int marked;
+} ShakeName;
+
+typedef struct {
+    ShakeName *slots;            // Open addressing, name == NULL when empty
+    int capacity;
+    int count;
+    ShakeName **pending;         // Marked names whose declarations are not walked yet
+    int num_pending;
+    int pending_capacity;
+} ShakeGraph;
+
+static void shake_stmt(ShakeGraph *graph, Stmt *stmt);
+
+static uint32_t shake_hash(const char *name) {
+    return (uint32_t)hml_fnv1a64(name, strlen(name), HML_FNV1A64_OFFSET);
+}
+
+static ShakeName* shake_find(ShakeGraph *graph, const char *name, int create) {
+    if (create && (graph->count + 1) * 2 > graph->capacity) {
+        // Grow at half load
+        ShakeName *old = graph->slots;
+        int old_capacity = graph->capacity;
+        graph->capacity = old_capacity ? old_capacity * 2 : 256;
+        graph->slots = calloc(graph->capacity, sizeof(ShakeName));
+        for (int i = 0; i < old_capacity; i++) {
+            if (old[i].name) {
+                uint32_t j = shake_hash(old[i].name) & (graph->capacity - 1);
+                while (graph->slots[j].name) {
+                    j = (j + 1) & (graph->capacity - 1);
+                }
+                graph->slots[j] = old[i];
+            }
+        }
+        free(old);
+    }
+    if (graph->capacity == 0) {
+        return NULL;
+    }
+
+    uint32_t i = shake_hash(name) & (graph->capacity - 1);
+    while (graph->slots[i].name) {
+        if (strcmp(graph->slots[i].name, name) == 0) {
+            return &graph->slots[i];
+        }
+        i = (i + 1) & (graph->capacity - 1);
+    }
+    if (!create) {
+        return NULL;
+    }
+    graph->slots[i].name = name;
+    graph->count++;
+    return &graph->slots[i];
+}
+
+static void shake_add_decl(ShakeGraph *graph, const char *name, Stmt *stmt, unsigned char *keep) {
+    ShakeName *entry = shake_find(graph, name, 1);
+    if (entry->num_decls >= entry->decl_capacity) {
+        entry->decl_capacity = entry->decl_capacity ? entry->decl_capacity * 2 : 2;
+        entry->decls = realloc(entry->decls, sizeof(ShakeDecl) * entry->decl_capacity);
+    }
+    entry->decls[entry->num_decls].stmt = stmt;
+    entry->decls[entry->num_decls].keep = keep;
+    entry->num_decls++;
+}
+
+static void shake_add_alias(ShakeGraph *graph, const char *name, const char *target) {
+    ShakeName *entry = shake_find(graph, name, 1);
+    if (entry->num_aliases >= entry->alias_capacity) {
+        entry->alias_capacity = entry->alias_capacity ? entry->alias_capacity * 2 : 2;
+        entry->aliases = realloc(entry->aliases, sizeof(char*) * entry->alias_capacity);
+    }
+    entry->aliases[entry->num_aliases++] = target;
+}
+
+// Mark a name as used; its declarations are walked by shake_run
+static void shake_mark(ShakeGraph *graph, const char *name) {
+    if (!name) {
+        return;
+    }
+    ShakeName *entry = shake_find(graph, name, 0);
+    if (!entry || entry->marked) {
+        return;
+    }
+    entry->marked = 1;
+    if (graph->num_pending >= graph->pending_capacity) {
+        graph->pending_capacity = graph->pending_capacity ? graph->pending_capacity * 2 : 64;
+        graph->pending = realloc(graph->pending, sizeof(ShakeName*) * graph->pending_capacity);
+    }
+    graph->pending[graph->num_pending++] = entry;
+}
+
+static void shake_type(ShakeGraph *graph, Type *type) {
+    for (; type; type = type->element_type) {
+        shake_mark(graph, type->type_name);
+    }
+}
+
+static void shake_expr(ShakeGraph *graph, Expr *expr) {
+    if (!expr) {
+        return;
+    }
+    switch (expr->type) {
+        case EXPR_NUMBER:
+        case EXPR_BOOL:
+        case EXPR_STRING:
+        case EXPR_RUNE:
+        case EXPR_NULL:
+            break;
+        case EXPR_IDENT:
+            shake_mark(graph, expr->as.ident);
+            break;
+        case EXPR_BINARY:
+            shake_expr(graph, expr->as.binary.left);
+            shake_expr(graph, expr->as.binary.right);
+            break;
+        case EXPR_UNARY:
+            shake_expr(graph, expr->as.unary.operand);
+            break;
+        case EXPR_TERNARY:
+            shake_expr(graph, expr->as.ternary.condition);
+            shake_expr(graph, expr->as.ternary.true_expr);
+            shake_expr(graph, expr->as.ternary.false_expr);
+            break;
+        case EXPR_CALL:
+            shake_expr(graph, expr->as.call.func);
+            for (int i = 0; i < expr->as.call.num_args; i++) {
+                shake_expr(graph, expr->as.call.args[i]);
+            }
+            break;
+        case EXPR_ASSIGN:
+            shake_mark(graph, expr->as.assign.name);
+            shake_expr(graph, expr->as.assign.value);
+            break;
+        case EXPR_GET_PROPERTY:
+            shake_expr(graph, expr->as.get_property.object);
+            break;
+        case EXPR_SET_PROPERTY:
+            shake_expr(graph, expr->as.set_property.object);
+            shake_expr(graph, expr->as.set_property.value);
+            break;
+        case EXPR_INDEX:
+            shake_expr(graph, expr->as.index.object);
+            shake_expr(graph, expr->as.index.index);
+            break;
+        case EXPR_INDEX_ASSIGN:
+            shake_expr(graph, expr->as.index_assign.object);
+            shake_expr(graph, expr->as.index_assign.index);
+            shake_expr(graph, expr->as.index_assign.value);
+            break;
+        case EXPR_FUNCTION:
+            for (int i = 0; i < expr->as.function.num_params; i++) {
+                if (expr->as.function.param_types) {
+                    shake_type(graph, expr->as.function.param_types[i]);
+                }
+                if (expr->as.function.param_defaults) {
+                    shake_expr(graph, expr->as.function.param_defaults[i]);
+                }
+            }
+            shake_type(graph, expr->as.function.return_type);
+            shake_stmt(graph, expr->as.function.body);
+            break;
+        case EXPR_ARRAY_LITERAL:
+            for (int i = 0; i < expr->as.array_literal.num_elements; i++) {
+                shake_expr(graph, expr->as.array_literal.elements[i]);
+            }
+            break;
+        case EXPR_OBJECT_LITERAL:
+            // Methods are function values, so their bodies are walked here
+            for (int i = 0; i < expr->as.object_literal.num_fields; i++) {
+                shake_expr(graph, expr->as.object_literal.field_values[i]);
+            }
+            break;
+        case EXPR_PREFIX_INC:
+            shake_expr(graph, expr->as.prefix_inc.operand);
+            break;
+        case EXPR_PREFIX_DEC:
+            shake_expr(graph, expr->as.prefix_dec.operand);
+            break;
+        case EXPR_POSTFIX_INC:
+            shake_expr(graph, expr->as.postfix_inc.operand);
+            break;
+        case EXPR_POSTFIX_DEC:
+            shake_expr(graph, expr->as.postfix_dec.operand);
+            break;
+        case EXPR_AWAIT:
+            shake_expr(graph, expr->as.await_expr.awaited_expr);
+            break;
+        case EXPR_STRING_INTERPOLATION:
+            for (int i = 0; i < expr->as.string_interpolation.num_parts; i++) {
+                shake_expr(graph, expr->as.string_interpolation.expr_parts[i]);
+            }
+            break;
+        case EXPR_OPTIONAL_CHAIN:
+            shake_expr(graph, expr->as.optional_chain.object);
+            shake_expr(graph, expr->as.optional_chain.index);
+            for (int i = 0; i < expr->as.optional_chain.num_args; i++) {
+                shake_expr(graph, expr->as.optional_chain.args[i]);
+            }
+            break;
+        case EXPR_NULL_COALESCE:
+            shake_expr(graph, expr->as.null_coalesce.left);
+            shake_expr(graph, expr->as.null_coalesce.right);
+            break;
+    }
+}
+
+static void shake_stmt(ShakeGraph *graph, Stmt *stmt) {
+    if (!stmt) {
+        return;
+    }
+    switch (stmt->type) {
+        case STMT_LET:
+            shake_type(graph, stmt->as.let.type_annotation);
+            shake_expr(graph, stmt->as.let.value);
+            break;
+        case STMT_CONST:
+            shake_type(graph, stmt->as.const_stmt.type_annotation);
+            shake_expr(graph, stmt->as.const_stmt.value);
+            break;
+        case STMT_EXPR:
+            shake_expr(graph, stmt->as.expr);
+            break;
+        case STMT_IF:
+            shake_expr(graph, stmt->as.if_stmt.condition);
+            shake_stmt(graph, stmt->as.if_stmt.then_branch);
+            shake_stmt(graph, stmt->as.if_stmt.else_branch);
+            break;
+        case STMT_WHILE:
+            shake_expr(graph, stmt->as.while_stmt.condition);
+            shake_stmt(graph, stmt->as.while_stmt.body);
+            break;
+        case STMT_FOR:
+            shake_stmt(graph, stmt->as.for_loop.initializer);
+            shake_expr(graph, stmt->as.for_loop.condition);
+            shake_expr(graph, stmt->as.for_loop.increment);
+            shake_stmt(graph, stmt->as.for_loop.body);
+            break;
+        case STMT_FOR_IN:
+            shake_expr(graph, stmt->as.for_in.iterable);
+            shake_stmt(graph, stmt->as.for_in.body);
+            break;
+        case STMT_BREAK:
+        case STMT_CONTINUE:
+        case STMT_IMPORT:
+        case STMT_IMPORT_FFI:
+            break;
+        case STMT_BLOCK:
+            for (int i = 0; i < stmt->as.block.count; i++) {
+                shake_stmt(graph, stmt->as.block.statements[i]);
+            }
+            break;
+        case STMT_RETURN:
+            shake_expr(graph, stmt->as.return_stmt.value);
+            break;
+        case STMT_DEFINE_OBJECT:
+            for (int i = 0; i < stmt->as.define_object.num_fields; i++) {
+                if (stmt->as.define_object.field_types) {
+                    shake_type(graph, stmt->as.define_object.field_types[i]);
+                }
+                if (stmt->as.define_object.field_defaults) {
+                    shake_expr(graph, stmt->as.define_object.field_defaults[i]);
+                }
+            }
+            break;
+        case STMT_ENUM:
+            for (int i = 0; i < stmt->as.enum_decl.num_variants; i++) {
+                if (stmt->as.enum_decl.variant_values) {
+                    shake_expr(graph, stmt->as.enum_decl.variant_values[i]);
+                }
+            }
+            break;
+        case STMT_TRY:
+            shake_stmt(graph, stmt->as.try_stmt.try_block);
+            shake_stmt(graph, stmt->as.try_stmt.catch_block);
+            shake_stmt(graph, stmt->as.try_stmt.finally_block);
+            break;
+        case STMT_THROW:
+            shake_expr(graph, stmt->as.throw_stmt.value);
+            break;
+        case STMT_SWITCH:
+            shake_expr(graph, stmt->as.switch_stmt.expr);
+            for (int i = 0; i < stmt->as.switch_stmt.num_cases; i++) {
+                shake_expr(graph, stmt->as.switch_stmt.case_values[i]);
+                shake_stmt(graph, stmt->as.switch_stmt.case_bodies[i]);
+            }
+            break;
+        case STMT_DEFER:
+            shake_expr(graph, stmt->as.defer_stmt.call);
+            break;
+        case STMT_EXPORT:
+            shake_stmt(graph, stmt->as.export_stmt.declaration);
+            break;
+        case STMT_EXTERN_FN:
+            for (int i = 0; i < stmt->as.extern_fn.num_params; i++) {
+                shake_type(graph, stmt->as.extern_fn.param_types[i]);
+            }
+            shake_type(graph, stmt->as.extern_fn.return_type);
+            break;
+    }
+}
+
+// Whether evaluating an initializer can have an effect (including throwing)
+static int shake_is_pure(ShakeGraph *graph, Expr *expr) {
+    if (!expr) {
+        return 1;
+    }
+    switch (expr->type) {
+        case EXPR_NUMBER:
+        case EXPR_BOOL:
+        case EXPR_STRING:
+        case EXPR_RUNE:
+        case EXPR_NULL:
+        case EXPR_FUNCTION:
+            return 1;
+        case EXPR_IDENT:
+            // Reading an undefined name throws
+            return shake_find(graph, expr->as.ident, 0) != NULL;
+        case EXPR_UNARY:
+            return expr->as.unary.operand->type == EXPR_NUMBER ||
+                   expr->as.unary.operand->type == EXPR_BOOL;
+        case EXPR_ARRAY_LITERAL:
+            for (int i = 0; i < expr->as.array_literal.num_elements; i++) {
+                if (!shake_is_pure(graph, expr->as.array_literal.elements[i])) {
+                    return 0;
+                }
+            }
+            return 1;
+        case EXPR_OBJECT_LITERAL:
+            for (int i = 0; i < expr->as.object_literal.num_fields; i++) {
+                if (!shake_is_pure(graph, expr->as.object_literal.field_values[i])) {
+                    return 0;
+                }
+            }
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// Name declared by a statement that can be dropped when unused, else NULL
+static const char* shake_decl_name(Stmt *stmt) {
+    switch (stmt->type) {
+        case STMT_LET:
+            // Typed declarations convert their value, which can throw
+            return stmt->as.let.type_annotation ? NULL : stmt->as.let.name;
+        case STMT_CONST:
+            return stmt->as.const_stmt.type_annotation ? NULL : stmt->as.const_stmt.name;
+        case STMT_DEFINE_OBJECT:
+            return stmt->as.define_object.name;
+        case STMT_ENUM:
+            return stmt->as.enum_decl.name;
+        case STMT_EXTERN_FN:
+            return stmt->as.extern_fn.function_name;
+        default:
+            return NULL;
+    }
+}
+
+static int shake_is_removable(ShakeGraph *graph, Stmt *stmt) {
+    switch (stmt->type) {
+        case STMT_LET:
+            return shake_is_pure(graph, stmt->as.let.value);
+        case STMT_CONST:
+            return shake_is_pure(graph, stmt->as.const_stmt.value);
+        case STMT_ENUM:
+            for (int i = 0; i < stmt->as.enum_decl.num_variants; i++) {
+                if (stmt->as.enum_decl.variant_values &&
+                    !shake_is_pure(graph, stmt->as.enum_decl.variant_values[i])) {
+                    return 0;
+                }
+            }
+            return 1;
+        default:
+            return 1;
+    }
+}
+
+// The statement a module contributes for statement i (export declarations
+// are flattened to the declaration itself)
+static Stmt* shake_flat_stmt(Stmt *stmt) {
+    if (stmt->type == STMT_EXPORT && stmt->as.export_stmt.is_declaration) {
+        return stmt->as.export_stmt.declaration;
+    }
+    return stmt;
+}
+
+static void tree_shake(Bundle *bundle) {
+    ShakeGraph graph = {0};
+    unsigned char **keep = calloc(bundle->num_modules, sizeof(unsigned char*));
+
+    // Declarations and aliases of every module
+    for (int m = 0; m < bundle->num_modules; m++) {
+        BundledModule *module = bundle->modules[m];
+        keep[m] = calloc(module->num_statements ? module->num_statements : 1, 1);
+        for (int i = 0; i < module->num_statements; i++) {
+            Stmt *stmt = module->statements[i];
+            Stmt *flat = shake_flat_stmt(stmt);
+            const char *name = shake_decl_name(flat);
+            if (name) {
+                shake_add_decl(&graph, name, flat, &keep[m][i]);
+            }
+
+            if (stmt->type == STMT_IMPORT) {
+                if (stmt->as.import_stmt.is_namespace) {
+                    // A namespace uses every export of its module
+                    BundledModule *dep = module->imports[i];
+                    for (int j = 0; dep && j < dep->num_exports; j++) {
+                        shake_add_alias(&graph, stmt->as.import_stmt.namespace_name,
+                                        dep->export_names[j]);
+                    }
+                } else {
+                    for (int j = 0; j < stmt->as.import_stmt.num_imports; j++) {
+                        if (stmt->as.import_stmt.import_aliases &&
+                            stmt->as.import_stmt.import_aliases[j]) {
+                            shake_add_alias(&graph, stmt->as.import_stmt.import_aliases[j],
+                                            stmt->as.import_stmt.import_names[j]);
+                        }
+                    }
+                }
+            } else if (stmt->type == STMT_EXPORT && !stmt->as.export_stmt.is_declaration) {
+                for (int j = 0; j < stmt->as.export_stmt.num_exports; j++) {
+                    if (stmt->as.export_stmt.export_aliases &&
+                        stmt->as.export_stmt.export_aliases[j]) {
+                        shake_add_alias(&graph, stmt->as.export_stmt.export_aliases[j],
+                                        stmt->as.export_stmt.export_names[j]);
+                    }
+                }
+            }
+        }
+    }
+
+    // Roots: the entry module and anything that may have a side effect
+    for (int m = 0; m < bundle->num_modules; m++) {
+        BundledModule *module = bundle->modules[m];
+        for (int i = 0; i < module->num_statements; i++) {
+            Stmt *stmt = module->statements[i];
+            Stmt *flat = shake_flat_stmt(stmt);
+            if (stmt->type == STMT_IMPORT ||
+                (stmt->type == STMT_EXPORT && !stmt->as.export_stmt.is_declaration)) {
+                continue;
+            }
+            if (module->is_entry || !shake_decl_name(flat) ||
+                !shake_is_removable(&graph, flat)) {
+                keep[m][i] = 1;
+                shake_stmt(&graph, flat);
+            }
+        }
+    }
+
+    // Walk the declarations of each newly used name
+    while (graph.num_pending > 0) {
+        ShakeName *entry = graph.pending[--graph.num_pending];
+        for (int i = 0; i < entry->num_decls; i++) {
+            if (!*entry->decls[i].keep) {
+                *entry->decls[i].keep = 1;
+                shake_stmt(&graph, entry->decls[i].stmt);
+            }
+        }
+        for (int i = 0; i < entry->num_aliases; i++) {
+            shake_mark(&graph, entry->aliases[i]);
+        }
+    }
+
+    // Record what was dropped; imports and export lists are never emitted
+    for (int m = 0; m < bundle->num_modules; m++) {
+        BundledModule *module = bundle->modules[m];
+        for (int i = 0; i < module->num_statements; i++) {
+            Stmt *stmt = module->statements[i];
+            if (keep[m][i] || stmt->type == STMT_IMPORT ||
+                (stmt->type == STMT_EXPORT && !stmt->as.export_stmt.is_declaration)) {
+                continue;
+            }
+            if (!module->removed) {
+                module->removed = calloc(module->num_statements, 1);
+            }
+            module->removed[i] = 1;
+            module->num_removed++;
+        }
+        free(keep[m]);
+    }
+    free(keep);
+
+    for (int i = 0; i < graph.capacity; i++) {
+        free(graph.slots[i].decls);
+        free(graph.slots[i].aliases);
+    }
+    free(graph.slots);
+    free(graph.pending);
+}
+
 // ========== PUBLIC API IMPLEMENTATION ==========
 
 BundleOptions bundle_options_default(void) {
     BundleOptions opts = {
         .include_stdlib = 1,
-        .tree_shake = 0,
+        .tree_shake = 1,
         .namespace_symbols = 0,  // Disabled for now - simpler flattening
         .verbose = 0
     };
@@ -432,6 +915,8 @@ Bundle* bundle_create(const char *entry_path, const BundleOptions *options) {
     bundle->capacity = 32;
     bundle->entry_path = absolute_entry;
     bundle->stdlib_path = find_stdlib_path();
+    bundle->arena = ast_arena_new();
+    bundle->tree_shake = opts.tree_shake;
     bundle->statements = NULL;
     bundle->num_statements = 0;
     bundle->stmt_capacity = 0;
@@ -483,6 +968,10 @@ int bundle_flatten(Bundle *bundle) {
         return -1;
     }
 
+    if (bundle->tree_shake) {
+        tree_shake(bundle);
+    }
+
     // Flatten starting from entry (will recursively flatten dependencies first)
     int result = flatten_module(bundle, entry);
 
@@ -566,13 +1055,12 @@ void bundle_free(Bundle *bundle) {
         free(mod->absolute_path);
         free(mod->module_id);
 
-        // Don't free statements - they may be referenced in flattened output
-        // They'll be freed when the program exits
-
         for (int j = 0; j < mod->num_exports; j++) {
             free(mod->export_names[j]);
         }
         free(mod->export_names);
+        free(mod->imports);
+        free(mod->removed);
         free(mod);
     }
 
@@ -582,8 +1070,9 @@ void bundle_free(Bundle *bundle) {
         free(bundle->stdlib_path);
     }
 
-    // Don't free individual statements - they're owned by modules
+    // The flattened list points into the module ASTs, which the arena owns
     free(bundle->statements);
+    ast_arena_free(bundle->arena);
     free(bundle);
 }
 
@@ -601,6 +1090,7 @@ void bundle_print_summary(Bundle *bundle) {
     printf("Entry: %s\n", bundle->entry_path);
     printf("Modules: %d\n", bundle->num_modules);
 
+    int removed = 0;
     for (int i = 0; i < bundle->num_modules; i++) {
         BundledModule *mod = bundle->modules[i];
         printf("  [%s] %s%s\n",
@@ -618,9 +1108,26 @@ void bundle_print_summary(Bundle *bundle) {
             }
             printf("\n");
         }
+
+        if (mod->num_removed > 0) {
+            printf("       Removed: ");
+            int printed = 0;
+            for (int j = 0; j < mod->num_statements; j++) {
+                if (mod->removed[j]) {
+                    const char *name = shake_decl_name(shake_flat_stmt(mod->statements[j]));
+                    printf("%s%s", printed++ ? ", " : "", name ? name : "?");
+                }
+            }
+            printf("\n");
+        }
+        removed += mod->num_removed;
     }
 
     if (bundle->statements) {
         printf("Flattened: %d statements\n", bundle->num_statements);
     }
+    if (bundle->tree_shake) {
+        printf("Tree shaking: removed %d unused declaration%s\n",
+               removed, removed == 1 ? "" : "s");
+    }
 }
@@ -25,6 +25,9 @@ typedef struct BundledModule {
     int num_statements;
     char **export_names;         // Names exported by this module
     int num_exports;
+    struct BundledModule **imports;  // Module each import/re-export statement loads (else NULL)
+    unsigned char *removed;      // 1 for each statement dropped by tree shaking (NULL if none)
+    int num_removed;
     int is_entry;                // 1 if this is the entry point module
     int is_flattened;            // 1 if already flattened into output
 } BundledModule;
@@ -37,6 +40,8 @@ typedef struct Bundle {
 
     char *entry_path;            // Absolute path of entry point
     char *stdlib_path;           // Path to stdlib directory
+    AstArena *arena;             // Owns the AST of every module
+    int tree_shake;              // Drop unreferenced declarations when flattening
 
     // Flattened output
     Stmt **statements;           // Unified statement list
@@ -47,7 +52,7 @@ typedef struct Bundle {
 // Bundle options
 typedef struct BundleOptions {
     int include_stdlib;          // 1 to include stdlib modules (default: 1)
-    int tree_shake;              // 1 to remove unused exports (default: 0, not yet implemented)
+    int tree_shake;              // 1 to remove unreferenced declarations (default: 1)
     int namespace_symbols;       // 1 to prefix symbols with module ID (default: 1)
     int verbose;                 // 1 to print progress (default: 0)
 } BundleOptions;
@@ -73,6 +78,9 @@ Bundle* bundle_create(const char *entry_path, const BundleOptions *options);
  * Flatten the bundle into a single unified AST
  *
  * This resolves all imports and merges all modules into bundle->statements.
+ * With tree shaking, top-level functions, constants and types of imported
+ * modules that nothing reachable from the entry point refers to are left
+ * out; statements with side effects are always kept.
  * After calling this, you can serialize the bundle or pass it to codegen.
  *
  * @param bundle      The bundle to flatten
@@ -123,7 +131,7 @@ void bundle_free(Bundle *bundle);
 BundledModule* bundle_get_module(Bundle *bundle, const char *path);
 
 /**
- * Print bundle summary (for debugging)
+ * Print bundle summary, including what tree shaking removed (for debugging)
  */
 void bundle_print_summary(Bundle *bundle);
 
@@ -0,0 +1,68 @@
+#include "cache_dir.h"
+#include "version.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <limits.h>
+#include <sys/stat.h>
+
+// ========== LOCATION ==========
+
+char* cache_dir_path(const char *kind) {
+    const char *off = getenv("HEMLOCK_NO_CACHE");
+    if (off && off[0] != '\0' && strcmp(off, "0") != 0) {
+        return NULL;
+    }
+
+    char path[PATH_MAX];
+    const char *xdg = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    int n;
+    if (xdg && xdg[0] == '/') {
+        n = snprintf(path, sizeof(path), "%s/hemlock/%s", xdg, kind);
+    } else if (home && home[0] == '/') {
+        n = snprintf(path, sizeof(path), "%s/.cache/hemlock/%s", home, kind);
+    } else {
+        return NULL;
+    }
+    if (n <= 0 || n >= (int)sizeof(path)) {
+        return NULL;
+    }
+    return strdup(path);
+}
+
+void cache_build_id(char *out) {
+    struct stat st;
+    if (stat("/proc/self/exe", &st) == 0) {
+        snprintf(out, CACHE_BUILD_ID_LEN, "%s %lld:%lld.%09ld",
+                 HEMLOCK_VERSION, (long long)st.st_size,
+                 (long long)st.st_mtim.tv_sec, (long)st.st_mtim.tv_nsec);
+    } else {
+        snprintf(out, CACHE_BUILD_ID_LEN, "%s %s %s",
+                 HEMLOCK_VERSION, __DATE__, __TIME__);
+    }
+}
+
+// ========== DIRECTORIES ==========
+
+int cache_make_dirs(const char *dir) {
+    char path[PATH_MAX];
+    int n = snprintf(path, sizeof(path), "%s", dir);
+    if (n <= 0 || n >= (int)sizeof(path)) {
+        return 0;
+    }
+    for (char *p = path + 1; ; p++) {
+        if (*p == '/' || *p == '\0') {
+            char c = *p;
+            *p = '\0';
+            if (mkdir(path, 0700) != 0 && errno != EEXIST) {
+                return 0;
+            }
+            *p = c;
+            if (c == '\0') {
+                return 1;
+            }
+        }
+    }
+}
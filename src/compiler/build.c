@@ -0,0 +1,400 @@
+/*
+ * Hemlock Compiler - Native Build
+ *
+ * Writes the generated translation units to a build directory, compiles the
+ * ones without a cached object in parallel, then links everything against
+ * the runtime library.
+ */
+
+#include "build.h"
+#include "cache_dir.h"
+#include "fnv1a.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <limits.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+// Bump when the object key or the way units are compiled changes
+#define BUILD_CACHE_FORMAT 1
+
+// ========== HASHING ==========
+
+// Two independent 64-bit lanes (FNV-1a and a multiply-xorshift) give a
+// 128-bit key, enough to name objects without storing what produced them
+typedef struct {
+    uint64_t a;
+    uint64_t b;
+} BuildHash;
+
+static void hash_init(BuildHash *h) {
+    h->a = HML_FNV1A64_OFFSET;
+    h->b = 0x84222325cbf29ce4ULL;
+}
+
+static void hash_update(BuildHash *h, const void *data, size_t len) {
+    h->a = hml_fnv1a64(data, len, h->a);
+    const unsigned char *p = data;
+    for (size_t i = 0; i < len; i++) {
+        h->b = (h->b + p[i]) * 0x9e3779b97f4a7c15ULL;
+        h->b ^= h->b >> 29;
+    }
+}
+
+// Hash a string including its terminator, so consecutive fields can't run together
+static void hash_string(BuildHash *h, const char *str) {
+    hash_update(h, str, strlen(str) + 1);
+}
+
+static void hash_hex(const BuildHash *h, char out[33]) {
+    snprintf(out, 33, "%016llx%016llx", (unsigned long long)h->a, (unsigned long long)h->b);
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+// Hash the runtime headers every unit includes, in name order
+static void hash_runtime_headers(BuildHash *h, const char *include_dir) {
+    DIR *dir = opendir(include_dir);
+    if (!dir) {
+        hash_string(h, include_dir);
+        return;
+    }
+    char **names = NULL;
+    int count = 0;
+    int capacity = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        if (count >= capacity) {
+            capacity = capacity == 0 ? 8 : capacity * 2;
+            names = realloc(names, capacity * sizeof(char*));
+        }
+        names[count++] = strdup(entry->d_name);
+    }
+    closedir(dir);
+    qsort(names, count, sizeof(char*), compare_names);
+
+    char path[PATH_MAX];
+    char buf[8192];
+    for (int i = 0; i < count; i++) {
+        snprintf(path, sizeof(path), "%s/%s", include_dir, names[i]);
+        FILE *file = fopen(path, "rb");
+        if (file) {
+            hash_string(h, names[i]);
+            size_t n;
+            while ((n = fread(buf, 1, sizeof(buf), file)) > 0) {
+                hash_update(h, buf, n);
+            }
+            fclose(file);
+        }
+        free(names[i]);
+    }
+    free(names);
+}
+
+// ========== LIBRARY PROBES ==========
+
+// Check whether a test program links with the given libraries
+static int probe_libs(const char *cc, const char *libs) {
+    char cmd[1024];
+    snprintf(cmd, sizeof(cmd),
+             "echo 'int main(){return 0;}' | %s -x c - %s -o /dev/null 2>/dev/null", cc, libs);
+    return system(cmd) == 0;
+}
+
+// Optional libraries the runtime may use (same checks as the runtime Makefile).
+// Results are cached per compiler and runtime library build, since probing
+// costs several compiler runs.
+static void detect_libs(const BuildOptions *opts, const char *cache_dir, char *out, size_t size) {
+    char lib_path[PATH_MAX];
+    snprintf(lib_path, sizeof(lib_path), "%s/libhemlock_runtime.a", opts->runtime_path);
+    BuildHash h;
+    hash_init(&h);
+    hash_string(&h, opts->cc);
+    struct stat st;
+    if (stat(lib_path, &st) == 0) {
+        long long stamp[2] = { (long long)st.st_size, (long long)st.st_mtime };
+        hash_update(&h, stamp, sizeof(stamp));
+    }
+    char key[33];
+    hash_hex(&h, key);
+
+    char probe_path[PATH_MAX];
+    probe_path[0] = '\0';
+    if (cache_dir) {
+        snprintf(probe_path, sizeof(probe_path), "%s/libs-%s", cache_dir, key);
+        FILE *file = fopen(probe_path, "r");
+        if (file) {
+            int ok = fgets(out, (int)size, file) != NULL;
+            fclose(file);
+            if (ok) {
+                out[strcspn(out, "\n")] = '\0';
+                if (opts->verbose) {
+                    printf("Using cached library probe: %s\n", out[0] ? out + 1 : "(none)");
+                }
+                return;
+            }
+        }
+    }
+
+    out[0] = '\0';
+    if (probe_libs(opts->cc, "-lz")) {
+        strncat(out, " -lz", size - strlen(out) - 1);
+    }
+    if (probe_libs(opts->cc, "-lwebsockets")) {
+        strncat(out, " -lwebsockets", size - strlen(out) - 1);
+    }
+    // HTTPS and hash digests
+    if (probe_libs(opts->cc, "-lssl -lcrypto")) {
+        strncat(out, " -lssl -lcrypto", size - strlen(out) - 1);
+    } else if (probe_libs(opts->cc, "-lcrypto")) {
+        strncat(out, " -lcrypto", size - strlen(out) - 1);
+    }
+
+    if (probe_path[0]) {
+        char tmp[PATH_MAX + 32];
+        snprintf(tmp, sizeof(tmp), "%s.%d", probe_path, (int)getpid());
+        FILE *file = fopen(tmp, "w");
+        if (file) {
+            fprintf(file, "%s\n", out);
+            if (fclose(file) != 0 || rename(tmp, probe_path) != 0) {
+                unlink(tmp);
+            }
+        }
+    }
+}
+
+// ========== UNIT COMPILATION ==========
+
+typedef struct {
+    const CodegenUnit *unit;
+    char object[PATH_MAX];       // Object file the unit compiles to
+    char partial[PATH_MAX + 32]; // Written by the compiler, renamed on success
+    int cached;                  // Object already exists
+    int duplicate;               // Same object as an earlier unit
+    pid_t pid;
+} UnitJob;
+
+static int write_file(const char *path, const char *prefix, const char *data, size_t len) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Error: Could not write '%s'\n", path);
+        return 0;
+    }
+    if (prefix) {
+        fputs(prefix, file);
+    }
+    fwrite(data, 1, len, file);
+    if (fclose(file) != 0) {
+        fprintf(stderr, "Error: Could not write '%s'\n", path);
+        return 0;
+    }
+    return 1;
+}
+
+static pid_t spawn_shell(const char *cmd) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl("/bin/sh", "sh", "-c", cmd, (char*)NULL);
+        _exit(127);
+    }
+    return pid;
+}
+
+// Compile every unit without a cached object, at most opts->jobs at a time
+static int compile_units(const BuildOptions *opts, const char *build_dir, UnitJob *jobs, int num_jobs) {
+    int next = 0;
+    int running = 0;
+    int status = 0;
+    for (;;) {
+        while (status == 0 && running < opts->jobs && next < num_jobs) {
+            UnitJob *job = &jobs[next++];
+            if (job->cached || job->duplicate) continue;
+
+            char cmd[PATH_MAX * 3 + 256];
+            snprintf(cmd, sizeof(cmd), "%s -O%d -c -o '%s' '%s/%s.c' -I'%s/runtime/include'",
+                     opts->cc, opts->optimize, job->partial, build_dir, job->unit->name,
+                     opts->runtime_path);
+            if (opts->verbose) {
+                printf("Running: %s\n", cmd);
+            }
+            job->pid = spawn_shell(cmd);
+            if (job->pid < 0) {
+                fprintf(stderr, "Error: Could not start the C compiler\n");
+                status = 1;
+                break;
+            }
+            running++;
+        }
+        if (running == 0) {
+            break;
+        }
+
+        int wstatus;
+        pid_t pid = waitpid(-1, &wstatus, 0);
+        if (pid < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int i = 0; i < num_jobs; i++) {
+            if (jobs[i].pid != pid) continue;
+            jobs[i].pid = 0;
+            running--;
+            int code = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 1;
+            if (code == 0 && rename(jobs[i].partial, jobs[i].object) != 0) {
+                fprintf(stderr, "Error: Could not store object '%s'\n", jobs[i].object);
+                code = 1;
+            }
+            if (code != 0) {
+                unlink(jobs[i].partial);
+                if (status == 0) status = code;
+            }
+            break;
+        }
+    }
+    return status;
+}
+
+// Remove the build directory and the files written into it
+static void remove_build_dir(const char *build_dir) {
+    DIR *dir = opendir(build_dir);
+    if (dir) {
+        struct dirent *entry;
+        char path[PATH_MAX];
+        while ((entry = readdir(dir)) != NULL) {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+            snprintf(path, sizeof(path), "%s/%s", build_dir, entry->d_name);
+            unlink(path);
+        }
+        closedir(dir);
+    }
+    rmdir(build_dir);
+}
+
+int build_default_jobs(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+int build_program(const BuildOptions *opts, const CodegenProgram *program, const char *output_file) {
+    char build_dir[] = "/tmp/hemlockc_XXXXXX";
+    if (!mkdtemp(build_dir)) {
+        fprintf(stderr, "Error: Could not create build directory\n");
+        return 1;
+    }
+
+    char *cache_dir = cache_dir_path("objects");
+    if (cache_dir && !cache_make_dirs(cache_dir)) {
+        free(cache_dir);
+        cache_dir = NULL;
+    }
+    const char *object_dir = cache_dir ? cache_dir : build_dir;
+
+    int status = 0;
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", build_dir, CODEGEN_PROGRAM_HEADER);
+    if (!write_file(path, NULL, program->header, program->header_length)) {
+        status = 1;
+    }
+
+    // Key shared by all units: everything but the unit's own source
+    char include_dir[PATH_MAX];
+    snprintf(include_dir, sizeof(include_dir), "%s/runtime/include", opts->runtime_path);
+    BuildHash base;
+    hash_init(&base);
+    int format = BUILD_CACHE_FORMAT;
+    hash_update(&base, &format, sizeof(format));
+    hash_string(&base, opts->cc);
+    hash_update(&base, &opts->optimize, sizeof(opts->optimize));
+    hash_string(&base, include_dir);
+    hash_runtime_headers(&base, include_dir);
+    hash_update(&base, program->header, program->header_length);
+
+    const char *include_line = "#include \"" CODEGEN_PROGRAM_HEADER "\"\n";
+    UnitJob *jobs = calloc(program->num_units, sizeof(UnitJob));
+    int num_compiled = 0;
+    for (int i = 0; i < program->num_units && status == 0; i++) {
+        UnitJob *job = &jobs[i];
+        job->unit = &program->units[i];
+
+        BuildHash h = base;
+        hash_update(&h, job->unit->source, job->unit->length);
+        char key[33];
+        hash_hex(&h, key);
+        snprintf(job->object, sizeof(job->object), "%s/%s.o", object_dir, key);
+        snprintf(job->partial, sizeof(job->partial), "%s.%d.tmp", job->object, (int)getpid());
+
+        for (int j = 0; j < i; j++) {
+            if (strcmp(jobs[j].object, job->object) == 0) {
+                job->duplicate = 1;
+                break;
+            }
+        }
+        job->cached = !job->duplicate && access(job->object, R_OK) == 0;
+
+        if (opts->verbose) {
+            printf("%s unit %s\n", job->cached || job->duplicate ? "Reusing" : "Compiling",
+                   job->unit->name);
+        }
+        if (!job->cached && !job->duplicate) {
+            num_compiled++;
+        }
+        if ((!job->cached && !job->duplicate) || opts->keep_c) {
+            snprintf(path, sizeof(path), "%s/%s.c", build_dir, job->unit->name);
+            if (!write_file(path, include_line, job->unit->source, job->unit->length)) {
+                status = 1;
+            }
+        }
+    }
+
+    if (status == 0) {
+        if (opts->verbose) {
+            printf("Compiling %d of %d units with up to %d jobs\n",
+                   num_compiled, program->num_units, opts->jobs);
+        }
+        status = compile_units(opts, build_dir, jobs, program->num_units);
+    }
+
+    // Link
+    if (status == 0) {
+        char libs[128];
+        detect_libs(opts, cache_dir, libs, sizeof(libs));
+
+        char *cmd = NULL;
+        size_t cmd_len = 0;
+        FILE *out = open_memstream(&cmd, &cmd_len);
+        fprintf(out, "%s -O%d -o '%s'", opts->cc, opts->optimize, output_file);
+        for (int i = 0; i < program->num_units; i++) {
+            if (!jobs[i].duplicate) {
+                fprintf(out, " '%s'", jobs[i].object);
+            }
+        }
+        fprintf(out, " -L'%s' -lhemlock_runtime -lm -lpthread -lffi -ldl%s",
+                opts->runtime_path, libs);
+        fclose(out);
+
+        if (opts->verbose) {
+            printf("Running: %s\n", cmd);
+        }
+        int link_status = system(cmd);
+        status = WIFEXITED(link_status) ? WEXITSTATUS(link_status) : 1;
+        free(cmd);
+    }
+
+    if (opts->keep_c) {
+        printf("Generated C kept in %s\n", build_dir);
+    } else {
+        // Objects built without the cache live in the build directory too
+        remove_build_dir(build_dir);
+    }
+    free(jobs);
+    free(cache_dir);
+    return status;
+}
@@ -0,0 +1,35 @@
+/*
+ * Hemlock Compiler - Native Build
+ *
+ * Turns a generated program (one C translation unit per module plus a
+ * shared header) into an executable. Object files are cached by a hash of
+ * everything that goes into them, so a rebuild only compiles the units whose
+ * C text changed, and those are compiled in parallel.
+ */
+
+#ifndef HEMLOCK_BUILD_H
+#define HEMLOCK_BUILD_H
+
+#include "codegen.h"
+
+// Objects live in $XDG_CACHE_HOME/hemlock/objects (or ~/.cache/hemlock/objects)
+// together with the cached library probe results. Set HEMLOCK_NO_CACHE=1 to
+// build everything from scratch in a temporary directory.
+
+typedef struct {
+    const char *cc;              // C compiler to use
+    int optimize;                // Optimization level (0-3)
+    const char *runtime_path;    // Directory with runtime/include and the runtime library
+    int jobs;                    // Maximum number of concurrent compiler processes
+    int verbose;                 // Print commands and cache hits
+    int keep_c;                  // Keep the generated C sources after building
+} BuildOptions;
+
+// Compile and link a program into output_file.
+// Returns 0 on success, otherwise the exit status of the failing command.
+int build_program(const BuildOptions *opts, const CodegenProgram *program, const char *output_file);
+
+// Number of online CPUs (at least 1), the default for BuildOptions.jobs
+int build_default_jobs(void);
+
+#endif // HEMLOCK_BUILD_H
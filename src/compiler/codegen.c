@@ -60,7 +60,10 @@ CodegenContext* codegen_new(FILE *output) {
     ctx->finally_labels = NULL;
     ctx->return_value_vars = NULL;
     ctx->has_return_vars = NULL;
+    ctx->finally_try_depths = NULL;
     ctx->try_finally_capacity = 0;
+    ctx->try_depth = 0;
+    ctx->break_try_depth = 0;
     ctx->loop_depth = 0;
     return ctx;
 }
@@ -143,6 +146,7 @@ void codegen_free(CodegenContext *ctx) {
             free(ctx->finally_labels);
             free(ctx->return_value_vars);
             free(ctx->has_return_vars);
+            free(ctx->finally_try_depths);
         }
 
         free(ctx);
@@ -194,11 +198,24 @@ char* codegen_label(CodegenContext *ctx) {
 }
 
 char* codegen_anon_func(CodegenContext *ctx) {
-    char *name = malloc(32);
-    snprintf(name, 32, "hml_fn_anon_%d", ctx->func_counter++);
+    char *name = malloc(64);
+    if (ctx->current_module) {
+        // Numbered per module so each module's unit is independent of the others
+        snprintf(name, 64, "hml_fn_anon%s%d", ctx->current_module->module_prefix,
+                 ctx->current_module->anon_counter++);
+    } else {
+        snprintf(name, 64, "hml_fn_anon_%d", ctx->func_counter++);
+    }
     return name;
 }
 
+void codegen_reset_counters(CodegenContext *ctx) {
+    // Temporaries and labels never outlive one C function, so numbering each
+    // function from zero keeps its code independent of what came before it
+    ctx->temp_counter = 0;
+    ctx->label_counter = 0;
+}
+
 void codegen_add_local(CodegenContext *ctx, const char *name) {
     if (ctx->num_locals >= ctx->local_capacity) {
         int new_cap = (ctx->local_capacity == 0) ? 16 : ctx->local_capacity * 2;
@@ -291,11 +308,13 @@ void codegen_push_try_finally(CodegenContext *ctx, const char *finally_label,
         ctx->finally_labels = realloc(ctx->finally_labels, new_cap * sizeof(char*));
         ctx->return_value_vars = realloc(ctx->return_value_vars, new_cap * sizeof(char*));
         ctx->has_return_vars = realloc(ctx->has_return_vars, new_cap * sizeof(char*));
+        ctx->finally_try_depths = realloc(ctx->finally_try_depths, new_cap * sizeof(int));
         ctx->try_finally_capacity = new_cap;
     }
     ctx->finally_labels[ctx->try_finally_depth] = strdup(finally_label);
     ctx->return_value_vars[ctx->try_finally_depth] = strdup(return_value_var);
     ctx->has_return_vars[ctx->try_finally_depth] = strdup(has_return_var);
+    ctx->finally_try_depths[ctx->try_finally_depth] = ctx->try_depth;
     ctx->try_finally_depth++;
 }
 
@@ -330,6 +349,22 @@ const char* codegen_get_has_return_var(CodegenContext *ctx) {
     return NULL;
 }
 
+// try_depth inside the innermost try-finally (its own context included)
+int codegen_get_finally_try_depth(CodegenContext *ctx) {
+    if (ctx->try_finally_depth > 0) {
+        return ctx->finally_try_depths[ctx->try_finally_depth - 1];
+    }
+    return 0;
+}
+
+// Pop the exception contexts of the innermost count try blocks, for
+// control flow that leaves them without reaching their own pop
+void codegen_exception_unwind(CodegenContext *ctx, int count) {
+    for (int i = 0; i < count; i++) {
+        codegen_writeln(ctx, "hml_exception_pop();");
+    }
+}
+
 // Forward declaration
 int codegen_is_main_var(CodegenContext *ctx, const char *name);
 
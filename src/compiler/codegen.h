@@ -80,6 +80,7 @@ struct CompiledModule {
     ImportBinding *imports;     // Import bindings for this module
     int num_imports;
     int import_capacity;
+    int anon_counter;           // Counter for this module's anonymous functions
     CompiledModule *next;       // Linked list
 };
 
@@ -161,7 +162,10 @@ typedef struct {
     char **finally_labels;        // Stack of finally labels (for goto)
     char **return_value_vars;     // Stack of return value variable names
     char **has_return_vars;       // Stack of "has return" flag variable names
+    int *finally_try_depths;      // Stack of try_depth values at each try-finally
     int try_finally_capacity;     // Capacity of the stacks
+    int try_depth;                // Enclosing try blocks in this function with a pushed exception context
+    int break_try_depth;          // try_depth at the innermost loop or switch
 
     // Loop tracking (for runtime defer support)
     int loop_depth;               // Current loop nesting depth (0 = not in loop)
@@ -173,9 +177,40 @@ CodegenContext* codegen_new(FILE *output);
 // Free code generation context
 void codegen_free(CodegenContext *ctx);
 
-// Generate C code for a complete program
+// ========== TRANSLATION UNITS ==========
+
+// Name of the generated header every translation unit includes
+#define CODEGEN_PROGRAM_HEADER "hemlock_program.h"
+
+// Generated C for one translation unit: the main file or one imported module.
+// The source does not include the shared header itself.
+typedef struct {
+    char *name;             // File stem ("main" or the module prefix)
+    char *source;           // Unit source
+    size_t length;          // Source length in bytes
+} CodegenUnit;
+
+// A generated program: declarations shared by all units, then the units
+// (units[0] is the main file)
+typedef struct {
+    char *header;           // Shared header source
+    size_t header_length;   // Header length in bytes
+    CodegenUnit *units;
+    int num_units;
+} CodegenProgram;
+
+// Generate C code for a complete program as one file written to ctx->output
 void codegen_program(CodegenContext *ctx, Stmt **stmts, int stmt_count);
 
+// Generate C code for a complete program as one translation unit per module
+CodegenProgram* codegen_program_units(CodegenContext *ctx, Stmt **stmts, int stmt_count);
+
+// Write a generated program as a single C file (header followed by every unit)
+void codegen_program_write(const CodegenProgram *program, FILE *out);
+
+// Free a generated program
+void codegen_program_free(CodegenProgram *program);
+
 // Generate C code for a single statement
 void codegen_stmt(CodegenContext *ctx, Stmt *stmt);
 
@@ -192,6 +227,9 @@ char* codegen_label(CodegenContext *ctx);
 // Helper: Generate a new anonymous function name
 char* codegen_anon_func(CodegenContext *ctx);
 
+// Helper: Restart temporary and label numbering at the start of a C function
+void codegen_reset_counters(CodegenContext *ctx);
+
 // Helper: Write indentation
 void codegen_indent(CodegenContext *ctx);
 
@@ -6,17 +6,46 @@
 
 #include "codegen_internal.h"
 
+// Method names the method-call path maps straight to string, array, file,
+// socket or channel builtins. An object may define its own method with one
+// of these names (a regex handle's split, a queue's push), so calls to them
+// check for an object first.
+static int codegen_is_builtin_method(const char *method) {
+    static const char *names[] = {
+        "accept", "bind", "byte_at", "char_at", "clear", "close", "concat", "connect",
+        "contains", "deserialize", "ends_with", "filter", "find", "first", "indexOf",
+        "insert", "join", "last", "listen", "map", "pop", "push", "read", "read_bytes",
+        "recv", "recvfrom", "reduce", "remove", "repeat", "replace", "replace_all",
+        "reverse", "seek", "send", "send_file", "sendto", "serialize", "set_timeout",
+        "setsockopt", "shift", "slice", "split", "starts_with", "substr", "tell",
+        "to_lower", "to_upper", "trim", "unshift", "write", "write_bytes"
+    };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (strcmp(method, names[i]) == 0) return 1;
+    }
+    return 0;
+}
+
 char* codegen_expr(CodegenContext *ctx, Expr *expr) {
     char *result = codegen_temp(ctx);
 
     switch (expr->type) {
         case EXPR_NUMBER:
             if (expr->as.number.is_float) {
-                codegen_writeln(ctx, "HmlValue %s = hml_val_f64(%g);", result, expr->as.number.float_value);
+                // Round-trip precision: folded constants are not short decimals
+                char literal[40];
+                snprintf(literal, sizeof(literal), "%.17g", expr->as.number.float_value);
+                if (!strpbrk(literal, ".eEn")) {
+                    strcat(literal, ".0");  // Keep it a double (and -0.0 negative)
+                }
+                codegen_writeln(ctx, "HmlValue %s = hml_val_f64(%s);", result, literal);
             } else {
                 // Check if it fits in i32
                 if (expr->as.number.int_value >= INT32_MIN && expr->as.number.int_value <= INT32_MAX) {
                     codegen_writeln(ctx, "HmlValue %s = hml_val_i32(%d);", result, (int32_t)expr->as.number.int_value);
+                } else if (expr->as.number.int_value == INT64_MIN) {
+                    // -9223372036854775808L would negate an out-of-range literal
+                    codegen_writeln(ctx, "HmlValue %s = hml_val_i64(INT64_MIN);", result);
                 } else {
                     codegen_writeln(ctx, "HmlValue %s = hml_val_i64(%ldL);", result, expr->as.number.int_value);
                 }
@@ -150,7 +179,8 @@ char* codegen_expr(CodegenContext *ctx, Expr *expr) {
                 codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_rand, 0, 0, 0);", result);
             } else if (strcmp(expr->as.ident, "__rand_range") == 0 || strcmp(expr->as.ident, "rand_range") == 0) {
                 codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_rand_range, 2, 2, 0);", result);
-            } else if (strcmp(expr->as.ident, "__seed") == 0 || strcmp(expr->as.ident, "seed") == 0) {
+            } else if (strcmp(expr->as.ident, "__seed") == 0 ||
+                       (strcmp(expr->as.ident, "seed") == 0 && !codegen_is_local(ctx, expr->as.ident))) {
                 codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_seed, 1, 1, 0);", result);
             // Handle time functions (builtins)
             } else if (strcmp(expr->as.ident, "__now") == 0) {
@@ -274,10 +304,135 @@ char* codegen_expr(CodegenContext *ctx, Expr *expr) {
                 codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_gzip_decompress, 2, 2, 0);", result);
             } else if (strcmp(expr->as.ident, "__zlib_compress_bound") == 0 || strcmp(expr->as.ident, "zlib_compress_bound") == 0) {
                 codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_zlib_compress_bound, 1, 1, 0);", result);
-            } else if (strcmp(expr->as.ident, "__crc32") == 0 || strcmp(expr->as.ident, "crc32") == 0) {
+            } else if (strcmp(expr->as.ident, "__crc32") == 0 ||
+                       (strcmp(expr->as.ident, "crc32") == 0 && !codegen_is_local(ctx, expr->as.ident))) {
                 codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_crc32, 1, 1, 0);", result);
             } else if (strcmp(expr->as.ident, "__adler32") == 0 || strcmp(expr->as.ident, "adler32") == 0) {
                 codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_adler32, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__deflate_new") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_deflate_new, 2, 2, 0);", result);
+            } else if (strcmp(expr->as.ident, "__inflate_new") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_inflate_new, 2, 2, 0);", result);
+            } else if (strcmp(expr->as.ident, "__zstream_update") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_zstream_update, 2, 2, 0);", result);
+            } else if (strcmp(expr->as.ident, "__zstream_flush") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_zstream_flush, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__zstream_finish") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_zstream_finish, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__zstream_done") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_zstream_done, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__zstream_free") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_zstream_free, 1, 1, 0);", result);
+            // Hash builtins
+            } else if (strcmp(expr->as.ident, "__hasher_new") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_hasher_new, 2, 2, 0);", result);
+            } else if (strcmp(expr->as.ident, "__hasher_update") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_hasher_update, 2, 2, 0);", result);
+            } else if (strcmp(expr->as.ident, "__hasher_update_file") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_hasher_update_file, 2, 2, 0);", result);
+            } else if (strcmp(expr->as.ident, "__hasher_digest") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_hasher_digest, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__hasher_hex_digest") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_hasher_hex_digest, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__hasher_value") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_hasher_value, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__hasher_reset") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_hasher_reset, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__hasher_free") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_hasher_free, 1, 1, 0);", result);
+            // Regex builtins
+            } else if (strcmp(expr->as.ident, "__regex_new") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_regex_new, 2, 2, 0);", result);
+            } else if (strcmp(expr->as.ident, "__regex_free") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_regex_free, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__regex_test") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_regex_test, 3, 3, 0);", result);
+            } else if (strcmp(expr->as.ident, "__regex_find") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_regex_find, 4, 4, 0);", result);
+            } else if (strcmp(expr->as.ident, "__regex_find_all") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_regex_find_all, 4, 4, 0);", result);
+            } else if (strcmp(expr->as.ident, "__regex_captures") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_regex_captures, 4, 4, 0);", result);
+            } else if (strcmp(expr->as.ident, "__regex_replace") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_regex_replace, 5, 5, 0);", result);
+            } else if (strcmp(expr->as.ident, "__regex_split") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_regex_split, 4, 4, 0);", result);
+            } else if (strcmp(expr->as.ident, "__http_client_new") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_http_client_new, 3, 3, 0);", result);
+            } else if (strcmp(expr->as.ident, "__http_client_free") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_http_client_free, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__http_client_stats") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_http_client_stats, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__http_request") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_http_request, 5, 5, 0);", result);
+            } else if (strcmp(expr->as.ident, "__http_response_status") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_http_response_status, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__http_response_headers") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_http_response_headers, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__http_response_read") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_http_response_read, 2, 2, 0);", result);
+            } else if (strcmp(expr->as.ident, "__http_response_body") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_http_response_body, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__http_response_close") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_http_response_close, 1, 1, 0);", result);
+            // HTTP server builtins
+            } else if (strcmp(expr->as.ident, "__http_server_new") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_http_server_new, 4, 4, 0);", result);
+            } else if (strcmp(expr->as.ident, "__http_server_port") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_http_server_port, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__http_server_stats") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_http_server_stats, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__http_server_close") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_http_server_close, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__log_sink_open") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_log_sink_open, 2, 2, 0);", result);
+            } else if (strcmp(expr->as.ident, "__log_sink_write") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_log_sink_write, 2, 2, 0);", result);
+            } else if (strcmp(expr->as.ident, "__log_sink_flush") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_log_sink_flush, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__log_sink_stats") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_log_sink_stats, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__log_sink_close") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_log_sink_close, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__log_timestamp") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_log_timestamp, 0, 0, 0);", result);
+            } else if (strcmp(expr->as.ident, "__log_json") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_log_json, 4, 4, 0);", result);
+            } else if (strcmp(expr->as.ident, "__process_spawn") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_process_spawn, 2, 2, 0);", result);
+            } else if (strcmp(expr->as.ident, "__process_pid") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_process_pid, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__process_read") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_process_read, 4, 4, 0);", result);
+            } else if (strcmp(expr->as.ident, "__process_read_line") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_process_read_line, 2, 2, 0);", result);
+            } else if (strcmp(expr->as.ident, "__process_write") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_process_write, 2, 2, 0);", result);
+            } else if (strcmp(expr->as.ident, "__process_close_stdin") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_process_close_stdin, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__process_poll") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_process_poll, 2, 2, 0);", result);
+            } else if (strcmp(expr->as.ident, "__process_wait") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_process_wait, 2, 2, 0);", result);
+            } else if (strcmp(expr->as.ident, "__process_kill") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_process_kill, 2, 2, 0);", result);
+            } else if (strcmp(expr->as.ident, "__process_communicate") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_process_communicate, 2, 2, 0);", result);
+            } else if (strcmp(expr->as.ident, "__process_close") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_process_close, 1, 1, 0);", result);
+            // Encoding builtins
+            } else if (strcmp(expr->as.ident, "__base64_encode") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_base64_encode, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__base64_decode") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_base64_decode, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__hex_encode") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_hex_encode, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__hex_decode") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_hex_decode, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__url_encode") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_url_encode, 1, 1, 0);", result);
+            } else if (strcmp(expr->as.ident, "__url_decode") == 0) {
+                codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_url_decode, 1, 1, 0);", result);
             // Internal helper builtins
             } else if (strcmp(expr->as.ident, "__read_u32") == 0 || strcmp(expr->as.ident, "read_u32") == 0) {
                 codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_read_u32, 1, 1, 0);", result);
@@ -703,6 +858,12 @@ char* codegen_expr(CodegenContext *ctx, Expr *expr) {
                     break;
                 }
 
+                // snapshot_point() only matters to `hemlock --snapshot`
+                if (strcmp(fn_name, "snapshot_point") == 0 && expr->as.call.num_args == 0) {
+                    codegen_writeln(ctx, "HmlValue %s = hml_val_null();", result);
+                    break;
+                }
+
                 // Handle channel builtin
                 if (strcmp(fn_name, "channel") == 0 && expr->as.call.num_args == 1) {
                     char *cap = codegen_expr(ctx, expr->as.call.args[0]);
@@ -1564,8 +1725,10 @@ char* codegen_expr(CodegenContext *ctx, Expr *expr) {
                     break;
                 }
 
-                // crc32(data)
-                if ((strcmp(fn_name, "crc32") == 0 || strcmp(fn_name, "__crc32") == 0) && expr->as.call.num_args == 1) {
+                // crc32(data) - but NOT if 'crc32' is a local/import (e.g., from @stdlib/hash)
+                if ((strcmp(fn_name, "__crc32") == 0 ||
+                     (strcmp(fn_name, "crc32") == 0 && !codegen_is_local(ctx, fn_name))) &&
+                    expr->as.call.num_args == 1) {
                     char *data = codegen_expr(ctx, expr->as.call.args[0]);
                     codegen_writeln(ctx, "HmlValue %s = hml_crc32_val(%s);", result, data);
                     codegen_writeln(ctx, "hml_release(&%s);", data);
@@ -1582,6 +1745,707 @@ char* codegen_expr(CodegenContext *ctx, Expr *expr) {
                     break;
                 }
 
+                // deflate_new(format, level)
+                if (strcmp(fn_name, "__deflate_new") == 0 && expr->as.call.num_args == 2) {
+                    char *format = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *level = codegen_expr(ctx, expr->as.call.args[1]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_deflate_new(%s, %s);", result, format, level);
+                    codegen_writeln(ctx, "hml_release(&%s);", format);
+                    codegen_writeln(ctx, "hml_release(&%s);", level);
+                    free(format);
+                    free(level);
+                    break;
+                }
+
+                // inflate_new(format, as_string)
+                if (strcmp(fn_name, "__inflate_new") == 0 && expr->as.call.num_args == 2) {
+                    char *format = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *as_string = codegen_expr(ctx, expr->as.call.args[1]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_inflate_new(%s, %s);", result, format, as_string);
+                    codegen_writeln(ctx, "hml_release(&%s);", format);
+                    codegen_writeln(ctx, "hml_release(&%s);", as_string);
+                    free(format);
+                    free(as_string);
+                    break;
+                }
+
+                // zstream_update(stream, chunk)
+                if (strcmp(fn_name, "__zstream_update") == 0 && expr->as.call.num_args == 2) {
+                    char *stream = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *chunk = codegen_expr(ctx, expr->as.call.args[1]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_zstream_update(%s, %s);", result, stream, chunk);
+                    codegen_writeln(ctx, "hml_release(&%s);", stream);
+                    codegen_writeln(ctx, "hml_release(&%s);", chunk);
+                    free(stream);
+                    free(chunk);
+                    break;
+                }
+
+                // zstream_flush(stream)
+                if (strcmp(fn_name, "__zstream_flush") == 0 && expr->as.call.num_args == 1) {
+                    char *stream = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_zstream_flush(%s);", result, stream);
+                    codegen_writeln(ctx, "hml_release(&%s);", stream);
+                    free(stream);
+                    break;
+                }
+
+                // zstream_finish(stream)
+                if (strcmp(fn_name, "__zstream_finish") == 0 && expr->as.call.num_args == 1) {
+                    char *stream = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_zstream_finish(%s);", result, stream);
+                    codegen_writeln(ctx, "hml_release(&%s);", stream);
+                    free(stream);
+                    break;
+                }
+
+                // zstream_done(stream)
+                if (strcmp(fn_name, "__zstream_done") == 0 && expr->as.call.num_args == 1) {
+                    char *stream = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_zstream_done(%s);", result, stream);
+                    codegen_writeln(ctx, "hml_release(&%s);", stream);
+                    free(stream);
+                    break;
+                }
+
+                // zstream_free(stream)
+                if (strcmp(fn_name, "__zstream_free") == 0 && expr->as.call.num_args == 1) {
+                    char *stream = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_zstream_free(%s);", result, stream);
+                    codegen_writeln(ctx, "hml_release(&%s);", stream);
+                    free(stream);
+                    break;
+                }
+
+                // ========== HASH BUILTINS ==========
+
+                // hasher_new(algorithm, seed)
+                if (strcmp(fn_name, "__hasher_new") == 0 && expr->as.call.num_args == 2) {
+                    char *algorithm = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *seed = codegen_expr(ctx, expr->as.call.args[1]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_hasher_new(%s, %s);", result, algorithm, seed);
+                    codegen_writeln(ctx, "hml_release(&%s);", algorithm);
+                    codegen_writeln(ctx, "hml_release(&%s);", seed);
+                    free(algorithm);
+                    free(seed);
+                    break;
+                }
+
+                // hasher_update(hasher, data)
+                if (strcmp(fn_name, "__hasher_update") == 0 && expr->as.call.num_args == 2) {
+                    char *hasher = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *data = codegen_expr(ctx, expr->as.call.args[1]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_hasher_update(%s, %s);", result, hasher, data);
+                    codegen_writeln(ctx, "hml_release(&%s);", hasher);
+                    codegen_writeln(ctx, "hml_release(&%s);", data);
+                    free(hasher);
+                    free(data);
+                    break;
+                }
+
+                // hasher_update_file(hasher, path)
+                if (strcmp(fn_name, "__hasher_update_file") == 0 && expr->as.call.num_args == 2) {
+                    char *hasher = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *path = codegen_expr(ctx, expr->as.call.args[1]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_hasher_update_file(%s, %s);", result, hasher, path);
+                    codegen_writeln(ctx, "hml_release(&%s);", hasher);
+                    codegen_writeln(ctx, "hml_release(&%s);", path);
+                    free(hasher);
+                    free(path);
+                    break;
+                }
+
+                // hasher_digest(hasher)
+                if (strcmp(fn_name, "__hasher_digest") == 0 && expr->as.call.num_args == 1) {
+                    char *hasher = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_hasher_digest(%s);", result, hasher);
+                    codegen_writeln(ctx, "hml_release(&%s);", hasher);
+                    free(hasher);
+                    break;
+                }
+
+                // hasher_hex_digest(hasher)
+                if (strcmp(fn_name, "__hasher_hex_digest") == 0 && expr->as.call.num_args == 1) {
+                    char *hasher = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_hasher_hex_digest(%s);", result, hasher);
+                    codegen_writeln(ctx, "hml_release(&%s);", hasher);
+                    free(hasher);
+                    break;
+                }
+
+                // hasher_value(hasher)
+                if (strcmp(fn_name, "__hasher_value") == 0 && expr->as.call.num_args == 1) {
+                    char *hasher = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_hasher_value(%s);", result, hasher);
+                    codegen_writeln(ctx, "hml_release(&%s);", hasher);
+                    free(hasher);
+                    break;
+                }
+
+                // hasher_reset(hasher)
+                if (strcmp(fn_name, "__hasher_reset") == 0 && expr->as.call.num_args == 1) {
+                    char *hasher = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_hasher_reset(%s);", result, hasher);
+                    codegen_writeln(ctx, "hml_release(&%s);", hasher);
+                    free(hasher);
+                    break;
+                }
+
+                // hasher_free(hasher)
+                if (strcmp(fn_name, "__hasher_free") == 0 && expr->as.call.num_args == 1) {
+                    char *hasher = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_hasher_free(%s);", result, hasher);
+                    codegen_writeln(ctx, "hml_release(&%s);", hasher);
+                    free(hasher);
+                    break;
+                }
+
+                // ========== REGEX BUILTINS ==========
+
+                // regex_new(pattern, flags)
+                if (strcmp(fn_name, "__regex_new") == 0 && expr->as.call.num_args == 2) {
+                    char *pattern = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *flags = codegen_expr(ctx, expr->as.call.args[1]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_regex_new(%s, %s);", result, pattern, flags);
+                    codegen_writeln(ctx, "hml_release(&%s);", pattern);
+                    codegen_writeln(ctx, "hml_release(&%s);", flags);
+                    free(pattern);
+                    free(flags);
+                    break;
+                }
+
+                // regex_free(handle)
+                if (strcmp(fn_name, "__regex_free") == 0 && expr->as.call.num_args == 1) {
+                    char *handle = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_regex_free(%s);", result, handle);
+                    codegen_writeln(ctx, "hml_release(&%s);", handle);
+                    free(handle);
+                    break;
+                }
+
+                // regex_test(re, flags, text)
+                if (strcmp(fn_name, "__regex_test") == 0 && expr->as.call.num_args == 3) {
+                    char *re = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *flags = codegen_expr(ctx, expr->as.call.args[1]);
+                    char *text = codegen_expr(ctx, expr->as.call.args[2]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_regex_test(%s, %s, %s);", result, re, flags, text);
+                    codegen_writeln(ctx, "hml_release(&%s);", re);
+                    codegen_writeln(ctx, "hml_release(&%s);", flags);
+                    codegen_writeln(ctx, "hml_release(&%s);", text);
+                    free(re);
+                    free(flags);
+                    free(text);
+                    break;
+                }
+
+                // regex_find(re, flags, text, start)
+                if (strcmp(fn_name, "__regex_find") == 0 && expr->as.call.num_args == 4) {
+                    char *re = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *flags = codegen_expr(ctx, expr->as.call.args[1]);
+                    char *text = codegen_expr(ctx, expr->as.call.args[2]);
+                    char *start = codegen_expr(ctx, expr->as.call.args[3]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_regex_find(%s, %s, %s, %s);", result, re, flags, text, start);
+                    codegen_writeln(ctx, "hml_release(&%s);", re);
+                    codegen_writeln(ctx, "hml_release(&%s);", flags);
+                    codegen_writeln(ctx, "hml_release(&%s);", text);
+                    codegen_writeln(ctx, "hml_release(&%s);", start);
+                    free(re);
+                    free(flags);
+                    free(text);
+                    free(start);
+                    break;
+                }
+
+                // regex_find_all(re, flags, text, limit)
+                if (strcmp(fn_name, "__regex_find_all") == 0 && expr->as.call.num_args == 4) {
+                    char *re = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *flags = codegen_expr(ctx, expr->as.call.args[1]);
+                    char *text = codegen_expr(ctx, expr->as.call.args[2]);
+                    char *limit = codegen_expr(ctx, expr->as.call.args[3]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_regex_find_all(%s, %s, %s, %s);", result, re, flags, text, limit);
+                    codegen_writeln(ctx, "hml_release(&%s);", re);
+                    codegen_writeln(ctx, "hml_release(&%s);", flags);
+                    codegen_writeln(ctx, "hml_release(&%s);", text);
+                    codegen_writeln(ctx, "hml_release(&%s);", limit);
+                    free(re);
+                    free(flags);
+                    free(text);
+                    free(limit);
+                    break;
+                }
+
+                // regex_captures(re, flags, text, start)
+                if (strcmp(fn_name, "__regex_captures") == 0 && expr->as.call.num_args == 4) {
+                    char *re = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *flags = codegen_expr(ctx, expr->as.call.args[1]);
+                    char *text = codegen_expr(ctx, expr->as.call.args[2]);
+                    char *start = codegen_expr(ctx, expr->as.call.args[3]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_regex_captures(%s, %s, %s, %s);", result, re, flags, text, start);
+                    codegen_writeln(ctx, "hml_release(&%s);", re);
+                    codegen_writeln(ctx, "hml_release(&%s);", flags);
+                    codegen_writeln(ctx, "hml_release(&%s);", text);
+                    codegen_writeln(ctx, "hml_release(&%s);", start);
+                    free(re);
+                    free(flags);
+                    free(text);
+                    free(start);
+                    break;
+                }
+
+                // regex_replace(re, flags, text, replacement, limit)
+                if (strcmp(fn_name, "__regex_replace") == 0 && expr->as.call.num_args == 5) {
+                    char *re = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *flags = codegen_expr(ctx, expr->as.call.args[1]);
+                    char *text = codegen_expr(ctx, expr->as.call.args[2]);
+                    char *replacement = codegen_expr(ctx, expr->as.call.args[3]);
+                    char *limit = codegen_expr(ctx, expr->as.call.args[4]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_regex_replace(%s, %s, %s, %s, %s);", result, re, flags, text, replacement, limit);
+                    codegen_writeln(ctx, "hml_release(&%s);", re);
+                    codegen_writeln(ctx, "hml_release(&%s);", flags);
+                    codegen_writeln(ctx, "hml_release(&%s);", text);
+                    codegen_writeln(ctx, "hml_release(&%s);", replacement);
+                    codegen_writeln(ctx, "hml_release(&%s);", limit);
+                    free(re);
+                    free(flags);
+                    free(text);
+                    free(replacement);
+                    free(limit);
+                    break;
+                }
+
+                // regex_split(re, flags, text, limit)
+                if (strcmp(fn_name, "__regex_split") == 0 && expr->as.call.num_args == 4) {
+                    char *re = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *flags = codegen_expr(ctx, expr->as.call.args[1]);
+                    char *text = codegen_expr(ctx, expr->as.call.args[2]);
+                    char *limit = codegen_expr(ctx, expr->as.call.args[3]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_regex_split(%s, %s, %s, %s);", result, re, flags, text, limit);
+                    codegen_writeln(ctx, "hml_release(&%s);", re);
+                    codegen_writeln(ctx, "hml_release(&%s);", flags);
+                    codegen_writeln(ctx, "hml_release(&%s);", text);
+                    codegen_writeln(ctx, "hml_release(&%s);", limit);
+                    free(re);
+                    free(flags);
+                    free(text);
+                    free(limit);
+                    break;
+                }
+
+                // ========== HTTP CLIENT BUILTINS ==========
+
+                // http_client_new(timeout_ms, max_idle, verify_tls)
+                if (strcmp(fn_name, "__http_client_new") == 0 && expr->as.call.num_args == 3) {
+                    char *timeout_ms = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *max_idle = codegen_expr(ctx, expr->as.call.args[1]);
+                    char *verify_tls = codegen_expr(ctx, expr->as.call.args[2]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_http_client_new(%s, %s, %s);", result, timeout_ms, max_idle, verify_tls);
+                    codegen_writeln(ctx, "hml_release(&%s);", timeout_ms);
+                    codegen_writeln(ctx, "hml_release(&%s);", max_idle);
+                    codegen_writeln(ctx, "hml_release(&%s);", verify_tls);
+                    free(timeout_ms);
+                    free(max_idle);
+                    free(verify_tls);
+                    break;
+                }
+
+                // http_client_free(client)
+                if (strcmp(fn_name, "__http_client_free") == 0 && expr->as.call.num_args == 1) {
+                    char *client = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_http_client_free(%s);", result, client);
+                    codegen_writeln(ctx, "hml_release(&%s);", client);
+                    free(client);
+                    break;
+                }
+
+                // http_client_stats(client)
+                if (strcmp(fn_name, "__http_client_stats") == 0 && expr->as.call.num_args == 1) {
+                    char *client = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_http_client_stats(%s);", result, client);
+                    codegen_writeln(ctx, "hml_release(&%s);", client);
+                    free(client);
+                    break;
+                }
+
+                // http_request(client, method, url, headers, body)
+                if (strcmp(fn_name, "__http_request") == 0 && expr->as.call.num_args == 5) {
+                    char *client = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *method = codegen_expr(ctx, expr->as.call.args[1]);
+                    char *url = codegen_expr(ctx, expr->as.call.args[2]);
+                    char *headers = codegen_expr(ctx, expr->as.call.args[3]);
+                    char *body = codegen_expr(ctx, expr->as.call.args[4]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_http_request(%s, %s, %s, %s, %s);", result, client, method, url, headers, body);
+                    codegen_writeln(ctx, "hml_release(&%s);", client);
+                    codegen_writeln(ctx, "hml_release(&%s);", method);
+                    codegen_writeln(ctx, "hml_release(&%s);", url);
+                    codegen_writeln(ctx, "hml_release(&%s);", headers);
+                    codegen_writeln(ctx, "hml_release(&%s);", body);
+                    free(client);
+                    free(method);
+                    free(url);
+                    free(headers);
+                    free(body);
+                    break;
+                }
+
+                // http_response_status(resp)
+                if (strcmp(fn_name, "__http_response_status") == 0 && expr->as.call.num_args == 1) {
+                    char *resp = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_http_response_status(%s);", result, resp);
+                    codegen_writeln(ctx, "hml_release(&%s);", resp);
+                    free(resp);
+                    break;
+                }
+
+                // http_response_headers(resp)
+                if (strcmp(fn_name, "__http_response_headers") == 0 && expr->as.call.num_args == 1) {
+                    char *resp = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_http_response_headers(%s);", result, resp);
+                    codegen_writeln(ctx, "hml_release(&%s);", resp);
+                    free(resp);
+                    break;
+                }
+
+                // http_response_read(resp, max_bytes)
+                if (strcmp(fn_name, "__http_response_read") == 0 && expr->as.call.num_args == 2) {
+                    char *resp = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *max_bytes = codegen_expr(ctx, expr->as.call.args[1]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_http_response_read(%s, %s);", result, resp, max_bytes);
+                    codegen_writeln(ctx, "hml_release(&%s);", resp);
+                    codegen_writeln(ctx, "hml_release(&%s);", max_bytes);
+                    free(resp);
+                    free(max_bytes);
+                    break;
+                }
+
+                // http_response_body(resp)
+                if (strcmp(fn_name, "__http_response_body") == 0 && expr->as.call.num_args == 1) {
+                    char *resp = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_http_response_body(%s);", result, resp);
+                    codegen_writeln(ctx, "hml_release(&%s);", resp);
+                    free(resp);
+                    break;
+                }
+
+                // http_response_close(resp)
+                if (strcmp(fn_name, "__http_response_close") == 0 && expr->as.call.num_args == 1) {
+                    char *resp = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_http_response_close(%s);", result, resp);
+                    codegen_writeln(ctx, "hml_release(&%s);", resp);
+                    free(resp);
+                    break;
+                }
+
+                // ========== HTTP SERVER BUILTINS ==========
+
+                // http_server_new(host, port, handler, config)
+                if (strcmp(fn_name, "__http_server_new") == 0 && expr->as.call.num_args == 4) {
+                    char *host = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *port = codegen_expr(ctx, expr->as.call.args[1]);
+                    char *handler = codegen_expr(ctx, expr->as.call.args[2]);
+                    char *config = codegen_expr(ctx, expr->as.call.args[3]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_http_server_new(%s, %s, %s, %s);", result, host, port, handler, config);
+                    codegen_writeln(ctx, "hml_release(&%s);", host);
+                    codegen_writeln(ctx, "hml_release(&%s);", port);
+                    codegen_writeln(ctx, "hml_release(&%s);", handler);
+                    codegen_writeln(ctx, "hml_release(&%s);", config);
+                    free(host);
+                    free(port);
+                    free(handler);
+                    free(config);
+                    break;
+                }
+
+                // http_server_port(server)
+                if (strcmp(fn_name, "__http_server_port") == 0 && expr->as.call.num_args == 1) {
+                    char *server = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_http_server_port(%s);", result, server);
+                    codegen_writeln(ctx, "hml_release(&%s);", server);
+                    free(server);
+                    break;
+                }
+
+                // http_server_stats(server)
+                if (strcmp(fn_name, "__http_server_stats") == 0 && expr->as.call.num_args == 1) {
+                    char *server = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_http_server_stats(%s);", result, server);
+                    codegen_writeln(ctx, "hml_release(&%s);", server);
+                    free(server);
+                    break;
+                }
+
+                // http_server_close(server)
+                if (strcmp(fn_name, "__http_server_close") == 0 && expr->as.call.num_args == 1) {
+                    char *server = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_http_server_close(%s);", result, server);
+                    codegen_writeln(ctx, "hml_release(&%s);", server);
+                    free(server);
+                    break;
+                }
+
+                // ========== LOG SINK BUILTINS ==========
+
+                // log_sink_open(target, config)
+                if (strcmp(fn_name, "__log_sink_open") == 0 && expr->as.call.num_args == 2) {
+                    char *target = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *config = codegen_expr(ctx, expr->as.call.args[1]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_log_sink_open(%s, %s);", result, target, config);
+                    codegen_writeln(ctx, "hml_release(&%s);", target);
+                    codegen_writeln(ctx, "hml_release(&%s);", config);
+                    free(target);
+                    free(config);
+                    break;
+                }
+
+                // log_sink_write(sink, line)
+                if (strcmp(fn_name, "__log_sink_write") == 0 && expr->as.call.num_args == 2) {
+                    char *sink = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *line = codegen_expr(ctx, expr->as.call.args[1]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_log_sink_write(%s, %s);", result, sink, line);
+                    codegen_writeln(ctx, "hml_release(&%s);", sink);
+                    codegen_writeln(ctx, "hml_release(&%s);", line);
+                    free(sink);
+                    free(line);
+                    break;
+                }
+
+                // log_sink_flush(sink)
+                if (strcmp(fn_name, "__log_sink_flush") == 0 && expr->as.call.num_args == 1) {
+                    char *sink = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_log_sink_flush(%s);", result, sink);
+                    codegen_writeln(ctx, "hml_release(&%s);", sink);
+                    free(sink);
+                    break;
+                }
+
+                // log_sink_stats(sink)
+                if (strcmp(fn_name, "__log_sink_stats") == 0 && expr->as.call.num_args == 1) {
+                    char *sink = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_log_sink_stats(%s);", result, sink);
+                    codegen_writeln(ctx, "hml_release(&%s);", sink);
+                    free(sink);
+                    break;
+                }
+
+                // log_sink_close(sink)
+                if (strcmp(fn_name, "__log_sink_close") == 0 && expr->as.call.num_args == 1) {
+                    char *sink = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_log_sink_close(%s);", result, sink);
+                    codegen_writeln(ctx, "hml_release(&%s);", sink);
+                    free(sink);
+                    break;
+                }
+
+                // log_timestamp()
+                if (strcmp(fn_name, "__log_timestamp") == 0 && expr->as.call.num_args == 0) {
+                    codegen_writeln(ctx, "HmlValue %s = hml_log_timestamp();", result);
+                    break;
+                }
+
+                // log_json(time, level, message, data)
+                if (strcmp(fn_name, "__log_json") == 0 && expr->as.call.num_args == 4) {
+                    char *time = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *level = codegen_expr(ctx, expr->as.call.args[1]);
+                    char *message = codegen_expr(ctx, expr->as.call.args[2]);
+                    char *data = codegen_expr(ctx, expr->as.call.args[3]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_log_json(%s, %s, %s, %s);", result, time, level, message, data);
+                    codegen_writeln(ctx, "hml_release(&%s);", time);
+                    codegen_writeln(ctx, "hml_release(&%s);", level);
+                    codegen_writeln(ctx, "hml_release(&%s);", message);
+                    codegen_writeln(ctx, "hml_release(&%s);", data);
+                    free(time);
+                    free(level);
+                    free(message);
+                    free(data);
+                    break;
+                }
+
+                // ========== SUBPROCESS BUILTINS ==========
+
+                // process_spawn(argv, options)
+                if (strcmp(fn_name, "__process_spawn") == 0 && expr->as.call.num_args == 2) {
+                    char *argv = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *options = codegen_expr(ctx, expr->as.call.args[1]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_process_spawn(%s, %s);", result, argv, options);
+                    codegen_writeln(ctx, "hml_release(&%s);", argv);
+                    codegen_writeln(ctx, "hml_release(&%s);", options);
+                    free(argv);
+                    free(options);
+                    break;
+                }
+
+                // process_pid(proc)
+                if (strcmp(fn_name, "__process_pid") == 0 && expr->as.call.num_args == 1) {
+                    char *proc = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_process_pid(%s);", result, proc);
+                    codegen_writeln(ctx, "hml_release(&%s);", proc);
+                    free(proc);
+                    break;
+                }
+
+                // process_read(proc, stream, max_bytes, timeout_ms)
+                if (strcmp(fn_name, "__process_read") == 0 && expr->as.call.num_args == 4) {
+                    char *proc = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *stream = codegen_expr(ctx, expr->as.call.args[1]);
+                    char *max_bytes = codegen_expr(ctx, expr->as.call.args[2]);
+                    char *timeout_ms = codegen_expr(ctx, expr->as.call.args[3]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_process_read(%s, %s, %s, %s);", result, proc, stream, max_bytes, timeout_ms);
+                    codegen_writeln(ctx, "hml_release(&%s);", proc);
+                    codegen_writeln(ctx, "hml_release(&%s);", stream);
+                    codegen_writeln(ctx, "hml_release(&%s);", max_bytes);
+                    codegen_writeln(ctx, "hml_release(&%s);", timeout_ms);
+                    free(proc);
+                    free(stream);
+                    free(max_bytes);
+                    free(timeout_ms);
+                    break;
+                }
+
+                // process_read_line(proc, stream)
+                if (strcmp(fn_name, "__process_read_line") == 0 && expr->as.call.num_args == 2) {
+                    char *proc = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *stream = codegen_expr(ctx, expr->as.call.args[1]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_process_read_line(%s, %s);", result, proc, stream);
+                    codegen_writeln(ctx, "hml_release(&%s);", proc);
+                    codegen_writeln(ctx, "hml_release(&%s);", stream);
+                    free(proc);
+                    free(stream);
+                    break;
+                }
+
+                // process_write(proc, data)
+                if (strcmp(fn_name, "__process_write") == 0 && expr->as.call.num_args == 2) {
+                    char *proc = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *data = codegen_expr(ctx, expr->as.call.args[1]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_process_write(%s, %s);", result, proc, data);
+                    codegen_writeln(ctx, "hml_release(&%s);", proc);
+                    codegen_writeln(ctx, "hml_release(&%s);", data);
+                    free(proc);
+                    free(data);
+                    break;
+                }
+
+                // process_close_stdin(proc)
+                if (strcmp(fn_name, "__process_close_stdin") == 0 && expr->as.call.num_args == 1) {
+                    char *proc = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_process_close_stdin(%s);", result, proc);
+                    codegen_writeln(ctx, "hml_release(&%s);", proc);
+                    free(proc);
+                    break;
+                }
+
+                // process_poll(procs, timeout_ms)
+                if (strcmp(fn_name, "__process_poll") == 0 && expr->as.call.num_args == 2) {
+                    char *procs = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *timeout_ms = codegen_expr(ctx, expr->as.call.args[1]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_process_poll(%s, %s);", result, procs, timeout_ms);
+                    codegen_writeln(ctx, "hml_release(&%s);", procs);
+                    codegen_writeln(ctx, "hml_release(&%s);", timeout_ms);
+                    free(procs);
+                    free(timeout_ms);
+                    break;
+                }
+
+                // process_wait(proc, timeout_ms)
+                if (strcmp(fn_name, "__process_wait") == 0 && expr->as.call.num_args == 2) {
+                    char *proc = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *timeout_ms = codegen_expr(ctx, expr->as.call.args[1]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_process_wait(%s, %s);", result, proc, timeout_ms);
+                    codegen_writeln(ctx, "hml_release(&%s);", proc);
+                    codegen_writeln(ctx, "hml_release(&%s);", timeout_ms);
+                    free(proc);
+                    free(timeout_ms);
+                    break;
+                }
+
+                // process_kill(proc, signal)
+                if (strcmp(fn_name, "__process_kill") == 0 && expr->as.call.num_args == 2) {
+                    char *proc = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *signal = codegen_expr(ctx, expr->as.call.args[1]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_process_kill(%s, %s);", result, proc, signal);
+                    codegen_writeln(ctx, "hml_release(&%s);", proc);
+                    codegen_writeln(ctx, "hml_release(&%s);", signal);
+                    free(proc);
+                    free(signal);
+                    break;
+                }
+
+                // process_communicate(proc, input)
+                if (strcmp(fn_name, "__process_communicate") == 0 && expr->as.call.num_args == 2) {
+                    char *proc = codegen_expr(ctx, expr->as.call.args[0]);
+                    char *input = codegen_expr(ctx, expr->as.call.args[1]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_process_communicate(%s, %s);", result, proc, input);
+                    codegen_writeln(ctx, "hml_release(&%s);", proc);
+                    codegen_writeln(ctx, "hml_release(&%s);", input);
+                    free(proc);
+                    free(input);
+                    break;
+                }
+
+                // process_close(proc)
+                if (strcmp(fn_name, "__process_close") == 0 && expr->as.call.num_args == 1) {
+                    char *proc = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_process_close(%s);", result, proc);
+                    codegen_writeln(ctx, "hml_release(&%s);", proc);
+                    free(proc);
+                    break;
+                }
+
+                // ========== ENCODING BUILTINS ==========
+
+                // base64_encode(data)
+                if (strcmp(fn_name, "__base64_encode") == 0 && expr->as.call.num_args == 1) {
+                    char *data = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_base64_encode(%s);", result, data);
+                    codegen_writeln(ctx, "hml_release(&%s);", data);
+                    free(data);
+                    break;
+                }
+
+                // base64_decode(data)
+                if (strcmp(fn_name, "__base64_decode") == 0 && expr->as.call.num_args == 1) {
+                    char *data = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_base64_decode(%s);", result, data);
+                    codegen_writeln(ctx, "hml_release(&%s);", data);
+                    free(data);
+                    break;
+                }
+
+                // hex_encode(data)
+                if (strcmp(fn_name, "__hex_encode") == 0 && expr->as.call.num_args == 1) {
+                    char *data = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_hex_encode(%s);", result, data);
+                    codegen_writeln(ctx, "hml_release(&%s);", data);
+                    free(data);
+                    break;
+                }
+
+                // hex_decode(data)
+                if (strcmp(fn_name, "__hex_decode") == 0 && expr->as.call.num_args == 1) {
+                    char *data = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_hex_decode(%s);", result, data);
+                    codegen_writeln(ctx, "hml_release(&%s);", data);
+                    free(data);
+                    break;
+                }
+
+                // url_encode(data)
+                if (strcmp(fn_name, "__url_encode") == 0 && expr->as.call.num_args == 1) {
+                    char *data = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_url_encode(%s);", result, data);
+                    codegen_writeln(ctx, "hml_release(&%s);", data);
+                    free(data);
+                    break;
+                }
+
+                // url_decode(data)
+                if (strcmp(fn_name, "__url_decode") == 0 && expr->as.call.num_args == 1) {
+                    char *data = codegen_expr(ctx, expr->as.call.args[0]);
+                    codegen_writeln(ctx, "HmlValue %s = hml_url_decode(%s);", result, data);
+                    codegen_writeln(ctx, "hml_release(&%s);", data);
+                    free(data);
+                    break;
+                }
+
                 // ========== STRING UTILITY BUILTINS ==========
 
                 // to_string(value)
@@ -2090,6 +2954,30 @@ char* codegen_expr(CodegenContext *ctx, Expr *expr) {
                     arg_temps[i] = codegen_expr(ctx, expr->as.call.args[i]);
                 }
 
+                // An object's own method wins over a builtin of the same name;
+                // the builtin chain below then writes into an inner temp
+                char *method_result = NULL;
+                if (codegen_is_builtin_method(method)) {
+                    method_result = result;
+                    result = codegen_temp(ctx);
+                    codegen_writeln(ctx, "HmlValue %s;", method_result);
+                    codegen_writeln(ctx, "if (%s.type == HML_VAL_OBJECT && hml_object_has_field(%s, \"%s\")) {",
+                                  obj_val, obj_val, method);
+                    if (expr->as.call.num_args > 0) {
+                        codegen_writeln(ctx, "    HmlValue _method_args%d[%d];", ctx->temp_counter, expr->as.call.num_args);
+                        for (int i = 0; i < expr->as.call.num_args; i++) {
+                            codegen_writeln(ctx, "    _method_args%d[%d] = %s;", ctx->temp_counter, i, arg_temps[i]);
+                        }
+                        codegen_writeln(ctx, "    %s = hml_call_method(%s, \"%s\", _method_args%d, %d);",
+                                      method_result, obj_val, method, ctx->temp_counter, expr->as.call.num_args);
+                        ctx->temp_counter++;
+                    } else {
+                        codegen_writeln(ctx, "    %s = hml_call_method(%s, \"%s\", NULL, 0);",
+                                      method_result, obj_val, method);
+                    }
+                    codegen_writeln(ctx, "} else {");
+                }
+
                 // Methods that work on both strings and arrays - need runtime type check
                 if (strcmp(method, "slice") == 0 && expr->as.call.num_args == 2) {
                     codegen_writeln(ctx, "HmlValue %s;", result);
@@ -2256,21 +3144,30 @@ char* codegen_expr(CodegenContext *ctx, Expr *expr) {
                 } else if (strcmp(method, "write") == 0 && expr->as.call.num_args == 1) {
                     codegen_writeln(ctx, "HmlValue %s = hml_file_write(%s, %s);",
                                   result, obj_val, arg_temps[0]);
+                } else if (strcmp(method, "read_bytes") == 0 && expr->as.call.num_args == 1) {
+                    codegen_writeln(ctx, "HmlValue %s = hml_file_read_bytes(%s, %s);",
+                                  result, obj_val, arg_temps[0]);
+                } else if (strcmp(method, "write_bytes") == 0 && expr->as.call.num_args == 1) {
+                    codegen_writeln(ctx, "HmlValue %s = hml_file_write_bytes(%s, %s);",
+                                  result, obj_val, arg_temps[0]);
                 } else if (strcmp(method, "seek") == 0 && expr->as.call.num_args == 1) {
                     codegen_writeln(ctx, "HmlValue %s = hml_file_seek(%s, %s);",
                                   result, obj_val, arg_temps[0]);
                 } else if (strcmp(method, "tell") == 0 && expr->as.call.num_args == 0) {
                     codegen_writeln(ctx, "HmlValue %s = hml_file_tell(%s);", result, obj_val);
                 } else if (strcmp(method, "close") == 0 && expr->as.call.num_args == 0) {
-                    // Handle file.close(), channel.close(), and socket.close()
+                    // Handle file.close(), channel.close(), and socket.close();
+                    // objects (e.g. stdlib handles) dispatch to their own close method
+                    codegen_writeln(ctx, "HmlValue %s = hml_val_null();", result);
                     codegen_writeln(ctx, "if (%s.type == HML_VAL_FILE) {", obj_val);
                     codegen_writeln(ctx, "    hml_file_close(%s);", obj_val);
                     codegen_writeln(ctx, "} else if (%s.type == HML_VAL_CHANNEL) {", obj_val);
                     codegen_writeln(ctx, "    hml_channel_close(%s);", obj_val);
                     codegen_writeln(ctx, "} else if (%s.type == HML_VAL_SOCKET) {", obj_val);
                     codegen_writeln(ctx, "    hml_socket_close(%s);", obj_val);
+                    codegen_writeln(ctx, "} else if (%s.type == HML_VAL_OBJECT) {", obj_val);
+                    codegen_writeln(ctx, "    %s = hml_call_method(%s, \"close\", NULL, 0);", result, obj_val);
                     codegen_writeln(ctx, "}");
-                    codegen_writeln(ctx, "HmlValue %s = hml_val_null();", result);
                 } else if (strcmp(method, "map") == 0 && expr->as.call.num_args == 1) {
                     codegen_writeln(ctx, "HmlValue %s = hml_array_map(%s, %s);",
                                   result, obj_val, arg_temps[0]);
@@ -2307,6 +3204,11 @@ char* codegen_expr(CodegenContext *ctx, Expr *expr) {
                         codegen_writeln(ctx, "%s = hml_socket_recv(%s, %s);", result, obj_val, arg_temps[0]);
                     }
                 // Socket-specific methods
+                } else if (strcmp(method, "send_file") == 0 && expr->as.call.num_args >= 1 && expr->as.call.num_args <= 3) {
+                    codegen_writeln(ctx, "HmlValue %s = hml_socket_send_file(%s, %s, %s, %s);",
+                                  result, obj_val, arg_temps[0],
+                                  expr->as.call.num_args >= 2 ? arg_temps[1] : "hml_val_null()",
+                                  expr->as.call.num_args == 3 ? arg_temps[2] : "hml_val_null()");
                 } else if (strcmp(method, "bind") == 0 && expr->as.call.num_args == 2) {
                     codegen_writeln(ctx, "hml_socket_bind(%s, %s, %s);", obj_val, arg_temps[0], arg_temps[1]);
                     codegen_writeln(ctx, "HmlValue %s = hml_val_null();", result);
@@ -2353,6 +3255,13 @@ char* codegen_expr(CodegenContext *ctx, Expr *expr) {
                     }
                 }
 
+                if (method_result) {
+                    codegen_writeln(ctx, "%s = %s;", method_result, result);
+                    codegen_writeln(ctx, "}");
+                    free(result);
+                    result = method_result;
+                }
+
                 // Release temporaries
                 codegen_writeln(ctx, "hml_release(&%s);", obj_val);
                 for (int i = 0; i < expr->as.call.num_args; i++) {
@@ -2420,8 +3329,10 @@ char* codegen_expr(CodegenContext *ctx, Expr *expr) {
             } else if (codegen_is_shadow(ctx, var_name)) {
                 // Shadow variable (like catch param) - use bare name
                 // var_name stays as-is
-            } else if (codegen_is_local(ctx, var_name) && !codegen_is_main_var(ctx, var_name)) {
-                // True local variable (not a main var added for tracking) - use bare name
+            } else if (codegen_is_local(ctx, var_name) &&
+                       (ctx->current_module || !codegen_is_main_var(ctx, var_name))) {
+                // True local variable (not a main var added for tracking) - use bare name.
+                // Main file names never apply inside a module, matching reads.
                 // var_name stays as-is
             } else if (codegen_is_main_var(ctx, expr->as.assign.name)) {
                 // Main file top-level variable - use _main_ prefix
@@ -12,6 +12,7 @@
 #include "codegen.h"
 #include "../../include/lexer.h"
 #include "../../include/parser.h"
+#include "../../include/ast_optimize.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -41,6 +42,8 @@ void codegen_pop_try_finally(CodegenContext *ctx);
 const char* codegen_get_finally_label(CodegenContext *ctx);
 const char* codegen_get_return_value_var(CodegenContext *ctx);
 const char* codegen_get_has_return_var(CodegenContext *ctx);
+int codegen_get_finally_try_depth(CodegenContext *ctx);
+void codegen_exception_unwind(CodegenContext *ctx, int count);
 
 // Main file variable tracking
 void codegen_add_main_var(CodegenContext *ctx, const char *name);
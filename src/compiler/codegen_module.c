@@ -294,6 +294,7 @@ Stmt** parse_module_file(const char *path, int *stmt_count) {
         return NULL;
     }
 
+    ast_optimize(statements, *stmt_count);
     return statements;
 }
 
@@ -321,6 +322,7 @@ CompiledModule* module_compile(CodegenContext *ctx, const char *absolute_path) {
     module->imports = NULL;
     module->num_imports = 0;
     module->import_capacity = 0;
+    module->anon_counter = 0;
 
     // Add to cache (for cycle detection)
     module->next = cache->modules;
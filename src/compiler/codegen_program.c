@@ -42,6 +42,7 @@ void codegen_function_decl(CodegenContext *ctx, Expr *func, const char *name) {
     }
     codegen_write(ctx, ") {\n");
     codegen_indent_inc(ctx);
+    codegen_reset_counters(ctx);
     // Suppress unused parameter warning
     codegen_writeln(ctx, "(void)_closure_env;");
 
@@ -49,6 +50,10 @@ void codegen_function_decl(CodegenContext *ctx, Expr *func, const char *name) {
     int saved_num_locals = ctx->num_locals;
     DeferEntry *saved_defer_stack = ctx->defer_stack;
     ctx->defer_stack = NULL;  // Start fresh for this function
+    int saved_try_depth = ctx->try_depth;
+    int saved_break_try_depth = ctx->break_try_depth;
+    ctx->try_depth = 0;
+    ctx->break_try_depth = 0;
     int saved_in_function = ctx->in_function;
     ctx->in_function = 1;  // We're now inside a function
 
@@ -107,6 +112,8 @@ void codegen_function_decl(CodegenContext *ctx, Expr *func, const char *name) {
     // Restore locals, defer state, and in_function flag
     codegen_defer_clear(ctx);
     ctx->defer_stack = saved_defer_stack;
+    ctx->try_depth = saved_try_depth;
+    ctx->break_try_depth = saved_break_try_depth;
     ctx->num_locals = saved_num_locals;
     ctx->in_function = saved_in_function;
 }
@@ -122,11 +129,16 @@ void codegen_closure_impl(CodegenContext *ctx, ClosureInfo *closure) {
     }
     codegen_write(ctx, ") {\n");
     codegen_indent_inc(ctx);
+    codegen_reset_counters(ctx);
 
     // Save locals, defer state, module context, current closure, and in_function flag
     int saved_num_locals = ctx->num_locals;
     DeferEntry *saved_defer_stack = ctx->defer_stack;
     ctx->defer_stack = NULL;  // Start fresh for this function
+    int saved_try_depth = ctx->try_depth;
+    int saved_break_try_depth = ctx->break_try_depth;
+    ctx->try_depth = 0;
+    ctx->break_try_depth = 0;
     CompiledModule *saved_module = ctx->current_module;
     ctx->current_module = closure->source_module;  // Restore module context for function resolution
     ClosureInfo *saved_closure = ctx->current_closure;
@@ -257,6 +269,8 @@ void codegen_closure_impl(CodegenContext *ctx, ClosureInfo *closure) {
     // Restore locals, defer state, module context, current closure, in_function flag, and clear shared environment
     codegen_defer_clear(ctx);
     ctx->defer_stack = saved_defer_stack;
+    ctx->try_depth = saved_try_depth;
+    ctx->break_try_depth = saved_break_try_depth;
     ctx->num_locals = saved_num_locals;
     ctx->current_module = saved_module;
     ctx->current_closure = saved_closure;
@@ -290,15 +304,17 @@ void codegen_closure_wrapper(CodegenContext *ctx, ClosureInfo *closure) {
 void codegen_module_init(CodegenContext *ctx, CompiledModule *module) {
     codegen_write(ctx, "// Module init: %s\n", module->absolute_path);
     codegen_write(ctx, "static int %sinit_done = 0;\n", module->module_prefix);
-    codegen_write(ctx, "static void %sinit(void) {\n", module->module_prefix);
+    codegen_write(ctx, "void %sinit(void) {\n", module->module_prefix);
     codegen_indent_inc(ctx);
+    codegen_reset_counters(ctx);
     codegen_writeln(ctx, "if (%sinit_done) return;", module->module_prefix);
     codegen_writeln(ctx, "%sinit_done = 1;", module->module_prefix);
     codegen_writeln(ctx, "");
 
-    // Save current module context
+    // Save current module context (and locals, so none leak into later code)
     CompiledModule *saved_module = ctx->current_module;
     ctx->current_module = module;
+    int saved_num_locals = ctx->num_locals;
 
     // First call init functions of imported modules
     for (int i = 0; i < module->num_statements; i++) {
@@ -359,6 +375,7 @@ void codegen_module_init(CodegenContext *ctx, CompiledModule *module) {
 
     // Restore module context
     ctx->current_module = saved_module;
+    ctx->num_locals = saved_num_locals;
 
     codegen_indent_dec(ctx);
     codegen_write(ctx, "}\n\n");
@@ -410,12 +427,17 @@ void codegen_module_funcs(CodegenContext *ctx, CompiledModule *module, FILE *dec
             }
             codegen_write(ctx, ") {\n");
             codegen_indent_inc(ctx);
+            codegen_reset_counters(ctx);
             codegen_writeln(ctx, "(void)_closure_env;");
 
             // Save and reset locals
             int saved_num_locals = ctx->num_locals;
             DeferEntry *saved_defer_stack = ctx->defer_stack;
             ctx->defer_stack = NULL;
+            int saved_try_depth = ctx->try_depth;
+            int saved_break_try_depth = ctx->break_try_depth;
+            ctx->try_depth = 0;
+            ctx->break_try_depth = 0;
 
             // Reset closure env tracking to prevent cross-function pollution
             ctx->last_closure_env_id = -1;
@@ -484,6 +506,8 @@ void codegen_module_funcs(CodegenContext *ctx, CompiledModule *module, FILE *dec
             // Restore locals, defer state, and clear shared environment
             codegen_defer_clear(ctx);
             ctx->defer_stack = saved_defer_stack;
+            ctx->try_depth = saved_try_depth;
+            ctx->break_try_depth = saved_break_try_depth;
             ctx->num_locals = saved_num_locals;
             shared_env_clear(ctx);
 
@@ -554,15 +578,301 @@ static void collect_extern_fn_from_stmt(Stmt *stmt, ExternFnList *list) {
     }
 }
 
+// Helpers for extern fn wrappers. Extern functions whose parameter and return
+// types all map onto plain C types are called directly through a typed function
+// pointer; anything else goes through hml_ffi_call (libffi).
+
+// C type used in the generated prototype, or NULL if the type needs libffi
+static const char* extern_c_type(Type *type) {
+    if (!type) return "int32_t";
+    switch (type->kind) {
+        case TYPE_I8:     return "int8_t";
+        case TYPE_I16:    return "int16_t";
+        case TYPE_I32:    return "int32_t";
+        case TYPE_I64:    return "int64_t";
+        case TYPE_U8:     return "uint8_t";
+        case TYPE_U16:    return "uint16_t";
+        case TYPE_U32:    return "uint32_t";
+        case TYPE_U64:    return "uint64_t";
+        case TYPE_F32:    return "float";
+        case TYPE_F64:    return "double";
+        case TYPE_BOOL:   return "int";
+        case TYPE_PTR:    return "void*";
+        case TYPE_BUFFER: return "void*";
+        case TYPE_STRING: return "char*";
+        default:          return NULL;
+    }
+}
+
+// Emit the expression converting wrapper argument _argN to its C type
+static void extern_write_arg(CodegenContext *ctx, Type *type, int index) {
+    switch (type ? type->kind : TYPE_I32) {
+        case TYPE_I8:     codegen_write(ctx, "(int8_t)hml_to_i32(_arg%d)", index); break;
+        case TYPE_I16:    codegen_write(ctx, "(int16_t)hml_to_i32(_arg%d)", index); break;
+        case TYPE_U8:     codegen_write(ctx, "(uint8_t)hml_to_i32(_arg%d)", index); break;
+        case TYPE_U16:    codegen_write(ctx, "(uint16_t)hml_to_i32(_arg%d)", index); break;
+        case TYPE_U32:    codegen_write(ctx, "(uint32_t)hml_to_i32(_arg%d)", index); break;
+        case TYPE_I64:    codegen_write(ctx, "hml_to_i64(_arg%d)", index); break;
+        case TYPE_U64:    codegen_write(ctx, "(uint64_t)hml_to_i64(_arg%d)", index); break;
+        case TYPE_F32:    codegen_write(ctx, "(float)hml_to_f64(_arg%d)", index); break;
+        case TYPE_F64:    codegen_write(ctx, "hml_to_f64(_arg%d)", index); break;
+        case TYPE_BOOL:   codegen_write(ctx, "hml_to_bool(_arg%d)", index); break;
+        case TYPE_PTR:
+        case TYPE_BUFFER: codegen_write(ctx, "hml_ffi_arg_ptr(_arg%d)", index); break;
+        case TYPE_STRING: codegen_write(ctx, "hml_ffi_arg_string(_arg%d)", index); break;
+        default:          codegen_write(ctx, "hml_to_i32(_arg%d)", index); break;
+    }
+}
+
+// Constructor wrapping the C return value _r into an HmlValue
+static const char* extern_ret_ctor(Type *type) {
+    switch (type ? type->kind : TYPE_I32) {
+        case TYPE_I8:     return "hml_val_i8";
+        case TYPE_I16:    return "hml_val_i16";
+        case TYPE_I64:    return "hml_val_i64";
+        case TYPE_U8:     return "hml_val_u8";
+        case TYPE_U16:    return "hml_val_u16";
+        case TYPE_U32:    return "hml_val_u32";
+        case TYPE_U64:    return "hml_val_u64";
+        case TYPE_F32:    return "hml_val_f32";
+        case TYPE_F64:    return "hml_val_f64";
+        case TYPE_BOOL:   return "hml_val_bool";
+        case TYPE_PTR:
+        case TYPE_BUFFER: return "hml_val_ptr";
+        case TYPE_STRING: return "hml_ffi_ret_string";
+        default:          return "hml_val_i32";
+    }
+}
+
+// Check whether an extern fn can be called through a typed C prototype
+static int extern_fn_is_direct(Stmt *stmt) {
+    Type *ret = stmt->as.extern_fn.return_type;
+    if (ret && ret->kind != TYPE_VOID && !extern_c_type(ret)) return 0;
+    for (int i = 0; i < stmt->as.extern_fn.num_params; i++) {
+        if (!extern_c_type(stmt->as.extern_fn.param_types[i])) return 0;
+    }
+    return 1;
+}
+
+// Generate a wrapper that calls the resolved symbol with native marshalling
+static void generate_direct_extern_wrapper(CodegenContext *ctx, Stmt *stmt) {
+    const char *fn_name = stmt->as.extern_fn.function_name;
+    int num_params = stmt->as.extern_fn.num_params;
+    Type *return_type = stmt->as.extern_fn.return_type;
+    int is_void = return_type && return_type->kind == TYPE_VOID;
+    const char *ret_c = is_void ? "void" : extern_c_type(return_type);
+
+    codegen_write(ctx, "// FFI wrapper for %s (direct call)\n", fn_name);
+    codegen_write(ctx, "HmlValue hml_fn_%s(HmlClosureEnv *_env", fn_name);
+    for (int j = 0; j < num_params; j++) {
+        codegen_write(ctx, ", HmlValue _arg%d", j);
+    }
+    codegen_write(ctx, ") {\n");
+    codegen_write(ctx, "    (void)_env;\n");
+    codegen_write(ctx, "    if (!_ffi_ptr_%s) {\n", fn_name);
+    codegen_write(ctx, "        _ffi_ptr_%s = hml_ffi_sym(_ffi_lib, \"%s\");\n", fn_name, fn_name);
+    codegen_write(ctx, "    }\n");
+    codegen_write(ctx, "    typedef %s (*_fn_t)(", ret_c);
+    if (num_params == 0) {
+        codegen_write(ctx, "void");
+    }
+    for (int j = 0; j < num_params; j++) {
+        codegen_write(ctx, "%s%s", j > 0 ? ", " : "", extern_c_type(stmt->as.extern_fn.param_types[j]));
+    }
+    codegen_write(ctx, ");\n");
+    if (is_void) {
+        codegen_write(ctx, "    ((_fn_t)_ffi_ptr_%s)(", fn_name);
+    } else {
+        codegen_write(ctx, "    %s _r = ((_fn_t)_ffi_ptr_%s)(", ret_c, fn_name);
+    }
+    for (int j = 0; j < num_params; j++) {
+        if (j > 0) codegen_write(ctx, ", ");
+        extern_write_arg(ctx, stmt->as.extern_fn.param_types[j], j);
+    }
+    codegen_write(ctx, ");\n");
+    if (is_void) {
+        codegen_write(ctx, "    return hml_val_null();\n");
+    } else {
+        codegen_write(ctx, "    return %s(_r);\n", extern_ret_ctor(return_type));
+    }
+    codegen_write(ctx, "}\n\n");
+}
+
+// Generate a wrapper that calls the resolved symbol through libffi
+static void generate_ffi_extern_wrapper(CodegenContext *ctx, Stmt *stmt) {
+    const char *fn_name = stmt->as.extern_fn.function_name;
+    int num_params = stmt->as.extern_fn.num_params;
+    Type *return_type = stmt->as.extern_fn.return_type;
+
+    codegen_write(ctx, "// FFI wrapper for %s\n", fn_name);
+    codegen_write(ctx, "HmlValue hml_fn_%s(HmlClosureEnv *_env", fn_name);
+    for (int j = 0; j < num_params; j++) {
+        codegen_write(ctx, ", HmlValue _arg%d", j);
+    }
+    codegen_write(ctx, ") {\n");
+    codegen_write(ctx, "    (void)_env;\n");
+    codegen_write(ctx, "    if (!_ffi_ptr_%s) {\n", fn_name);
+    codegen_write(ctx, "        _ffi_ptr_%s = hml_ffi_sym(_ffi_lib, \"%s\");\n", fn_name, fn_name);
+    codegen_write(ctx, "    }\n");
+    codegen_write(ctx, "    HmlFFIType _types[%d];\n", num_params + 1);
+
+    // Return type
+    const char *ret_str = "HML_FFI_VOID";
+    if (return_type) {
+        switch (return_type->kind) {
+            case TYPE_I8: ret_str = "HML_FFI_I8"; break;
+            case TYPE_I16: ret_str = "HML_FFI_I16"; break;
+            case TYPE_I32: ret_str = "HML_FFI_I32"; break;
+            case TYPE_I64: ret_str = "HML_FFI_I64"; break;
+            case TYPE_U8: ret_str = "HML_FFI_U8"; break;
+            case TYPE_U16: ret_str = "HML_FFI_U16"; break;
+            case TYPE_U32: ret_str = "HML_FFI_U32"; break;
+            case TYPE_U64: ret_str = "HML_FFI_U64"; break;
+            case TYPE_F32: ret_str = "HML_FFI_F32"; break;
+            case TYPE_F64: ret_str = "HML_FFI_F64"; break;
+            case TYPE_PTR: ret_str = "HML_FFI_PTR"; break;
+            case TYPE_STRING: ret_str = "HML_FFI_STRING"; break;
+            default: ret_str = "HML_FFI_I32"; break;
+        }
+    }
+    codegen_write(ctx, "    _types[0] = %s;\n", ret_str);
+
+    // Parameter types
+    for (int j = 0; j < num_params; j++) {
+        Type *ptype = stmt->as.extern_fn.param_types[j];
+        const char *type_str = "HML_FFI_I32";
+        if (ptype) {
+            switch (ptype->kind) {
+                case TYPE_I8: type_str = "HML_FFI_I8"; break;
+                case TYPE_I16: type_str = "HML_FFI_I16"; break;
+                case TYPE_I32: type_str = "HML_FFI_I32"; break;
+                case TYPE_I64: type_str = "HML_FFI_I64"; break;
+                case TYPE_U8: type_str = "HML_FFI_U8"; break;
+                case TYPE_U16: type_str = "HML_FFI_U16"; break;
+                case TYPE_U32: type_str = "HML_FFI_U32"; break;
+                case TYPE_U64: type_str = "HML_FFI_U64"; break;
+                case TYPE_F32: type_str = "HML_FFI_F32"; break;
+                case TYPE_F64: type_str = "HML_FFI_F64"; break;
+                case TYPE_PTR: type_str = "HML_FFI_PTR"; break;
+                case TYPE_STRING: type_str = "HML_FFI_STRING"; break;
+                default: type_str = "HML_FFI_I32"; break;
+            }
+        }
+        codegen_write(ctx, "    _types[%d] = %s;\n", j + 1, type_str);
+    }
+
+    if (num_params > 0) {
+        codegen_write(ctx, "    HmlValue _args[%d];\n", num_params);
+        for (int j = 0; j < num_params; j++) {
+            codegen_write(ctx, "    _args[%d] = _arg%d;\n", j, j);
+        }
+        codegen_write(ctx, "    return hml_ffi_call(_ffi_ptr_%s, _args, %d, _types);\n", fn_name, num_params);
+    } else {
+        codegen_write(ctx, "    return hml_ffi_call(_ffi_ptr_%s, NULL, 0, _types);\n", fn_name);
+    }
+    codegen_write(ctx, "}\n\n");
+}
+
+// ========== TRANSLATION UNITS ==========
+
+// Output buffers for one translation unit while the program is generated
+typedef struct {
+    CompiledModule *module;  // NULL for the main file
+    FILE *funcs;             // Function implementations (and the module init)
+    FILE *closures;          // Closure implementations
+} UnitBuffers;
+
+// Append everything written to a buffer to the current output
+static void copy_buffer(CodegenContext *ctx, FILE *buffer) {
+    rewind(buffer);
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), buffer)) > 0) {
+        fwrite(buf, 1, n, ctx->output);
+    }
+}
+
+// Unit buffers holding the code of a module (NULL for the main file)
+static UnitBuffers* unit_for_module(UnitBuffers *units, int num_units, CompiledModule *module) {
+    for (int i = 1; i < num_units; i++) {
+        if (units[i].module == module) {
+            return &units[i];
+        }
+    }
+    return &units[0];
+}
+
+// Forward declarations for the closures defined in one unit
+static void write_closure_decls(CodegenContext *ctx, CompiledModule *module) {
+    int first = 1;
+    for (ClosureInfo *c = ctx->closures; c; c = c->next) {
+        if (c->source_module != module) continue;
+        if (first) {
+            codegen_write(ctx, "// Closure forward declarations\n");
+            first = 0;
+        }
+        Expr *func = c->func_expr;
+        codegen_write(ctx, "HmlValue %s(HmlClosureEnv *_closure_env", c->func_name);
+        for (int i = 0; i < func->as.function.num_params; i++) {
+            codegen_write(ctx, ", HmlValue %s", func->as.function.param_names[i]);
+        }
+        codegen_write(ctx, ");\n");
+    }
+    if (!first) {
+        codegen_write(ctx, "\n");
+    }
+}
+
+// Declaration of an extern fn wrapper (shared by all units)
+static void write_extern_fn_decl(CodegenContext *ctx, Stmt *stmt) {
+    codegen_write(ctx, "HmlValue hml_fn_%s(HmlClosureEnv *_closure_env", stmt->as.extern_fn.function_name);
+    for (int j = 0; j < stmt->as.extern_fn.num_params; j++) {
+        codegen_write(ctx, ", HmlValue _arg%d", j);
+    }
+    codegen_write(ctx, ");\n");
+}
+
 void codegen_program(CodegenContext *ctx, Stmt **stmts, int stmt_count) {
+    CodegenProgram *program = codegen_program_units(ctx, stmts, stmt_count);
+    codegen_program_write(program, ctx->output);
+    codegen_program_free(program);
+}
+
+void codegen_program_write(const CodegenProgram *program, FILE *out) {
+    fwrite(program->header, 1, program->header_length, out);
+    // Modules first so the file reads top-down, main() last
+    for (int i = 1; i < program->num_units; i++) {
+        fwrite(program->units[i].source, 1, program->units[i].length, out);
+    }
+    if (program->num_units > 0) {
+        fwrite(program->units[0].source, 1, program->units[0].length, out);
+    }
+}
+
+void codegen_program_free(CodegenProgram *program) {
+    if (!program) return;
+    for (int i = 0; i < program->num_units; i++) {
+        free(program->units[i].name);
+        free(program->units[i].source);
+    }
+    free(program->units);
+    free(program->header);
+    free(program);
+}
+
+CodegenProgram* codegen_program_units(CodegenContext *ctx, Stmt **stmts, int stmt_count) {
     // Multi-pass approach:
     // 1. First pass through imports to compile all modules
-    // 2. Generate named function bodies to a buffer to collect closures
-    // 3. Output header + all forward declarations (functions + closures)
-    // 4. Output module global variables and init functions
-    // 5. Output closure implementations
-    // 6. Output named function implementations
-    // 7. Output main function
+    // 2. Generate module functions, named functions, main() and module init
+    //    functions into per-unit buffers (this collects closures)
+    // 3. Generate each closure into the unit of the module that defined it
+    // 4. Output the shared header: runtime includes plus everything one unit
+    //    can reference in another (module exports, functions, init functions, FFI)
+    // 5. Output each unit: its globals, forward declarations, closures and
+    //    functions, with main() in the main file's unit
+    //
+    // A unit's text depends only on its own module and the shared header, so
+    // an edit inside one module leaves every other unit byte-for-byte the same.
 
     // First pass: compile all imported modules
     if (ctx->module_cache) {
@@ -578,11 +888,28 @@ void codegen_program(CodegenContext *ctx, Stmt **stmts, int stmt_count) {
         }
     }
 
-    // Buffer for named function implementations
-    FILE *func_buffer = tmpfile();
+
+    // One unit for the main file, then one per module
+    int num_units = 1;
+    if (ctx->module_cache) {
+        for (CompiledModule *mod = ctx->module_cache->modules; mod; mod = mod->next) {
+            num_units++;
+        }
+    }
+    UnitBuffers *units = calloc(num_units, sizeof(UnitBuffers));
+    if (ctx->module_cache) {
+        int u = 1;
+        for (CompiledModule *mod = ctx->module_cache->modules; mod; mod = mod->next) {
+            units[u++].module = mod;
+        }
+    }
+    for (int u = 0; u < num_units; u++) {
+        units[u].funcs = tmpfile();
+        units[u].closures = tmpfile();
+    }
+
     FILE *main_buffer = tmpfile();
     FILE *module_decl_buffer = tmpfile();
-    FILE *module_impl_buffer = tmpfile();
     FILE *saved_output = ctx->output;
 
     // Pre-pass: Collect all main file variable names BEFORE generating code
@@ -640,16 +967,12 @@ void codegen_program(CodegenContext *ctx, Stmt **stmts, int stmt_count) {
     }
 
     // Generate module functions first (to collect closures)
-    if (ctx->module_cache) {
-        CompiledModule *mod = ctx->module_cache->modules;
-        while (mod) {
-            codegen_module_funcs(ctx, mod, module_decl_buffer, module_impl_buffer);
-            mod = mod->next;
-        }
+    for (int u = 1; u < num_units; u++) {
+        codegen_module_funcs(ctx, units[u].module, module_decl_buffer, units[u].funcs);
     }
 
     // Pass 1: Generate named function bodies to buffer (this collects closures)
-    ctx->output = func_buffer;
+    ctx->output = units[0].funcs;
     for (int i = 0; i < stmt_count; i++) {
         char *name;
         Expr *func;
@@ -662,6 +985,7 @@ void codegen_program(CodegenContext *ctx, Stmt **stmts, int stmt_count) {
     ctx->output = main_buffer;
     codegen_write(ctx, "int main(int argc, char **argv) {\n");
     codegen_indent_inc(ctx);
+    codegen_reset_counters(ctx);
     codegen_writeln(ctx, "hml_runtime_init(argc, argv);");
     codegen_writeln(ctx, "");
 
@@ -830,9 +1154,73 @@ void codegen_program(CodegenContext *ctx, Stmt **stmts, int stmt_count) {
     codegen_indent_dec(ctx);
     codegen_write(ctx, "}\n");
 
-    // Now output everything in the correct order
-    ctx->output = saved_output;
 
+    // Module init functions. Their top-level code can create closures, so
+    // they are generated before the closure pass.
+    for (int u = 1; u < num_units; u++) {
+        ctx->output = units[u].funcs;
+        codegen_module_init(ctx, units[u].module);
+    }
+
+    // Iteratively generate closures until no new ones are created
+    // This handles nested closures (functions inside functions)
+    ClosureInfo *processed_tail = NULL;
+    while (ctx->closures != processed_tail) {
+        ClosureInfo *c = ctx->closures;
+        while (c != processed_tail) {
+            // Find the last one before processed_tail to process in order
+            ClosureInfo *to_process = c;
+            while (to_process->next != processed_tail) {
+                to_process = to_process->next;
+            }
+            ctx->output = unit_for_module(units, num_units, to_process->source_module)->closures;
+            codegen_closure_impl(ctx, to_process);
+            if (processed_tail == NULL) {
+                processed_tail = to_process;
+            } else {
+                // Move processed_tail backward
+                ClosureInfo *prev = ctx->closures;
+                while (prev->next != processed_tail) {
+                    prev = prev->next;
+                }
+                processed_tail = prev;
+            }
+            // Re-check from start in case new closures were prepended
+            c = ctx->closures;
+        }
+    }
+
+    // FFI: Collect all extern fn declarations recursively (including from block scopes and modules)
+    ExternFnList all_extern_fns = {NULL, 0, 0};
+    collect_extern_fn_from_stmts(stmts, stmt_count, &all_extern_fns);
+    for (int u = 1; u < num_units; u++) {
+        collect_extern_fn_from_stmts(units[u].module->statements, units[u].module->num_statements,
+                                     &all_extern_fns);
+    }
+
+    int has_ffi = all_extern_fns.count > 0;
+    for (int i = 0; i < stmt_count && !has_ffi; i++) {
+        if (stmts[i]->type == STMT_IMPORT_FFI) {
+            has_ffi = 1;
+        }
+    }
+    // Also check modules for FFI imports
+    for (int u = 1; u < num_units && !has_ffi; u++) {
+        CompiledModule *mod = units[u].module;
+        for (int i = 0; i < mod->num_statements; i++) {
+            if (mod->statements[i]->type == STMT_IMPORT_FFI) {
+                has_ffi = 1;
+                break;
+            }
+        }
+    }
+
+    CodegenProgram *program = calloc(1, sizeof(CodegenProgram));
+    program->num_units = num_units;
+    program->units = calloc(num_units, sizeof(CodegenUnit));
+
+    // Shared header
+    ctx->output = open_memstream(&program->header, &program->header_length);
     // Header
     codegen_write(ctx, "/*\n");
     codegen_write(ctx, " * Generated by Hemlock Compiler\n");
@@ -860,48 +1248,107 @@ void codegen_program(CodegenContext *ctx, Stmt **stmts, int stmt_count) {
     codegen_write(ctx, "#define SIGSTOP_VAL 19\n");
     codegen_write(ctx, "#define SIGTSTP_VAL 20\n\n");
 
-    // FFI: Global library handle and function pointer declarations
-    // Collect all extern fn declarations recursively (including from block scopes and modules)
-    ExternFnList all_extern_fns = {NULL, 0, 0};
-    collect_extern_fn_from_stmts(stmts, stmt_count, &all_extern_fns);
 
-    // Also collect from imported modules
-    if (ctx->module_cache) {
-        CompiledModule *mod = ctx->module_cache->modules;
-        while (mod) {
-            collect_extern_fn_from_stmts(mod->statements, mod->num_statements, &all_extern_fns);
-            mod = mod->next;
+    // FFI globals live in the main file's unit; extern fn statements in any
+    // unit resolve symbols into them
+    if (has_ffi) {
+        codegen_write(ctx, "// FFI globals\n");
+        codegen_write(ctx, "extern HmlValue _ffi_lib;\n");
+        for (int i = 0; i < all_extern_fns.count; i++) {
+            codegen_write(ctx, "extern void *_ffi_ptr_%s;\n",
+                        all_extern_fns.stmts[i]->as.extern_fn.function_name);
         }
+        codegen_write(ctx, "\n");
     }
 
-    int has_ffi = 0;
-    for (int i = 0; i < stmt_count; i++) {
-        if (stmts[i]->type == STMT_IMPORT_FFI) {
-            has_ffi = 1;
-            break;
+    if (num_units > 1) {
+        // Exported module variables, referenced by the importing units
+        codegen_write(ctx, "// Module exports\n");
+        for (int u = 1; u < num_units; u++) {
+            CompiledModule *mod = units[u].module;
+            for (int i = 0; i < mod->num_exports; i++) {
+                codegen_write(ctx, "extern HmlValue %s;\n", mod->exports[i].mangled_name);
+            }
         }
+        codegen_write(ctx, "\n");
+
+        // Module function forward declarations (from buffer)
+        codegen_write(ctx, "// Module function forward declarations\n");
+        copy_buffer(ctx, module_decl_buffer);
+        codegen_write(ctx, "\n");
+
+        // Module init function forward declarations
+        codegen_write(ctx, "// Module init function declarations\n");
+        for (int u = 1; u < num_units; u++) {
+            codegen_write(ctx, "void %sinit(void);\n", units[u].module->module_prefix);
+        }
+        codegen_write(ctx, "\n");
     }
-    // Also check modules for FFI imports
-    if (!has_ffi && ctx->module_cache) {
-        CompiledModule *mod = ctx->module_cache->modules;
-        while (mod && !has_ffi) {
-            for (int i = 0; i < mod->num_statements; i++) {
-                if (mod->statements[i]->type == STMT_IMPORT_FFI) {
-                    has_ffi = 1;
-                    break;
-                }
-            }
-            mod = mod->next;
+
+    // Forward declarations for extern function wrappers (including from block scopes)
+    if (all_extern_fns.count > 0) {
+        codegen_write(ctx, "// FFI extern function wrappers\n");
+        for (int i = 0; i < all_extern_fns.count; i++) {
+            write_extern_fn_decl(ctx, all_extern_fns.stmts[i]);
         }
+        codegen_write(ctx, "\n");
     }
-    if (!has_ffi && all_extern_fns.count > 0) {
-        has_ffi = 1;
+    fclose(ctx->output);
+
+    // One unit per module: its variables, closures, functions and init function
+    for (int u = 1; u < num_units; u++) {
+        CompiledModule *mod = units[u].module;
+        CodegenUnit *unit = &program->units[u];
+        unit->name = strdup(mod->module_prefix);
+        ctx->output = open_memstream(&unit->source, &unit->length);
+
+        codegen_write(ctx, "// Module: %s\n\n", mod->absolute_path);
+        codegen_write(ctx, "// Module global variables\n");
+        for (int i = 0; i < mod->num_exports; i++) {
+            codegen_write(ctx, "HmlValue %s = {0};\n", mod->exports[i].mangled_name);
+        }
+        // Non-exported (private) variables are only visible in this unit
+        for (int i = 0; i < mod->num_statements; i++) {
+            Stmt *stmt = mod->statements[i];
+            // Skip exports (already handled above)
+            if (stmt->type == STMT_EXPORT) continue;
+            // Check if it's a private const
+            if (stmt->type == STMT_CONST) {
+                // Skip if already in exports (to avoid duplicate declaration)
+                if (module_find_export(mod, stmt->as.const_stmt.name)) continue;
+                codegen_write(ctx, "static HmlValue %s%s = {0};\n",
+                            mod->module_prefix, stmt->as.const_stmt.name);
+            }
+            // Check if it's a private let (function or not)
+            if (stmt->type == STMT_LET) {
+                // Skip if already in exports (to avoid duplicate declaration)
+                if (module_find_export(mod, stmt->as.let.name)) continue;
+                codegen_write(ctx, "static HmlValue %s%s = {0};\n",
+                            mod->module_prefix, stmt->as.let.name);
+            }
+        }
+        codegen_write(ctx, "\n");
+
+        write_closure_decls(ctx, mod);
+        if (ftell(units[u].closures) > 0) {
+            codegen_write(ctx, "// Closure implementations\n");
+            copy_buffer(ctx, units[u].closures);
+        }
+        codegen_write(ctx, "// Module function implementations\n");
+        copy_buffer(ctx, units[u].funcs);
+        fclose(ctx->output);
     }
+
+    // The main file's unit
+    CodegenUnit *main_unit = &program->units[0];
+    main_unit->name = strdup("main");
+    ctx->output = open_memstream(&main_unit->source, &main_unit->length);
+
     if (has_ffi) {
         codegen_write(ctx, "// FFI globals\n");
-        codegen_write(ctx, "static HmlValue _ffi_lib = {0};\n");
+        codegen_write(ctx, "HmlValue _ffi_lib = {0};\n");
         for (int i = 0; i < all_extern_fns.count; i++) {
-            codegen_write(ctx, "static void *_ffi_ptr_%s = NULL;\n",
+            codegen_write(ctx, "void *_ffi_ptr_%s = NULL;\n",
                         all_extern_fns.stmts[i]->as.extern_fn.function_name);
         }
         codegen_write(ctx, "\n");
@@ -1023,107 +1470,8 @@ void codegen_program(CodegenContext *ctx, Stmt **stmts, int stmt_count) {
     }
     free(declared_statics);
 
-    // Generate closure implementations to a buffer first (this may create nested closures)
-    FILE *closure_buffer = tmpfile();
-    FILE *saved_for_closures = ctx->output;
-    ctx->output = closure_buffer;
 
-    // Iteratively generate closures until no new ones are created
-    // This handles nested closures (functions inside functions)
-    ClosureInfo *processed_tail = NULL;
-    while (ctx->closures != processed_tail) {
-        ClosureInfo *c = ctx->closures;
-        while (c != processed_tail) {
-            // Find the last one before processed_tail to process in order
-            ClosureInfo *to_process = c;
-            while (to_process->next != processed_tail) {
-                to_process = to_process->next;
-            }
-            codegen_closure_impl(ctx, to_process);
-            if (processed_tail == NULL) {
-                processed_tail = to_process;
-            } else {
-                // Move processed_tail backward
-                ClosureInfo *prev = ctx->closures;
-                while (prev->next != processed_tail) {
-                    prev = prev->next;
-                }
-                processed_tail = prev;
-            }
-            // Re-check from start in case new closures were prepended
-            c = ctx->closures;
-        }
-    }
-    ctx->output = saved_for_closures;
-
-    // Now generate forward declarations for ALL closures (including nested ones)
-    if (ctx->closures) {
-        codegen_write(ctx, "// Closure forward declarations\n");
-        ClosureInfo *c = ctx->closures;
-        while (c) {
-            Expr *func = c->func_expr;
-            codegen_write(ctx, "HmlValue %s(HmlClosureEnv *_closure_env", c->func_name);
-            for (int i = 0; i < func->as.function.num_params; i++) {
-                codegen_write(ctx, ", HmlValue %s", func->as.function.param_names[i]);
-            }
-            codegen_write(ctx, ");\n");
-            c = c->next;
-        }
-        codegen_write(ctx, "\n");
-    }
-
-    // Module global variables and forward declarations
-    if (ctx->module_cache && ctx->module_cache->modules) {
-        codegen_write(ctx, "// Module global variables\n");
-        CompiledModule *mod = ctx->module_cache->modules;
-        while (mod) {
-            // Generate global variable for each export
-            for (int i = 0; i < mod->num_exports; i++) {
-                codegen_write(ctx, "static HmlValue %s = {0};\n", mod->exports[i].mangled_name);
-            }
-            // Also generate global variables for non-exported (private) variables
-            for (int i = 0; i < mod->num_statements; i++) {
-                Stmt *stmt = mod->statements[i];
-                // Skip exports (already handled above)
-                if (stmt->type == STMT_EXPORT) continue;
-                // Check if it's a private const
-                if (stmt->type == STMT_CONST) {
-                    // Skip if already in exports (to avoid duplicate declaration)
-                    if (module_find_export(mod, stmt->as.const_stmt.name)) continue;
-                    codegen_write(ctx, "static HmlValue %s%s = {0};\n",
-                                mod->module_prefix, stmt->as.const_stmt.name);
-                }
-                // Check if it's a private let (function or not)
-                if (stmt->type == STMT_LET) {
-                    // Skip if already in exports (to avoid duplicate declaration)
-                    if (module_find_export(mod, stmt->as.let.name)) continue;
-                    codegen_write(ctx, "static HmlValue %s%s = {0};\n",
-                                mod->module_prefix, stmt->as.let.name);
-                }
-            }
-            mod = mod->next;
-        }
-        codegen_write(ctx, "\n");
-
-        // Module function forward declarations (from buffer)
-        codegen_write(ctx, "// Module function forward declarations\n");
-        rewind(module_decl_buffer);
-        char buf[4096];
-        size_t n;
-        while ((n = fread(buf, 1, sizeof(buf), module_decl_buffer)) > 0) {
-            fwrite(buf, 1, n, ctx->output);
-        }
-        codegen_write(ctx, "\n");
-
-        // Module init function forward declarations
-        codegen_write(ctx, "// Module init function declarations\n");
-        mod = ctx->module_cache->modules;
-        while (mod) {
-            codegen_write(ctx, "static void %sinit(void);\n", mod->module_prefix);
-            mod = mod->next;
-        }
-        codegen_write(ctx, "\n");
-    }
+    write_closure_decls(ctx, NULL);
 
     // Forward declarations for named functions
     codegen_write(ctx, "// Named function forward declarations\n");
@@ -1139,143 +1487,40 @@ void codegen_program(CodegenContext *ctx, Stmt **stmts, int stmt_count) {
             codegen_write(ctx, ");\n");
         }
     }
-    // Forward declarations for extern functions (including from block scopes)
-    for (int i = 0; i < all_extern_fns.count; i++) {
-        const char *fn_name = all_extern_fns.stmts[i]->as.extern_fn.function_name;
-        int num_params = all_extern_fns.stmts[i]->as.extern_fn.num_params;
-        codegen_write(ctx, "HmlValue hml_fn_%s(HmlClosureEnv *_closure_env", fn_name);
-        for (int j = 0; j < num_params; j++) {
-            codegen_write(ctx, ", HmlValue _arg%d", j);
-        }
-        codegen_write(ctx, ");\n");
-    }
     codegen_write(ctx, "\n");
 
     // Output closure implementations from buffer
-    if (ctx->closures) {
+    if (ftell(units[0].closures) > 0) {
         codegen_write(ctx, "// Closure implementations\n");
-        rewind(closure_buffer);
-        char buf[4096];
-        size_t n;
-        while ((n = fread(buf, 1, sizeof(buf), closure_buffer)) > 0) {
-            fwrite(buf, 1, n, ctx->output);
-        }
+        copy_buffer(ctx, units[0].closures);
     }
-    fclose(closure_buffer);
 
     // FFI extern function wrapper implementations (including from block scopes)
     for (int i = 0; i < all_extern_fns.count; i++) {
-        Stmt *stmt = all_extern_fns.stmts[i];
-        const char *fn_name = stmt->as.extern_fn.function_name;
-        int num_params = stmt->as.extern_fn.num_params;
-        Type *return_type = stmt->as.extern_fn.return_type;
-
-        codegen_write(ctx, "// FFI wrapper for %s\n", fn_name);
-        codegen_write(ctx, "HmlValue hml_fn_%s(HmlClosureEnv *_env", fn_name);
-        for (int j = 0; j < num_params; j++) {
-            codegen_write(ctx, ", HmlValue _arg%d", j);
-        }
-        codegen_write(ctx, ") {\n");
-        codegen_write(ctx, "    (void)_env;\n");
-        codegen_write(ctx, "    if (!_ffi_ptr_%s) {\n", fn_name);
-        codegen_write(ctx, "        _ffi_ptr_%s = hml_ffi_sym(_ffi_lib, \"%s\");\n", fn_name, fn_name);
-        codegen_write(ctx, "    }\n");
-        codegen_write(ctx, "    HmlFFIType _types[%d];\n", num_params + 1);
-
-        // Return type
-        const char *ret_str = "HML_FFI_VOID";
-        if (return_type) {
-            switch (return_type->kind) {
-                case TYPE_I8: ret_str = "HML_FFI_I8"; break;
-                case TYPE_I16: ret_str = "HML_FFI_I16"; break;
-                case TYPE_I32: ret_str = "HML_FFI_I32"; break;
-                case TYPE_I64: ret_str = "HML_FFI_I64"; break;
-                case TYPE_U8: ret_str = "HML_FFI_U8"; break;
-                case TYPE_U16: ret_str = "HML_FFI_U16"; break;
-                case TYPE_U32: ret_str = "HML_FFI_U32"; break;
-                case TYPE_U64: ret_str = "HML_FFI_U64"; break;
-                case TYPE_F32: ret_str = "HML_FFI_F32"; break;
-                case TYPE_F64: ret_str = "HML_FFI_F64"; break;
-                case TYPE_PTR: ret_str = "HML_FFI_PTR"; break;
-                case TYPE_STRING: ret_str = "HML_FFI_STRING"; break;
-                default: ret_str = "HML_FFI_I32"; break;
-            }
-        }
-        codegen_write(ctx, "    _types[0] = %s;\n", ret_str);
-
-        // Parameter types
-        for (int j = 0; j < num_params; j++) {
-            Type *ptype = stmt->as.extern_fn.param_types[j];
-            const char *type_str = "HML_FFI_I32";
-            if (ptype) {
-                switch (ptype->kind) {
-                    case TYPE_I8: type_str = "HML_FFI_I8"; break;
-                    case TYPE_I16: type_str = "HML_FFI_I16"; break;
-                    case TYPE_I32: type_str = "HML_FFI_I32"; break;
-                    case TYPE_I64: type_str = "HML_FFI_I64"; break;
-                    case TYPE_U8: type_str = "HML_FFI_U8"; break;
-                    case TYPE_U16: type_str = "HML_FFI_U16"; break;
-                    case TYPE_U32: type_str = "HML_FFI_U32"; break;
-                    case TYPE_U64: type_str = "HML_FFI_U64"; break;
-                    case TYPE_F32: type_str = "HML_FFI_F32"; break;
-                    case TYPE_F64: type_str = "HML_FFI_F64"; break;
-                    case TYPE_PTR: type_str = "HML_FFI_PTR"; break;
-                    case TYPE_STRING: type_str = "HML_FFI_STRING"; break;
-                    default: type_str = "HML_FFI_I32"; break;
-                }
-            }
-            codegen_write(ctx, "    _types[%d] = %s;\n", j + 1, type_str);
-        }
-
-        if (num_params > 0) {
-            codegen_write(ctx, "    HmlValue _args[%d];\n", num_params);
-            for (int j = 0; j < num_params; j++) {
-                codegen_write(ctx, "    _args[%d] = _arg%d;\n", j, j);
-            }
-            codegen_write(ctx, "    return hml_ffi_call(_ffi_ptr_%s, _args, %d, _types);\n", fn_name, num_params);
+        if (extern_fn_is_direct(all_extern_fns.stmts[i])) {
+            generate_direct_extern_wrapper(ctx, all_extern_fns.stmts[i]);
         } else {
-            codegen_write(ctx, "    return hml_ffi_call(_ffi_ptr_%s, NULL, 0, _types);\n", fn_name);
+            generate_ffi_extern_wrapper(ctx, all_extern_fns.stmts[i]);
         }
-        codegen_write(ctx, "}\n\n");
     }
     // Free the extern fn list
     free(all_extern_fns.stmts);
 
-    // Module function implementations (from buffer)
-    if (ctx->module_cache && ctx->module_cache->modules) {
-        codegen_write(ctx, "// Module function implementations\n");
-        rewind(module_impl_buffer);
-        char mbuf[4096];
-        size_t mn;
-        while ((mn = fread(mbuf, 1, sizeof(mbuf), module_impl_buffer)) > 0) {
-            fwrite(mbuf, 1, mn, ctx->output);
-        }
-
-        // Module init function implementations
-        codegen_write(ctx, "// Module init functions\n");
-        CompiledModule *mod = ctx->module_cache->modules;
-        while (mod) {
-            codegen_module_init(ctx, mod);
-            mod = mod->next;
-        }
-    }
-    fclose(module_decl_buffer);
-    fclose(module_impl_buffer);
-
     // Named function implementations (from buffer)
     codegen_write(ctx, "// Named function implementations\n");
-    rewind(func_buffer);
-    char buf[4096];
-    size_t n;
-    while ((n = fread(buf, 1, sizeof(buf), func_buffer)) > 0) {
-        fwrite(buf, 1, n, ctx->output);
-    }
-    fclose(func_buffer);
+    copy_buffer(ctx, units[0].funcs);
 
     // Main function (from buffer)
-    rewind(main_buffer);
-    while ((n = fread(buf, 1, sizeof(buf), main_buffer)) > 0) {
-        fwrite(buf, 1, n, ctx->output);
+    copy_buffer(ctx, main_buffer);
+    fclose(ctx->output);
+
+    for (int u = 0; u < num_units; u++) {
+        fclose(units[u].funcs);
+        fclose(units[u].closures);
     }
+    free(units);
     fclose(main_buffer);
+    fclose(module_decl_buffer);
+    ctx->output = saved_output;
+    return program;
 }
@@ -134,6 +134,8 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
 
         case STMT_WHILE: {
             ctx->loop_depth++;
+            int saved_break_try_depth = ctx->break_try_depth;
+            ctx->break_try_depth = ctx->try_depth;
             codegen_writeln(ctx, "while (1) {");
             codegen_indent_inc(ctx);
             char *cond = codegen_expr(ctx, stmt->as.while_stmt.condition);
@@ -143,12 +145,15 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
             codegen_indent_dec(ctx);
             codegen_writeln(ctx, "}");
             ctx->loop_depth--;
+            ctx->break_try_depth = saved_break_try_depth;
             free(cond);
             break;
         }
 
         case STMT_FOR: {
             ctx->loop_depth++;
+            int saved_break_try_depth = ctx->break_try_depth;
+            ctx->break_try_depth = ctx->try_depth;
             codegen_writeln(ctx, "{");
             codegen_indent_inc(ctx);
             // Initializer
@@ -177,6 +182,7 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
             codegen_indent_dec(ctx);
             codegen_writeln(ctx, "}");
             ctx->loop_depth--;
+            ctx->break_try_depth = saved_break_try_depth;
             break;
         }
 
@@ -184,6 +190,8 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
             // Generate for-in loop for arrays, objects, or strings
             // for (let val in iterable) or for (let key, val in iterable)
             ctx->loop_depth++;
+            int saved_break_try_depth = ctx->break_try_depth;
+            ctx->break_try_depth = ctx->try_depth;
             codegen_writeln(ctx, "{");
             codegen_indent_inc(ctx);
 
@@ -270,6 +278,7 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
             codegen_indent_dec(ctx);
             codegen_writeln(ctx, "}");
             ctx->loop_depth--;
+            ctx->break_try_depth = saved_break_try_depth;
 
             free(iter_val);
             free(len_var);
@@ -303,7 +312,8 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
                     codegen_writeln(ctx, "%s = hml_val_null();", ret_var);
                 }
                 codegen_writeln(ctx, "%s = 1;", has_ret);
-                codegen_writeln(ctx, "hml_exception_pop();");
+                // Leave every try between here and the finally, that one included
+                codegen_exception_unwind(ctx, ctx->try_depth - codegen_get_finally_try_depth(ctx) + 1);
                 codegen_writeln(ctx, "goto %s;", finally_label);
             } else if (ctx->defer_stack) {
                 // We have defers - need to save return value, execute defers, then return
@@ -315,6 +325,7 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
                 } else {
                     codegen_writeln(ctx, "HmlValue %s = hml_val_null();", ret_val);
                 }
+                codegen_exception_unwind(ctx, ctx->try_depth);
                 // Execute all defers in LIFO order
                 codegen_defer_execute_all(ctx);
                 // Execute any runtime defers (from loops)
@@ -324,15 +335,18 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
                 free(ret_val);
             } else {
                 // No defers or try-finally - simple return
-                // Evaluate expression first, then decrement call depth
+                // Evaluate expression first, then leave enclosing trys and
+                // decrement call depth
                 if (stmt->as.return_stmt.value) {
                     char *value = codegen_expr(ctx, stmt->as.return_stmt.value);
+                    codegen_exception_unwind(ctx, ctx->try_depth);
                     // Execute any runtime defers (from loops)
                     codegen_writeln(ctx, "hml_defer_execute_all();");
                     codegen_writeln(ctx, "hml_call_exit();");
                     codegen_writeln(ctx, "return %s;", value);
                     free(value);
                 } else {
+                    codegen_exception_unwind(ctx, ctx->try_depth);
                     // Execute any runtime defers (from loops)
                     codegen_writeln(ctx, "hml_defer_execute_all();");
                     codegen_writeln(ctx, "hml_call_exit();");
@@ -343,10 +357,13 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
         }
 
         case STMT_BREAK:
+            // Leave the trys inside the loop or switch being exited
+            codegen_exception_unwind(ctx, ctx->try_depth - ctx->break_try_depth);
             codegen_writeln(ctx, "break;");
             break;
 
         case STMT_CONTINUE:
+            codegen_exception_unwind(ctx, ctx->try_depth - ctx->break_try_depth);
             codegen_writeln(ctx, "continue;");
             break;
 
@@ -354,6 +371,7 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
             codegen_writeln(ctx, "{");
             codegen_indent_inc(ctx);
             codegen_writeln(ctx, "HmlExceptionContext *_ex_ctx = hml_exception_push();");
+            ctx->try_depth++;
 
             // Track if we need to re-throw after finally
             int has_finally = stmt->as.try_stmt.finally_block != NULL;
@@ -421,6 +439,7 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
             // Pop exception context BEFORE finally block
             // This ensures exceptions in finally go to outer handler
             codegen_writeln(ctx, "hml_exception_pop();");
+            ctx->try_depth--;
 
             // Finally block
             if (has_finally) {
@@ -448,6 +467,7 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
                 if (needs_return_tracking) {
                     codegen_writeln(ctx, "if (%s) {", has_return_var);
                     codegen_indent_inc(ctx);
+                    codegen_exception_unwind(ctx, ctx->try_depth);
                     // Execute any runtime defers (from loops)
                     codegen_writeln(ctx, "hml_defer_execute_all();");
                     codegen_writeln(ctx, "hml_call_exit();");
@@ -480,6 +500,8 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
         case STMT_SWITCH: {
             // Generate switch using do-while(0) pattern so break works correctly
             char *expr_val = codegen_expr(ctx, stmt->as.switch_stmt.expr);
+            int saved_break_try_depth = ctx->break_try_depth;
+            ctx->break_try_depth = ctx->try_depth;
             int has_default = 0;
             int default_idx = -1;
 
@@ -548,6 +570,7 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
             codegen_writeln(ctx, "hml_release(&%s);", expr_val);
             codegen_indent_dec(ctx);
             codegen_writeln(ctx, "} while(0);");
+            ctx->break_try_depth = saved_break_try_depth;
             free(expr_val);
             break;
         }
@@ -818,7 +841,11 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
             break;
 
         case STMT_EXTERN_FN:
-            // Wrapper function is generated in codegen_program, nothing to do here
+            // Wrapper function is generated in codegen_program; resolve the symbol
+            // here against the library imported just before the declaration
+            codegen_writeln(ctx, "if (!_ffi_ptr_%s) _ffi_ptr_%s = hml_ffi_sym(_ffi_lib, \"%s\");",
+                          stmt->as.extern_fn.function_name, stmt->as.extern_fn.function_name,
+                          stmt->as.extern_fn.function_name);
             break;
 
         default:
@@ -9,12 +9,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
-#include <sys/wait.h>
 #include <limits.h>
 #include "../../include/lexer.h"
 #include "../../include/parser.h"
 #include "../../include/ast.h"
+#include "../../include/ast_optimize.h"
 #include "codegen.h"
+#include "build.h"
 
 #ifdef __APPLE__
 #include <mach-o/dyld.h>
@@ -70,6 +71,7 @@ typedef struct {
     int verbose;                 // Verbose output
     int keep_c;                  // Keep generated C file
     int optimize;                // Optimization level (0, 1, 2, 3)
+    int jobs;                    // Concurrent C compiler processes
     const char *cc;              // C compiler to use
     const char *runtime_path;    // Path to runtime library
 } Options;
@@ -81,8 +83,10 @@ static void print_usage(const char *progname) {
     fprintf(stderr, "  -o <file>     Output executable name (default: a.out)\n");
     fprintf(stderr, "  -c            Emit C code only (don't compile)\n");
     fprintf(stderr, "  --emit-c <f>  Write generated C to file\n");
-    fprintf(stderr, "  -k, --keep-c  Keep generated C file after compilation\n");
+    fprintf(stderr, "  -k, --keep-c  Keep the generated C sources after compilation\n");
     fprintf(stderr, "  -O<level>     Optimization level (0-3, default: 0)\n");
+    fprintf(stderr, "  -j <n>        Run up to n C compiler jobs (default: CPU count)\n");
+    fprintf(stderr, "  --no-optimize Skip constant folding and dead-branch removal\n");
     fprintf(stderr, "  --cc <path>   C compiler to use (default: gcc)\n");
     fprintf(stderr, "  --runtime <p> Path to runtime library\n");
     fprintf(stderr, "  -v, --verbose Verbose output\n");
@@ -99,6 +103,7 @@ static Options parse_args(int argc, char **argv) {
         .verbose = 0,
         .keep_c = 0,
         .optimize = 0,
+        .jobs = 0,
         .cc = "gcc",
         .runtime_path = NULL
     };
@@ -118,10 +123,19 @@ static Options parse_args(int argc, char **argv) {
             opts.c_output = argv[++i];
         } else if (strcmp(argv[i], "-k") == 0 || strcmp(argv[i], "--keep-c") == 0) {
             opts.keep_c = 1;
+        } else if (strcmp(argv[i], "--no-optimize") == 0) {
+            ast_optimize_set_enabled(0);
         } else if (strncmp(argv[i], "-O", 2) == 0) {
             opts.optimize = atoi(argv[i] + 2);
             if (opts.optimize < 0) opts.optimize = 0;
             if (opts.optimize > 3) opts.optimize = 3;
+        } else if (strncmp(argv[i], "-j", 2) == 0) {
+            const char *n = argv[i][2] ? argv[i] + 2 : (i + 1 < argc ? argv[++i] : "");
+            opts.jobs = atoi(n);
+            if (opts.jobs < 1) {
+                fprintf(stderr, "Invalid job count: %s\n", n);
+                exit(1);
+            }
         } else if (strcmp(argv[i], "--cc") == 0 && i + 1 < argc) {
             opts.cc = argv[++i];
         } else if (strcmp(argv[i], "--runtime") == 0 && i + 1 < argc) {
@@ -205,46 +219,16 @@ static char* make_c_filename(const char *input) {
     return result;
 }
 
-// Invoke the C compiler
-static int compile_c(const Options *opts, const char *c_file) {
-    // Build command
-    char cmd[4096];
-    char opt_flag[4];
-    snprintf(opt_flag, sizeof(opt_flag), "-O%d", opts->optimize);
-
-    // Determine runtime path (relative to hemlockc location)
-    const char *runtime_path = opts->runtime_path;
-    if (!runtime_path) {
-        runtime_path = get_self_dir();
-        if (!runtime_path) {
-            runtime_path = ".";
-        }
-    }
-
-    // Build link command
-    // Check if -lz is linkable (same check as runtime Makefile)
-    char zlib_flag[8] = "";
-    if (system("echo 'int main(){return 0;}' | gcc -x c - -lz -o /dev/null 2>/dev/null") == 0) {
-        strcpy(zlib_flag, " -lz");
-    }
-
-    // Check if -lwebsockets is linkable
-    char websockets_flag[16] = "";
-    if (system("echo 'int main(){return 0;}' | gcc -x c - -lwebsockets -o /dev/null 2>/dev/null") == 0) {
-        strcpy(websockets_flag, " -lwebsockets");
-    }
-
-    snprintf(cmd, sizeof(cmd),
-        "%s %s -o %s %s -I%s/runtime/include -L%s -lhemlock_runtime -lm -lpthread -lffi -ldl%s%s",
-        opts->cc, opt_flag, opts->output_file, c_file,
-        runtime_path, runtime_path, zlib_flag, websockets_flag);
-
-    if (opts->verbose) {
-        printf("Running: %s\n", cmd);
+// Write a generated program as a single C file
+static int write_c_file(const char *path, const CodegenProgram *program) {
+    FILE *output = fopen(path, "w");
+    if (!output) {
+        fprintf(stderr, "Error: Could not open output file '%s'\n", path);
+        return 0;
     }
-
-    int status = system(cmd);
-    return WEXITSTATUS(status);
+    codegen_program_write(program, output);
+    fclose(output);
+    return 1;
 }
 
 int main(int argc, char **argv) {
@@ -275,66 +259,25 @@ int main(int argc, char **argv) {
         free(source);
         return 1;
     }
+    ast_optimize(statements, stmt_count);
 
     if (opts.verbose) {
         printf("Parsed %d statements\n", stmt_count);
     }
 
-    // Determine C output file
-    char *c_file;
-    int c_file_allocated = 0;
-    if (opts.c_output) {
-        c_file = (char*)opts.c_output;
-    } else if (opts.emit_c_only) {
-        // When -c is used with -o, use the output file as C output
-        if (strcmp(opts.output_file, "a.out") != 0) {
-            c_file = (char*)opts.output_file;
-        } else {
-            c_file = make_c_filename(opts.input_file);
-            c_file_allocated = 1;
-        }
-    } else {
-        // Generate temp file
-        c_file = strdup("/tmp/hemlock_XXXXXX");
-        int fd = mkstemp(c_file);
-        if (fd < 0) {
-            fprintf(stderr, "Error: Could not create temporary file\n");
-            free(source);
-            return 1;
-        }
-        close(fd);
-        // Rename to add .c extension
-        char *new_name = malloc(strlen(c_file) + 3);
-        sprintf(new_name, "%s.c", c_file);
-        rename(c_file, new_name);
-        free(c_file);
-        c_file = new_name;
-        c_file_allocated = 1;
-    }
-
-    // Open output file
-    FILE *output = fopen(c_file, "w");
-    if (!output) {
-        fprintf(stderr, "Error: Could not open output file '%s'\n", c_file);
-        free(source);
-        if (c_file_allocated) free(c_file);
-        return 1;
-    }
-
-    // Generate C code
+    // Generate C code: one translation unit per module plus a shared header
     if (opts.verbose) {
-        printf("Generating C code to %s...\n", c_file);
+        printf("Generating C code...\n");
     }
 
     // Initialize module cache for import support
     ModuleCache *module_cache = module_cache_new(opts.input_file);
 
-    CodegenContext *ctx = codegen_new(output);
+    CodegenContext *ctx = codegen_new(NULL);
     codegen_set_module_cache(ctx, module_cache);
-    codegen_program(ctx, statements, stmt_count);
+    CodegenProgram *program = codegen_program_units(ctx, statements, stmt_count);
     codegen_free(ctx);
     module_cache_free(module_cache);
-    fclose(output);
 
     // Cleanup AST
     for (int i = 0; i < stmt_count; i++) {
@@ -343,12 +286,28 @@ int main(int argc, char **argv) {
     free(statements);
     free(source);
 
-    if (opts.emit_c_only) {
-        if (opts.verbose) {
+    // Single C file output (-c or --emit-c)
+    if (opts.emit_c_only || opts.c_output) {
+        char *c_file;
+        int c_file_allocated = 0;
+        if (opts.c_output) {
+            c_file = (char*)opts.c_output;
+        } else if (strcmp(opts.output_file, "a.out") != 0) {
+            // When -c is used with -o, use the output file as C output
+            c_file = (char*)opts.output_file;
+        } else {
+            c_file = make_c_filename(opts.input_file);
+            c_file_allocated = 1;
+        }
+        int written = write_c_file(c_file, program);
+        if (written && opts.verbose) {
             printf("C code written to %s\n", c_file);
         }
         if (c_file_allocated) free(c_file);
-        return 0;
+        if (!written || opts.emit_c_only) {
+            codegen_program_free(program);
+            return written ? 0 : 1;
+        }
     }
 
     // Compile C code
@@ -356,17 +315,25 @@ int main(int argc, char **argv) {
         printf("Compiling C code...\n");
     }
 
-    int result = compile_c(&opts, c_file);
-
-    // Cleanup temp file
-    if (!opts.keep_c && !opts.c_output) {
-        if (opts.verbose) {
-            printf("Removing temporary file %s\n", c_file);
+    // Determine runtime path (relative to hemlockc location)
+    const char *runtime_path = opts.runtime_path;
+    if (!runtime_path) {
+        runtime_path = get_self_dir();
+        if (!runtime_path) {
+            runtime_path = ".";
         }
-        unlink(c_file);
     }
 
-    if (c_file_allocated) free(c_file);
+    BuildOptions build = {
+        .cc = opts.cc,
+        .optimize = opts.optimize,
+        .runtime_path = runtime_path,
+        .jobs = opts.jobs > 0 ? opts.jobs : build_default_jobs(),
+        .verbose = opts.verbose,
+        .keep_c = opts.keep_c
+    };
+    int result = build_program(&build, program, opts.output_file);
+    codegen_program_free(program);
 
     if (result == 0) {
         if (opts.verbose) {
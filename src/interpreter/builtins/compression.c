@@ -391,3 +391,315 @@ Value builtin_adler32(Value *args, int num_args, ExecutionContext *ctx) {
 
     return val_u32((uint32_t)adler_val);
 }
+
+// ============================================================================
+// STREAMING COMPRESSION
+// ============================================================================
+//
+// Deflater/Inflater handles wrap a persistent z_stream. Each update() feeds
+// one chunk and returns only the output it produced, so arbitrarily large
+// inputs are processed in constant memory.
+
+#define ZSTREAM_OUT_CHUNK 16384
+
+typedef struct {
+    z_stream strm;
+    int deflate;        // 1 = Deflater, 0 = Inflater
+    int multi_member;   // Inflater: continue across concatenated gzip members
+    int as_string;      // Inflater: return strings instead of buffers
+    int finished;       // Deflater: finish() called; Inflater: end of stream seen
+    int closed;         // z_stream released
+} ZStream;
+
+// Map a format name to zlib windowBits. Returns 0 for unknown formats.
+static int zstream_window_bits(const char *format, int allow_auto) {
+    if (strcmp(format, "zlib") == 0) return 15;
+    if (strcmp(format, "gzip") == 0) return 15 + 16;
+    if (strcmp(format, "raw") == 0) return -15;
+    if (allow_auto && strcmp(format, "auto") == 0) return 15 + 32;
+    return 0;
+}
+
+static ZStream* zstream_get(Value val, const char *fn_name, ExecutionContext *ctx) {
+    if (val.type != VAL_PTR || val.as.as_ptr == NULL) {
+        runtime_error(ctx, "%s() expects a compression stream handle", fn_name);
+        return NULL;
+    }
+    ZStream *zs = (ZStream*)val.as.as_ptr;
+    if (zs->closed) {
+        runtime_error(ctx, "%s() called on closed compression stream", fn_name);
+        return NULL;
+    }
+    return zs;
+}
+
+static Value zstream_output(ZStream *zs, char *out, size_t len) {
+    if (zs->as_string) {
+        char *str = realloc(out, len + 1);
+        if (!str) str = out;
+        str[len] = '\0';
+        return val_string_take(str, (int)len, (int)len + 1);
+    }
+    Buffer *buf = malloc(sizeof(Buffer));
+    buf->data = out;
+    buf->length = (int)len;
+    buf->capacity = (int)len;
+    buf->ref_count = 1;
+    return (Value){ .type = VAL_BUFFER, .as.as_buffer = buf };
+}
+
+// Run the stream over `data` with the given flush mode, collecting output.
+// Returns the output length, or -1 with *err_msg set on failure.
+static long zstream_pump(ZStream *zs, const void *data, size_t len, int flush,
+                         char **out_ptr, const char **err_msg) {
+    size_t cap = ZSTREAM_OUT_CHUNK;
+    size_t size = 0;
+    char *out = malloc(cap + 1);
+    if (!out) {
+        *err_msg = "memory allocation failed";
+        return -1;
+    }
+
+    zs->strm.next_in = (Bytef *)data;
+    zs->strm.avail_in = (uInt)len;
+
+    for (;;) {
+        if (cap - size < ZSTREAM_OUT_CHUNK) {
+            cap *= 2;
+            char *grown = realloc(out, cap + 1);
+            if (!grown) {
+                free(out);
+                *err_msg = "memory allocation failed";
+                return -1;
+            }
+            out = grown;
+        }
+        zs->strm.next_out = (Bytef *)(out + size);
+        zs->strm.avail_out = (uInt)(cap - size);
+
+        int ret = zs->deflate ? deflate(&zs->strm, flush) : inflate(&zs->strm, flush);
+        size = cap - zs->strm.avail_out;
+
+        if (ret == Z_STREAM_END) {
+            if (zs->deflate) break;
+            // A gzip file may hold several concatenated members
+            if (zs->multi_member && zs->strm.avail_in > 0) {
+                inflateReset(&zs->strm);
+                continue;
+            }
+            zs->finished = 1;
+            break;
+        }
+        if (ret == Z_BUF_ERROR) {
+            if (zs->strm.avail_out == 0) continue;  // Needs more output space
+            break;                                  // Needs more input
+        }
+        if (ret != Z_OK) {
+            free(out);
+            if (ret == Z_NEED_DICT) *err_msg = "preset dictionary required";
+            else if (ret == Z_MEM_ERROR) *err_msg = "memory allocation failed";
+            else *err_msg = zs->strm.msg ? zs->strm.msg : "corrupted or invalid data";
+            return -1;
+        }
+        // Input consumed and output not full: nothing more is pending
+        if (zs->strm.avail_in == 0 && zs->strm.avail_out > 0 && flush != Z_FINISH) break;
+    }
+
+    *out_ptr = out;
+    return (long)size;
+}
+
+// __deflate_new(format: string, level: i32) -> ptr
+// format is "zlib", "gzip" or "raw"
+Value builtin_deflate_new(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2) {
+        runtime_error(ctx, "deflate_new() expects 2 arguments (format, level)");
+        return val_null();
+    }
+    if (args[0].type != VAL_STRING || !is_numeric(args[1])) {
+        runtime_error(ctx, "deflate_new() expects (string format, integer level)");
+        return val_null();
+    }
+
+    int bits = zstream_window_bits(args[0].as.as_string->data, 0);
+    if (bits == 0) {
+        runtime_error(ctx, "deflate_new() format must be \"zlib\", \"gzip\" or \"raw\"");
+        return val_null();
+    }
+    int level = value_to_int(args[1]);
+    if (level < -1 || level > 9) {
+        runtime_error(ctx, "deflate_new() level must be -1 to 9");
+        return val_null();
+    }
+
+    ZStream *zs = calloc(1, sizeof(ZStream));
+    if (!zs) {
+        runtime_error(ctx, "deflate_new() memory allocation failed");
+        return val_null();
+    }
+    zs->deflate = 1;
+    if (deflateInit2(&zs->strm, level, Z_DEFLATED, bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        free(zs);
+        runtime_error(ctx, "deflate_new() failed to initialize zlib stream");
+        return val_null();
+    }
+    return val_ptr(zs);
+}
+
+// __inflate_new(format: string, as_string: bool) -> ptr
+// format is "zlib", "gzip", "raw" or "auto" (zlib or gzip, detected)
+Value builtin_inflate_new(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2) {
+        runtime_error(ctx, "inflate_new() expects 2 arguments (format, as_string)");
+        return val_null();
+    }
+    if (args[0].type != VAL_STRING) {
+        runtime_error(ctx, "inflate_new() format must be a string");
+        return val_null();
+    }
+
+    int bits = zstream_window_bits(args[0].as.as_string->data, 1);
+    if (bits == 0) {
+        runtime_error(ctx, "inflate_new() format must be \"zlib\", \"gzip\", \"raw\" or \"auto\"");
+        return val_null();
+    }
+
+    ZStream *zs = calloc(1, sizeof(ZStream));
+    if (!zs) {
+        runtime_error(ctx, "inflate_new() memory allocation failed");
+        return val_null();
+    }
+    zs->multi_member = bits > 15;
+    zs->as_string = value_is_truthy(args[1]);
+    if (inflateInit2(&zs->strm, bits) != Z_OK) {
+        free(zs);
+        runtime_error(ctx, "inflate_new() failed to initialize zlib stream");
+        return val_null();
+    }
+    return val_ptr(zs);
+}
+
+// __zstream_update(stream: ptr, chunk: string | buffer) -> buffer | string
+// Feed a chunk; returns whatever output it produced (possibly empty)
+Value builtin_zstream_update(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2) {
+        runtime_error(ctx, "zstream_update() expects 2 arguments (stream, chunk)");
+        return val_null();
+    }
+    ZStream *zs = zstream_get(args[0], "zstream_update", ctx);
+    if (!zs) return val_null();
+    if (zs->deflate && zs->finished) {
+        runtime_error(ctx, "zstream_update() called after finish()");
+        return val_null();
+    }
+
+    const void *data;
+    size_t len;
+    if (args[1].type == VAL_STRING) {
+        data = args[1].as.as_string->data;
+        len = args[1].as.as_string->length;
+    } else if (args[1].type == VAL_BUFFER) {
+        data = args[1].as.as_buffer->data;
+        len = args[1].as.as_buffer->length;
+    } else {
+        runtime_error(ctx, "zstream_update() chunk must be string or buffer");
+        return val_null();
+    }
+
+    // Data after the end of a compressed stream is ignored
+    if (zs->finished) len = 0;
+
+    char *out;
+    const char *err;
+    long n = zstream_pump(zs, data, len, Z_NO_FLUSH, &out, &err);
+    if (n < 0) {
+        runtime_error(ctx, "%s failed: %s", zs->deflate ? "deflate" : "inflate", err);
+        return val_null();
+    }
+    return zstream_output(zs, out, (size_t)n);
+}
+
+// __zstream_flush(stream: ptr) -> buffer
+// Deflater: emit everything buffered so far on a byte boundary (Z_SYNC_FLUSH)
+Value builtin_zstream_flush(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "zstream_flush() expects 1 argument (stream)");
+        return val_null();
+    }
+    ZStream *zs = zstream_get(args[0], "zstream_flush", ctx);
+    if (!zs) return val_null();
+    if (!zs->deflate || zs->finished) {
+        return zstream_output(zs, malloc(1), 0);
+    }
+
+    char *out;
+    const char *err;
+    long n = zstream_pump(zs, NULL, 0, Z_SYNC_FLUSH, &out, &err);
+    if (n < 0) {
+        runtime_error(ctx, "deflate failed: %s", err);
+        return val_null();
+    }
+    return zstream_output(zs, out, (size_t)n);
+}
+
+// __zstream_finish(stream: ptr) -> buffer | string
+// Deflater: flush the trailer. Inflater: verify the stream was complete.
+Value builtin_zstream_finish(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "zstream_finish() expects 1 argument (stream)");
+        return val_null();
+    }
+    ZStream *zs = zstream_get(args[0], "zstream_finish", ctx);
+    if (!zs) return val_null();
+
+    if (!zs->deflate) {
+        if (!zs->finished) {
+            runtime_error(ctx, "inflate failed: unexpected end of compressed data");
+            return val_null();
+        }
+        return zstream_output(zs, malloc(1), 0);
+    }
+    if (zs->finished) {
+        return zstream_output(zs, malloc(1), 0);
+    }
+
+    char *out;
+    const char *err;
+    long n = zstream_pump(zs, NULL, 0, Z_FINISH, &out, &err);
+    if (n < 0) {
+        runtime_error(ctx, "deflate failed: %s", err);
+        return val_null();
+    }
+    zs->finished = 1;
+    return zstream_output(zs, out, (size_t)n);
+}
+
+// __zstream_done(stream: ptr) -> bool
+// Inflater: true once the end of the compressed stream has been reached
+Value builtin_zstream_done(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "zstream_done() expects 1 argument (stream)");
+        return val_null();
+    }
+    ZStream *zs = zstream_get(args[0], "zstream_done", ctx);
+    if (!zs) return val_null();
+    return val_bool(zs->finished);
+}
+
+// __zstream_free(stream: ptr) -> null
+Value builtin_zstream_free(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "zstream_free() expects 1 argument (stream)");
+        return val_null();
+    }
+    ZStream *zs = zstream_get(args[0], "zstream_free", ctx);
+    if (!zs) return val_null();
+
+    if (zs->deflate) deflateEnd(&zs->strm);
+    else inflateEnd(&zs->strm);
+
+    // The handle may still be referenced by Hemlock values, so the struct
+    // stays allocated and is marked closed instead of freed
+    zs->closed = 1;
+    return val_null();
+}
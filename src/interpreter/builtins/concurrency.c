@@ -36,7 +36,7 @@ static void* task_thread_wrapper(void* arg) {
     }
 
     // Execute function body
-    eval_stmt(fn->body, func_env, task->ctx);
+    eval_stmt(function_body(fn, task->ctx), func_env, task->ctx);
 
     // Get return value
     Value result = val_null();
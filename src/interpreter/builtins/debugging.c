@@ -193,3 +193,13 @@ Value builtin_panic(Value *args, int num_args, ExecutionContext *ctx) {
     call_stack_print(&ctx->call_stack);
     exit(1);
 }
+
+Value builtin_snapshot_point(Value *args, int num_args, ExecutionContext *ctx) {
+    (void)args;
+
+    // Marks where `hemlock --snapshot` stops; does nothing when the program runs
+    if (num_args != 0) {
+        runtime_error(ctx, "snapshot_point() expects no arguments");
+    }
+    return val_null();
+}
@@ -0,0 +1,102 @@
+#include "internal.h"
+#include "../../shared/encoding_core.h"
+#include <stdint.h>
+
+// ============================================================================
+// BASE64 / HEX / URL ENCODING
+// ============================================================================
+//
+// Encoders accept a string or buffer and return a string; decoders take a
+// string and return a string holding the raw decoded bytes. The codecs and
+// their SIMD kernels live in the shared core (src/shared/encoding_core.c).
+
+// Get the bytes of a string or buffer argument; returns 0 on type mismatch
+static int encoding_input(Value val, const uint8_t **data, size_t *len) {
+    if (val.type == VAL_STRING) {
+        *data = (const uint8_t *)val.as.as_string->data;
+        *len = (size_t)val.as.as_string->length;
+        return 1;
+    }
+    if (val.type == VAL_BUFFER) {
+        *data = (const uint8_t *)val.as.as_buffer->data;
+        *len = (size_t)val.as.as_buffer->length;
+        return 1;
+    }
+    return 0;
+}
+
+static Value run_encoder(Value *args, int num_args, ExecutionContext *ctx,
+                         const char *name, EncodeFn fn, size_t (*out_size)(size_t)) {
+    const uint8_t *data;
+    size_t len;
+    if (num_args != 1 || !encoding_input(args[0], &data, &len)) {
+        runtime_error(ctx, "%s() requires string or buffer argument", name);
+        return val_null();
+    }
+
+    size_t cap = out_size(len) + 1;
+    char *out = malloc(cap);
+    if (!out) {
+        runtime_error(ctx, "%s() memory allocation failed", name);
+        return val_null();
+    }
+    long n = fn(data, len, out);
+    out[n] = '\0';
+    return val_string_take(out, (int)n, (int)cap);
+}
+
+static Value run_decoder(Value *args, int num_args, ExecutionContext *ctx,
+                         const char *name, DecodeFn fn, size_t (*out_size)(size_t)) {
+    const uint8_t *data;
+    size_t len;
+    if (num_args != 1 || !encoding_input(args[0], &data, &len)) {
+        runtime_error(ctx, "%s() requires string or buffer argument", name);
+        return val_null();
+    }
+
+    size_t cap = out_size(len) + 1;
+    char *out = malloc(cap);
+    if (!out) {
+        runtime_error(ctx, "%s() memory allocation failed", name);
+        return val_null();
+    }
+    const char *err = NULL;
+    long n = fn(data, len, (uint8_t *)out, &err);
+    if (n < 0) {
+        free(out);
+        runtime_error(ctx, "%s", err);
+        return val_null();
+    }
+    out[n] = '\0';
+    return val_string_take(out, (int)n, (int)cap);
+}
+
+// __base64_encode(data: string | buffer) -> string
+Value builtin_base64_encode(Value *args, int num_args, ExecutionContext *ctx) {
+    return run_encoder(args, num_args, ctx, "base64_encode", base64_encode_bytes, base64_encoded_size);
+}
+
+// __base64_decode(data: string) -> string (raw bytes)
+Value builtin_base64_decode(Value *args, int num_args, ExecutionContext *ctx) {
+    return run_decoder(args, num_args, ctx, "base64_decode", base64_decode_bytes, base64_decoded_size);
+}
+
+// __hex_encode(data: string | buffer) -> string (lowercase)
+Value builtin_hex_encode(Value *args, int num_args, ExecutionContext *ctx) {
+    return run_encoder(args, num_args, ctx, "hex_encode", hex_encode_bytes, hex_encoded_size);
+}
+
+// __hex_decode(data: string) -> string (raw bytes)
+Value builtin_hex_decode(Value *args, int num_args, ExecutionContext *ctx) {
+    return run_decoder(args, num_args, ctx, "hex_decode", hex_decode_bytes, hex_decoded_size);
+}
+
+// __url_encode(data: string | buffer) -> string
+Value builtin_url_encode(Value *args, int num_args, ExecutionContext *ctx) {
+    return run_encoder(args, num_args, ctx, "url_encode", url_encode_bytes, url_encoded_size);
+}
+
+// __url_decode(data: string) -> string
+Value builtin_url_decode(Value *args, int num_args, ExecutionContext *ctx) {
+    return run_decoder(args, num_args, ctx, "url_decode", url_decode_bytes, url_decoded_size);
+}
@@ -0,0 +1,840 @@
+#include "internal.h"
+#include <poll.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdarg.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#define EVLOOP_HAVE_EPOLL 1
+#endif
+
+// ========== EVENT LOOP ==========
+//
+// A persistent reactor: file descriptors are registered once and stay in the
+// kernel's interest set (epoll on Linux, a rebuilt pollfd array elsewhere),
+// timers live in a min-heap, and channels signal readiness through an
+// eventfd (a pipe on non-Linux systems) written by send()/close().
+//
+// Callbacks always run on the thread that calls run()/run_once().
+
+typedef enum {
+    EV_WATCH_FD,        // Socket, file or raw descriptor
+    EV_WATCH_CHANNEL,   // Channel readiness (fd is the wakeup read end)
+} EvWatchKind;
+
+typedef struct {
+    uint64_t id;        // Unique id, used to detect removal during dispatch
+    EvWatchKind kind;
+    int fd;             // Descriptor registered with the backend
+    int wake_write_fd;  // Channel watchers: fd the channel writes to (== fd with eventfd)
+    int events;         // POLLIN / POLLOUT mask
+    int edge;           // Edge-triggered (epoll only; level-triggered under poll)
+    Value target;       // Socket/file/channel passed back to the callback
+    Value callback;
+} EvWatcher;
+
+typedef struct {
+    int id;
+    int64_t deadline_ms;
+    int64_t interval_ms;  // 0 for one-shot timers
+    Value callback;
+    int cancelled;
+} EvTimer;
+
+typedef struct {
+    int backend_fd;          // epoll instance (-1 with the poll backend)
+    EvWatcher **by_fd;       // Watchers indexed by file descriptor
+    int fd_capacity;
+    int num_watchers;
+    uint64_t next_watcher_id;
+    EvTimer **timers;        // Binary min-heap ordered by deadline
+    int num_timers;
+    int timer_capacity;
+    int next_timer_id;
+    EvTimer *firing;         // Timer whose callback is currently running
+    int stopped;
+    int closed;
+} EventLoop;
+
+// ========== RUNTIME ERROR HELPER ==========
+
+static Value throw_runtime_error(ExecutionContext *ctx, const char *format, ...) {
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    ctx->exception_state.exception_value = val_string(buffer);
+    value_retain(ctx->exception_state.exception_value);
+    ctx->exception_state.is_throwing = 1;
+    return val_null();
+}
+
+// ========== HELPERS ==========
+
+static int64_t ev_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static EventLoop* ev_get_loop(Value val, const char *fn_name, ExecutionContext *ctx) {
+    if (val.type != VAL_PTR || val.as.as_ptr == NULL) {
+        throw_runtime_error(ctx, "%s() expects an event loop handle", fn_name);
+        return NULL;
+    }
+    EventLoop *loop = (EventLoop*)val.as.as_ptr;
+    if (loop->closed) {
+        throw_runtime_error(ctx, "%s() called on closed event loop", fn_name);
+        return NULL;
+    }
+    return loop;
+}
+
+// Extract a file descriptor from a socket, file, or raw integer fd
+static int ev_fd_from_value(Value val) {
+    if (val.type == VAL_SOCKET) {
+        return val.as.as_socket->closed ? -1 : val.as.as_socket->fd;
+    }
+    if (val.type == VAL_FILE) {
+        return val.as.as_file->closed ? -1 : fileno(val.as.as_file->fp);
+    }
+    if (is_integer(val)) {
+        return value_to_int(val);
+    }
+    return -1;
+}
+
+// A watcher whose socket/file was closed without being unregistered
+static int ev_watcher_is_stale(EvWatcher *w) {
+    if (w->kind != EV_WATCH_FD) return 0;
+    if (w->target.type == VAL_SOCKET) return w->target.as.as_socket->closed;
+    if (w->target.type == VAL_FILE) return w->target.as.as_file->closed;
+    return 0;
+}
+
+// Call a Hemlock callback. Missing parameters are bound to null and extra
+// arguments are dropped, so callbacks may ignore what they don't need.
+static Value ev_invoke(Value callback, Value *args, int num_args, ExecutionContext *ctx) {
+    if (callback.type == VAL_BUILTIN_FN) {
+        return callback.as.as_builtin_fn(args, num_args, ctx);
+    }
+    return call_function_value(callback, args, num_args, ctx);
+}
+
+static int ev_is_callable(Value val) {
+    return val.type == VAL_FUNCTION || val.type == VAL_BUILTIN_FN;
+}
+
+// ========== BACKEND ==========
+
+#ifdef EVLOOP_HAVE_EPOLL
+static uint32_t ev_to_epoll(int events, int edge) {
+    uint32_t out = 0;
+    if (events & POLLIN) out |= EPOLLIN;
+    if (events & POLLOUT) out |= EPOLLOUT;
+    if (events & POLLPRI) out |= EPOLLPRI;
+    if (edge) out |= EPOLLET;
+    return out;
+}
+
+static int ev_from_epoll(uint32_t events) {
+    int out = 0;
+    if (events & EPOLLIN) out |= POLLIN;
+    if (events & EPOLLOUT) out |= POLLOUT;
+    if (events & EPOLLPRI) out |= POLLPRI;
+    if (events & EPOLLERR) out |= POLLERR;
+    if (events & EPOLLHUP) out |= POLLHUP;
+    return out;
+}
+#endif
+
+static int ev_backend_ctl(EventLoop *loop, int op, EvWatcher *w) {
+#ifdef EVLOOP_HAVE_EPOLL
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = ev_to_epoll(w->events, w->edge);
+    ev.data.fd = w->fd;
+    int epoll_op = op == 0 ? EPOLL_CTL_ADD : (op == 1 ? EPOLL_CTL_MOD : EPOLL_CTL_DEL);
+    if (epoll_ctl(loop->backend_fd, epoll_op, w->fd, &ev) < 0) {
+        // A descriptor closed behind our back is already gone from the set
+        if (epoll_op == EPOLL_CTL_DEL && (errno == EBADF || errno == ENOENT)) return 0;
+        return -1;
+    }
+    return 0;
+#else
+    (void)loop; (void)op; (void)w;
+    return 0;  // poll backend rebuilds its set from by_fd on every wait
+#endif
+}
+
+// Create the wakeup descriptor pair used for channel readiness
+static int ev_make_wakeup(int *read_fd, int *write_fd) {
+#ifdef EVLOOP_HAVE_EPOLL
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) return -1;
+    *read_fd = fd;
+    *write_fd = fd;
+    return 0;
+#else
+    int fds[2];
+    if (pipe(fds) < 0) return -1;
+    for (int i = 0; i < 2; i++) {
+        fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL, 0) | O_NONBLOCK);
+        fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+    }
+    *read_fd = fds[0];
+    *write_fd = fds[1];
+    return 0;
+#endif
+}
+
+static void ev_drain_wakeup(int fd) {
+    uint64_t buf[8];
+    while (read(fd, buf, sizeof(buf)) > 0) {
+        // Keep reading until EAGAIN (pipe fallback may hold several writes)
+    }
+}
+
+// ========== WATCHER TABLE ==========
+
+static int ev_ensure_fd_capacity(EventLoop *loop, int fd) {
+    if (fd < loop->fd_capacity) return 0;
+    int new_cap = loop->fd_capacity ? loop->fd_capacity : 64;
+    while (new_cap <= fd) new_cap *= 2;
+    EvWatcher **grown = realloc(loop->by_fd, sizeof(EvWatcher*) * new_cap);
+    if (!grown) return -1;
+    memset(grown + loop->fd_capacity, 0, sizeof(EvWatcher*) * (new_cap - loop->fd_capacity));
+    loop->by_fd = grown;
+    loop->fd_capacity = new_cap;
+    return 0;
+}
+
+static EvWatcher* ev_lookup(EventLoop *loop, int fd) {
+    if (fd < 0 || fd >= loop->fd_capacity) return NULL;
+    return loop->by_fd[fd];
+}
+
+static void ev_watcher_free(EvWatcher *w) {
+    if (w->kind == EV_WATCH_CHANNEL) {
+        Channel *ch = w->target.as.as_channel;
+        pthread_mutex_lock((pthread_mutex_t*)ch->mutex);
+        if (ch->notify_fd == w->wake_write_fd) {
+            ch->notify_fd = -1;
+        }
+        pthread_mutex_unlock((pthread_mutex_t*)ch->mutex);
+        close(w->fd);
+        if (w->wake_write_fd != w->fd) {
+            close(w->wake_write_fd);
+        }
+    }
+    value_release(w->target);
+    value_release(w->callback);
+    free(w);
+}
+
+static void ev_remove_watcher(EventLoop *loop, EvWatcher *w) {
+    ev_backend_ctl(loop, 2, w);
+    loop->by_fd[w->fd] = NULL;
+    loop->num_watchers--;
+    ev_watcher_free(w);
+}
+
+// ========== TIMER HEAP ==========
+
+static void ev_heap_swap(EventLoop *loop, int a, int b) {
+    EvTimer *tmp = loop->timers[a];
+    loop->timers[a] = loop->timers[b];
+    loop->timers[b] = tmp;
+}
+
+static void ev_heap_sift_up(EventLoop *loop, int i) {
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (loop->timers[parent]->deadline_ms <= loop->timers[i]->deadline_ms) break;
+        ev_heap_swap(loop, parent, i);
+        i = parent;
+    }
+}
+
+static void ev_heap_sift_down(EventLoop *loop, int i) {
+    for (;;) {
+        int left = 2 * i + 1;
+        int right = left + 1;
+        int smallest = i;
+        if (left < loop->num_timers && loop->timers[left]->deadline_ms < loop->timers[smallest]->deadline_ms) {
+            smallest = left;
+        }
+        if (right < loop->num_timers && loop->timers[right]->deadline_ms < loop->timers[smallest]->deadline_ms) {
+            smallest = right;
+        }
+        if (smallest == i) break;
+        ev_heap_swap(loop, i, smallest);
+        i = smallest;
+    }
+}
+
+static int ev_heap_push(EventLoop *loop, EvTimer *t) {
+    if (loop->num_timers >= loop->timer_capacity) {
+        int new_cap = loop->timer_capacity ? loop->timer_capacity * 2 : 16;
+        EvTimer **grown = realloc(loop->timers, sizeof(EvTimer*) * new_cap);
+        if (!grown) return -1;
+        loop->timers = grown;
+        loop->timer_capacity = new_cap;
+    }
+    loop->timers[loop->num_timers] = t;
+    ev_heap_sift_up(loop, loop->num_timers);
+    loop->num_timers++;
+    return 0;
+}
+
+static EvTimer* ev_heap_remove_at(EventLoop *loop, int i) {
+    EvTimer *t = loop->timers[i];
+    loop->num_timers--;
+    if (i != loop->num_timers) {
+        loop->timers[i] = loop->timers[loop->num_timers];
+        ev_heap_sift_down(loop, i);
+        ev_heap_sift_up(loop, i);
+    }
+    return t;
+}
+
+static void ev_timer_free(EvTimer *t) {
+    value_release(t->callback);
+    free(t);
+}
+
+// ========== DISPATCH ==========
+
+// Milliseconds until the next timer is due, capped by timeout_ms (-1 = no cap)
+static int ev_compute_timeout(EventLoop *loop, int timeout_ms) {
+    if (loop->num_timers == 0) return timeout_ms;
+    int64_t until = loop->timers[0]->deadline_ms - ev_now_ms();
+    if (until < 0) until = 0;
+    if (timeout_ms < 0 || until < timeout_ms) return (int)until;
+    return timeout_ms;
+}
+
+// Fire all timers that were due when this pass started
+static int ev_run_timers(EventLoop *loop, ExecutionContext *ctx) {
+    int dispatched = 0;
+    int64_t now = ev_now_ms();
+
+    while (loop->num_timers > 0 && loop->timers[0]->deadline_ms <= now && !loop->stopped) {
+        EvTimer *t = ev_heap_remove_at(loop, 0);
+        loop->firing = t;
+
+        Value result = ev_invoke(t->callback, NULL, 0, ctx);
+        value_release(result);
+        dispatched++;
+
+        loop->firing = NULL;
+        if (t->interval_ms > 0 && !t->cancelled && !loop->closed) {
+            t->deadline_ms += t->interval_ms;
+            if (t->deadline_ms <= now) {
+                t->deadline_ms = now + t->interval_ms;  // Fell behind: don't burst
+            }
+            ev_heap_push(loop, t);
+        } else {
+            ev_timer_free(t);
+        }
+
+        if (ctx->exception_state.is_throwing) break;
+    }
+
+    return dispatched;
+}
+
+// Deliver every queued message of a watched channel
+static int ev_dispatch_channel(EventLoop *loop, EvWatcher *w, ExecutionContext *ctx) {
+    int fd = w->fd;
+    uint64_t id = w->id;
+    Channel *ch = w->target.as.as_channel;
+    int dispatched = 0;
+
+    ev_drain_wakeup(fd);
+
+    Value msg;
+    while (channel_try_recv(ch, &msg)) {
+        Value cb = w->callback;
+        value_retain(cb);
+        Value result = ev_invoke(cb, &msg, 1, ctx);
+        value_release(result);
+        value_release(cb);
+        value_release(msg);
+        dispatched++;
+
+        // The callback may have unwatched the channel or stopped the loop
+        EvWatcher *current = ev_lookup(loop, fd);
+        if (!current || current->id != id || loop->stopped || ctx->exception_state.is_throwing) {
+            return dispatched;
+        }
+    }
+
+    // A closed, drained channel will never become ready again
+    pthread_mutex_lock((pthread_mutex_t*)ch->mutex);
+    int finished = ch->closed && ch->count == 0 && !ch->sender_waiting;
+    pthread_mutex_unlock((pthread_mutex_t*)ch->mutex);
+    if (finished) {
+        ev_remove_watcher(loop, w);
+    }
+
+    return dispatched;
+}
+
+static int ev_dispatch_fd(EventLoop *loop, int fd, int revents, ExecutionContext *ctx) {
+    EvWatcher *w = ev_lookup(loop, fd);
+    if (!w) return 0;  // Removed by an earlier callback in this batch
+
+    if (w->kind == EV_WATCH_CHANNEL) {
+        return ev_dispatch_channel(loop, w, ctx);
+    }
+
+    // Hold our own references: the callback may unregister this watcher
+    Value target = w->target;
+    Value cb = w->callback;
+    value_retain(target);
+    value_retain(cb);
+
+    Value cb_args[2] = { target, val_i32(revents) };
+    Value result = ev_invoke(cb, cb_args, 2, ctx);
+    value_release(result);
+
+    value_release(cb);
+    value_release(target);
+    return 1;
+}
+
+#define EV_MAX_EVENTS 256
+
+// Wait for readiness (bounded by timers) and dispatch callbacks.
+// Returns number of callbacks invoked, or -1 on backend failure.
+static int ev_run_once(EventLoop *loop, int timeout_ms, ExecutionContext *ctx) {
+    int wait_ms = ev_compute_timeout(loop, timeout_ms);
+    int dispatched = 0;
+
+#ifdef EVLOOP_HAVE_EPOLL
+    struct epoll_event events[EV_MAX_EVENTS];
+    int n = epoll_wait(loop->backend_fd, events, EV_MAX_EVENTS, wait_ms);
+    if (n < 0) {
+        if (errno != EINTR) return -1;
+        n = 0;
+    }
+    for (int i = 0; i < n && !loop->stopped && !ctx->exception_state.is_throwing; i++) {
+        dispatched += ev_dispatch_fd(loop, events[i].data.fd, ev_from_epoll(events[i].events), ctx);
+    }
+#else
+    struct pollfd *pfds = NULL;
+    int nfds = 0;
+    if (loop->num_watchers > 0) {
+        pfds = malloc(sizeof(struct pollfd) * loop->num_watchers);
+        if (!pfds) return -1;
+        for (int fd = 0; fd < loop->fd_capacity; fd++) {
+            EvWatcher *w = loop->by_fd[fd];
+            if (!w) continue;
+            pfds[nfds].fd = fd;
+            pfds[nfds].events = (short)w->events;
+            pfds[nfds].revents = 0;
+            nfds++;
+        }
+    }
+    int n = poll(pfds, nfds, wait_ms);
+    if (n < 0 && errno != EINTR) {
+        free(pfds);
+        return -1;
+    }
+    for (int i = 0; i < nfds && n > 0 && !loop->stopped && !ctx->exception_state.is_throwing; i++) {
+        if (pfds[i].revents != 0) {
+            dispatched += ev_dispatch_fd(loop, pfds[i].fd, pfds[i].revents, ctx);
+        }
+    }
+    free(pfds);
+#endif
+
+    if (!loop->stopped && !ctx->exception_state.is_throwing) {
+        dispatched += ev_run_timers(loop, ctx);
+    }
+
+    return dispatched;
+}
+
+// ========== BUILTINS ==========
+
+// __evloop_new() -> ptr
+Value builtin_evloop_new(Value *args, int num_args, ExecutionContext *ctx) {
+    (void)args;
+    if (num_args != 0) {
+        return throw_runtime_error(ctx, "__evloop_new() expects 0 arguments");
+    }
+
+    EventLoop *loop = calloc(1, sizeof(EventLoop));
+    if (!loop) {
+        return throw_runtime_error(ctx, "__evloop_new() memory allocation failed");
+    }
+
+#ifdef EVLOOP_HAVE_EPOLL
+    loop->backend_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (loop->backend_fd < 0) {
+        free(loop);
+        return throw_runtime_error(ctx, "Failed to create event loop: %s", strerror(errno));
+    }
+#else
+    loop->backend_fd = -1;
+#endif
+    loop->next_watcher_id = 1;
+    loop->next_timer_id = 1;
+
+    return val_ptr(loop);
+}
+
+// __evloop_backend(loop) -> string ("epoll" or "poll")
+Value builtin_evloop_backend(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        return throw_runtime_error(ctx, "__evloop_backend() expects 1 argument (loop)");
+    }
+    if (!ev_get_loop(args[0], "__evloop_backend", ctx)) return val_null();
+#ifdef EVLOOP_HAVE_EPOLL
+    return val_string("epoll");
+#else
+    return val_string("poll");
+#endif
+}
+
+// __evloop_register(loop, target, events, callback, edge) -> null
+// target is a socket, file, or raw fd; callback(target, revents)
+Value builtin_evloop_register(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 5) {
+        return throw_runtime_error(ctx, "__evloop_register() expects 5 arguments (loop, target, events, callback, edge)");
+    }
+    EventLoop *loop = ev_get_loop(args[0], "__evloop_register", ctx);
+    if (!loop) return val_null();
+
+    int fd = ev_fd_from_value(args[1]);
+    if (fd < 0) {
+        return throw_runtime_error(ctx, "register() target must be an open socket, file, or fd");
+    }
+    if (!is_integer(args[2])) {
+        return throw_runtime_error(ctx, "register() events must be an integer (POLLIN | POLLOUT)");
+    }
+    if (!ev_is_callable(args[3])) {
+        return throw_runtime_error(ctx, "register() callback must be a function");
+    }
+
+    EvWatcher *existing = ev_lookup(loop, fd);
+    if (existing) {
+        if (!ev_watcher_is_stale(existing)) {
+            return throw_runtime_error(ctx, "register() fd %d is already registered", fd);
+        }
+        ev_remove_watcher(loop, existing);
+    }
+
+    if (ev_ensure_fd_capacity(loop, fd) < 0) {
+        return throw_runtime_error(ctx, "register() memory allocation failed");
+    }
+
+    EvWatcher *w = calloc(1, sizeof(EvWatcher));
+    if (!w) {
+        return throw_runtime_error(ctx, "register() memory allocation failed");
+    }
+    w->id = loop->next_watcher_id++;
+    w->kind = EV_WATCH_FD;
+    w->fd = fd;
+    w->wake_write_fd = -1;
+    w->events = value_to_int(args[2]);
+    w->edge = value_is_truthy(args[4]);
+    w->target = args[1];
+    w->callback = args[3];
+
+    if (ev_backend_ctl(loop, 0, w) < 0) {
+        free(w);
+        return throw_runtime_error(ctx, "register() failed for fd %d: %s", fd, strerror(errno));
+    }
+
+    value_retain(w->target);
+    value_retain(w->callback);
+    loop->by_fd[fd] = w;
+    loop->num_watchers++;
+
+    return val_null();
+}
+
+// __evloop_modify(loop, target, events) -> null
+Value builtin_evloop_modify(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 3) {
+        return throw_runtime_error(ctx, "__evloop_modify() expects 3 arguments (loop, target, events)");
+    }
+    EventLoop *loop = ev_get_loop(args[0], "__evloop_modify", ctx);
+    if (!loop) return val_null();
+
+    int fd = ev_fd_from_value(args[1]);
+    EvWatcher *w = ev_lookup(loop, fd);
+    if (!w || w->kind != EV_WATCH_FD) {
+        return throw_runtime_error(ctx, "modify() target is not registered");
+    }
+    if (!is_integer(args[2])) {
+        return throw_runtime_error(ctx, "modify() events must be an integer");
+    }
+
+    w->events = value_to_int(args[2]);
+    if (ev_backend_ctl(loop, 1, w) < 0) {
+        return throw_runtime_error(ctx, "modify() failed for fd %d: %s", fd, strerror(errno));
+    }
+    return val_null();
+}
+
+// __evloop_unregister(loop, target) -> bool
+// Must be called before closing a registered socket or file
+Value builtin_evloop_unregister(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2) {
+        return throw_runtime_error(ctx, "__evloop_unregister() expects 2 arguments (loop, target)");
+    }
+    EventLoop *loop = ev_get_loop(args[0], "__evloop_unregister", ctx);
+    if (!loop) return val_null();
+
+    EvWatcher *w = NULL;
+    if (args[1].type == VAL_CHANNEL) {
+        for (int fd = 0; fd < loop->fd_capacity && !w; fd++) {
+            EvWatcher *candidate = loop->by_fd[fd];
+            if (candidate && candidate->kind == EV_WATCH_CHANNEL &&
+                candidate->target.as.as_channel == args[1].as.as_channel) {
+                w = candidate;
+            }
+        }
+    } else {
+        w = ev_lookup(loop, ev_fd_from_value(args[1]));
+    }
+
+    if (!w) return val_bool(0);
+    ev_remove_watcher(loop, w);
+    return val_bool(1);
+}
+
+// __evloop_watch_channel(loop, channel, callback) -> null
+// callback(message) runs on the loop thread for every message sent
+Value builtin_evloop_watch_channel(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 3) {
+        return throw_runtime_error(ctx, "__evloop_watch_channel() expects 3 arguments (loop, channel, callback)");
+    }
+    EventLoop *loop = ev_get_loop(args[0], "__evloop_watch_channel", ctx);
+    if (!loop) return val_null();
+
+    if (args[1].type != VAL_CHANNEL) {
+        return throw_runtime_error(ctx, "watch_channel() expects a channel");
+    }
+    if (!ev_is_callable(args[2])) {
+        return throw_runtime_error(ctx, "watch_channel() callback must be a function");
+    }
+
+    Channel *ch = args[1].as.as_channel;
+    int read_fd, write_fd;
+    if (ev_make_wakeup(&read_fd, &write_fd) < 0) {
+        return throw_runtime_error(ctx, "watch_channel() failed to create wakeup fd: %s", strerror(errno));
+    }
+
+    pthread_mutex_lock((pthread_mutex_t*)ch->mutex);
+    if (ch->notify_fd >= 0) {
+        pthread_mutex_unlock((pthread_mutex_t*)ch->mutex);
+        close(read_fd);
+        if (write_fd != read_fd) close(write_fd);
+        return throw_runtime_error(ctx, "watch_channel() channel is already watched by an event loop");
+    }
+    ch->notify_fd = write_fd;
+    // Messages queued before the watch was installed must not be missed
+    int pending = ch->count > 0 || ch->sender_waiting || ch->closed;
+    pthread_mutex_unlock((pthread_mutex_t*)ch->mutex);
+
+    EvWatcher *w = calloc(1, sizeof(EvWatcher));
+    if (!w || ev_ensure_fd_capacity(loop, read_fd) < 0) {
+        free(w);
+        pthread_mutex_lock((pthread_mutex_t*)ch->mutex);
+        ch->notify_fd = -1;
+        pthread_mutex_unlock((pthread_mutex_t*)ch->mutex);
+        close(read_fd);
+        if (write_fd != read_fd) close(write_fd);
+        return throw_runtime_error(ctx, "watch_channel() memory allocation failed");
+    }
+    w->id = loop->next_watcher_id++;
+    w->kind = EV_WATCH_CHANNEL;
+    w->fd = read_fd;
+    w->wake_write_fd = write_fd;
+    w->events = POLLIN;
+    w->edge = 0;
+    w->target = args[1];
+    w->callback = args[2];
+    value_retain(w->target);
+    value_retain(w->callback);
+
+    if (ev_backend_ctl(loop, 0, w) < 0) {
+        int saved = errno;
+        ev_watcher_free(w);
+        return throw_runtime_error(ctx, "watch_channel() failed: %s", strerror(saved));
+    }
+    loop->by_fd[read_fd] = w;
+    loop->num_watchers++;
+
+    if (pending) {
+        uint64_t one = 1;
+        ssize_t ignored = write(write_fd, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    return val_null();
+}
+
+// __evloop_add_timer(loop, delay_ms, callback, repeat) -> i32 timer id
+Value builtin_evloop_add_timer(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 4) {
+        return throw_runtime_error(ctx, "__evloop_add_timer() expects 4 arguments (loop, delay_ms, callback, repeat)");
+    }
+    EventLoop *loop = ev_get_loop(args[0], "__evloop_add_timer", ctx);
+    if (!loop) return val_null();
+
+    if (!is_numeric(args[1])) {
+        return throw_runtime_error(ctx, "timer delay must be a number of milliseconds");
+    }
+    if (!ev_is_callable(args[2])) {
+        return throw_runtime_error(ctx, "timer callback must be a function");
+    }
+
+    int64_t delay = value_to_int64(args[1]);
+    if (delay < 0) delay = 0;
+    int repeat = value_is_truthy(args[3]);
+
+    EvTimer *t = calloc(1, sizeof(EvTimer));
+    if (!t) {
+        return throw_runtime_error(ctx, "timer memory allocation failed");
+    }
+    t->id = loop->next_timer_id++;
+    t->deadline_ms = ev_now_ms() + delay;
+    t->interval_ms = repeat ? (delay > 0 ? delay : 1) : 0;
+    t->callback = args[2];
+    value_retain(t->callback);
+
+    if (ev_heap_push(loop, t) < 0) {
+        ev_timer_free(t);
+        return throw_runtime_error(ctx, "timer memory allocation failed");
+    }
+
+    return val_i32(t->id);
+}
+
+// __evloop_cancel_timer(loop, id) -> bool
+Value builtin_evloop_cancel_timer(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2) {
+        return throw_runtime_error(ctx, "__evloop_cancel_timer() expects 2 arguments (loop, id)");
+    }
+    EventLoop *loop = ev_get_loop(args[0], "__evloop_cancel_timer", ctx);
+    if (!loop) return val_null();
+    if (!is_integer(args[1])) {
+        return throw_runtime_error(ctx, "cancel_timer() id must be an integer");
+    }
+
+    int id = value_to_int(args[1]);
+    if (loop->firing && loop->firing->id == id) {
+        loop->firing->cancelled = 1;
+        return val_bool(1);
+    }
+    for (int i = 0; i < loop->num_timers; i++) {
+        if (loop->timers[i]->id == id) {
+            ev_timer_free(ev_heap_remove_at(loop, i));
+            return val_bool(1);
+        }
+    }
+    return val_bool(0);
+}
+
+// __evloop_run_once(loop, timeout_ms) -> i32 callbacks dispatched
+// timeout_ms of -1 waits until something is ready
+Value builtin_evloop_run_once(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2) {
+        return throw_runtime_error(ctx, "__evloop_run_once() expects 2 arguments (loop, timeout_ms)");
+    }
+    EventLoop *loop = ev_get_loop(args[0], "__evloop_run_once", ctx);
+    if (!loop) return val_null();
+    if (!is_integer(args[1])) {
+        return throw_runtime_error(ctx, "run_once() timeout must be an integer");
+    }
+
+    loop->stopped = 0;
+    int dispatched = ev_run_once(loop, value_to_int(args[1]), ctx);
+    if (dispatched < 0) {
+        return throw_runtime_error(ctx, "Event loop wait failed: %s", strerror(errno));
+    }
+    return val_i32(dispatched);
+}
+
+// __evloop_run(loop) -> null
+// Runs until stop() is called or nothing is registered and no timers remain
+Value builtin_evloop_run(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        return throw_runtime_error(ctx, "__evloop_run() expects 1 argument (loop)");
+    }
+    EventLoop *loop = ev_get_loop(args[0], "__evloop_run", ctx);
+    if (!loop) return val_null();
+
+    loop->stopped = 0;
+    while (!loop->stopped && !loop->closed && (loop->num_watchers > 0 || loop->num_timers > 0)) {
+        if (ev_run_once(loop, -1, ctx) < 0) {
+            return throw_runtime_error(ctx, "Event loop wait failed: %s", strerror(errno));
+        }
+        if (ctx->exception_state.is_throwing) {
+            break;  // Propagate exceptions thrown by callbacks
+        }
+    }
+    return val_null();
+}
+
+// __evloop_stop(loop) -> null
+// Makes run() return after the current callback
+Value builtin_evloop_stop(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        return throw_runtime_error(ctx, "__evloop_stop() expects 1 argument (loop)");
+    }
+    EventLoop *loop = ev_get_loop(args[0], "__evloop_stop", ctx);
+    if (!loop) return val_null();
+    loop->stopped = 1;
+    return val_null();
+}
+
+// __evloop_free(loop) -> null
+// Releases all registrations and timers; registered sockets are not closed
+Value builtin_evloop_free(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        return throw_runtime_error(ctx, "__evloop_free() expects 1 argument (loop)");
+    }
+    EventLoop *loop = ev_get_loop(args[0], "__evloop_free", ctx);
+    if (!loop) return val_null();
+
+    for (int fd = 0; fd < loop->fd_capacity; fd++) {
+        if (loop->by_fd[fd]) {
+            ev_remove_watcher(loop, loop->by_fd[fd]);
+        }
+    }
+    free(loop->by_fd);
+    loop->by_fd = NULL;
+    loop->fd_capacity = 0;
+
+    for (int i = 0; i < loop->num_timers; i++) {
+        ev_timer_free(loop->timers[i]);
+    }
+    free(loop->timers);
+    loop->timers = NULL;
+    loop->num_timers = 0;
+    if (loop->firing) {
+        loop->firing->cancelled = 1;
+    }
+
+    if (loop->backend_fd >= 0) {
+        close(loop->backend_fd);
+        loop->backend_fd = -1;
+    }
+
+    // The handle may still be referenced by Hemlock values, so the struct
+    // itself stays allocated and is marked closed instead of freed
+    loop->closed = 1;
+    loop->stopped = 1;
+    return val_null();
+}
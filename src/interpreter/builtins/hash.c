@@ -0,0 +1,184 @@
+#include "internal.h"
+#include "../../shared/hash_core.h"
+
+// ============================================================================
+// INCREMENTAL HASHERS
+// ============================================================================
+//
+// A hasher handle holds the running state of one digest. The algorithms,
+// murmur3 and file streaming live in the shared core (src/shared/hash_core.c);
+// these builtins check arguments and feed string/buffer bytes in place.
+
+static Hasher* hasher_get(Value val, const char *fn_name, ExecutionContext *ctx) {
+    if (val.type != VAL_PTR || val.as.as_ptr == NULL) {
+        runtime_error(ctx, "%s() expects a hasher handle", fn_name);
+        return NULL;
+    }
+    Hasher *hs = (Hasher*)val.as.as_ptr;
+    if (hs->closed) {
+        runtime_error(ctx, "%s() called on closed hasher", fn_name);
+        return NULL;
+    }
+    return hs;
+}
+
+// __hasher_new(algorithm: string, seed: i32) -> ptr
+// algorithm is "sha256", "sha512", "sha1", "md5", "murmur3", "fnv1a",
+// "djb2" or "crc32"; seed is only used by murmur3
+Value builtin_hasher_new(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2) {
+        runtime_error(ctx, "hasher_new() expects 2 arguments (algorithm, seed)");
+        return val_null();
+    }
+    if (args[0].type != VAL_STRING || !is_numeric(args[1])) {
+        runtime_error(ctx, "hasher_new() expects (string algorithm, integer seed)");
+        return val_null();
+    }
+    int algo = hasher_algo(args[0].as.as_string->data);
+    if (algo < 0) {
+        runtime_error(ctx, "hasher_new() unknown algorithm '%s'", args[0].as.as_string->data);
+        return val_null();
+    }
+
+    char err[HASHER_ERR_LEN];
+    Hasher *hs = hasher_new((HasherAlgo)algo, (uint32_t)value_to_int64(args[1]), err);
+    if (!hs) {
+        runtime_error(ctx, "hasher_new() %s", err);
+        return val_null();
+    }
+    return val_ptr(hs);
+}
+
+// __hasher_update(hasher: ptr, data: string | buffer) -> null
+Value builtin_hasher_update(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2) {
+        runtime_error(ctx, "hasher_update() expects 2 arguments (hasher, data)");
+        return val_null();
+    }
+    Hasher *hs = hasher_get(args[0], "hasher_update", ctx);
+    if (!hs) return val_null();
+
+    if (args[1].type == VAL_STRING) {
+        hasher_feed(hs, args[1].as.as_string->data, (size_t)args[1].as.as_string->length);
+    } else if (args[1].type == VAL_BUFFER) {
+        hasher_feed(hs, args[1].as.as_buffer->data, (size_t)args[1].as.as_buffer->length);
+    } else {
+        runtime_error(ctx, "hasher_update() data must be string or buffer");
+    }
+    return val_null();
+}
+
+// __hasher_update_file(hasher: ptr, path: string) -> i64
+// Stream a whole file through the hasher; returns the number of bytes read
+Value builtin_hasher_update_file(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2) {
+        runtime_error(ctx, "hasher_update_file() expects 2 arguments (hasher, path)");
+        return val_null();
+    }
+    Hasher *hs = hasher_get(args[0], "hasher_update_file", ctx);
+    if (!hs) return val_null();
+    if (args[1].type != VAL_STRING) {
+        runtime_error(ctx, "hasher_update_file() path must be a string");
+        return val_null();
+    }
+
+    char err[HASHER_ERR_LEN];
+    int64_t total = hasher_feed_file(hs, args[1].as.as_string->data, err);
+    if (total < 0) {
+        runtime_error(ctx, "%s", err);
+        return val_null();
+    }
+    return val_i64(total);
+}
+
+// __hasher_digest(hasher: ptr) -> buffer
+Value builtin_hasher_digest(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "hasher_digest() expects 1 argument (hasher)");
+        return val_null();
+    }
+    Hasher *hs = hasher_get(args[0], "hasher_digest", ctx);
+    if (!hs) return val_null();
+
+    unsigned char md[HASHER_MAX_DIGEST];
+    int len = hasher_finish(hs, md);
+    if (len < 0) {
+        runtime_error(ctx, "hasher_digest() failed to finalize digest");
+        return val_null();
+    }
+    Buffer *buf = malloc(sizeof(Buffer));
+    buf->data = malloc((size_t)len);
+    memcpy(buf->data, md, (size_t)len);
+    buf->length = len;
+    buf->capacity = len;
+    buf->ref_count = 1;
+    return (Value){ .type = VAL_BUFFER, .as.as_buffer = buf };
+}
+
+// __hasher_hex_digest(hasher: ptr) -> string (lowercase hex)
+Value builtin_hasher_hex_digest(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "hasher_hex_digest() expects 1 argument (hasher)");
+        return val_null();
+    }
+    Hasher *hs = hasher_get(args[0], "hasher_hex_digest", ctx);
+    if (!hs) return val_null();
+
+    unsigned char md[HASHER_MAX_DIGEST];
+    int len = hasher_finish(hs, md);
+    if (len < 0) {
+        runtime_error(ctx, "hasher_hex_digest() failed to finalize digest");
+        return val_null();
+    }
+    static const char hex_chars[] = "0123456789abcdef";
+    char *hex = malloc((size_t)len * 2 + 1);
+    for (int i = 0; i < len; i++) {
+        hex[i * 2] = hex_chars[md[i] >> 4];
+        hex[i * 2 + 1] = hex_chars[md[i] & 15];
+    }
+    hex[len * 2] = '\0';
+    return val_string_take(hex, len * 2, len * 2 + 1);
+}
+
+// __hasher_value(hasher: ptr) -> u32
+// Integer value of a 32-bit hash (murmur3, fnv1a, djb2, crc32)
+Value builtin_hasher_value(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "hasher_value() expects 1 argument (hasher)");
+        return val_null();
+    }
+    Hasher *hs = hasher_get(args[0], "hasher_value", ctx);
+    if (!hs) return val_null();
+    if (hs->md != NULL) {
+        runtime_error(ctx, "hasher_value() is only available for 32-bit hashes; use digest()");
+        return val_null();
+    }
+    return val_u32(hasher_value32(hs));
+}
+
+// __hasher_reset(hasher: ptr) -> null
+Value builtin_hasher_reset(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "hasher_reset() expects 1 argument (hasher)");
+        return val_null();
+    }
+    Hasher *hs = hasher_get(args[0], "hasher_reset", ctx);
+    if (!hs) return val_null();
+    hasher_reset(hs);
+    return val_null();
+}
+
+// __hasher_free(hasher: ptr) -> null
+Value builtin_hasher_free(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "hasher_free() expects 1 argument (hasher)");
+        return val_null();
+    }
+    Hasher *hs = hasher_get(args[0], "hasher_free", ctx);
+    if (!hs) return val_null();
+
+    // The handle may still be referenced by Hemlock values, so the struct
+    // stays allocated and is marked closed instead of freed
+    hasher_close(hs);
+    return val_null();
+}
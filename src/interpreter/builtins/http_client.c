@@ -0,0 +1,285 @@
+#include "internal.h"
+#include "../../shared/http_client_core.h"
+
+// ============================================================================
+// PERSISTENT HTTP/1.1 CLIENT
+// ============================================================================
+//
+// Builtins for the @stdlib/http client. The connection pool, request writing
+// and response parsing live in src/shared/http_client_core.c, which the
+// runtime library compiles too: a client handle owns a pool of idle
+// keep-alive connections keyed by scheme://host:port, a request returns a
+// response handle as soon as the status line and headers are in, and the
+// body is then pulled through read()/body().
+
+// ========== BUILTINS ==========
+
+static HttpClient* http_client_get(Value val, const char *fn_name, ExecutionContext *ctx) {
+    if (val.type != VAL_PTR || !val.as.as_ptr) {
+        runtime_error(ctx, "%s() expects an HTTP client handle", fn_name);
+        return NULL;
+    }
+    HttpClient *client = (HttpClient*)val.as.as_ptr;
+    if (http_client_closed(client)) {
+        runtime_error(ctx, "%s() called on closed HTTP client", fn_name);
+        return NULL;
+    }
+    return client;
+}
+
+static HttpResponse* http_response_get(Value val, const char *fn_name, ExecutionContext *ctx) {
+    if (val.type != VAL_PTR || !val.as.as_ptr) {
+        runtime_error(ctx, "%s() expects an HTTP response handle", fn_name);
+        return NULL;
+    }
+    return (HttpResponse*)val.as.as_ptr;
+}
+
+// __http_client_new(timeout_ms, max_idle_per_host, verify_tls) -> ptr
+Value builtin_http_client_new(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 3) {
+        runtime_error(ctx, "http_client_new() expects 3 arguments (timeout_ms, max_idle_per_host, verify_tls)");
+        return val_null();
+    }
+    if (!is_integer(args[0]) || !is_integer(args[1]) || args[2].type != VAL_BOOL) {
+        runtime_error(ctx, "http_client_new() expects (integer, integer, bool)");
+        return val_null();
+    }
+    int timeout_ms = value_to_int(args[0]);
+    int max_idle = value_to_int(args[1]);
+    if (timeout_ms <= 0 || max_idle < 0) {
+        runtime_error(ctx, "http_client_new() timeout must be positive and max_idle_per_host non-negative");
+        return val_null();
+    }
+    HttpClient *client = http_client_create(timeout_ms, max_idle, args[2].as.as_bool);
+    if (!client) {
+        runtime_error(ctx, "http_client_new() memory allocation failed");
+        return val_null();
+    }
+    return val_ptr(client);
+}
+
+// __http_client_free(client): close the pool and release the client
+Value builtin_http_client_free(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "http_client_free() expects 1 argument (client)");
+        return val_null();
+    }
+    HttpClient *client = http_client_get(args[0], "http_client_free", ctx);
+    if (!client) {
+        return val_null();
+    }
+    http_client_close(client);
+    return val_null();
+}
+
+// __http_client_stats(client) -> { opened, reused, idle }
+Value builtin_http_client_stats(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "http_client_stats() expects 1 argument (client)");
+        return val_null();
+    }
+    HttpClient *client = http_client_get(args[0], "http_client_stats", ctx);
+    if (!client) {
+        return val_null();
+    }
+    long opened, reused;
+    int idle;
+    http_client_stats(client, &opened, &reused, &idle);
+    Object *obj = object_new(NULL, 3);
+    char *field_names[] = {"opened", "reused", "idle"};
+    Value field_values[] = { val_i32((int32_t)opened), val_i32((int32_t)reused), val_i32(idle) };
+    for (int i = 0; i < 3; i++) {
+        obj->field_names[i] = strdup(field_names[i]);
+        obj->field_values[i] = field_values[i];
+        obj->num_fields++;
+    }
+    return val_object(obj);
+}
+
+// __http_request(client, method, url, headers, body) -> response handle
+// headers: null, array of "Name: value" strings, or object of name -> value
+// body: null, string or buffer
+Value builtin_http_request(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 5) {
+        runtime_error(ctx, "http_request() expects 5 arguments (client, method, url, headers, body)");
+        return val_null();
+    }
+    HttpClient *client = http_client_get(args[0], "http_request", ctx);
+    if (!client) {
+        return val_null();
+    }
+    if (args[1].type != VAL_STRING || args[2].type != VAL_STRING) {
+        runtime_error(ctx, "http_request() method and url must be strings");
+        return val_null();
+    }
+
+    size_t hlen = 0, hcap = 256;
+    char *headers = malloc(hcap);
+    headers[0] = '\0';
+    int bad = 0;
+    if (args[3].type == VAL_ARRAY) {
+        Array *arr = args[3].as.as_array;
+        for (int i = 0; i < arr->length && !bad; i++) {
+            Value h = arr->elements[i];
+            if (h.type != VAL_STRING) {
+                bad = 1;
+                break;
+            }
+            bad = http_header_block_append(&headers, &hlen, &hcap, h.as.as_string->data,
+                                           (size_t)h.as.as_string->length) != 0;
+        }
+    } else if (args[3].type == VAL_OBJECT) {
+        Object *obj = args[3].as.as_object;
+        for (int i = 0; i < obj->num_fields && !bad; i++) {
+            Value v = obj->field_values[i];
+            char *vs = value_to_string(v);
+            size_t line_len = strlen(obj->field_names[i]) + 2 + strlen(vs);
+            char *line = malloc(line_len + 1);
+            snprintf(line, line_len + 1, "%s: %s", obj->field_names[i], vs);
+            bad = http_header_block_append(&headers, &hlen, &hcap, line, line_len) != 0;
+            free(line);
+            free(vs);
+        }
+    } else if (args[3].type != VAL_NULL) {
+        bad = 1;
+    }
+    if (bad) {
+        free(headers);
+        runtime_error(ctx, "http_request() headers must be an array of \"Name: value\" strings or an object of single-line values");
+        return val_null();
+    }
+
+    const char *body = NULL;
+    size_t body_len = 0;
+    if (args[4].type == VAL_STRING) {
+        body = args[4].as.as_string->data;
+        body_len = (size_t)args[4].as.as_string->length;
+    } else if (args[4].type == VAL_BUFFER) {
+        body = args[4].as.as_buffer->data;
+        body_len = (size_t)args[4].as.as_buffer->length;
+    } else if (args[4].type != VAL_NULL) {
+        free(headers);
+        runtime_error(ctx, "http_request() body must be a string, buffer or null");
+        return val_null();
+    }
+
+    char method[HTTP_METHOD_MAX];
+    if (http_method_normalize(args[1].as.as_string->data, method) != 0) {
+        free(headers);
+        runtime_error(ctx, "http_request() invalid method '%s'", args[1].as.as_string->data);
+        return val_null();
+    }
+
+    char err[HTTP_ERR_LEN];
+    HttpResponse *resp = http_client_request(client, method, args[2].as.as_string->data,
+                                             headers, body, body_len, err);
+    free(headers);
+    if (!resp) {
+        runtime_error(ctx, "HTTP request failed: %s %s: %s", method, args[2].as.as_string->data, err);
+        return val_null();
+    }
+    return val_ptr(resp);
+}
+
+// __http_response_status(resp) -> i32
+Value builtin_http_response_status(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "http_response_status() expects 1 argument (response)");
+        return val_null();
+    }
+    HttpResponse *resp = http_response_get(args[0], "http_response_status", ctx);
+    if (!resp) {
+        return val_null();
+    }
+    return val_i32(http_response_status(resp));
+}
+
+// __http_response_headers(resp) -> object of lowercased name -> value
+Value builtin_http_response_headers(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "http_response_headers() expects 1 argument (response)");
+        return val_null();
+    }
+    HttpResponse *resp = http_response_get(args[0], "http_response_headers", ctx);
+    if (!resp) {
+        return val_null();
+    }
+    int count = http_response_header_count(resp);
+    Object *obj = object_new(NULL, count > 0 ? count : 1);
+    for (int i = 0; i < count; i++) {
+        obj->field_names[i] = strdup(http_response_header_name(resp, i));
+        obj->field_values[i] = val_string(http_response_header_value(resp, i));
+        obj->num_fields++;
+    }
+    return val_object(obj);
+}
+
+// __http_response_read(resp, max) -> string of up to max body bytes, "" at end
+Value builtin_http_response_read(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2 || !is_integer(args[1])) {
+        runtime_error(ctx, "http_response_read() expects 2 arguments (response, max_bytes)");
+        return val_null();
+    }
+    HttpResponse *resp = http_response_get(args[0], "http_response_read", ctx);
+    if (!resp) {
+        return val_null();
+    }
+    int max = value_to_int(args[1]);
+    if (max <= 0) {
+        runtime_error(ctx, "http_response_read() max_bytes must be positive");
+        return val_null();
+    }
+    if (http_response_finished(resp)) {
+        return val_string("");
+    }
+    char *out = malloc((size_t)max + 1);
+    if (!out) {
+        runtime_error(ctx, "http_response_read() memory allocation failed");
+        return val_null();
+    }
+    char err[HTTP_ERR_LEN];
+    ssize_t n = http_response_read(resp, out, (size_t)max, err);
+    if (n < 0) {
+        free(out);
+        runtime_error(ctx, "HTTP read failed: %s", err);
+        return val_null();
+    }
+    out[n] = '\0';
+    return val_string_take(out, (int)n, max + 1);
+}
+
+// __http_response_body(resp) -> rest of the body as a string
+Value builtin_http_response_body(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "http_response_body() expects 1 argument (response)");
+        return val_null();
+    }
+    HttpResponse *resp = http_response_get(args[0], "http_response_body", ctx);
+    if (!resp) {
+        return val_null();
+    }
+    size_t len, cap;
+    char err[HTTP_ERR_LEN];
+    char *out = http_response_read_all(resp, &len, &cap, err);
+    if (!out) {
+        runtime_error(ctx, "HTTP read failed: %s", err);
+        return val_null();
+    }
+    return val_string_take(out, (int)len, (int)cap);
+}
+
+// __http_response_close(resp): reuse the connection if the body was read
+// to the end, otherwise close it
+Value builtin_http_response_close(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "http_response_close() expects 1 argument (response)");
+        return val_null();
+    }
+    HttpResponse *resp = http_response_get(args[0], "http_response_close", ctx);
+    if (!resp) {
+        return val_null();
+    }
+    http_response_close(resp);
+    return val_null();
+}
@@ -0,0 +1,377 @@
+#include "internal.h"
+#include "../../shared/http_server_core.h"
+
+// ============================================================================
+// NATIVE HTTP/1.1 SERVER
+// ============================================================================
+//
+// The sockets, the request parser and response framing live in the shared
+// core (src/shared/http_server_core.c): one I/O thread runs every
+// connection through epoll and hands complete requests to a fixed pool of
+// worker threads. Each worker has its own ExecutionContext; for every
+// request it builds the Hemlock request object, calls the handler and
+// writes the result back through the core.
+
+#ifdef HTTPD_HAVE_EPOLL
+
+// ========== HEMLOCK BOUNDARY ==========
+
+static Value httpd_string(const char *data, size_t len) {
+    char *copy = malloc(len + 1);
+    if (!copy) {
+        fprintf(stderr, "Runtime error: Memory allocation failed\n");
+        exit(1);
+    }
+    memcpy(copy, data, len);
+    copy[len] = '\0';
+    return val_string_take(copy, (int)len, (int)len + 1);
+}
+
+static void httpd_object_add(Object *obj, const char *name, Value value) {
+    obj->field_names[obj->num_fields] = strdup(name);
+    obj->field_values[obj->num_fields] = value;
+    obj->num_fields++;
+}
+
+// { method, target, path, query, version, headers, body }
+static Value httpd_request_value(HttpdConn *c) {
+    int num_headers = httpd_request_header_count(c);
+    Object *headers = object_new(NULL, num_headers > 0 ? num_headers : 1);
+    for (int i = 0; i < num_headers; i++) {
+        const char *name, *value;
+        size_t name_len, value_len;
+        httpd_request_header(c, i, &name, &name_len, &value, &value_len);
+
+        int found = -1;
+        for (int j = 0; j < headers->num_fields; j++) {
+            if (strlen(headers->field_names[j]) == name_len &&
+                memcmp(headers->field_names[j], name, name_len) == 0) {
+                found = j;
+                break;
+            }
+        }
+        if (found < 0) {
+            headers->field_names[headers->num_fields] = strndup(name, name_len);
+            headers->field_values[headers->num_fields] = httpd_string(value, value_len);
+            headers->num_fields++;
+            continue;
+        }
+        // Repeated fields are joined with ", " as in the client
+        String *old = headers->field_values[found].as.as_string;
+        size_t len = (size_t)old->length + 2 + value_len;
+        char *merged = malloc(len + 1);
+        if (!merged) {
+            fprintf(stderr, "Runtime error: Memory allocation failed\n");
+            exit(1);
+        }
+        memcpy(merged, old->data, (size_t)old->length);
+        memcpy(merged + old->length, ", ", 2);
+        memcpy(merged + old->length + 2, value, value_len);
+        merged[len] = '\0';
+        value_release(headers->field_values[found]);
+        headers->field_values[found] = val_string_take(merged, (int)len, (int)len + 1);
+    }
+
+    size_t method_len, target_len, body_len;
+    const char *method = httpd_request_method(c, &method_len);
+    const char *target = httpd_request_target(c, &target_len);
+    const char *body = httpd_request_body(c, &body_len);
+    const char *query = memchr(target, '?', target_len);
+    size_t path_len = query ? (size_t)(query - target) : target_len;
+
+    Object *req = object_new(NULL, 7);
+    httpd_object_add(req, "method", httpd_string(method, method_len));
+    httpd_object_add(req, "target", httpd_string(target, target_len));
+    httpd_object_add(req, "path", httpd_string(target, path_len));
+    httpd_object_add(req, "query", query ? httpd_string(query + 1, target_len - path_len - 1) : httpd_string("", 0));
+    httpd_object_add(req, "version", httpd_string(httpd_request_version(c), 8));
+    httpd_object_add(req, "headers", val_object(headers));
+    httpd_object_add(req, "body", httpd_string(body, body_len));
+    return val_object(req);
+}
+
+static Value* httpd_field(Object *obj, const char *name) {
+    for (int i = 0; i < obj->num_fields; i++) {
+        if (strcmp(obj->field_names[i], name) == 0) {
+            return &obj->field_values[i];
+        }
+    }
+    return NULL;
+}
+
+static int httpd_body_bytes(Value body, const char **data, size_t *len, const char **type) {
+    if (body.type == VAL_NULL) {
+        *data = "";
+        *len = 0;
+    } else if (body.type == VAL_STRING) {
+        *data = body.as.as_string->data;
+        *len = (size_t)body.as.as_string->length;
+        *type = "text/plain; charset=utf-8";
+    } else if (body.type == VAL_BUFFER) {
+        *data = (const char*)body.as.as_buffer->data;
+        *len = (size_t)body.as.as_buffer->length;
+        *type = "application/octet-stream";
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+// Write the handler's result: a string or buffer (200), null (204), or an
+// object { status?, headers?, body? }. Returns 0 for anything else.
+static int httpd_render_response(HttpdConn *c, Value result) {
+    int status = 200;
+    const char *body = "";
+    size_t body_len = 0;
+    const char *type = NULL;
+    Value *headers = NULL;
+
+    if (result.type == VAL_NULL) {
+        status = 204;
+    } else if (result.type == VAL_OBJECT) {
+        Object *obj = result.as.as_object;
+        Value *field = httpd_field(obj, "status");
+        if (field && field->type != VAL_NULL) {
+            if (!is_integer(*field)) return 0;
+            int64_t s = value_to_int64(*field);
+            if (s < 200 || s > 599) return 0;
+            status = (int)s;
+        }
+        field = httpd_field(obj, "body");
+        if (field && !httpd_body_bytes(*field, &body, &body_len, &type)) {
+            return 0;
+        }
+        headers = httpd_field(obj, "headers");
+    } else if (!httpd_body_bytes(result, &body, &body_len, &type)) {
+        return 0;
+    }
+
+    httpd_response_begin(c, status);
+    int ok = 1;
+    if (headers && headers->type == VAL_OBJECT) {
+        Object *h = headers->as.as_object;
+        for (int i = 0; i < h->num_fields && ok; i++) {
+            char *value = value_to_string(h->field_values[i]);
+            ok = httpd_response_header(c, h->field_names[i], strlen(h->field_names[i]),
+                                       value, strlen(value));
+            free(value);
+        }
+    } else if (headers && headers->type == VAL_ARRAY) {
+        // "Name: value" strings, as the client accepts
+        Array *h = headers->as.as_array;
+        for (int i = 0; i < h->length && ok; i++) {
+            Value line = h->elements[i];
+            ok = line.type == VAL_STRING &&
+                 httpd_response_header_line(c, line.as.as_string->data, (size_t)line.as.as_string->length);
+        }
+    } else if (headers && headers->type != VAL_NULL) {
+        ok = 0;
+    }
+    if (!ok) {
+        httpd_response_cancel(c);
+        return 0;
+    }
+    httpd_response_end(c, body, body_len, type);
+    return 1;
+}
+
+// Reset a worker context between requests, as for FFI callbacks
+static void httpd_reset_ctx(ExecutionContext *ctx) {
+    ctx->return_state.is_returning = 0;
+    ctx->return_state.return_value = val_null();
+    ctx->loop_state.is_breaking = 0;
+    ctx->loop_state.is_continuing = 0;
+    ctx->exception_state.is_throwing = 0;
+    ctx->exception_state.exception_value = val_null();
+    ctx->call_stack.count = 0;
+}
+
+// Call the handler with the request. Further parameters take their default,
+// or null.
+// Returns the handler's result (owned by the caller); *failed is set when
+// it threw.
+static Value httpd_call_handler(Function *handler, Value req, ExecutionContext *ctx, int *failed) {
+    Value result = call_function_value(val_function(handler), &req, 1, ctx);
+    value_retain(result);
+    *failed = ctx->exception_state.is_throwing;
+    if (*failed) {
+        char *msg = value_to_string(ctx->exception_state.exception_value);
+        fprintf(stderr, "Warning: Exception in HTTP handler: %s\n", msg);
+        free(msg);
+        value_release(result);
+        result = val_null();
+    }
+    httpd_reset_ctx(ctx);
+    return result;
+}
+
+// Serve one request on a worker; 0 has the core answer 500
+static int httpd_serve_request(void *data, void *worker, HttpdConn *c) {
+    Value req = httpd_request_value(c);
+    int failed = 0;
+    Value result = httpd_call_handler((Function*)data, req, (ExecutionContext*)worker, &failed);
+    if (!failed && !httpd_render_response(c, result)) {
+        fprintf(stderr, "Warning: HTTP handler returned an invalid response\n");
+        failed = 1;
+    }
+    value_release(result);
+    value_release(req);
+    return !failed;
+}
+
+static void* httpd_worker_start(void *data) {
+    (void)data;
+    return exec_context_new();
+}
+
+static void httpd_worker_stop(void *data, void *worker) {
+    (void)data;
+    exec_context_free((ExecutionContext*)worker);
+}
+
+static void httpd_release_handler(void *data) {
+    function_release((Function*)data);
+}
+
+static int64_t httpd_config_int(Value config, const char *name, int64_t fallback) {
+    if (config.type != VAL_OBJECT) {
+        return fallback;
+    }
+    Value *field = httpd_field(config.as.as_object, name);
+    if (!field || !is_integer(*field)) {
+        return fallback;
+    }
+    return value_to_int64(*field);
+}
+
+#endif  // HTTPD_HAVE_EPOLL
+
+// ========== BUILTINS ==========
+
+// __http_server_new(host, port, handler, config) -> server handle
+// config: { workers, max_body, idle_timeout } (missing fields use defaults)
+Value builtin_http_server_new(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 4 || args[0].type != VAL_STRING || !is_integer(args[1]) ||
+        args[2].type != VAL_FUNCTION) {
+        runtime_error(ctx, "http_server_new() expects 4 arguments (host, port, handler, config)");
+        return val_null();
+    }
+#ifdef HTTPD_HAVE_EPOLL
+    int port = value_to_int(args[1]);
+    int64_t workers = httpd_config_int(args[3], "workers", 4);
+    int64_t max_body = httpd_config_int(args[3], "max_body", 8 * 1024 * 1024);
+    int64_t idle_timeout = httpd_config_int(args[3], "idle_timeout", 60);
+    if (port < 0 || port > 65535) {
+        runtime_error(ctx, "http_server_new() port must be between 0 and 65535");
+        return val_null();
+    }
+    if (workers < 1 || workers > 1024) {
+        runtime_error(ctx, "http_server_new() workers must be between 1 and 1024");
+        return val_null();
+    }
+    if (max_body < 0 || idle_timeout < 0) {
+        runtime_error(ctx, "http_server_new() max_body and idle_timeout must not be negative");
+        return val_null();
+    }
+
+    Function *handler = args[2].as.as_function;
+    function_retain(handler);
+    HttpdHandler hooks = { handler, httpd_worker_start, httpd_worker_stop,
+                           httpd_serve_request, httpd_release_handler };
+
+    char err[HTTPD_ERR_LEN];
+    HttpServer *srv = httpd_server_start(args[0].as.as_string->data, port, (int)workers,
+                                         (size_t)max_body, (int)idle_timeout, &hooks, err);
+    if (!srv) {
+        function_release(handler);
+        runtime_error(ctx, "HttpServer: %s", err);
+        return val_null();
+    }
+    return val_ptr(srv);
+#else
+    runtime_error(ctx, "HttpServer requires epoll (Linux only)");
+    return val_null();
+#endif
+}
+
+#ifdef HTTPD_HAVE_EPOLL
+static HttpServer* http_server_get(Value val, const char *fn_name, ExecutionContext *ctx) {
+    if (val.type != VAL_PTR || !val.as.as_ptr) {
+        runtime_error(ctx, "%s() expects an HTTP server handle", fn_name);
+        return NULL;
+    }
+    HttpServer *srv = (HttpServer*)val.as.as_ptr;
+    if (httpd_server_closed(srv)) {
+        runtime_error(ctx, "%s() called on closed HTTP server", fn_name);
+        return NULL;
+    }
+    return srv;
+}
+#endif
+
+// __http_server_port(server) -> i32 (the bound port, useful with port 0)
+Value builtin_http_server_port(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "http_server_port() expects 1 argument (server)");
+        return val_null();
+    }
+#ifdef HTTPD_HAVE_EPOLL
+    HttpServer *srv = http_server_get(args[0], "http_server_port", ctx);
+    if (!srv) {
+        return val_null();
+    }
+    return val_i32(httpd_server_port(srv));
+#else
+    runtime_error(ctx, "HttpServer requires epoll (Linux only)");
+    return val_null();
+#endif
+}
+
+// __http_server_stats(server) -> { connections, active, requests }
+Value builtin_http_server_stats(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "http_server_stats() expects 1 argument (server)");
+        return val_null();
+    }
+#ifdef HTTPD_HAVE_EPOLL
+    HttpServer *srv = http_server_get(args[0], "http_server_stats", ctx);
+    if (!srv) {
+        return val_null();
+    }
+    long connections, requests;
+    int active;
+    httpd_server_stats(srv, &connections, &active, &requests);
+    Object *obj = object_new(NULL, 3);
+    httpd_object_add(obj, "connections", val_i64(connections));
+    httpd_object_add(obj, "active", val_i32(active));
+    httpd_object_add(obj, "requests", val_i64(requests));
+    return val_object(obj);
+#else
+    runtime_error(ctx, "HttpServer requires epoll (Linux only)");
+    return val_null();
+#endif
+}
+
+// __http_server_close(server): stop accepting, finish requests in progress
+// and close every connection
+Value builtin_http_server_close(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "http_server_close() expects 1 argument (server)");
+        return val_null();
+    }
+#ifdef HTTPD_HAVE_EPOLL
+    HttpServer *srv = http_server_get(args[0], "http_server_close", ctx);
+    if (!srv) {
+        return val_null();
+    }
+    if (httpd_server_is_current(srv)) {
+        runtime_error(ctx, "HttpServer cannot be closed from its own handler");
+        return val_null();
+    }
+    httpd_server_close(srv);
+    return val_null();
+#else
+    runtime_error(ctx, "HttpServer requires epoll (Linux only)");
+    return val_null();
+#endif
+}
@@ -55,6 +55,7 @@ Value builtin_realloc(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_typeof(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_assert(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_panic(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_snapshot_point(Value *args, int num_args, ExecutionContext *ctx);
 
 // Math builtins (math.c)
 Value builtin_sin(Value *args, int num_args, ExecutionContext *ctx);
@@ -163,6 +164,37 @@ void socket_free(SocketHandle *sock);
 Value get_socket_property(SocketHandle *sock, const char *property, ExecutionContext *ctx);
 Value call_socket_method(SocketHandle *sock, const char *method, Value *args, int num_args, ExecutionContext *ctx);
 
+// Event loop builtins (event_loop.c)
+Value builtin_evloop_new(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_evloop_backend(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_evloop_register(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_evloop_modify(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_evloop_unregister(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_evloop_watch_channel(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_evloop_add_timer(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_evloop_cancel_timer(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_evloop_run_once(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_evloop_run(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_evloop_stop(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_evloop_free(Value *args, int num_args, ExecutionContext *ctx);
+
+// I/O ring builtins (io_ring.c)
+Value builtin_io_ring_new(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_io_ring_backend(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_io_ring_read_file(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_io_ring_write_file(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_io_ring_copy_file(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_io_ring_read(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_io_ring_write(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_io_ring_recv(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_io_ring_send(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_io_ring_accept(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_io_ring_submit(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_io_ring_wait(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_io_ring_reap(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_io_ring_pending(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_io_ring_free(Value *args, int num_args, ExecutionContext *ctx);
+
 // libwebsockets builtins (websockets.c)
 // HTTP builtins
 Value builtin_lws_http_get(Value *args, int num_args, ExecutionContext *ctx);
@@ -194,6 +226,80 @@ Value builtin_gzip_decompress(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_zlib_compress_bound(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_crc32(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_adler32(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_deflate_new(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_inflate_new(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_zstream_update(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_zstream_flush(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_zstream_finish(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_zstream_done(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_zstream_free(Value *args, int num_args, ExecutionContext *ctx);
+
+// Hash builtins (hash.c)
+Value builtin_hasher_new(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_hasher_update(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_hasher_update_file(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_hasher_digest(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_hasher_hex_digest(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_hasher_value(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_hasher_reset(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_hasher_free(Value *args, int num_args, ExecutionContext *ctx);
+
+// Regex builtins (regex.c)
+Value builtin_regex_new(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_regex_free(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_regex_test(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_regex_find(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_regex_find_all(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_regex_captures(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_regex_replace(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_regex_split(Value *args, int num_args, ExecutionContext *ctx);
+
+// HTTP client builtins (http_client.c)
+Value builtin_http_client_new(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_http_client_free(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_http_client_stats(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_http_request(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_http_response_status(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_http_response_headers(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_http_response_read(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_http_response_body(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_http_response_close(Value *args, int num_args, ExecutionContext *ctx);
+
+// HTTP server builtins (http_server.c)
+Value builtin_http_server_new(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_http_server_port(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_http_server_stats(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_http_server_close(Value *args, int num_args, ExecutionContext *ctx);
+
+// Log sink builtins (log_sink.c)
+Value builtin_log_sink_open(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_log_sink_write(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_log_sink_flush(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_log_sink_stats(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_log_sink_close(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_log_timestamp(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_log_json(Value *args, int num_args, ExecutionContext *ctx);
+
+// Subprocess builtins (subprocess.c)
+Value builtin_process_spawn(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_process_pid(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_process_read(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_process_read_line(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_process_write(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_process_close_stdin(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_process_poll(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_process_wait(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_process_kill(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_process_communicate(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_process_close(Value *args, int num_args, ExecutionContext *ctx);
+
+// Encoding builtins
+Value builtin_base64_encode(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_base64_decode(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_hex_encode(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_hex_decode(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_url_encode(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_url_decode(Value *args, int num_args, ExecutionContext *ctx);
 
 // OS information builtins (os.c)
 Value builtin_platform(Value *args, int num_args, ExecutionContext *ctx);
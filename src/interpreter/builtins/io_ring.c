@@ -0,0 +1,1336 @@
+#define _DEFAULT_SOURCE  // For syscall()
+
+#include "internal.h"
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <sys/mman.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>) && __has_include(<sys/syscall.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(IORING_FEAT_EXT_ARG)
+#define IORING_HAVE_URING 1
+#endif
+#endif
+#endif
+
+// ========== I/O RING ==========
+//
+// Batched submission of file and socket I/O. Operations are staged with the
+// __io_ring_* builtins, pushed to the kernel in one go by __io_ring_submit,
+// and their completions are reaped later by id (futures) or in bulk.
+//
+// Two backends share the same op table:
+//   - io_uring: ops become SQEs in a shared submission queue; one
+//     io_uring_enter() submits the whole batch. Detected at ring creation.
+//   - threads:  a small pool of native worker threads runs the blocking
+//     syscalls. Used when io_uring is unavailable (old kernel, seccomp) or
+//     when HEMLOCK_IO_BACKEND=threads is set.
+//
+// Result values are built on the thread that claims a completion, so worker
+// threads never touch Hemlock values.
+
+#define IO_RING_DEFAULT_ENTRIES 256
+#define IO_RING_MAX_ENTRIES 4096
+#define IO_RING_WORKERS 4
+#define IO_RING_HASH_BUCKETS 1024
+#define IO_RING_GROW_CHUNK 4096
+
+typedef enum {
+    IO_OP_READ_FILE,    // Whole-file read into a string (or copy source)
+    IO_OP_WRITE_FILE,   // Whole-file write (truncate or append)
+    IO_OP_READ,         // read() from a descriptor into a buffer
+    IO_OP_WRITE,        // write() from a string/buffer
+    IO_OP_RECV,         // recv() from a socket
+    IO_OP_SEND,         // send() on a socket
+    IO_OP_ACCEPT,       // accept() on a listening socket
+} IoOpKind;
+
+typedef enum {
+    IO_OP_STAGED,       // Waiting for __io_ring_submit
+    IO_OP_PENDING,      // Handed to the kernel / worker pool
+    IO_OP_DONE,         // Completed, not yet claimed
+} IoOpState;
+
+typedef struct IoOp {
+    int id;
+    IoOpKind kind;
+    IoOpState state;
+    int fd;
+    int owns_fd;            // read_file/write_file open their own descriptor
+    int open_failed;        // res is the errno of open(), not of the transfer
+    char *path;             // For error messages (file ops only)
+    char *copy_dst;         // Copy: destination written once the read finishes
+    char *buf;
+    size_t len;             // Bytes requested (capacity of buf for reads)
+    size_t done;            // Bytes transferred so far
+    int64_t offset;         // File offset of buf[0]; -1 for streams/current position
+    int grow;               // Read until EOF, growing buf (size unknown up front)
+    int res;                // Final result: >= 0 on success, -errno on failure
+    struct sockaddr_storage addr;
+    socklen_t addrlen;
+    Value target;           // Socket/file kept alive while the op is in flight
+    struct IoOp *hash_next;
+    struct IoOp *queue_next;
+} IoOp;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t done_cond;   // Broadcast whenever an op completes
+    IoOp *buckets[IO_RING_HASH_BUCKETS];  // All unclaimed ops, keyed by id
+    int next_id;
+    int num_inflight;           // Ops handed to the backend and not yet done
+    int num_done;               // Completed ops not yet claimed
+    IoOp *staged_head;          // Ops waiting for submit (FIFO)
+    IoOp *staged_tail;
+    int num_staged;
+    int use_uring;
+    int closed;
+
+#ifdef IORING_HAVE_URING
+    int ring_fd;
+    unsigned sq_entries;
+    unsigned cq_entries;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_map;
+    size_t sq_map_size;
+    void *cq_map;
+    size_t cq_map_size;
+    size_t sqes_size;
+    unsigned sq_unsubmitted;    // SQEs written but not yet passed to io_uring_enter
+    int reaping;                // A thread is blocked in io_uring_enter
+#endif
+
+    // Thread backend
+    pthread_t workers[IO_RING_WORKERS];
+    int num_workers;
+    pthread_cond_t work_cond;
+    IoOp *work_head;
+    IoOp *work_tail;
+} IoRing;
+
+// ========== RUNTIME ERROR HELPER ==========
+
+static Value throw_runtime_error(ExecutionContext *ctx, const char *format, ...) {
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    ctx->exception_state.exception_value = val_string(buffer);
+    value_retain(ctx->exception_state.exception_value);
+    ctx->exception_state.is_throwing = 1;
+    return val_null();
+}
+
+// ========== HELPERS ==========
+
+static IoRing* io_get_ring(Value val, const char *fn_name, ExecutionContext *ctx) {
+    if (val.type != VAL_PTR || val.as.as_ptr == NULL) {
+        throw_runtime_error(ctx, "%s() expects an I/O ring handle", fn_name);
+        return NULL;
+    }
+    IoRing *ring = (IoRing*)val.as.as_ptr;
+    if (ring->closed) {
+        throw_runtime_error(ctx, "%s() called on closed I/O ring", fn_name);
+        return NULL;
+    }
+    return ring;
+}
+
+static int io_fd_from_value(Value val) {
+    if (val.type == VAL_SOCKET) {
+        return val.as.as_socket->closed ? -1 : val.as.as_socket->fd;
+    }
+    if (val.type == VAL_FILE) {
+        return val.as.as_file->closed ? -1 : fileno(val.as.as_file->fp);
+    }
+    if (is_integer(val)) {
+        return value_to_int(val);
+    }
+    return -1;
+}
+
+static char* io_cstring(String *s) {
+    char *out = malloc(s->length + 1);
+    if (!out) return NULL;
+    memcpy(out, s->data, s->length);
+    out[s->length] = '\0';
+    return out;
+}
+
+// Copy string/buffer contents into a private allocation owned by the op
+static int io_copy_payload(Value val, char **out, size_t *out_len) {
+    const void *data;
+    size_t len;
+    if (val.type == VAL_STRING) {
+        data = val.as.as_string->data;
+        len = val.as.as_string->length;
+    } else if (val.type == VAL_BUFFER) {
+        data = val.as.as_buffer->data;
+        len = val.as.as_buffer->length;
+    } else {
+        return -1;
+    }
+    *out = malloc(len > 0 ? len : 1);
+    if (!*out) return -1;
+    if (len > 0) memcpy(*out, data, len);
+    *out_len = len;
+    return 0;
+}
+
+static int64_t io_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void io_deadline(struct timespec *ts, int timeout_ms) {
+    clock_gettime(CLOCK_REALTIME, ts);
+    ts->tv_sec += timeout_ms / 1000;
+    ts->tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+// ========== OP TABLE ==========
+
+static void io_table_insert(IoRing *ring, IoOp *op) {
+    unsigned b = (unsigned)op->id & (IO_RING_HASH_BUCKETS - 1);
+    op->hash_next = ring->buckets[b];
+    ring->buckets[b] = op;
+}
+
+static IoOp* io_table_find(IoRing *ring, int id) {
+    IoOp *op = ring->buckets[(unsigned)id & (IO_RING_HASH_BUCKETS - 1)];
+    while (op && op->id != id) op = op->hash_next;
+    return op;
+}
+
+static void io_table_remove(IoRing *ring, IoOp *op) {
+    IoOp **link = &ring->buckets[(unsigned)op->id & (IO_RING_HASH_BUCKETS - 1)];
+    while (*link && *link != op) link = &(*link)->hash_next;
+    if (*link) *link = op->hash_next;
+}
+
+static void io_op_free(IoOp *op) {
+    if (op->owns_fd && op->fd >= 0) close(op->fd);
+    if (op->target.type != VAL_NULL) value_release(op->target);
+    free(op->path);
+    free(op->copy_dst);
+    free(op->buf);
+    free(op);
+}
+
+static IoOp* io_op_new(IoOpKind kind) {
+    IoOp *op = calloc(1, sizeof(IoOp));
+    if (!op) return NULL;
+    op->kind = kind;
+    op->fd = -1;
+    op->offset = -1;
+    op->target = val_null();
+    return op;
+}
+
+// Stage an op for the next submit. Ops that already failed (e.g. open())
+// go straight to the done table so the error surfaces on reap.
+static int io_stage(IoRing *ring, IoOp *op) {
+    pthread_mutex_lock(&ring->lock);
+    op->id = ring->next_id++;
+    if (ring->next_id <= 0) ring->next_id = 1;
+    io_table_insert(ring, op);
+    if (op->state == IO_OP_DONE) {
+        ring->num_done++;
+    } else {
+        op->state = IO_OP_STAGED;
+        op->queue_next = NULL;
+        if (ring->staged_tail) ring->staged_tail->queue_next = op;
+        else ring->staged_head = op;
+        ring->staged_tail = op;
+        ring->num_staged++;
+    }
+    int id = op->id;
+    pthread_mutex_unlock(&ring->lock);
+    return id;
+}
+
+// Turn a finished copy-source read into the destination write.
+// Returns 1 if the op is already complete, 0 to submit the write.
+static int io_op_start_copy_write(IoOp *op) {
+    close(op->fd);
+    op->fd = open(op->copy_dst, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    free(op->path);
+    op->path = op->copy_dst;
+    op->copy_dst = NULL;
+    if (op->fd < 0) {
+        op->res = -errno;
+        op->open_failed = 1;
+        return 1;
+    }
+    op->kind = IO_OP_WRITE_FILE;
+    op->len = op->done;
+    op->done = 0;
+    if (op->len == 0) {
+        op->res = 0;
+        return 1;
+    }
+    return 0;
+}
+
+// Account for a finished transfer. Returns 1 if the op is complete, 0 if
+// the remainder must be resubmitted (short read/write or growing read).
+static int io_op_progress(IoOp *op, int res) {
+    if (res < 0) {
+        op->res = res;
+        return 1;
+    }
+    switch (op->kind) {
+        case IO_OP_READ_FILE:
+            op->done += (size_t)res;
+            if (res > 0 && op->done < op->len) return 0;
+            if (res > 0 && op->grow) {
+                char *grown = realloc(op->buf, op->len * 2 + 1);
+                if (!grown) {
+                    op->res = -ENOMEM;
+                    return 1;
+                }
+                op->buf = grown;
+                op->len *= 2;
+                return 0;
+            }
+            if (op->copy_dst) return io_op_start_copy_write(op);
+            break;
+        case IO_OP_WRITE_FILE:
+            op->done += (size_t)res;
+            if (res > 0 && op->done < op->len) return 0;
+            break;
+        case IO_OP_ACCEPT:
+            op->res = res;
+            return 1;
+        default:
+            op->done = (size_t)res;
+            break;
+    }
+    op->res = (int)(op->done > INT32_MAX ? INT32_MAX : op->done);
+    return 1;
+}
+
+static void io_op_finish(IoRing *ring, IoOp *op) {
+    if (op->owns_fd && op->fd >= 0) {
+        close(op->fd);
+        op->fd = -1;
+    }
+    op->state = IO_OP_DONE;
+    ring->num_inflight--;
+    ring->num_done++;
+}
+
+// ========== THREAD BACKEND ==========
+
+// Run one transfer with blocking syscalls; mirrors the io_uring opcodes
+static int io_run_blocking(IoOp *op) {
+    ssize_t n;
+    switch (op->kind) {
+        case IO_OP_READ_FILE:
+            n = pread(op->fd, op->buf + op->done, op->len - op->done, (off_t)op->done);
+            break;
+        case IO_OP_WRITE_FILE:
+            n = write(op->fd, op->buf + op->done, op->len - op->done);
+            break;
+        case IO_OP_READ:
+            n = op->offset >= 0 ? pread(op->fd, op->buf, op->len, (off_t)op->offset)
+                                : read(op->fd, op->buf, op->len);
+            break;
+        case IO_OP_WRITE:
+            n = op->offset >= 0 ? pwrite(op->fd, op->buf, op->len, (off_t)op->offset)
+                                : write(op->fd, op->buf, op->len);
+            break;
+        case IO_OP_RECV:
+            n = recv(op->fd, op->buf, op->len, 0);
+            break;
+        case IO_OP_SEND:
+            n = send(op->fd, op->buf, op->len, MSG_NOSIGNAL);
+            break;
+        case IO_OP_ACCEPT:
+            op->addrlen = sizeof(op->addr);
+            n = accept(op->fd, (struct sockaddr*)&op->addr, &op->addrlen);
+            break;
+        default:
+            return -EINVAL;
+    }
+    return n < 0 ? -errno : (int)n;
+}
+
+static void* io_worker_main(void *arg) {
+    IoRing *ring = (IoRing*)arg;
+    pthread_mutex_lock(&ring->lock);
+    for (;;) {
+        while (!ring->work_head && !ring->closed) {
+            pthread_cond_wait(&ring->work_cond, &ring->lock);
+        }
+        if (!ring->work_head) break;
+
+        IoOp *op = ring->work_head;
+        ring->work_head = op->queue_next;
+        if (!ring->work_head) ring->work_tail = NULL;
+        pthread_mutex_unlock(&ring->lock);
+
+        int complete;
+        do {
+            complete = io_op_progress(op, io_run_blocking(op));
+        } while (!complete);
+
+        pthread_mutex_lock(&ring->lock);
+        io_op_finish(ring, op);
+        pthread_cond_broadcast(&ring->done_cond);
+    }
+    pthread_mutex_unlock(&ring->lock);
+    return NULL;
+}
+
+// ========== IO_URING BACKEND ==========
+
+#ifdef IORING_HAVE_URING
+
+static int io_uring_setup_sys(unsigned entries, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int io_uring_enter_sys(int fd, unsigned to_submit, unsigned min_complete,
+                              unsigned flags, void *arg, size_t argsz) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz);
+}
+
+// Map the submission/completion rings. Returns 0 on success, -1 if io_uring
+// is unusable here (the caller falls back to the thread backend).
+static int io_uring_init(IoRing *ring, unsigned entries) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+
+    int fd = io_uring_setup_sys(entries, &p);
+    if (fd < 0) return -1;
+
+    // Timed waits rely on IORING_ENTER_EXT_ARG (Linux 5.11+)
+    if (!(p.features & IORING_FEAT_EXT_ARG) || !(p.features & IORING_FEAT_NODROP)) {
+        close(fd);
+        return -1;
+    }
+
+    ring->sq_map_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    ring->cq_map_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_map_size > ring->sq_map_size) ring->sq_map_size = ring->cq_map_size;
+        ring->cq_map_size = ring->sq_map_size;
+    }
+
+    ring->sq_map = mmap(NULL, ring->sq_map_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (ring->sq_map == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_map = ring->sq_map;
+    } else {
+        ring->cq_map = mmap(NULL, ring->cq_map_size, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (ring->cq_map == MAP_FAILED) {
+            munmap(ring->sq_map, ring->sq_map_size);
+            close(fd);
+            return -1;
+        }
+    }
+
+    ring->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        if (ring->cq_map != ring->sq_map) munmap(ring->cq_map, ring->cq_map_size);
+        munmap(ring->sq_map, ring->sq_map_size);
+        close(fd);
+        return -1;
+    }
+
+    char *sq = (char*)ring->sq_map;
+    char *cq = (char*)ring->cq_map;
+    ring->sq_head = (unsigned*)(sq + p.sq_off.head);
+    ring->sq_tail = (unsigned*)(sq + p.sq_off.tail);
+    ring->sq_mask = (unsigned*)(sq + p.sq_off.ring_mask);
+    ring->sq_array = (unsigned*)(sq + p.sq_off.array);
+    ring->cq_head = (unsigned*)(cq + p.cq_off.head);
+    ring->cq_tail = (unsigned*)(cq + p.cq_off.tail);
+    ring->cq_mask = (unsigned*)(cq + p.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+    ring->sq_entries = p.sq_entries;
+    ring->cq_entries = p.cq_entries;
+    ring->ring_fd = fd;
+    return 0;
+}
+
+static void io_uring_teardown(IoRing *ring) {
+    munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_map != ring->sq_map) munmap(ring->cq_map, ring->cq_map_size);
+    munmap(ring->sq_map, ring->sq_map_size);
+    close(ring->ring_fd);
+    ring->ring_fd = -1;
+}
+
+// Push written SQEs to the kernel. Called with ring->lock held.
+static int io_uring_flush(IoRing *ring) {
+    while (ring->sq_unsubmitted > 0) {
+        int n = io_uring_enter_sys(ring->ring_fd, ring->sq_unsubmitted, 0, 0, NULL, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -errno;
+        }
+        ring->sq_unsubmitted -= (unsigned)n;
+        if (n == 0) break;
+    }
+    return 0;
+}
+
+static void io_uring_reap_locked(IoRing *ring);
+
+// Fill an SQE for the op's next transfer. Called with ring->lock held.
+static int io_uring_queue(IoRing *ring, IoOp *op) {
+    unsigned tail = *ring->sq_tail;
+    unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    if (tail - head >= ring->sq_entries) {
+        int err = io_uring_flush(ring);
+        if (err < 0) return err;
+        head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+        if (tail - head >= ring->sq_entries) return -EBUSY;
+    }
+
+    unsigned index = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->fd = op->fd;
+    sqe->user_data = (uint64_t)(uintptr_t)op;
+
+    switch (op->kind) {
+        case IO_OP_READ_FILE:
+            sqe->opcode = IORING_OP_READ;
+            sqe->addr = (uint64_t)(uintptr_t)(op->buf + op->done);
+            sqe->len = (unsigned)(op->len - op->done);
+            sqe->off = (uint64_t)op->done;
+            break;
+        case IO_OP_WRITE_FILE:
+            sqe->opcode = IORING_OP_WRITE;
+            sqe->addr = (uint64_t)(uintptr_t)(op->buf + op->done);
+            sqe->len = (unsigned)(op->len - op->done);
+            sqe->off = (uint64_t)-1;  // Current position (O_APPEND honoured)
+            break;
+        case IO_OP_READ:
+        case IO_OP_WRITE:
+            sqe->opcode = op->kind == IO_OP_READ ? IORING_OP_READ : IORING_OP_WRITE;
+            sqe->addr = (uint64_t)(uintptr_t)op->buf;
+            sqe->len = (unsigned)op->len;
+            sqe->off = (uint64_t)op->offset;
+            break;
+        case IO_OP_RECV:
+            sqe->opcode = IORING_OP_RECV;
+            sqe->addr = (uint64_t)(uintptr_t)op->buf;
+            sqe->len = (unsigned)op->len;
+            break;
+        case IO_OP_SEND:
+            sqe->opcode = IORING_OP_SEND;
+            sqe->addr = (uint64_t)(uintptr_t)op->buf;
+            sqe->len = (unsigned)op->len;
+            sqe->msg_flags = MSG_NOSIGNAL;
+            break;
+        case IO_OP_ACCEPT:
+            op->addrlen = sizeof(op->addr);
+            sqe->opcode = IORING_OP_ACCEPT;
+            sqe->addr = (uint64_t)(uintptr_t)&op->addr;
+            sqe->addr2 = (uint64_t)(uintptr_t)&op->addrlen;
+            break;
+    }
+
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring->sq_unsubmitted++;
+    return 0;
+}
+
+// Drain the completion queue. Called with ring->lock held.
+static void io_uring_reap_locked(IoRing *ring) {
+    unsigned head = *ring->cq_head;
+    unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    int resubmit = 0;
+    int completed = 0;
+
+    while (head != tail) {
+        struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+        IoOp *op = (IoOp*)(uintptr_t)cqe->user_data;
+        int res = cqe->res;
+        head++;
+
+        if (op && !io_op_progress(op, res)) {
+            // Short transfer: queue the remainder under the same op
+            int err = io_uring_queue(ring, op);
+            if (err == 0) {
+                resubmit = 1;
+                continue;
+            }
+            op->res = err;
+        }
+        if (op) {
+            io_op_finish(ring, op);
+            completed = 1;
+        }
+    }
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+
+    if (resubmit) io_uring_flush(ring);
+    if (completed) pthread_cond_broadcast(&ring->done_cond);
+}
+
+// Block in io_uring_enter until at least one completion or the timeout.
+// Called with ring->lock held; the lock is dropped while waiting so other
+// threads can keep staging and submitting.
+static void io_uring_wait_locked(IoRing *ring, int timeout_ms) {
+    ring->reaping = 1;
+    pthread_mutex_unlock(&ring->lock);
+
+    struct __kernel_timespec ts;
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    if (timeout_ms >= 0) {
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (long long)(timeout_ms % 1000) * 1000000LL;
+        arg.ts = (uint64_t)(uintptr_t)&ts;
+    }
+    io_uring_enter_sys(ring->ring_fd, 0, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                       &arg, sizeof(arg));
+
+    pthread_mutex_lock(&ring->lock);
+    ring->reaping = 0;
+    io_uring_reap_locked(ring);
+    // Wake threads that waited on done_cond while we held the reaper role
+    pthread_cond_broadcast(&ring->done_cond);
+}
+
+#endif  // IORING_HAVE_URING
+
+// ========== SUBMIT / WAIT ==========
+
+// Hand all staged ops to the backend. Called with ring->lock held.
+static int io_submit_locked(IoRing *ring) {
+    int submitted = 0;
+    while (ring->staged_head) {
+        IoOp *op = ring->staged_head;
+        ring->staged_head = op->queue_next;
+        if (!ring->staged_head) ring->staged_tail = NULL;
+        ring->num_staged--;
+        op->queue_next = NULL;
+        op->state = IO_OP_PENDING;
+        ring->num_inflight++;
+        submitted++;
+
+#ifdef IORING_HAVE_URING
+        if (ring->use_uring) {
+            // CQ overflow is safe: IORING_FEAT_NODROP is required at setup
+            int err = io_uring_queue(ring, op);
+            if (err < 0) {
+                op->res = err;
+                io_op_finish(ring, op);
+            }
+            continue;
+        }
+#endif
+        if (ring->work_tail) ring->work_tail->queue_next = op;
+        else ring->work_head = op;
+        ring->work_tail = op;
+    }
+
+#ifdef IORING_HAVE_URING
+    if (ring->use_uring) {
+        io_uring_flush(ring);
+        return submitted;
+    }
+#endif
+    if (submitted > 0) pthread_cond_broadcast(&ring->work_cond);
+    return submitted;
+}
+
+// Wait until `op` (or, with op == NULL, any op) completes or the timeout
+// expires. Staged ops are submitted first. Called with ring->lock held.
+static void io_wait_locked(IoRing *ring, IoOp *op, int timeout_ms) {
+    if (ring->num_staged > 0) io_submit_locked(ring);
+
+    int64_t deadline = timeout_ms >= 0 ? io_now_ms() + timeout_ms : -1;
+    for (;;) {
+        if (op ? op->state == IO_OP_DONE : ring->num_done > 0) return;
+        if (ring->num_inflight == 0) return;
+
+        int remaining = -1;
+        if (deadline >= 0) {
+            int64_t left = deadline - io_now_ms();
+            if (left <= 0) return;
+            remaining = (int)left;
+        }
+
+#ifdef IORING_HAVE_URING
+        if (ring->use_uring) {
+            io_uring_reap_locked(ring);
+            if (op ? op->state == IO_OP_DONE : ring->num_done > 0) return;
+            if (!ring->reaping) {
+                io_uring_wait_locked(ring, remaining);
+                continue;
+            }
+            // Another thread is in io_uring_enter; it broadcasts on reap
+        }
+#endif
+        if (remaining >= 0) {
+            struct timespec ts;
+            io_deadline(&ts, remaining);
+            pthread_cond_timedwait(&ring->done_cond, &ring->lock, &ts);
+        } else {
+            pthread_cond_wait(&ring->done_cond, &ring->lock);
+        }
+    }
+}
+
+// ========== COMPLETION VALUES ==========
+
+static Value io_empty_buffer(void) {
+    Buffer *buf = malloc(sizeof(Buffer));
+    buf->data = malloc(1);
+    buf->length = 0;
+    buf->capacity = 0;
+    buf->ref_count = 1;
+    return (Value){ .type = VAL_BUFFER, .as.as_buffer = buf };
+}
+
+static Value io_accepted_socket(IoOp *op) {
+    SocketHandle *listener = op->target.type == VAL_SOCKET ? op->target.as.as_socket : NULL;
+    SocketHandle *client = malloc(sizeof(SocketHandle));
+    if (!client) {
+        close(op->res);
+        return val_null();
+    }
+    client->fd = op->res;
+    client->domain = listener ? listener->domain : op->addr.ss_family;
+    client->type = listener ? listener->type : SOCK_STREAM;
+    client->closed = 0;
+    client->listening = 0;
+    client->nonblocking = 0;
+
+    if (op->addr.ss_family == AF_INET6) {
+        struct sockaddr_in6 *addr6 = (struct sockaddr_in6 *)&op->addr;
+        char addr_str[INET6_ADDRSTRLEN];
+        inet_ntop(AF_INET6, &addr6->sin6_addr, addr_str, sizeof(addr_str));
+        client->address = strdup(addr_str);
+        client->port = ntohs(addr6->sin6_port);
+    } else {
+        struct sockaddr_in *addr4 = (struct sockaddr_in *)&op->addr;
+        char addr_str[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &addr4->sin_addr, addr_str, sizeof(addr_str));
+        client->address = strdup(addr_str);
+        client->port = ntohs(addr4->sin_port);
+    }
+    return val_socket(client);
+}
+
+static const char* io_op_verb(IoOpKind kind) {
+    switch (kind) {
+        case IO_OP_READ_FILE: return "read";
+        case IO_OP_WRITE_FILE: return "write";
+        case IO_OP_READ: return "read";
+        case IO_OP_WRITE: return "write";
+        case IO_OP_RECV: return "receive data";
+        case IO_OP_SEND: return "send data";
+        case IO_OP_ACCEPT: return "accept connection";
+    }
+    return "perform I/O";
+}
+
+// Build {id, ok, value, error} for a completed op and free it.
+// Called without ring->lock; the op is already out of the table.
+static Value io_completion_value(IoOp *op) {
+    Value value = val_null();
+    Value error = val_null();
+    int ok = op->res >= 0;
+
+    if (!ok) {
+        char msg[512];
+        if (op->path) {
+            snprintf(msg, sizeof(msg), "Failed to %s '%s': %s",
+                     op->open_failed ? "open" : io_op_verb(op->kind), op->path, strerror(-op->res));
+        } else {
+            snprintf(msg, sizeof(msg), "Failed to %s: %s",
+                     io_op_verb(op->kind), strerror(-op->res));
+        }
+        error = val_string(msg);
+    } else {
+        switch (op->kind) {
+            case IO_OP_READ_FILE: {
+                char *data = op->buf;
+                op->buf = NULL;
+                data[op->done] = '\0';
+                value = val_string_take(data, (int)op->done, (int)op->len + 1);
+                break;
+            }
+            case IO_OP_READ:
+            case IO_OP_RECV:
+                if (op->done == 0) {
+                    value = io_empty_buffer();
+                } else {
+                    Buffer *buf = malloc(sizeof(Buffer));
+                    buf->data = op->buf;
+                    buf->length = (int)op->done;
+                    buf->capacity = (int)op->len;
+                    buf->ref_count = 1;
+                    op->buf = NULL;
+                    value = (Value){ .type = VAL_BUFFER, .as.as_buffer = buf };
+                }
+                break;
+            case IO_OP_ACCEPT:
+                value = io_accepted_socket(op);
+                break;
+            default:
+                value = val_i32(op->res);
+                break;
+        }
+    }
+
+    Object *obj = object_new(NULL, 4);
+    char *field_names[] = {"id", "ok", "value", "error"};
+    Value field_values[] = { val_i32(op->id), val_bool(ok), value, error };
+    for (int i = 0; i < 4; i++) {
+        obj->field_names[i] = strdup(field_names[i]);
+        obj->field_values[i] = field_values[i];
+        obj->num_fields++;
+    }
+
+    io_op_free(op);
+    return val_object(obj);
+}
+
+// ========== RING LIFECYCLE ==========
+
+// Free every op that is not owned by the kernel or a worker thread.
+// Called with ring->lock held.
+static void io_discard_ops_locked(IoRing *ring) {
+    for (int b = 0; b < IO_RING_HASH_BUCKETS; b++) {
+        IoOp **link = &ring->buckets[b];
+        while (*link) {
+            IoOp *op = *link;
+            if (op->state != IO_OP_PENDING) {
+                *link = op->hash_next;
+                io_op_free(op);
+            } else {
+                link = &op->hash_next;
+            }
+        }
+    }
+    ring->staged_head = NULL;
+    ring->staged_tail = NULL;
+    ring->num_staged = 0;
+    ring->num_done = 0;
+}
+
+static int io_uring_disabled_by_env(void) {
+    const char *env = getenv("HEMLOCK_IO_BACKEND");
+    return env && strcmp(env, "threads") == 0;
+}
+
+// __io_ring_new(entries?) -> ptr
+Value builtin_io_ring_new(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args > 1) {
+        return throw_runtime_error(ctx, "__io_ring_new() expects 0-1 arguments (entries)");
+    }
+    int entries = IO_RING_DEFAULT_ENTRIES;
+    if (num_args == 1 && args[0].type != VAL_NULL) {
+        if (!is_integer(args[0])) {
+            return throw_runtime_error(ctx, "__io_ring_new() entries must be an integer");
+        }
+        entries = value_to_int(args[0]);
+        if (entries < 1 || entries > IO_RING_MAX_ENTRIES) {
+            return throw_runtime_error(ctx, "__io_ring_new() entries must be between 1 and %d",
+                                       IO_RING_MAX_ENTRIES);
+        }
+    }
+
+    IoRing *ring = calloc(1, sizeof(IoRing));
+    if (!ring) {
+        return throw_runtime_error(ctx, "__io_ring_new() memory allocation failed");
+    }
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->done_cond, NULL);
+    pthread_cond_init(&ring->work_cond, NULL);
+    ring->next_id = 1;
+
+#ifdef IORING_HAVE_URING
+    ring->ring_fd = -1;
+    if (!io_uring_disabled_by_env() && io_uring_init(ring, (unsigned)entries) == 0) {
+        ring->use_uring = 1;
+        return val_ptr(ring);
+    }
+#else
+    (void)io_uring_disabled_by_env;
+#endif
+
+    for (int i = 0; i < IO_RING_WORKERS; i++) {
+        if (pthread_create(&ring->workers[i], NULL, io_worker_main, ring) != 0) {
+            break;
+        }
+        pthread_detach(ring->workers[i]);
+        ring->num_workers++;
+    }
+    if (ring->num_workers == 0) {
+        pthread_cond_destroy(&ring->done_cond);
+        pthread_cond_destroy(&ring->work_cond);
+        pthread_mutex_destroy(&ring->lock);
+        free(ring);
+        return throw_runtime_error(ctx, "Failed to start I/O worker threads");
+    }
+    return val_ptr(ring);
+}
+
+// __io_ring_backend(ring) -> string ("io_uring" or "threads")
+Value builtin_io_ring_backend(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        return throw_runtime_error(ctx, "__io_ring_backend() expects 1 argument (ring)");
+    }
+    IoRing *ring = io_get_ring(args[0], "__io_ring_backend", ctx);
+    if (!ring) return val_null();
+    return val_string(ring->use_uring ? "io_uring" : "threads");
+}
+
+// ========== STAGING OPS ==========
+
+// Open `path` and size the buffer for a whole-file read. open/fstat are
+// metadata operations and stay synchronous; the data transfer is batched.
+// An open() failure is recorded on the op and reported at completion.
+static IoOp* io_read_file_op_new(String *path, const char *fn_name, ExecutionContext *ctx) {
+    IoOp *op = io_op_new(IO_OP_READ_FILE);
+    if (!op || !(op->path = io_cstring(path))) {
+        free(op);
+        throw_runtime_error(ctx, "%s() memory allocation failed", fn_name);
+        return NULL;
+    }
+    op->owns_fd = 1;
+    op->offset = 0;
+
+    op->fd = open(op->path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (op->fd < 0) {
+        op->res = -errno;
+        op->open_failed = 1;
+        op->state = IO_OP_DONE;
+        return op;
+    }
+    if (fstat(op->fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        op->len = (size_t)st.st_size;
+    } else {
+        op->len = IO_RING_GROW_CHUNK;  // Size unknown (pipe, procfs, empty file)
+        op->grow = 1;
+    }
+
+    op->buf = malloc(op->len + 1);
+    if (!op->buf) {
+        io_op_free(op);
+        throw_runtime_error(ctx, "%s() memory allocation failed", fn_name);
+        return NULL;
+    }
+    return op;
+}
+
+// __io_ring_read_file(ring, path) -> i32 op id; completes with the file contents
+Value builtin_io_ring_read_file(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2) {
+        return throw_runtime_error(ctx, "__io_ring_read_file() expects 2 arguments (ring, path)");
+    }
+    IoRing *ring = io_get_ring(args[0], "__io_ring_read_file", ctx);
+    if (!ring) return val_null();
+    if (args[1].type != VAL_STRING) {
+        return throw_runtime_error(ctx, "__io_ring_read_file() requires a string path");
+    }
+
+    IoOp *op = io_read_file_op_new(args[1].as.as_string, "__io_ring_read_file", ctx);
+    if (!op) return val_null();
+    return val_i32(io_stage(ring, op));
+}
+
+// __io_ring_copy_file(ring, src, dst) -> i32 op id; completes with bytes written
+// The source read and destination write run back to back inside one op
+Value builtin_io_ring_copy_file(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 3) {
+        return throw_runtime_error(ctx, "__io_ring_copy_file() expects 3 arguments (ring, src, dst)");
+    }
+    IoRing *ring = io_get_ring(args[0], "__io_ring_copy_file", ctx);
+    if (!ring) return val_null();
+    if (args[1].type != VAL_STRING || args[2].type != VAL_STRING) {
+        return throw_runtime_error(ctx, "__io_ring_copy_file() requires string paths");
+    }
+
+    IoOp *op = io_read_file_op_new(args[1].as.as_string, "__io_ring_copy_file", ctx);
+    if (!op) return val_null();
+    op->copy_dst = io_cstring(args[2].as.as_string);
+    if (!op->copy_dst) {
+        io_op_free(op);
+        return throw_runtime_error(ctx, "__io_ring_copy_file() memory allocation failed");
+    }
+    return val_i32(io_stage(ring, op));
+}
+
+// __io_ring_write_file(ring, path, content, append) -> i32 op id; completes with bytes written
+Value builtin_io_ring_write_file(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 4) {
+        return throw_runtime_error(ctx, "__io_ring_write_file() expects 4 arguments (ring, path, content, append)");
+    }
+    IoRing *ring = io_get_ring(args[0], "__io_ring_write_file", ctx);
+    if (!ring) return val_null();
+    if (args[1].type != VAL_STRING) {
+        return throw_runtime_error(ctx, "__io_ring_write_file() requires a string path");
+    }
+
+    IoOp *op = io_op_new(IO_OP_WRITE_FILE);
+    if (!op || !(op->path = io_cstring(args[1].as.as_string))) {
+        free(op);
+        return throw_runtime_error(ctx, "__io_ring_write_file() memory allocation failed");
+    }
+    if (io_copy_payload(args[2], &op->buf, &op->len) != 0) {
+        io_op_free(op);
+        return throw_runtime_error(ctx, "__io_ring_write_file() content must be a string or buffer");
+    }
+    op->owns_fd = 1;
+
+    int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (value_is_truthy(args[3]) ? O_APPEND : O_TRUNC);
+    op->fd = open(op->path, flags, 0666);
+    if (op->fd < 0) {
+        op->res = -errno;
+        op->open_failed = 1;
+        op->state = IO_OP_DONE;
+    } else if (op->len == 0) {
+        op->res = 0;
+        close(op->fd);
+        op->fd = -1;
+        op->state = IO_OP_DONE;
+    }
+    return val_i32(io_stage(ring, op));
+}
+
+// Shared argument handling for ops that target an existing descriptor
+static IoOp* io_fd_op_new(IoOpKind kind, Value target, const char *fn_name,
+                            ExecutionContext *ctx) {
+    int fd = io_fd_from_value(target);
+    if (fd < 0) {
+        throw_runtime_error(ctx, "%s() expects an open socket, file, or file descriptor", fn_name);
+        return NULL;
+    }
+    IoOp *op = io_op_new(kind);
+    if (!op) {
+        throw_runtime_error(ctx, "%s() memory allocation failed", fn_name);
+        return NULL;
+    }
+    op->fd = fd;
+    op->target = target;
+    value_retain(target);
+    return op;
+}
+
+static IoOp* io_read_op_new(IoOpKind kind, Value target, Value size,
+                              const char *fn_name, ExecutionContext *ctx) {
+    if (!is_integer(size) || value_to_int(size) < 0) {
+        throw_runtime_error(ctx, "%s() size must be a non-negative integer", fn_name);
+        return NULL;
+    }
+    IoOp *op = io_fd_op_new(kind, target, fn_name, ctx);
+    if (!op) return NULL;
+    op->len = (size_t)value_to_int(size);
+    op->buf = malloc(op->len > 0 ? op->len : 1);
+    if (!op->buf) {
+        io_op_free(op);
+        throw_runtime_error(ctx, "%s() memory allocation failed", fn_name);
+        return NULL;
+    }
+    return op;
+}
+
+static IoOp* io_write_op_new(IoOpKind kind, Value target, Value data,
+                               const char *fn_name, ExecutionContext *ctx) {
+    IoOp *op = io_fd_op_new(kind, target, fn_name, ctx);
+    if (!op) return NULL;
+    if (io_copy_payload(data, &op->buf, &op->len) != 0) {
+        io_op_free(op);
+        throw_runtime_error(ctx, "%s() data must be a string or buffer", fn_name);
+        return NULL;
+    }
+    return op;
+}
+
+static int io_parse_offset(Value val, int64_t *out) {
+    if (val.type == VAL_NULL) {
+        *out = -1;
+        return 0;
+    }
+    if (!is_integer(val)) return -1;
+    *out = value_to_int64(val);
+    if (*out < -1) return -1;
+    return 0;
+}
+
+// __io_ring_read(ring, target, size, offset) -> i32 op id; completes with a buffer
+// offset of -1/null reads from the current file position
+Value builtin_io_ring_read(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 4) {
+        return throw_runtime_error(ctx, "__io_ring_read() expects 4 arguments (ring, target, size, offset)");
+    }
+    IoRing *ring = io_get_ring(args[0], "__io_ring_read", ctx);
+    if (!ring) return val_null();
+    int64_t offset;
+    if (io_parse_offset(args[3], &offset) != 0) {
+        return throw_runtime_error(ctx, "__io_ring_read() offset must be an integer >= -1");
+    }
+    IoOp *op = io_read_op_new(IO_OP_READ, args[1], args[2], "__io_ring_read", ctx);
+    if (!op) return val_null();
+    op->offset = offset;
+    return val_i32(io_stage(ring, op));
+}
+
+// __io_ring_write(ring, target, data, offset) -> i32 op id; completes with bytes written
+Value builtin_io_ring_write(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 4) {
+        return throw_runtime_error(ctx, "__io_ring_write() expects 4 arguments (ring, target, data, offset)");
+    }
+    IoRing *ring = io_get_ring(args[0], "__io_ring_write", ctx);
+    if (!ring) return val_null();
+    int64_t offset;
+    if (io_parse_offset(args[3], &offset) != 0) {
+        return throw_runtime_error(ctx, "__io_ring_write() offset must be an integer >= -1");
+    }
+    IoOp *op = io_write_op_new(IO_OP_WRITE, args[1], args[2], "__io_ring_write", ctx);
+    if (!op) return val_null();
+    op->offset = offset;
+    return val_i32(io_stage(ring, op));
+}
+
+// __io_ring_recv(ring, socket, size) -> i32 op id; completes with a buffer (empty on EOF)
+Value builtin_io_ring_recv(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 3) {
+        return throw_runtime_error(ctx, "__io_ring_recv() expects 3 arguments (ring, socket, size)");
+    }
+    IoRing *ring = io_get_ring(args[0], "__io_ring_recv", ctx);
+    if (!ring) return val_null();
+    if (args[1].type != VAL_SOCKET) {
+        return throw_runtime_error(ctx, "__io_ring_recv() expects a socket");
+    }
+    IoOp *op = io_read_op_new(IO_OP_RECV, args[1], args[2], "__io_ring_recv", ctx);
+    if (!op) return val_null();
+    return val_i32(io_stage(ring, op));
+}
+
+// __io_ring_send(ring, socket, data) -> i32 op id; completes with bytes sent
+Value builtin_io_ring_send(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 3) {
+        return throw_runtime_error(ctx, "__io_ring_send() expects 3 arguments (ring, socket, data)");
+    }
+    IoRing *ring = io_get_ring(args[0], "__io_ring_send", ctx);
+    if (!ring) return val_null();
+    if (args[1].type != VAL_SOCKET) {
+        return throw_runtime_error(ctx, "__io_ring_send() expects a socket");
+    }
+    IoOp *op = io_write_op_new(IO_OP_SEND, args[1], args[2], "__io_ring_send", ctx);
+    if (!op) return val_null();
+    return val_i32(io_stage(ring, op));
+}
+
+// __io_ring_accept(ring, socket) -> i32 op id; completes with the client socket
+Value builtin_io_ring_accept(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2) {
+        return throw_runtime_error(ctx, "__io_ring_accept() expects 2 arguments (ring, socket)");
+    }
+    IoRing *ring = io_get_ring(args[0], "__io_ring_accept", ctx);
+    if (!ring) return val_null();
+    if (args[1].type != VAL_SOCKET || !args[1].as.as_socket->listening) {
+        return throw_runtime_error(ctx, "__io_ring_accept() expects a listening socket");
+    }
+    IoOp *op = io_fd_op_new(IO_OP_ACCEPT, args[1], "__io_ring_accept", ctx);
+    if (!op) return val_null();
+    return val_i32(io_stage(ring, op));
+}
+
+// ========== SUBMIT / REAP ==========
+
+// __io_ring_submit(ring) -> i32 (number of ops handed to the backend)
+Value builtin_io_ring_submit(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        return throw_runtime_error(ctx, "__io_ring_submit() expects 1 argument (ring)");
+    }
+    IoRing *ring = io_get_ring(args[0], "__io_ring_submit", ctx);
+    if (!ring) return val_null();
+    pthread_mutex_lock(&ring->lock);
+    int submitted = io_submit_locked(ring);
+    pthread_mutex_unlock(&ring->lock);
+    return val_i32(submitted);
+}
+
+// __io_ring_wait(ring, id, timeout_ms) -> completion object, or null on timeout
+// timeout_ms < 0 waits forever. Each completion can be claimed once.
+Value builtin_io_ring_wait(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 3) {
+        return throw_runtime_error(ctx, "__io_ring_wait() expects 3 arguments (ring, id, timeout_ms)");
+    }
+    IoRing *ring = io_get_ring(args[0], "__io_ring_wait", ctx);
+    if (!ring) return val_null();
+    if (!is_integer(args[1]) || !is_integer(args[2])) {
+        return throw_runtime_error(ctx, "__io_ring_wait() expects integer id and timeout");
+    }
+    int id = value_to_int(args[1]);
+    int timeout_ms = value_to_int(args[2]);
+
+    pthread_mutex_lock(&ring->lock);
+    IoOp *op = io_table_find(ring, id);
+    if (!op) {
+        pthread_mutex_unlock(&ring->lock);
+        return throw_runtime_error(ctx, "__io_ring_wait(): unknown or already claimed op id %d", id);
+    }
+    io_wait_locked(ring, op, timeout_ms);
+    if (op->state != IO_OP_DONE) {
+        pthread_mutex_unlock(&ring->lock);
+        return val_null();
+    }
+    io_table_remove(ring, op);
+    ring->num_done--;
+    pthread_mutex_unlock(&ring->lock);
+
+    return io_completion_value(op);
+}
+
+// __io_ring_reap(ring, min, timeout_ms) -> array of completion objects
+// Waits for at least `min` completions (bounded by timeout_ms) and returns
+// every unclaimed completion.
+Value builtin_io_ring_reap(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 3) {
+        return throw_runtime_error(ctx, "__io_ring_reap() expects 3 arguments (ring, min, timeout_ms)");
+    }
+    IoRing *ring = io_get_ring(args[0], "__io_ring_reap", ctx);
+    if (!ring) return val_null();
+    if (!is_integer(args[1]) || !is_integer(args[2])) {
+        return throw_runtime_error(ctx, "__io_ring_reap() expects integer min and timeout");
+    }
+    int min = value_to_int(args[1]);
+    int timeout_ms = value_to_int(args[2]);
+
+    pthread_mutex_lock(&ring->lock);
+    int64_t deadline = timeout_ms >= 0 ? io_now_ms() + timeout_ms : -1;
+    while (ring->num_done < min && ring->num_inflight + ring->num_staged > 0) {
+        int remaining = -1;
+        if (deadline >= 0) {
+            int64_t left = deadline - io_now_ms();
+            if (left <= 0) break;
+            remaining = (int)left;
+        }
+        int before = ring->num_done;
+        io_wait_locked(ring, NULL, remaining);
+        if (ring->num_done == before && ring->num_done > 0) {
+            // io_wait_locked returns as soon as anything is done; wait for more
+            if (ring->num_inflight == 0) break;
+#ifdef IORING_HAVE_URING
+            if (ring->use_uring && !ring->reaping) {
+                io_uring_wait_locked(ring, remaining);
+                continue;
+            }
+#endif
+            struct timespec ts;
+            io_deadline(&ts, remaining >= 0 ? remaining : 1000);
+            pthread_cond_timedwait(&ring->done_cond, &ring->lock, &ts);
+        }
+    }
+#ifdef IORING_HAVE_URING
+    if (ring->use_uring) io_uring_reap_locked(ring);
+#endif
+
+    // Collect completed ops in id order
+    IoOp *done = NULL;
+    for (int b = 0; b < IO_RING_HASH_BUCKETS; b++) {
+        IoOp **link = &ring->buckets[b];
+        while (*link) {
+            IoOp *op = *link;
+            if (op->state == IO_OP_DONE) {
+                *link = op->hash_next;
+                op->queue_next = done;
+                done = op;
+                ring->num_done--;
+            } else {
+                link = &op->hash_next;
+            }
+        }
+    }
+    pthread_mutex_unlock(&ring->lock);
+
+    Array *arr = array_new();
+    while (done) {
+        IoOp *next = done->queue_next;
+        array_push(arr, io_completion_value(done));
+        done = next;
+    }
+    return val_array(arr);
+}
+
+// __io_ring_pending(ring) -> i32 (staged + in-flight + unclaimed ops)
+Value builtin_io_ring_pending(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        return throw_runtime_error(ctx, "__io_ring_pending() expects 1 argument (ring)");
+    }
+    IoRing *ring = io_get_ring(args[0], "__io_ring_pending", ctx);
+    if (!ring) return val_null();
+    pthread_mutex_lock(&ring->lock);
+    int pending = ring->num_staged + ring->num_inflight + ring->num_done;
+    pthread_mutex_unlock(&ring->lock);
+    return val_i32(pending);
+}
+
+// __io_ring_free(ring) -> null
+// Waits for in-flight file ops; socket ops that never complete are abandoned
+Value builtin_io_ring_free(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        return throw_runtime_error(ctx, "__io_ring_free() expects 1 argument (ring)");
+    }
+    IoRing *ring = io_get_ring(args[0], "__io_ring_free", ctx);
+    if (!ring) return val_null();
+
+    pthread_mutex_lock(&ring->lock);
+    // Drop staged and unclaimed ops, then give in-flight ones a bounded
+    // chance to finish so their buffers can be released
+    io_discard_ops_locked(ring);
+    int64_t deadline = io_now_ms() + 1000;
+    while (ring->num_inflight > 0) {
+        int64_t left = deadline - io_now_ms();
+        if (left <= 0) break;
+        io_wait_locked(ring, NULL, (int)left);
+        io_discard_ops_locked(ring);
+    }
+
+    // Handles may still be referenced by Hemlock values, so the struct stays
+    // allocated and is marked closed; idle workers exit on the broadcast.
+    // Ops that never complete (e.g. an accept with no client) are leaked
+    // rather than freed underneath the kernel or a worker.
+    ring->closed = 1;
+#ifdef IORING_HAVE_URING
+    if (ring->use_uring && ring->num_inflight == 0) {
+        io_uring_teardown(ring);
+    }
+#endif
+    pthread_cond_broadcast(&ring->work_cond);
+    pthread_cond_broadcast(&ring->done_cond);
+    pthread_mutex_unlock(&ring->lock);
+    return val_null();
+}
@@ -0,0 +1,242 @@
+#include "internal.h"
+#include "../io/internal.h"
+#include "../../shared/log_sink_core.h"
+
+// ============================================================================
+// LOG SINK
+// ============================================================================
+//
+// Output backend for @stdlib/logging. The line ring, the writer thread and
+// the atexit flush live in the shared core (src/shared/log_sink_core.c);
+// these builtins check arguments, copy lines out of Hemlock strings and
+// format JSON lines.
+
+static Value* log_config_field(Value config, const char *name) {
+    if (config.type != VAL_OBJECT) {
+        return NULL;
+    }
+    Object *obj = config.as.as_object;
+    for (int i = 0; i < obj->num_fields; i++) {
+        if (strcmp(obj->field_names[i], name) == 0) {
+            return &obj->field_values[i];
+        }
+    }
+    return NULL;
+}
+
+static int64_t log_config_int(Value config, const char *name, int64_t fallback) {
+    Value *field = log_config_field(config, name);
+    if (!field || !is_integer(*field)) {
+        return fallback;
+    }
+    return value_to_int64(*field);
+}
+
+static int log_config_bool(Value config, const char *name, int fallback) {
+    Value *field = log_config_field(config, name);
+    if (!field || field->type != VAL_BOOL) {
+        return fallback;
+    }
+    return field->as.as_bool;
+}
+
+static void log_object_add(Object *obj, const char *name, Value value) {
+    obj->field_names[obj->num_fields] = strdup(name);
+    obj->field_values[obj->num_fields] = value;
+    obj->num_fields++;
+}
+
+static LogSink* log_sink_get(Value val, const char *fn_name, ExecutionContext *ctx) {
+    if (val.type != VAL_PTR || !val.as.as_ptr) {
+        runtime_error(ctx, "%s() expects a log sink handle", fn_name);
+        return NULL;
+    }
+    LogSink *s = (LogSink*)val.as.as_ptr;
+    if (log_sink_closed(s)) {
+        runtime_error(ctx, "%s() called on closed log sink", fn_name);
+        return NULL;
+    }
+    return s;
+}
+
+// ========== BUILTINS ==========
+
+// __log_sink_open(target, config) -> sink handle
+// target: "stdout", "stderr" or a file path (opened for append)
+// config: { buffered, capacity, batch_bytes, flush_ms, block } (missing fields use defaults)
+Value builtin_log_sink_open(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2 || args[0].type != VAL_STRING) {
+        runtime_error(ctx, "log_sink_open() expects 2 arguments (target, config)");
+        return val_null();
+    }
+    int buffered = log_config_bool(args[1], "buffered", 1);
+    int block = log_config_bool(args[1], "block", 1);
+    int64_t capacity = log_config_int(args[1], "capacity", 8192);
+    int64_t batch_bytes = log_config_int(args[1], "batch_bytes", 64 * 1024);
+    int64_t flush_ms = log_config_int(args[1], "flush_ms", 100);
+    if (capacity < 1 || capacity > LOG_SINK_MAX_CAPACITY) {
+        runtime_error(ctx, "log_sink_open() capacity must be between 1 and %d", LOG_SINK_MAX_CAPACITY);
+        return val_null();
+    }
+    if (batch_bytes < 1 || flush_ms < 1 || flush_ms > 60000) {
+        runtime_error(ctx, "log_sink_open() batch_bytes must be positive and flush_ms between 1 and 60000");
+        return val_null();
+    }
+
+    char err[LOG_SINK_ERR_LEN];
+    LogSink *s = log_sink_open(args[0].as.as_string->data, buffered, block, (size_t)capacity,
+                               (size_t)batch_bytes, (int)flush_ms, err);
+    if (!s) {
+        runtime_error(ctx, "%s", err);
+        return val_null();
+    }
+    return val_ptr(s);
+}
+
+// __log_sink_write(sink, line) -> bool (false if the line was dropped)
+Value builtin_log_sink_write(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2 || args[1].type != VAL_STRING) {
+        runtime_error(ctx, "log_sink_write() expects 2 arguments (sink, line)");
+        return val_null();
+    }
+    LogSink *s = log_sink_get(args[0], "log_sink_write", ctx);
+    if (!s) {
+        return val_null();
+    }
+    String *str = args[1].as.as_string;
+    size_t len = (size_t)str->length;
+    char *line = malloc(len + 1);
+    if (!line) {
+        runtime_error(ctx, "log_sink_write() memory allocation failed");
+        return val_null();
+    }
+    memcpy(line, str->data, len);
+    line[len] = '\n';
+    return val_bool(log_sink_write(s, line, len + 1));
+}
+
+// __log_sink_flush(sink): wait until every queued line has been written
+Value builtin_log_sink_flush(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "log_sink_flush() expects 1 argument (sink)");
+        return val_null();
+    }
+    LogSink *s = log_sink_get(args[0], "log_sink_flush", ctx);
+    if (!s) {
+        return val_null();
+    }
+    log_sink_flush(s);
+    return val_null();
+}
+
+// __log_sink_stats(sink) -> { written, dropped, pending }
+Value builtin_log_sink_stats(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "log_sink_stats() expects 1 argument (sink)");
+        return val_null();
+    }
+    LogSink *s = log_sink_get(args[0], "log_sink_stats", ctx);
+    if (!s) {
+        return val_null();
+    }
+    int64_t written, dropped, pending;
+    log_sink_stats(s, &written, &dropped, &pending);
+    Object *obj = object_new(NULL, 3);
+    log_object_add(obj, "written", val_i64(written));
+    log_object_add(obj, "dropped", val_i64(dropped));
+    log_object_add(obj, "pending", val_i64(pending));
+    return val_object(obj);
+}
+
+// __log_sink_close(sink): flush, stop the writer and close an opened file
+Value builtin_log_sink_close(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "log_sink_close() expects 1 argument (sink)");
+        return val_null();
+    }
+    LogSink *s = log_sink_get(args[0], "log_sink_close", ctx);
+    if (!s) {
+        return val_null();
+    }
+    log_sink_close(s);
+    return val_null();
+}
+
+// __log_timestamp() -> "YYYY-MM-DDTHH:MM:SS.mmmZ" (UTC)
+Value builtin_log_timestamp(Value *args, int num_args, ExecutionContext *ctx) {
+    (void)args;
+    if (num_args != 0) {
+        runtime_error(ctx, "log_timestamp() expects no arguments");
+        return val_null();
+    }
+    char *out = malloc(LOG_TIMESTAMP_LEN);
+    if (!out) {
+        runtime_error(ctx, "log_timestamp() memory allocation failed");
+        return val_null();
+    }
+    int len = log_timestamp_format(out);
+    return val_string_take(out, len, LOG_TIMESTAMP_LEN);
+}
+
+// __log_json(time, level, message, data) -> one JSON line
+// {"time":...,"level":...,"msg":...} followed by the fields of data when it
+// is an object, or a "data" field for any other non-null value. time may be
+// null to leave it out.
+Value builtin_log_json(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 4 || args[1].type != VAL_STRING || args[2].type != VAL_STRING ||
+        (args[0].type != VAL_STRING && args[0].type != VAL_NULL)) {
+        runtime_error(ctx, "log_json() expects 4 arguments (time, level, message, data)");
+        return val_null();
+    }
+    char *extra = NULL;
+    if (args[3].type != VAL_NULL) {
+        VisitedSet visited;
+        visited_init(&visited);
+        extra = serialize_value(args[3], &visited, ctx);
+        visited_free(&visited);
+        if (!extra) {
+            // serialize_value already threw
+            return val_null();
+        }
+    }
+
+    char *time_str = args[0].type == VAL_STRING ? escape_json_string(args[0].as.as_string->data) : NULL;
+    char *level = escape_json_string(args[1].as.as_string->data);
+    char *msg = escape_json_string(args[2].as.as_string->data);
+
+    size_t cap = strlen(level) + strlen(msg) + 48;
+    if (time_str) cap += strlen(time_str);
+    if (extra) cap += strlen(extra);
+    char *out = malloc(cap);
+    if (!out) {
+        free(time_str);
+        free(level);
+        free(msg);
+        free(extra);
+        runtime_error(ctx, "log_json() memory allocation failed");
+        return val_null();
+    }
+    size_t len = 0;
+    out[len++] = '{';
+    if (time_str) {
+        len += (size_t)snprintf(out + len, cap - len, "\"time\":\"%s\",", time_str);
+    }
+    len += (size_t)snprintf(out + len, cap - len, "\"level\":\"%s\",\"msg\":\"%s\"", level, msg);
+    if (extra && args[3].type == VAL_OBJECT) {
+        // Splice the object's fields in after msg
+        if (strcmp(extra, "{}") != 0) {
+            len += (size_t)snprintf(out + len, cap - len, ",%s", extra + 1);
+            len--;  // Drop the object's closing brace
+        }
+    } else if (extra) {
+        len += (size_t)snprintf(out + len, cap - len, ",\"data\":%s", extra);
+    }
+    out[len++] = '}';
+    out[len] = '\0';
+
+    free(time_str);
+    free(level);
+    free(msg);
+    free(extra);
+    return val_string_take(out, (int)len, (int)cap);
+}
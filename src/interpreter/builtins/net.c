@@ -1,4 +1,5 @@
 #include "internal.h"
+#include "../../shared/send_file_core.h"
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -394,6 +395,87 @@ Value socket_method_recv(SocketHandle *sock, Value *args, int num_args, Executio
     return (Value){ .type = VAL_BUFFER, .as.as_buffer = buf };
 }
 
+// ========== ZERO-COPY FILE TRANSFER ==========
+
+// socket.send_file(source, offset?: i64, length?: i64) -> i64 (bytes sent)
+// source is a File, a path, or a raw fd. offset defaults to 0 and length to
+// the rest of the file; pipes are read from their current position (offset
+// must be 0) until EOF. On a non-blocking socket the result may be short:
+// advance offset by it and call again once the socket is writable. The
+// transfer itself lives in the shared core (src/shared/send_file_core.c).
+Value socket_method_send_file(SocketHandle *sock, Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args < 1 || num_args > 3) {
+        return throw_runtime_error(ctx, "send_file() expects 1-3 arguments (source, offset, length)");
+    }
+
+    if (sock->closed) {
+        return throw_runtime_error(ctx, "Cannot send on closed socket");
+    }
+
+    int64_t offset = 0;
+    int64_t length = -1;
+    if (num_args >= 2 && args[1].type != VAL_NULL) {
+        if (!is_integer(args[1]) || value_to_int64(args[1]) < 0) {
+            return throw_runtime_error(ctx, "send_file() offset must be a non-negative integer");
+        }
+        offset = value_to_int64(args[1]);
+    }
+    if (num_args == 3 && args[2].type != VAL_NULL) {
+        if (!is_integer(args[2]) || value_to_int64(args[2]) < 0) {
+            return throw_runtime_error(ctx, "send_file() length must be a non-negative integer");
+        }
+        length = value_to_int64(args[2]);
+    }
+
+    int in_fd;
+    int owns_fd = 0;
+    char path_buf[PATH_MAX];
+    const char *what = "file";
+    if (args[0].type == VAL_FILE) {
+        FileHandle *file = args[0].as.as_file;
+        if (file->closed) {
+            return throw_runtime_error(ctx, "send_file() source file is closed");
+        }
+        fflush(file->fp);  // Make buffered writes visible to the kernel
+        in_fd = fileno(file->fp);
+        what = file->path;
+        if ((fcntl(in_fd, F_GETFL) & O_ACCMODE) == O_WRONLY) {
+            // Write-only handle: read the same file through a fresh descriptor
+            in_fd = open(file->path, O_RDONLY | O_CLOEXEC);
+            if (in_fd < 0) {
+                return throw_runtime_error(ctx, "Failed to open '%s': %s", file->path, strerror(errno));
+            }
+            owns_fd = 1;
+        }
+    } else if (args[0].type == VAL_STRING) {
+        String *path = args[0].as.as_string;
+        if (path->length >= (int)sizeof(path_buf)) {
+            return throw_runtime_error(ctx, "send_file() path too long");
+        }
+        memcpy(path_buf, path->data, path->length);
+        path_buf[path->length] = '\0';
+        in_fd = open(path_buf, O_RDONLY | O_CLOEXEC);
+        if (in_fd < 0) {
+            return throw_runtime_error(ctx, "Failed to open '%s': %s", path_buf, strerror(errno));
+        }
+        owns_fd = 1;
+        what = path_buf;
+    } else if (is_integer(args[0])) {
+        in_fd = value_to_int(args[0]);
+    } else {
+        return throw_runtime_error(ctx, "send_file() source must be a file, path, or file descriptor");
+    }
+
+    int err = 0;
+    int64_t sent = send_file_fd(sock->fd, in_fd, offset, length, &err);
+    if (owns_fd) close(in_fd);
+
+    if (sent < 0) {
+        return throw_runtime_error(ctx, "Failed to send file '%s': %s", what, strerror(err));
+    }
+    return val_i64(sent);
+}
+
 // ========== UDP OPERATIONS ==========
 
 // socket.sendto(address: string, port: i32, data: string | buffer) -> i32
@@ -738,6 +820,9 @@ Value call_socket_method(SocketHandle *sock, const char *method, Value *args, in
     if (strcmp(method, "recv") == 0) {
         return socket_method_recv(sock, args, num_args, ctx);
     }
+    if (strcmp(method, "send_file") == 0) {
+        return socket_method_send_file(sock, args, num_args, ctx);
+    }
 
     // UDP operations
     if (strcmp(method, "sendto") == 0) {
@@ -0,0 +1,300 @@
+#include "internal.h"
+#include "../../shared/regex_engine.h"
+
+// ============================================================================
+// REGULAR EXPRESSIONS
+// ============================================================================
+//
+// Builtins for @stdlib/regex. Parsing, the Pike VM and lazy DFA, the literal
+// prefilter and the pattern cache live in src/shared/regex_engine.c, which
+// the runtime library compiles too; this file only converts between Values
+// and the engine's byte ranges and capture slots.
+
+// ========== BUILTINS ==========
+
+typedef struct {
+    HmlRegex *re;
+    int closed;
+} RegexHandle;
+
+// Resolve a regex argument: a handle from __regex_new, or a pattern string
+// compiled through the cache with the given flags. The caller releases it.
+static HmlRegex* regex_arg(Value re, Value flags, const char *fn_name, ExecutionContext *ctx) {
+    if (re.type == VAL_STRING) {
+        if (!is_numeric(flags)) {
+            runtime_error(ctx, "%s() flags must be an integer", fn_name);
+            return NULL;
+        }
+        const char *error = NULL;
+        HmlRegex *compiled = hml_re_acquire(re.as.as_string->data, re.as.as_string->length,
+                                        value_to_int(flags), &error);
+        if (!compiled) runtime_error(ctx, "Regex compilation failed: %s", error);
+        return compiled;
+    }
+    if (re.type != VAL_PTR || re.as.as_ptr == NULL) {
+        runtime_error(ctx, "%s() expects a regex handle or pattern string", fn_name);
+        return NULL;
+    }
+    RegexHandle *h = (RegexHandle*)re.as.as_ptr;
+    if (h->closed) {
+        runtime_error(ctx, "%s() called on freed regex", fn_name);
+        return NULL;
+    }
+    hml_re_retain(h->re);
+    return h->re;
+}
+
+static int regex_text_arg(Value text, const char *fn_name, ExecutionContext *ctx) {
+    if (text.type != VAL_STRING) {
+        runtime_error(ctx, "%s() text must be a string", fn_name);
+        return 0;
+    }
+    return 1;
+}
+
+static Value regex_substring(const char *text, int start, int end) {
+    int len = end - start;
+    char *s = malloc(len + 1);
+    if (!s) {
+        fprintf(stderr, "Runtime error: Memory allocation failed\n");
+        exit(1);
+    }
+    memcpy(s, text + start, len);
+    s[len] = '\0';
+    return val_string_take(s, len, len + 1);
+}
+
+// { start, end, text } for one match or group
+static Value regex_match_value(const char *text, int start, int end) {
+    Object *obj = object_new(NULL, 3);
+    char *field_names[] = {"start", "end", "text"};
+    Value field_values[] = { val_i32(start), val_i32(end), regex_substring(text, start, end) };
+    for (int i = 0; i < 3; i++) {
+        obj->field_names[i] = strdup(field_names[i]);
+        obj->field_values[i] = field_values[i];
+        obj->num_fields++;
+    }
+    return val_object(obj);
+}
+
+static void regex_push(Array *arr, Value val) {
+    array_push(arr, val);
+    value_release(val);
+}
+
+// Search state shared by the builtins below
+typedef struct {
+    HmlRegex *re;
+    HmlRegexVM vm;
+    int *caps;
+    const char *text;
+    int len;
+} RegexRun;
+
+static int regex_run_begin(RegexRun *run, Value *args, Value text, const char *fn_name, ExecutionContext *ctx) {
+    if (!regex_text_arg(text, fn_name, ctx)) return 0;
+    run->re = regex_arg(args[0], args[1], fn_name, ctx);
+    if (!run->re) return 0;
+    run->text = text.as.as_string->data;
+    run->len = text.as.as_string->length;
+    run->caps = malloc(sizeof(int) * hml_re_groups(run->re) * 2);
+    if (!run->caps || !hml_re_vm_init(&run->vm, run->re)) {
+        runtime_error(ctx, "%s() out of memory", fn_name);
+        return 0;
+    }
+    return 1;
+}
+
+static void regex_run_end(RegexRun *run) {
+    if (!run->re) return;
+    hml_re_vm_free(&run->vm);
+    free(run->caps);
+    hml_re_release(run->re);
+}
+
+static int regex_limit_arg(Value val, const char *fn_name, ExecutionContext *ctx) {
+    if (!is_numeric(val) || value_to_int(val) < 0) {
+        runtime_error(ctx, "%s() limit must be a non-negative integer", fn_name);
+        return -1;
+    }
+    return value_to_int(val);
+}
+
+// __regex_new(pattern, flags) -> handle
+Value builtin_regex_new(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2 || args[0].type != VAL_STRING || !is_numeric(args[1])) {
+        runtime_error(ctx, "regex_new() expects (string pattern, integer flags)");
+        return val_null();
+    }
+    const char *error = NULL;
+    HmlRegex *re = hml_re_acquire(args[0].as.as_string->data, args[0].as.as_string->length,
+                              value_to_int(args[1]), &error);
+    if (!re) {
+        runtime_error(ctx, "Regex compilation failed: %s", error);
+        return val_null();
+    }
+    RegexHandle *h = malloc(sizeof(RegexHandle));
+    if (!h) {
+        hml_re_release(re);
+        runtime_error(ctx, "regex_new() out of memory");
+        return val_null();
+    }
+    h->re = re;
+    h->closed = 0;
+    return val_ptr(h);
+}
+
+// __regex_free(handle)
+Value builtin_regex_free(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1 || args[0].type != VAL_PTR || args[0].as.as_ptr == NULL) {
+        runtime_error(ctx, "regex_free() expects a regex handle");
+        return val_null();
+    }
+    RegexHandle *h = (RegexHandle*)args[0].as.as_ptr;
+    if (!h->closed) {
+        h->closed = 1;
+        hml_re_release(h->re);
+        h->re = NULL;
+    }
+    return val_null();
+}
+
+// __regex_test(re, flags, text) -> bool
+Value builtin_regex_test(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 3) {
+        runtime_error(ctx, "regex_test() expects 3 arguments");
+        return val_null();
+    }
+    if (!regex_text_arg(args[2], "regex_test", ctx)) return val_null();
+    HmlRegex *re = regex_arg(args[0], args[1], "regex_test", ctx);
+    if (!re) return val_null();
+    int found = hml_re_test(re, (const unsigned char*)args[2].as.as_string->data, args[2].as.as_string->length);
+    hml_re_release(re);
+    return val_bool(found);
+}
+
+// __regex_find(re, flags, text, start) -> { start, end, text } or null
+Value builtin_regex_find(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 4 || !is_numeric(args[3])) {
+        runtime_error(ctx, "regex_find() expects (regex, flags, string text, integer start)");
+        return val_null();
+    }
+    RegexRun run = {0};
+    Value result = val_null();
+    int start = value_to_int(args[3]);
+    if (regex_run_begin(&run, args, args[2], "regex_find", ctx) && start >= 0 && start <= run.len &&
+        hml_re_search(run.re, &run.vm, (const unsigned char*)run.text, run.len, start, run.caps)) {
+        result = regex_match_value(run.text, run.caps[0], run.caps[1]);
+    }
+    regex_run_end(&run);
+    return result;
+}
+
+// __regex_find_all(re, flags, text, limit) -> array of { start, end, text }
+Value builtin_regex_find_all(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 4) {
+        runtime_error(ctx, "regex_find_all() expects 4 arguments");
+        return val_null();
+    }
+    int limit = regex_limit_arg(args[3], "regex_find_all", ctx);
+    RegexRun run = {0};
+    if (limit < 0 || !regex_run_begin(&run, args, args[2], "regex_find_all", ctx)) {
+        regex_run_end(&run);
+        return val_null();
+    }
+    Array *arr = array_new();
+    int pos = 0, prev_end = -1;
+    while ((limit == 0 || arr->length < limit) &&
+           hml_re_next(run.re, &run.vm, (const unsigned char*)run.text, run.len, &pos, &prev_end, run.caps)) {
+        regex_push(arr, regex_match_value(run.text, run.caps[0], run.caps[1]));
+    }
+    regex_run_end(&run);
+    return val_array(arr);
+}
+
+// __regex_captures(re, flags, text, start) -> array (group 0 first, null
+// for groups that did not take part) or null without a match
+Value builtin_regex_captures(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 4 || !is_numeric(args[3])) {
+        runtime_error(ctx, "regex_captures() expects (regex, flags, string text, integer start)");
+        return val_null();
+    }
+    RegexRun run = {0};
+    Value result = val_null();
+    int start = value_to_int(args[3]);
+    if (regex_run_begin(&run, args, args[2], "regex_captures", ctx) && start >= 0 && start <= run.len &&
+        hml_re_search(run.re, &run.vm, (const unsigned char*)run.text, run.len, start, run.caps)) {
+        Array *arr = array_new();
+        for (int g = 0; g < hml_re_groups(run.re); g++) {
+            int s = run.caps[g * 2], e = run.caps[g * 2 + 1];
+            if (s >= 0 && e >= s) regex_push(arr, regex_match_value(run.text, s, e));
+            else array_push(arr, val_null());
+        }
+        result = val_array(arr);
+    }
+    regex_run_end(&run);
+    return result;
+}
+
+// __regex_replace(re, flags, text, replacement, limit) -> string
+Value builtin_regex_replace(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 5 || args[3].type != VAL_STRING) {
+        runtime_error(ctx, "regex_replace() expects (regex, flags, string text, string replacement, integer limit)");
+        return val_null();
+    }
+    int limit = regex_limit_arg(args[4], "regex_replace", ctx);
+    RegexRun run = {0};
+    if (limit < 0 || !regex_run_begin(&run, args, args[2], "regex_replace", ctx)) {
+        regex_run_end(&run);
+        return val_null();
+    }
+    HmlRegexOut out = {0};
+    hml_re_out(&out, "", 0);
+    int pos = 0, prev_end = -1, last = 0, count = 0;
+    while ((limit == 0 || count < limit) &&
+           hml_re_next(run.re, &run.vm, (const unsigned char*)run.text, run.len, &pos, &prev_end, run.caps)) {
+        hml_re_out(&out, run.text + last, run.caps[0] - last);
+        hml_re_expand(&out, args[3].as.as_string->data, args[3].as.as_string->length,
+                      run.text, run.caps, hml_re_groups(run.re));
+        last = run.caps[1];
+        count++;
+    }
+    hml_re_out(&out, run.text + last, run.len - last);
+    regex_run_end(&run);
+    if (out.failed) {
+        fprintf(stderr, "Runtime error: Memory allocation failed\n");
+        exit(1);
+    }
+    return val_string_take(out.data, out.len, out.cap);
+}
+
+// __regex_split(re, flags, text, limit) -> array of strings
+Value builtin_regex_split(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 4) {
+        runtime_error(ctx, "regex_split() expects 4 arguments");
+        return val_null();
+    }
+    int limit = regex_limit_arg(args[3], "regex_split", ctx);
+    RegexRun run = {0};
+    if (limit < 0 || !regex_run_begin(&run, args, args[2], "regex_split", ctx)) {
+        regex_run_end(&run);
+        return val_null();
+    }
+    Array *arr = array_new();
+    int pos = 0, prev_end = -1, beg = 0, end = 0;
+    if (run.len == 0) {
+        regex_push(arr, regex_substring(run.text, 0, 0));
+        regex_run_end(&run);
+        return val_array(arr);
+    }
+    while ((limit == 0 || arr->length < limit - 1) &&
+           hml_re_next(run.re, &run.vm, (const unsigned char*)run.text, run.len, &pos, &prev_end, run.caps)) {
+        end = run.caps[0];
+        // An empty match at the very start does not produce an empty piece
+        if (run.caps[1] != 0) regex_push(arr, regex_substring(run.text, beg, end));
+        beg = run.caps[1];
+    }
+    if (end != run.len) regex_push(arr, regex_substring(run.text, beg, run.len));
+    regex_run_end(&run);
+    return val_array(arr);
+}
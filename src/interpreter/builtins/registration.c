@@ -24,6 +24,7 @@ static BuiltinInfo builtins[] = {
     {"open", builtin_open},
     {"assert", builtin_assert},
     {"panic", builtin_panic},
+    {"snapshot_point", builtin_snapshot_point},
     {"exec", builtin_exec},
     {"spawn", builtin_spawn},
     {"join", builtin_join},
@@ -37,6 +38,35 @@ static BuiltinInfo builtins[] = {
     {"socket_create", builtin_socket_create},
     {"dns_resolve", builtin_dns_resolve},
     {"poll", builtin_poll},
+    // Event loop (use stdlib/net.hml EventLoop for public API)
+    {"__evloop_new", builtin_evloop_new},
+    {"__evloop_backend", builtin_evloop_backend},
+    {"__evloop_register", builtin_evloop_register},
+    {"__evloop_modify", builtin_evloop_modify},
+    {"__evloop_unregister", builtin_evloop_unregister},
+    {"__evloop_watch_channel", builtin_evloop_watch_channel},
+    {"__evloop_add_timer", builtin_evloop_add_timer},
+    {"__evloop_cancel_timer", builtin_evloop_cancel_timer},
+    {"__evloop_run_once", builtin_evloop_run_once},
+    {"__evloop_run", builtin_evloop_run},
+    {"__evloop_stop", builtin_evloop_stop},
+    {"__evloop_free", builtin_evloop_free},
+    // I/O ring (use stdlib/async_fs.hml IoRing for public API)
+    {"__io_ring_new", builtin_io_ring_new},
+    {"__io_ring_backend", builtin_io_ring_backend},
+    {"__io_ring_read_file", builtin_io_ring_read_file},
+    {"__io_ring_write_file", builtin_io_ring_write_file},
+    {"__io_ring_copy_file", builtin_io_ring_copy_file},
+    {"__io_ring_read", builtin_io_ring_read},
+    {"__io_ring_write", builtin_io_ring_write},
+    {"__io_ring_recv", builtin_io_ring_recv},
+    {"__io_ring_send", builtin_io_ring_send},
+    {"__io_ring_accept", builtin_io_ring_accept},
+    {"__io_ring_submit", builtin_io_ring_submit},
+    {"__io_ring_wait", builtin_io_ring_wait},
+    {"__io_ring_reap", builtin_io_ring_reap},
+    {"__io_ring_pending", builtin_io_ring_pending},
+    {"__io_ring_free", builtin_io_ring_free},
     // Math functions (use stdlib/math.hml module for public API)
     {"__sin", builtin_sin},
     {"__cos", builtin_cos},
@@ -146,6 +176,73 @@ static BuiltinInfo builtins[] = {
     {"__zlib_compress_bound", builtin_zlib_compress_bound},
     {"__crc32", builtin_crc32},
     {"__adler32", builtin_adler32},
+    {"__deflate_new", builtin_deflate_new},
+    {"__inflate_new", builtin_inflate_new},
+    {"__zstream_update", builtin_zstream_update},
+    {"__zstream_flush", builtin_zstream_flush},
+    {"__zstream_finish", builtin_zstream_finish},
+    {"__zstream_done", builtin_zstream_done},
+    {"__zstream_free", builtin_zstream_free},
+    // Hash builtins (use stdlib/hash.hml module for public API)
+    {"__hasher_new", builtin_hasher_new},
+    {"__hasher_update", builtin_hasher_update},
+    {"__hasher_update_file", builtin_hasher_update_file},
+    {"__hasher_digest", builtin_hasher_digest},
+    {"__hasher_hex_digest", builtin_hasher_hex_digest},
+    {"__hasher_value", builtin_hasher_value},
+    {"__hasher_reset", builtin_hasher_reset},
+    {"__hasher_free", builtin_hasher_free},
+    // Regex builtins (use stdlib/regex.hml module for public API)
+    {"__regex_new", builtin_regex_new},
+    {"__regex_free", builtin_regex_free},
+    {"__regex_test", builtin_regex_test},
+    {"__regex_find", builtin_regex_find},
+    {"__regex_find_all", builtin_regex_find_all},
+    {"__regex_captures", builtin_regex_captures},
+    {"__regex_replace", builtin_regex_replace},
+    {"__regex_split", builtin_regex_split},
+    // HTTP client builtins (use stdlib/http.hml module for public API)
+    {"__http_client_new", builtin_http_client_new},
+    {"__http_client_free", builtin_http_client_free},
+    {"__http_client_stats", builtin_http_client_stats},
+    {"__http_request", builtin_http_request},
+    {"__http_response_status", builtin_http_response_status},
+    {"__http_response_headers", builtin_http_response_headers},
+    {"__http_response_read", builtin_http_response_read},
+    {"__http_response_body", builtin_http_response_body},
+    {"__http_response_close", builtin_http_response_close},
+    // HTTP server builtins (use stdlib/http.hml module for public API)
+    {"__http_server_new", builtin_http_server_new},
+    {"__http_server_port", builtin_http_server_port},
+    {"__http_server_stats", builtin_http_server_stats},
+    {"__http_server_close", builtin_http_server_close},
+    // Log sink builtins (use stdlib/logging.hml module for public API)
+    {"__log_sink_open", builtin_log_sink_open},
+    {"__log_sink_write", builtin_log_sink_write},
+    {"__log_sink_flush", builtin_log_sink_flush},
+    {"__log_sink_stats", builtin_log_sink_stats},
+    {"__log_sink_close", builtin_log_sink_close},
+    {"__log_timestamp", builtin_log_timestamp},
+    {"__log_json", builtin_log_json},
+    // Subprocess builtins (use stdlib/process.hml module for public API)
+    {"__process_spawn", builtin_process_spawn},
+    {"__process_pid", builtin_process_pid},
+    {"__process_read", builtin_process_read},
+    {"__process_read_line", builtin_process_read_line},
+    {"__process_write", builtin_process_write},
+    {"__process_close_stdin", builtin_process_close_stdin},
+    {"__process_poll", builtin_process_poll},
+    {"__process_wait", builtin_process_wait},
+    {"__process_kill", builtin_process_kill},
+    {"__process_communicate", builtin_process_communicate},
+    {"__process_close", builtin_process_close},
+    // Encoding builtins (use stdlib/encoding.hml module for public API)
+    {"__base64_encode", builtin_base64_encode},
+    {"__base64_decode", builtin_base64_decode},
+    {"__hex_encode", builtin_hex_encode},
+    {"__hex_decode", builtin_hex_decode},
+    {"__url_encode", builtin_url_encode},
+    {"__url_decode", builtin_url_decode},
     // OS information builtins (use stdlib/os.hml module for public API)
     {"__platform", builtin_platform},
     {"__arch", builtin_arch},
@@ -199,6 +296,24 @@ static BuiltinInfo builtins[] = {
     {NULL, NULL}  // Sentinel
 };
 
+const char* builtin_name(BuiltinFn fn) {
+    for (int i = 0; builtins[i].name != NULL; i++) {
+        if (builtins[i].fn == fn) {
+            return builtins[i].name;
+        }
+    }
+    return NULL;
+}
+
+BuiltinFn builtin_lookup(const char *name) {
+    for (int i = 0; builtins[i].name != NULL; i++) {
+        if (strcmp(builtins[i].name, name) == 0) {
+            return builtins[i].fn;
+        }
+    }
+    return NULL;
+}
+
 Value val_builtin_fn(BuiltinFn fn) {
     Value v;
     v.type = VAL_BUILTIN_FN;
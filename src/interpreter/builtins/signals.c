@@ -27,7 +27,7 @@ static void hemlock_signal_handler(int signum) {
     }
 
     // Execute handler body
-    eval_stmt(handler->body, func_env, ctx);
+    eval_stmt(function_body(handler, ctx), func_env, ctx);
 
     // Cleanup
     env_release(func_env);
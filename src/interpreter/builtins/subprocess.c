@@ -0,0 +1,484 @@
+#include "internal.h"
+#include "../../shared/subprocess_core.h"
+
+// ============================================================================
+// STREAMING SUBPROCESSES
+// ============================================================================
+//
+// A process handle is a child started with posix_spawnp() whose stdin,
+// stdout and stderr are each inherited, redirected to /dev/null or a file,
+// or connected to a pipe held by the parent. Spawning, reading, writing and
+// waiting live in the shared core (src/shared/subprocess_core.c); these
+// builtins check arguments and convert between Hemlock values and bytes.
+
+// ========== BUILTINS ==========
+
+static Process* proc_get(Value val, const char *fn_name, int allow_closed, ExecutionContext *ctx) {
+    if (val.type != VAL_PTR || !val.as.as_ptr) {
+        runtime_error(ctx, "%s() expects a process handle", fn_name);
+        return NULL;
+    }
+    Process *proc = (Process*)val.as.as_ptr;
+    if (proc->closed && !allow_closed) {
+        runtime_error(ctx, "%s() called on closed process", fn_name);
+        return NULL;
+    }
+    return proc;
+}
+
+static Value* proc_field(Object *obj, const char *name) {
+    for (int i = 0; i < obj->num_fields; i++) {
+        if (strcmp(obj->field_names[i], name) == 0) {
+            return &obj->field_values[i];
+        }
+    }
+    return NULL;
+}
+
+static ProcStream* proc_stream_get(Process *proc, Value name, const char *fn_name, ExecutionContext *ctx) {
+    ProcStream *s = name.type == VAL_STRING ? proc_stream_named(proc, name.as.as_string->data) : NULL;
+    if (!s) {
+        runtime_error(ctx, "%s() stream must be \"stdout\" or \"stderr\"", fn_name);
+    }
+    return s;
+}
+
+static void proc_add_field(Object *obj, const char *name, Value value) {
+    obj->field_names[obj->num_fields] = strdup(name);
+    obj->field_values[obj->num_fields] = value;
+    obj->num_fields++;
+}
+
+static void proc_add_status(Object *obj, Process *proc) {
+    int exit_code, term_signal;
+    proc_exit_status(proc, &exit_code, &term_signal);
+    proc_add_field(obj, "exit_code", val_i32(exit_code));
+    proc_add_field(obj, "signal", val_i32(term_signal));
+}
+
+// Parse a stdin/stdout/stderr option:
+//   null / "inherit", "pipe", "null", { file, append? },
+//   "stdout" (stderr only) or a process handle (stdin only)
+static int proc_parse_redirect(Value spec, int stream, ProcRedirect *r, ExecutionContext *ctx) {
+    static const char *names[] = {"stdin", "stdout", "stderr"};
+    memset(r, 0, sizeof(*r));
+    r->fd = -1;
+    if (spec.type == VAL_NULL) {
+        return 0;
+    }
+    if (spec.type == VAL_STRING) {
+        const char *s = spec.as.as_string->data;
+        if (strcmp(s, "inherit") == 0) {
+            return 0;
+        }
+        if (strcmp(s, "pipe") == 0) {
+            r->kind = PROC_PIPE;
+            return 0;
+        }
+        if (strcmp(s, "null") == 0) {
+            r->kind = PROC_NULL;
+            return 0;
+        }
+        if (strcmp(s, "stdout") == 0 && stream == 2) {
+            r->kind = PROC_STDOUT;
+            return 0;
+        }
+    } else if (spec.type == VAL_PTR && stream == 0) {
+        Process *from = proc_get(spec, "process_spawn", 0, ctx);
+        if (!from) {
+            return -1;
+        }
+        char err[PROC_ERR_LEN];
+        if (proc_redirect_from(r, from, err, sizeof(err)) < 0) {
+            runtime_error(ctx, "process_spawn() %s", err);
+            return -1;
+        }
+        return 0;
+    } else if (spec.type == VAL_OBJECT) {
+        Value *file = proc_field(spec.as.as_object, "file");
+        Value *append = proc_field(spec.as.as_object, "append");
+        if (file && file->type == VAL_STRING) {
+            int append_mode = append && append->type == VAL_BOOL && append->as.as_bool;
+            char err[PROC_ERR_LEN];
+            if (proc_redirect_file(r, stream, file->as.as_string->data, append_mode, err, sizeof(err)) < 0) {
+                runtime_error(ctx, "process_spawn() %s", err);
+                return -1;
+            }
+            return 0;
+        }
+    }
+    runtime_error(ctx, "process_spawn() invalid %s option (expected \"inherit\", \"pipe\", \"null\", "
+                  "{ file }%s)", names[stream],
+                  stream == 0 ? " or a process" : stream == 2 ? " or \"stdout\"" : "");
+    return -1;
+}
+
+// __process_spawn(argv, options) -> process handle
+// options: { cwd, env, stdin, stdout, stderr } (null or missing fields use defaults)
+Value builtin_process_spawn(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2) {
+        runtime_error(ctx, "process_spawn() expects 2 arguments (argv, options)");
+        return val_null();
+    }
+    if (args[0].type != VAL_ARRAY || args[0].as.as_array->length == 0) {
+        runtime_error(ctx, "process_spawn() argv must be a non-empty array of strings");
+        return val_null();
+    }
+    Array *argv_arr = args[0].as.as_array;
+    for (int i = 0; i < argv_arr->length; i++) {
+        if (argv_arr->elements[i].type != VAL_STRING) {
+            runtime_error(ctx, "process_spawn() argv must be a non-empty array of strings");
+            return val_null();
+        }
+    }
+    Object *opts = args[1].type == VAL_OBJECT ? args[1].as.as_object : NULL;
+    if (!opts && args[1].type != VAL_NULL) {
+        runtime_error(ctx, "process_spawn() options must be an object or null");
+        return val_null();
+    }
+
+    const char *cwd = NULL;
+    Value *cwd_val = opts ? proc_field(opts, "cwd") : NULL;
+    if (cwd_val && cwd_val->type != VAL_NULL) {
+        if (cwd_val->type != VAL_STRING) {
+            runtime_error(ctx, "process_spawn() cwd must be a string");
+            return val_null();
+        }
+        cwd = cwd_val->as.as_string->data;
+    }
+    Value *env_val = opts ? proc_field(opts, "env") : NULL;
+    Object *env_obj = NULL;
+    if (env_val && env_val->type != VAL_NULL) {
+        if (env_val->type != VAL_OBJECT) {
+            runtime_error(ctx, "process_spawn() env must be an object of strings");
+            return val_null();
+        }
+        env_obj = env_val->as.as_object;
+        for (int i = 0; i < env_obj->num_fields; i++) {
+            if (env_obj->field_values[i].type != VAL_STRING) {
+                runtime_error(ctx, "process_spawn() env value '%s' must be a string", env_obj->field_names[i]);
+                return val_null();
+            }
+        }
+    }
+
+    static const char *stream_names[] = {"stdin", "stdout", "stderr"};
+    ProcRedirect redir[3];
+    memset(redir, 0, sizeof(redir));
+    for (int i = 0; i < 3; i++) {
+        Value *spec = opts ? proc_field(opts, stream_names[i]) : NULL;
+        if (proc_parse_redirect(spec ? *spec : val_null(), i, &redir[i], ctx) < 0) {
+            proc_redirect_release(redir, i);
+            return val_null();
+        }
+    }
+
+    char **argv = malloc(sizeof(char*) * ((size_t)argv_arr->length + 1));
+    char **envp = NULL;
+    int env_count = env_obj ? env_obj->num_fields : 0;
+    if (env_obj) {
+        envp = calloc((size_t)env_count + 1, sizeof(char*));
+    }
+    int alloc_failed = !argv || (env_obj && !envp);
+    if (argv) {
+        for (int i = 0; i < argv_arr->length; i++) {
+            argv[i] = argv_arr->elements[i].as.as_string->data;
+        }
+        argv[argv_arr->length] = NULL;
+    }
+    for (int i = 0; envp && i < env_count; i++) {
+        const char *name = env_obj->field_names[i];
+        String *value = env_obj->field_values[i].as.as_string;
+        size_t len = strlen(name) + (size_t)value->length + 2;
+        envp[i] = malloc(len);
+        if (!envp[i]) {
+            alloc_failed = 1;
+            break;
+        }
+        snprintf(envp[i], len, "%s=%s", name, value->data);
+    }
+
+    Process *proc = NULL;
+    char err[PROC_ERR_LEN];
+    if (!alloc_failed) {
+        proc = proc_spawn(argv, envp, cwd, redir, err, sizeof(err));
+    } else {
+        proc_redirect_release(redir, 3);
+        snprintf(err, sizeof(err), "memory allocation failed");
+    }
+    free(argv);
+    for (int i = 0; envp && i < env_count; i++) {
+        free(envp[i]);
+    }
+    free(envp);
+    if (!proc) {
+        runtime_error(ctx, "process_spawn() failed to start %s", err);
+        return val_null();
+    }
+    return val_ptr(proc);
+}
+
+// __process_pid(proc) -> i32
+Value builtin_process_pid(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "process_pid() expects 1 argument (process)");
+        return val_null();
+    }
+    Process *proc = proc_get(args[0], "process_pid", 1, ctx);
+    if (!proc) {
+        return val_null();
+    }
+    return val_i32((int32_t)proc->pid);
+}
+
+// __process_read(proc, stream, max, timeout_ms) -> up to max bytes,
+// "" at EOF, null if nothing arrived within timeout_ms (-1 waits forever)
+Value builtin_process_read(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 4 || !is_integer(args[2]) || !is_integer(args[3])) {
+        runtime_error(ctx, "process_read() expects 4 arguments (process, stream, max_bytes, timeout_ms)");
+        return val_null();
+    }
+    Process *proc = proc_get(args[0], "process_read", 0, ctx);
+    if (!proc) {
+        return val_null();
+    }
+    ProcStream *s = proc_stream_get(proc, args[1], "process_read", ctx);
+    if (!s) {
+        return val_null();
+    }
+    int max = value_to_int(args[2]);
+    if (max <= 0) {
+        runtime_error(ctx, "process_read() max_bytes must be positive");
+        return val_null();
+    }
+    char *out = malloc((size_t)max + 1);
+    if (!out) {
+        runtime_error(ctx, "process_read() memory allocation failed");
+        return val_null();
+    }
+    ssize_t n = proc_stream_read(s, out, (size_t)max, value_to_int(args[3]));
+    if (n == -2) {
+        free(out);
+        return val_null();
+    }
+    if (n < 0) {
+        int saved = errno;
+        free(out);
+        runtime_error(ctx, "process_read() failed: %s", strerror(saved));
+        return val_null();
+    }
+    out[n] = '\0';
+    return val_string_take(out, (int)n, max + 1);
+}
+
+// __process_read_line(proc, stream) -> next line without "\n", null at EOF
+Value builtin_process_read_line(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2) {
+        runtime_error(ctx, "process_read_line() expects 2 arguments (process, stream)");
+        return val_null();
+    }
+    Process *proc = proc_get(args[0], "process_read_line", 0, ctx);
+    if (!proc) {
+        return val_null();
+    }
+    ProcStream *s = proc_stream_get(proc, args[1], "process_read_line", ctx);
+    if (!s) {
+        return val_null();
+    }
+    size_t len = 0;
+    int failed = 0;
+    char *line = proc_stream_line(s, &len, &failed);
+    if (failed) {
+        runtime_error(ctx, "process_read_line() failed: %s", strerror(errno));
+        return val_null();
+    }
+    if (!line) {
+        return val_null();
+    }
+    return val_string_take(line, (int)len, (int)len + 1);
+}
+
+// __process_write(proc, data): write a string or buffer to the child's stdin
+Value builtin_process_write(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2) {
+        runtime_error(ctx, "process_write() expects 2 arguments (process, data)");
+        return val_null();
+    }
+    Process *proc = proc_get(args[0], "process_write", 0, ctx);
+    if (!proc) {
+        return val_null();
+    }
+    const char *data;
+    size_t len;
+    if (args[1].type == VAL_STRING) {
+        data = args[1].as.as_string->data;
+        len = (size_t)args[1].as.as_string->length;
+    } else if (args[1].type == VAL_BUFFER) {
+        data = (const char*)args[1].as.as_buffer->data;
+        len = (size_t)args[1].as.as_buffer->length;
+    } else {
+        runtime_error(ctx, "process_write() data must be a string or buffer");
+        return val_null();
+    }
+    if (proc->in_fd < 0) {
+        runtime_error(ctx, "process_write() stdin is not an open pipe");
+        return val_null();
+    }
+    int rc = proc_write(proc, data, len);
+    if (rc != 0) {
+        runtime_error(ctx, "process_write() failed: %s", strerror(rc));
+    }
+    return val_null();
+}
+
+// __process_close_stdin(proc): send EOF to the child
+Value builtin_process_close_stdin(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "process_close_stdin() expects 1 argument (process)");
+        return val_null();
+    }
+    Process *proc = proc_get(args[0], "process_close_stdin", 1, ctx);
+    if (proc) {
+        proc_close_stdin(proc);
+    }
+    return val_null();
+}
+
+// __process_poll(procs, timeout_ms) -> [{ stdout, stderr }, ...]
+// Waits until any piped output of the given processes is readable (data or
+// EOF), at most timeout_ms (-1 waits forever), and reports which ones are
+Value builtin_process_poll(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2 || args[0].type != VAL_ARRAY || !is_integer(args[1])) {
+        runtime_error(ctx, "process_poll() expects 2 arguments (processes array, timeout_ms)");
+        return val_null();
+    }
+    Array *procs = args[0].as.as_array;
+    int count = procs->length;
+    Process **list = malloc(sizeof(Process*) * ((size_t)count + 1));
+    int *ready = malloc(sizeof(int) * ((size_t)count * 2 + 1));
+    if (!list || !ready) {
+        free(list);
+        free(ready);
+        runtime_error(ctx, "process_poll() memory allocation failed");
+        return val_null();
+    }
+    for (int i = 0; i < count; i++) {
+        list[i] = proc_get(procs->elements[i], "process_poll", 1, ctx);
+        if (!list[i]) {
+            free(list);
+            free(ready);
+            return val_null();
+        }
+    }
+    if (proc_poll(list, count, value_to_int(args[1]), ready) < 0) {
+        free(list);
+        free(ready);
+        runtime_error(ctx, "process_poll() memory allocation failed");
+        return val_null();
+    }
+    Array *result = array_new();
+    for (int i = 0; i < count; i++) {
+        Object *obj = object_new(NULL, 2);
+        proc_add_field(obj, "stdout", val_bool(ready[i * 2]));
+        proc_add_field(obj, "stderr", val_bool(ready[i * 2 + 1]));
+        array_push(result, val_object(obj));
+    }
+    free(list);
+    free(ready);
+    return val_array(result);
+}
+
+// __process_wait(proc, timeout_ms) -> { exit_code, signal }, or null if the
+// child is still running after timeout_ms (-1 waits forever)
+// exit_code is -1 when the child was killed by a signal
+Value builtin_process_wait(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2 || !is_integer(args[1])) {
+        runtime_error(ctx, "process_wait() expects 2 arguments (process, timeout_ms)");
+        return val_null();
+    }
+    Process *proc = proc_get(args[0], "process_wait", 1, ctx);
+    if (!proc) {
+        return val_null();
+    }
+    int r = proc_reap(proc, value_to_int(args[1]));
+    if (r < 0) {
+        runtime_error(ctx, "process_wait() failed: %s", strerror(errno));
+        return val_null();
+    }
+    if (r == 0) {
+        return val_null();
+    }
+    Object *obj = object_new(NULL, 2);
+    proc_add_status(obj, proc);
+    return val_object(obj);
+}
+
+// __process_kill(proc, signal): signal the child (a no-op once it is reaped)
+Value builtin_process_kill(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2 || !is_integer(args[1])) {
+        runtime_error(ctx, "process_kill() expects 2 arguments (process, signal)");
+        return val_null();
+    }
+    Process *proc = proc_get(args[0], "process_kill", 1, ctx);
+    if (proc && proc_kill(proc, value_to_int(args[1])) < 0) {
+        runtime_error(ctx, "process_kill() failed: %s", strerror(errno));
+    }
+    return val_null();
+}
+
+// __process_communicate(proc, input) -> { stdout, stderr, exit_code, signal }
+// Writes input (string, buffer or null) to stdin, closes it, reads both
+// output pipes to EOF and waits for the child to exit
+Value builtin_process_communicate(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2) {
+        runtime_error(ctx, "process_communicate() expects 2 arguments (process, input)");
+        return val_null();
+    }
+    Process *proc = proc_get(args[0], "process_communicate", 0, ctx);
+    if (!proc) {
+        return val_null();
+    }
+    const char *input = NULL;
+    size_t input_len = 0;
+    if (args[1].type == VAL_STRING) {
+        input = args[1].as.as_string->data;
+        input_len = (size_t)args[1].as.as_string->length;
+    } else if (args[1].type == VAL_BUFFER) {
+        input = (const char*)args[1].as.as_buffer->data;
+        input_len = (size_t)args[1].as.as_buffer->length;
+    } else if (args[1].type != VAL_NULL) {
+        runtime_error(ctx, "process_communicate() input must be a string, buffer or null");
+        return val_null();
+    }
+    if (input_len > 0 && proc->in_fd < 0) {
+        runtime_error(ctx, "process_communicate() stdin is not an open pipe");
+        return val_null();
+    }
+    ProcBuf out = {0}, err = {0};
+    int rc = proc_communicate(proc, input, input_len, &out, &err);
+    if (rc != 0) {
+        free(out.data);
+        free(err.data);
+        runtime_error(ctx, "process_communicate() failed: %s", strerror(rc));
+        return val_null();
+    }
+    Object *obj = object_new(NULL, 4);
+    proc_add_field(obj, "stdout", val_string_take(out.data, (int)out.len, (int)out.cap));
+    proc_add_field(obj, "stderr", val_string_take(err.data, (int)err.len, (int)err.cap));
+    proc_add_status(obj, proc);
+    return val_object(obj);
+}
+
+// __process_close(proc): close the pipes held by the parent. The child keeps
+// running; wait() and kill() still work afterwards.
+Value builtin_process_close(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "process_close() expects 1 argument (process)");
+        return val_null();
+    }
+    Process *proc = proc_get(args[0], "process_close", 1, ctx);
+    if (proc) {
+        proc_close(proc);
+    }
+    return val_null();
+}
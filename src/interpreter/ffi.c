@@ -37,9 +37,14 @@ typedef struct {
 static CallbackState g_callback_state = {NULL, 0, 0};
 static int g_next_callback_id = 1;
 
-// Thread-safety: Mutex for callback invocations
-// Note: Hemlock interpreter is not fully thread-safe, so callbacks must be serialized
-static pthread_mutex_t ffi_callback_mutex = PTHREAD_MUTEX_INITIALIZER;
+// Callbacks run on whichever thread C calls them from, like spawn'd tasks.
+// Each thread keeps one cached ExecutionContext for its callbacks.
+static pthread_key_t ffi_callback_ctx_key;
+static pthread_once_t ffi_callback_ctx_once = PTHREAD_ONCE_INIT;
+
+// A string returned to C points into a Hemlock string, which is kept alive
+// until the next string-returning callback on the same thread
+static __thread Value ffi_callback_string_result = { .type = VAL_NULL };
 
 // ========== PLATFORM-SPECIFIC LIBRARY PATH TRANSLATION ==========
 
@@ -187,115 +192,102 @@ ffi_type* hemlock_type_to_ffi_type(Type *type) {
 
 // ========== VALUE CONVERSION ==========
 
-void* hemlock_to_c_value(Value val, Type *type) {
-    size_t size = 0;
-    ffi_type *ffi_t = hemlock_type_to_ffi_type(type);
+// Argument frames up to this size live on the C stack during a call
+#define FFI_INLINE_FRAME_SIZE 256
+#define FFI_INLINE_MAX_ARGS 32
+
+// Return value storage: libffi widens small integral returns to ffi_arg
+typedef union {
+    ffi_arg u;
+    ffi_sarg s;
+    int64_t i64;
+    uint64_t u64;
+    float f32;
+    double f64;
+    void *ptr;
+} FFIReturnSlot;
+
+// Size (and alignment) of a marshalled argument
+static size_t ffi_kind_size(TypeKind kind) {
+    switch (kind) {
+        case TYPE_I8:  case TYPE_U8:  return 1;
+        case TYPE_I16: case TYPE_U16: return 2;
+        case TYPE_I32: case TYPE_U32: return 4;
+        case TYPE_I64: case TYPE_U64: return 8;
+        case TYPE_F32:    return sizeof(float);
+        case TYPE_F64:    return sizeof(double);
+        case TYPE_BOOL:   return sizeof(int);
+        default:          return sizeof(void*);  // ptr, string
+    }
+}
 
-    // Determine size
-    if (ffi_t == &ffi_type_sint8 || ffi_t == &ffi_type_uint8) size = 1;
-    else if (ffi_t == &ffi_type_sint16 || ffi_t == &ffi_type_uint16) size = 2;
-    else if (ffi_t == &ffi_type_sint32 || ffi_t == &ffi_type_uint32) size = 4;
-    else if (ffi_t == &ffi_type_sint64 || ffi_t == &ffi_type_uint64) size = 8;
-    else if (ffi_t == &ffi_type_sint || ffi_t == &ffi_type_uint) size = sizeof(int);
-    else if (ffi_t == &ffi_type_float) size = sizeof(float);
-    else if (ffi_t == &ffi_type_double) size = sizeof(double);
-    else if (ffi_t == &ffi_type_pointer) size = sizeof(void*);
-    else {
-        fprintf(stderr, "Error: Cannot determine size for FFI type\n");
-        exit(1);
+// Integer view of a numeric argument
+static int64_t ffi_int_arg(Value val) {
+    switch (val.type) {
+        case VAL_F32: return (int64_t)val.as.as_f32;
+        case VAL_F64: return (int64_t)val.as.as_f64;
+        case VAL_PTR: return (int64_t)(intptr_t)val.as.as_ptr;
+        case VAL_NULL: return 0;
+        default: return is_integer(val) || val.type == VAL_BOOL ? value_to_int64(val) : 0;
     }
+}
 
-    void *storage = malloc(size);
+// Float view of a numeric argument
+static double ffi_float_arg(Value val) {
+    if (is_numeric(val)) return value_to_float(val);
+    return 0.0;
+}
 
-    switch (type->kind) {
-        case TYPE_I8:
-            *(int8_t*)storage = val.as.as_i8;
-            break;
-        case TYPE_I16:
-            *(int16_t*)storage = val.as.as_i16;
-            break;
-        case TYPE_I32:
-            *(int32_t*)storage = val.as.as_i32;
-            break;
-        case TYPE_I64:
-            *(int64_t*)storage = val.as.as_i64;
-            break;
-        case TYPE_U8:
-            *(uint8_t*)storage = val.as.as_u8;
-            break;
-        case TYPE_U16:
-            *(uint16_t*)storage = val.as.as_u16;
-            break;
-        case TYPE_U32:
-            *(uint32_t*)storage = val.as.as_u32;
-            break;
-        case TYPE_U64:
-            *(uint64_t*)storage = val.as.as_u64;
-            break;
-        case TYPE_F32:
-            *(float*)storage = val.as.as_f32;
-            break;
-        case TYPE_F64:
-            *(double*)storage = val.as.as_f64;
-            break;
+// Marshal one argument into its slot in the call frame.
+// Returns 0 if the value cannot be passed as the declared type.
+static int ffi_store_arg(Value val, TypeKind kind, void *slot) {
+    switch (kind) {
+        case TYPE_I8:   *(int8_t*)slot = (int8_t)ffi_int_arg(val); break;
+        case TYPE_I16:  *(int16_t*)slot = (int16_t)ffi_int_arg(val); break;
+        case TYPE_I32:  *(int32_t*)slot = (int32_t)ffi_int_arg(val); break;
+        case TYPE_I64:  *(int64_t*)slot = ffi_int_arg(val); break;
+        case TYPE_U8:   *(uint8_t*)slot = (uint8_t)ffi_int_arg(val); break;
+        case TYPE_U16:  *(uint16_t*)slot = (uint16_t)ffi_int_arg(val); break;
+        case TYPE_U32:  *(uint32_t*)slot = (uint32_t)ffi_int_arg(val); break;
+        case TYPE_U64:  *(uint64_t*)slot = val.type == VAL_U64 ? val.as.as_u64 : (uint64_t)ffi_int_arg(val); break;
+        case TYPE_F32:  *(float*)slot = (float)ffi_float_arg(val); break;
+        case TYPE_F64:  *(double*)slot = ffi_float_arg(val); break;
+        case TYPE_BOOL: *(int*)slot = value_is_truthy(val) ? 1 : 0; break;
         case TYPE_PTR:
-            *(void**)storage = val.as.as_ptr;
+            if (val.type == VAL_PTR) *(void**)slot = val.as.as_ptr;
+            else if (val.type == VAL_BUFFER) *(void**)slot = val.as.as_buffer->data;
+            else if (val.type == VAL_NULL) *(void**)slot = NULL;
+            else if (is_integer(val)) *(void**)slot = (void*)(intptr_t)value_to_int64(val);
+            else return 0;
             break;
         case TYPE_STRING:
-            *(char**)storage = val.as.as_string->data;
-            break;
-        case TYPE_BOOL:
-            *(int*)storage = val.as.as_bool ? 1 : 0;
+            if (val.type == VAL_STRING) *(char**)slot = val.as.as_string->data;
+            else if (val.type == VAL_NULL) *(char**)slot = NULL;
+            else return 0;
             break;
         default:
-            fprintf(stderr, "Error: Cannot convert Hemlock type to C: %d\n", type->kind);
-            exit(1);
+            return 0;
     }
-
-    return storage;
+    return 1;
 }
 
-Value c_to_hemlock_value(void *c_value, Type *type) {
-    if (type == NULL || type->kind == TYPE_VOID) {
-        return val_null();
-    }
-
-    switch (type->kind) {
-        case TYPE_I8:
-            return val_i8(*(int8_t*)c_value);
-        case TYPE_I16:
-            return val_i16(*(int16_t*)c_value);
-        case TYPE_I32:
-            return val_i32(*(int32_t*)c_value);
-        case TYPE_I64:
-            return val_i64(*(int64_t*)c_value);
-        case TYPE_U8:
-            return val_u8(*(uint8_t*)c_value);
-        case TYPE_U16:
-            return val_u16(*(uint16_t*)c_value);
-        case TYPE_U32:
-            return val_u32(*(uint32_t*)c_value);
-        case TYPE_U64:
-            return val_u64(*(uint64_t*)c_value);
-        case TYPE_F32:
-            return val_f32(*(float*)c_value);
-        case TYPE_F64:
-            return val_f64(*(double*)c_value);
-        case TYPE_PTR:
-            return val_ptr(*(void**)c_value);
-        case TYPE_BOOL:
-            return val_bool(*(int*)c_value != 0);
-        case TYPE_STRING: {
-            char *str = *(char**)c_value;
-            if (str == NULL) {
-                return val_null();
-            }
-            // Create a Hemlock string from the C string
-            return val_string(str);
-        }
-        default:
-            fprintf(stderr, "Error: Cannot convert C type to Hemlock: %d\n", type->kind);
-            exit(1);
+// Convert a C return value to a Hemlock value
+static Value ffi_load_return(FFIReturnSlot *ret, TypeKind kind) {
+    switch (kind) {
+        case TYPE_I8:     return val_i8((int8_t)ret->s);
+        case TYPE_I16:    return val_i16((int16_t)ret->s);
+        case TYPE_I32:    return val_i32((int32_t)ret->s);
+        case TYPE_I64:    return val_i64(ret->i64);
+        case TYPE_U8:     return val_u8((uint8_t)ret->u);
+        case TYPE_U16:    return val_u16((uint16_t)ret->u);
+        case TYPE_U32:    return val_u32((uint32_t)ret->u);
+        case TYPE_U64:    return val_u64(ret->u64);
+        case TYPE_F32:    return val_f32(ret->f32);
+        case TYPE_F64:    return val_f64(ret->f64);
+        case TYPE_PTR:    return val_ptr(ret->ptr);
+        case TYPE_BOOL:   return val_bool((int)ret->s != 0);
+        case TYPE_STRING: return ret->ptr ? val_string((char*)ret->ptr) : val_null();
+        default:          return val_null();
     }
 }
 
@@ -324,6 +316,7 @@ FFIFunction* ffi_declare_function(
     // Create FFI function
     FFIFunction *func = malloc(sizeof(FFIFunction));
     func->name = strdup(name);
+    func->library_path = lib->path;
     func->func_ptr = func_ptr;
     func->hemlock_params = param_types;
     func->num_params = num_params;
@@ -343,6 +336,22 @@ FFIFunction* ffi_declare_function(
     ffi_type *return_type_ffi = hemlock_type_to_ffi_type(return_type);
     func->return_type = return_type_ffi;
 
+    // Build the marshalling plan: one converter per argument plus its
+    // naturally aligned offset in the per-call argument frame
+    func->arg_kinds = malloc(sizeof(TypeKind) * (num_params > 0 ? num_params : 1));
+    func->arg_offsets = malloc(sizeof(size_t) * (num_params > 0 ? num_params : 1));
+    size_t offset = 0;
+    for (int i = 0; i < num_params; i++) {
+        TypeKind kind = param_types[i]->kind;
+        size_t size = ffi_kind_size(kind);
+        offset = (offset + size - 1) & ~(size - 1);
+        func->arg_kinds[i] = kind;
+        func->arg_offsets[i] = offset;
+        offset += size;
+    }
+    func->frame_size = offset;
+    func->return_kind = return_type ? return_type->kind : TYPE_VOID;
+
     // Prepare libffi call interface
     ffi_status status = ffi_prep_cif(
         cif,
@@ -358,6 +367,8 @@ FFIFunction* ffi_declare_function(
         snprintf(err, sizeof(err), "Failed to prepare FFI call interface for '%s'", name);
         ctx->exception_state.exception_value = val_string(err);
         free(func->arg_types);
+        free(func->arg_kinds);
+        free(func->arg_offsets);
         free(func->name);
         free(func);
         return NULL;
@@ -371,6 +382,8 @@ void ffi_free_function(FFIFunction *func) {
     free(func->name);
     if (func->cif) free(func->cif);
     if (func->arg_types) free(func->arg_types);
+    free(func->arg_kinds);
+    free(func->arg_offsets);
     // Note: hemlock_params and hemlock_return are managed by AST
     free(func);
 }
@@ -388,53 +401,42 @@ Value ffi_call_function(FFIFunction *func, Value *args, int num_args, ExecutionC
         return val_null();
     }
 
-    // Convert Hemlock values to C values
-    void **arg_values = malloc(sizeof(void*) * num_args);
-    void **arg_storage = malloc(sizeof(void*) * num_args);
-
-    for (int i = 0; i < num_args; i++) {
-        arg_storage[i] = hemlock_to_c_value(args[i], func->hemlock_params[i]);
-        arg_values[i] = arg_storage[i];
+    // Marshal arguments into a stack frame following the precomputed plan;
+    // only unusually large signatures fall back to the heap
+    _Alignas(16) unsigned char inline_frame[FFI_INLINE_FRAME_SIZE];
+    void *inline_values[FFI_INLINE_MAX_ARGS];
+    unsigned char *frame = inline_frame;
+    void **arg_values = inline_values;
+    if (func->frame_size > FFI_INLINE_FRAME_SIZE || num_args > FFI_INLINE_MAX_ARGS) {
+        frame = malloc(func->frame_size);
+        arg_values = malloc(sizeof(void*) * num_args);
     }
 
-    // Prepare return value storage
-    void *return_storage = NULL;
-    if (func->hemlock_return != NULL && func->hemlock_return->kind != TYPE_VOID) {
-        // Allocate enough space for the return value
-        size_t return_size = 8;  // Default to pointer size
-        ffi_type *ret_type = (ffi_type*)func->return_type;
-        if (ret_type == &ffi_type_sint8 || ret_type == &ffi_type_uint8) return_size = 1;
-        else if (ret_type == &ffi_type_sint16 || ret_type == &ffi_type_uint16) return_size = 2;
-        else if (ret_type == &ffi_type_sint32 || ret_type == &ffi_type_uint32) return_size = 4;
-        else if (ret_type == &ffi_type_float) return_size = sizeof(float);
-        else if (ret_type == &ffi_type_double) return_size = sizeof(double);
-
-        return_storage = malloc(return_size);
+    for (int i = 0; i < num_args; i++) {
+        void *slot = frame + func->arg_offsets[i];
+        if (!ffi_store_arg(args[i], func->arg_kinds[i], slot)) {
+            if (frame != inline_frame) {
+                free(frame);
+                free(arg_values);
+            }
+            runtime_error(ctx, "FFI function '%s': invalid value for argument %d",
+                          func->name, i + 1);
+            return val_null();
+        }
+        arg_values[i] = slot;
     }
 
     // Call via libffi
-    ffi_cif *cif = (ffi_cif*)func->cif;
-    ffi_call(cif, FFI_FN(func->func_ptr), return_storage, arg_values);
-
-    // Convert return value
-    Value result;
-    if (func->hemlock_return == NULL || func->hemlock_return->kind == TYPE_VOID) {
-        result = val_null();
-    } else {
-        result = c_to_hemlock_value(return_storage, func->hemlock_return);
-    }
+    FFIReturnSlot ret;
+    ret.u64 = 0;
+    ffi_call((ffi_cif*)func->cif, FFI_FN(func->func_ptr), &ret, arg_values);
 
-    // Cleanup
-    for (int i = 0; i < num_args; i++) {
-        free(arg_storage[i]);
-    }
-    free(arg_values);
-    free(arg_storage);
-    if (return_storage != NULL) {
-        free(return_storage);
+    if (frame != inline_frame) {
+        free(frame);
+        free(arg_values);
     }
 
-    return result;
+    return ffi_load_return(&ret, func->return_kind);
 }
 
 // ========== FFI CALLBACKS ==========
@@ -536,16 +538,59 @@ static void hemlock_to_c_storage(Value val, Type *type, void *storage) {
 }
 
 // Universal callback handler - this is called by libffi when C code invokes the callback
+static void ffi_callback_ctx_destroy(void *ptr) {
+    exec_context_free((ExecutionContext*)ptr);
+    value_release(ffi_callback_string_result);
+    ffi_callback_string_result = val_null();
+}
+
+static void ffi_callback_ctx_key_init(void) {
+    pthread_key_create(&ffi_callback_ctx_key, ffi_callback_ctx_destroy);
+}
+
+// Take this thread's cached callback context. While a callback runs the slot
+// is empty, so a nested callback on the same thread gets a fresh context.
+static ExecutionContext* ffi_callback_ctx_acquire(void) {
+    pthread_once(&ffi_callback_ctx_once, ffi_callback_ctx_key_init);
+    ExecutionContext *ctx = pthread_getspecific(ffi_callback_ctx_key);
+    if (ctx) {
+        pthread_setspecific(ffi_callback_ctx_key, NULL);
+        return ctx;
+    }
+    return exec_context_new();
+}
+
+// Release what the callback left in its context, then reset the context and
+// put it back in the thread's slot
+static void ffi_callback_ctx_release(ExecutionContext *ctx) {
+    value_release(ctx->return_state.return_value);
+    if (ctx->exception_state.is_throwing) {
+        value_release(ctx->exception_state.exception_value);
+    }
+    while (ctx->call_stack.count > 0) {
+        call_stack_pop(&ctx->call_stack);
+    }
+    if (pthread_getspecific(ffi_callback_ctx_key) != NULL) {
+        exec_context_free(ctx);
+        return;
+    }
+    ctx->return_state.is_returning = 0;
+    ctx->return_state.return_value = val_null();
+    ctx->loop_state.is_breaking = 0;
+    ctx->loop_state.is_continuing = 0;
+    ctx->exception_state.is_throwing = 0;
+    ctx->exception_state.exception_value = val_null();
+    pthread_setspecific(ffi_callback_ctx_key, ctx);
+}
+
 static void ffi_callback_handler(ffi_cif *cif, void *ret, void **args, void *user_data) {
     (void)cif;  // Unused parameter
     FFICallback *cb = (FFICallback *)user_data;
     Function *fn = cb->hemlock_fn;
 
-    // Lock to ensure thread-safety (Hemlock interpreter is not fully thread-safe)
-    pthread_mutex_lock(&ffi_callback_mutex);
-
-    // Create a fresh execution context for this callback invocation
-    ExecutionContext *ctx = exec_context_new();
+    // No global lock: the callback runs on the calling thread under the same
+    // rules as a spawn'd task (shared closure environment, private context)
+    ExecutionContext *ctx = ffi_callback_ctx_acquire();
 
     // Create a new environment with the function's closure as parent
     Environment *func_env = env_new(fn->closure_env);
@@ -556,27 +601,35 @@ static void ffi_callback_handler(ffi_cif *cif, void *ret, void **args, void *use
         env_define(func_env, fn->param_names[i], arg, 0, ctx);
     }
 
-    // Execute the Hemlock function body
-    eval_stmt(fn->body, func_env, ctx);
+    // Execute the Hemlock function body, then its deferred calls
+    eval_stmt(function_body(fn, ctx), func_env, ctx);
+    if (ctx->defer_stack.count > 0) {
+        defer_stack_execute(&ctx->defer_stack, ctx);
+    }
 
     // Handle return value
     if (ctx->return_state.is_returning && cb->hemlock_return != NULL && cb->hemlock_return->kind != TYPE_VOID) {
         Value result = ctx->return_state.return_value;
         hemlock_to_c_storage(result, cb->hemlock_return, ret);
+        if (cb->hemlock_return->kind == TYPE_STRING) {
+            value_retain(result);
+            value_release(ffi_callback_string_result);
+            ffi_callback_string_result = result;
+        }
     }
 
-    // Handle exceptions - we can't propagate them to C, so just print a warning
+    // Handle exceptions - we can't propagate them to C, so report them like
+    // an uncaught exception without exiting
     if (ctx->exception_state.is_throwing) {
-        fprintf(stderr, "Warning: Exception in FFI callback (cannot propagate to C): ");
-        print_value(ctx->exception_state.exception_value);
-        fprintf(stderr, "\n");
+        char *msg = value_to_string(ctx->exception_state.exception_value);
+        fprintf(stderr, "Warning: Exception in FFI callback (cannot propagate to C): %s\n", msg);
+        free(msg);
+        call_stack_print(&ctx->call_stack);
     }
 
     // Cleanup
     env_release(func_env);
-    exec_context_free(ctx);
-
-    pthread_mutex_unlock(&ffi_callback_mutex);
+    ffi_callback_ctx_release(ctx);
 }
 
 // Create a C-callable function pointer from a Hemlock function
@@ -160,6 +160,7 @@ Value val_object(Object *obj);
 void function_free(Function *fn);
 void function_retain(Function *fn);
 void function_release(Function *fn);
+Stmt* function_body(Function *fn, ExecutionContext *ctx);
 
 // File operations
 Value val_file(FileHandle *file);
@@ -212,6 +213,10 @@ Value check_object_type(Value value, ObjectType *object_type, Environment *env,
 
 void register_builtins(Environment *env, int argc, char **argv, ExecutionContext *ctx);
 
+// Name of a registered builtin and back (NULL if unknown)
+const char* builtin_name(BuiltinFn fn);
+BuiltinFn builtin_lookup(const char *name);
+
 // Concurrency builtins (needed for await implementation)
 Value builtin_join(Value *args, int num_args, ExecutionContext *ctx);
 
@@ -236,6 +241,7 @@ Value call_socket_method(SocketHandle *sock, const char *method, Value *args, in
 Value call_array_method(Array *arr, const char *method, Value *args, int num_args, ExecutionContext *ctx);
 Value call_string_method(String *str, const char *method, Value *args, int num_args, ExecutionContext *ctx);
 Value call_channel_method(Channel *ch, const char *method, Value *args, int num_args, ExecutionContext *ctx);
+int channel_try_recv(Channel *ch, Value *out);  // Non-blocking receive (used by the event loop)
 Value call_object_method(Object *obj, const char *method, Value *args, int num_args, ExecutionContext *ctx);
 
 // Property accessors
@@ -254,6 +260,7 @@ typedef struct FFILibrary FFILibrary;
 // External function structure
 typedef struct {
     char *name;              // Function name
+    const char *library_path;  // Library it was found in (owned by the library)
     void *func_ptr;          // Function pointer from dlsym()
     void *cif;               // ffi_cif (opaque)
     void **arg_types;        // libffi argument types (opaque)
@@ -261,6 +268,11 @@ typedef struct {
     Type **hemlock_params;   // Hemlock parameter types
     Type *hemlock_return;    // Hemlock return type
     int num_params;
+    // Marshalling plan (computed once at declaration)
+    TypeKind *arg_kinds;     // Converter for each argument
+    size_t *arg_offsets;     // Offset of each argument in the call frame
+    size_t frame_size;       // Bytes of argument storage per call
+    TypeKind return_kind;    // Converter for the return value
 } FFIFunction;
 
 // FFI Callback structure - wraps a Hemlock function as a C function pointer
@@ -320,8 +332,15 @@ const char* get_current_source_file(void);
 void defer_stack_init(DeferStack *stack);
 void defer_stack_push(DeferStack *stack, Expr *call, Environment *env);
 void defer_stack_execute(DeferStack *stack, ExecutionContext *ctx);
+void defer_stack_unwind(ExecutionContext *ctx, int depth);
 void defer_stack_free(DeferStack *stack);
 
+// Call a Hemlock function from native code (callbacks). Parameters without
+// an argument take their default value, or null; extra arguments are
+// ignored. The function's defers run before it returns. The result is the
+// returned value (null when nothing was returned or it threw).
+Value call_function_value(Value func, Value *args, int num_args, ExecutionContext *ctx);
+
 // Runtime error with exception support (printf-style)
 // Now throws catchable exceptions when ctx is provided
 void runtime_error(ExecutionContext *ctx, const char *format, ...);
@@ -18,8 +18,8 @@ static Value throw_runtime_error(ExecutionContext *ctx, const char *format, ...)
 
 // ========== FUNCTION CALL HELPER ==========
 
-// Helper to call a function value with given arguments
-static Value call_function_value(Value func, Value *args, int num_args, ExecutionContext *ctx) {
+// Call a callback with exactly the arguments it declares
+static Value call_callback(Value func, Value *args, int num_args, ExecutionContext *ctx) {
     if (func.type != VAL_FUNCTION) {
         return throw_runtime_error(ctx, "Callback must be a function");
     }
@@ -32,41 +32,7 @@ static Value call_function_value(Value func, Value *args, int num_args, Executio
                 fn->num_params, num_args);
     }
 
-    // Create call environment with closure_env as parent
-    Environment *call_env = env_new(fn->closure_env);
-
-    // Bind parameters
-    for (int i = 0; i < fn->num_params; i++) {
-        Value arg_value = args[i];
-
-        // Type check if parameter has type annotation
-        if (fn->param_types[i]) {
-            arg_value = convert_to_type(arg_value, fn->param_types[i], call_env, ctx);
-            if (ctx->exception_state.is_throwing) {
-                env_release(call_env);
-                return val_null();
-            }
-        }
-
-        env_set(call_env, fn->param_names[i], arg_value, ctx);
-        if (ctx->exception_state.is_throwing) {
-            env_release(call_env);
-            return val_null();
-        }
-    }
-
-    // Execute body
-    ctx->return_state.is_returning = 0;
-    eval_stmt(fn->body, call_env, ctx);
-
-    // Get return value
-    Value result = ctx->return_state.is_returning ? ctx->return_state.return_value : val_null();
-    ctx->return_state.is_returning = 0;
-
-    // Clean up
-    env_release(call_env);
-
-    return result;
+    return call_function_value(func, args, num_args, ctx);
 }
 
 // ========== ARRAY METHOD HANDLING ==========
@@ -479,7 +445,7 @@ Value call_array_method(Array *arr, const char *method, Value *args, int num_arg
             callback_args[1] = val_i32(i);
 
             // Call the callback function
-            Value mapped = call_function_value(args[0], callback_args, 1, ctx);
+            Value mapped = call_callback(args[0], callback_args, 1, ctx);
             if (ctx->exception_state.is_throwing) {
                 // Clean up and propagate exception
                 return val_null();
@@ -509,7 +475,7 @@ Value call_array_method(Array *arr, const char *method, Value *args, int num_arg
             callback_args[1] = val_i32(i);
 
             // Call the predicate function
-            Value predicate_result = call_function_value(args[0], callback_args, 1, ctx);
+            Value predicate_result = call_callback(args[0], callback_args, 1, ctx);
             if (ctx->exception_state.is_throwing) {
                 // Clean up and propagate exception
                 return val_null();
@@ -565,7 +531,7 @@ Value call_array_method(Array *arr, const char *method, Value *args, int num_arg
             reducer_args[2] = val_i32(i);
 
             // Call the reducer function
-            Value new_accumulator = call_function_value(args[0], reducer_args, 2, ctx);
+            Value new_accumulator = call_callback(args[0], reducer_args, 2, ctx);
             if (ctx->exception_state.is_throwing) {
                 value_release(accumulator);
                 return val_null();
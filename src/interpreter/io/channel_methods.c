@@ -2,6 +2,8 @@
 #include <stdarg.h>
 #include <errno.h>
 #include <time.h>
+#include <unistd.h>
+#include <stdint.h>
 
 // ========== RUNTIME ERROR HELPER ==========
 
@@ -18,6 +20,44 @@ static Value throw_runtime_error(ExecutionContext *ctx, const char *format, ...)
     return val_null();
 }
 
+// ========== EVENT LOOP NOTIFICATION ==========
+
+// Wake an event loop watching this channel. Must be called with the channel mutex held.
+static void channel_notify(Channel *ch) {
+    if (ch->notify_fd >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = write(ch->notify_fd, &one, sizeof(one));
+        (void)ignored;  // EAGAIN just means a wakeup is already pending
+    }
+}
+
+// Non-blocking receive used by the event loop.
+// Returns 1 and stores the message in *out if one was available, 0 otherwise.
+int channel_try_recv(Channel *ch, Value *out) {
+    pthread_mutex_t *mutex = (pthread_mutex_t*)ch->mutex;
+    int got = 0;
+
+    pthread_mutex_lock(mutex);
+    if (ch->capacity == 0) {
+        if (ch->sender_waiting) {
+            *out = *(ch->unbuffered_value);
+            *(ch->unbuffered_value) = val_null();
+            ch->sender_waiting = 0;
+            pthread_cond_signal((pthread_cond_t*)ch->rendezvous);
+            got = 1;
+        }
+    } else if (ch->count > 0) {
+        *out = ch->buffer[ch->head];
+        ch->head = (ch->head + 1) % ch->capacity;
+        ch->count--;
+        pthread_cond_signal((pthread_cond_t*)ch->not_full);
+        got = 1;
+    }
+    pthread_mutex_unlock(mutex);
+
+    return got;
+}
+
 // ========== CHANNEL METHODS ==========
 
 Value call_channel_method(Channel *ch, const char *method, Value *args, int num_args, ExecutionContext *ctx) {
@@ -50,6 +90,7 @@ Value call_channel_method(Channel *ch, const char *method, Value *args, int num_
 
             // Signal any waiting receiver that data is available
             pthread_cond_signal(not_empty);
+            channel_notify(ch);
 
             // Wait for receiver to pick up the value
             while (ch->sender_waiting && !ch->closed) {
@@ -88,6 +129,7 @@ Value call_channel_method(Channel *ch, const char *method, Value *args, int num_
 
         // Signal that buffer is not empty
         pthread_cond_signal(not_empty);
+        channel_notify(ch);
         pthread_mutex_unlock(mutex);
 
         return val_null();
@@ -262,6 +304,7 @@ Value call_channel_method(Channel *ch, const char *method, Value *args, int num_
 
         // Signal that buffer is not empty
         pthread_cond_signal(not_empty);
+        channel_notify(ch);
         pthread_mutex_unlock(mutex);
 
         return val_bool(1);  // Success
@@ -282,6 +325,7 @@ Value call_channel_method(Channel *ch, const char *method, Value *args, int num_
         pthread_cond_broadcast(not_full);
         // Also wake up any unbuffered channel senders waiting on rendezvous
         pthread_cond_broadcast(rendezvous);
+        channel_notify(ch);
         pthread_mutex_unlock(mutex);
 
         return val_null();
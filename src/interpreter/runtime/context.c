@@ -209,6 +209,24 @@ void defer_stack_execute(DeferStack *stack, ExecutionContext *ctx) {
     stack->count = 0;
 }
 
+// Run the defers pushed since the stack held depth entries (a function's own
+// defers, in LIFO order) and drop them
+void defer_stack_unwind(ExecutionContext *ctx, int depth) {
+    if (ctx->defer_stack.count <= depth) {
+        return;
+    }
+
+    // A view of just the entries above depth
+    DeferStack local_defers;
+    local_defers.count = ctx->defer_stack.count - depth;
+    local_defers.capacity = local_defers.count;
+    local_defers.calls = &ctx->defer_stack.calls[depth];
+    local_defers.envs = &ctx->defer_stack.envs[depth];
+
+    defer_stack_execute(&local_defers, ctx);
+    ctx->defer_stack.count = depth;
+}
+
 void defer_stack_free(DeferStack *stack) {
     // Free any remaining deferred calls (shouldn't happen in normal execution)
     for (int i = 0; i < stack->count; i++) {
@@ -223,6 +241,53 @@ void defer_stack_free(DeferStack *stack) {
     stack->capacity = 0;
 }
 
+// ========== CALLING FUNCTIONS FROM NATIVE CODE ==========
+
+Value call_function_value(Value func, Value *args, int num_args, ExecutionContext *ctx) {
+    if (func.type != VAL_FUNCTION) {
+        runtime_error(ctx, "Value is not a function");
+        return val_null();
+    }
+
+    Function *fn = func.as.as_function;
+    Environment *call_env = env_new(fn->closure_env);
+
+    // Bind parameters: missing arguments take their default, or null
+    for (int i = 0; i < fn->num_params; i++) {
+        Value arg_value = val_null();
+        if (i < num_args) {
+            arg_value = args[i];
+            if (fn->param_types[i]) {
+                arg_value = convert_to_type(arg_value, fn->param_types[i], call_env, ctx);
+            }
+        } else if (fn->param_defaults && fn->param_defaults[i]) {
+            arg_value = eval_expr(fn->param_defaults[i], fn->closure_env, ctx);
+        }
+        if (ctx->exception_state.is_throwing) {
+            env_release(call_env);
+            return val_null();
+        }
+
+        env_set(call_env, fn->param_names[i], arg_value, ctx);
+        if (ctx->exception_state.is_throwing) {
+            env_release(call_env);
+            return val_null();
+        }
+    }
+
+    // Execute body, then its defers (even if it threw)
+    int defer_depth_before = ctx->defer_stack.count;
+    ctx->return_state.is_returning = 0;
+    eval_stmt(function_body(fn, ctx), call_env, ctx);
+    defer_stack_unwind(ctx, defer_depth_before);
+
+    Value result = ctx->return_state.is_returning ? ctx->return_state.return_value : val_null();
+    ctx->return_state.is_returning = 0;
+
+    env_release(call_env);
+    return result;
+}
+
 // Runtime error with stack trace
 void runtime_error(ExecutionContext *ctx, const char *format, ...) {
     char buffer[512];
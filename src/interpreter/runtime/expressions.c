@@ -907,8 +907,30 @@ Value eval_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
                 }
             }
 
-            // Evaluate the function expression
-            Value func = eval_expr(expr->as.call.func, env, ctx);
+            // Evaluate the function expression. For methods on objects, look the
+            // method up on the receiver evaluated above: evaluating the object
+            // expression again would repeat its side effects (e.g. a.b().c()).
+            Value func = {0};
+            int method_found = 0;
+            if (is_method_call && method_self.type == VAL_OBJECT) {
+                Object *obj = method_self.as.as_object;
+                const char *method = expr->as.call.func->as.get_property.property;
+                for (int i = 0; i < obj->num_fields; i++) {
+                    if (strcmp(obj->field_names[i], method) == 0) {
+                        func = obj->field_values[i];
+                        value_retain(func);
+                        method_found = 1;
+                        break;
+                    }
+                }
+                if (!method_found) {
+                    runtime_error(ctx, "Object has no field '%s'", method);
+                    value_release(method_self);
+                    return val_null();
+                }
+            } else {
+                func = eval_expr(expr->as.call.func, env, ctx);
+            }
 
             // Evaluate arguments
             Value *args = NULL;
@@ -1031,30 +1053,17 @@ Value eval_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
 
                 // Execute body
                 ctx->return_state.is_returning = 0;
-                eval_stmt(fn->body, call_env, ctx);
+                eval_stmt(function_body(fn, ctx), call_env, ctx);
 
                 // Execute deferred calls (in LIFO order) before returning
                 // This happens even if there was an exception
-                if (ctx->defer_stack.count > defer_depth_before) {
-                    // Create a temporary defer stack with just this function's defers
-                    DeferStack local_defers;
-                    local_defers.count = ctx->defer_stack.count - defer_depth_before;
-                    local_defers.capacity = local_defers.count;
-                    local_defers.calls = &ctx->defer_stack.calls[defer_depth_before];
-                    local_defers.envs = &ctx->defer_stack.envs[defer_depth_before];
-
-                    // Execute the defers
-                    defer_stack_execute(&local_defers, ctx);
-
-                    // Restore defer stack to pre-function depth
-                    ctx->defer_stack.count = defer_depth_before;
-                }
+                defer_stack_unwind(ctx, defer_depth_before);
 
                 // Get result
                 result = ctx->return_state.return_value;
 
-                // Check return type if specified
-                if (fn->return_type) {
+                // Check return type if specified (an exception in flight has no result to check)
+                if (fn->return_type && !ctx->exception_state.is_throwing) {
                     if (!ctx->return_state.is_returning) {
                         runtime_error(ctx, "Function with return type must return a value");
                     }
@@ -1408,6 +1417,7 @@ Value eval_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
 
             // Store body AST (shared, not copied)
             fn->body = expr->as.function.body;
+            fn->lazy_body = expr->as.function.lazy_body;
 
             // CRITICAL: Capture current environment and retain it
             fn->closure_env = env;
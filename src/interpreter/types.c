@@ -384,7 +384,7 @@ Value promote_value(Value val, ValueType target_type) {
             } else if (val.type == VAL_U64) {
                 return val_i64((int64_t)val.as.as_u64);
             } else {
-                return val_i64((int64_t)value_to_int(val));
+                return val_i64(value_to_int64(val));
             }
         case VAL_U8: return val_u8((uint8_t)value_to_int(val));
         case VAL_U16: return val_u16((uint16_t)value_to_int(val));
@@ -398,19 +398,19 @@ Value promote_value(Value val, ValueType target_type) {
             } else if (val.type == VAL_I64) {
                 return val_u64((uint64_t)val.as.as_i64);
             } else {
-                return val_u64((uint64_t)value_to_int(val));
+                return val_u64((uint64_t)value_to_int64(val));
             }
         case VAL_F32:
             if (is_float(val)) {
                 return val_f32((float)value_to_float(val));
             } else {
-                return val_f32((float)value_to_int(val));
+                return val_f32((float)value_to_int64(val));
             }
         case VAL_F64:
             if (is_float(val)) {
                 return val_f64(value_to_float(val));
             } else {
-                return val_f64((double)value_to_int(val));
+                return val_f64((double)value_to_int64(val));
             }
         default:
             fprintf(stderr, "Runtime error: Cannot promote to type\n");
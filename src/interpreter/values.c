@@ -1,4 +1,5 @@
 #include "internal.h"
+#include "ast_serialize.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -442,6 +443,22 @@ void object_release(Object *obj) {
 
 // ========== FUNCTION OPERATIONS ==========
 
+// Body of a user function; bodies loaded lazily from a .hmlc image are
+// decoded on first call
+Stmt* function_body(Function *fn, ExecutionContext *ctx) {
+    if (fn->body) {
+        return fn->body;
+    }
+    Stmt *body = fn->lazy_body ? lazy_body_load(fn->lazy_body) : NULL;
+    if (!body) {
+        // Run an empty body so the error unwinds like any other
+        static Stmt empty_body = { .type = STMT_BLOCK };
+        runtime_error(ctx, "Corrupt function body in compiled code");
+        return &empty_body;
+    }
+    return body;
+}
+
 void function_free(Function *fn) {
     if (!fn) return;
 
@@ -672,6 +689,7 @@ Channel* channel_new(int capacity) {
     }
     ch->sender_waiting = 0;
     ch->receiver_waiting = 0;
+    ch->notify_fd = -1;
 
     return ch;
 }
@@ -5,6 +5,7 @@
 #include "handlers.h"
 #include "lsp.h"
 #include "protocol.h"
+#include "index.h"
 
 #include "../../include/lexer.h"
 #include "../../include/parser.h"
@@ -39,6 +40,13 @@ JSONValue *handle_initialize(LSPServer *server, JSONValue *params) {
     const char *root_path = json_object_get_string(params, "rootPath");
     if (root_path) {
         server->root_path = strdup(root_path);
+    } else if (root_uri) {
+        server->root_path = lsp_uri_to_path(root_uri);
+    }
+
+    // Index the workspace and the stdlib in the background
+    if (!server->index) {
+        server->index = lsp_index_create(server->root_path);
     }
 
     // Build server capabilities response
@@ -46,8 +54,14 @@ JSONValue *handle_initialize(LSPServer *server, JSONValue *params) {
 
     JSONValue *server_capabilities = json_object();
 
-    // Text document sync - full sync mode
-    json_object_set(server_capabilities, "textDocumentSync", json_number(1));
+    // Text document sync - incremental, with save notifications
+    JSONValue *sync_options = json_object();
+    json_object_set(sync_options, "openClose", json_bool(true));
+    json_object_set(sync_options, "change", json_number(2));
+    JSONValue *save_options = json_object();
+    json_object_set(save_options, "includeText", json_bool(false));
+    json_object_set(sync_options, "save", save_options);
+    json_object_set(server_capabilities, "textDocumentSync", sync_options);
 
     // Hover support
     json_object_set(server_capabilities, "hoverProvider", json_bool(true));
@@ -59,8 +73,10 @@ JSONValue *handle_initialize(LSPServer *server, JSONValue *params) {
     json_object_set(completion_options, "triggerCharacters", trigger_chars);
     json_object_set(server_capabilities, "completionProvider", completion_options);
 
-    // Go to definition support
+    // Go to definition, references and workspace symbols (workspace index)
     json_object_set(server_capabilities, "definitionProvider", json_bool(true));
+    json_object_set(server_capabilities, "referencesProvider", json_bool(true));
+    json_object_set(server_capabilities, "workspaceSymbolProvider", json_bool(true));
 
     // Document symbol support
     json_object_set(server_capabilities, "documentSymbolProvider", json_bool(true));
@@ -121,6 +137,15 @@ void handle_did_open(LSPServer *server, JSONValue *params) {
 
     // Publish diagnostics
     lsp_publish_diagnostics(server, doc);
+    lsp_document_sync_index(server, doc);
+}
+
+static LSPPosition parse_position(JSONValue *position) {
+    LSPPosition pos = {
+        .line = (int)json_object_get_number(position, "line"),
+        .character = (int)json_object_get_number(position, "character")
+    };
+    return pos;
 }
 
 void handle_did_change(LSPServer *server, JSONValue *params) {
@@ -135,25 +160,29 @@ void handle_did_change(LSPServer *server, JSONValue *params) {
     LSPDocument *doc = lsp_document_find(server, uri);
     if (!doc) return;
 
-    // Get content changes (we use full sync, so there's one change with full text)
+    // Apply content changes in order: ranged edits (incremental sync) or
+    // whole-text replacements
     JSONValue *changes = json_object_get_array(params, "contentChanges");
     if (!changes || changes->as.array->count == 0) return;
 
-    JSONValue *change = changes->as.array->items[0];
-    const char *text = json_object_get_string(change, "text");
-
-    if (!text) return;
-
-    fprintf(stderr, "LSP: Document changed: %s\n", uri);
-
-    // Update document
-    lsp_document_update(doc, text, version);
-
-    // Re-parse and collect diagnostics
-    lsp_document_parse(doc);
+    for (int i = 0; i < changes->as.array->count; i++) {
+        JSONValue *change = changes->as.array->items[i];
+        const char *text = json_object_get_string(change, "text");
+        if (!text) continue;
+
+        JSONValue *range = json_object_get_object(change, "range");
+        JSONValue *start = range ? json_object_get_object(range, "start") : NULL;
+        JSONValue *end = range ? json_object_get_object(range, "end") : NULL;
+        if (start && end) {
+            LSPRange edit = { .start = parse_position(start), .end = parse_position(end) };
+            lsp_document_edit(doc, edit, text, version);
+        } else {
+            lsp_document_update(doc, text, version);
+        }
+    }
 
-    // Publish diagnostics
-    lsp_publish_diagnostics(server, doc);
+    // Reparse and publish once typing pauses
+    lsp_document_schedule_diagnostics(server, doc);
 }
 
 void handle_did_close(LSPServer *server, JSONValue *params) {
@@ -177,16 +206,198 @@ void handle_did_close(LSPServer *server, JSONValue *params) {
 }
 
 void handle_did_save(LSPServer *server, JSONValue *params) {
-    (void)server;
-    (void)params;
-    // We re-parse on every change, so save doesn't need special handling
+    JSONValue *text_doc = json_object_get_object(params, "textDocument");
+    if (!text_doc) return;
+
     fprintf(stderr, "LSP: Document saved\n");
+
+    // Publish now instead of waiting out the debounce
+    LSPDocument *doc = lsp_document_find(server, json_object_get_string(text_doc, "uri"));
+    if (doc && doc->diagnostics_due) {
+        doc->diagnostics_due = 0;
+        server->pending_diagnostics--;
+        lsp_document_parse(doc);
+        lsp_publish_diagnostics(server, doc);
+    }
+    if (doc) {
+        lsp_document_sync_index(server, doc);
+    }
+}
+
+void handle_did_change_watched_files(LSPServer *server, JSONValue *params) {
+    JSONValue *changes = json_object_get_array(params, "changes");
+    if (!changes || !server->index) return;
+
+    for (int i = 0; i < changes->as.array->count; i++) {
+        JSONValue *change = changes->as.array->items[i];
+        const char *uri = json_object_get_string(change, "uri");
+        char *path = lsp_uri_to_path(uri);
+        if (!path) continue;
+
+        // Open documents are indexed from the editor's text instead
+        if (!lsp_document_find(server, uri)) {
+            if ((int)json_object_get_number(change, "type") == 3) {  // Deleted
+                lsp_index_remove(server->index, path);
+            } else {
+                lsp_index_update(server->index, path, NULL);
+            }
+        }
+        free(path);
+    }
 }
 
 // ============================================================================
 // Language Features
 // ============================================================================
 
+static JSONValue *range_json(LSPRange range) {
+    JSONValue *json = json_object();
+    JSONValue *start = json_object();
+    json_object_set(start, "line", json_number(range.start.line));
+    json_object_set(start, "character", json_number(range.start.character));
+    JSONValue *end = json_object();
+    json_object_set(end, "line", json_number(range.end.line));
+    json_object_set(end, "character", json_number(range.end.character));
+    json_object_set(json, "start", start);
+    json_object_set(json, "end", end);
+    return json;
+}
+
+// Index paths are file paths, except for documents with other URI schemes
+static char *path_uri(const char *path) {
+    return path[0] == '/' ? lsp_path_to_uri(path) : strdup(path);
+}
+
+static JSONValue *location_json(const LSPSymbolLocation *location) {
+    JSONValue *json = json_object();
+    char *uri = path_uri(location->path);
+    json_object_set(json, "uri", json_string(uri));
+    json_object_set(json, "range", range_json(location->range));
+    free(uri);
+    return json;
+}
+
+static const char *def_kind_name(LSPDefKind kind) {
+    switch (kind) {
+        case LSP_DEF_VARIABLE: return "variable";
+        case LSP_DEF_CONSTANT: return "constant";
+        case LSP_DEF_FUNCTION: return "function";
+        case LSP_DEF_PARAMETER: return "parameter";
+        case LSP_DEF_TYPE: return "type";
+        case LSP_DEF_ENUM: return "enum";
+        case LSP_DEF_ENUM_MEMBER: return "enum member";
+        case LSP_DEF_IMPORT: return "import";
+        case LSP_DEF_NAMESPACE: return "namespace";
+    }
+    return "symbol";
+}
+
+// LSP SymbolKind
+static int def_symbol_kind(LSPDefKind kind) {
+    switch (kind) {
+        case LSP_DEF_FUNCTION: return 12;       // Function
+        case LSP_DEF_CONSTANT: return 14;       // Constant
+        case LSP_DEF_TYPE: return 23;           // Struct
+        case LSP_DEF_ENUM: return 10;           // Enum
+        case LSP_DEF_ENUM_MEMBER: return 22;    // EnumMember
+        case LSP_DEF_NAMESPACE: return 2;       // Module
+        default: return 13;                     // Variable
+    }
+}
+
+// LSP CompletionItemKind
+static int def_completion_kind(LSPDefKind kind) {
+    switch (kind) {
+        case LSP_DEF_FUNCTION: return 3;        // Function
+        case LSP_DEF_CONSTANT: return 21;       // Constant
+        case LSP_DEF_TYPE: return 22;           // Struct
+        case LSP_DEF_ENUM: return 13;           // Enum
+        case LSP_DEF_ENUM_MEMBER: return 20;    // EnumMember
+        case LSP_DEF_NAMESPACE: return 9;       // Module
+        default: return 6;                      // Variable
+    }
+}
+
+// Index path and position of a textDocument/position request, with the
+// latest text of open documents indexed first (caller frees the path)
+static char *request_position(LSPServer *server, JSONValue *params, LSPPosition *pos) {
+    JSONValue *text_doc = json_object_get_object(params, "textDocument");
+    JSONValue *position = json_object_get_object(params, "position");
+    if (!server->index || !text_doc || !position) return NULL;
+
+    const char *uri = json_object_get_string(text_doc, "uri");
+    if (!uri) return NULL;
+    *pos = parse_position(position);
+
+    lsp_server_sync_index(server);
+    LSPDocument *doc = lsp_document_find(server, uri);
+    return doc ? strdup(doc->path) : lsp_uri_to_path(uri);
+}
+
+// A line of a file, from the open document if there is one, trimmed of
+// surrounding whitespace and a trailing '{' (caller frees)
+static char *source_line(LSPServer *server, const char *path, int line) {
+    char *uri = path_uri(path);
+    LSPDocument *doc = lsp_document_find(server, uri);
+    free(uri);
+
+    char *owned = NULL;
+    const char *text;
+    if (doc) {
+        text = lsp_document_text(doc);
+    } else {
+        FILE *file = fopen(path, "r");
+        if (!file) return NULL;
+        size_t capacity = 4096;
+        size_t length = 0;
+        owned = malloc(capacity);
+        size_t n;
+        while ((n = fread(owned + length, 1, capacity - length - 1, file)) > 0) {
+            length += n;
+            if (length + 1 == capacity) {
+                capacity *= 2;
+                owned = realloc(owned, capacity);
+            }
+        }
+        owned[length] = '\0';
+        fclose(file);
+        text = owned;
+    }
+
+    const char *start = text;
+    for (int i = 0; i < line && start; i++) {
+        start = strchr(start, '\n');
+        if (start) start++;
+    }
+    char *result = NULL;
+    if (start) {
+        while (*start == ' ' || *start == '\t') start++;
+        const char *end = strchr(start, '\n');
+        if (!end) end = start + strlen(start);
+        while (end > start && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '{')) end--;
+        result = strndup(start, end - start);
+    }
+    free(owned);
+    return result;
+}
+
+// Hover text for an identifier's definition
+static char *describe_definition(LSPServer *server, const LSPSymbolLocation *location) {
+    char *line = source_line(server, location->path, location->range.start.line);
+    const char *file = strrchr(location->path, '/');
+    file = file ? file + 1 : location->path;
+
+    size_t size = strlen(location->name) + strlen(file) + (line ? strlen(line) : 0) + 128;
+    char *text = malloc(size);
+    snprintf(text, size, "```hemlock\n%s\n```\n%s%s **%s** defined in `%s:%d`",
+             line ? line : location->name,
+             location->exported ? "exported " : "",
+             def_kind_name(location->kind), location->name,
+             file, location->range.start.line + 1);
+    free(line);
+    return text;
+}
+
 JSONValue *handle_hover(LSPServer *server, JSONValue *params) {
     JSONValue *text_doc = json_object_get_object(params, "textDocument");
     JSONValue *position = json_object_get_object(params, "position");
@@ -198,11 +409,15 @@ JSONValue *handle_hover(LSPServer *server, JSONValue *params) {
     int character = (int)json_object_get_number(position, "character");
 
     LSPDocument *doc = lsp_document_find(server, uri);
-    if (!doc || !doc->ast_valid) return json_null();
+    if (!doc) return json_null();
+
+    lsp_document_parse(doc);
+    if (!doc->ast_valid) return json_null();
 
     // Find the token at the position
+    const char *content = lsp_document_text(doc);
     Lexer lexer;
-    lexer_init(&lexer, doc->content);
+    lexer_init(&lexer, content);
 
     Token token;
     Token found_token = {0};
@@ -215,9 +430,9 @@ JSONValue *handle_hover(LSPServer *server, JSONValue *params) {
         // Token line is 1-based, LSP position is 0-based
         if (token.line - 1 == line) {
             // Calculate token column
-            const char *line_start = doc->content;
+            const char *line_start = content;
             int current_line = 0;
-            for (const char *p = doc->content; *p && current_line < token.line - 1; p++) {
+            for (const char *p = content; *p && current_line < token.line - 1; p++) {
                 if (*p == '\n') {
                     current_line++;
                     line_start = p + 1;
@@ -308,8 +523,17 @@ JSONValue *handle_hover(LSPServer *server, JSONValue *params) {
             hover_text = strdup("**string** - UTF-8 string type");
             break;
         case TOK_IDENT: {
-            // For identifiers, we'd need to look up in symbol table
-            // For now, just show the identifier
+            // Definitions come from the workspace index
+            LSPSymbolLocation location;
+            if (server->index) {
+                lsp_server_sync_index(server);
+                LSPPosition pos = { .line = line, .character = character };
+                if (lsp_index_definition(server->index, doc->path, pos, &location)) {
+                    hover_text = describe_definition(server, &location);
+                    lsp_symbol_location_free(&location);
+                    break;
+                }
+            }
             char *name = strndup(found_token.start, found_token.length);
             char buf[256];
             snprintf(buf, sizeof(buf), "Identifier: **%s**", name);
@@ -342,9 +566,29 @@ JSONValue *handle_completion(LSPServer *server, JSONValue *params) {
     LSPDocument *doc = lsp_document_find(server, uri);
     if (!doc) return json_null();
 
-    // Build completion list with Hemlock keywords and builtins
+    // Build completion list with names in scope, Hemlock keywords and builtins
     JSONValue *items = json_array();
 
+    // Locals, top-level definitions and imports visible at the cursor
+    if (server->index) {
+        JSONValue *position = json_object_get_object(params, "position");
+        LSPPosition pos = { 0, 0 };
+        if (position) {
+            pos = parse_position(position);
+        }
+        lsp_server_sync_index(server);
+        LSPSymbolLocation *visible;
+        int count = lsp_index_visible_symbols(server->index, doc->path, pos, &visible);
+        for (int i = 0; i < count; i++) {
+            JSONValue *item = json_object();
+            json_object_set(item, "label", json_string(visible[i].name));
+            json_object_set(item, "kind", json_number(def_completion_kind(visible[i].kind)));
+            json_object_set(item, "detail", json_string(def_kind_name(visible[i].kind)));
+            json_array_push(items, item);
+        }
+        lsp_symbol_locations_free(visible, count);
+    }
+
     // Keywords
     const char *keywords[] = {
         "fn", "let", "const", "if", "else", "while", "for", "return",
@@ -399,18 +643,79 @@ JSONValue *handle_completion(LSPServer *server, JSONValue *params) {
 }
 
 JSONValue *handle_definition(LSPServer *server, JSONValue *params) {
-    // TODO: Implement go-to-definition
-    // This requires building a symbol table from the AST
-    (void)server;
-    (void)params;
-    return json_null();
+    LSPPosition pos;
+    char *path = request_position(server, params, &pos);
+    if (!path) return json_null();
+
+    LSPSymbolLocation location;
+    bool found = lsp_index_definition(server->index, path, pos, &location);
+    free(path);
+    if (!found) return json_null();
+
+    JSONValue *result = location_json(&location);
+    lsp_symbol_location_free(&location);
+    return result;
 }
 
 JSONValue *handle_references(LSPServer *server, JSONValue *params) {
-    // TODO: Implement find references
-    (void)server;
-    (void)params;
-    return json_null();
+    LSPPosition pos;
+    char *path = request_position(server, params, &pos);
+    if (!path) return json_null();
+
+    JSONValue *context = json_object_get_object(params, "context");
+    bool include_declaration = context && json_object_get_bool(context, "includeDeclaration");
+
+    LSPSymbolLocation *references;
+    int count = lsp_index_references(server->index, path, pos, include_declaration, &references);
+    free(path);
+
+    JSONValue *result = json_array();
+    for (int i = 0; i < count; i++) {
+        json_array_push(result, location_json(&references[i]));
+    }
+    lsp_symbol_locations_free(references, count);
+    return result;
+}
+
+// Most results a workspace/symbol request returns
+#define LSP_WORKSPACE_SYMBOL_LIMIT 500
+
+JSONValue *handle_workspace_symbol(LSPServer *server, JSONValue *params) {
+    if (!server->index) return json_null();
+    const char *query = json_object_get_string(params, "query");
+    lsp_server_sync_index(server);
+
+    LSPSymbolLocation *symbols;
+    int count = lsp_index_workspace_symbols(server->index, query ? query : "",
+                                            LSP_WORKSPACE_SYMBOL_LIMIT, &symbols);
+
+    JSONValue *result = json_array();
+    for (int i = 0; i < count; i++) {
+        JSONValue *symbol = json_object();
+        json_object_set(symbol, "name", json_string(symbols[i].name));
+        json_object_set(symbol, "kind", json_number(def_symbol_kind(symbols[i].kind)));
+        json_object_set(symbol, "location", location_json(&symbols[i]));
+        const char *file = strrchr(symbols[i].path, '/');
+        json_object_set(symbol, "containerName", json_string(file ? file + 1 : symbols[i].path));
+        json_array_push(result, symbol);
+    }
+    lsp_symbol_locations_free(symbols, count);
+    return result;
+}
+
+// Zero-width range at the start of a line (a JSON value has one owner, so
+// range and selectionRange each need their own)
+static JSONValue *line_range(int line) {
+    JSONValue *range = json_object();
+    JSONValue *start = json_object();
+    json_object_set(start, "line", json_number(line));
+    json_object_set(start, "character", json_number(0));
+    JSONValue *end = json_object();
+    json_object_set(end, "line", json_number(line));
+    json_object_set(end, "character", json_number(0));
+    json_object_set(range, "start", start);
+    json_object_set(range, "end", end);
+    return range;
 }
 
 JSONValue *handle_document_symbol(LSPServer *server, JSONValue *params) {
@@ -419,7 +724,10 @@ JSONValue *handle_document_symbol(LSPServer *server, JSONValue *params) {
 
     const char *uri = json_object_get_string(text_doc, "uri");
     LSPDocument *doc = lsp_document_find(server, uri);
-    if (!doc || !doc->ast) return json_null();
+    if (!doc) return json_null();
+
+    lsp_document_parse(doc);
+    if (!doc->ast) return json_null();
 
     JSONValue *symbols = json_array();
 
@@ -455,17 +763,8 @@ JSONValue *handle_document_symbol(LSPServer *server, JSONValue *params) {
                 }
                 json_object_set(symbol, "kind", json_number(kind));
 
-                JSONValue *range = json_object();
-                JSONValue *start = json_object();
-                json_object_set(start, "line", json_number(stmt->line - 1));
-                json_object_set(start, "character", json_number(0));
-                JSONValue *end = json_object();
-                json_object_set(end, "line", json_number(stmt->line - 1));
-                json_object_set(end, "character", json_number(0));
-                json_object_set(range, "start", start);
-                json_object_set(range, "end", end);
-                json_object_set(symbol, "range", range);
-                json_object_set(symbol, "selectionRange", range);
+                json_object_set(symbol, "range", line_range(stmt->line - 1));
+                json_object_set(symbol, "selectionRange", line_range(stmt->line - 1));
                 break;
             }
 
@@ -475,17 +774,8 @@ JSONValue *handle_document_symbol(LSPServer *server, JSONValue *params) {
                 json_object_set(symbol, "name", json_string(stmt->as.define_object.name));
                 json_object_set(symbol, "kind", json_number(23));  // Struct
 
-                JSONValue *range = json_object();
-                JSONValue *start = json_object();
-                json_object_set(start, "line", json_number(stmt->line - 1));
-                json_object_set(start, "character", json_number(0));
-                JSONValue *end = json_object();
-                json_object_set(end, "line", json_number(stmt->line - 1));
-                json_object_set(end, "character", json_number(0));
-                json_object_set(range, "start", start);
-                json_object_set(range, "end", end);
-                json_object_set(symbol, "range", range);
-                json_object_set(symbol, "selectionRange", range);
+                json_object_set(symbol, "range", line_range(stmt->line - 1));
+                json_object_set(symbol, "selectionRange", line_range(stmt->line - 1));
                 break;
             }
 
@@ -495,17 +785,8 @@ JSONValue *handle_document_symbol(LSPServer *server, JSONValue *params) {
                 json_object_set(symbol, "name", json_string(stmt->as.enum_decl.name));
                 json_object_set(symbol, "kind", json_number(10));  // Enum
 
-                JSONValue *range = json_object();
-                JSONValue *start = json_object();
-                json_object_set(start, "line", json_number(stmt->line - 1));
-                json_object_set(start, "character", json_number(0));
-                JSONValue *end = json_object();
-                json_object_set(end, "line", json_number(stmt->line - 1));
-                json_object_set(end, "character", json_number(0));
-                json_object_set(range, "start", start);
-                json_object_set(range, "end", end);
-                json_object_set(symbol, "range", range);
-                json_object_set(symbol, "selectionRange", range);
+                json_object_set(symbol, "range", line_range(stmt->line - 1));
+                json_object_set(symbol, "selectionRange", line_range(stmt->line - 1));
                 break;
             }
 
@@ -616,6 +897,11 @@ JSONValue *lsp_dispatch(LSPServer *server, const char *method, JSONValue *params
         handle_did_save(server, params);
         return NULL;
     }
+    if (strcmp(method, "workspace/didChangeWatchedFiles") == 0) {
+        *is_notification = true;
+        handle_did_change_watched_files(server, params);
+        return NULL;
+    }
 
     // Language features
     if (strcmp(method, "textDocument/hover") == 0) {
@@ -638,6 +924,10 @@ JSONValue *lsp_dispatch(LSPServer *server, const char *method, JSONValue *params
         *is_notification = false;
         return handle_document_symbol(server, params);
     }
+    if (strcmp(method, "workspace/symbol") == 0) {
+        *is_notification = false;
+        return handle_workspace_symbol(server, params);
+    }
 
     // Unknown method
     fprintf(stderr, "LSP: Unknown method: %s\n", method);
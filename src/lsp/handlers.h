@@ -10,6 +10,9 @@
  * - textDocument/hover
  * - textDocument/completion
  * - textDocument/definition
+ * - textDocument/references
+ * - workspace/symbol
+ * - workspace/didChangeWatchedFiles
  */
 
 #ifndef HEMLOCK_LSP_HANDLERS_H
@@ -38,6 +41,7 @@ void handle_did_open(LSPServer *server, JSONValue *params);
 void handle_did_change(LSPServer *server, JSONValue *params);
 void handle_did_close(LSPServer *server, JSONValue *params);
 void handle_did_save(LSPServer *server, JSONValue *params);
+void handle_did_change_watched_files(LSPServer *server, JSONValue *params);
 
 /*
  * Language feature handlers
@@ -47,6 +51,7 @@ JSONValue *handle_completion(LSPServer *server, JSONValue *params);
 JSONValue *handle_definition(LSPServer *server, JSONValue *params);
 JSONValue *handle_references(LSPServer *server, JSONValue *params);
 JSONValue *handle_document_symbol(LSPServer *server, JSONValue *params);
+JSONValue *handle_workspace_symbol(LSPServer *server, JSONValue *params);
 
 /*
  * Dispatch a request/notification to the appropriate handler
@@ -0,0 +1,1833 @@
+/*
+ * Workspace symbol index
+ */
+
+#define _GNU_SOURCE
+#include "index.h"
+
+#include "../../include/lexer.h"
+#include "../../include/module.h"
+#include "../../include/cache_dir.h"
+#include "../../include/fnv1a.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+// Most threads the initial build uses
+#define INDEX_MAX_WORKERS 4
+
+// Re-export and import chains longer than this are treated as cycles
+#define INDEX_MAX_DEPTH 16
+
+// ============================================================================
+// Symbols
+// ============================================================================
+
+// Interned names and module paths, shared by every file index and kept for
+// the life of the process. Id 0 is the empty string and means "none".
+static pthread_mutex_t symbols_lock = PTHREAD_MUTEX_INITIALIZER;
+static char **symbol_names = NULL;
+static uint32_t symbol_count = 0;
+static uint32_t symbol_capacity = 0;
+static uint32_t *symbol_slots = NULL;   // Open addressing over ids, 0 = empty
+static uint32_t slot_capacity = 0;      // Power of two
+
+static void symbols_rehash(uint32_t capacity) {
+    uint32_t *slots = calloc(capacity, sizeof(uint32_t));
+    for (uint32_t id = 1; id < symbol_count; id++) {
+        const char *name = symbol_names[id];
+        uint32_t i = (uint32_t)hml_fnv1a64(name, strlen(name), HML_FNV1A64_OFFSET) & (capacity - 1);
+        while (slots[i]) {
+            i = (i + 1) & (capacity - 1);
+        }
+        slots[i] = id;
+    }
+    free(symbol_slots);
+    symbol_slots = slots;
+    slot_capacity = capacity;
+}
+
+static uint32_t intern(const char *name, size_t len) {
+    if (len == 0) return 0;
+    uint32_t hash = (uint32_t)hml_fnv1a64(name, len, HML_FNV1A64_OFFSET);
+
+    pthread_mutex_lock(&symbols_lock);
+    if (symbol_count == 0) {
+        symbol_capacity = 1024;
+        symbol_names = malloc(symbol_capacity * sizeof(char *));
+        symbol_names[0] = strdup("");
+        symbol_count = 1;
+        symbols_rehash(2048);
+    }
+
+    uint32_t i = hash & (slot_capacity - 1);
+    while (symbol_slots[i]) {
+        uint32_t id = symbol_slots[i];
+        const char *existing = symbol_names[id];
+        if (strncmp(existing, name, len) == 0 && existing[len] == '\0') {
+            pthread_mutex_unlock(&symbols_lock);
+            return id;
+        }
+        i = (i + 1) & (slot_capacity - 1);
+    }
+
+    if (symbol_count == symbol_capacity) {
+        symbol_capacity *= 2;
+        symbol_names = realloc(symbol_names, symbol_capacity * sizeof(char *));
+    }
+    uint32_t id = symbol_count++;
+    symbol_names[id] = strndup(name, len);
+    symbol_slots[i] = id;
+    if (symbol_count * 2 > slot_capacity) {
+        symbols_rehash(slot_capacity * 2);
+    }
+    pthread_mutex_unlock(&symbols_lock);
+    return id;
+}
+
+static uint32_t intern_string(const char *name) {
+    return intern(name, strlen(name));
+}
+
+static const char *symbol_name(uint32_t id) {
+    pthread_mutex_lock(&symbols_lock);
+    const char *name = id < symbol_count ? symbol_names[id] : "";
+    pthread_mutex_unlock(&symbols_lock);
+    return name;
+}
+
+// ============================================================================
+// File Indexes
+// ============================================================================
+
+#define DEF_TOP_LEVEL   0x01
+#define DEF_EXPORTED    0x02
+
+#define REF_MEMBER      0x01    // `owner.name`; qualifier is owner if a plain name
+#define REF_EXTERNAL    0x02    // Names an export of another module; qualifier is its path
+
+#define SCOPE_END UINT32_MAX
+
+// The fixed-width records below are written to the cache as they are
+typedef struct {
+    uint32_t symbol;
+    uint32_t offset;        // Byte offset of the name
+    uint32_t scope_start;   // Visible in [scope_start, scope_end)
+    uint32_t scope_end;
+    int32_t line;
+    int32_t character;      // UTF-16 code units, as in LSP
+    int32_t length;
+    uint32_t source;        // IMPORT/NAMESPACE: module path; ENUM_MEMBER: the enum
+    uint32_t imported;      // IMPORT: name exported by the module
+    uint8_t kind;           // LSPDefKind
+    uint8_t flags;
+    uint16_t reserved;
+} IndexDef;
+
+typedef struct {
+    uint32_t symbol;
+    uint32_t offset;
+    int32_t line;
+    int32_t character;
+    int32_t length;
+    uint32_t qualifier;     // See REF_MEMBER and REF_EXTERNAL
+    int32_t def;            // Definition this occurrence declares, or -1
+    uint8_t flags;
+    uint8_t reserved[3];
+} IndexRef;
+
+typedef struct {
+    uint32_t name;          // Name importers use
+    uint32_t local;         // Name in this file, or in module
+    uint32_t module;        // Re-exported module path, or 0
+} IndexExport;
+
+typedef struct {
+    uint32_t path;
+    int64_t mtime_sec;      // Identity of the file on disk when indexed
+    int64_t mtime_nsec;
+    uint64_t size;
+    bool from_buffer;       // Indexed from an open document instead
+    bool missing;           // Module path that could not be read
+
+    IndexDef *defs;
+    uint32_t def_count;
+    IndexRef *refs;         // In source order
+    uint32_t ref_count;
+    IndexExport *exports;
+    uint32_t export_count;
+
+    uint32_t *defs_by_symbol;   // Indexes ordered by (symbol, offset)
+    uint32_t *refs_by_symbol;
+} FileIndex;
+
+static void file_index_free(FileIndex *file) {
+    if (!file) return;
+    free(file->defs);
+    free(file->refs);
+    free(file->exports);
+    free(file->defs_by_symbol);
+    free(file->refs_by_symbol);
+    free(file);
+}
+
+static void *grow_array(void *array, uint32_t count, uint32_t *capacity, size_t size) {
+    if (count < *capacity) return array;
+    *capacity = *capacity ? *capacity * 2 : 16;
+    return realloc(array, *capacity * size);
+}
+
+// Sorting by symbol goes through a file-scoped pointer, as qsort has no
+// context argument; each thread sorts its own file
+static _Thread_local const FileIndex *sorting_file;
+
+static int compare_defs(const void *a, const void *b) {
+    const IndexDef *x = &sorting_file->defs[*(const uint32_t *)a];
+    const IndexDef *y = &sorting_file->defs[*(const uint32_t *)b];
+    if (x->symbol != y->symbol) return x->symbol < y->symbol ? -1 : 1;
+    return x->offset < y->offset ? -1 : x->offset > y->offset;
+}
+
+static int compare_refs(const void *a, const void *b) {
+    const IndexRef *x = &sorting_file->refs[*(const uint32_t *)a];
+    const IndexRef *y = &sorting_file->refs[*(const uint32_t *)b];
+    if (x->symbol != y->symbol) return x->symbol < y->symbol ? -1 : 1;
+    return x->offset < y->offset ? -1 : x->offset > y->offset;
+}
+
+static void file_index_sort(FileIndex *file) {
+    file->defs_by_symbol = malloc((file->def_count + 1) * sizeof(uint32_t));
+    file->refs_by_symbol = malloc((file->ref_count + 1) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < file->def_count; i++) file->defs_by_symbol[i] = i;
+    for (uint32_t i = 0; i < file->ref_count; i++) file->refs_by_symbol[i] = i;
+    sorting_file = file;
+    qsort(file->defs_by_symbol, file->def_count, sizeof(uint32_t), compare_defs);
+    qsort(file->refs_by_symbol, file->ref_count, sizeof(uint32_t), compare_refs);
+    sorting_file = NULL;
+}
+
+// Symbol of the record an index entry points at (both record types start
+// with their symbol)
+static uint32_t record_symbol(const uint32_t *order, const void *records,
+                              size_t record_size, uint32_t i) {
+    return *(const uint32_t *)((const char *)records + (size_t)order[i] * record_size);
+}
+
+// Run of an index ordered by symbol whose records have the symbol: returns
+// its start and stores its end in *end
+static uint32_t symbol_run(const uint32_t *order, uint32_t count, const void *records,
+                           size_t record_size, uint32_t symbol, uint32_t *end) {
+    uint32_t lo = 0;
+    uint32_t hi = count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (record_symbol(order, records, record_size, mid) < symbol) lo = mid + 1;
+        else hi = mid;
+    }
+    uint32_t stop = lo;
+    while (stop < count && record_symbol(order, records, record_size, stop) == symbol) stop++;
+    *end = stop;
+    return lo;
+}
+
+// ============================================================================
+// Indexing
+// ============================================================================
+
+typedef struct {
+    TokenType type;
+    uint32_t offset;
+    int length;
+    int line;
+    int character;
+    int units;              // Length in UTF-16 code units
+    char *string;           // TOK_STRING value
+} IndexToken;
+
+typedef struct {
+    uint32_t start;
+    uint32_t first_def;     // Definitions from here on may close with the scope
+} IndexScope;
+
+typedef struct {
+    uint32_t hash;
+    uint32_t symbol;        // 0 = empty slot
+    uint32_t offset;        // First occurrence in the source
+    int length;
+} IndexName;
+
+typedef struct {
+    const char *path;
+    const char *source;
+    ModuleCache *modules;
+
+    IndexToken *tokens;
+    int token_count;
+    int32_t *token_def;         // Definition each token declares, or -1
+    uint32_t *token_module;     // Module a token names an export of, or 0
+    bool *token_skip;           // Not an occurrence (keys, export aliases)
+
+    FileIndex *file;
+    uint32_t def_capacity;
+    uint32_t ref_capacity;
+    uint32_t export_capacity;
+    uint32_t *def_depth;        // Brace depth of each definition's scope
+
+    // Names seen in this file, so most lookups skip the shared table
+    IndexName *names;
+    uint32_t name_capacity;
+    uint32_t name_count;
+} IndexBuilder;
+
+static int utf16_units(const char *text, int length) {
+    int units = 0;
+    for (int i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)text[i];
+        if ((c & 0xC0) == 0x80) continue;
+        units += c >= 0xF0 ? 2 : 1;
+    }
+    return units;
+}
+
+static IndexToken *tokenize(const char *source, int *count) {
+    Lexer lexer;
+    lexer_init(&lexer, source);
+
+    IndexToken *tokens = NULL;
+    uint32_t token_count = 0;
+    uint32_t token_capacity = 0;
+    const char *cursor = source;
+    int line = 0;
+    int character = 0;
+
+    for (;;) {
+        const char *before = lexer.current;
+        Token token = lexer_next(&lexer);
+        if (token.type == TOK_EOF) break;
+        if (token.type == TOK_ERROR) {
+            // The message is not part of the source; stop if the lexer is stuck
+            if (lexer.current == before) break;
+            continue;
+        }
+
+        // Walk the line/column cursor up to the token
+        while (cursor < token.start) {
+            unsigned char c = (unsigned char)*cursor++;
+            if (c == '\n') {
+                line++;
+                character = 0;
+            } else if ((c & 0xC0) != 0x80) {
+                character += c >= 0xF0 ? 2 : 1;
+            }
+        }
+
+        tokens = grow_array(tokens, token_count, &token_capacity, sizeof(IndexToken));
+        IndexToken *t = &tokens[token_count++];
+        t->type = token.type;
+        t->offset = (uint32_t)(token.start - source);
+        t->length = token.length;
+        t->line = line;
+        t->character = character;
+        t->units = token.type == TOK_IDENT ? utf16_units(token.start, token.length) : token.length;
+        t->string = NULL;
+        if (token.type == TOK_STRING) {
+            t->string = token.string_value;
+        } else if (token.type == TOK_TEMPLATE_STRING) {
+            free(token.string_value);
+        }
+    }
+
+    *count = (int)token_count;
+    return tokens;
+}
+
+static uint32_t builder_intern(IndexBuilder *b, int token) {
+    const char *text = b->source + b->tokens[token].offset;
+    int length = b->tokens[token].length;
+    uint32_t hash = (uint32_t)hml_fnv1a64(text, length, HML_FNV1A64_OFFSET);
+
+    if (b->name_count * 2 >= b->name_capacity) {
+        uint32_t capacity = b->name_capacity ? b->name_capacity * 2 : 256;
+        IndexName *names = calloc(capacity, sizeof(IndexName));
+        for (uint32_t i = 0; i < b->name_capacity; i++) {
+            if (!b->names[i].symbol) continue;
+            uint32_t j = b->names[i].hash & (capacity - 1);
+            while (names[j].symbol) j = (j + 1) & (capacity - 1);
+            names[j] = b->names[i];
+        }
+        free(b->names);
+        b->names = names;
+        b->name_capacity = capacity;
+    }
+
+    uint32_t i = hash & (b->name_capacity - 1);
+    while (b->names[i].symbol) {
+        if (b->names[i].hash == hash && b->names[i].length == length &&
+            memcmp(b->source + b->names[i].offset, text, length) == 0) {
+            return b->names[i].symbol;
+        }
+        i = (i + 1) & (b->name_capacity - 1);
+    }
+    uint32_t symbol = intern(text, length);
+    b->names[i].hash = hash;
+    b->names[i].symbol = symbol;
+    b->names[i].offset = b->tokens[token].offset;
+    b->names[i].length = length;
+    b->name_count++;
+    return symbol;
+}
+
+static bool token_is(IndexBuilder *b, int i, TokenType type) {
+    return i >= 0 && i < b->token_count && b->tokens[i].type == type;
+}
+
+static int add_def(IndexBuilder *b, int token, LSPDefKind kind, int depth,
+                   uint32_t scope_start, bool exported) {
+    FileIndex *file = b->file;
+    uint32_t capacity = b->def_capacity;
+    file->defs = grow_array(file->defs, file->def_count, &b->def_capacity, sizeof(IndexDef));
+    if (b->def_capacity != capacity) {
+        b->def_depth = realloc(b->def_depth, b->def_capacity * sizeof(uint32_t));
+    }
+
+    int index = (int)file->def_count++;
+    IndexToken *t = &b->tokens[token];
+    IndexDef *def = &file->defs[index];
+    memset(def, 0, sizeof(*def));
+    def->symbol = builder_intern(b, token);
+    def->offset = t->offset;
+    def->scope_start = depth == 0 ? 0 : scope_start;
+    def->scope_end = SCOPE_END;
+    def->line = t->line;
+    def->character = t->character;
+    def->length = t->units;
+    def->kind = (uint8_t)kind;
+    def->flags = depth == 0 ? DEF_TOP_LEVEL : 0;
+    b->def_depth[index] = (uint32_t)depth;
+    b->token_def[token] = index;
+
+    if (exported && depth == 0) {
+        def->flags |= DEF_EXPORTED;
+        file->exports = grow_array(file->exports, file->export_count, &b->export_capacity,
+                                   sizeof(IndexExport));
+        file->exports[file->export_count++] = (IndexExport){ def->symbol, def->symbol, 0 };
+    }
+    return index;
+}
+
+// Absolute path of the module an import string names, interned
+static uint32_t resolve_import(IndexBuilder *b, int token) {
+    if (!token_is(b, token, TOK_STRING) || !b->tokens[token].string || !b->modules) return 0;
+    char *resolved = resolve_module_path(b->modules, b->path, b->tokens[token].string);
+    if (!resolved) return 0;
+    uint32_t module = intern_string(resolved);
+    free(resolved);
+    return module;
+}
+
+// Index of the token closing the bracket opened at open
+static int matching_close(IndexBuilder *b, int open) {
+    int depth = 0;
+    for (int i = open; i < b->token_count; i++) {
+        switch (b->tokens[i].type) {
+            case TOK_LPAREN: case TOK_LBRACKET: case TOK_LBRACE:
+                depth++;
+                break;
+            case TOK_RPAREN: case TOK_RBRACKET: case TOK_RBRACE:
+                if (--depth == 0) return i;
+                break;
+            default:
+                break;
+        }
+    }
+    return b->token_count - 1;
+}
+
+// Parameter names in the list opened at open; returns the first new
+// definition (or -1) and the closing parenthesis in *close
+static int index_parameters(IndexBuilder *b, int open, int depth, int *close) {
+    *close = matching_close(b, open);
+    int first = -1;
+    int nesting = 0;
+    bool expect_name = true;
+    for (int i = open + 1; i < *close; i++) {
+        switch (b->tokens[i].type) {
+            case TOK_LPAREN: case TOK_LBRACKET: case TOK_LBRACE:
+                nesting++;
+                expect_name = false;
+                break;
+            case TOK_RPAREN: case TOK_RBRACKET: case TOK_RBRACE:
+                nesting--;
+                break;
+            case TOK_COMMA:
+                if (nesting == 0) expect_name = true;
+                break;
+            case TOK_REF:
+            case TOK_DOT:
+                break;
+            case TOK_IDENT:
+                if (nesting == 0 && expect_name) {
+                    int def = add_def(b, i, LSP_DEF_PARAMETER, depth + 1,
+                                      b->tokens[open].offset, false);
+                    if (first < 0) first = def;
+                }
+                expect_name = false;
+                break;
+            default:
+                expect_name = false;
+                break;
+        }
+    }
+    return first;
+}
+
+// `{ a, b as c }` lists of import and export statements; returns the token
+// after the closing brace. Calls back with the name and alias (or -1) tokens.
+typedef void (*NameListFn)(IndexBuilder *b, int name, int alias, void *data);
+
+static int name_list(IndexBuilder *b, int open, NameListFn fn, void *data) {
+    int i = open + 1;
+    while (token_is(b, i, TOK_IDENT)) {
+        int name = i++;
+        int alias = -1;
+        if (token_is(b, i, TOK_AS) && token_is(b, i + 1, TOK_IDENT)) {
+            alias = i + 1;
+            i += 2;
+        }
+        fn(b, name, alias, data);
+        if (!token_is(b, i, TOK_COMMA)) break;
+        i++;
+    }
+    return token_is(b, i, TOK_RBRACE) ? i + 1 : i;
+}
+
+typedef struct {
+    int first_def;
+    int first_name;         // Aliased import names, patched with the module
+    int names[256];
+    int name_count;
+} ImportList;
+
+static void import_name(IndexBuilder *b, int name, int alias, void *data) {
+    ImportList *list = data;
+    int def = add_def(b, alias >= 0 ? alias : name, LSP_DEF_IMPORT, 0, 0, false);
+    b->file->defs[def].imported = builder_intern(b, name);
+    if (list->first_def < 0) list->first_def = def;
+    if (alias >= 0 && list->name_count < (int)(sizeof(list->names) / sizeof(list->names[0]))) {
+        list->names[list->name_count++] = name;
+    }
+}
+
+typedef struct {
+    int names[256];
+    int aliases[256];
+    int count;
+} ExportList;
+
+static void export_name(IndexBuilder *b, int name, int alias, void *data) {
+    ExportList *list = data;
+    if (alias >= 0) b->token_skip[alias] = true;
+    if (list->count < (int)(sizeof(list->names) / sizeof(list->names[0]))) {
+        list->names[list->count] = name;
+        list->aliases[list->count] = alias;
+        list->count++;
+    }
+}
+
+// Definitions, scopes, imports and exports, from one pass over the tokens
+static void index_declarations(IndexBuilder *b) {
+    FileIndex *file = b->file;
+    IndexScope *scopes = NULL;
+    uint32_t scope_count = 0;
+    uint32_t scope_capacity = 0;
+
+    int pending = -1;           // Parameters waiting for their body
+    int pending_after = -1;     // ...which starts after this token
+    bool export_next = false;
+
+    for (int i = 0; i < b->token_count; i++) {
+        IndexToken *t = &b->tokens[i];
+        int depth = (int)scope_count;
+
+        switch (t->type) {
+            case TOK_LBRACE: {
+                scopes = grow_array(scopes, scope_count, &scope_capacity, sizeof(IndexScope));
+                IndexScope *scope = &scopes[scope_count++];
+                scope->start = t->offset;
+                scope->first_def = file->def_count;
+                if (pending >= 0 && i > pending_after) {
+                    scope->first_def = (uint32_t)pending;
+                    pending = -1;
+                }
+                break;
+            }
+
+            case TOK_RBRACE:
+                if (scope_count > 0) {
+                    IndexScope *scope = &scopes[--scope_count];
+                    for (uint32_t d = scope->first_def; d < file->def_count; d++) {
+                        if (file->defs[d].scope_end == SCOPE_END && b->def_depth[d] >= (uint32_t)depth) {
+                            file->defs[d].scope_end = t->offset;
+                        }
+                    }
+                }
+                break;
+
+            case TOK_SEMICOLON:
+                // Parameters of a declaration without a body (extern fn)
+                if (pending >= 0 && i > pending_after) {
+                    for (uint32_t d = (uint32_t)pending; d < file->def_count; d++) {
+                        if (file->defs[d].scope_end == SCOPE_END && b->def_depth[d] > (uint32_t)depth) {
+                            file->defs[d].scope_end = t->offset;
+                        }
+                    }
+                    pending = -1;
+                }
+                export_next = false;
+                break;
+
+            case TOK_EXPORT:
+                if (token_is(b, i + 1, TOK_LBRACE)) {
+                    ExportList list = { .count = 0 };
+                    int next = name_list(b, i + 1, export_name, &list);
+                    uint32_t module = 0;
+                    if (token_is(b, next, TOK_FROM)) {
+                        module = resolve_import(b, next + 1);
+                    }
+                    for (int n = 0; n < list.count; n++) {
+                        int name = list.names[n];
+                        int alias = list.aliases[n];
+                        uint32_t local = builder_intern(b, name);
+                        file->exports = grow_array(file->exports, file->export_count,
+                                                   &b->export_capacity, sizeof(IndexExport));
+                        file->exports[file->export_count++] = (IndexExport){
+                            alias >= 0 ? builder_intern(b, alias) : local, local, module
+                        };
+                        if (module) b->token_module[name] = module;
+                    }
+                    i = next - 1;
+                } else {
+                    export_next = true;
+                }
+                break;
+
+            case TOK_IMPORT:
+                if (token_is(b, i + 1, TOK_STAR) && token_is(b, i + 2, TOK_AS) &&
+                    token_is(b, i + 3, TOK_IDENT)) {
+                    int def = add_def(b, i + 3, LSP_DEF_NAMESPACE, 0, 0, false);
+                    if (token_is(b, i + 4, TOK_FROM)) {
+                        file->defs[def].source = resolve_import(b, i + 5);
+                    }
+                    i += 3;
+                } else if (token_is(b, i + 1, TOK_LBRACE)) {
+                    ImportList list = { .first_def = -1, .name_count = 0 };
+                    int next = name_list(b, i + 1, import_name, &list);
+                    uint32_t module = 0;
+                    if (token_is(b, next, TOK_FROM)) {
+                        module = resolve_import(b, next + 1);
+                    }
+                    if (list.first_def >= 0) {
+                        for (uint32_t d = (uint32_t)list.first_def; d < file->def_count; d++) {
+                            file->defs[d].source = module;
+                        }
+                    }
+                    for (int n = 0; n < list.name_count; n++) {
+                        b->token_module[list.names[n]] = module;
+                    }
+                    i = next - 1;
+                }
+                break;
+
+            case TOK_LET:
+            case TOK_CONST: {
+                LSPDefKind kind = t->type == TOK_LET ? LSP_DEF_VARIABLE : LSP_DEF_CONSTANT;
+                if (token_is(b, i - 1, TOK_LPAREN) && token_is(b, i - 2, TOK_FOR) &&
+                    token_is(b, i + 1, TOK_IDENT)) {
+                    // Loop variables belong to the loop body
+                    int first = add_def(b, i + 1, kind, depth + 1, t->offset, false);
+                    if (token_is(b, i + 2, TOK_COMMA) && token_is(b, i + 3, TOK_IDENT)) {
+                        add_def(b, i + 3, kind, depth + 1, t->offset, false);
+                    }
+                    pending = first;
+                    pending_after = matching_close(b, i - 1);
+                } else if (token_is(b, i + 1, TOK_IDENT)) {
+                    add_def(b, i + 1, kind, depth, b->tokens[i + 1].offset, export_next);
+                    export_next = false;
+                }
+                break;
+            }
+
+            case TOK_FN: {
+                int open = i + 1;
+                if (token_is(b, i + 1, TOK_IDENT)) {
+                    add_def(b, i + 1, LSP_DEF_FUNCTION, depth, b->tokens[i + 1].offset, export_next);
+                    export_next = false;
+                    open = i + 2;
+                }
+                if (token_is(b, open, TOK_LPAREN)) {
+                    int close;
+                    int first = index_parameters(b, open, depth, &close);
+                    if (first >= 0) {
+                        pending = first;
+                        pending_after = close;
+                    }
+                }
+                break;
+            }
+
+            case TOK_CATCH:
+                if (token_is(b, i + 1, TOK_LPAREN) && token_is(b, i + 2, TOK_IDENT)) {
+                    pending = add_def(b, i + 2, LSP_DEF_PARAMETER, depth + 1, t->offset, false);
+                    pending_after = matching_close(b, i + 1);
+                }
+                break;
+
+            case TOK_DEFINE:
+                if (token_is(b, i + 1, TOK_IDENT)) {
+                    add_def(b, i + 1, LSP_DEF_TYPE, depth, b->tokens[i + 1].offset, export_next);
+                    export_next = false;
+                }
+                break;
+
+            case TOK_ENUM:
+                if (token_is(b, i + 1, TOK_IDENT)) {
+                    int def = add_def(b, i + 1, LSP_DEF_ENUM, depth, b->tokens[i + 1].offset, export_next);
+                    export_next = false;
+                    uint32_t owner = file->defs[def].symbol;
+                    if (token_is(b, i + 2, TOK_LBRACE)) {
+                        // Members are only reachable as Enum.MEMBER: empty scope
+                        int close = matching_close(b, i + 2);
+                        bool expect_name = true;
+                        for (int m = i + 3; m < close; m++) {
+                            if (b->tokens[m].type == TOK_COMMA) {
+                                expect_name = true;
+                            } else if (b->tokens[m].type == TOK_IDENT && expect_name) {
+                                int member = add_def(b, m, LSP_DEF_ENUM_MEMBER, depth + 1, 0, false);
+                                file->defs[member].scope_start = 0;
+                                file->defs[member].scope_end = 0;
+                                file->defs[member].flags = 0;
+                                file->defs[member].source = owner;
+                                expect_name = false;
+                            } else {
+                                expect_name = false;
+                            }
+                        }
+                    }
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    free(scopes);
+}
+
+// Every identifier occurrence, in source order
+static void index_occurrences(IndexBuilder *b) {
+    FileIndex *file = b->file;
+    for (int i = 0; i < b->token_count; i++) {
+        IndexToken *t = &b->tokens[i];
+        if (t->type != TOK_IDENT || b->token_skip[i]) continue;
+
+        bool member = token_is(b, i - 1, TOK_DOT) || token_is(b, i - 1, TOK_QUESTION_DOT);
+        if (!member && b->token_def[i] < 0 && !b->token_module[i] &&
+            (token_is(b, i - 1, TOK_LBRACE) || token_is(b, i - 1, TOK_COMMA)) &&
+            (token_is(b, i + 1, TOK_COLON) ||
+             (token_is(b, i + 1, TOK_QUESTION) && token_is(b, i + 2, TOK_COLON)))) {
+            // Object literal key or define field
+            continue;
+        }
+
+        file->refs = grow_array(file->refs, file->ref_count, &b->ref_capacity, sizeof(IndexRef));
+        IndexRef *ref = &file->refs[file->ref_count++];
+        memset(ref, 0, sizeof(*ref));
+        ref->symbol = builder_intern(b, i);
+        ref->offset = t->offset;
+        ref->line = t->line;
+        ref->character = t->character;
+        ref->length = t->units;
+        ref->def = b->token_def[i];
+        if (b->token_module[i]) {
+            ref->flags = REF_EXTERNAL;
+            ref->qualifier = b->token_module[i];
+        } else if (member) {
+            ref->flags = REF_MEMBER;
+            if (token_is(b, i - 2, TOK_IDENT) &&
+                !token_is(b, i - 3, TOK_DOT) && !token_is(b, i - 3, TOK_QUESTION_DOT)) {
+                ref->qualifier = builder_intern(b, i - 2);
+            }
+        }
+    }
+}
+
+static FileIndex *index_source(const char *path, const char *source, ModuleCache *modules) {
+    IndexBuilder b;
+    memset(&b, 0, sizeof(b));
+    b.path = path;
+    b.source = source;
+    b.modules = modules;
+    b.tokens = tokenize(source, &b.token_count);
+
+    int count = b.token_count > 0 ? b.token_count : 1;
+    b.token_def = malloc(count * sizeof(int32_t));
+    for (int i = 0; i < b.token_count; i++) b.token_def[i] = -1;
+    b.token_module = calloc(count, sizeof(uint32_t));
+    b.token_skip = calloc(count, sizeof(bool));
+
+    b.file = calloc(1, sizeof(FileIndex));
+    b.file->path = intern_string(path);
+
+    index_declarations(&b);
+    index_occurrences(&b);
+    file_index_sort(b.file);
+
+    for (int i = 0; i < b.token_count; i++) {
+        free(b.tokens[i].string);
+    }
+    free(b.tokens);
+    free(b.token_def);
+    free(b.token_module);
+    free(b.token_skip);
+    free(b.def_depth);
+    free(b.names);
+    return b.file;
+}
+
+// Index a file from disk; a file that cannot be read gives a missing entry
+static FileIndex *index_file(ModuleCache *modules, const char *path) {
+    FileIndex *file = NULL;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        size_t size = (size_t)st.st_size;
+        char *source = malloc(size + 1);
+        size_t done = 0;
+        while (done < size) {
+            ssize_t n = read(fd, source + done, size - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            done += (size_t)n;
+        }
+        if (done == size) {
+            source[size] = '\0';
+            file = index_source(path, source, modules);
+            file->mtime_sec = (int64_t)st.st_mtim.tv_sec;
+            file->mtime_nsec = (int64_t)st.st_mtim.tv_nsec;
+            file->size = (uint64_t)st.st_size;
+        }
+        free(source);
+    }
+    if (fd >= 0) close(fd);
+
+    if (!file) {
+        file = calloc(1, sizeof(FileIndex));
+        file->path = intern_string(path);
+        file->missing = true;
+        file_index_sort(file);
+    }
+    return file;
+}
+
+// ============================================================================
+// Workspace Index
+// ============================================================================
+
+struct LSPIndex {
+    char *root;                 // Workspace root (real path), or NULL
+    ModuleCache *modules;       // Import path resolution and the stdlib location
+    char *cache_path;           // Saved index, NULL when the cache is off
+
+    pthread_mutex_t lock;       // Guards everything below
+    pthread_cond_t built;
+
+    FileIndex **files;          // By path symbol
+    uint32_t file_capacity;
+
+    // Initial build
+    pthread_t thread;
+    bool thread_started;
+    char **queue;               // Files left to index
+    uint32_t queue_count;
+    uint32_t queue_next;
+    bool ready;
+    bool cancel;
+    bool dirty;                 // Differs from the saved cache
+};
+
+// The table only ever frees entries on the thread answering requests (the
+// one calling lsp_index_update), so entries it looks up stay valid while
+// background threads add others.
+static FileIndex *file_lookup(LSPIndex *index, uint32_t path) {
+    pthread_mutex_lock(&index->lock);
+    FileIndex *file = path < index->file_capacity ? index->files[path] : NULL;
+    pthread_mutex_unlock(&index->lock);
+    return file;
+}
+
+// Add a file, keeping an existing entry unless replace is set; returns the
+// entry now in the table
+static FileIndex *file_insert(LSPIndex *index, FileIndex *file, bool replace) {
+    FileIndex *old = NULL;
+    pthread_mutex_lock(&index->lock);
+    if (file->path >= index->file_capacity) {
+        uint32_t capacity = index->file_capacity ? index->file_capacity : 1024;
+        while (capacity <= file->path) capacity *= 2;
+        index->files = realloc(index->files, capacity * sizeof(FileIndex *));
+        memset(index->files + index->file_capacity, 0,
+               (capacity - index->file_capacity) * sizeof(FileIndex *));
+        index->file_capacity = capacity;
+    }
+    FileIndex *existing = index->files[file->path];
+    if (existing && !replace) {
+        pthread_mutex_unlock(&index->lock);
+        file_index_free(file);
+        return existing;
+    }
+    old = existing;
+    index->files[file->path] = file;
+    if (!file->from_buffer && !file->missing) index->dirty = true;
+    pthread_mutex_unlock(&index->lock);
+    file_index_free(old);
+    return file;
+}
+
+// File index for a module, indexing it now if the background build has not
+// reached it (or it lies outside the workspace)
+static FileIndex *file_get(LSPIndex *index, uint32_t path) {
+    if (!path) return NULL;
+    FileIndex *file = file_lookup(index, path);
+    if (!file) {
+        file = file_insert(index, index_file(index->modules, symbol_name(path)), false);
+    }
+    return file->missing ? NULL : file;
+}
+
+// Every indexed file (caller frees the array)
+static FileIndex **file_snapshot(LSPIndex *index, uint32_t *count) {
+    pthread_mutex_lock(&index->lock);
+    FileIndex **files = malloc((index->file_capacity + 1) * sizeof(FileIndex *));
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < index->file_capacity; i++) {
+        if (index->files[i] && !index->files[i]->missing) files[n++] = index->files[i];
+    }
+    pthread_mutex_unlock(&index->lock);
+    *count = n;
+    return files;
+}
+
+// ============================================================================
+// Index Cache
+// ============================================================================
+
+// Cache layout (host byte order; the cache never leaves the machine):
+//   u32 magic, u16 format, u16 key length, key bytes,
+//   u32 symbol count, then per symbol after the first: u32 length, bytes,
+//   u32 file count, then per file a CachedFile followed by its definition,
+//   occurrence and export records, and last a u64 hash of everything before
+// The key holds the interpreter version and binary identity (as for the
+// module cache) and the workspace root. Records store symbol ids, which are
+// mapped back to this process's ids on load.
+
+#define INDEX_CACHE_MAGIC 0x58444948  // "HIDX" in little-endian
+#define INDEX_CACHE_FORMAT 1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t format;
+    uint16_t key_len;
+} CacheHeader;
+
+typedef struct {
+    uint32_t path;
+    uint32_t def_count;
+    uint32_t ref_count;
+    uint32_t export_count;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+    uint64_t size;
+} CachedFile;
+
+static char *cache_key(const char *root, size_t *len) {
+    char id[CACHE_BUILD_ID_LEN];
+    cache_build_id(id);
+    size_t id_len = strlen(id);
+    size_t root_len = root ? strlen(root) : 0;
+    if (id_len + 1 + root_len > UINT16_MAX) return NULL;
+    char *key = malloc(id_len + 1 + root_len);
+    memcpy(key, id, id_len);
+    key[id_len] = '\n';
+    if (root_len) memcpy(key + id_len + 1, root, root_len);
+    *len = id_len + 1 + root_len;
+    return key;
+}
+
+// Cache file for a workspace, or NULL when caching is off
+static char *cache_location(const char *root) {
+    char *dir = cache_dir_path("lsp");
+    if (!dir) return NULL;
+
+    const char *name = root ? root : "";
+    char path[4200];
+    snprintf(path, sizeof(path), "%s/%016llx.idx", dir,
+             (unsigned long long)hml_fnv1a64(name, strlen(name), HML_FNV1A64_OFFSET));
+    free(dir);
+    return strdup(path);
+}
+
+static int make_parent_dirs(const char *file_path) {
+    char path[4200];
+    snprintf(path, sizeof(path), "%s", file_path);
+    char *slash = strrchr(path, '/');
+    if (!slash || slash == path) return 0;
+    *slash = '\0';
+    return cache_make_dirs(path) ? 0 : -1;
+}
+
+typedef struct {
+    uint8_t *data;
+    size_t length;
+    size_t capacity;
+} ByteBuffer;
+
+static void buffer_write(ByteBuffer *buf, const void *data, size_t length) {
+    if (length == 0) return;
+    if (buf->length + length > buf->capacity) {
+        size_t capacity = buf->capacity ? buf->capacity : 65536;
+        while (buf->length + length > capacity) capacity *= 2;
+        buf->data = realloc(buf->data, capacity);
+        buf->capacity = capacity;
+    }
+    memcpy(buf->data + buf->length, data, length);
+    buf->length += length;
+}
+
+static void buffer_u32(ByteBuffer *buf, uint32_t value) {
+    buffer_write(buf, &value, sizeof(value));
+}
+
+static void save_cache(LSPIndex *index) {
+    if (!index->cache_path) return;
+    size_t key_len;
+    char *key = cache_key(index->root, &key_len);
+    if (!key) return;
+
+    ByteBuffer buf = { NULL, 0, 0 };
+    CacheHeader header = { INDEX_CACHE_MAGIC, INDEX_CACHE_FORMAT, (uint16_t)key_len };
+    buffer_write(&buf, &header, sizeof(header));
+    buffer_write(&buf, key, key_len);
+    free(key);
+
+    // Files on disk only: open documents are indexed from unsaved text
+    pthread_mutex_lock(&index->lock);
+    pthread_mutex_lock(&symbols_lock);
+    uint32_t symbols = symbol_count;
+    buffer_u32(&buf, symbols);
+    for (uint32_t id = 1; id < symbols; id++) {
+        uint32_t length = (uint32_t)strlen(symbol_names[id]);
+        buffer_u32(&buf, length);
+        buffer_write(&buf, symbol_names[id], length);
+    }
+    pthread_mutex_unlock(&symbols_lock);
+
+    size_t count_at = buf.length;
+    uint32_t file_count = 0;
+    buffer_u32(&buf, 0);
+    for (uint32_t i = 0; i < index->file_capacity; i++) {
+        FileIndex *file = index->files[i];
+        if (!file || file->from_buffer || file->missing) continue;
+        CachedFile cached = {
+            file->path, file->def_count, file->ref_count, file->export_count,
+            file->mtime_sec, file->mtime_nsec, file->size
+        };
+        buffer_write(&buf, &cached, sizeof(cached));
+        buffer_write(&buf, file->defs, file->def_count * sizeof(IndexDef));
+        buffer_write(&buf, file->refs, file->ref_count * sizeof(IndexRef));
+        buffer_write(&buf, file->exports, file->export_count * sizeof(IndexExport));
+        file_count++;
+    }
+    index->dirty = false;
+    pthread_mutex_unlock(&index->lock);
+    memcpy(buf.data + count_at, &file_count, sizeof(file_count));
+    uint64_t checksum = hml_fnv1a64(buf.data, buf.length, HML_FNV1A64_OFFSET);
+    buffer_write(&buf, &checksum, sizeof(checksum));
+
+    // Write a temporary file and rename it over the old cache
+    char tmp[4300];
+    snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", index->cache_path, (long)getpid());
+    if (make_parent_dirs(index->cache_path) == 0) {
+        int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (fd >= 0) {
+            size_t done = 0;
+            while (done < buf.length) {
+                ssize_t n = write(fd, buf.data + done, buf.length - done);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) break;
+                done += (size_t)n;
+            }
+            close(fd);
+            if (done != buf.length || rename(tmp, index->cache_path) != 0) {
+                unlink(tmp);
+            }
+        }
+    }
+    free(buf.data);
+}
+
+typedef struct {
+    const uint8_t *data;
+    size_t length;
+    size_t offset;
+    bool failed;
+} ByteReader;
+
+static const void *reader_take(ByteReader *r, size_t length) {
+    if (r->failed || length > r->length - r->offset) {
+        r->failed = true;
+        return NULL;
+    }
+    const void *p = r->data + r->offset;
+    r->offset += length;
+    return p;
+}
+
+static uint32_t reader_u32(ByteReader *r) {
+    uint32_t value = 0;
+    const void *p = reader_take(r, sizeof(value));
+    if (p) memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// Map a cached symbol id to this process's id; false when out of range
+static bool remap(const uint32_t *map, uint32_t count, uint32_t *id) {
+    if (*id >= count) return false;
+    *id = map[*id];
+    return true;
+}
+
+// Load entries whose files are unchanged on disk; returns how many. Anything
+// not loaded (missing, foreign or damaged cache) is indexed from source.
+static uint32_t load_cache(LSPIndex *index) {
+    if (!index->cache_path) return 0;
+    int fd = open(index->cache_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return 0;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(CacheHeader)) {
+        close(fd);
+        return 0;
+    }
+    size_t size = (size_t)st.st_size;
+    uint8_t *data = malloc(size);
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = read(fd, data + done, size - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        done += (size_t)n;
+    }
+    close(fd);
+    if (done != size) {
+        free(data);
+        return 0;
+    }
+
+    // A damaged cache is dropped as a whole
+    uint64_t checksum = 0;
+    if (size >= sizeof(CacheHeader) + sizeof(checksum)) {
+        size -= sizeof(checksum);
+        memcpy(&checksum, data + size, sizeof(checksum));
+    }
+    if (checksum == 0 || checksum != hml_fnv1a64(data, size, HML_FNV1A64_OFFSET)) {
+        free(data);
+        return 0;
+    }
+
+    ByteReader r = { data, size, 0, false };
+    size_t key_len;
+    char *key = cache_key(index->root, &key_len);
+    CacheHeader header;
+    memcpy(&header, reader_take(&r, sizeof(header)), sizeof(header));
+    const void *stored_key = reader_take(&r, header.key_len);
+    bool match = key && !r.failed &&
+                 header.magic == INDEX_CACHE_MAGIC &&
+                 header.format == INDEX_CACHE_FORMAT &&
+                 header.key_len == key_len &&
+                 memcmp(stored_key, key, key_len) == 0;
+    free(key);
+    if (!match) {
+        free(data);
+        return 0;
+    }
+
+    uint32_t symbols = reader_u32(&r);
+    if (r.failed || symbols == 0 || symbols > (size - r.offset) / sizeof(uint32_t) + 1) {
+        free(data);
+        return 0;
+    }
+    uint32_t *map = malloc(symbols * sizeof(uint32_t));
+    map[0] = 0;
+    for (uint32_t id = 1; id < symbols && !r.failed; id++) {
+        uint32_t length = reader_u32(&r);
+        const char *name = reader_take(&r, length);
+        map[id] = name ? intern(name, length) : 0;
+    }
+
+    uint32_t file_count = reader_u32(&r);
+    uint32_t loaded = 0;
+    bool stale = false;
+    for (uint32_t f = 0; f < file_count && !r.failed; f++) {
+        CachedFile cached;
+        const void *p = reader_take(&r, sizeof(cached));
+        if (!p) break;
+        memcpy(&cached, p, sizeof(cached));
+        const void *defs = reader_take(&r, (size_t)cached.def_count * sizeof(IndexDef));
+        const void *refs = reader_take(&r, (size_t)cached.ref_count * sizeof(IndexRef));
+        const void *exports = reader_take(&r, (size_t)cached.export_count * sizeof(IndexExport));
+        if (r.failed || !remap(map, symbols, &cached.path)) {
+            r.failed = true;
+            break;
+        }
+
+        // Only entries for files that have not changed since
+        struct stat file_st;
+        const char *path = symbol_name(cached.path);
+        if (stat(path, &file_st) != 0 || (uint64_t)file_st.st_size != cached.size ||
+            (int64_t)file_st.st_mtim.tv_sec != cached.mtime_sec ||
+            (int64_t)file_st.st_mtim.tv_nsec != cached.mtime_nsec) {
+            stale = true;
+            continue;
+        }
+
+        FileIndex *file = calloc(1, sizeof(FileIndex));
+        file->path = cached.path;
+        file->mtime_sec = cached.mtime_sec;
+        file->mtime_nsec = cached.mtime_nsec;
+        file->size = cached.size;
+        file->def_count = cached.def_count;
+        file->ref_count = cached.ref_count;
+        file->export_count = cached.export_count;
+        file->defs = malloc((cached.def_count + 1) * sizeof(IndexDef));
+        file->refs = malloc((cached.ref_count + 1) * sizeof(IndexRef));
+        file->exports = malloc((cached.export_count + 1) * sizeof(IndexExport));
+        memcpy(file->defs, defs, cached.def_count * sizeof(IndexDef));
+        memcpy(file->refs, refs, cached.ref_count * sizeof(IndexRef));
+        memcpy(file->exports, exports, cached.export_count * sizeof(IndexExport));
+
+        bool valid = true;
+        for (uint32_t i = 0; i < file->def_count && valid; i++) {
+            IndexDef *def = &file->defs[i];
+            valid = remap(map, symbols, &def->symbol) && remap(map, symbols, &def->source) &&
+                    remap(map, symbols, &def->imported);
+        }
+        for (uint32_t i = 0; i < file->ref_count && valid; i++) {
+            IndexRef *ref = &file->refs[i];
+            valid = remap(map, symbols, &ref->symbol) && remap(map, symbols, &ref->qualifier) &&
+                    ref->def >= -1 && ref->def < (int32_t)file->def_count;
+        }
+        for (uint32_t i = 0; i < file->export_count && valid; i++) {
+            IndexExport *e = &file->exports[i];
+            valid = remap(map, symbols, &e->name) && remap(map, symbols, &e->local) &&
+                    remap(map, symbols, &e->module);
+        }
+        if (!valid) {
+            file_index_free(file);
+            r.failed = true;
+            break;
+        }
+        file_index_sort(file);
+        file_insert(index, file, false);
+        loaded++;
+    }
+
+    free(map);
+    free(data);
+    pthread_mutex_lock(&index->lock);
+    // Cached entries match the file, so loading them changes nothing to save
+    index->dirty = stale || r.failed;
+    pthread_mutex_unlock(&index->lock);
+    return loaded;
+}
+
+// ============================================================================
+// Initial Build
+// ============================================================================
+
+typedef struct {
+    char **paths;
+    uint32_t count;
+    uint32_t capacity;
+} PathList;
+
+// Collect the .hml files under a directory, skipping hidden directories
+static void scan_directory(const char *dir, PathList *list, int depth) {
+    if (depth > 32) return;
+    DIR *d = opendir(dir);
+    if (!d) return;
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        char path[PATH_MAX];
+        int n = snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        if (n <= 0 || n >= (int)sizeof(path)) continue;
+
+        bool is_dir = entry->d_type == DT_DIR;
+        bool is_file = entry->d_type == DT_REG;
+        if (entry->d_type == DT_UNKNOWN) {
+            struct stat st;
+            if (lstat(path, &st) != 0) continue;
+            is_dir = S_ISDIR(st.st_mode);
+            is_file = S_ISREG(st.st_mode);
+        }
+        if (is_dir) {
+            scan_directory(path, list, depth + 1);
+        } else if (is_file && n > 4 && strcmp(path + n - 4, ".hml") == 0) {
+            char *real = realpath(path, NULL);
+            if (!real) continue;
+            list->paths = grow_array(list->paths, list->count, &list->capacity, sizeof(char *));
+            list->paths[list->count++] = real;
+        }
+    }
+    closedir(d);
+}
+
+static void *build_worker(void *arg) {
+    LSPIndex *index = arg;
+    for (;;) {
+        pthread_mutex_lock(&index->lock);
+        if (index->cancel || index->queue_next >= index->queue_count) {
+            pthread_mutex_unlock(&index->lock);
+            break;
+        }
+        char *path = index->queue[index->queue_next++];
+        pthread_mutex_unlock(&index->lock);
+
+        file_insert(index, index_file(index->modules, path), false);
+    }
+    return NULL;
+}
+
+static int compare_paths(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static void *build_index(void *arg) {
+    LSPIndex *index = arg;
+
+    PathList list = { NULL, 0, 0 };
+    if (index->root) {
+        scan_directory(index->root, &list, 0);
+    }
+    if (index->modules->stdlib_path) {
+        char *stdlib = realpath(index->modules->stdlib_path, NULL);
+        if (stdlib) {
+            scan_directory(stdlib, &list, 0);
+            free(stdlib);
+        }
+    }
+    // The stdlib may sit inside the workspace
+    qsort(list.paths, list.count, sizeof(char *), compare_paths);
+
+    uint32_t cached = load_cache(index);
+
+    pthread_mutex_lock(&index->lock);
+    index->queue = malloc((list.count + 1) * sizeof(char *));
+    for (uint32_t i = 0; i < list.count; i++) {
+        if (i > 0 && strcmp(list.paths[i], list.paths[i - 1]) == 0) continue;
+        uint32_t path = intern_string(list.paths[i]);
+        if (path < index->file_capacity && index->files[path]) continue;
+        index->queue[index->queue_count++] = list.paths[i];
+    }
+    uint32_t queued = index->queue_count;
+    pthread_mutex_unlock(&index->lock);
+
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int workers = cores > INDEX_MAX_WORKERS ? INDEX_MAX_WORKERS : (cores > 1 ? (int)cores : 1);
+    if ((uint32_t)workers > queued) workers = queued > 0 ? (int)queued : 1;
+    pthread_t threads[INDEX_MAX_WORKERS];
+    int started = 0;
+    for (int i = 1; i < workers; i++) {
+        if (pthread_create(&threads[started], NULL, build_worker, index) == 0) started++;
+    }
+    build_worker(index);
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    pthread_mutex_lock(&index->lock);
+    index->ready = true;
+    pthread_cond_broadcast(&index->built);
+    bool save = index->dirty && !index->cancel;
+    pthread_mutex_unlock(&index->lock);
+
+    fprintf(stderr, "LSP: Indexed %u files (%u from cache)\n", queued + cached, cached);
+
+    if (save) save_cache(index);
+
+    for (uint32_t i = 0; i < list.count; i++) {
+        free(list.paths[i]);
+    }
+    free(list.paths);
+    return NULL;
+}
+
+LSPIndex *lsp_index_create(const char *root_path) {
+    LSPIndex *index = calloc(1, sizeof(LSPIndex));
+    index->root = root_path ? realpath(root_path, NULL) : NULL;
+    index->modules = module_cache_new(index->root ? index->root : ".");
+    index->cache_path = cache_location(index->root);
+    pthread_mutex_init(&index->lock, NULL);
+    pthread_cond_init(&index->built, NULL);
+
+    if (pthread_create(&index->thread, NULL, build_index, index) == 0) {
+        index->thread_started = true;
+    } else {
+        index->ready = true;
+    }
+    return index;
+}
+
+void lsp_index_wait(LSPIndex *index) {
+    pthread_mutex_lock(&index->lock);
+    while (!index->ready) {
+        pthread_cond_wait(&index->built, &index->lock);
+    }
+    pthread_mutex_unlock(&index->lock);
+}
+
+void lsp_index_free(LSPIndex *index) {
+    if (!index) return;
+    pthread_mutex_lock(&index->lock);
+    index->cancel = true;
+    pthread_mutex_unlock(&index->lock);
+    if (index->thread_started) {
+        pthread_join(index->thread, NULL);
+    }
+    if (index->dirty) {
+        save_cache(index);
+    }
+
+    for (uint32_t i = 0; i < index->file_capacity; i++) {
+        file_index_free(index->files[i]);
+    }
+    free(index->files);
+    free(index->queue);
+    free(index->root);
+    free(index->cache_path);
+    module_cache_free(index->modules);
+    pthread_mutex_destroy(&index->lock);
+    pthread_cond_destroy(&index->built);
+    free(index);
+}
+
+void lsp_index_update(LSPIndex *index, const char *path, const char *text) {
+    FileIndex *file;
+    if (text) {
+        file = index_source(path, text, index->modules);
+        file->from_buffer = true;
+    } else {
+        file = index_file(index->modules, path);
+    }
+    file_insert(index, file, true);
+}
+
+void lsp_index_remove(LSPIndex *index, const char *path) {
+    uint32_t id = intern_string(path);
+    pthread_mutex_lock(&index->lock);
+    FileIndex *file = id < index->file_capacity ? index->files[id] : NULL;
+    if (file) {
+        index->files[id] = NULL;
+        index->dirty = true;
+    }
+    pthread_mutex_unlock(&index->lock);
+    file_index_free(file);
+}
+
+// ============================================================================
+// Resolution
+// ============================================================================
+
+typedef struct {
+    FileIndex *file;
+    int def;
+} Target;
+
+// Occurrence at a position (the cursor may sit just past the name)
+static int ref_at(const FileIndex *file, LSPPosition pos) {
+    uint32_t lo = 0;
+    uint32_t hi = file->ref_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        const IndexRef *ref = &file->refs[mid];
+        if (ref->line < pos.line || (ref->line == pos.line && ref->character <= pos.character)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == 0) return -1;
+    const IndexRef *ref = &file->refs[lo - 1];
+    if (ref->line != pos.line || pos.character > ref->character + ref->length) return -1;
+    return (int)(lo - 1);
+}
+
+// Innermost definition of a name visible at offset
+static int find_local(const FileIndex *file, uint32_t symbol, uint32_t offset) {
+    uint32_t end;
+    uint32_t i = symbol_run(file->defs_by_symbol, file->def_count, file->defs,
+                            sizeof(IndexDef), symbol, &end);
+    int best = -1;
+    for (; i < end; i++) {
+        int d = (int)file->defs_by_symbol[i];
+        const IndexDef *def = &file->defs[d];
+        if (def->kind == LSP_DEF_ENUM_MEMBER) continue;
+        if (offset < def->scope_start || offset >= def->scope_end) continue;
+        if (best < 0) {
+            best = d;
+            continue;
+        }
+        const IndexDef *current = &file->defs[best];
+        if (def->scope_start > current->scope_start) {
+            best = d;
+        } else if (def->scope_start == current->scope_start && def->offset <= offset &&
+                   (current->offset > offset || def->offset > current->offset)) {
+            // Same scope: the latest declaration before the use
+            best = d;
+        }
+    }
+    return best;
+}
+
+static int find_top_level(const FileIndex *file, uint32_t symbol) {
+    uint32_t end;
+    uint32_t i = symbol_run(file->defs_by_symbol, file->def_count, file->defs,
+                            sizeof(IndexDef), symbol, &end);
+    for (; i < end; i++) {
+        int d = (int)file->defs_by_symbol[i];
+        if (file->defs[d].flags & DEF_TOP_LEVEL) return d;
+    }
+    return -1;
+}
+
+static int find_member(const FileIndex *file, uint32_t owner, uint32_t symbol) {
+    uint32_t end;
+    uint32_t i = symbol_run(file->defs_by_symbol, file->def_count, file->defs,
+                            sizeof(IndexDef), symbol, &end);
+    for (; i < end; i++) {
+        int d = (int)file->defs_by_symbol[i];
+        if (file->defs[d].kind == LSP_DEF_ENUM_MEMBER && file->defs[d].source == owner) return d;
+    }
+    return -1;
+}
+
+static bool find_export(LSPIndex *index, uint32_t module, uint32_t name, int depth, Target *out);
+
+// Follow an imported name to its definition in the exporting module
+static void follow_import(LSPIndex *index, Target *target, int depth) {
+    const IndexDef *def = &target->file->defs[target->def];
+    if (def->kind != LSP_DEF_IMPORT || !def->source) return;
+    Target next;
+    if (find_export(index, def->source, def->imported, depth + 1, &next)) {
+        *target = next;
+    }
+}
+
+static bool find_export(LSPIndex *index, uint32_t module, uint32_t name, int depth, Target *out) {
+    if (depth > INDEX_MAX_DEPTH) return false;
+    FileIndex *file = file_get(index, module);
+    if (!file) return false;
+
+    for (uint32_t i = 0; i < file->export_count; i++) {
+        const IndexExport *e = &file->exports[i];
+        if (e->name != name) continue;
+        if (e->module) {
+            return find_export(index, e->module, e->local, depth + 1, out);
+        }
+        int d = find_top_level(file, e->local);
+        if (d >= 0) {
+            *out = (Target){ file, d };
+            follow_import(index, out, depth);
+            return true;
+        }
+    }
+
+    // Tolerate a missing export: the name still has one obvious meaning
+    int d = find_top_level(file, name);
+    if (d < 0) return false;
+    *out = (Target){ file, d };
+    follow_import(index, out, depth);
+    return true;
+}
+
+static bool resolve_ref(LSPIndex *index, FileIndex *file, const IndexRef *ref, Target *out) {
+    if (ref->def >= 0) {
+        *out = (Target){ file, ref->def };
+        follow_import(index, out, 0);
+        return true;
+    }
+    if (ref->flags & REF_EXTERNAL) {
+        return find_export(index, ref->qualifier, ref->symbol, 0, out);
+    }
+    if (ref->flags & REF_MEMBER) {
+        // Only `namespace.name` and `Enum.MEMBER` resolve statically
+        if (!ref->qualifier) return false;
+        int q = find_local(file, ref->qualifier, ref->offset);
+        if (q < 0) return false;
+        Target owner = { file, q };
+        follow_import(index, &owner, 0);
+        const IndexDef *def = &owner.file->defs[owner.def];
+        if (def->kind == LSP_DEF_NAMESPACE) {
+            return find_export(index, def->source, ref->symbol, 0, out);
+        }
+        if (def->kind == LSP_DEF_ENUM) {
+            int m = find_member(owner.file, def->symbol, ref->symbol);
+            if (m < 0) return false;
+            *out = (Target){ owner.file, m };
+            return true;
+        }
+        return false;
+    }
+
+    int d = find_local(file, ref->symbol, ref->offset);
+    if (d < 0) return false;
+    *out = (Target){ file, d };
+    follow_import(index, out, 0);
+    return true;
+}
+
+static bool resolve_position(LSPIndex *index, const char *path, LSPPosition pos, Target *out) {
+    FileIndex *file = file_get(index, intern_string(path));
+    if (!file) return false;
+    int r = ref_at(file, pos);
+    if (r < 0) return false;
+    return resolve_ref(index, file, &file->refs[r], out);
+}
+
+// ============================================================================
+// Queries
+// ============================================================================
+
+static void fill_location(LSPSymbolLocation *out, const FileIndex *file, uint32_t symbol,
+                          int line, int character, int length, const IndexDef *def) {
+    out->name = strdup(symbol_name(symbol));
+    out->path = strdup(symbol_name(file->path));
+    out->range.start.line = line;
+    out->range.start.character = character;
+    out->range.end.line = line;
+    out->range.end.character = character + length;
+    out->kind = (LSPDefKind)def->kind;
+    out->exported = (def->flags & DEF_EXPORTED) != 0;
+}
+
+static void fill_definition(LSPSymbolLocation *out, const Target *target) {
+    const IndexDef *def = &target->file->defs[target->def];
+    fill_location(out, target->file, def->symbol, def->line, def->character, def->length, def);
+}
+
+bool lsp_index_definition(LSPIndex *index, const char *path, LSPPosition pos,
+                          LSPSymbolLocation *out) {
+    Target target;
+    if (!resolve_position(index, path, pos, &target)) return false;
+    fill_definition(out, &target);
+
+    // A namespace is defined by its module
+    const IndexDef *def = &target.file->defs[target.def];
+    if (def->kind == LSP_DEF_NAMESPACE && def->source && file_get(index, def->source)) {
+        free(out->path);
+        out->path = strdup(symbol_name(def->source));
+        out->range.start.line = out->range.end.line = 0;
+        out->range.start.character = out->range.end.character = 0;
+    }
+    return true;
+}
+
+typedef struct {
+    uint32_t *items;
+    uint32_t count;
+    uint32_t capacity;
+} SymbolSet;
+
+static bool set_add(SymbolSet *set, uint32_t symbol) {
+    for (uint32_t i = 0; i < set->count; i++) {
+        if (set->items[i] == symbol) return false;
+    }
+    set->items = grow_array(set->items, set->count, &set->capacity, sizeof(uint32_t));
+    set->items[set->count++] = symbol;
+    return true;
+}
+
+static bool set_has(const SymbolSet *set, uint32_t symbol) {
+    for (uint32_t i = 0; i < set->count; i++) {
+        if (set->items[i] == symbol) return true;
+    }
+    return false;
+}
+
+int lsp_index_references(LSPIndex *index, const char *path, LSPPosition pos,
+                         bool include_declaration, LSPSymbolLocation **out) {
+    *out = NULL;
+    lsp_index_wait(index);
+
+    Target target;
+    if (!resolve_position(index, path, pos, &target)) return 0;
+    const IndexDef *target_def = &target.file->defs[target.def];
+
+    uint32_t file_count;
+    FileIndex **files = file_snapshot(index, &file_count);
+
+    // Names the symbol goes by: its own, plus import and export aliases
+    SymbolSet names = { NULL, 0, 0 };
+    set_add(&names, target_def->symbol);
+    bool grew = true;
+    while (grew) {
+        grew = false;
+        for (uint32_t f = 0; f < file_count; f++) {
+            FileIndex *file = files[f];
+            for (uint32_t i = 0; i < file->export_count; i++) {
+                if (set_has(&names, file->exports[i].local)) {
+                    grew |= set_add(&names, file->exports[i].name);
+                }
+            }
+            for (uint32_t i = 0; i < file->def_count; i++) {
+                const IndexDef *def = &file->defs[i];
+                if (def->kind == LSP_DEF_IMPORT && set_has(&names, def->imported)) {
+                    grew |= set_add(&names, def->symbol);
+                }
+            }
+        }
+    }
+
+    // Occurrences of those names that resolve to the same definition
+    LSPSymbolLocation *results = NULL;
+    uint32_t result_count = 0;
+    uint32_t result_capacity = 0;
+    for (uint32_t f = 0; f < file_count; f++) {
+        FileIndex *file = files[f];
+        for (uint32_t s = 0; s < names.count; s++) {
+            uint32_t end;
+            uint32_t i = symbol_run(file->refs_by_symbol, file->ref_count, file->refs,
+                                    sizeof(IndexRef), names.items[s], &end);
+            for (; i < end; i++) {
+                const IndexRef *ref = &file->refs[file->refs_by_symbol[i]];
+                Target found;
+                if (!resolve_ref(index, file, ref, &found)) continue;
+                if (found.file != target.file || found.def != target.def) continue;
+                if (!include_declaration && file == target.file && ref->def == target.def) continue;
+
+                results = grow_array(results, result_count, &result_capacity, sizeof(LSPSymbolLocation));
+                fill_location(&results[result_count++], file, ref->symbol, ref->line,
+                              ref->character, ref->length, target_def);
+            }
+        }
+    }
+
+    free(names.items);
+    free(files);
+    *out = results;
+    return (int)result_count;
+}
+
+// Case-insensitive substring test
+static bool name_matches(const char *name, const char *query) {
+    if (!query[0]) return true;
+    for (const char *start = name; *start; start++) {
+        const char *n = start;
+        const char *q = query;
+        while (*n && *q && tolower((unsigned char)*n) == tolower((unsigned char)*q)) {
+            n++;
+            q++;
+        }
+        if (!*q) return true;
+    }
+    return false;
+}
+
+int lsp_index_workspace_symbols(LSPIndex *index, const char *query, int limit,
+                                LSPSymbolLocation **out) {
+    *out = NULL;
+    lsp_index_wait(index);
+
+    uint32_t file_count;
+    FileIndex **files = file_snapshot(index, &file_count);
+    LSPSymbolLocation *results = NULL;
+    uint32_t result_count = 0;
+    uint32_t result_capacity = 0;
+    for (uint32_t f = 0; f < file_count && (int)result_count < limit; f++) {
+        FileIndex *file = files[f];
+        for (uint32_t i = 0; i < file->def_count && (int)result_count < limit; i++) {
+            const IndexDef *def = &file->defs[i];
+            if (!(def->flags & DEF_TOP_LEVEL) ||
+                def->kind == LSP_DEF_IMPORT || def->kind == LSP_DEF_NAMESPACE) {
+                continue;
+            }
+            if (!name_matches(symbol_name(def->symbol), query)) continue;
+            results = grow_array(results, result_count, &result_capacity, sizeof(LSPSymbolLocation));
+            fill_definition(&results[result_count++], &(Target){ file, (int)i });
+        }
+    }
+    free(files);
+    *out = results;
+    return (int)result_count;
+}
+
+int lsp_index_visible_symbols(LSPIndex *index, const char *path, LSPPosition pos,
+                              LSPSymbolLocation **out) {
+    *out = NULL;
+    FileIndex *file = file_get(index, intern_string(path));
+    if (!file) return 0;
+
+    // Scopes only change at braces, so the nearest occurrence before the
+    // position stands in for its offset
+    uint32_t offset = 0;
+    for (uint32_t lo = 0, hi = file->ref_count; lo < hi;) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        const IndexRef *ref = &file->refs[mid];
+        if (ref->line < pos.line || (ref->line == pos.line && ref->character <= pos.character)) {
+            offset = ref->offset;
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    LSPSymbolLocation *results = NULL;
+    uint32_t result_count = 0;
+    uint32_t result_capacity = 0;
+    for (uint32_t i = 0; i < file->def_count;) {
+        uint32_t symbol = file->defs[file->defs_by_symbol[i]].symbol;
+        uint32_t end;
+        symbol_run(file->defs_by_symbol + i, file->def_count - i, file->defs,
+                   sizeof(IndexDef), symbol, &end);
+        i += end;
+        int d = find_local(file, symbol, offset);
+        if (d < 0) continue;
+        results = grow_array(results, result_count, &result_capacity, sizeof(LSPSymbolLocation));
+        fill_definition(&results[result_count++], &(Target){ file, d });
+    }
+    *out = results;
+    return (int)result_count;
+}
+
+void lsp_symbol_location_free(LSPSymbolLocation *location) {
+    free(location->name);
+    free(location->path);
+    location->name = NULL;
+    location->path = NULL;
+}
+
+void lsp_symbol_locations_free(LSPSymbolLocation *locations, int count) {
+    for (int i = 0; i < count; i++) {
+        lsp_symbol_location_free(&locations[i]);
+    }
+    free(locations);
+}
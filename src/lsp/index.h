@@ -0,0 +1,113 @@
+/*
+ * Workspace symbol index
+ *
+ * Every .hml file under the workspace root and the stdlib is reduced to a
+ * compact per-file index: its definitions (with the byte range each one is
+ * visible in), every identifier occurrence, its imports and its exports.
+ * Names, and the module paths they come from, are interned into one symbol
+ * table, so everything else is plain integers.
+ *
+ * Files are indexed from tokens rather than the AST, which keeps indexing
+ * thread-safe and tolerant of syntax errors. The initial build runs on
+ * background threads; open documents are re-indexed from the editor buffer
+ * as they change. Between sessions the index is kept in
+ * $XDG_CACHE_HOME/hemlock/lsp (or ~/.cache/hemlock/lsp), one file per
+ * workspace, and files whose size and mtime still match are not re-read.
+ * HEMLOCK_NO_CACHE=1 turns the cache off.
+ *
+ * Lookups resolve an occurrence to its definition: the innermost local
+ * definition in scope, else an import followed into the exporting module
+ * (through re-exports), else `ns.name` through a namespace import.
+ */
+
+#ifndef HEMLOCK_LSP_INDEX_H
+#define HEMLOCK_LSP_INDEX_H
+
+#include "lsp.h"
+
+#include <stdbool.h>
+
+typedef struct LSPIndex LSPIndex;
+
+typedef enum {
+    LSP_DEF_VARIABLE,
+    LSP_DEF_CONSTANT,
+    LSP_DEF_FUNCTION,
+    LSP_DEF_PARAMETER,
+    LSP_DEF_TYPE,           // define
+    LSP_DEF_ENUM,
+    LSP_DEF_ENUM_MEMBER,
+    LSP_DEF_IMPORT,         // import { name as alias }
+    LSP_DEF_NAMESPACE       // import * as ns
+} LSPDefKind;
+
+/*
+ * A definition or occurrence found by a lookup
+ */
+typedef struct {
+    char *name;
+    char *path;             // Absolute file path
+    LSPRange range;         // The name itself
+    LSPDefKind kind;        // Kind of the definition
+    bool exported;
+} LSPSymbolLocation;
+
+/*
+ * Create the index for a workspace (root_path may be NULL) and start
+ * building it in the background
+ */
+LSPIndex *lsp_index_create(const char *root_path);
+
+/*
+ * Stop indexing, save the cache and free the index
+ */
+void lsp_index_free(LSPIndex *index);
+
+/*
+ * Block until the initial build has finished
+ */
+void lsp_index_wait(LSPIndex *index);
+
+/*
+ * Re-index a file from an editor buffer, or from disk when text is NULL
+ * (a closed document, or a file changed outside the editor)
+ */
+void lsp_index_update(LSPIndex *index, const char *path, const char *text);
+
+/*
+ * Forget a deleted file
+ */
+void lsp_index_remove(LSPIndex *index, const char *path);
+
+/*
+ * Definition of the identifier at a position
+ */
+bool lsp_index_definition(LSPIndex *index, const char *path, LSPPosition pos,
+                          LSPSymbolLocation *out);
+
+/*
+ * Every occurrence, in any indexed file, of the symbol at a position.
+ * Returns the count; *out is an array the caller frees with
+ * lsp_symbol_locations_free.
+ */
+int lsp_index_references(LSPIndex *index, const char *path, LSPPosition pos,
+                         bool include_declaration, LSPSymbolLocation **out);
+
+/*
+ * Top-level definitions whose name contains query (case-insensitive),
+ * across the workspace, at most limit of them
+ */
+int lsp_index_workspace_symbols(LSPIndex *index, const char *query, int limit,
+                                LSPSymbolLocation **out);
+
+/*
+ * Definitions visible at a position in a file, the innermost one per name
+ * (locals, top-level definitions and imports)
+ */
+int lsp_index_visible_symbols(LSPIndex *index, const char *path, LSPPosition pos,
+                              LSPSymbolLocation **out);
+
+void lsp_symbol_location_free(LSPSymbolLocation *location);
+void lsp_symbol_locations_free(LSPSymbolLocation *locations, int count);
+
+#endif // HEMLOCK_LSP_INDEX_H
@@ -5,15 +5,20 @@
 #include "lsp.h"
 #include "protocol.h"
 #include "handlers.h"
+#include "text_buffer.h"
+#include "index.h"
 
 #include "../../include/lexer.h"
 #include "../../include/parser.h"
 #include "../../include/ast.h"
+#include "../../include/fnv1a.h"
 
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <poll.h>
+#include <time.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -23,13 +28,17 @@
 // LSP Server Lifecycle
 // ============================================================================
 
+static void document_free(LSPDocument *doc);
+
 LSPServer *lsp_server_create(void) {
     LSPServer *server = calloc(1, sizeof(LSPServer));
     server->input_fd = STDIN_FILENO;
     server->output_fd = STDOUT_FILENO;
     server->initialized = false;
     server->shutdown = false;
-    server->documents = NULL;
+    server->document_bucket_count = 16;
+    server->documents = calloc(server->document_bucket_count, sizeof(LSPDocument *));
+    server->document_count = 0;
     server->root_uri = NULL;
     server->root_path = NULL;
     return server;
@@ -39,26 +48,164 @@ void lsp_server_free(LSPServer *server) {
     if (!server) return;
 
     // Free all documents
-    LSPDocument *doc = server->documents;
-    while (doc) {
-        LSPDocument *next = doc->next;
-        free(doc->uri);
-        free(doc->content);
-        lsp_document_clear_diagnostics(doc);
-        // Note: doc->ast is owned by the interpreter, not freed here
-        free(doc);
-        doc = next;
+    for (int i = 0; i < server->document_bucket_count; i++) {
+        LSPDocument *doc = server->documents[i];
+        while (doc) {
+            LSPDocument *next = doc->next;
+            document_free(doc);
+            doc = next;
+        }
     }
+    free(server->documents);
 
+    lsp_index_free(server->index);
     free(server->root_uri);
     free(server->root_path);
     free(server);
 }
 
+// ============================================================================
+// Statement Spans
+// ============================================================================
+
+// Arena shared by the statements of one parse; freed with the last of them
+typedef struct {
+    AstArena *arena;
+    int refs;
+} LSPParseChunk;
+
+typedef struct {
+    size_t offset;          // From the start of the statement's span
+    size_t length;
+    char *message;
+} LSPStatementError;
+
+// One top-level statement. Spans tile the text: each runs from the end of
+// the previous statement to the end of its own last token, and the last
+// entry (no statement) holds whatever trails the final statement.
+typedef struct LSPStatement {
+    size_t length;          // Bytes in the span
+    int newlines;           // Line breaks in the span
+    int lead_lines;         // Line breaks before the statement's first token
+    Stmt *stmt;
+    LSPParseChunk *chunk;   // Owns stmt
+    LSPStatementError *errors;
+    int error_count;
+    bool dirty;             // Edited since it was parsed
+    bool recovering;        // Parser was still skipping an error after it
+} LSPStatement;
+
+static void chunk_release(LSPParseChunk *chunk) {
+    if (chunk && --chunk->refs == 0) {
+        ast_arena_free(chunk->arena);
+        free(chunk);
+    }
+}
+
+static void statement_release(LSPStatement *entry) {
+    chunk_release(entry->chunk);
+    for (int i = 0; i < entry->error_count; i++) {
+        free(entry->errors[i].message);
+    }
+    free(entry->errors);
+    entry->stmt = NULL;
+    entry->chunk = NULL;
+    entry->errors = NULL;
+    entry->error_count = 0;
+}
+
+// Replace entries [first, last] with count new ones
+static void statements_splice(LSPDocument *doc, int first, int last,
+                              const LSPStatement *entries, int count) {
+    for (int i = first; i <= last; i++) {
+        statement_release(&doc->statements[i]);
+    }
+    int removed = last - first + 1;
+    int needed = doc->statement_count - removed + count;
+    if (needed > doc->statement_capacity) {
+        while (doc->statement_capacity < needed) {
+            doc->statement_capacity = doc->statement_capacity ? doc->statement_capacity * 2 : 16;
+        }
+        doc->statements = realloc(doc->statements,
+                                  doc->statement_capacity * sizeof(LSPStatement));
+    }
+    memmove(&doc->statements[first + count], &doc->statements[last + 1],
+            (doc->statement_count - last - 1) * sizeof(LSPStatement));
+    memcpy(&doc->statements[first], entries, count * sizeof(LSPStatement));
+    doc->statement_count = needed;
+}
+
+// Forget the parse: the whole text becomes one edited span
+static void statements_reset(LSPDocument *doc) {
+    LSPStatement whole = {
+        .length = doc->text->length,
+        .newlines = doc->text->newlines,
+        .dirty = true
+    };
+    if (doc->statement_count == 0) {
+        doc->statement_capacity = 16;
+        doc->statements = malloc(doc->statement_capacity * sizeof(LSPStatement));
+        doc->statements[0] = whole;
+        doc->statement_count = 1;
+    } else {
+        statements_splice(doc, 0, doc->statement_count - 1, &whole, 1);
+    }
+    doc->parse_pending = true;
+}
+
 // ============================================================================
 // Document Management
 // ============================================================================
 
+static uint32_t uri_hash(const char *uri) {
+    return (uint32_t)hml_fnv1a64(uri, strlen(uri), HML_FNV1A64_OFFSET);
+}
+
+static void documents_grow(LSPServer *server) {
+    int count = server->document_bucket_count * 2;
+    LSPDocument **buckets = calloc(count, sizeof(LSPDocument *));
+    for (int i = 0; i < server->document_bucket_count; i++) {
+        LSPDocument *doc = server->documents[i];
+        while (doc) {
+            LSPDocument *next = doc->next;
+            LSPDocument **bucket = &buckets[doc->uri_hash & (count - 1)];
+            doc->next = *bucket;
+            *bucket = doc;
+            doc = next;
+        }
+    }
+    free(server->documents);
+    server->documents = buckets;
+    server->document_bucket_count = count;
+}
+
+static void invalidate_ast(LSPDocument *doc) {
+    free(doc->ast);
+    doc->ast = NULL;
+    doc->ast_stmt_count = 0;
+    doc->ast_valid = false;
+}
+
+static void invalidate_text(LSPDocument *doc) {
+    free(doc->content);
+    doc->content = NULL;
+    invalidate_ast(doc);
+}
+
+static void document_free(LSPDocument *doc) {
+    for (int i = 0; i < doc->statement_count; i++) {
+        statement_release(&doc->statements[i]);
+    }
+    free(doc->statements);
+    invalidate_text(doc);
+    text_buffer_free(doc->text);
+    free(doc->text);
+    lsp_document_clear_diagnostics(doc);
+    free(doc->uri);
+    free(doc->path);
+    free(doc);
+}
+
 LSPDocument *lsp_document_open(LSPServer *server, const char *uri, const char *content, int version) {
     // Check if already open
     LSPDocument *existing = lsp_document_find(server, uri);
@@ -70,42 +217,118 @@ LSPDocument *lsp_document_open(LSPServer *server, const char *uri, const char *c
     // Create new document
     LSPDocument *doc = calloc(1, sizeof(LSPDocument));
     doc->uri = strdup(uri);
-    doc->content = strdup(content);
+    doc->uri_hash = uri_hash(uri);
+    doc->path = lsp_uri_to_path(uri);
+    if (!doc->path) {
+        doc->path = strdup(uri);
+    }
+    doc->index_stale = true;
+    doc->text = malloc(sizeof(LSPTextBuffer));
+    text_buffer_init(doc->text, content);
     doc->version = version;
     doc->ast = NULL;
     doc->ast_stmt_count = 0;
     doc->ast_valid = false;
     doc->diagnostics = NULL;
     doc->diagnostic_count = 0;
+    statements_reset(doc);
 
-    // Add to list
-    doc->next = server->documents;
-    server->documents = doc;
+    // Add to the table
+    if (server->document_count >= server->document_bucket_count) {
+        documents_grow(server);
+    }
+    LSPDocument **bucket = &server->documents[doc->uri_hash & (server->document_bucket_count - 1)];
+    doc->next = *bucket;
+    *bucket = doc;
+    server->document_count++;
 
     return doc;
 }
 
 void lsp_document_update(LSPDocument *doc, const char *content, int version) {
-    free(doc->content);
-    doc->content = strdup(content);
+    text_buffer_free(doc->text);
+    text_buffer_init(doc->text, content);
     doc->version = version;
-    doc->ast_valid = false;
+    doc->index_stale = true;
+    invalidate_text(doc);
+    statements_reset(doc);
+}
 
-    // Clear old diagnostics
-    lsp_document_clear_diagnostics(doc);
+void lsp_document_edit(LSPDocument *doc, LSPRange range, const char *text, int version) {
+    size_t start = text_buffer_offset(doc->text, range.start);
+    size_t end = text_buffer_offset(doc->text, range.end);
+    if (end < start) {
+        size_t swap = start;
+        start = end;
+        end = swap;
+    }
+    size_t text_length = strlen(text);
+    int removed_newlines = text_buffer_count_newlines(doc->text, start, end);
+
+    text_buffer_replace(doc->text, start, end, text, text_length);
+    doc->version = version;
+    doc->index_stale = true;
+    invalidate_text(doc);
+
+    int added_newlines = 0;
+    for (size_t i = 0; i < text_length; i++) {
+        if (text[i] == '\n') added_newlines++;
+    }
+
+    // Statements whose spans touch the edited range (ends included, since
+    // typing right after a statement can extend it) merge into one edited
+    // span, together with the statement before them, whose parse looked one
+    // token ahead into the edited text
+    size_t pos = 0;
+    int first = -1;
+    int last = -1;
+    for (int i = 0; i < doc->statement_count; i++) {
+        size_t span_end = pos + doc->statements[i].length;
+        if (pos > end) break;
+        if (span_end >= start) {
+            if (first < 0) first = i;
+            last = i;
+        }
+        pos = span_end;
+    }
+    if (first < 0) {
+        first = last = doc->statement_count - 1;
+    }
+    if (first > 0) {
+        first--;
+    }
+
+    LSPStatement merged = {
+        .length = text_length - (end - start),
+        .newlines = added_newlines - removed_newlines,
+        .dirty = true,
+        .recovering = doc->statements[last].recovering
+    };
+    for (int i = first; i <= last; i++) {
+        merged.length += doc->statements[i].length;
+        merged.newlines += doc->statements[i].newlines;
+    }
+    statements_splice(doc, first, last, &merged, 1);
+    doc->parse_pending = true;
 }
 
 void lsp_document_close(LSPServer *server, const char *uri) {
-    LSPDocument **prev = &server->documents;
-    LSPDocument *doc = server->documents;
+    uint32_t hash = uri_hash(uri);
+    LSPDocument **prev = &server->documents[hash & (server->document_bucket_count - 1)];
+    LSPDocument *doc = *prev;
 
     while (doc) {
-        if (strcmp(doc->uri, uri) == 0) {
+        if (doc->uri_hash == hash && strcmp(doc->uri, uri) == 0) {
             *prev = doc->next;
-            free(doc->uri);
-            free(doc->content);
-            lsp_document_clear_diagnostics(doc);
-            free(doc);
+            if (doc->diagnostics_due) {
+                server->pending_diagnostics--;
+            }
+            // Back to what is on disk
+            if (server->index) {
+                lsp_index_update(server->index, doc->path, NULL);
+            }
+            server->document_count--;
+            document_free(doc);
             return;
         }
         prev = &doc->next;
@@ -114,9 +337,11 @@ void lsp_document_close(LSPServer *server, const char *uri) {
 }
 
 LSPDocument *lsp_document_find(LSPServer *server, const char *uri) {
-    LSPDocument *doc = server->documents;
+    if (!uri) return NULL;
+    uint32_t hash = uri_hash(uri);
+    LSPDocument *doc = server->documents[hash & (server->document_bucket_count - 1)];
     while (doc) {
-        if (strcmp(doc->uri, uri) == 0) {
+        if (doc->uri_hash == hash && strcmp(doc->uri, uri) == 0) {
             return doc;
         }
         doc = doc->next;
@@ -124,6 +349,28 @@ LSPDocument *lsp_document_find(LSPServer *server, const char *uri) {
     return NULL;
 }
 
+const char *lsp_document_text(LSPDocument *doc) {
+    if (!doc->content) {
+        doc->content = text_buffer_substring(doc->text, 0, doc->text->length);
+    }
+    return doc->content;
+}
+
+void lsp_document_sync_index(LSPServer *server, LSPDocument *doc) {
+    if (!server->index || !doc->index_stale) return;
+    lsp_index_update(server->index, doc->path, lsp_document_text(doc));
+    doc->index_stale = false;
+}
+
+void lsp_server_sync_index(LSPServer *server) {
+    if (!server->index) return;
+    for (int i = 0; i < server->document_bucket_count; i++) {
+        for (LSPDocument *doc = server->documents[i]; doc; doc = doc->next) {
+            lsp_document_sync_index(server, doc);
+        }
+    }
+}
+
 // ============================================================================
 // Diagnostics
 // ============================================================================
@@ -154,78 +401,329 @@ void lsp_document_add_diagnostic(LSPDocument *doc, LSPRange range,
     diag->message = strdup(message);
 }
 
+#define LSP_DIAGNOSTIC_DELAY_MS 150
+
+static int64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void lsp_document_schedule_diagnostics(LSPServer *server, LSPDocument *doc) {
+    if (!doc->diagnostics_due) {
+        server->pending_diagnostics++;
+    }
+    doc->diagnostics_due = now_ms() + LSP_DIAGNOSTIC_DELAY_MS;
+}
+
+// Publish diagnostics that have come due; returns the milliseconds until the
+// next one does (-1 when none are scheduled)
+static int publish_due_diagnostics(LSPServer *server) {
+    if (server->pending_diagnostics == 0) return -1;
+
+    int64_t now = now_ms();
+    int64_t next = -1;
+    for (int i = 0; i < server->document_bucket_count; i++) {
+        for (LSPDocument *doc = server->documents[i]; doc; doc = doc->next) {
+            if (!doc->diagnostics_due) continue;
+            if (doc->diagnostics_due <= now) {
+                doc->diagnostics_due = 0;
+                server->pending_diagnostics--;
+                lsp_document_parse(doc);
+                lsp_publish_diagnostics(server, doc);
+                lsp_document_sync_index(server, doc);
+            } else if (next < 0 || doc->diagnostics_due < next) {
+                next = doc->diagnostics_due;
+            }
+        }
+    }
+    return next < 0 ? -1 : (int)(next - now);
+}
+
 // ============================================================================
 // Parsing and Diagnostics Collection
 // ============================================================================
 
-// This function is called by parser errors
-// We need to hook into the parser's error reporting
-void lsp_document_parse(LSPDocument *doc) {
-    lsp_document_clear_diagnostics(doc);
+typedef struct {
+    const char *text;
+    size_t text_length;
+    Lexer *lexer;
+    size_t first_token;         // Statement being parsed
+    size_t first_token_length;
+    LSPStatementError *errors;  // Reported since the last statement ended
+    int count;
+    int capacity;
+} ErrorCollector;
+
+static void collect_error(void *data, const Token *token, const char *message) {
+    ErrorCollector *collector = data;
+    LSPStatementError error = { .message = strdup(message) };
+
+    // Lexer errors carry their message in place of the source text
+    const char *start = token->start;
+    size_t length = token->type == TOK_EOF ? 0 : (size_t)token->length;
+    if (token->type == TOK_ERROR) {
+        start = collector->lexer->start;
+        length = (size_t)(collector->lexer->current - collector->lexer->start);
+    }
+    error.offset = (size_t)(start - collector->text);
+    error.length = length;
+
+    // Errors "at" the previous token may point into the statement before;
+    // report those on this statement's first token instead
+    if (error.offset <= collector->first_token) {
+        error.offset = collector->first_token;
+        error.length = collector->first_token_length;
+    }
 
-    if (!doc->content) return;
+    if (collector->count == collector->capacity) {
+        collector->capacity = collector->capacity ? collector->capacity * 2 : 4;
+        collector->errors = realloc(collector->errors,
+                                    collector->capacity * sizeof(LSPStatementError));
+    }
+    collector->errors[collector->count++] = error;
+}
 
-    // Create lexer and parser
-    Lexer lexer;
-    lexer_init(&lexer, doc->content);
+// Hand the collected errors to a statement whose span starts at span_start
+static void take_errors(ErrorCollector *collector, LSPStatement *entry, size_t span_start) {
+    if (collector->count == 0) return;
+    for (int i = 0; i < collector->count; i++) {
+        LSPStatementError *error = &collector->errors[i];
+        error->offset = error->offset > span_start ? error->offset - span_start : 0;
+    }
+    entry->errors = collector->errors;
+    entry->error_count = collector->count;
+    collector->errors = NULL;
+    collector->count = 0;
+    collector->capacity = 0;
+}
 
-    Parser parser;
-    parser_init(&parser, &lexer);
+static int count_newlines(const char *start, const char *end) {
+    int count = 0;
+    for (const char *p = start; p < end; p++) {
+        if (*p == '\n') count++;
+    }
+    return count;
+}
 
-    // Parse the document
-    int stmt_count = 0;
-    Stmt **statements = parse_program(&parser, &stmt_count);
+static size_t span_offset(LSPDocument *doc, int index) {
+    size_t offset = 0;
+    for (int i = 0; i < index; i++) {
+        offset += doc->statements[i].length;
+    }
+    return offset;
+}
 
-    // Check for errors
-    if (parser.had_error) {
-        // The parser error occurred at parser.previous or parser.current
-        // Convert to LSP diagnostic
+// Reparse the edited statements [first, last]. Parsing starts at the first
+// one's span and stops as soon as a statement ends on a boundary of an
+// unedited statement at or after last, so the statements from there on are
+// kept. The source handed to the parser is a window reaching a couple of
+// statements past the edit, widened fourfold each time the parse runs off
+// its end without resynchronizing. Returns the index after the new
+// statements.
+static int reparse_statements(LSPDocument *doc, int first, int last) {
+    size_t start = span_offset(doc, first);
+    int tail = doc->statement_count - 1;
+    int reach = 2;
+    int window_last = last + reach < tail ? last + reach : tail;
+
+    for (;;) {
+        size_t window_end = start;
+        for (int i = first; i <= window_last; i++) {
+            window_end += doc->statements[i].length;
+        }
+        bool to_end = window_last == tail;
+
+        char *text = text_buffer_substring(doc->text, start, window_end);
+        size_t text_length = window_end - start;
+
+        LSPParseChunk *chunk = malloc(sizeof(LSPParseChunk));
+        chunk->arena = ast_arena_new();
+        chunk->refs = 1;    // Dropped when this parse is done with it
+        AstArena *previous_arena = ast_arena_use(chunk->arena);
+
+        Lexer lexer;
+        lexer_init(&lexer, text);
+        ErrorCollector collector = { .text = text, .text_length = text_length, .lexer = &lexer };
+
+        Parser parser;
+        parser_init(&parser, &lexer);
+        parser.quiet = 1;
+        parser.on_error = collect_error;
+        parser.on_error_data = &collector;
+
+        LSPStatement *entries = NULL;
+        int count = 0;
+        int capacity = 0;
+        size_t span_start = 0;
+        int resync = -1;
+
+        // Candidate boundary: the end of old statement k
+        int k = last;
+        size_t k_end = span_offset(doc, last) + doc->statements[last].length;
+
+        for (;;) {
+            if (parser.panic_mode) {
+                parser_synchronize(&parser);
+            }
+            if (parser.current.type == TOK_EOF) break;
+
+            const char *first_token = parser.current.start;
+            collector.first_token = (size_t)(first_token - text);
+            collector.first_token_length = (size_t)parser.current.length;
+            Stmt *stmt = parse_statement(&parser);
+            size_t stmt_end = (size_t)(parser.previous.start + parser.previous.length - text);
+            if (stmt_end < span_start) stmt_end = span_start;
+
+            if (count == capacity) {
+                capacity = capacity ? capacity * 2 : 8;
+                entries = realloc(entries, capacity * sizeof(LSPStatement));
+            }
+            LSPStatement *entry = &entries[count++];
+            memset(entry, 0, sizeof(*entry));
+            entry->length = stmt_end - span_start;
+            entry->newlines = count_newlines(text + span_start, text + stmt_end);
+            entry->lead_lines = count_newlines(text + span_start, first_token);
+            entry->stmt = stmt;
+            if (stmt) {
+                entry->chunk = chunk;
+                chunk->refs++;
+            }
+            entry->recovering = parser.panic_mode;
+            take_errors(&collector, entry, span_start);
+            span_start = stmt_end;
+
+            if (parser.panic_mode) continue;
+            size_t end = start + stmt_end;
+            while (k < tail && k_end < end) {
+                k++;
+                k_end += doc->statements[k].length;
+            }
+            if (k < tail && k_end == end && end < window_end &&
+                !doc->statements[k].recovering) {
+                resync = k;
+                break;
+            }
+        }
 
-        // Get line number (parser stores 1-based lines)
-        int line = parser.previous.line > 0 ? parser.previous.line - 1 : 0;
+        if (resync < 0 && to_end) {
+            // Everything after the last statement becomes the trailing span
+            if (count == capacity) {
+                capacity = capacity ? capacity * 2 : 8;
+                entries = realloc(entries, capacity * sizeof(LSPStatement));
+            }
+            LSPStatement *entry = &entries[count++];
+            memset(entry, 0, sizeof(*entry));
+            entry->length = text_length - span_start;
+            entry->newlines = count_newlines(text + span_start, text + text_length);
+            take_errors(&collector, entry, span_start);
+            resync = tail;
+        }
 
-        // Calculate character position in line
-        int character = 0;
-        const char *line_start = doc->content;
-        int current_line = 0;
+        ast_arena_use(previous_arena);
+        for (int i = 0; i < collector.count; i++) {
+            free(collector.errors[i].message);
+        }
+        free(collector.errors);
+        free(text);
 
-        // Find the start of the error line
-        for (const char *p = doc->content; *p && current_line < parser.previous.line - 1; p++) {
-            if (*p == '\n') {
-                current_line++;
-                line_start = p + 1;
+        if (resync < 0) {
+            // No boundary inside the window: retry with a wider one
+            for (int i = 0; i < count; i++) {
+                statement_release(&entries[i]);
             }
+            free(entries);
+            chunk_release(chunk);
+            reach *= 4;
+            window_last = last + reach < tail ? last + reach : tail;
+            continue;
         }
 
-        // Calculate character offset
-        if (parser.previous.start) {
-            character = (int)(parser.previous.start - line_start);
-            if (character < 0) character = 0;
-        }
+        chunk_release(chunk);
+        statements_splice(doc, first, resync, entries, count);
+        free(entries);
+        return first + count;
+    }
+}
 
-        LSPRange range = {
-            .start = { .line = line, .character = character },
-            .end = { .line = line, .character = character + parser.previous.length }
-        };
+void lsp_document_parse(LSPDocument *doc) {
+    if (doc->parse_pending) {
+        int i = 0;
+        while (i < doc->statement_count) {
+            if (!doc->statements[i].dirty) {
+                i++;
+                continue;
+            }
+            int last = i;
+            while (last + 1 < doc->statement_count && doc->statements[last + 1].dirty) {
+                last++;
+            }
+            // A parse can only restart where the parser was not skipping
+            // past an error
+            int first = i;
+            while (first > 0 && doc->statements[first - 1].recovering) {
+                first--;
+            }
+            i = reparse_statements(doc, first, last);
+        }
+        doc->parse_pending = false;
+        invalidate_ast(doc);
+    }
+    if (doc->ast) return;
 
-        // Create generic error message if we don't have specifics
-        lsp_document_add_diagnostic(doc, range, LSP_SEVERITY_ERROR,
-                                    "Syntax error");
+    // Rebuild the statement list, stamping each statement with its current
+    // first line (statements kept across edits may have moved)
+    lsp_document_clear_diagnostics(doc);
+    int stmt_count = doc->statement_count - 1;
+    Stmt **statements = malloc(sizeof(Stmt *) * (stmt_count > 0 ? stmt_count : 1));
+    size_t offset = 0;
+    int line = 0;
+    bool valid = true;
+    for (int i = 0; i < doc->statement_count; i++) {
+        LSPStatement *entry = &doc->statements[i];
+        if (i < stmt_count) {
+            statements[i] = entry->stmt;
+            if (entry->stmt) {
+                entry->stmt->line = line + entry->lead_lines + 1;
+            }
+        }
+        for (int e = 0; e < entry->error_count; e++) {
+            LSPStatementError *error = &entry->errors[e];
+            size_t error_start = offset + error->offset;
+            LSPRange range = {
+                .start = text_buffer_position(doc->text, error_start),
+                .end = text_buffer_position(doc->text, error_start + error->length)
+            };
+            lsp_document_add_diagnostic(doc, range, LSP_SEVERITY_ERROR, error->message);
+            valid = false;
+        }
+        offset += entry->length;
+        line += entry->newlines;
     }
 
     // Store AST for later use (hover, goto definition, etc.)
     doc->ast = statements;
     doc->ast_stmt_count = stmt_count;
-    doc->ast_valid = !parser.had_error;
-
-    // Note: We don't free the AST here because we want to keep it for
-    // language features. The AST will be freed when the document is closed.
+    doc->ast_valid = valid;
 }
 
 // ============================================================================
 // Server Main Loop
 // ============================================================================
 
+// Block until the client sends something, publishing debounced diagnostics
+// whenever their deadline passes first
+static void wait_for_input(LSPServer *server) {
+    for (;;) {
+        int timeout = publish_due_diagnostics(server);
+        if (timeout < 0) return;
+
+        struct pollfd pfd = { .fd = server->input_fd, .events = POLLIN };
+        int ready = poll(&pfd, 1, timeout);
+        if (ready > 0 || (ready < 0 && errno != EINTR)) return;
+    }
+}
+
 int lsp_server_run_stdio(LSPServer *server) {
     server->input_fd = STDIN_FILENO;
     server->output_fd = STDOUT_FILENO;
@@ -238,6 +736,8 @@ int lsp_server_run_stdio(LSPServer *server) {
     fprintf(stderr, "Hemlock LSP server starting (stdio transport)\n");
 
     while (!server->shutdown) {
+        wait_for_input(server);
+
         // Read message
         LSPMessage *request = lsp_read_message(server->input_fd);
         if (!request) {
@@ -331,6 +831,8 @@ int lsp_server_run_tcp(LSPServer *server, int port) {
 
     // Run main loop
     while (!server->shutdown) {
+        wait_for_input(server);
+
         LSPMessage *request = lsp_read_message(server->input_fd);
         if (!request) {
             fprintf(stderr, "LSP: Connection closed\n");
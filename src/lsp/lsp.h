@@ -62,22 +62,39 @@ struct LSPDiagnostic {
 
 /*
  * Document state tracked by the server
+ *
+ * The text lives in a piece table (text_buffer.h) and is edited in place by
+ * incremental didChange ranges. The parse is kept per top-level statement:
+ * an edit only marks the statements it touches, and the next parse re-runs
+ * the parser over those until it lines up with an unchanged statement
+ * boundary again, reusing everything else.
  */
 struct LSPDocument {
     char *uri;              // Document URI (file://...)
-    char *content;          // Current content
+    uint32_t uri_hash;
+    char *path;             // File path (the URI itself for other schemes)
+    struct LSPTextBuffer *text;  // Current text
+    char *content;          // Flattened text cache (see lsp_document_text)
     int version;            // Document version
 
     // Cached parse results
     void *ast;              // Cached AST (Stmt**)
     int ast_stmt_count;     // Number of statements
-    bool ast_valid;         // Whether AST is up-to-date
+    bool ast_valid;         // Parsed without errors
+
+    // Top-level statement spans (private to lsp.c)
+    struct LSPStatement *statements;
+    int statement_count;
+    int statement_capacity;
+    bool parse_pending;     // Edits since the last parse
+    bool index_stale;       // Edits since the workspace index saw the text
 
     // Diagnostics
     LSPDiagnostic *diagnostics;
     int diagnostic_count;
+    int64_t diagnostics_due;  // Debounced publish time in ms (0 = none)
 
-    struct LSPDocument *next;  // Linked list
+    struct LSPDocument *next;  // Hash bucket chain
 };
 
 /*
@@ -98,12 +115,16 @@ struct LSPServer {
     bool supports_completion;
     bool supports_definition;
 
-    // Open documents
-    LSPDocument *documents;
+    // Open documents, hashed by URI
+    LSPDocument **documents;
+    int document_bucket_count;
+    int document_count;
+    int pending_diagnostics;  // Documents with a publish scheduled
 
     // Workspace
     char *root_uri;         // Workspace root
     char *root_path;        // Workspace root as path
+    struct LSPIndex *index; // Workspace symbol index (index.h)
 };
 
 /*
@@ -131,14 +152,39 @@ int lsp_server_run_tcp(LSPServer *server, int port);
  */
 LSPDocument *lsp_document_open(LSPServer *server, const char *uri, const char *content, int version);
 void lsp_document_update(LSPDocument *doc, const char *content, int version);
+void lsp_document_edit(LSPDocument *doc, LSPRange range, const char *text, int version);
 void lsp_document_close(LSPServer *server, const char *uri);
 LSPDocument *lsp_document_find(LSPServer *server, const char *uri);
 
 /*
- * Parse document and collect diagnostics
+ * Current text as one string, owned by the document and valid until the
+ * next edit
+ */
+const char *lsp_document_text(LSPDocument *doc);
+
+/*
+ * Bring the parse up to date and collect diagnostics (reparses only the
+ * statements edited since the last call)
  */
 void lsp_document_parse(LSPDocument *doc);
 
+/*
+ * Publish diagnostics once edits to the document pause, rather than on
+ * every keystroke
+ */
+void lsp_document_schedule_diagnostics(LSPServer *server, LSPDocument *doc);
+
+/*
+ * Re-index the document's text if it changed since it was last indexed
+ */
+void lsp_document_sync_index(LSPServer *server, LSPDocument *doc);
+
+/*
+ * Re-index every open document with unindexed edits (before index queries,
+ * which may look into any of them)
+ */
+void lsp_server_sync_index(LSPServer *server);
+
 /*
  * Clear diagnostics for a document
  */
@@ -221,14 +221,35 @@ static JSONValue *parse_string(JSONParser *p) {
                     for (int i = 0; i < 4 && *p->current; i++) {
                         hex[i] = *p->current++;
                     }
-                    p->current--;  // Will be incremented below
                     int codepoint = (int)strtol(hex, NULL, 16);
-                    // Simple UTF-8 encoding for BMP
+                    // Characters outside the BMP arrive as a surrogate
+                    // pair; a lone surrogate becomes U+FFFD
+                    if (codepoint >= 0xD800 && codepoint <= 0xDBFF &&
+                        p->current[0] == '\\' && p->current[1] == 'u') {
+                        char low_hex[5] = {0};
+                        for (int i = 0; i < 4 && p->current[2 + i]; i++) {
+                            low_hex[i] = p->current[2 + i];
+                        }
+                        int low = (int)strtol(low_hex, NULL, 16);
+                        if (low >= 0xDC00 && low <= 0xDFFF) {
+                            codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                            p->current += 6;
+                        }
+                    }
+                    if (codepoint >= 0xD800 && codepoint <= 0xDFFF) {
+                        codepoint = 0xFFFD;
+                    }
+                    p->current--;  // Will be incremented below
                     if (codepoint < 0x80) {
                         *dst++ = (char)codepoint;
                     } else if (codepoint < 0x800) {
                         *dst++ = (char)(0xC0 | (codepoint >> 6));
                         *dst++ = (char)(0x80 | (codepoint & 0x3F));
+                    } else if (codepoint >= 0x10000) {
+                        *dst++ = (char)(0xF0 | (codepoint >> 18));
+                        *dst++ = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+                        *dst++ = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+                        *dst++ = (char)(0x80 | (codepoint & 0x3F));
                     } else {
                         *dst++ = (char)(0xE0 | (codepoint >> 12));
                         *dst++ = (char)(0x80 | ((codepoint >> 6) & 0x3F));
@@ -840,3 +861,56 @@ void lsp_message_free(LSPMessage *msg) {
     json_free(msg->error);
     free(msg);
 }
+
+// ============================================================================
+// URIs
+// ============================================================================
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+char *lsp_uri_to_path(const char *uri) {
+    if (!uri || strncmp(uri, "file://", 7) != 0) return NULL;
+    const char *p = uri + 7;
+    // Skip an authority ("file://localhost/...")
+    if (*p != '/') {
+        p = strchr(p, '/');
+        if (!p) return NULL;
+    }
+
+    char *path = malloc(strlen(p) + 1);
+    size_t n = 0;
+    for (; *p; p++) {
+        if (*p == '%' && hex_value(p[1]) >= 0 && hex_value(p[2]) >= 0) {
+            path[n++] = (char)(hex_value(p[1]) * 16 + hex_value(p[2]));
+            p += 2;
+        } else {
+            path[n++] = *p;
+        }
+    }
+    path[n] = '\0';
+    return path;
+}
+
+char *lsp_path_to_uri(const char *path) {
+    static const char hex[] = "0123456789ABCDEF";
+    char *uri = malloc(strlen(path) * 3 + 8);
+    size_t n = 0;
+    memcpy(uri, "file://", 7);
+    n = 7;
+    for (const unsigned char *p = (const unsigned char *)path; *p; p++) {
+        if (isalnum(*p) || strchr("/-._~", *p)) {
+            uri[n++] = (char)*p;
+        } else {
+            uri[n++] = '%';
+            uri[n++] = hex[*p >> 4];
+            uri[n++] = hex[*p & 15];
+        }
+    }
+    uri[n] = '\0';
+    return uri;
+}
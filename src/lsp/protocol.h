@@ -161,4 +161,11 @@ void lsp_message_free(LSPMessage *msg);
 #define LSP_ERROR_SERVER_NOT_INITIALIZED -32002
 #define LSP_ERROR_REQUEST_CANCELLED -32800
 
+/*
+ * file:// URI <-> path conversion (percent-encoded). lsp_uri_to_path
+ * returns NULL for other schemes. Both return a string the caller frees.
+ */
+char *lsp_uri_to_path(const char *uri);
+char *lsp_path_to_uri(const char *path);
+
 #endif // HEMLOCK_LSP_PROTOCOL_H
@@ -0,0 +1,359 @@
+/*
+ * Piece-table text buffer for open documents
+ */
+
+#include "text_buffer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Flatten the table once an editing session has fragmented it this much
+#define LSP_TEXT_MAX_PIECES 512
+
+// ============================================================================
+// Text Stores
+// ============================================================================
+
+static void store_init(LSPTextStore *store) {
+    memset(store, 0, sizeof(*store));
+}
+
+static void store_free(LSPTextStore *store) {
+    free(store->data);
+    free(store->newlines);
+    store_init(store);
+}
+
+static void store_append(LSPTextStore *store, const char *text, size_t length) {
+    if (store->length + length + 1 > store->capacity) {
+        size_t capacity = store->capacity ? store->capacity : 256;
+        while (store->length + length + 1 > capacity) {
+            capacity *= 2;
+        }
+        store->data = realloc(store->data, capacity);
+        store->capacity = capacity;
+    }
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] != '\n') continue;
+        if (store->newline_count == store->newline_capacity) {
+            store->newline_capacity = store->newline_capacity ? store->newline_capacity * 2 : 64;
+            store->newlines = realloc(store->newlines,
+                                      store->newline_capacity * sizeof(size_t));
+        }
+        store->newlines[store->newline_count++] = store->length + i;
+    }
+    memcpy(store->data + store->length, text, length);
+    store->length += length;
+    store->data[store->length] = '\0';
+}
+
+// Number of line breaks before offset
+static int store_newlines_before(const LSPTextStore *store, size_t offset) {
+    int lo = 0;
+    int hi = store->newline_count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (store->newlines[mid] < offset) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static int store_count_newlines(const LSPTextStore *store, size_t start, size_t end) {
+    return store_newlines_before(store, end) - store_newlines_before(store, start);
+}
+
+static const LSPTextStore *piece_store(const LSPTextBuffer *buf, const LSPPiece *piece) {
+    return piece->added ? &buf->added : &buf->original;
+}
+
+// ============================================================================
+// Pieces
+// ============================================================================
+
+// Index of the piece holding offset, and that piece's starting offset.
+// Returns piece_count when offset is the end of the text.
+static int find_piece(const LSPTextBuffer *buf, size_t offset, size_t *piece_start) {
+    size_t start = 0;
+    for (int i = 0; i < buf->piece_count; i++) {
+        if (offset < start + buf->pieces[i].length) {
+            *piece_start = start;
+            return i;
+        }
+        start += buf->pieces[i].length;
+    }
+    *piece_start = start;
+    return buf->piece_count;
+}
+
+static void insert_piece(LSPTextBuffer *buf, int index, LSPPiece piece) {
+    if (buf->piece_count == buf->piece_capacity) {
+        buf->piece_capacity = buf->piece_capacity ? buf->piece_capacity * 2 : 16;
+        buf->pieces = realloc(buf->pieces, buf->piece_capacity * sizeof(LSPPiece));
+    }
+    memmove(&buf->pieces[index + 1], &buf->pieces[index],
+            (buf->piece_count - index) * sizeof(LSPPiece));
+    buf->pieces[index] = piece;
+    buf->piece_count++;
+}
+
+// Make offset a piece boundary; returns the index of the piece starting there
+static int split_at(LSPTextBuffer *buf, size_t offset) {
+    size_t piece_start;
+    int i = find_piece(buf, offset, &piece_start);
+    if (i == buf->piece_count || piece_start == offset) {
+        return i;
+    }
+
+    LSPPiece *piece = &buf->pieces[i];
+    size_t head = offset - piece_start;
+    LSPPiece tail = {
+        .added = piece->added,
+        .start = piece->start + head,
+        .length = piece->length - head,
+        .newlines = store_count_newlines(piece_store(buf, piece),
+                                         piece->start + head,
+                                         piece->start + piece->length)
+    };
+    piece->length = head;
+    piece->newlines -= tail.newlines;
+    insert_piece(buf, i + 1, tail);
+    return i + 1;
+}
+
+static void compact(LSPTextBuffer *buf) {
+    char *text = text_buffer_substring(buf, 0, buf->length);
+    text_buffer_free(buf);
+    text_buffer_init(buf, text);
+    free(text);
+}
+
+// ============================================================================
+// Buffer API
+// ============================================================================
+
+void text_buffer_init(LSPTextBuffer *buf, const char *text) {
+    memset(buf, 0, sizeof(*buf));
+    store_init(&buf->original);
+    store_init(&buf->added);
+
+    size_t length = strlen(text);
+    store_append(&buf->original, text, length);
+    buf->length = length;
+    buf->newlines = buf->original.newline_count;
+    if (length > 0) {
+        LSPPiece piece = {
+            .added = false,
+            .start = 0,
+            .length = length,
+            .newlines = buf->newlines
+        };
+        insert_piece(buf, 0, piece);
+    }
+}
+
+void text_buffer_free(LSPTextBuffer *buf) {
+    store_free(&buf->original);
+    store_free(&buf->added);
+    free(buf->pieces);
+    buf->pieces = NULL;
+    buf->piece_count = 0;
+    buf->piece_capacity = 0;
+    buf->length = 0;
+    buf->newlines = 0;
+}
+
+void text_buffer_replace(LSPTextBuffer *buf, size_t start, size_t end,
+                         const char *text, size_t text_length) {
+    if (end > buf->length) end = buf->length;
+    if (start > end) start = end;
+
+    // Typing right after the previous insertion grows that piece in place
+    if (start == end && start > 0 && text_length > 0) {
+        size_t piece_start;
+        int i = find_piece(buf, start - 1, &piece_start);
+        LSPPiece *piece = &buf->pieces[i];
+        if (piece->added && piece_start + piece->length == start &&
+            piece->start + piece->length == buf->added.length) {
+            int before = buf->added.newline_count;
+            store_append(&buf->added, text, text_length);
+            int newlines = buf->added.newline_count - before;
+            piece->length += text_length;
+            piece->newlines += newlines;
+            buf->length += text_length;
+            buf->newlines += newlines;
+            return;
+        }
+    }
+
+    int first = split_at(buf, start);
+    int last = split_at(buf, end);
+    for (int i = first; i < last; i++) {
+        buf->length -= buf->pieces[i].length;
+        buf->newlines -= buf->pieces[i].newlines;
+    }
+    memmove(&buf->pieces[first], &buf->pieces[last],
+            (buf->piece_count - last) * sizeof(LSPPiece));
+    buf->piece_count -= last - first;
+
+    if (text_length > 0) {
+        int before = buf->added.newline_count;
+        LSPPiece piece = {
+            .added = true,
+            .start = buf->added.length,
+            .length = text_length,
+            .newlines = 0
+        };
+        store_append(&buf->added, text, text_length);
+        piece.newlines = buf->added.newline_count - before;
+        insert_piece(buf, first, piece);
+        buf->length += text_length;
+        buf->newlines += piece.newlines;
+    }
+
+    if (buf->piece_count > LSP_TEXT_MAX_PIECES) {
+        compact(buf);
+    }
+}
+
+// Offset of the first byte of a line (clamped to the end of the text)
+static size_t line_start(const LSPTextBuffer *buf, int line) {
+    if (line <= 0) return 0;
+    if (line > buf->newlines) return buf->length;
+
+    size_t start = 0;
+    int lines = 0;
+    for (int i = 0; i < buf->piece_count; i++) {
+        const LSPPiece *piece = &buf->pieces[i];
+        if (lines + piece->newlines >= line) {
+            const LSPTextStore *store = piece_store(buf, piece);
+            int index = store_newlines_before(store, piece->start) + (line - lines - 1);
+            return start + (store->newlines[index] - piece->start) + 1;
+        }
+        lines += piece->newlines;
+        start += piece->length;
+    }
+    return buf->length;
+}
+
+// UTF-16 code units taken by the UTF-8 sequence starting with byte c,
+// and that sequence's length in bytes
+static int utf8_sequence(unsigned char c, int *units) {
+    if (c >= 0xF0) {
+        *units = 2;
+        return 4;
+    }
+    *units = 1;
+    if (c >= 0xE0) return 3;
+    if (c >= 0xC0) return 2;
+    return 1;
+}
+
+// Walk from offset across the line, stopping after `character` UTF-16 units
+// (or at the end of the line); returns the byte offset reached and stores the
+// units walked. A negative limit walks to stop_offset instead.
+static size_t walk_line(const LSPTextBuffer *buf, size_t offset, int character,
+                        size_t stop_offset, int *walked) {
+    size_t piece_start;
+    int i = find_piece(buf, offset, &piece_start);
+    size_t pos = offset - piece_start;
+    int units = 0;
+    int pending = 0;    // Continuation bytes of the current sequence
+
+    while (i < buf->piece_count) {
+        const LSPPiece *piece = &buf->pieces[i];
+        const char *data = piece_store(buf, piece)->data + piece->start;
+        while (pos < piece->length) {
+            if (pending > 0) {
+                pending--;
+                pos++;
+                offset++;
+                continue;
+            }
+            unsigned char c = (unsigned char)data[pos];
+            if (c == '\n') goto done;
+            if (character < 0 ? offset >= stop_offset : units >= character) goto done;
+
+            int seq_units;
+            int bytes = utf8_sequence(c, &seq_units);
+            if (character >= 0 && units + seq_units > character) goto done;
+            units += seq_units;
+            pending = bytes - 1;
+            pos++;
+            offset++;
+        }
+        i++;
+        pos = 0;
+    }
+
+done:
+    *walked = units;
+    return offset;
+}
+
+size_t text_buffer_offset(const LSPTextBuffer *buf, LSPPosition pos) {
+    if (pos.line > buf->newlines) return buf->length;
+    size_t start = line_start(buf, pos.line);
+    if (pos.character <= 0) return start;
+
+    int walked;
+    return walk_line(buf, start, pos.character, 0, &walked);
+}
+
+LSPPosition text_buffer_position(const LSPTextBuffer *buf, size_t offset) {
+    if (offset > buf->length) offset = buf->length;
+
+    LSPPosition pos = { .line = text_buffer_count_newlines(buf, 0, offset), .character = 0 };
+    size_t start = line_start(buf, pos.line);
+    if (offset > start) {
+        walk_line(buf, start, -1, offset, &pos.character);
+    }
+    return pos;
+}
+
+char *text_buffer_substring(const LSPTextBuffer *buf, size_t start, size_t end) {
+    if (end > buf->length) end = buf->length;
+    if (start > end) start = end;
+
+    char *result = malloc(end - start + 1);
+    size_t written = 0;
+    size_t piece_start;
+    int i = find_piece(buf, start, &piece_start);
+    for (; i < buf->piece_count && piece_start < end; i++) {
+        const LSPPiece *piece = &buf->pieces[i];
+        size_t from = start > piece_start ? start - piece_start : 0;
+        size_t to = piece->length;
+        if (piece_start + to > end) to = end - piece_start;
+        memcpy(result + written, piece_store(buf, piece)->data + piece->start + from, to - from);
+        written += to - from;
+        piece_start += piece->length;
+    }
+    result[written] = '\0';
+    return result;
+}
+
+int text_buffer_count_newlines(const LSPTextBuffer *buf, size_t start, size_t end) {
+    if (end > buf->length) end = buf->length;
+    if (start >= end) return 0;
+
+    int count = 0;
+    size_t piece_start;
+    int i = find_piece(buf, start, &piece_start);
+    for (; i < buf->piece_count && piece_start < end; i++) {
+        const LSPPiece *piece = &buf->pieces[i];
+        size_t from = start > piece_start ? start - piece_start : 0;
+        size_t to = piece->length;
+        if (piece_start + to > end) to = end - piece_start;
+        if (from == 0 && to == piece->length) {
+            count += piece->newlines;
+        } else {
+            count += store_count_newlines(piece_store(buf, piece),
+                                          piece->start + from, piece->start + to);
+        }
+        piece_start += piece->length;
+    }
+    return count;
+}
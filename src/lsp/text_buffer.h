@@ -0,0 +1,76 @@
+/*
+ * Piece-table text buffer for open documents
+ *
+ * The text is a sequence of pieces, each a span of either the original text
+ * (immutable, as received in didOpen) or the add buffer (append-only, every
+ * inserted string). An edit splits at most two pieces and appends the new
+ * text, so its cost does not depend on the document size. Both buffers keep
+ * a sorted index of their line breaks, which makes LSP position <-> byte
+ * offset conversion a walk over the pieces plus one line.
+ *
+ * Typing at the same spot extends the last piece instead of adding one, and
+ * the table is flattened back into a single original once it holds too many
+ * pieces.
+ */
+
+#ifndef HEMLOCK_LSP_TEXT_BUFFER_H
+#define HEMLOCK_LSP_TEXT_BUFFER_H
+
+#include "lsp.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct {
+    char *data;
+    size_t length;
+    size_t capacity;
+    size_t *newlines;       // Offsets of '\n' bytes, ascending
+    int newline_count;
+    int newline_capacity;
+} LSPTextStore;
+
+typedef struct {
+    bool added;             // Span of the add buffer (else the original)
+    size_t start;
+    size_t length;
+    int newlines;           // Line breaks inside the span
+} LSPPiece;
+
+typedef struct LSPTextBuffer {
+    LSPTextStore original;
+    LSPTextStore added;
+    LSPPiece *pieces;
+    int piece_count;
+    int piece_capacity;
+    size_t length;          // Total bytes
+    int newlines;           // Total line breaks
+} LSPTextBuffer;
+
+void text_buffer_init(LSPTextBuffer *buf, const char *text);
+void text_buffer_free(LSPTextBuffer *buf);
+
+/*
+ * Replace bytes [start, end) with text
+ */
+void text_buffer_replace(LSPTextBuffer *buf, size_t start, size_t end,
+                         const char *text, size_t text_length);
+
+/*
+ * Position conversion (characters are UTF-16 code units, as in LSP).
+ * Positions past the end of a line or the document are clamped.
+ */
+size_t text_buffer_offset(const LSPTextBuffer *buf, LSPPosition pos);
+LSPPosition text_buffer_position(const LSPTextBuffer *buf, size_t offset);
+
+/*
+ * Copy bytes [start, end) into a NUL-terminated string (caller frees)
+ */
+char *text_buffer_substring(const LSPTextBuffer *buf, size_t start, size_t end);
+
+/*
+ * Number of line breaks in bytes [start, end)
+ */
+int text_buffer_count_newlines(const LSPTextBuffer *buf, size_t start, size_t end);
+
+#endif // HEMLOCK_LSP_TEXT_BUFFER_H
@@ -1,6 +1,9 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <zlib.h>
@@ -12,9 +15,11 @@
 #include "interpreter/internal.h"
 #include "lsp/lsp.h"
 #include "ast_serialize.h"
+#include "ast_optimize.h"
 #include "bundler/bundler.h"
+#include "snapshot.h"
+#include "version.h"
 
-#define HEMLOCK_VERSION "1.0.0"
 #define HEMLOCK_BUILD_DATE __DATE__
 
 // Magic marker for packaged executables (appended at end of file)
@@ -68,8 +73,14 @@ static void run_source(const char *source, int argc, char **argv) {
     Parser parser;
     parser_init(&parser, &lexer);
 
+    AstArena *arena = ast_arena_new();
+    AstArena *previous = ast_arena_use(arena);
     int stmt_count;
     Stmt **statements = parse_program(&parser, &stmt_count);
+    if (!parser.had_error) {
+        ast_optimize(statements, stmt_count);
+    }
+    ast_arena_use(previous);
 
     if (parser.had_error) {
         fprintf(stderr, "Parse failed!\n");
@@ -91,15 +102,44 @@ static void run_source(const char *source, int argc, char **argv) {
     env_break_cycles(env);  // Break circular references before release
     env_release(env);
     clear_manually_freed_pointers();  // Clear after env is fully freed
-    for (int i = 0; i < stmt_count; i++) {
-        stmt_free(statements[i]);
+    ast_arena_free(arena);
+}
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+// A read-only or anonymous mapping that backs a loaded AST
+typedef struct {
+    void *base;      // NULL when nothing is mapped
+    size_t length;
+} Mapping;
+
+// Map size bytes of fd starting at offset; returns the first byte
+static uint8_t* map_file_range(int fd, off_t offset, size_t size, Mapping *map) {
+    off_t start = offset - offset % sysconf(_SC_PAGESIZE);
+    map->length = size + (size_t)(offset - start);
+    map->base = mmap(NULL, map->length, PROT_READ, MAP_PRIVATE, fd, start);
+    if (map->base == MAP_FAILED) {
+        map->base = NULL;
+        return NULL;
+    }
+    return (uint8_t*)map->base + (offset - start);
+}
+
+static void unmap(Mapping *map) {
+    if (map->base) {
+        munmap(map->base, map->length);
+        map->base = NULL;
     }
-    free(statements);
 }
 
 // Check if this executable has an embedded HMLB payload
-// Returns the payload data (caller must free) or NULL if not packaged
-static uint8_t* check_embedded_payload(size_t *out_size) {
+// Returns the payload, mapped from the executable (unmap with unmap), or
+// NULL if not packaged
+static uint8_t* check_embedded_payload(size_t *out_size, Mapping *map) {
+    map->base = NULL;
+
     // Read our own executable path
     char exe_path[4096];
     ssize_t len = readlink("/proc/self/exe", exe_path, sizeof(exe_path) - 1);
@@ -117,54 +157,43 @@ static uint8_t* check_embedded_payload(size_t *out_size) {
         exe_path[len] = '\0';
     }
 
-    FILE *f = fopen(exe_path, "rb");
-    if (!f) return NULL;
+    int fd = open(exe_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return NULL;
 
-    // Seek to end - 12 bytes (8 byte offset + 4 byte magic)
-    if (fseek(f, -12, SEEK_END) != 0) {
-        fclose(f);
+    // Trailer: 8 byte payload size + 4 byte magic
+    struct stat st;
+    uint8_t trailer[12];
+    if (fstat(fd, &st) != 0 || st.st_size < 12 ||
+        pread(fd, trailer, sizeof(trailer), st.st_size - 12) != (ssize_t)sizeof(trailer)) {
+        close(fd);
         return NULL;
     }
 
     uint64_t payload_size;
     uint32_t magic;
-    if (fread(&payload_size, 8, 1, f) != 1 ||
-        fread(&magic, 4, 1, f) != 1) {
-        fclose(f);
-        return NULL;
-    }
+    memcpy(&payload_size, trailer, 8);
+    memcpy(&magic, trailer + 8, 4);
 
     // Check for HMLP magic
     if (magic != HMLP_MAGIC) {
-        fclose(f);
+        close(fd);
         return NULL;
     }
 
-    // Get file size and calculate payload position
-    fseek(f, 0, SEEK_END);
-    long file_size = ftell(f);
-    long payload_start = file_size - 12 - (long)payload_size;
-
+    // Calculate payload position
+    long payload_start = (long)st.st_size - 12 - (long)payload_size;
     if (payload_start < 0 || payload_size == 0 || payload_size > 100000000) {  // 100MB max
-        fclose(f);
+        close(fd);
         return NULL;
     }
 
-    // Read the payload
-    fseek(f, payload_start, SEEK_SET);
-    uint8_t *payload = malloc(payload_size);
+    // Map the payload; pages are read only as the loader touches them
+    uint8_t *payload = map_file_range(fd, payload_start, payload_size, map);
+    close(fd);
     if (!payload) {
-        fclose(f);
-        return NULL;
-    }
-
-    if (fread(payload, 1, payload_size, f) != payload_size) {
-        free(payload);
-        fclose(f);
         return NULL;
     }
 
-    fclose(f);
     *out_size = payload_size;
     return payload;
 }
@@ -176,9 +205,11 @@ static int run_embedded_payload(uint8_t *payload, size_t payload_size, int argc,
         return 1;
     }
 
-    uint32_t magic = *(uint32_t*)payload;
-    int stmt_count;
-    Stmt **statements = NULL;
+    uint32_t magic;
+    memcpy(&magic, payload, 4);
+    const uint8_t *data = payload;
+    size_t data_size = payload_size;
+    Mapping inflated = { NULL, 0 };
 
     if (magic == 0x424C4D48) {  // "HMLB" (compressed)
         // Payload is in HMLB format: [magic:4][version:2][orig_size:4][compressed_data]
@@ -187,41 +218,48 @@ static int run_embedded_payload(uint8_t *payload, size_t payload_size, int argc,
             return 1;
         }
 
-        uint16_t version = *(uint16_t*)(payload + 4);
-        (void)version;  // Currently unused
-
-        uint32_t orig_size = *(uint32_t*)(payload + 6);
+        uint32_t orig_size;
+        memcpy(&orig_size, payload + 6, 4);
         uint8_t *compressed_data = payload + 10;
         size_t compressed_size = payload_size - 10;
 
-        // Decompress
-        uint8_t *decompressed = malloc(orig_size);
-        if (!decompressed) {
+        // Inflate once into a mapping that lives as long as the program,
+        // since function bodies are decoded from it on first call
+        inflated.length = orig_size ? orig_size : 1;
+        inflated.base = mmap(NULL, inflated.length, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (inflated.base == MAP_FAILED) {
             fprintf(stderr, "Error: Cannot allocate memory for decompression\n");
             return 1;
         }
 
         uLongf dest_len = orig_size;
-        int ret = uncompress(decompressed, &dest_len, compressed_data, compressed_size);
+        int ret = uncompress(inflated.base, &dest_len, compressed_data, compressed_size);
         if (ret != Z_OK) {
             fprintf(stderr, "Error: Decompression failed (%d)\n", ret);
-            free(decompressed);
+            unmap(&inflated);
             return 1;
         }
-
-        // Deserialize AST from memory
-        statements = ast_deserialize(decompressed, dest_len, &stmt_count);
-        free(decompressed);
-    } else if (magic == 0x434C4D48) {  // "HMLC" (uncompressed)
-        // Payload is already in HMLC format, deserialize directly
-        statements = ast_deserialize(payload, payload_size, &stmt_count);
-    } else {
+        mprotect(inflated.base, inflated.length, PROT_READ);
+        data = inflated.base;
+        data_size = dest_len;
+    } else if (magic != 0x434C4D48) {  // "HMLC" (uncompressed) is used in place
         fprintf(stderr, "Error: Unknown embedded payload format (magic: 0x%08x)\n", magic);
         return 1;
     }
 
+    // Deserialize top-level code; function bodies are decoded on first call
+    int stmt_count;
+    HmlcImage *image = NULL;
+    AstArena *arena = ast_arena_new();
+    AstArena *previous = ast_arena_use(arena);
+    Stmt **statements = ast_deserialize_lazy(data, data_size, &stmt_count, &image);
+    ast_arena_use(previous);
+
     if (!statements) {
         fprintf(stderr, "Error: Failed to deserialize embedded code\n");
+        ast_arena_free(arena);
+        unmap(&inflated);
         return 1;
     }
 
@@ -244,11 +282,9 @@ static int run_embedded_payload(uint8_t *payload, size_t payload_size, int argc,
     env_break_cycles(env);
     env_release(env);
     clear_manually_freed_pointers();
-
-    for (int i = 0; i < stmt_count; i++) {
-        stmt_free(statements[i]);
-    }
-    free(statements);
+    hmlc_image_free(image);
+    ast_arena_free(arena);
+    unmap(&inflated);
 
     ffi_cleanup();
     set_current_source_file(NULL);
@@ -348,6 +384,7 @@ static int compile_file(const char *input_path, const char *output_path, int deb
         free(source);
         return 1;
     }
+    ast_optimize(statements, stmt_count);
 
     // Determine output path
     char *final_output = NULL;
@@ -466,9 +503,11 @@ static int show_file_info(const char *path) {
 }
 
 // Bundle a .hml file with all its dependencies
-static int bundle_file(const char *input_path, const char *output_path, int verbose, int compressed) {
+static int bundle_file(const char *input_path, const char *output_path, int verbose, int compressed,
+                       int tree_shake) {
     BundleOptions opts = bundle_options_default();
     opts.verbose = verbose;
+    opts.tree_shake = tree_shake;
 
     // Create bundle
     Bundle *bundle = bundle_create(input_path, &opts);
@@ -533,9 +572,11 @@ static int bundle_file(const char *input_path, const char *output_path, int verb
 }
 
 // Create a self-contained executable (.hmlp) from a .hml file
-static int package_file(const char *input_path, const char *output_path, int verbose, int compress) {
+static int package_file(const char *input_path, const char *output_path, int verbose, int compress,
+                        int tree_shake) {
     BundleOptions opts = bundle_options_default();
     opts.verbose = verbose;
+    opts.tree_shake = tree_shake;
 
     // Create bundle
     Bundle *bundle = bundle_create(input_path, &opts);
@@ -719,9 +760,30 @@ static int package_file(const char *input_path, const char *output_path, int ver
 
 // Run a .hmlc compiled file
 static void run_hmlc_file(const char *path, int argc, char **argv) {
-    // Deserialize AST from file
+    // Map the file and deserialize top-level code; function bodies are
+    // decoded from the mapping on first call
+    Mapping map = { NULL, 0 };
+    uint8_t *data = NULL;
+    struct stat st;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open '%s' for reading\n", path);
+    } else {
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            data = map_file_range(fd, 0, (size_t)st.st_size, &map);
+        }
+        close(fd);
+    }
+
     int stmt_count;
-    Stmt **statements = ast_deserialize_from_file(path, &stmt_count);
+    HmlcImage *image = NULL;
+    Stmt **statements = NULL;
+    AstArena *arena = ast_arena_new();
+    if (data) {
+        AstArena *previous = ast_arena_use(arena);
+        statements = ast_deserialize_lazy(data, (size_t)st.st_size, &stmt_count, &image);
+        ast_arena_use(previous);
+    }
     if (statements == NULL) {
         fprintf(stderr, "Failed to load compiled file '%s'\n", path);
         exit(1);
@@ -746,14 +808,40 @@ static void run_hmlc_file(const char *path, int argc, char **argv) {
     env_break_cycles(env);
     env_release(env);
     clear_manually_freed_pointers();
+    hmlc_image_free(image);
+    ast_arena_free(arena);
+    unmap(&map);
 
-    for (int i = 0; i < stmt_count; i++) {
-        stmt_free(statements[i]);
+    ffi_cleanup();
+    set_current_source_file(NULL);
+}
+
+// Run a heap snapshot made with --snapshot
+static int run_snapshot_file(const char *path, int argc, char **argv) {
+    // The image stays mapped while the program runs: function bodies are
+    // decoded from it on first call
+    Mapping map = { NULL, 0 };
+    uint8_t *data = NULL;
+    struct stat st;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open '%s' for reading\n", path);
+        return 1;
+    }
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        data = map_file_range(fd, 0, (size_t)st.st_size, &map);
+    }
+    close(fd);
+    if (!data) {
+        fprintf(stderr, "Failed to load snapshot '%s'\n", path);
+        return 1;
     }
-    free(statements);
 
+    ffi_init();
+    int result = snapshot_run(data, (size_t)st.st_size, argc, argv);
     ffi_cleanup();
-    set_current_source_file(NULL);
+    unmap(&map);
+    return result;
 }
 
 // Check if file has .hmlc extension
@@ -811,6 +899,7 @@ static void run_repl(void) {
         if (parser.had_error) {
             continue;
         }
+        ast_optimize(statements, stmt_count);
 
         // Execute
         for (int i = 0; i < stmt_count; i++) {
@@ -843,11 +932,12 @@ static void print_help(const char *program) {
     printf("USAGE:\n");
     printf("    %s [OPTIONS] [FILE] [ARGS...]\n", program);
     printf("    %s --compile FILE [-o OUTPUT] [--debug]\n", program);
-    printf("    %s --bundle FILE [-o OUTPUT] [--compress] [--verbose]\n", program);
-    printf("    %s --package FILE [-o OUTPUT] [--no-compress] [--verbose]\n", program);
+    printf("    %s --bundle FILE [-o OUTPUT] [--compress] [--no-tree-shake] [--verbose]\n", program);
+    printf("    %s --package FILE [-o OUTPUT] [--no-compress] [--no-tree-shake] [--verbose]\n", program);
+    printf("    %s --snapshot OUTPUT FILE [ARGS...]\n", program);
     printf("    %s lsp [--stdio | --tcp PORT]\n\n", program);
     printf("ARGUMENTS:\n");
-    printf("    <FILE>       Hemlock script file to execute (.hml or .hmlc)\n");
+    printf("    <FILE>       Hemlock script file to execute (.hml, .hmlc or .hsnap)\n");
     printf("    <ARGS>...    Arguments passed to the script (available in 'args' array)\n\n");
     printf("SUBCOMMANDS:\n");
     printf("    lsp          Start Language Server Protocol server\n");
@@ -863,6 +953,9 @@ static void print_help(const char *program) {
     printf("    --package <FILE>     Create self-contained executable (interpreter + bundle)\n");
     printf("    --compress           Use zlib compression for bundle output (.hmlb)\n");
     printf("    --no-compress        Skip compression (faster startup, larger binary)\n");
+    printf("    --no-tree-shake      Keep unused declarations of imported modules in bundles\n");
+    printf("    --no-optimize        Skip constant folding and dead-branch removal\n");
+    printf("    --snapshot <OUTPUT>  Run FILE up to snapshot_point() and save its heap\n");
     printf("    --info <FILE>        Show info about a .hmlc/.hmlb file\n");
     printf("    -o, --output <FILE>  Output path for compiled/bundled/packaged file\n");
     printf("    --debug              Include line numbers in compiled output\n");
@@ -881,6 +974,8 @@ static void print_help(const char *program) {
     printf("    %s --package app.hml       # Create ./app executable\n", program);
     printf("    %s --package app.hml --no-compress -o myapp\n", program);
     printf("    %s --info app.hmlc         # Show compiled file info\n", program);
+    printf("    %s --snapshot app.hsnap app.hml    # Save initialized heap\n", program);
+    printf("    %s app.hsnap           # Start from the snapshot\n", program);
     printf("    %s lsp                 # Start LSP server (stdio)\n", program);
     printf("    %s lsp --tcp 6969      # Start LSP server (TCP)\n\n", program);
     printf("For more information, visit: https://github.com/nbeerbower/hemlock\n");
@@ -930,10 +1025,11 @@ int main(int argc, char **argv) {
     // Check for embedded payload FIRST (before any argument parsing)
     // This allows packaged executables to run their embedded code
     size_t payload_size;
-    uint8_t *payload = check_embedded_payload(&payload_size);
+    Mapping payload_map;
+    uint8_t *payload = check_embedded_payload(&payload_size, &payload_map);
     if (payload) {
         int result = run_embedded_payload(payload, payload_size, argc, argv);
-        free(payload);
+        unmap(&payload_map);
         cleanup_object_types();
         cleanup_enum_types();
         return result;
@@ -945,6 +1041,7 @@ int main(int argc, char **argv) {
     int bundle_mode = 0;
     int bundle_compress = 0;
     int bundle_verbose = 0;
+    int bundle_tree_shake = 1;
     int package_mode = 0;
     int info_mode = 0;
     const char *file_to_info = NULL;
@@ -952,6 +1049,7 @@ int main(int argc, char **argv) {
     const char *file_to_compile = NULL;
     const char *file_to_bundle = NULL;
     const char *file_to_package = NULL;
+    const char *snapshot_path = NULL;
     const char *output_path = NULL;
     const char *command_to_run = NULL;
     int first_script_arg = 0;  // Index of first argument to pass to script
@@ -1013,6 +1111,18 @@ int main(int argc, char **argv) {
             bundle_compress = -1;  // Explicitly disabled
         } else if (strcmp(argv[i], "--verbose") == 0) {
             bundle_verbose = 1;
+        } else if (strcmp(argv[i], "--no-tree-shake") == 0) {
+            bundle_tree_shake = 0;
+        } else if (strcmp(argv[i], "--no-optimize") == 0) {
+            ast_optimize_set_enabled(0);
+        } else if (strcmp(argv[i], "--snapshot") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: --snapshot requires an output file argument\n");
+                fprintf(stderr, "Try '%s --help' for more information.\n", argv[0]);
+                return 1;
+            }
+            snapshot_path = argv[i + 1];
+            i++;  // Skip the output path
         } else if (strcmp(argv[i], "--info") == 0) {
             info_mode = 1;
             if (i + 1 >= argc) {
@@ -1062,7 +1172,8 @@ int main(int argc, char **argv) {
             fprintf(stderr, "Error: No input file specified for bundling\n");
             return 1;
         }
-        int result = bundle_file(file_to_bundle, output_path, bundle_verbose, bundle_compress);
+        int result = bundle_file(file_to_bundle, output_path, bundle_verbose, bundle_compress,
+                                 bundle_tree_shake);
         return result;
     }
 
@@ -1084,7 +1195,23 @@ int main(int argc, char **argv) {
         // For --package, compression is ON by default (smaller binary)
         // Use --no-compress for faster startup at cost of larger binary
         int compress = (bundle_compress == -1) ? 0 : 1;  // Default to compressed
-        int result = package_file(file_to_package, output_path, bundle_verbose, compress);
+        int result = package_file(file_to_package, output_path, bundle_verbose, compress,
+                                  bundle_tree_shake);
+        return result;
+    }
+
+    // Handle snapshot mode: run up to the snapshot point and save the heap
+    if (snapshot_path != NULL) {
+        if (file_to_run == NULL) {
+            fprintf(stderr, "Error: No input file specified for snapshot\n");
+            return 1;
+        }
+        ffi_init();
+        int result = snapshot_create(file_to_run, snapshot_path, argc - first_script_arg,
+                                     &argv[first_script_arg]);
+        ffi_cleanup();
+        cleanup_object_types();
+        cleanup_enum_types();
         return result;
     }
 
@@ -1112,6 +1239,10 @@ int main(int argc, char **argv) {
         // Check if it's a compiled .hmlc file
         if (is_hmlc_extension(file_to_run) || is_hmlc_file(file_to_run)) {
             run_hmlc_file(file_to_run, script_argc, script_argv);
+        } else if (is_snapshot_file(file_to_run)) {
+            if (run_snapshot_file(file_to_run, script_argc, script_argv) != 0) {
+                exit(1);
+            }
         } else {
             run_file(file_to_run, script_argc, script_argv);
         }
@@ -2,6 +2,9 @@
 #include "module.h"
 #include "parser.h"
 #include "lexer.h"
+#include "parse_cache.h"
+#include "fnv1a.h"
+#include "ast_optimize.h"
 #include "interpreter/internal.h"
 #include <stdlib.h>
 #include <string.h>
@@ -9,6 +12,8 @@
 #include <unistd.h>
 #include <libgen.h>
 #include <limits.h>
+#include <stdint.h>
+#include <pthread.h>
 
 // ========== MODULE CACHE ==========
 
@@ -71,12 +76,58 @@ static char* find_stdlib_path() {
     return NULL;
 }
 
+// ========== PATH INDEX ==========
+
+static void path_index_init(PathIndex *index, int capacity) {
+    index->slots = calloc(capacity, sizeof(PathSlot));
+    index->capacity = capacity;
+    index->count = 0;
+}
+
+static PathSlot* path_index_slot(PathIndex *index, const char *path) {
+    int mask = index->capacity - 1;
+    int i = (int)(hml_fnv1a64(path, strlen(path), HML_FNV1A64_OFFSET) & (uint64_t)mask);
+    while (index->slots[i].path && strcmp(index->slots[i].path, path) != 0) {
+        i = (i + 1) & mask;
+    }
+    return &index->slots[i];
+}
+
+static void* path_index_get(PathIndex *index, const char *path) {
+    return path_index_slot(index, path)->value;
+}
+
+// Insert or replace; path must live as long as the entry
+static void path_index_put(PathIndex *index, const char *path, void *value) {
+    // Keep the load factor at or below one half
+    if ((index->count + 1) * 2 > index->capacity) {
+        PathSlot *old = index->slots;
+        int old_capacity = index->capacity;
+        path_index_init(index, old_capacity * 2);
+        for (int i = 0; i < old_capacity; i++) {
+            if (old[i].path) {
+                *path_index_slot(index, old[i].path) = old[i];
+                index->count++;
+            }
+        }
+        free(old);
+    }
+    PathSlot *slot = path_index_slot(index, path);
+    if (!slot->path) {
+        index->count++;
+    }
+    slot->path = path;
+    slot->value = value;
+}
+
 ModuleCache* module_cache_new(const char *initial_dir) {
     ModuleCache *cache = malloc(sizeof(ModuleCache));
     cache->modules = malloc(sizeof(Module*) * 32);
     cache->count = 0;
     cache->capacity = 32;
+    path_index_init(&cache->index, 64);
     cache->current_dir = strdup(initial_dir);
+    cache->prefetch = NULL;
     cache->stdlib_path = find_stdlib_path();
 
     if (!cache->stdlib_path) {
@@ -93,11 +144,8 @@ void module_cache_free(ModuleCache *cache) {
         Module *mod = cache->modules[i];
         free(mod->absolute_path);
 
-        // Free statements
-        for (int j = 0; j < mod->num_statements; j++) {
-            stmt_free(mod->statements[j]);
-        }
-        free(mod->statements);
+        // Free the AST in one go
+        ast_arena_free(mod->arena);
 
         // Release exports environment
         if (mod->exports_env) {
@@ -114,6 +162,7 @@ void module_cache_free(ModuleCache *cache) {
     }
 
     free(cache->modules);
+    free(cache->index.slots);
     free(cache->current_dir);
     if (cache->stdlib_path) {
         free(cache->stdlib_path);
@@ -181,22 +230,13 @@ char* resolve_module_path(ModuleCache *cache, const char *importer_path, const c
 // ========== MODULE LOADING ==========
 
 Module* get_cached_module(ModuleCache *cache, const char *absolute_path) {
-    for (int i = 0; i < cache->count; i++) {
-        if (strcmp(cache->modules[i]->absolute_path, absolute_path) == 0) {
-            return cache->modules[i];
-        }
-    }
-    return NULL;
+    return path_index_get(&cache->index, absolute_path);
 }
 
-// Parse a module file and return statements
-Stmt** parse_module_file(const char *path, int *stmt_count, ExecutionContext *ctx) {
-    (void)ctx;  // Suppress unused parameter warning
-    // Read file
+// Read a module file into memory (caller must free). Returns NULL if unreadable.
+static char* read_module_source(const char *path, size_t *source_len) {
     FILE *file = fopen(path, "r");
     if (!file) {
-        fprintf(stderr, "Error: Cannot open module file '%s'\n", path);
-        *stmt_count = 0;
         return NULL;
     }
 
@@ -204,32 +244,277 @@ Stmt** parse_module_file(const char *path, int *stmt_count, ExecutionContext *ct
     fseek(file, 0, SEEK_END);
     long file_size = ftell(file);
     fseek(file, 0, SEEK_SET);
+    if (file_size < 0) {
+        fclose(file);
+        return NULL;
+    }
 
     char *source = malloc(file_size + 1);
-    fread(source, 1, file_size, file);
-    source[file_size] = '\0';
+    *source_len = fread(source, 1, file_size, file);
+    source[*source_len] = '\0';
     fclose(file);
+    return source;
+}
 
-    // Parse
-    Lexer lexer;
-    lexer_init(&lexer, source);
+// Parse module source into a new arena, reusing the on-disk parse cache when
+// the source is unchanged. Quiet parses record errors without printing them.
+static Stmt** parse_module_source(const char *path, const char *source, size_t source_len,
+                                  int *stmt_count, int quiet, AstArena **arena) {
+    *arena = ast_arena_new();
+    AstArena *previous = ast_arena_use(*arena);
+
+    Stmt **statements = parse_cache_load(path, source, source_len, stmt_count);
+    int parsed = 0;
+    if (!statements) {
+        Lexer lexer;
+        lexer_init(&lexer, source);
+
+        Parser parser;
+        parser_init(&parser, &lexer);
+        parser.quiet = quiet;
+
+        statements = parse_program(&parser, stmt_count);
+        parsed = 1;
+        if (parser.had_error) {
+            statements = NULL;
+        }
+    }
+    ast_arena_use(previous);
 
-    Parser parser;
-    parser_init(&parser, &lexer);
+    if (!statements) {
+        ast_arena_free(*arena);
+        *arena = NULL;
+        *stmt_count = 0;
+        return NULL;
+    }
+    if (parsed) {
+        parse_cache_store(path, source, source_len, statements, *stmt_count);
+    }
+
+    // The cache keeps the tree as parsed, so --no-optimize sees it unchanged
+    previous = ast_arena_use(*arena);
+    ast_optimize(statements, *stmt_count);
+    ast_arena_use(previous);
+    return statements;
+}
 
-    Stmt **statements = parse_program(&parser, stmt_count);
+// Parse a module file and return statements, owned by *arena
+Stmt** parse_module_file(const char *path, int *stmt_count, AstArena **arena, ExecutionContext *ctx) {
+    (void)ctx;  // Suppress unused parameter warning
+    size_t source_len = 0;
+    char *source = read_module_source(path, &source_len);
+    if (!source) {
+        fprintf(stderr, "Error: Cannot open module file '%s'\n", path);
+        *stmt_count = 0;
+        return NULL;
+    }
 
+    Stmt **statements = parse_module_source(path, source, source_len, stmt_count, 0, arena);
     free(source);
 
-    if (parser.had_error) {
+    if (!statements) {
         fprintf(stderr, "Error: Failed to parse module '%s'\n", path);
-        *stmt_count = 0;
         return NULL;
     }
 
     return statements;
 }
 
+// ========== PARALLEL PREFETCH ==========
+
+// Before load_module walks the import graph, the files it will reach are
+// read and parsed on a small thread pool. Each job scans its tokens for
+// `from "path"` to queue imports before parsing, so siblings and children
+// parse concurrently. load_module then takes the parsed statements in its
+// usual depth-first order, so execution order, cycle detection and error
+// messages are unchanged: a file that fails to read or parse here is simply
+// loaded again serially, which reports the error.
+
+#define PREFETCH_MAX_THREADS 8
+
+typedef struct {
+    char *path;
+    Stmt **statements;           // NULL until parsed, or if parsing failed
+    int num_statements;
+    AstArena *arena;             // Owns statements
+} PrefetchJob;
+
+struct ModulePrefetch {
+    ModuleCache *cache;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    PrefetchJob **jobs;          // Discovery order; jobs[next..count) are queued
+    int count;
+    int capacity;
+    int next;
+    int busy;                    // Jobs being processed
+    PathIndex index;             // path -> PrefetchJob
+};
+
+// Queue a path unless it was seen before (lock held)
+static void prefetch_enqueue(ModulePrefetch *pf, char *path) {
+    if (path_index_get(&pf->index, path)) {
+        free(path);
+        return;
+    }
+    if (pf->count >= pf->capacity) {
+        pf->capacity *= 2;
+        pf->jobs = realloc(pf->jobs, sizeof(PrefetchJob*) * pf->capacity);
+    }
+    PrefetchJob *job = malloc(sizeof(PrefetchJob));
+    job->path = path;
+    job->statements = NULL;
+    job->num_statements = 0;
+    job->arena = NULL;
+    pf->jobs[pf->count++] = job;
+    path_index_put(&pf->index, job->path, job);
+    pthread_cond_signal(&pf->cond);
+}
+
+static void prefetch_job(ModulePrefetch *pf, PrefetchJob *job) {
+    size_t source_len = 0;
+    char *source = read_module_source(job->path, &source_len);
+    if (!source) {
+        return;
+    }
+
+    // Token scan: every string after `from` is an import or re-export path
+    Lexer lexer;
+    lexer_init(&lexer, source);
+    int after_from = 0;
+    int lex_error = 0;
+    for (;;) {
+        Token tok = lexer_next(&lexer);
+        if (tok.type == TOK_EOF) {
+            break;
+        }
+        if (tok.type == TOK_ERROR) {
+            lex_error = 1;
+            break;
+        }
+        if (tok.type == TOK_STRING || tok.type == TOK_TEMPLATE_STRING) {
+            const char *import_path = tok.string_value;
+            if (after_from && tok.type == TOK_STRING &&
+                (strncmp(import_path, "@stdlib/", 8) != 0 || pf->cache->stdlib_path)) {
+                char *resolved = resolve_module_path(pf->cache, job->path, import_path);
+                pthread_mutex_lock(&pf->lock);
+                prefetch_enqueue(pf, resolved);
+                pthread_mutex_unlock(&pf->lock);
+            }
+            free(tok.string_value);
+        }
+        after_from = tok.type == TOK_FROM;
+    }
+
+    // Lexer errors would be reported while priming the parser; leave them
+    // to the serial load
+    if (!lex_error) {
+        job->statements = parse_module_source(job->path, source, source_len,
+                                              &job->num_statements, 1, &job->arena);
+    }
+    free(source);
+}
+
+static void prefetch_run(ModulePrefetch *pf) {
+    pthread_mutex_lock(&pf->lock);
+    for (;;) {
+        while (pf->next == pf->count && pf->busy > 0) {
+            pthread_cond_wait(&pf->cond, &pf->lock);
+        }
+        if (pf->next == pf->count) {
+            break;  // Queue empty and no job left that could add to it
+        }
+        PrefetchJob *job = pf->jobs[pf->next++];
+        pf->busy++;
+        pthread_mutex_unlock(&pf->lock);
+
+        prefetch_job(pf, job);
+
+        pthread_mutex_lock(&pf->lock);
+        pf->busy--;
+        if (pf->busy == 0 && pf->next == pf->count) {
+            pthread_cond_broadcast(&pf->cond);
+        }
+    }
+    pthread_mutex_unlock(&pf->lock);
+}
+
+static void* prefetch_worker(void *arg) {
+    prefetch_run((ModulePrefetch *)arg);
+    return NULL;
+}
+
+// Parse the import graph below absolute_path ahead of load_module
+static void module_prefetch_start(ModuleCache *cache, const char *absolute_path) {
+    ModulePrefetch *pf = malloc(sizeof(ModulePrefetch));
+    pf->cache = cache;
+    pthread_mutex_init(&pf->lock, NULL);
+    pthread_cond_init(&pf->cond, NULL);
+    pf->capacity = 32;
+    pf->jobs = malloc(sizeof(PrefetchJob*) * pf->capacity);
+    pf->count = 0;
+    pf->next = 0;
+    pf->busy = 0;
+    path_index_init(&pf->index, 64);
+    prefetch_enqueue(pf, strdup(absolute_path));
+
+    // The calling thread is one of the workers
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int helpers = (int)(cpus > PREFETCH_MAX_THREADS ? PREFETCH_MAX_THREADS : cpus) - 1;
+    pthread_t threads[PREFETCH_MAX_THREADS];
+    int started = 0;
+    for (int i = 0; i < helpers; i++) {
+        if (pthread_create(&threads[started], NULL, prefetch_worker, pf) == 0) {
+            started++;
+        }
+    }
+    prefetch_run(pf);
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    cache->prefetch = pf;
+}
+
+// Take the prefetched statements and their arena for a module, or NULL if
+// there are none
+static Stmt** module_prefetch_take(ModuleCache *cache, const char *absolute_path, int *stmt_count,
+                                   AstArena **arena) {
+    if (!cache->prefetch) {
+        return NULL;
+    }
+    PrefetchJob *job = path_index_get(&cache->prefetch->index, absolute_path);
+    if (!job || !job->statements) {
+        return NULL;
+    }
+    Stmt **statements = job->statements;
+    *stmt_count = job->num_statements;
+    *arena = job->arena;
+    job->statements = NULL;
+    job->arena = NULL;
+    return statements;
+}
+
+// Free prefetched modules that load_module never asked for
+static void module_prefetch_free(ModuleCache *cache) {
+    ModulePrefetch *pf = cache->prefetch;
+    if (!pf) {
+        return;
+    }
+    for (int i = 0; i < pf->count; i++) {
+        PrefetchJob *job = pf->jobs[i];
+        ast_arena_free(job->arena);
+        free(job->path);
+        free(job);
+    }
+    free(pf->jobs);
+    free(pf->index.slots);
+    pthread_mutex_destroy(&pf->lock);
+    pthread_cond_destroy(&pf->cond);
+    free(pf);
+    cache->prefetch = NULL;
+}
+
 // Recursively load a module and its dependencies
 Module* load_module(ModuleCache *cache, const char *module_path, ExecutionContext *ctx) {
     // Resolve to absolute path
@@ -270,9 +555,16 @@ Module* load_module(ModuleCache *cache, const char *module_path, ExecutionContex
         cache->modules = realloc(cache->modules, sizeof(Module*) * cache->capacity);
     }
     cache->modules[cache->count++] = module;
+    path_index_put(&cache->index, module->absolute_path, module);
 
-    // Parse the module file
-    module->statements = parse_module_file(absolute_path, &module->num_statements, ctx);
+    // Parse the module file, unless it was already parsed ahead
+    module->arena = NULL;
+    module->statements = module_prefetch_take(cache, absolute_path, &module->num_statements,
+                                              &module->arena);
+    if (!module->statements) {
+        module->statements = parse_module_file(absolute_path, &module->num_statements,
+                                               &module->arena, ctx);
+    }
     if (!module->statements) {
         module->state = MODULE_UNLOADED;
         return NULL;
@@ -317,7 +609,9 @@ Module* load_module(ModuleCache *cache, const char *module_path, ExecutionContex
 // ========== MODULE EXECUTION ==========
 
 // Execute a module in topological order (dependencies first)
-void execute_module(Module *module, ModuleCache *cache, Environment *global_env, ExecutionContext *ctx) {
+// Execute a module's dependencies and its first `count` top-level statements
+static void execute_module_prefix(Module *module, ModuleCache *cache, Environment *global_env,
+                                  int count, ExecutionContext *ctx) {
     if (module->exports_env) {
         // Already executed
         return;
@@ -329,7 +623,7 @@ void execute_module(Module *module, ModuleCache *cache, Environment *global_env,
     set_current_source_file(module->absolute_path);
 
     // First, execute all imported modules
-    for (int i = 0; i < module->num_statements; i++) {
+    for (int i = 0; i < count; i++) {
         Stmt *stmt = module->statements[i];
         if (stmt->type == STMT_IMPORT) {
             char *import_path = stmt->as.import_stmt.module_path;
@@ -356,7 +650,7 @@ void execute_module(Module *module, ModuleCache *cache, Environment *global_env,
     Environment *module_env = env_new(global_env);
 
     // Execute module's statements (except import/export)
-    for (int i = 0; i < module->num_statements; i++) {
+    for (int i = 0; i < count; i++) {
         Stmt *stmt = module->statements[i];
 
         if (stmt->type == STMT_IMPORT) {
@@ -467,11 +761,15 @@ void execute_module(Module *module, ModuleCache *cache, Environment *global_env,
     }
 }
 
+void execute_module(Module *module, ModuleCache *cache, Environment *global_env, ExecutionContext *ctx) {
+    execute_module_prefix(module, cache, global_env, module->num_statements, ctx);
+}
+
 // ========== HIGH-LEVEL API ==========
 
-// Execute a file using the module system
-// Returns 0 on success, non-zero on error
-int execute_file_with_modules(const char *file_path, Environment *global_env, int argc, char **argv, ExecutionContext *ctx) {
+// Load a file and its imports, then run it (or only the part the hook asks for)
+static int run_main_module(const char *file_path, Environment *global_env, const ModulePrefixHook *hook,
+                           ExecutionContext *ctx) {
     // Get current working directory
     char cwd[PATH_MAX];
     if (!getcwd(cwd, sizeof(cwd))) {
@@ -482,8 +780,13 @@ int execute_file_with_modules(const char *file_path, Environment *global_env, in
     // Create module cache
     ModuleCache *cache = module_cache_new(cwd);
 
-    // Load the main module (and all its dependencies)
+    // Parse the import graph in parallel, then load the main module (and all
+    // its dependencies) in order
+    char *main_path = resolve_module_path(cache, NULL, file_path);
+    module_prefetch_start(cache, main_path);
+    free(main_path);
     Module *main_module = load_module(cache, file_path, ctx);
+    module_prefetch_free(cache);
     if (!main_module) {
         fprintf(stderr, "Error: Failed to load module '%s'\n", file_path);
         module_cache_free(cache);
@@ -491,14 +794,37 @@ int execute_file_with_modules(const char *file_path, Environment *global_env, in
     }
 
     // Execute the main module (and all its dependencies in topological order)
-    execute_module(main_module, cache, global_env, ctx);
+    int result = 0;
+    if (hook) {
+        int count = hook->prefix_length(main_module, hook->data);
+        if (count < 0) {
+            result = 1;
+        } else {
+            execute_module_prefix(main_module, cache, global_env, count, ctx);
+            // The module ASTs are still loaded here; they go with the cache
+            result = hook->finish(main_module, main_module->exports_env, hook->data);
+        }
+    } else {
+        execute_module(main_module, cache, global_env, ctx);
+    }
 
     // Cleanup
     module_cache_free(cache);
 
+    return result;
+}
+
+// Execute a file using the module system
+// Returns 0 on success, non-zero on error
+int execute_file_with_modules(const char *file_path, Environment *global_env, int argc, char **argv, ExecutionContext *ctx) {
     // Suppress unused parameter warnings
     (void)argc;
     (void)argv;
 
-    return 0;
+    return run_main_module(file_path, global_env, NULL, ctx);
+}
+
+int execute_file_prefix(const char *file_path, Environment *global_env, const ModulePrefixHook *hook,
+                        ExecutionContext *ctx) {
+    return run_main_module(file_path, global_env, hook, ctx);
 }
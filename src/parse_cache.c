@@ -0,0 +1,221 @@
+#define _GNU_SOURCE
+#include "parse_cache.h"
+#include "cache_dir.h"
+#include "fnv1a.h"
+#include "ast_serialize.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+// ========== ENTRY FORMAT ==========
+
+// Entry layout (host byte order; the cache never leaves the machine):
+//   u32 magic, u16 format, u16 key length, key bytes,
+//   u64 source size, u64 source hash, then the .hmlc blob
+// The key holds the interpreter version, the identity of the interpreter
+// binary (so a rebuilt interpreter never reads an older AST layout) and the
+// absolute module path.
+
+#define ENTRY_MAGIC 0x45434D48  // "HMCE" in little-endian
+#define ENTRY_FORMAT 1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t format;
+    uint16_t key_len;
+} EntryHeader;
+
+typedef struct {
+    uint64_t source_size;
+    uint64_t source_hash;
+} EntrySource;
+
+// ========== CACHE LOCATION ==========
+
+static pthread_once_t cache_once = PTHREAD_ONCE_INIT;
+static char *cache_dir = NULL;       // NULL when the cache is off
+static char cache_id[CACHE_BUILD_ID_LEN];  // Version and binary identity
+static int cache_dir_ready = 0;      // Directory created (or known to exist)
+static pthread_mutex_t cache_dir_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void cache_init(void) {
+    cache_dir = cache_dir_path("modules");
+    if (cache_dir) {
+        cache_build_id(cache_id);
+    }
+}
+
+// Create the cache directory and its parents on first store
+static int cache_ensure_dir(void) {
+    pthread_mutex_lock(&cache_dir_lock);
+    if (!cache_dir_ready) {
+        cache_dir_ready = cache_make_dirs(cache_dir);
+    }
+    int ready = cache_dir_ready;
+    pthread_mutex_unlock(&cache_dir_lock);
+    return ready;
+}
+
+// ========== ENTRY NAMES ==========
+
+// Entry file for a module: one per absolute path, replaced when it changes
+static void entry_path(char *out, size_t size, const char *absolute_path) {
+    snprintf(out, size, "%s/%016llx.hmlc", cache_dir,
+             (unsigned long long)hml_fnv1a64(absolute_path, strlen(absolute_path), HML_FNV1A64_OFFSET));
+}
+
+// Key stored in the entry: build id, newline, absolute path
+static char* entry_key(const char *absolute_path, size_t *len) {
+    size_t id_len = strlen(cache_id);
+    size_t path_len = strlen(absolute_path);
+    if (id_len + 1 + path_len > UINT16_MAX) {
+        return NULL;
+    }
+    char *key = malloc(id_len + 1 + path_len);
+    memcpy(key, cache_id, id_len);
+    key[id_len] = '\n';
+    memcpy(key + id_len + 1, absolute_path, path_len);
+    *len = id_len + 1 + path_len;
+    return key;
+}
+
+// ========== LOOKUP AND STORE ==========
+
+static int read_all(int fd, uint8_t *buf, size_t len) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = read(fd, buf + done, len - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        done += (size_t)n;
+    }
+    return 0;
+}
+
+static int write_all(int fd, const void *buf, size_t len) {
+    const uint8_t *p = buf;
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = write(fd, p + done, len - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        done += (size_t)n;
+    }
+    return 0;
+}
+
+Stmt** parse_cache_load(const char *absolute_path, const char *source, size_t source_len,
+                        int *stmt_count) {
+    pthread_once(&cache_once, cache_init);
+    if (!cache_dir) {
+        return NULL;
+    }
+
+    char path[4200];
+    entry_path(path, sizeof(path), absolute_path);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)(sizeof(EntryHeader) + sizeof(EntrySource))) {
+        close(fd);
+        return NULL;
+    }
+    size_t size = (size_t)st.st_size;
+    uint8_t *data = malloc(size);
+    int failed = read_all(fd, data, size);
+    close(fd);
+    if (failed) {
+        free(data);
+        return NULL;
+    }
+
+    // Header, key and source identity must all match
+    size_t key_len = 0;
+    char *key = entry_key(absolute_path, &key_len);
+    EntryHeader header;
+    EntrySource src;
+    memcpy(&header, data, sizeof(header));
+    size_t offset = sizeof(header);
+    int match = key != NULL &&
+                header.magic == ENTRY_MAGIC &&
+                header.format == ENTRY_FORMAT &&
+                header.key_len == key_len &&
+                offset + key_len + sizeof(src) <= size &&
+                memcmp(data + offset, key, key_len) == 0;
+    free(key);
+    if (match) {
+        offset += key_len;
+        memcpy(&src, data + offset, sizeof(src));
+        offset += sizeof(src);
+        match = src.source_size == (uint64_t)source_len &&
+                src.source_hash == hml_fnv1a64(source, source_len, HML_FNV1A64_OFFSET);
+    }
+    if (!match) {
+        // Stale or foreign entry; the next store replaces it
+        free(data);
+        return NULL;
+    }
+
+    const char *error = NULL;
+    Stmt **statements = ast_try_deserialize(data + offset, size - offset, stmt_count, &error);
+    free(data);
+    if (!statements) {
+        // Corrupt blob: drop it so the parsed AST gets stored again
+        unlink(path);
+    }
+    return statements;
+}
+
+void parse_cache_store(const char *absolute_path, const char *source, size_t source_len,
+                       Stmt **statements, int stmt_count) {
+    pthread_once(&cache_once, cache_init);
+    if (!cache_dir || !cache_ensure_dir()) {
+        return;
+    }
+
+    size_t key_len = 0;
+    char *key = entry_key(absolute_path, &key_len);
+    if (!key) {
+        return;
+    }
+    size_t blob_size = 0;
+    uint8_t *blob = ast_serialize(statements, stmt_count, HMLC_FLAG_DEBUG, &blob_size);
+    if (!blob) {
+        free(key);
+        return;
+    }
+
+    EntryHeader header = { ENTRY_MAGIC, ENTRY_FORMAT, (uint16_t)key_len };
+    EntrySource src = { (uint64_t)source_len, hml_fnv1a64(source, source_len, HML_FNV1A64_OFFSET) };
+
+    // Write to a temporary file and rename it over the entry, so readers
+    // see either the old entry or the complete new one
+    char path[4200];
+    char tmp[4220];
+    entry_path(path, sizeof(path), absolute_path);
+    snprintf(tmp, sizeof(tmp), "%s.XXXXXX", path);
+    int fd = mkostemp(tmp, O_CLOEXEC);
+    if (fd >= 0) {
+        int failed = write_all(fd, &header, sizeof(header)) ||
+                     write_all(fd, key, key_len) ||
+                     write_all(fd, &src, sizeof(src)) ||
+                     write_all(fd, blob, blob_size);
+        if (close(fd) != 0) {
+            failed = 1;
+        }
+        if (failed || rename(tmp, path) != 0) {
+            unlink(tmp);
+        }
+    }
+
+    free(blob);
+    free(key);
+}
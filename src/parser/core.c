@@ -5,6 +5,11 @@
 void error_at(Parser *p, Token *token, const char *message) {
     if (p->panic_mode) return;
     p->panic_mode = 1;
+    p->had_error = 1;
+    if (p->on_error) {
+        p->on_error(p->on_error_data, token, message);
+    }
+    if (p->quiet) return;
     
     fprintf(stderr, "[line %d] Error", token->line);
     
@@ -17,7 +22,6 @@ void error_at(Parser *p, Token *token, const char *message) {
     }
     
     fprintf(stderr, ": %s\n", message);
-    p->had_error = 1;
 }
 
 void error(Parser *p, const char *message) {
@@ -36,8 +40,21 @@ void synchronize(Parser *p) {
 
         switch (p->current.type) {
             case TOK_LET:
+            case TOK_CONST:
+            case TOK_FN:
             case TOK_IF:
             case TOK_WHILE:
+            case TOK_FOR:
+            case TOK_SWITCH:
+            case TOK_TRY:
+            case TOK_THROW:
+            case TOK_RETURN:
+            case TOK_DEFER:
+            case TOK_DEFINE:
+            case TOK_ENUM:
+            case TOK_IMPORT:
+            case TOK_EXPORT:
+            case TOK_EXTERN:
                 return;
             default:
                 ; // Do nothing
@@ -79,26 +96,56 @@ int match(Parser *p, TokenType type) {
     return 1;
 }
 
+char* token_name(Token *token) {
+    return ast_strndup(token->start, (size_t)token->length);
+}
+
 // ========== PUBLIC INTERFACE ==========
 
 void parser_init(Parser *parser, Lexer *lexer) {
     parser->lexer = lexer;
     parser->had_error = 0;
     parser->panic_mode = 0;
-    
+    parser->quiet = 0;
+    parser->on_error = NULL;
+    parser->on_error_data = NULL;
+
+    // Errors reported before the first token point at the start of input
+    memset(&parser->current, 0, sizeof(Token));
+    parser->current.start = lexer->current;
+    parser->current.line = lexer->line;
+
     advance(parser);  // Prime the pump
 }
 
 Stmt** parse_program(Parser *parser, int *stmt_count) {
-    Stmt **statements = malloc(sizeof(Stmt*) * 256);  // max 256 statements
+    int capacity = 64;
+    Stmt **statements = ast_alloc(sizeof(Stmt*) * capacity);
     *stmt_count = 0;
 
     while (!match(parser, TOK_EOF)) {
         if (parser->panic_mode) {
             synchronize(parser);
+            if (check(parser, TOK_EOF)) break;
         }
-        statements[(*stmt_count)++] = statement(parser);
+        statements = ast_array_grow(statements, *stmt_count, &capacity, sizeof(Stmt*));
+        statements[(*stmt_count)++] = parse_statement(parser);
     }
 
     return statements;
+}
+
+void parser_synchronize(Parser *parser) {
+    synchronize(parser);
+}
+
+Stmt* parse_statement(Parser *parser) {
+    const char *start = parser->current.start;
+    Stmt *stmt = statement(parser);
+    // A statement that fails on its first token consumes nothing; skip the
+    // token so recovery cannot spin on it
+    if (parser->current.start == start && !check(parser, TOK_EOF)) {
+        advance(parser);
+    }
+    return stmt;
 }
\ No newline at end of file
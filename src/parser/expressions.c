@@ -35,18 +35,19 @@ static int is_type_keyword(TokenType type) {
 static char* consume_identifier_or_type(Parser *p, const char *message) {
     if (p->current.type == TOK_IDENT || is_type_keyword(p->current.type)) {
         advance(p);
-        return token_text(&p->previous);
+        return token_name(&p->previous);
     }
     error_at_current(p, message);
-    return strdup("error");
+    return ast_strdup("error");
 }
 
 // Helper: Parse interpolated string with ${...} expressions
 static Expr* parse_interpolated_string(Parser *p, const char *str_content) {
-    char **string_parts = malloc(sizeof(char*) * 32);  // Array of string literals
-    Expr **expr_parts = malloc(sizeof(Expr*) * 32);    // Array of expressions
+    int capacity = 4;
+    int expr_capacity = 4;
+    char **string_parts = ast_alloc(sizeof(char*) * capacity);  // Array of string literals
+    Expr **expr_parts = ast_alloc(sizeof(Expr*) * expr_capacity);  // Array of expressions
     int num_parts = 0;
-    int capacity = 32;
 
     const char *ptr = str_content;
     char *current_string = malloc(1024);
@@ -57,8 +58,8 @@ static Expr* parse_interpolated_string(Parser *p, const char *str_content) {
         if (*ptr == '$' && *(ptr + 1) == '{') {
             // Found interpolation start
             // Save current string part
-            current_string[str_len] = '\0';
-            string_parts[num_parts] = strdup(current_string);
+            string_parts = ast_array_grow(string_parts, num_parts, &capacity, sizeof(char*));
+            string_parts[num_parts] = ast_strndup(current_string, (size_t)str_len);
             str_len = 0;
 
             // Find matching }
@@ -89,20 +90,16 @@ static Expr* parse_interpolated_string(Parser *p, const char *str_content) {
 
             Parser expr_parser;
             parser_init(&expr_parser, &expr_lexer);
+            expr_parser.quiet = p->quiet;
 
             Expr *interpolated_expr = expression(&expr_parser);
+            expr_parts = ast_array_grow(expr_parts, num_parts, &expr_capacity, sizeof(Expr*));
             expr_parts[num_parts] = interpolated_expr;
 
-            // Note: Not freeing expr_text here because the lexer/parser may have pointers into it
-            // This is a known memory leak that should be fixed by tracking allocated strings
-            // TODO: Track expr_text allocations and free them after AST is no longer needed
+            // The AST holds copies of every name, so the text can go now
+            free(expr_text);
 
             num_parts++;
-            if (num_parts >= capacity) {
-                capacity *= 2;
-                string_parts = realloc(string_parts, sizeof(char*) * capacity);
-                expr_parts = realloc(expr_parts, sizeof(Expr*) * capacity);
-            }
 
             ptr++;  // Skip closing }
         } else {
@@ -117,8 +114,8 @@ static Expr* parse_interpolated_string(Parser *p, const char *str_content) {
     }
 
     // Save final string part
-    current_string[str_len] = '\0';
-    string_parts[num_parts] = strdup(current_string);
+    string_parts = ast_array_grow(string_parts, num_parts, &capacity, sizeof(char*));
+    string_parts[num_parts] = ast_strndup(current_string, (size_t)str_len);
     free(current_string);
 
     // Create interpolation expression
@@ -166,9 +163,9 @@ Expr* primary(Parser *p) {
     }
 
     if (match(p, TOK_IDENT)) {
-        char *name = token_text(&p->previous);
+        char *name = token_name(&p->previous);
         Expr *ident = expr_ident(name);
-        free(name);
+        ast_free(name);
         return ident;
     }
 
@@ -184,11 +181,15 @@ Expr* primary(Parser *p) {
 
     // Object literal: { field: value, ... }
     if (match(p, TOK_LBRACE)) {
-        char **field_names = malloc(sizeof(char*) * 32);
-        Expr **field_values = malloc(sizeof(Expr*) * 32);
+        int capacity = 8;
+        int values_capacity = 8;
+        char **field_names = ast_alloc(sizeof(char*) * capacity);
+        Expr **field_values = ast_alloc(sizeof(Expr*) * values_capacity);
         int num_fields = 0;
 
         while (!check(p, TOK_RBRACE) && !check(p, TOK_EOF)) {
+            field_names = ast_array_grow(field_names, num_fields, &capacity, sizeof(char*));
+            field_values = ast_array_grow(field_values, num_fields, &values_capacity, sizeof(Expr*));
             field_names[num_fields] = consume_identifier_or_type(p, "Expect field name");
 
             consume(p, TOK_COLON, "Expect ':' after field name");
@@ -206,11 +207,13 @@ Expr* primary(Parser *p) {
 
     // Array literal: [elem1, elem2, ...]
     if (match(p, TOK_LBRACKET)) {
-        Expr **elements = malloc(sizeof(Expr*) * 256);
+        int capacity = 8;
+        Expr **elements = ast_alloc(sizeof(Expr*) * capacity);
         int num_elements = 0;
 
         if (!check(p, TOK_RBRACKET)) {
             do {
+                elements = ast_array_grow(elements, num_elements, &capacity, sizeof(Expr*));
                 elements[num_elements++] = expression(p);
             } while (match(p, TOK_COMMA));
         }
@@ -236,16 +239,22 @@ Expr* primary(Parser *p) {
     consume(p, TOK_LPAREN, "Expect '(' after 'fn'");
 
     // Parse parameters
-    char **param_names = malloc(sizeof(char*) * 32);  // max 32 params
-    Type **param_types = malloc(sizeof(Type*) * 32);
-    Expr **param_defaults = malloc(sizeof(Expr*) * 32);
+    int names_capacity = 4;
+    int types_capacity = 4;
+    int defaults_capacity = 4;
+    char **param_names = ast_alloc(sizeof(char*) * names_capacity);
+    Type **param_types = ast_alloc(sizeof(Type*) * types_capacity);
+    Expr **param_defaults = ast_alloc(sizeof(Expr*) * defaults_capacity);
     int num_params = 0;
     int seen_optional = 0;  // Track if we've seen an optional parameter
 
     if (!check(p, TOK_RPAREN)) {
         do {
+            param_names = ast_array_grow(param_names, num_params, &names_capacity, sizeof(char*));
+            param_types = ast_array_grow(param_types, num_params, &types_capacity, sizeof(Type*));
+            param_defaults = ast_array_grow(param_defaults, num_params, &defaults_capacity, sizeof(Expr*));
             consume(p, TOK_IDENT, "Expect parameter name");
-            param_names[num_params] = token_text(&p->previous);
+            param_names[num_params] = token_name(&p->previous);
 
             // Optional type annotation
             if (match(p, TOK_COLON)) {
@@ -312,6 +321,18 @@ not_fn_expr:
     return expr_number(0);
 }
 
+// Helper: Parse a non-empty, comma-separated argument list
+static Expr** parse_arguments(Parser *p, int *num_args) {
+    int capacity = 4;
+    Expr **args = ast_alloc(sizeof(Expr*) * capacity);
+    *num_args = 0;
+    do {
+        args = ast_array_grow(args, *num_args, &capacity, sizeof(Expr*));
+        args[(*num_args)++] = expression(p);
+    } while (match(p, TOK_COMMA));
+    return args;
+}
+
 Expr* postfix(Parser *p) {
     Expr *expr = primary(p);
 
@@ -331,12 +352,7 @@ Expr* postfix(Parser *p) {
                 int num_args = 0;
 
                 if (!check(p, TOK_RPAREN)) {
-                    args = malloc(sizeof(Expr*) * 8);
-                    args[num_args++] = expression(p);
-
-                    while (match(p, TOK_COMMA)) {
-                        args[num_args++] = expression(p);
-                    }
+                    args = parse_arguments(p, &num_args);
                 }
 
                 consume(p, TOK_RPAREN, "Expect ')' after optional chaining arguments");
@@ -345,13 +361,13 @@ Expr* postfix(Parser *p) {
                 // Optional property access: obj?.property
                 char *property = consume_identifier_or_type(p, "Expect property name after '?.'");
                 expr = expr_optional_chain_property(expr, property);
-                free(property);
+                ast_free(property);
             }
         } else if (match(p, TOK_DOT)) {
             // Property access: obj.property
             char *property = consume_identifier_or_type(p, "Expect property name after '.'");
             expr = expr_get_property(expr, property);
-            free(property);
+            ast_free(property);
         } else if (match(p, TOK_LBRACKET)) {
             // Indexing: obj[index]
             Expr *index = expression(p);
@@ -364,12 +380,7 @@ Expr* postfix(Parser *p) {
             int num_args = 0;
 
             if (!check(p, TOK_RPAREN)) {
-                args = malloc(sizeof(Expr*) * 8);
-                args[num_args++] = expression(p);
-
-                while (match(p, TOK_COMMA)) {
-                    args[num_args++] = expression(p);
-                }
+                args = parse_arguments(p, &num_args);
             }
 
             consume(p, TOK_RPAREN, "Expect ')' after arguments");
@@ -605,11 +616,13 @@ Expr* assignment(Parser *p) {
 
         if (expr->type == EXPR_IDENT) {
             // Variable compound assignment: x += 5
-            char *name = strdup(expr->as.ident);
+            char *name = ast_strdup(expr->as.ident);
             Expr *lhs_copy = expr_ident(name);
             Expr *binary = expr_binary(lhs_copy, compound_op, rhs);
             expr_free(expr);
-            return expr_assign(name, binary);
+            Expr *assign = expr_assign(name, binary);
+            ast_free(name);
+            return assign;
         } else if (expr->type == EXPR_INDEX) {
             // Index compound assignment: arr[i] += 5
             // Desugar to: arr[i] = arr[i] + 5
@@ -638,7 +651,7 @@ Expr* assignment(Parser *p) {
             // Property compound assignment: obj.field += 5
             // Desugar to: obj.field = obj.field + 5
             Expr *object = expr->as.get_property.object;
-            char *property = strdup(expr->as.get_property.property);
+            char *property = ast_strdup(expr->as.get_property.property);
 
             // Clone the object for the RHS
             Expr *object_clone = expr_clone(object);
@@ -654,7 +667,9 @@ Expr* assignment(Parser *p) {
             expr_free(expr);
 
             // Create the assignment: obj.field = obj.field + 5
-            return expr_set_property(object, property, binary);
+            Expr *assign = expr_set_property(object, property, binary);
+            ast_free(property);
+            return assign;
         } else {
             error(p, "Invalid compound assignment target");
             expr_free(expr);
@@ -666,10 +681,12 @@ Expr* assignment(Parser *p) {
         // Check what kind of assignment target we have
         if (expr->type == EXPR_IDENT) {
             // Regular variable assignment
-            char *name = strdup(expr->as.ident);
+            char *name = ast_strdup(expr->as.ident);
             Expr *value = assignment(p);
             expr_free(expr);
-            return expr_assign(name, value);
+            Expr *assign = expr_assign(name, value);
+            ast_free(name);
+            return assign;
         } else if (expr->type == EXPR_INDEX) {
             // Index assignment: obj[index] = value
             Expr *object = expr->as.index.object;
@@ -686,14 +703,16 @@ Expr* assignment(Parser *p) {
         } else if (expr->type == EXPR_GET_PROPERTY) {
             // Property assignment: obj.field = value
             Expr *object = expr->as.get_property.object;
-            char *property = strdup(expr->as.get_property.property);
+            char *property = ast_strdup(expr->as.get_property.property);
             Expr *value = assignment(p);
 
             // Steal the object from the EXPR_GET_PROPERTY
             expr->as.get_property.object = NULL;
             expr_free(expr);
 
-            return expr_set_property(object, property, value);
+            Expr *assign = expr_set_property(object, property, value);
+            ast_free(property);
+            return assign;
         } else {
             error(p, "Invalid assignment target");
             return expr;
@@ -739,7 +758,7 @@ Type* parse_type(Parser *p) {
 
     // Check for custom object type name (identifier)
     if (p->current.type == TOK_IDENT) {
-        char *type_name = token_text(&p->current);
+        char *type_name = token_name(&p->current);
         advance(p);
         Type *type = type_new(TYPE_CUSTOM_OBJECT);
         type->type_name = type_name;
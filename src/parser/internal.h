@@ -20,6 +20,9 @@ void consume(Parser *p, TokenType type, const char *message);
 int check(Parser *p, TokenType type);
 int match(Parser *p, TokenType type);
 
+// Identifier text as an AST-owned string (interned under an arena)
+char* token_name(Token *token);
+
 // ========== EXPRESSION PARSING (from expressions.c) ==========
 
 Expr* expression(Parser *p);
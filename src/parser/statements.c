@@ -6,7 +6,7 @@ Stmt* statement(Parser *p);
 
 Stmt* let_statement(Parser *p) {
     consume(p, TOK_IDENT, "Expect variable name");
-    char *name = token_text(&p->previous);
+    char *name = token_name(&p->previous);
 
     Type *type_annotation = NULL;
 
@@ -22,13 +22,13 @@ Stmt* let_statement(Parser *p) {
     consume(p, TOK_SEMICOLON, "Expect ';' after variable declaration");
 
     Stmt *stmt = stmt_let_typed(name, type_annotation, value);
-    free(name);
+    ast_free(name);
     return stmt;
 }
 
 Stmt* const_statement(Parser *p) {
     consume(p, TOK_IDENT, "Expect variable name");
-    char *name = token_text(&p->previous);
+    char *name = token_name(&p->previous);
 
     Type *type_annotation = NULL;
 
@@ -44,16 +44,18 @@ Stmt* const_statement(Parser *p) {
     consume(p, TOK_SEMICOLON, "Expect ';' after variable declaration");
 
     Stmt *stmt = stmt_const_typed(name, type_annotation, value);
-    free(name);
+    ast_free(name);
     return stmt;
 }
 
 Stmt* block_statement(Parser *p) {
-    Stmt **statements = malloc(sizeof(Stmt*) * 256);
+    int capacity = 8;
+    Stmt **statements = ast_alloc(sizeof(Stmt*) * capacity);
     int count = 0;
     
     while (!check(p, TOK_RBRACE) && !check(p, TOK_EOF)) {
-        statements[count++] = statement(p);
+        statements = ast_array_grow(statements, count, &capacity, sizeof(Stmt*));
+        statements[count++] = parse_statement(p);
     }
     
     consume(p, TOK_RBRACE, "Expect '}' after block");
@@ -103,21 +105,27 @@ Stmt* switch_statement(Parser *p) {
     consume(p, TOK_LBRACE, "Expect '{' after switch expression");
 
     // Parse cases
-    Expr **case_values = malloc(sizeof(Expr*) * 128);
-    Stmt **case_bodies = malloc(sizeof(Stmt*) * 128);
+    int values_capacity = 8;
+    int bodies_capacity = 8;
+    Expr **case_values = ast_alloc(sizeof(Expr*) * values_capacity);
+    Stmt **case_bodies = ast_alloc(sizeof(Stmt*) * bodies_capacity);
     int num_cases = 0;
 
     while (!check(p, TOK_RBRACE) && !check(p, TOK_EOF)) {
+        case_values = ast_array_grow(case_values, num_cases, &values_capacity, sizeof(Expr*));
+        case_bodies = ast_array_grow(case_bodies, num_cases, &bodies_capacity, sizeof(Stmt*));
         if (match(p, TOK_CASE)) {
             // Parse case value
             case_values[num_cases] = expression(p);
             consume(p, TOK_COLON, "Expect ':' after case value");
 
             // Parse case body statements until we hit another case/default/closing brace
-            Stmt **statements = malloc(sizeof(Stmt*) * 128);
+            int capacity = 8;
+            Stmt **statements = ast_alloc(sizeof(Stmt*) * capacity);
             int count = 0;
 
             while (!check(p, TOK_CASE) && !check(p, TOK_DEFAULT) && !check(p, TOK_RBRACE) && !check(p, TOK_EOF)) {
+                statements = ast_array_grow(statements, count, &capacity, sizeof(Stmt*));
                 statements[count++] = statement(p);
             }
 
@@ -130,10 +138,12 @@ Stmt* switch_statement(Parser *p) {
             case_values[num_cases] = NULL;
 
             // Parse default body statements
-            Stmt **statements = malloc(sizeof(Stmt*) * 128);
+            int capacity = 8;
+            Stmt **statements = ast_alloc(sizeof(Stmt*) * capacity);
             int count = 0;
 
             while (!check(p, TOK_CASE) && !check(p, TOK_DEFAULT) && !check(p, TOK_RBRACE) && !check(p, TOK_EOF)) {
+                statements = ast_array_grow(statements, count, &capacity, sizeof(Stmt*));
                 statements[count++] = statement(p);
             }
 
@@ -159,12 +169,12 @@ Stmt* for_statement(Parser *p) {
 
     if (match(p, TOK_LET)) {
         consume(p, TOK_IDENT, "Expect variable name");
-        first_var = token_text(&p->previous);
+        first_var = token_name(&p->previous);
 
         if (match(p, TOK_COMMA)) {
             // for (let key, value in ...)
             consume(p, TOK_IDENT, "Expect second variable name");
-            second_var = token_text(&p->previous);
+            second_var = token_name(&p->previous);
             consume(p, TOK_IN, "Expect 'in' in for-in loop");
             is_for_in = 1;
         } else if (match(p, TOK_IN)) {
@@ -199,7 +209,7 @@ Stmt* for_statement(Parser *p) {
         consume(p, TOK_SEMICOLON, "Expect ';' after for loop initializer");
 
         Stmt *initializer = stmt_let_typed(first_var, type, init_value);
-        free(first_var);
+        ast_free(first_var);
 
         // Parse condition
         Expr *condition = NULL;
@@ -281,7 +291,7 @@ Stmt* import_statement(Parser *p) {
     if (match(p, TOK_STAR)) {
         consume(p, TOK_AS, "Expect 'as' after '*' in namespace import");
         consume(p, TOK_IDENT, "Expect identifier for namespace name");
-        char *namespace_name = token_text(&p->previous);
+        char *namespace_name = token_name(&p->previous);
 
         consume(p, TOK_FROM, "Expect 'from' in import statement");
         consume(p, TOK_STRING, "Expect module path string");
@@ -290,7 +300,7 @@ Stmt* import_statement(Parser *p) {
         consume(p, TOK_SEMICOLON, "Expect ';' after import statement");
 
         Stmt *stmt = stmt_import_namespace(namespace_name, module_path);
-        free(namespace_name);
+        ast_free(namespace_name);
         free(module_path);
         return stmt;
     }
@@ -298,18 +308,22 @@ Stmt* import_statement(Parser *p) {
     // Named imports: import { name1, name2 as alias } from "module"
     consume(p, TOK_LBRACE, "Expect '{', '*', or string after 'import'");
 
-    char **import_names = malloc(sizeof(char*) * 32);
-    char **import_aliases = malloc(sizeof(char*) * 32);
+    int names_capacity = 8;
+    int aliases_capacity = 8;
+    char **import_names = ast_alloc(sizeof(char*) * names_capacity);
+    char **import_aliases = ast_alloc(sizeof(char*) * aliases_capacity);
     int num_imports = 0;
 
     do {
+        import_names = ast_array_grow(import_names, num_imports, &names_capacity, sizeof(char*));
+        import_aliases = ast_array_grow(import_aliases, num_imports, &aliases_capacity, sizeof(char*));
         consume(p, TOK_IDENT, "Expect import name");
-        import_names[num_imports] = token_text(&p->previous);
+        import_names[num_imports] = token_name(&p->previous);
 
         // Check for alias: name as alias
         if (match(p, TOK_AS)) {
             consume(p, TOK_IDENT, "Expect alias name after 'as'");
-            import_aliases[num_imports] = token_text(&p->previous);
+            import_aliases[num_imports] = token_name(&p->previous);
         } else {
             import_aliases[num_imports] = NULL;
         }
@@ -332,18 +346,22 @@ Stmt* import_statement(Parser *p) {
 Stmt* export_statement(Parser *p) {
     // Check for re-export: export { name1, name2 } from "module"
     if (match(p, TOK_LBRACE)) {
-        char **export_names = malloc(sizeof(char*) * 32);
-        char **export_aliases = malloc(sizeof(char*) * 32);
+        int names_capacity = 8;
+        int aliases_capacity = 8;
+        char **export_names = ast_alloc(sizeof(char*) * names_capacity);
+        char **export_aliases = ast_alloc(sizeof(char*) * aliases_capacity);
         int num_exports = 0;
 
         do {
+            export_names = ast_array_grow(export_names, num_exports, &names_capacity, sizeof(char*));
+            export_aliases = ast_array_grow(export_aliases, num_exports, &aliases_capacity, sizeof(char*));
             consume(p, TOK_IDENT, "Expect export name");
-            export_names[num_exports] = token_text(&p->previous);
+            export_names[num_exports] = token_name(&p->previous);
 
             // Check for alias: name as alias
             if (match(p, TOK_AS)) {
                 consume(p, TOK_IDENT, "Expect alias name after 'as'");
-                export_aliases[num_exports] = token_text(&p->previous);
+                export_aliases[num_exports] = token_name(&p->previous);
             } else {
                 export_aliases[num_exports] = NULL;
             }
@@ -394,21 +412,27 @@ Stmt* export_statement(Parser *p) {
 
     // Must be a named function
     consume(p, TOK_IDENT, "Expect function name after 'export fn'");
-    char *name = token_text(&p->previous);
+    char *name = token_name(&p->previous);
 
     // Parse function (same as in statement())
     consume(p, TOK_LPAREN, "Expect '(' after function name");
 
-    char **param_names = malloc(sizeof(char*) * 32);
-    Type **param_types = malloc(sizeof(Type*) * 32);
-    Expr **param_defaults = malloc(sizeof(Expr*) * 32);
+    int names_capacity = 4;
+    int types_capacity = 4;
+    int defaults_capacity = 4;
+    char **param_names = ast_alloc(sizeof(char*) * names_capacity);
+    Type **param_types = ast_alloc(sizeof(Type*) * types_capacity);
+    Expr **param_defaults = ast_alloc(sizeof(Expr*) * defaults_capacity);
     int num_params = 0;
     int seen_optional = 0;
 
     if (!check(p, TOK_RPAREN)) {
         do {
+            param_names = ast_array_grow(param_names, num_params, &names_capacity, sizeof(char*));
+            param_types = ast_array_grow(param_types, num_params, &types_capacity, sizeof(Type*));
+            param_defaults = ast_array_grow(param_defaults, num_params, &defaults_capacity, sizeof(Expr*));
             consume(p, TOK_IDENT, "Expect parameter name");
-            param_names[num_params] = token_text(&p->previous);
+            param_names[num_params] = token_name(&p->previous);
 
             if (match(p, TOK_COLON)) {
                 param_types[num_params] = parse_type(p);
@@ -449,7 +473,7 @@ Stmt* export_statement(Parser *p) {
 
     // Create let statement
     Stmt *decl = stmt_let_typed(name, NULL, fn_expr);
-    free(name);
+    ast_free(name);
 
     return stmt_export_declaration(decl);
 }
@@ -458,16 +482,18 @@ Stmt* extern_fn_statement(Parser *p) {
     // extern fn name(param1: type1, param2: type2): return_type;
     consume(p, TOK_FN, "Expect 'fn' after 'extern'");
     consume(p, TOK_IDENT, "Expect function name");
-    char *function_name = token_text(&p->previous);
+    char *function_name = token_name(&p->previous);
 
     consume(p, TOK_LPAREN, "Expect '(' after function name");
 
     // Parse parameters
-    Type **param_types = malloc(sizeof(Type*) * 32);
+    int capacity = 4;
+    Type **param_types = ast_alloc(sizeof(Type*) * capacity);
     int num_params = 0;
 
     if (!check(p, TOK_RPAREN)) {
         do {
+            param_types = ast_array_grow(param_types, num_params, &capacity, sizeof(Type*));
             // Parameter name is not used in FFI, but required for syntax
             consume(p, TOK_IDENT, "Expect parameter name");
             consume(p, TOK_COLON, "Expect ':' after parameter name in extern declaration");
@@ -487,7 +513,7 @@ Stmt* extern_fn_statement(Parser *p) {
     consume(p, TOK_SEMICOLON, "Expect ';' after extern declaration");
 
     Stmt *stmt = stmt_extern_fn(function_name, param_types, num_params, return_type);
-    free(function_name);
+    ast_free(function_name);
     return stmt;
 }
 
@@ -503,20 +529,28 @@ Stmt* statement(Parser *p) {
     // Object type definition: define TypeName { ... }
     if (match(p, TOK_DEFINE)) {
         consume(p, TOK_IDENT, "Expect object type name");
-        char *name = token_text(&p->previous);
+        char *name = token_name(&p->previous);
 
         consume(p, TOK_LBRACE, "Expect '{' after type name");
 
         // Parse fields
-        char **field_names = malloc(sizeof(char*) * 32);
-        Type **field_types = malloc(sizeof(Type*) * 32);
-        int *field_optional = malloc(sizeof(int) * 32);
-        Expr **field_defaults = malloc(sizeof(Expr*) * 32);
+        int names_capacity = 8;
+        int types_capacity = 8;
+        int optional_capacity = 8;
+        int defaults_capacity = 8;
+        char **field_names = ast_alloc(sizeof(char*) * names_capacity);
+        Type **field_types = ast_alloc(sizeof(Type*) * types_capacity);
+        int *field_optional = ast_alloc(sizeof(int) * optional_capacity);
+        Expr **field_defaults = ast_alloc(sizeof(Expr*) * defaults_capacity);
         int num_fields = 0;
 
         while (!check(p, TOK_RBRACE) && !check(p, TOK_EOF)) {
+            field_names = ast_array_grow(field_names, num_fields, &names_capacity, sizeof(char*));
+            field_types = ast_array_grow(field_types, num_fields, &types_capacity, sizeof(Type*));
+            field_optional = ast_array_grow(field_optional, num_fields, &optional_capacity, sizeof(int));
+            field_defaults = ast_array_grow(field_defaults, num_fields, &defaults_capacity, sizeof(Expr*));
             consume(p, TOK_IDENT, "Expect field name");
-            field_names[num_fields] = token_text(&p->previous);
+            field_names[num_fields] = token_name(&p->previous);
 
             // Check for optional marker followed by colon (?: syntax)
             if (match(p, TOK_QUESTION)) {
@@ -576,25 +610,29 @@ Stmt* statement(Parser *p) {
 
         Stmt *stmt = stmt_define_object(name, field_names, field_types,
                                        field_optional, field_defaults, num_fields);
-        free(name);
+        ast_free(name);
         return stmt;
     }
 
     // Enum definition: enum EnumName { ... }
     if (match(p, TOK_ENUM)) {
         consume(p, TOK_IDENT, "Expect enum type name");
-        char *name = token_text(&p->previous);
+        char *name = token_name(&p->previous);
 
         consume(p, TOK_LBRACE, "Expect '{' after enum name");
 
         // Parse variants
-        char **variant_names = malloc(sizeof(char*) * 32);
-        Expr **variant_values = malloc(sizeof(Expr*) * 32);
+        int names_capacity = 8;
+        int values_capacity = 8;
+        char **variant_names = ast_alloc(sizeof(char*) * names_capacity);
+        Expr **variant_values = ast_alloc(sizeof(Expr*) * values_capacity);
         int num_variants = 0;
 
         while (!check(p, TOK_RBRACE) && !check(p, TOK_EOF)) {
+            variant_names = ast_array_grow(variant_names, num_variants, &names_capacity, sizeof(char*));
+            variant_values = ast_array_grow(variant_values, num_variants, &values_capacity, sizeof(Expr*));
             consume(p, TOK_IDENT, "Expect variant name");
-            variant_names[num_variants] = token_text(&p->previous);
+            variant_names[num_variants] = token_name(&p->previous);
 
             // Check for explicit value assignment
             if (match(p, TOK_EQUAL)) {
@@ -611,7 +649,7 @@ Stmt* statement(Parser *p) {
         consume(p, TOK_RBRACE, "Expect '}' after enum variants");
 
         Stmt *stmt = stmt_enum(name, variant_names, variant_values, num_variants);
-        free(name);
+        ast_free(name);
         return stmt;
     }
 
@@ -630,23 +668,29 @@ Stmt* statement(Parser *p) {
 
     // Check if it's a named function (next token is identifier)
     if (check(p, TOK_IDENT)) {
-        char *name = token_text(&p->current);
+        char *name = token_name(&p->current);
         advance(p);  // consume identifier
 
         // Now parse as function expression
         consume(p, TOK_LPAREN, "Expect '(' after function name");
 
         // Parse parameters
-        char **param_names = malloc(sizeof(char*) * 32);
-        Type **param_types = malloc(sizeof(Type*) * 32);
-        Expr **param_defaults = malloc(sizeof(Expr*) * 32);
+        int names_capacity = 4;
+        int types_capacity = 4;
+        int defaults_capacity = 4;
+        char **param_names = ast_alloc(sizeof(char*) * names_capacity);
+        Type **param_types = ast_alloc(sizeof(Type*) * types_capacity);
+        Expr **param_defaults = ast_alloc(sizeof(Expr*) * defaults_capacity);
         int num_params = 0;
         int seen_optional = 0;
 
         if (!check(p, TOK_RPAREN)) {
             do {
+                param_names = ast_array_grow(param_names, num_params, &names_capacity, sizeof(char*));
+                param_types = ast_array_grow(param_types, num_params, &types_capacity, sizeof(Type*));
+                param_defaults = ast_array_grow(param_defaults, num_params, &defaults_capacity, sizeof(Expr*));
                 consume(p, TOK_IDENT, "Expect parameter name");
-                param_names[num_params] = token_text(&p->previous);
+                param_names[num_params] = token_name(&p->previous);
 
                 if (match(p, TOK_COLON)) {
                     param_types[num_params] = parse_type(p);
@@ -687,7 +731,7 @@ Stmt* statement(Parser *p) {
 
         // Desugar to let statement
         Stmt *stmt = stmt_let_typed(name, NULL, fn_expr);
-        free(name);
+        ast_free(name);
         return stmt;
     } else {
         // Anonymous function at statement level - error
@@ -734,7 +778,7 @@ not_function:
         if (match(p, TOK_CATCH)) {
             consume(p, TOK_LPAREN, "Expect '(' after 'catch'");
             consume(p, TOK_IDENT, "Expect parameter name");
-            catch_param = token_text(&p->previous);
+            catch_param = token_name(&p->previous);
             consume(p, TOK_RPAREN, "Expect ')' after catch parameter");
             consume(p, TOK_LBRACE, "Expect '{' before catch block");
             catch_block = block_statement(p);
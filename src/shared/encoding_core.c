@@ -0,0 +1,583 @@
+/*
+ * Hemlock Encoding Core
+ *
+ * The value-independent half of the base64, hex and URL builtins, compiled
+ * into both the interpreter and the runtime library. On x86-64 the base64
+ * and hex kernels have SSSE3 and AVX2 paths selected at runtime from CPUID;
+ * the URL codecs copy 16-byte blocks of plain characters found with SSE2,
+ * which every x86-64 CPU has. Other targets use the scalar code. Both
+ * Makefiles build this file with -O2 (the intrinsics are far slower in the
+ * default unoptimized build).
+ */
+
+#include "encoding_core.h"
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define ENC_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+#define ENC_SIMD_NONE  0
+#define ENC_SIMD_SSSE3 1
+#define ENC_SIMD_AVX2  2
+
+static const char BASE64_CHARS[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const char HEX_CHARS[] = "0123456789abcdef";
+
+// Reverse lookup for base64/hex: value, or -1 for characters outside the alphabet
+static const int8_t BASE64_VALUES[256] = {
+    ['A'] = 0,  ['B'] = 1,  ['C'] = 2,  ['D'] = 3,  ['E'] = 4,  ['F'] = 5,
+    ['G'] = 6,  ['H'] = 7,  ['I'] = 8,  ['J'] = 9,  ['K'] = 10, ['L'] = 11,
+    ['M'] = 12, ['N'] = 13, ['O'] = 14, ['P'] = 15, ['Q'] = 16, ['R'] = 17,
+    ['S'] = 18, ['T'] = 19, ['U'] = 20, ['V'] = 21, ['W'] = 22, ['X'] = 23,
+    ['Y'] = 24, ['Z'] = 25, ['a'] = 26, ['b'] = 27, ['c'] = 28, ['d'] = 29,
+    ['e'] = 30, ['f'] = 31, ['g'] = 32, ['h'] = 33, ['i'] = 34, ['j'] = 35,
+    ['k'] = 36, ['l'] = 37, ['m'] = 38, ['n'] = 39, ['o'] = 40, ['p'] = 41,
+    ['q'] = 42, ['r'] = 43, ['s'] = 44, ['t'] = 45, ['u'] = 46, ['v'] = 47,
+    ['w'] = 48, ['x'] = 49, ['y'] = 50, ['z'] = 51, ['0'] = 52, ['1'] = 53,
+    ['2'] = 54, ['3'] = 55, ['4'] = 56, ['5'] = 57, ['6'] = 58, ['7'] = 59,
+    ['8'] = 60, ['9'] = 61, ['+'] = 62, ['/'] = 63,
+};
+
+static int base64_value(uint8_t c) {
+    int v = BASE64_VALUES[c];
+    // Zero-initialized slots are "invalid" except for 'A'
+    return (v == 0 && c != 'A') ? -1 : v;
+}
+
+static int hex_value(uint8_t c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+static int is_encoding_space(uint8_t c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+// Unreserved URL characters (RFC 3986): A-Z a-z 0-9 - _ . ~
+static int is_url_safe(uint8_t c) {
+    uint8_t lower = c | 0x20;
+    return (lower >= 'a' && lower <= 'z') || (c >= '0' && c <= '9') ||
+           c == '-' || c == '_' || c == '.' || c == '~';
+}
+
+// ========== SIMD KERNELS ==========
+
+#ifdef ENC_X86_SIMD
+
+static int encoding_simd_level(void) {
+    static int level = -1;
+    if (level < 0) {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) level = ENC_SIMD_AVX2;
+        else if (__builtin_cpu_supports("ssse3")) level = ENC_SIMD_SSSE3;
+        else level = ENC_SIMD_NONE;
+    }
+    return level;
+}
+
+// Map 6-bit indices to base64 characters (one pshufb over offset classes)
+__attribute__((target("ssse3")))
+static __m128i base64_lookup_ssse3(__m128i indices) {
+    const __m128i shift_lut = _mm_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+        '/' - 63, 'A', 0, 0);
+    __m128i reduced = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    reduced = _mm_or_si128(reduced, _mm_and_si128(less, _mm_set1_epi8(13)));
+    return _mm_add_epi8(_mm_shuffle_epi8(shift_lut, reduced), indices);
+}
+
+// Split 12 input bytes (in the low 12 lanes) into sixteen 6-bit indices
+__attribute__((target("ssse3")))
+static __m128i base64_split_ssse3(__m128i in) {
+    in = _mm_shuffle_epi8(in, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+    __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    return _mm_or_si128(t1, t3);
+}
+
+__attribute__((target("ssse3")))
+static size_t base64_encode_ssse3(const uint8_t *src, size_t len, char *dst, size_t *consumed) {
+    size_t i = 0, o = 0;
+    // Each step reads 16 bytes but consumes 12
+    while (len - i >= 16) {
+        __m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_si128((__m128i *)(dst + o), base64_lookup_ssse3(base64_split_ssse3(in)));
+        i += 12;
+        o += 16;
+    }
+    *consumed = i;
+    return o;
+}
+
+__attribute__((target("avx2")))
+static __m256i base64_lookup_avx2(__m256i indices) {
+    const __m256i shift_lut = _mm256_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+        '/' - 63, 'A', 0, 0,
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+        '/' - 63, 'A', 0, 0);
+    __m256i reduced = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+    reduced = _mm256_or_si256(reduced, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+    return _mm256_add_epi8(_mm256_shuffle_epi8(shift_lut, reduced), indices);
+}
+
+__attribute__((target("avx2")))
+static size_t base64_encode_avx2(const uint8_t *src, size_t len, char *dst, size_t *consumed) {
+    const __m256i shuf = _mm256_setr_epi8(
+        1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+        1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    size_t i = 0, o = 0;
+    // Each step reads 28 bytes (two overlapping 16-byte loads) and consumes 24
+    while (len - i >= 28) {
+        __m256i in = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(src + i))),
+            _mm_loadu_si128((const __m128i *)(src + i + 12)), 1);
+        in = _mm256_shuffle_epi8(in, shuf);
+        __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+        __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+        __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        __m256i indices = _mm256_or_si256(t1, t3);
+        _mm256_storeu_si256((__m256i *)(dst + o), base64_lookup_avx2(indices));
+        i += 24;
+        o += 32;
+    }
+    *consumed = i;
+    return o;
+}
+
+// Decode whole 16-character blocks until one holds a character outside the
+// alphabet (padding, whitespace or garbage); the scalar loop takes it from there.
+// Writes 16 bytes per step, of which 12 are output.
+__attribute__((target("ssse3")))
+static size_t base64_decode_ssse3(const uint8_t *src, size_t len, uint8_t *dst, size_t *consumed) {
+    const __m128i lut_lo = _mm_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i lut_hi = _mm_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lut_roll = _mm_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+    size_t i = 0, o = 0;
+    while (len - i >= 16) {
+        __m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(in, 4), nibble);
+        __m128i lo_nibbles = _mm_and_si128(in, nibble);
+        __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+        __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+        __m128i bad = _mm_cmpeq_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128());
+        if (_mm_movemask_epi8(bad) != 0xFFFF) break;
+
+        __m128i eq_slash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+        __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_slash, hi_nibbles));
+        __m128i values = _mm_add_epi8(in, roll);
+
+        __m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        __m128i out = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        _mm_storeu_si128((__m128i *)(dst + o), _mm_shuffle_epi8(out, pack));
+        i += 16;
+        o += 12;
+    }
+    *consumed = i;
+    return o;
+}
+
+__attribute__((target("ssse3")))
+static size_t hex_encode_ssse3(const uint8_t *src, size_t len, char *dst, size_t *consumed) {
+    const __m128i lut = _mm_loadu_si128((const __m128i *)HEX_CHARS);
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    size_t i = 0;
+    while (len - i >= 16) {
+        __m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(in, 4), nibble));
+        __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(in, nibble));
+        _mm_storeu_si128((__m128i *)(dst + 2 * i), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i *)(dst + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+        i += 16;
+    }
+    *consumed = i;
+    return 2 * i;
+}
+
+__attribute__((target("avx2")))
+static size_t hex_encode_avx2(const uint8_t *src, size_t len, char *dst, size_t *consumed) {
+    const __m256i lut = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)HEX_CHARS));
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    size_t i = 0;
+    while (len - i >= 32) {
+        __m256i in = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(in, 4), nibble));
+        __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(in, nibble));
+        // unpack works per 128-bit lane; reorder lanes back into byte order
+        __m256i a = _mm256_unpacklo_epi8(hi, lo);
+        __m256i b = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256((__m256i *)(dst + 2 * i), _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256((__m256i *)(dst + 2 * i + 32), _mm256_permute2x128_si256(a, b, 0x31));
+        i += 32;
+    }
+    *consumed = i;
+    return 2 * i;
+}
+
+// Convert 16 hex characters to nibble values; *ok is cleared on any invalid character
+__attribute__((target("ssse3")))
+static __m128i hex_nibbles_ssse3(__m128i in, int *ok) {
+    __m128i digit = _mm_sub_epi8(in, _mm_set1_epi8('0'));
+    __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    __m128i alpha = _mm_sub_epi8(_mm_or_si128(in, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i is_alpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+    if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha)) != 0xFFFF) *ok = 0;
+    return _mm_or_si128(_mm_and_si128(is_digit, digit),
+                        _mm_and_si128(is_alpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+}
+
+__attribute__((target("ssse3")))
+static size_t hex_decode_ssse3(const uint8_t *src, size_t len, uint8_t *dst, size_t *consumed) {
+    // Multiply-add pairs: high nibble * 16 + low nibble
+    const __m128i weights = _mm_set1_epi16(0x0110);
+    size_t i = 0, o = 0;
+    while (len - i >= 32) {
+        int ok = 1;
+        __m128i a = hex_nibbles_ssse3(_mm_loadu_si128((const __m128i *)(src + i)), &ok);
+        __m128i b = hex_nibbles_ssse3(_mm_loadu_si128((const __m128i *)(src + i + 16)), &ok);
+        if (!ok) break;
+        __m128i out = _mm_packus_epi16(_mm_maddubs_epi16(a, weights), _mm_maddubs_epi16(b, weights));
+        _mm_storeu_si128((__m128i *)(dst + o), out);
+        i += 32;
+        o += 16;
+    }
+    *consumed = i;
+    return o;
+}
+
+__attribute__((target("avx2")))
+static __m256i hex_nibbles_avx2(__m256i in, int *ok) {
+    __m256i digit = _mm256_sub_epi8(in, _mm256_set1_epi8('0'));
+    __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    __m256i alpha = _mm256_sub_epi8(_mm256_or_si256(in, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    __m256i is_alpha = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+    if ((uint32_t)_mm256_movemask_epi8(_mm256_or_si256(is_digit, is_alpha)) != 0xFFFFFFFFu) *ok = 0;
+    return _mm256_or_si256(_mm256_and_si256(is_digit, digit),
+                           _mm256_and_si256(is_alpha, _mm256_add_epi8(alpha, _mm256_set1_epi8(10))));
+}
+
+__attribute__((target("avx2")))
+static size_t hex_decode_avx2(const uint8_t *src, size_t len, uint8_t *dst, size_t *consumed) {
+    const __m256i weights = _mm256_set1_epi16(0x0110);
+    size_t i = 0, o = 0;
+    while (len - i >= 64) {
+        int ok = 1;
+        __m256i a = hex_nibbles_avx2(_mm256_loadu_si256((const __m256i *)(src + i)), &ok);
+        __m256i b = hex_nibbles_avx2(_mm256_loadu_si256((const __m256i *)(src + i + 32)), &ok);
+        if (!ok) break;
+        __m256i out = _mm256_packus_epi16(_mm256_maddubs_epi16(a, weights), _mm256_maddubs_epi16(b, weights));
+        // packus interleaves lanes (a0 b0 a1 b1); restore a0 a1 b0 b1
+        _mm256_storeu_si256((__m256i *)(dst + o), _mm256_permute4x64_epi64(out, 0xD8));
+        i += 64;
+        o += 32;
+    }
+    *consumed = i;
+    return o;
+}
+
+// Bitmask of the bytes in a 16-byte block that are not unreserved URL characters
+static unsigned url_unsafe_mask_sse2(const uint8_t *src) {
+    __m128i in = _mm_loadu_si128((const __m128i *)src);
+    __m128i alpha = _mm_sub_epi8(_mm_or_si128(in, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i digit = _mm_sub_epi8(in, _mm_set1_epi8('0'));
+    __m128i safe = _mm_or_si128(
+        _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(25)), alpha),
+        _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit));
+    safe = _mm_or_si128(safe, _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8('-')), _mm_cmpeq_epi8(in, _mm_set1_epi8('_'))),
+        _mm_or_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8('.')), _mm_cmpeq_epi8(in, _mm_set1_epi8('~')))));
+    return (unsigned)_mm_movemask_epi8(safe) ^ 0xFFFF;
+}
+
+// Bitmask of the '%' and '+' bytes in a 16-byte block
+static unsigned url_special_mask_sse2(const uint8_t *src) {
+    __m128i in = _mm_loadu_si128((const __m128i *)src);
+    __m128i special = _mm_or_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8('%')),
+                                   _mm_cmpeq_epi8(in, _mm_set1_epi8('+')));
+    return (unsigned)_mm_movemask_epi8(special);
+}
+
+#else
+
+static int encoding_simd_level(void) {
+    return ENC_SIMD_NONE;
+}
+
+#endif /* ENC_X86_SIMD */
+
+// ========== CODECS ==========
+
+long base64_encode_bytes(const uint8_t *src, size_t len, char *dst) {
+    size_t i = 0, o = 0;
+#ifdef ENC_X86_SIMD
+    int level = encoding_simd_level();
+    size_t used = 0;
+    if (level >= ENC_SIMD_AVX2) {
+        o += base64_encode_avx2(src, len, dst, &used);
+        i += used;
+    }
+    if (level >= ENC_SIMD_SSSE3) {
+        o += base64_encode_ssse3(src + i, len - i, dst + o, &used);
+        i += used;
+    }
+#endif
+    for (; len - i >= 3; i += 3) {
+        uint32_t v = ((uint32_t)src[i] << 16) | ((uint32_t)src[i + 1] << 8) | src[i + 2];
+        dst[o++] = BASE64_CHARS[(v >> 18) & 63];
+        dst[o++] = BASE64_CHARS[(v >> 12) & 63];
+        dst[o++] = BASE64_CHARS[(v >> 6) & 63];
+        dst[o++] = BASE64_CHARS[v & 63];
+    }
+    if (len - i == 1) {
+        uint32_t v = (uint32_t)src[i] << 16;
+        dst[o++] = BASE64_CHARS[(v >> 18) & 63];
+        dst[o++] = BASE64_CHARS[(v >> 12) & 63];
+        dst[o++] = '=';
+        dst[o++] = '=';
+    } else if (len - i == 2) {
+        uint32_t v = ((uint32_t)src[i] << 16) | ((uint32_t)src[i + 1] << 8);
+        dst[o++] = BASE64_CHARS[(v >> 18) & 63];
+        dst[o++] = BASE64_CHARS[(v >> 12) & 63];
+        dst[o++] = BASE64_CHARS[(v >> 6) & 63];
+        dst[o++] = '=';
+    }
+    return (long)o;
+}
+
+// Whitespace is skipped; dst needs len / 4 * 3 + 16 bytes
+long base64_decode_bytes(const uint8_t *src, size_t len, uint8_t *dst, const char **err) {
+#ifdef ENC_X86_SIMD
+    int level = encoding_simd_level();
+#endif
+    size_t i = 0, o = 0;
+    uint32_t quad = 0;
+    int q = 0;
+
+    while (i < len) {
+#ifdef ENC_X86_SIMD
+        if (q == 0 && level >= ENC_SIMD_SSSE3 && len - i >= 16) {
+            size_t used = 0;
+            o += base64_decode_ssse3(src + i, len - i, dst + o, &used);
+            i += used;
+            if (i >= len) break;
+        }
+#endif
+        uint8_t c = src[i++];
+        if (is_encoding_space(c)) continue;
+
+        if (c == '=') {
+            if (q < 2) {
+                *err = "Invalid Base64 string: unexpected padding";
+                return -1;
+            }
+            // "xx==" or "xxx=": the quad must be completed by padding
+            int pads = 1;
+            while (i < len) {
+                c = src[i++];
+                if (is_encoding_space(c)) continue;
+                if (c == '=' && q + pads < 4) {
+                    pads++;
+                    continue;
+                }
+                *err = base64_value(c) < 0 && c != '='
+                    ? "Invalid Base64 string: invalid character"
+                    : "Invalid Base64 string: unexpected padding";
+                return -1;
+            }
+            if (q + pads != 4) {
+                *err = "Invalid Base64 string: length must be multiple of 4";
+                return -1;
+            }
+            quad <<= 6 * (4 - q);
+            dst[o++] = (uint8_t)(quad >> 16);
+            if (q == 3) dst[o++] = (uint8_t)(quad >> 8);
+            return (long)o;
+        }
+
+        int v = base64_value(c);
+        if (v < 0) {
+            *err = "Invalid Base64 string: invalid character";
+            return -1;
+        }
+        quad = (quad << 6) | (uint32_t)v;
+        if (++q == 4) {
+            dst[o++] = (uint8_t)(quad >> 16);
+            dst[o++] = (uint8_t)(quad >> 8);
+            dst[o++] = (uint8_t)quad;
+            quad = 0;
+            q = 0;
+        }
+    }
+
+    if (q != 0) {
+        *err = "Invalid Base64 string: length must be multiple of 4";
+        return -1;
+    }
+    return (long)o;
+}
+
+long hex_encode_bytes(const uint8_t *src, size_t len, char *dst) {
+    size_t i = 0, o = 0;
+#ifdef ENC_X86_SIMD
+    int level = encoding_simd_level();
+    size_t used = 0;
+    if (level >= ENC_SIMD_AVX2) {
+        o += hex_encode_avx2(src, len, dst, &used);
+        i += used;
+    }
+    if (level >= ENC_SIMD_SSSE3) {
+        o += hex_encode_ssse3(src + i, len - i, dst + o, &used);
+        i += used;
+    }
+#endif
+    for (; i < len; i++) {
+        dst[o++] = HEX_CHARS[src[i] >> 4];
+        dst[o++] = HEX_CHARS[src[i] & 15];
+    }
+    return (long)o;
+}
+
+// Case-insensitive, whitespace is skipped; dst needs len / 2 + 32 bytes
+long hex_decode_bytes(const uint8_t *src, size_t len, uint8_t *dst, const char **err) {
+#ifdef ENC_X86_SIMD
+    int level = encoding_simd_level();
+#endif
+    size_t i = 0, o = 0;
+    int high = -1;
+
+    while (i < len) {
+#ifdef ENC_X86_SIMD
+        if (high < 0 && level >= ENC_SIMD_SSSE3 && len - i >= 32) {
+            size_t used = 0;
+            if (level >= ENC_SIMD_AVX2) {
+                o += hex_decode_avx2(src + i, len - i, dst + o, &used);
+                i += used;
+            }
+            o += hex_decode_ssse3(src + i, len - i, dst + o, &used);
+            i += used;
+            if (i >= len) break;
+        }
+#endif
+        uint8_t c = src[i++];
+        if (is_encoding_space(c)) continue;
+        int v = hex_value(c);
+        if (v < 0) {
+            *err = "Invalid hex string: invalid character";
+            return -1;
+        }
+        if (high < 0) {
+            high = v;
+        } else {
+            dst[o++] = (uint8_t)((high << 4) | v);
+            high = -1;
+        }
+    }
+
+    if (high >= 0) {
+        *err = "Invalid hex string: length must be even";
+        return -1;
+    }
+    return (long)o;
+}
+
+// Unreserved characters pass through, space becomes '+', the rest %xx;
+// dst needs 3 * len bytes
+long url_encode_bytes(const uint8_t *src, size_t len, char *dst) {
+    size_t i = 0, o = 0;
+    while (i < len) {
+#ifdef ENC_X86_SIMD
+        // Copy whole blocks of plain characters at once
+        if (len - i >= 16 && url_unsafe_mask_sse2(src + i) == 0) {
+            memcpy(dst + o, src + i, 16);
+            i += 16;
+            o += 16;
+            continue;
+        }
+#endif
+        size_t end = len - i > 16 ? i + 16 : len;
+        for (; i < end; i++) {
+            uint8_t c = src[i];
+            if (is_url_safe(c)) {
+                dst[o++] = (char)c;
+            } else if (c == ' ') {
+                dst[o++] = '+';
+            } else {
+                dst[o++] = '%';
+                dst[o++] = HEX_CHARS[c >> 4];
+                dst[o++] = HEX_CHARS[c & 15];
+            }
+        }
+    }
+    return (long)o;
+}
+
+// '+' decodes to space and %XX to its byte; dst needs len bytes
+long url_decode_bytes(const uint8_t *src, size_t len, uint8_t *dst, const char **err) {
+    size_t i = 0, o = 0;
+    while (i < len) {
+#ifdef ENC_X86_SIMD
+        if (len - i >= 16 && url_special_mask_sse2(src + i) == 0) {
+            memcpy(dst + o, src + i, 16);
+            i += 16;
+            o += 16;
+            continue;
+        }
+#endif
+        // A percent sequence may run past the block end; that is fine
+        size_t end = len - i > 16 ? i + 16 : len;
+        while (i < end) {
+            uint8_t c = src[i];
+            if (c == '+') {
+                dst[o++] = ' ';
+                i++;
+            } else if (c != '%') {
+                dst[o++] = c;
+                i++;
+            } else {
+                if (len - i < 3) {
+                    *err = "Invalid URL encoding: incomplete percent sequence";
+                    return -1;
+                }
+                int h1 = hex_value(src[i + 1]);
+                int h2 = hex_value(src[i + 2]);
+                if (h1 < 0 || h2 < 0) {
+                    *err = "Invalid URL encoding: invalid hex digits in percent sequence";
+                    return -1;
+                }
+                dst[o++] = (uint8_t)((h1 << 4) | h2);
+                i += 3;
+            }
+        }
+    }
+    return (long)o;
+}
+
+// ========== OUTPUT SIZES ==========
+
+size_t base64_encoded_size(size_t len) { return (len + 2) / 3 * 4; }
+size_t base64_decoded_size(size_t len) { return len / 4 * 3 + 16; }
+size_t hex_encoded_size(size_t len) { return len * 2; }
+size_t hex_decoded_size(size_t len) { return len / 2 + 32; }
+size_t url_encoded_size(size_t len) { return len * 3; }
+size_t url_decoded_size(size_t len) { return len; }
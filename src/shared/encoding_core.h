@@ -0,0 +1,38 @@
+/*
+ * Hemlock Encoding Core
+ *
+ * Base64, hex and URL codecs on plain bytes for the encoding builtins,
+ * shared by the interpreter and the runtime library.
+ */
+
+#ifndef HEMLOCK_ENCODING_CORE_H
+#define HEMLOCK_ENCODING_CORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Each codec writes into dst, sized by the caller from the matching
+ * *_size function, and returns the output length. Decoders return -1 with
+ * *err set to a static message for malformed input; base64 and hex
+ * decoding skip ASCII whitespace.
+ */
+typedef long (*EncodeFn)(const uint8_t *src, size_t len, char *dst);
+typedef long (*DecodeFn)(const uint8_t *src, size_t len, uint8_t *dst, const char **err);
+
+long base64_encode_bytes(const uint8_t *src, size_t len, char *dst);
+long base64_decode_bytes(const uint8_t *src, size_t len, uint8_t *dst, const char **err);
+long hex_encode_bytes(const uint8_t *src, size_t len, char *dst);
+long hex_decode_bytes(const uint8_t *src, size_t len, uint8_t *dst, const char **err);
+long url_encode_bytes(const uint8_t *src, size_t len, char *dst);
+long url_decode_bytes(const uint8_t *src, size_t len, uint8_t *dst, const char **err);
+
+// Upper bounds on the output of each codec for len input bytes
+size_t base64_encoded_size(size_t len);
+size_t base64_decoded_size(size_t len);
+size_t hex_encoded_size(size_t len);
+size_t hex_decoded_size(size_t len);
+size_t url_encoded_size(size_t len);
+size_t url_decoded_size(size_t len);
+
+#endif // HEMLOCK_ENCODING_CORE_H
@@ -0,0 +1,300 @@
+/*
+ * Hemlock Hash Core
+ *
+ * The value-independent half of @stdlib/hash, compiled into both the
+ * interpreter and the runtime library. A hasher holds the running state of
+ * one digest; feeding bytes never buffers more than a 3-byte murmur3 tail,
+ * so hashing a stream of any size uses constant memory. Finishing works on
+ * a copy of the state, which lets callers keep feeding after reading an
+ * intermediate digest.
+ */
+
+#define _GNU_SOURCE
+#include "hash_core.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef HML_HAVE_OPENSSL
+#include <openssl/evp.h>
+#endif
+
+#ifdef HML_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#define HASHER_FILE_CHUNK (1024 * 1024)
+
+// ========== ALGORITHMS ==========
+
+#ifdef HML_HAVE_OPENSSL
+static const EVP_MD* hasher_evp(HasherAlgo algo) {
+    switch (algo) {
+        case HASHER_SHA256: return EVP_sha256();
+        case HASHER_SHA512: return EVP_sha512();
+        case HASHER_SHA1: return EVP_sha1();
+        case HASHER_MD5: return EVP_md5();
+        default: return NULL;
+    }
+}
+#endif
+
+int hasher_algo(const char *name) {
+    if (strcmp(name, "sha256") == 0) return HASHER_SHA256;
+    if (strcmp(name, "sha512") == 0) return HASHER_SHA512;
+    if (strcmp(name, "sha1") == 0) return HASHER_SHA1;
+    if (strcmp(name, "md5") == 0) return HASHER_MD5;
+    if (strcmp(name, "murmur3") == 0) return HASHER_MURMUR3;
+    if (strcmp(name, "fnv1a") == 0) return HASHER_FNV1A;
+    if (strcmp(name, "djb2") == 0) return HASHER_DJB2;
+    if (strcmp(name, "crc32") == 0) return HASHER_CRC32;
+    return -1;
+}
+
+static const char* hasher_name(HasherAlgo algo) {
+    switch (algo) {
+        case HASHER_SHA256: return "sha256";
+        case HASHER_SHA512: return "sha512";
+        case HASHER_SHA1: return "sha1";
+        case HASHER_MD5: return "md5";
+        case HASHER_MURMUR3: return "murmur3";
+        case HASHER_FNV1A: return "fnv1a";
+        case HASHER_DJB2: return "djb2";
+        default: return "crc32";
+    }
+}
+
+static void hasher_init_state(Hasher *hs) {
+    switch (hs->algo) {
+        case HASHER_MURMUR3: hs->h = hs->seed; break;
+        case HASHER_FNV1A: hs->h = 2166136261u; break;
+        case HASHER_DJB2: hs->h = 5381; break;
+        default: hs->h = 0; break;   // crc32 starts at 0
+    }
+    hs->tail_len = 0;
+    hs->total = 0;
+}
+
+// ========== MURMUR3 ==========
+
+static inline uint32_t rotl32(uint32_t x, int r) {
+    return (x << r) | (x >> (32 - r));
+}
+
+static inline uint32_t murmur3_mix_k(uint32_t k) {
+    k *= 0xcc9e2d51u;
+    k = rotl32(k, 15);
+    return k * 0x1b873593u;
+}
+
+static void murmur3_update(Hasher *hs, const uint8_t *p, size_t len) {
+    uint32_t h = hs->h;
+    hs->total += len;
+
+    // Complete a block left over from the previous update
+    while (hs->tail_len > 0 && len > 0) {
+        hs->tail[hs->tail_len++] = *p++;
+        len--;
+        if (hs->tail_len == 4) {
+            uint32_t k = (uint32_t)hs->tail[0] | ((uint32_t)hs->tail[1] << 8) |
+                         ((uint32_t)hs->tail[2] << 16) | ((uint32_t)hs->tail[3] << 24);
+            h ^= murmur3_mix_k(k);
+            h = rotl32(h, 13) * 5 + 0xe6546b64u;
+            hs->tail_len = 0;
+        }
+    }
+
+    while (len >= 4) {
+        uint32_t k = (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+                     ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+        h ^= murmur3_mix_k(k);
+        h = rotl32(h, 13) * 5 + 0xe6546b64u;
+        p += 4;
+        len -= 4;
+    }
+
+    while (len > 0) {
+        hs->tail[hs->tail_len++] = *p++;
+        len--;
+    }
+    hs->h = h;
+}
+
+static uint32_t murmur3_final(const Hasher *hs) {
+    uint32_t h = hs->h;
+    uint32_t k = 0;
+    switch (hs->tail_len) {
+        case 3: k ^= (uint32_t)hs->tail[2] << 16; // fallthrough
+        case 2: k ^= (uint32_t)hs->tail[1] << 8;  // fallthrough
+        case 1: k ^= hs->tail[0];
+                h ^= murmur3_mix_k(k);
+    }
+    h ^= (uint32_t)hs->total;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+// ========== HASHERS ==========
+
+Hasher* hasher_new(HasherAlgo algo, uint32_t seed, char *err) {
+#ifndef HML_HAVE_ZLIB
+    if (algo == HASHER_CRC32) {
+        snprintf(err, HASHER_ERR_LEN, "crc32 hasher not available - zlib not installed");
+        return NULL;
+    }
+#endif
+#ifndef HML_HAVE_OPENSSL
+    if (algo <= HASHER_MD5) {
+        snprintf(err, HASHER_ERR_LEN, "%s hasher not available - OpenSSL not installed",
+                 hasher_name(algo));
+        return NULL;
+    }
+#endif
+
+    Hasher *hs = calloc(1, sizeof(Hasher));
+    if (!hs) {
+        snprintf(err, HASHER_ERR_LEN, "memory allocation failed");
+        return NULL;
+    }
+    hs->algo = algo;
+    hs->seed = seed;
+
+#ifdef HML_HAVE_OPENSSL
+    const EVP_MD *md = hasher_evp(algo);
+    if (md) {
+        hs->md = EVP_MD_CTX_new();
+        if (!hs->md || !EVP_DigestInit_ex(hs->md, md, NULL)) {
+            EVP_MD_CTX_free(hs->md);
+            free(hs);
+            snprintf(err, HASHER_ERR_LEN, "failed to initialize %s digest", hasher_name(algo));
+            return NULL;
+        }
+    }
+#endif
+    hasher_init_state(hs);
+    return hs;
+}
+
+void hasher_feed(Hasher *hs, const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+    switch (hs->algo) {
+        case HASHER_MURMUR3:
+            murmur3_update(hs, p, len);
+            break;
+        case HASHER_FNV1A: {
+            uint32_t h = hs->h;
+            for (size_t i = 0; i < len; i++) {
+                h = (h ^ p[i]) * 16777619u;
+            }
+            hs->h = h;
+            break;
+        }
+        case HASHER_DJB2: {
+            uint32_t h = hs->h;
+            for (size_t i = 0; i < len; i++) {
+                h = (h << 5) + h + p[i];
+            }
+            hs->h = h;
+            break;
+        }
+        case HASHER_CRC32:
+#ifdef HML_HAVE_ZLIB
+            // zlib takes uInt lengths; feed oversized inputs in pieces
+            while (len > 0) {
+                uInt n = len > 0x40000000u ? 0x40000000u : (uInt)len;
+                hs->h = (uint32_t)crc32(hs->h, p, n);
+                p += n;
+                len -= n;
+            }
+#endif
+            break;
+        default:
+#ifdef HML_HAVE_OPENSSL
+            EVP_DigestUpdate(hs->md, p, len);
+#endif
+            break;
+    }
+}
+
+int64_t hasher_feed_file(Hasher *hs, const char *path, char *err) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        snprintf(err, HASHER_ERR_LEN, "Failed to open '%s': %s", path, strerror(errno));
+        return -1;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    char *chunk = malloc(HASHER_FILE_CHUNK);
+    if (!chunk) {
+        close(fd);
+        snprintf(err, HASHER_ERR_LEN, "Out of memory reading '%s'", path);
+        return -1;
+    }
+
+    int64_t total = 0;
+    for (;;) {
+        ssize_t n = read(fd, chunk, HASHER_FILE_CHUNK);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            snprintf(err, HASHER_ERR_LEN, "Failed to read '%s': %s", path, strerror(errno));
+            total = -1;
+            break;
+        }
+        if (n == 0) break;
+        hasher_feed(hs, chunk, (size_t)n);
+        total += n;
+    }
+    free(chunk);
+    close(fd);
+    return total;
+}
+
+uint32_t hasher_value32(const Hasher *hs) {
+    return hs->algo == HASHER_MURMUR3 ? murmur3_final(hs) : hs->h;
+}
+
+int hasher_finish(Hasher *hs, unsigned char *out) {
+    if (hs->md == NULL) {
+        // 32-bit hashes digest to their big-endian bytes
+        uint32_t v = hasher_value32(hs);
+        out[0] = (unsigned char)(v >> 24);
+        out[1] = (unsigned char)(v >> 16);
+        out[2] = (unsigned char)(v >> 8);
+        out[3] = (unsigned char)v;
+        return 4;
+    }
+#ifdef HML_HAVE_OPENSSL
+    EVP_MD_CTX *copy = EVP_MD_CTX_new();
+    unsigned int len = 0;
+    int ok = copy && EVP_MD_CTX_copy_ex(copy, hs->md) && EVP_DigestFinal_ex(copy, out, &len);
+    EVP_MD_CTX_free(copy);
+    if (ok) return (int)len;
+#endif
+    return -1;
+}
+
+void hasher_reset(Hasher *hs) {
+#ifdef HML_HAVE_OPENSSL
+    if (hs->md != NULL) {
+        EVP_DigestInit_ex(hs->md, hasher_evp(hs->algo), NULL);
+    }
+#endif
+    hasher_init_state(hs);
+}
+
+void hasher_close(Hasher *hs) {
+#ifdef HML_HAVE_OPENSSL
+    EVP_MD_CTX_free(hs->md);
+#endif
+    hs->md = NULL;
+    hs->closed = 1;
+}
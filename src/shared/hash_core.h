@@ -0,0 +1,69 @@
+/*
+ * Hemlock Hash Core
+ *
+ * Incremental hashers for @stdlib/hash, shared by the interpreter and the
+ * runtime library. SHA-256/512, SHA-1 and MD5 go through OpenSSL's EVP
+ * interface, crc32 through zlib; murmur3, fnv1a and djb2 are computed here.
+ */
+
+#ifndef HEMLOCK_HASH_CORE_H
+#define HEMLOCK_HASH_CORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HASHER_ERR_LEN      320
+#define HASHER_MAX_DIGEST   64      // EVP_MAX_MD_SIZE
+
+typedef enum {
+    HASHER_SHA256,
+    HASHER_SHA512,
+    HASHER_SHA1,
+    HASHER_MD5,
+    HASHER_MURMUR3,
+    HASHER_FNV1A,
+    HASHER_DJB2,
+    HASHER_CRC32
+} HasherAlgo;
+
+typedef struct {
+    HasherAlgo algo;
+    struct evp_md_ctx_st *md;   // Cryptographic digests
+    uint32_t h;                 // Running state of the 32-bit hashes
+    uint32_t seed;              // murmur3 seed, restored by reset()
+    uint8_t tail[4];            // murmur3: bytes not yet forming a full block
+    int tail_len;
+    uint64_t total;             // murmur3: total input length
+    int closed;
+} Hasher;
+
+// Map an algorithm name to its id. Returns -1 for unknown names.
+int hasher_algo(const char *name);
+
+/*
+ * Start a hasher; seed is only used by murmur3. Returns NULL with err
+ * (HASHER_ERR_LEN bytes) filled in when the algorithm's library is not
+ * built in or fails to initialize. A closed hasher stays allocated so
+ * stale handles can be detected.
+ */
+Hasher* hasher_new(HasherAlgo algo, uint32_t seed, char *err);
+
+void hasher_feed(Hasher *hs, const void *data, size_t len);
+
+// Stream a whole file through the hasher in 1 MB chunks. Returns the
+// number of bytes read, or -1 with err filled in.
+int64_t hasher_feed_file(Hasher *hs, const char *path, char *err);
+
+// Value of a 32-bit hash as it stands after the bytes fed so far
+uint32_t hasher_value32(const Hasher *hs);
+
+// Finalize into out (HASHER_MAX_DIGEST bytes). Returns the digest length,
+// or -1 on failure. The hasher state is left untouched.
+int hasher_finish(Hasher *hs, unsigned char *out);
+
+void hasher_reset(Hasher *hs);
+
+// Release the digest state and mark the hasher closed
+void hasher_close(Hasher *hs);
+
+#endif // HEMLOCK_HASH_CORE_H
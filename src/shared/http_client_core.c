@@ -0,0 +1,1097 @@
+/*
+ * Hemlock HTTP/1.1 Client Core
+ *
+ * The value-independent half of the @stdlib/http client, compiled into both
+ * the interpreter and the runtime library. A client keeps a pool of idle
+ * keep-alive connections keyed by scheme://host:port plus one TLS context,
+ * so repeated requests to a host skip the TCP and TLS handshakes. A request
+ * returns once the headers are in; the body is then streamed and the
+ * connection is pooled again when the body ends. The pool is mutex-guarded
+ * and a connection belongs to one response at a time, so a client can be
+ * shared between tasks.
+ */
+
+#define _GNU_SOURCE
+#include "http_client_core.h"
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef HML_HAVE_OPENSSL_SSL
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#else
+typedef struct ssl_st SSL;
+typedef struct ssl_ctx_st SSL_CTX;
+#endif
+
+#define HTTP_READ_CHUNK      16384
+#define HTTP_MAX_HEAD        (64 * 1024)
+#define HTTP_IDLE_TIMEOUT    60      // Seconds an idle connection is kept
+#define HTTP_INLINE_BODY     (64 * 1024)  // Bodies up to this size share the head's write
+
+typedef struct HttpConn {
+    int fd;
+    SSL *ssl;
+    char *key;                  // "scheme://host:port" pool key
+    char *buf;                  // Received bytes not yet consumed
+    size_t start, end, cap;
+    time_t idle_since;
+    struct HttpConn *next;
+} HttpConn;
+
+struct HttpClient {
+    pthread_mutex_t lock;
+    HttpConn *idle;             // Idle connections, most recently used first
+    SSL_CTX *ssl_ctx;
+    int timeout_ms;
+    int max_idle_per_host;
+    int verify_tls;
+    int refs;                   // The handle plus one per open response
+    int closed;
+    long opened;                // Connections dialed
+    long reused;                // Requests served from the pool
+};
+
+typedef enum {
+    HTTP_BODY_NONE,
+    HTTP_BODY_LENGTH,
+    HTTP_BODY_CHUNKED,
+    HTTP_BODY_CLOSE
+} HttpBodyMode;
+
+struct HttpResponse {
+    HttpClient *client;
+    HttpConn *conn;             // NULL once released (drops the client ref)
+    int status;
+    char **names;               // Lowercased header names (duplicates merged)
+    char **values;
+    int num_headers;
+    HttpBodyMode mode;
+    uint64_t remaining;         // Bytes left in the body or current chunk
+    int in_chunk;               // Chunked: inside chunk data
+    int keep_alive;
+    int done;
+    int closed;
+};
+
+typedef struct {
+    int https;
+    char host[256];
+    int port;
+    const char *path;           // Points into the URL
+    size_t path_len;
+} HttpUrl;
+
+// ========== CLIENT LIFETIME ==========
+
+static void conn_close(HttpConn *conn) {
+#ifdef HML_HAVE_OPENSSL_SSL
+    if (conn->ssl) {
+        SSL_shutdown(conn->ssl);
+        SSL_free(conn->ssl);
+    }
+#endif
+    if (conn->fd >= 0) {
+        close(conn->fd);
+    }
+    free(conn->key);
+    free(conn->buf);
+    free(conn);
+}
+
+static void client_ref(HttpClient *client) {
+    pthread_mutex_lock(&client->lock);
+    client->refs++;
+    pthread_mutex_unlock(&client->lock);
+}
+
+// Drop one reference; the last one releases the TLS context. The struct
+// itself stays allocated (marked closed) so stale handles are detected.
+static void client_unref(HttpClient *client) {
+    pthread_mutex_lock(&client->lock);
+    int refs = --client->refs;
+    SSL_CTX *sctx = refs == 0 ? client->ssl_ctx : NULL;
+    if (refs == 0) {
+        client->ssl_ctx = NULL;
+    }
+    pthread_mutex_unlock(&client->lock);
+#ifdef HML_HAVE_OPENSSL_SSL
+    if (sctx) {
+        SSL_CTX_free(sctx);
+    }
+#else
+    (void)sctx;
+#endif
+}
+
+// ========== CONNECTION POOL ==========
+
+// Take an idle connection for key, discarding any that expired or that the
+// server has closed (an idle connection must not be readable).
+static HttpConn* pool_take(HttpClient *client, const char *key) {
+    time_t now = time(NULL);
+    HttpConn *found = NULL;
+    HttpConn *dead = NULL;
+
+    pthread_mutex_lock(&client->lock);
+    HttpConn **link = &client->idle;
+    while (*link) {
+        HttpConn *c = *link;
+        if (now - c->idle_since > HTTP_IDLE_TIMEOUT) {
+            *link = c->next;
+            c->next = dead;
+            dead = c;
+            continue;
+        }
+        if (!found && strcmp(c->key, key) == 0) {
+            *link = c->next;
+            struct pollfd pfd = { .fd = c->fd, .events = POLLIN };
+            if (c->start == c->end && poll(&pfd, 1, 0) == 0) {
+                found = c;
+                client->reused++;
+            } else {
+                c->next = dead;
+                dead = c;
+            }
+            continue;
+        }
+        link = &c->next;
+    }
+    pthread_mutex_unlock(&client->lock);
+
+    while (dead) {
+        HttpConn *c = dead;
+        dead = c->next;
+        conn_close(c);
+    }
+    if (found) {
+        found->next = NULL;
+    }
+    return found;
+}
+
+// Return a connection to the pool, closing it if the host already has
+// max_idle_per_host idle connections or the client has been freed.
+static void pool_put(HttpClient *client, HttpConn *conn) {
+    pthread_mutex_lock(&client->lock);
+    int count = 0;
+    for (HttpConn *c = client->idle; c; c = c->next) {
+        if (strcmp(c->key, conn->key) == 0) {
+            count++;
+        }
+    }
+    if (client->closed || count >= client->max_idle_per_host) {
+        pthread_mutex_unlock(&client->lock);
+        conn_close(conn);
+        return;
+    }
+    conn->idle_since = time(NULL);
+    conn->start = conn->end = 0;
+    conn->next = client->idle;
+    client->idle = conn;
+    pthread_mutex_unlock(&client->lock);
+}
+
+// ========== URL PARSING ==========
+
+static int http_parse_url(const char *url, HttpUrl *out, char *err) {
+    const char *p;
+    if (strncasecmp(url, "http://", 7) == 0) {
+        out->https = 0;
+        out->port = 80;
+        p = url + 7;
+    } else if (strncasecmp(url, "https://", 8) == 0) {
+        out->https = 1;
+        out->port = 443;
+        p = url + 8;
+    } else {
+        snprintf(err, HTTP_ERR_LEN, "unsupported URL '%s' (expected http:// or https://)", url);
+        return -1;
+    }
+
+    const char *host_end;
+    const char *host = p;
+    if (*p == '[') {
+        // IPv6 literal: [addr]:port
+        host = p + 1;
+        host_end = strchr(host, ']');
+        if (!host_end) {
+            snprintf(err, HTTP_ERR_LEN, "invalid IPv6 host in URL '%s'", url);
+            return -1;
+        }
+        p = host_end + 1;
+    } else {
+        while (*p && *p != ':' && *p != '/' && *p != '?' && *p != '#') {
+            p++;
+        }
+        host_end = p;
+    }
+    size_t host_len = (size_t)(host_end - host);
+    if (host_len == 0 || host_len >= sizeof(out->host)) {
+        snprintf(err, HTTP_ERR_LEN, "invalid host in URL '%s'", url);
+        return -1;
+    }
+    memcpy(out->host, host, host_len);
+    out->host[host_len] = '\0';
+
+    if (*p == ':') {
+        p++;
+        int port = 0;
+        int digits = 0;
+        while (isdigit((unsigned char)*p) && digits < 6) {
+            port = port * 10 + (*p - '0');
+            p++;
+            digits++;
+        }
+        if (digits == 0 || port <= 0 || port > 65535) {
+            snprintf(err, HTTP_ERR_LEN, "invalid port in URL '%s'", url);
+            return -1;
+        }
+        out->port = port;
+    }
+    if (*p && *p != '/' && *p != '?' && *p != '#') {
+        snprintf(err, HTTP_ERR_LEN, "invalid URL '%s'", url);
+        return -1;
+    }
+
+    // Path and query; the fragment is never sent
+    out->path = p;
+    const char *frag = strchr(p, '#');
+    out->path_len = frag ? (size_t)(frag - p) : strlen(p);
+    return 0;
+}
+
+// ========== SOCKET I/O ==========
+
+// Connect with a deadline, then switch back to blocking I/O bounded by
+// SO_RCVTIMEO/SO_SNDTIMEO.
+static int dial(const HttpUrl *u, int timeout_ms, char *err) {
+    char port[8];
+    snprintf(port, sizeof(port), "%d", u->port);
+    struct addrinfo hints = {0};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo *res = NULL;
+    int rc = getaddrinfo(u->host, port, &hints, &res);
+    if (rc != 0) {
+        snprintf(err, HTTP_ERR_LEN, "cannot resolve '%s': %s", u->host, gai_strerror(rc));
+        return -1;
+    }
+
+    int fd = -1;
+    int last_errno = 0;
+    for (struct addrinfo *ai = res; ai; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) {
+            last_errno = errno;
+            continue;
+        }
+        int flags = fcntl(fd, F_GETFL, 0);
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        int ok = connect(fd, ai->ai_addr, ai->ai_addrlen) == 0;
+        if (!ok && errno == EINPROGRESS) {
+            struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+            if (poll(&pfd, 1, timeout_ms) == 1) {
+                int so_err = 0;
+                socklen_t len = sizeof(so_err);
+                getsockopt(fd, SOL_SOCKET, SO_ERROR, &so_err, &len);
+                ok = so_err == 0;
+                last_errno = so_err;
+            } else {
+                last_errno = ETIMEDOUT;
+            }
+        } else if (!ok) {
+            last_errno = errno;
+        }
+        if (ok) {
+            fcntl(fd, F_SETFL, flags);
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    if (fd < 0) {
+        snprintf(err, HTTP_ERR_LEN, "cannot connect to %s:%d: %s", u->host, u->port, strerror(last_errno));
+        return -1;
+    }
+
+    struct timeval tv = { .tv_sec = timeout_ms / 1000, .tv_usec = (timeout_ms % 1000) * 1000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+#ifdef HML_HAVE_OPENSSL_SSL
+static SSL_CTX* client_ssl_ctx(HttpClient *client, char *err) {
+    pthread_mutex_lock(&client->lock);
+    if (!client->ssl_ctx) {
+        SSL_CTX *sctx = SSL_CTX_new(TLS_client_method());
+        if (sctx) {
+            SSL_CTX_set_min_proto_version(sctx, TLS1_2_VERSION);
+            if (client->verify_tls) {
+                SSL_CTX_set_default_verify_paths(sctx);
+                SSL_CTX_set_verify(sctx, SSL_VERIFY_PEER, NULL);
+            }
+        }
+        client->ssl_ctx = sctx;
+    }
+    SSL_CTX *sctx = client->ssl_ctx;
+    pthread_mutex_unlock(&client->lock);
+    if (!sctx) {
+        snprintf(err, HTTP_ERR_LEN, "cannot create TLS context");
+    }
+    return sctx;
+}
+#endif
+
+static HttpConn* conn_open(HttpClient *client, const HttpUrl *u, const char *key, char *err) {
+    int fd = dial(u, client->timeout_ms, err);
+    if (fd < 0) {
+        return NULL;
+    }
+    HttpConn *conn = calloc(1, sizeof(HttpConn));
+    if (!conn) {
+        close(fd);
+        snprintf(err, HTTP_ERR_LEN, "memory allocation failed");
+        return NULL;
+    }
+    conn->fd = fd;
+    conn->key = strdup(key);
+    conn->cap = HTTP_READ_CHUNK;
+    conn->buf = malloc(conn->cap);
+    if (!conn->key || !conn->buf) {
+        conn_close(conn);
+        snprintf(err, HTTP_ERR_LEN, "memory allocation failed");
+        return NULL;
+    }
+
+    if (u->https) {
+#ifdef HML_HAVE_OPENSSL_SSL
+        SSL_CTX *sctx = client_ssl_ctx(client, err);
+        if (!sctx) {
+            conn_close(conn);
+            return NULL;
+        }
+        conn->ssl = SSL_new(sctx);
+        if (!conn->ssl) {
+            conn_close(conn);
+            snprintf(err, HTTP_ERR_LEN, "cannot create TLS session");
+            return NULL;
+        }
+        SSL_set_fd(conn->ssl, fd);
+        SSL_set_tlsext_host_name(conn->ssl, u->host);
+        if (client->verify_tls) {
+            SSL_set1_host(conn->ssl, u->host);
+        }
+        if (SSL_connect(conn->ssl) != 1) {
+            unsigned long e = ERR_get_error();
+            long vr = SSL_get_verify_result(conn->ssl);
+            if (vr != X509_V_OK) {
+                snprintf(err, HTTP_ERR_LEN, "TLS handshake with %s failed: %s",
+                         u->host, X509_verify_cert_error_string(vr));
+            } else {
+                snprintf(err, HTTP_ERR_LEN, "TLS handshake with %s failed: %s",
+                         u->host, e ? ERR_reason_error_string(e) : "connection closed");
+            }
+            ERR_clear_error();
+            conn_close(conn);
+            return NULL;
+        }
+#else
+        conn_close(conn);
+        snprintf(err, HTTP_ERR_LEN, "HTTPS not available - OpenSSL (libssl) not installed");
+        return NULL;
+#endif
+    }
+
+    pthread_mutex_lock(&client->lock);
+    client->opened++;
+    pthread_mutex_unlock(&client->lock);
+    return conn;
+}
+
+static int conn_write_all(HttpConn *conn, const char *data, size_t len) {
+    size_t off = 0;
+    while (off < len) {
+        ssize_t n;
+#ifdef HML_HAVE_OPENSSL_SSL
+        if (conn->ssl) {
+            // SSL_write() uses write(), so keep a dead peer from raising SIGPIPE
+            sigset_t pipe_set, old_set;
+            sigemptyset(&pipe_set);
+            sigaddset(&pipe_set, SIGPIPE);
+            pthread_sigmask(SIG_BLOCK, &pipe_set, &old_set);
+            int chunk = len - off > INT_MAX ? INT_MAX : (int)(len - off);
+            n = SSL_write(conn->ssl, data + off, chunk);
+            if (n <= 0) {
+                struct timespec zero = {0, 0};
+                sigtimedwait(&pipe_set, NULL, &zero);
+                ERR_clear_error();
+            }
+            pthread_sigmask(SIG_SETMASK, &old_set, NULL);
+            if (n <= 0) {
+                return -1;
+            }
+        } else
+#endif
+        {
+            n = send(conn->fd, data + off, len - off, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return -1;
+            }
+        }
+        off += (size_t)n;
+    }
+    return 0;
+}
+
+// Read more bytes into the connection buffer.
+// Returns bytes read, 0 at EOF, -1 on error or timeout.
+static ssize_t conn_fill(HttpConn *conn) {
+    if (conn->start > 0 && conn->start == conn->end) {
+        conn->start = conn->end = 0;
+    }
+    if (conn->end == conn->cap) {
+        if (conn->start > 0) {
+            memmove(conn->buf, conn->buf + conn->start, conn->end - conn->start);
+            conn->end -= conn->start;
+            conn->start = 0;
+        } else {
+            size_t cap = conn->cap * 2;
+            char *grown = realloc(conn->buf, cap);
+            if (!grown) {
+                return -1;
+            }
+            conn->buf = grown;
+            conn->cap = cap;
+        }
+    }
+    for (;;) {
+        ssize_t n;
+#ifdef HML_HAVE_OPENSSL_SSL
+        if (conn->ssl) {
+            n = SSL_read(conn->ssl, conn->buf + conn->end, (int)(conn->cap - conn->end));
+            if (n <= 0) {
+                int e = SSL_get_error(conn->ssl, (int)n);
+                ERR_clear_error();
+                return e == SSL_ERROR_ZERO_RETURN ? 0 : -1;
+            }
+        } else
+#endif
+        {
+            n = recv(conn->fd, conn->buf + conn->end, conn->cap - conn->end, 0);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                return -1;
+            }
+        }
+        conn->end += (size_t)n;
+        return n;
+    }
+}
+
+// Find the end of a CRLF-terminated line in the buffer, filling as needed.
+// Returns the line length (excluding CRLF) or -1 on EOF/error/oversize.
+static ssize_t conn_line(HttpConn *conn) {
+    size_t scanned = 0;
+    for (;;) {
+        char *base = conn->buf + conn->start;
+        size_t avail = conn->end - conn->start;
+        char *nl = memchr(base + scanned, '\n', avail - scanned);
+        if (nl) {
+            size_t len = (size_t)(nl - base);
+            return (ssize_t)(len > 0 && base[len - 1] == '\r' ? len - 1 : len);
+        }
+        scanned = avail;
+        if (avail > HTTP_MAX_HEAD || conn_fill(conn) <= 0) {
+            return -1;
+        }
+    }
+}
+
+static void conn_consume_line(HttpConn *conn, size_t line_len) {
+    conn->start += line_len;
+    if (conn->buf[conn->start] == '\r') {
+        conn->start++;
+    }
+    conn->start++;  // '\n'
+}
+
+// ========== REQUEST / RESPONSE ==========
+
+static void response_add_header(HttpResponse *resp, const char *name, size_t name_len,
+                                const char *value, size_t value_len) {
+    char *lname = malloc(name_len + 1);
+    for (size_t i = 0; i < name_len; i++) {
+        lname[i] = (char)tolower((unsigned char)name[i]);
+    }
+    lname[name_len] = '\0';
+
+    for (int i = 0; i < resp->num_headers; i++) {
+        if (strcmp(resp->names[i], lname) == 0) {
+            // Repeated header: merge as a comma-separated list (RFC 9110 5.3)
+            size_t old_len = strlen(resp->values[i]);
+            char *merged = realloc(resp->values[i], old_len + 2 + value_len + 1);
+            memcpy(merged + old_len, ", ", 2);
+            memcpy(merged + old_len + 2, value, value_len);
+            merged[old_len + 2 + value_len] = '\0';
+            resp->values[i] = merged;
+            free(lname);
+            return;
+        }
+    }
+    resp->names = realloc(resp->names, sizeof(char*) * (size_t)(resp->num_headers + 1));
+    resp->values = realloc(resp->values, sizeof(char*) * (size_t)(resp->num_headers + 1));
+    resp->names[resp->num_headers] = lname;
+    resp->values[resp->num_headers] = strndup(value, value_len);
+    resp->num_headers++;
+}
+
+static const char* response_header(HttpResponse *resp, const char *name) {
+    for (int i = 0; i < resp->num_headers; i++) {
+        if (strcmp(resp->names[i], name) == 0) {
+            return resp->values[i];
+        }
+    }
+    return NULL;
+}
+
+static void response_clear_headers(HttpResponse *resp) {
+    for (int i = 0; i < resp->num_headers; i++) {
+        free(resp->names[i]);
+        free(resp->values[i]);
+    }
+    free(resp->names);
+    free(resp->values);
+    resp->names = NULL;
+    resp->values = NULL;
+    resp->num_headers = 0;
+}
+
+// Does a comma-separated header value contain token (case-insensitive)?
+static int header_has_token(const char *value, const char *token) {
+    size_t tlen = strlen(token);
+    const char *p = value;
+    while (p && *p) {
+        while (*p == ' ' || *p == '\t' || *p == ',') {
+            p++;
+        }
+        const char *end = p;
+        while (*end && *end != ',') {
+            end++;
+        }
+        const char *trim = end;
+        while (trim > p && (trim[-1] == ' ' || trim[-1] == '\t')) {
+            trim--;
+        }
+        if ((size_t)(trim - p) == tlen && strncasecmp(p, token, tlen) == 0) {
+            return 1;
+        }
+        p = end;
+    }
+    return 0;
+}
+
+// Read the status line and headers, skipping interim 1xx responses.
+// Returns 0 on success; -1 on error with *got_bytes telling whether any
+// response bytes arrived (a stale pooled connection fails with none).
+static int response_read_head(HttpResponse *resp, int is_head, int *got_bytes, char *err) {
+    HttpConn *conn = resp->conn;
+    *got_bytes = 0;
+    int minor = 1;
+    for (;;) {
+        ssize_t len = conn_line(conn);
+        if (conn->end > 0) {
+            *got_bytes = 1;
+        }
+        if (len < 0) {
+            snprintf(err, HTTP_ERR_LEN, "connection closed before response");
+            return -1;
+        }
+        char *line = conn->buf + conn->start;
+        int status = 0;
+        if (len < 12 || strncmp(line, "HTTP/1.", 7) != 0 || !isdigit((unsigned char)line[7]) ||
+            line[8] != ' ' || sscanf(line + 9, "%3d", &status) != 1 || status < 100) {
+            snprintf(err, HTTP_ERR_LEN, "malformed status line");
+            return -1;
+        }
+        minor = line[7] - '0';
+        conn_consume_line(conn, (size_t)len);
+
+        response_clear_headers(resp);
+        size_t head_bytes = 0;
+        for (;;) {
+            len = conn_line(conn);
+            if (len < 0) {
+                snprintf(err, HTTP_ERR_LEN, "connection closed while reading headers");
+                return -1;
+            }
+            if (len == 0) {
+                conn_consume_line(conn, 0);
+                break;
+            }
+            head_bytes += (size_t)len;
+            if (head_bytes > HTTP_MAX_HEAD) {
+                snprintf(err, HTTP_ERR_LEN, "response headers too large");
+                return -1;
+            }
+            line = conn->buf + conn->start;
+            char *colon = memchr(line, ':', (size_t)len);
+            if (colon && colon > line) {
+                char *v = colon + 1;
+                char *v_end = line + len;
+                while (v < v_end && (*v == ' ' || *v == '\t')) {
+                    v++;
+                }
+                while (v_end > v && (v_end[-1] == ' ' || v_end[-1] == '\t')) {
+                    v_end--;
+                }
+                response_add_header(resp, line, (size_t)(colon - line), v, (size_t)(v_end - v));
+            }
+            conn_consume_line(conn, (size_t)len);
+        }
+
+        // 101 Switching Protocols is final; other 1xx are interim
+        if (status >= 200 || status == 101) {
+            resp->status = status;
+            break;
+        }
+    }
+
+    const char *connection = response_header(resp, "connection");
+    if (minor == 0) {
+        resp->keep_alive = connection && header_has_token(connection, "keep-alive");
+    } else {
+        resp->keep_alive = !(connection && header_has_token(connection, "close"));
+    }
+
+    const char *te = response_header(resp, "transfer-encoding");
+    const char *cl = response_header(resp, "content-length");
+    if (is_head || resp->status == 204 || resp->status == 304 || resp->status < 200) {
+        resp->mode = HTTP_BODY_NONE;
+    } else if (te && header_has_token(te, "chunked")) {
+        resp->mode = HTTP_BODY_CHUNKED;
+    } else if (cl) {
+        char *end;
+        errno = 0;
+        unsigned long long n = strtoull(cl, &end, 10);
+        if (errno || end == cl || *end != '\0') {
+            snprintf(err, HTTP_ERR_LEN, "invalid Content-Length '%s'", cl);
+            return -1;
+        }
+        resp->mode = HTTP_BODY_LENGTH;
+        resp->remaining = n;
+    } else {
+        resp->mode = HTTP_BODY_CLOSE;
+        resp->keep_alive = 0;
+    }
+    if (resp->status == 101) {
+        resp->keep_alive = 0;
+    }
+    if (resp->mode == HTTP_BODY_NONE || (resp->mode == HTTP_BODY_LENGTH && resp->remaining == 0)) {
+        resp->done = 1;
+    }
+    return 0;
+}
+
+// Hand the connection back (body fully read on a keep-alive connection)
+// or close it, and drop the response's client reference.
+static void response_release_conn(HttpResponse *resp) {
+    if (!resp->conn) {
+        return;
+    }
+    if (resp->done && resp->keep_alive && resp->conn->start == resp->conn->end) {
+        pool_put(resp->client, resp->conn);
+    } else {
+        conn_close(resp->conn);
+    }
+    resp->conn = NULL;
+    client_unref(resp->client);
+}
+
+// Copy up to max body bytes into out.
+// Returns bytes copied, 0 at the end of the body, -1 on error.
+static ssize_t response_read(HttpResponse *resp, char *out, size_t max, char *err) {
+    HttpConn *conn = resp->conn;
+    if (!conn) {
+        snprintf(err, HTTP_ERR_LEN, "connection already closed");
+        return -1;
+    }
+    while (!resp->done) {
+        if (resp->mode == HTTP_BODY_CHUNKED && !resp->in_chunk) {
+            // Chunk size line: hex size, optional extensions
+            ssize_t len = conn_line(conn);
+            if (len < 0) {
+                snprintf(err, HTTP_ERR_LEN, "connection closed inside chunked body");
+                return -1;
+            }
+            char *line = conn->buf + conn->start;
+            char *end;
+            unsigned long long size = strtoull(line, &end, 16);
+            if (end == line) {
+                snprintf(err, HTTP_ERR_LEN, "malformed chunk size");
+                return -1;
+            }
+            conn_consume_line(conn, (size_t)len);
+            if (size == 0) {
+                // Trailer section ends with an empty line
+                for (;;) {
+                    len = conn_line(conn);
+                    if (len < 0) {
+                        snprintf(err, HTTP_ERR_LEN, "connection closed inside chunked trailer");
+                        return -1;
+                    }
+                    conn_consume_line(conn, (size_t)len);
+                    if (len == 0) {
+                        break;
+                    }
+                }
+                resp->done = 1;
+                break;
+            }
+            resp->remaining = size;
+            resp->in_chunk = 1;
+        }
+
+        if (conn->start == conn->end) {
+            ssize_t n = conn_fill(conn);
+            if (n == 0 && resp->mode == HTTP_BODY_CLOSE) {
+                resp->done = 1;
+                break;
+            }
+            if (n <= 0) {
+                snprintf(err, HTTP_ERR_LEN, n == 0 ? "connection closed before end of body"
+                                                   : "error reading response body: %s", strerror(errno));
+                return -1;
+            }
+        }
+
+        size_t avail = conn->end - conn->start;
+        size_t take = avail < max ? avail : max;
+        if (resp->mode != HTTP_BODY_CLOSE && take > resp->remaining) {
+            take = (size_t)resp->remaining;
+        }
+        memcpy(out, conn->buf + conn->start, take);
+        conn->start += take;
+        if (resp->mode != HTTP_BODY_CLOSE) {
+            resp->remaining -= take;
+        }
+
+        if (resp->mode == HTTP_BODY_LENGTH && resp->remaining == 0) {
+            resp->done = 1;
+        } else if (resp->mode == HTTP_BODY_CHUNKED && resp->remaining == 0) {
+            // CRLF after chunk data
+            ssize_t len = conn_line(conn);
+            if (len != 0) {
+                snprintf(err, HTTP_ERR_LEN, "malformed chunked body");
+                return -1;
+            }
+            conn_consume_line(conn, 0);
+            resp->in_chunk = 0;
+        }
+        if (resp->done) {
+            response_release_conn(resp);
+        }
+        return (ssize_t)take;
+    }
+    response_release_conn(resp);
+    return 0;
+}
+
+static int is_idempotent(const char *method) {
+    return strcmp(method, "GET") == 0 || strcmp(method, "HEAD") == 0 ||
+           strcmp(method, "PUT") == 0 || strcmp(method, "DELETE") == 0 ||
+           strcmp(method, "OPTIONS") == 0 || strcmp(method, "TRACE") == 0;
+}
+
+// Does a "Name: value\r\n" block set the named header?
+static int header_block_has(const char *block, const char *name) {
+    size_t nlen = strlen(name);
+    const char *p = block;
+    while (*p) {
+        if (strncasecmp(p, name, nlen) == 0 && p[nlen] == ':') {
+            return 1;
+        }
+        const char *nl = strchr(p, '\n');
+        if (!nl) {
+            break;
+        }
+        p = nl + 1;
+    }
+    return 0;
+}
+
+// Send a request and read the response head. On success the response owns
+// a connection and a client reference.
+HttpResponse* http_client_request(HttpClient *client, const char *method, const char *url,
+                                  const char *headers, const char *body, size_t body_len,
+                                  char *err) {
+    HttpUrl u;
+    if (http_parse_url(url, &u, err) != 0) {
+        return NULL;
+    }
+
+    char key[300];
+    snprintf(key, sizeof(key), "%s://%s:%d", u.https ? "https" : "http", u.host, u.port);
+
+    // Request head
+    int default_port = u.https ? u.port == 443 : u.port == 80;
+    int ipv6 = strchr(u.host, ':') != NULL;
+    size_t inline_body = body_len <= HTTP_INLINE_BODY ? body_len : 0;
+    size_t head_cap = strlen(method) + u.path_len + strlen(u.host) + strlen(headers) + 160 + inline_body;
+    char *head = malloc(head_cap);
+    if (!head) {
+        snprintf(err, HTTP_ERR_LEN, "memory allocation failed");
+        return NULL;
+    }
+    // "http://host" and "http://host?q" request "/" and "/?q"
+    const char *root = u.path_len == 0 || u.path[0] == '?' ? "/" : "";
+    int n = snprintf(head, head_cap, "%s %s%.*s HTTP/1.1\r\n", method, root, (int)u.path_len, u.path);
+    if (!header_block_has(headers, "host")) {
+        n += snprintf(head + n, head_cap - (size_t)n, ipv6 ? "Host: [%s]" : "Host: %s", u.host);
+        n += default_port ? snprintf(head + n, head_cap - (size_t)n, "\r\n")
+                          : snprintf(head + n, head_cap - (size_t)n, ":%d\r\n", u.port);
+    }
+    if (!header_block_has(headers, "user-agent")) {
+        n += snprintf(head + n, head_cap - (size_t)n, "User-Agent: hemlock-http/1.1\r\n");
+    }
+    int sends_body = body_len > 0 || strcmp(method, "POST") == 0 ||
+                     strcmp(method, "PUT") == 0 || strcmp(method, "PATCH") == 0;
+    if (sends_body && !header_block_has(headers, "content-length") &&
+        !header_block_has(headers, "transfer-encoding")) {
+        n += snprintf(head + n, head_cap - (size_t)n, "Content-Length: %zu\r\n", body_len);
+    }
+    n += snprintf(head + n, head_cap - (size_t)n, "%s\r\n", headers);
+    if (inline_body > 0) {
+        memcpy(head + n, body, inline_body);
+        n += (int)inline_body;
+    }
+
+    HttpResponse *resp = calloc(1, sizeof(HttpResponse));
+    if (!resp) {
+        free(head);
+        snprintf(err, HTTP_ERR_LEN, "memory allocation failed");
+        return NULL;
+    }
+    resp->client = client;
+    client_ref(client);
+    int is_head = strcmp(method, "HEAD") == 0;
+
+    // A pooled connection may have been closed by the server after the
+    // liveness check; retry once on a fresh connection if nothing came back.
+    for (int attempt = 0; attempt < 2; attempt++) {
+        int reused = 0;
+        HttpConn *conn = attempt == 0 ? pool_take(client, key) : NULL;
+        if (conn) {
+            reused = 1;
+        } else {
+            conn = conn_open(client, &u, key, err);
+            if (!conn) {
+                break;
+            }
+        }
+        resp->conn = conn;
+
+        int got_bytes = 0;
+        int wrote = conn_write_all(conn, head, (size_t)n) == 0 &&
+                    (inline_body == body_len || conn_write_all(conn, body, body_len) == 0);
+        if (wrote && response_read_head(resp, is_head, &got_bytes, err) == 0) {
+            free(head);
+            if (resp->done) {
+                response_release_conn(resp);
+            }
+            return resp;
+        }
+        if (!wrote) {
+            snprintf(err, HTTP_ERR_LEN, "error sending request: %s", strerror(errno));
+        }
+        conn_close(conn);
+        resp->conn = NULL;
+        if (!reused || got_bytes || (wrote && !is_idempotent(method))) {
+            break;
+        }
+    }
+    free(head);
+    response_clear_headers(resp);
+    free(resp);
+    client_unref(client);
+    return NULL;
+}
+
+// ========== PUBLIC API ==========
+
+HttpClient* http_client_create(int timeout_ms, int max_idle_per_host, int verify_tls) {
+    HttpClient *client = calloc(1, sizeof(HttpClient));
+    if (!client) {
+        return NULL;
+    }
+    pthread_mutex_init(&client->lock, NULL);
+    client->timeout_ms = timeout_ms;
+    client->max_idle_per_host = max_idle_per_host;
+    client->verify_tls = verify_tls;
+    client->refs = 1;
+    return client;
+}
+
+int http_client_closed(HttpClient *client) {
+    return client->closed;
+}
+
+void http_client_close(HttpClient *client) {
+    pthread_mutex_lock(&client->lock);
+    client->closed = 1;
+    HttpConn *idle = client->idle;
+    client->idle = NULL;
+    pthread_mutex_unlock(&client->lock);
+    // Open responses keep their connection (and a client reference) until
+    // their body is read or they are closed
+    while (idle) {
+        HttpConn *c = idle;
+        idle = c->next;
+        conn_close(c);
+    }
+    client_unref(client);
+}
+
+void http_client_stats(HttpClient *client, long *opened, long *reused, int *idle) {
+    pthread_mutex_lock(&client->lock);
+    int count = 0;
+    for (HttpConn *c = client->idle; c; c = c->next) {
+        count++;
+    }
+    *opened = client->opened;
+    *reused = client->reused;
+    *idle = count;
+    pthread_mutex_unlock(&client->lock);
+}
+
+int http_method_normalize(const char *method, char *verb) {
+    size_t len = strlen(method);
+    if (len == 0 || len >= HTTP_METHOD_MAX) {
+        return -1;
+    }
+    for (size_t i = 0; i <= len; i++) {
+        verb[i] = (char)toupper((unsigned char)method[i]);
+        if (i < len && !isalpha((unsigned char)method[i])) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int http_header_block_append(char **block, size_t *len, size_t *cap, const char *line, size_t line_len) {
+    if (memchr(line, '\r', line_len) || memchr(line, '\n', line_len)) {
+        return -1;  // Header injection
+    }
+    if (*len + line_len + 3 > *cap) {
+        size_t new_cap = (*cap + line_len + 3) * 2;
+        char *grown = realloc(*block, new_cap);
+        if (!grown) {
+            return -1;
+        }
+        *block = grown;
+        *cap = new_cap;
+    }
+    memcpy(*block + *len, line, line_len);
+    memcpy(*block + *len + line_len, "\r\n", 3);
+    *len += line_len + 2;
+    return 0;
+}
+
+int http_response_status(const HttpResponse *resp) {
+    return resp->status;
+}
+
+int http_response_header_count(const HttpResponse *resp) {
+    return resp->num_headers;
+}
+
+const char* http_response_header_name(const HttpResponse *resp, int i) {
+    return resp->names[i];
+}
+
+const char* http_response_header_value(const HttpResponse *resp, int i) {
+    return resp->values[i];
+}
+
+int http_response_finished(const HttpResponse *resp) {
+    return resp->closed || resp->done;
+}
+
+ssize_t http_response_read(HttpResponse *resp, char *out, size_t max, char *err) {
+    if (http_response_finished(resp)) {
+        return 0;
+    }
+    ssize_t n = response_read(resp, out, max, err);
+    if (n < 0) {
+        response_release_conn(resp);
+    }
+    return n;
+}
+
+char* http_response_read_all(HttpResponse *resp, size_t *len, size_t *cap, char *err) {
+    *len = 0;
+    *cap = resp->mode == HTTP_BODY_LENGTH && resp->remaining < (64u << 20)
+           ? (size_t)resp->remaining + 1 : HTTP_READ_CHUNK;
+    char *out = malloc(*cap);
+    if (!out) {
+        snprintf(err, HTTP_ERR_LEN, "memory allocation failed");
+        return NULL;
+    }
+    while (!http_response_finished(resp)) {
+        if (*cap - *len < HTTP_READ_CHUNK / 2) {
+            char *grown = realloc(out, *cap * 2);
+            if (!grown) {
+                free(out);
+                snprintf(err, HTTP_ERR_LEN, "memory allocation failed");
+                return NULL;
+            }
+            out = grown;
+            *cap *= 2;
+        }
+        ssize_t n = http_response_read(resp, out + *len, *cap - *len - 1, err);
+        if (n < 0) {
+            free(out);
+            return NULL;
+        }
+        if (n == 0) {
+            break;
+        }
+        *len += (size_t)n;
+    }
+    out[*len] = '\0';
+    return out;
+}
+
+void http_response_close(HttpResponse *resp) {
+    if (resp->closed) {
+        return;
+    }
+    response_release_conn(resp);
+    response_clear_headers(resp);
+    resp->closed = 1;
+}
@@ -0,0 +1,68 @@
+/*
+ * Hemlock HTTP/1.1 Client Core
+ *
+ * Connection pooling, request writing and response parsing for the
+ * @stdlib/http client, shared by the interpreter and the runtime library.
+ * Functions that can fail take an err buffer of HTTP_ERR_LEN bytes and fill
+ * it with a message.
+ */
+
+#ifndef HEMLOCK_HTTP_CLIENT_CORE_H
+#define HEMLOCK_HTTP_CLIENT_CORE_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#define HTTP_ERR_LEN         512
+#define HTTP_METHOD_MAX      32
+
+typedef struct HttpClient HttpClient;
+typedef struct HttpResponse HttpResponse;
+
+/*
+ * Client lifetime. A closed client stays allocated so stale handles can be
+ * detected; responses still open keep their connection until they end.
+ */
+HttpClient* http_client_create(int timeout_ms, int max_idle_per_host, int verify_tls);
+int http_client_closed(HttpClient *client);
+void http_client_close(HttpClient *client);
+void http_client_stats(HttpClient *client, long *opened, long *reused, int *idle);
+
+// Uppercase a method into verb (HTTP_METHOD_MAX bytes); -1 if it is not
+// all letters
+int http_method_normalize(const char *method, char *verb);
+
+// Append "Name: value\r\n" to a growing header block; -1 on a line break
+// in the header or allocation failure
+int http_header_block_append(char **block, size_t *len, size_t *cap, const char *line, size_t line_len);
+
+/*
+ * Send a request and read the response head. headers is a block built
+ * with http_header_block_append. Returns NULL on failure.
+ */
+HttpResponse* http_client_request(HttpClient *client, const char *method, const char *url,
+                                  const char *headers, const char *body, size_t body_len,
+                                  char *err);
+
+int http_response_status(const HttpResponse *resp);
+
+// Headers with lowercased names, repeated headers merged
+int http_response_header_count(const HttpResponse *resp);
+const char* http_response_header_name(const HttpResponse *resp, int i);
+const char* http_response_header_value(const HttpResponse *resp, int i);
+
+// Whether the body has been read to the end or the response closed
+int http_response_finished(const HttpResponse *resp);
+
+// Copy up to max body bytes into out. Returns bytes copied, 0 at the end
+// of the body, -1 on error (the connection is then dropped).
+ssize_t http_response_read(HttpResponse *resp, char *out, size_t max, char *err);
+
+// Rest of the body as a NUL-terminated malloc'd string of *len bytes in a
+// *cap byte allocation, or NULL on error
+char* http_response_read_all(HttpResponse *resp, size_t *len, size_t *cap, char *err);
+
+// Pool the connection if the body was read to the end, otherwise close it
+void http_response_close(HttpResponse *resp);
+
+#endif // HEMLOCK_HTTP_CLIENT_CORE_H
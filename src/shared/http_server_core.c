@@ -0,0 +1,1056 @@
+/*
+ * Hemlock HTTP/1.1 Server Core
+ *
+ * The value-independent half of the @stdlib/http server, compiled into both
+ * the interpreter and the runtime library. One I/O thread accepts, reads
+ * and writes every connection through epoll and parses requests
+ * incrementally and in place (slices of the input buffer, header names
+ * lowercased where they lie, chunked bodies decoded over their own
+ * framing). Complete requests go to a fixed pool of worker threads that
+ * call the embedding's serve hook; a connection is not read while a worker
+ * owns it, so keep-alive and pipelined responses leave in request order,
+ * and buffered pipelined requests are answered in one write.
+ */
+
+#define _GNU_SOURCE
+#include "http_server_core.h"
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef HTTPD_HAVE_EPOLL
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#define HTTPD_READ_CHUNK     16384
+#define HTTPD_MAX_HEAD       (64 * 1024)
+#define HTTPD_MAX_HEADERS    100
+#define HTTPD_MAX_EVENTS     128
+#define HTTPD_MAX_CHUNK_LINE 1024
+#define HTTPD_BATCH_OUTPUT   (256 * 1024)  // Pipelined output a worker buffers before handing back
+
+// Parser results other than these are HTTP error statuses
+#define HTTPD_NEED_MORE      0
+#define HTTPD_COMPLETE       1
+
+typedef enum {
+    HTTPD_HEAD,
+    HTTPD_BODY,
+    HTTPD_CHUNK_SIZE,
+    HTTPD_CHUNK_DATA,
+    HTTPD_CHUNK_END,
+    HTTPD_TRAILER,
+    HTTPD_DONE
+} HttpdState;
+
+typedef struct {
+    uint32_t off, len;          // Byte range in the connection's input buffer
+} HttpdSlice;
+
+struct HttpdConn {
+    int fd;
+    char *in;                   // Received bytes; the current request starts at 0
+    size_t in_len, in_cap;
+
+    // Current request (slices stay valid until the request is consumed)
+    HttpdState state;
+    size_t scan;                // Where the search for the end of the head resumes
+    size_t pos;                 // Next raw byte to parse
+    HttpdSlice method, target;
+    HttpdSlice names[HTTPD_MAX_HEADERS];
+    HttpdSlice values[HTTPD_MAX_HEADERS];
+    int num_headers;
+    size_t body_start, body_len;
+    uint64_t remaining;         // Bytes left in the body or current chunk
+    int http10;
+    int keep_alive;
+    int head_only;
+    int expect_continue;
+
+    char *out;                  // Responses not yet written
+    size_t out_len, out_pos, out_cap;
+    size_t mark;                // Start of the response being written
+    int status;
+    int has_type;               // The handler set a Content-Type
+    int close_after;            // Close once out has been flushed
+    int busy;                   // Owned by a worker
+    int dead;                   // Peer went away while busy
+    time_t last_active;
+
+    struct HttpdConn *prev, *next;  // All connections (I/O thread)
+    struct HttpdConn *qnext;        // Work or done queue link
+};
+
+struct HttpServer {
+    int listen_fd;
+    int epoll_fd;
+    int wake_fd;                // eventfd: workers hand connections back
+    int port;
+    HttpdHandler handler;
+    size_t max_body;
+    int idle_timeout;           // Seconds, 0 keeps idle connections forever
+    int num_workers;
+    pthread_t io_thread;
+    pthread_t *workers;
+    HttpdConn *conns;
+
+    pthread_mutex_t lock;       // Guards the queues and stopping
+    pthread_cond_t work_cond;
+    HttpdConn *work_head, *work_tail;
+    HttpdConn *done;
+    int stopping;
+    int closed;
+
+    atomic_long accepted;
+    atomic_long requests;
+    atomic_int active;
+};
+
+// Server whose handler the current thread is running (NULL off the pool)
+static __thread HttpServer *httpd_current = NULL;
+
+static const char* httpd_reason(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 202: return "Accepted";
+        case 204: return "No Content";
+        case 206: return "Partial Content";
+        case 301: return "Moved Permanently";
+        case 302: return "Found";
+        case 303: return "See Other";
+        case 304: return "Not Modified";
+        case 307: return "Temporary Redirect";
+        case 308: return "Permanent Redirect";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 409: return "Conflict";
+        case 410: return "Gone";
+        case 413: return "Content Too Large";
+        case 415: return "Unsupported Media Type";
+        case 422: return "Unprocessable Content";
+        case 429: return "Too Many Requests";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        case 505: return "HTTP Version Not Supported";
+        default:  return status < 300 ? "OK" : (status < 400 ? "Redirect" : (status < 500 ? "Client Error" : "Server Error"));
+    }
+}
+
+// ========== REQUEST PARSER ==========
+
+static void httpd_reset_request(HttpdConn *c) {
+    c->state = HTTPD_HEAD;
+    c->scan = 0;
+    c->pos = 0;
+    c->num_headers = 0;
+    c->body_start = 0;
+    c->body_len = 0;
+    c->remaining = 0;
+    c->http10 = 0;
+    c->keep_alive = 0;
+    c->head_only = 0;
+    c->expect_continue = 0;
+}
+
+// Drop the request just served, keeping any pipelined bytes behind it
+static void httpd_consume(HttpdConn *c) {
+    memmove(c->in, c->in + c->pos, c->in_len - c->pos);
+    c->in_len -= c->pos;
+    httpd_reset_request(c);
+}
+
+static int httpd_is_tchar(unsigned char ch) {
+    return isalnum(ch) || (ch && strchr("!#$%&'*+-.^_`|~", ch) != NULL);
+}
+
+// Case-insensitive match of a comma-separated token list against one token
+static int httpd_has_token(const char *v, size_t len, const char *token) {
+    size_t tlen = strlen(token);
+    size_t i = 0;
+    while (i < len) {
+        while (i < len && (v[i] == ' ' || v[i] == '\t' || v[i] == ',')) i++;
+        size_t start = i;
+        while (i < len && v[i] != ',') i++;
+        size_t end = i;
+        while (end > start && (v[end - 1] == ' ' || v[end - 1] == '\t')) end--;
+        if (end - start == tlen && strncasecmp(v + start, token, tlen) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Parse the request line and header fields once the blank line is in
+static int httpd_parse_head(HttpServer *srv, HttpdConn *c) {
+    // Tolerate empty lines ahead of a request (RFC 9112 section 2.2)
+    size_t skip = 0;
+    while (skip + 1 < c->in_len && c->in[skip] == '\r' && c->in[skip + 1] == '\n') {
+        skip += 2;
+    }
+    if (skip > 0) {
+        memmove(c->in, c->in + skip, c->in_len - skip);
+        c->in_len -= skip;
+        c->scan = 0;
+    }
+
+    size_t from = c->scan > 3 ? c->scan - 3 : 0;
+    char *blank = memmem(c->in + from, c->in_len - from, "\r\n\r\n", 4);
+    if (!blank) {
+        c->scan = c->in_len;
+        return c->in_len > HTTPD_MAX_HEAD ? 431 : HTTPD_NEED_MORE;
+    }
+    size_t head_len = (size_t)(blank - c->in) + 4;
+    if (head_len > HTTPD_MAX_HEAD) {
+        return 431;
+    }
+    char *head_end = c->in + head_len;
+
+    // Request line: method SP request-target SP HTTP-version CRLF
+    char *eol = memchr(c->in, '\r', head_len);
+    char *sp1 = memchr(c->in, ' ', (size_t)(eol - c->in));
+    if (!sp1 || sp1 == c->in || eol[1] != '\n') {
+        return 400;
+    }
+    char *sp2 = memchr(sp1 + 1, ' ', (size_t)(eol - sp1 - 1));
+    if (!sp2 || sp2 == sp1 + 1) {
+        return 400;
+    }
+    for (char *p = c->in; p < sp1; p++) {
+        if (!httpd_is_tchar((unsigned char)*p)) return 400;
+    }
+    for (char *p = sp1 + 1; p < sp2; p++) {
+        if ((unsigned char)*p <= ' ' || *p == 0x7f) return 400;
+    }
+    char *version = sp2 + 1;
+    if (eol - version != 8 || memcmp(version, "HTTP/", 5) != 0) {
+        return 400;
+    }
+    if (memcmp(version, "HTTP/1.1", 8) == 0) {
+        c->keep_alive = 1;
+    } else if (memcmp(version, "HTTP/1.0", 8) == 0) {
+        c->http10 = 1;
+    } else {
+        return 505;
+    }
+    c->method = (HttpdSlice){ 0, (uint32_t)(sp1 - c->in) };
+    c->target = (HttpdSlice){ (uint32_t)(sp1 + 1 - c->in), (uint32_t)(sp2 - sp1 - 1) };
+    c->head_only = c->method.len == 4 && memcmp(c->in, "HEAD", 4) == 0;
+
+    // Header fields: name ":" OWS value OWS CRLF
+    uint64_t length = 0;
+    int have_length = 0;
+    int chunked = 0;
+    char *line = eol + 2;
+    while (line < head_end - 2) {
+        eol = memchr(line, '\r', (size_t)(head_end - line));
+        if (eol[1] != '\n') {
+            return 400;
+        }
+        if (*line == ' ' || *line == '\t') {
+            return 400;  // Obsolete line folding
+        }
+        char *colon = memchr(line, ':', (size_t)(eol - line));
+        if (!colon || colon == line) {
+            return 400;
+        }
+        for (char *p = line; p < colon; p++) {
+            if (!httpd_is_tchar((unsigned char)*p)) return 400;
+            *p = (char)tolower((unsigned char)*p);
+        }
+        char *v = colon + 1;
+        char *v_end = eol;
+        while (v < v_end && (*v == ' ' || *v == '\t')) v++;
+        while (v_end > v && (v_end[-1] == ' ' || v_end[-1] == '\t')) v_end--;
+        for (char *p = v; p < v_end; p++) {
+            unsigned char ch = (unsigned char)*p;
+            if ((ch < ' ' && ch != '\t') || ch == 0x7f) return 400;
+        }
+        if (c->num_headers == HTTPD_MAX_HEADERS) {
+            return 431;
+        }
+        size_t name_len = (size_t)(colon - line);
+        size_t value_len = (size_t)(v_end - v);
+        c->names[c->num_headers] = (HttpdSlice){ (uint32_t)(line - c->in), (uint32_t)name_len };
+        c->values[c->num_headers] = (HttpdSlice){ (uint32_t)(v - c->in), (uint32_t)value_len };
+        c->num_headers++;
+
+        if (name_len == 14 && memcmp(line, "content-length", 14) == 0) {
+            uint64_t n = 0;
+            if (value_len == 0) return 400;
+            for (char *p = v; p < v_end; p++) {
+                if (!isdigit((unsigned char)*p)) return 400;
+                if (n > (UINT64_MAX - 9) / 10) return 413;
+                n = n * 10 + (uint64_t)(*p - '0');
+            }
+            if (have_length && n != length) return 400;
+            length = n;
+            have_length = 1;
+        } else if (name_len == 17 && memcmp(line, "transfer-encoding", 17) == 0) {
+            // Only "chunked" on its own is understood
+            if (value_len != 7 || strncasecmp(v, "chunked", 7) != 0) return 501;
+            chunked = 1;
+        } else if (name_len == 10 && memcmp(line, "connection", 10) == 0) {
+            if (httpd_has_token(v, value_len, "close")) {
+                c->keep_alive = 0;
+            } else if (httpd_has_token(v, value_len, "keep-alive")) {
+                c->keep_alive = 1;
+            }
+        } else if (name_len == 6 && memcmp(line, "expect", 6) == 0) {
+            c->expect_continue = value_len == 12 && strncasecmp(v, "100-continue", 12) == 0;
+        }
+        line = eol + 2;
+    }
+
+    if (chunked && have_length) {
+        return 400;  // Ambiguous framing (RFC 9112 section 6.3)
+    }
+    c->pos = head_len;
+    c->body_start = head_len;
+    if (chunked) {
+        c->state = HTTPD_CHUNK_SIZE;
+    } else if (length > 0) {
+        if (length > srv->max_body) return 413;
+        c->remaining = length;
+        c->state = HTTPD_BODY;
+    } else {
+        c->state = HTTPD_DONE;
+        c->expect_continue = 0;
+    }
+    return HTTPD_NEED_MORE;
+}
+
+// Advance the parser over the buffered input. Resumable: returns
+// HTTPD_NEED_MORE until a whole request is in, then HTTPD_COMPLETE, or an
+// HTTP error status for a request that cannot be served.
+static int httpd_parse(HttpServer *srv, HttpdConn *c) {
+    for (;;) {
+        switch (c->state) {
+            case HTTPD_HEAD: {
+                int rc = httpd_parse_head(srv, c);
+                if (rc != HTTPD_NEED_MORE || c->state == HTTPD_HEAD) {
+                    return rc;
+                }
+                break;
+            }
+
+            case HTTPD_BODY:
+                if (c->in_len - c->pos < c->remaining) {
+                    return HTTPD_NEED_MORE;
+                }
+                c->body_len = (size_t)c->remaining;
+                c->pos += (size_t)c->remaining;
+                c->remaining = 0;
+                c->state = HTTPD_DONE;
+                break;
+
+            case HTTPD_CHUNK_SIZE: {
+                char *start = c->in + c->pos;
+                char *eol = memmem(start, c->in_len - c->pos, "\r\n", 2);
+                if (!eol) {
+                    return c->in_len - c->pos > HTTPD_MAX_CHUNK_LINE ? 400 : HTTPD_NEED_MORE;
+                }
+                uint64_t size = 0;
+                char *p = start;
+                while (p < eol && isxdigit((unsigned char)*p)) {
+                    if (size >> 59) return 413;
+                    int digit = isdigit((unsigned char)*p) ? *p - '0' : (tolower((unsigned char)*p) - 'a' + 10);
+                    size = size * 16 + (uint64_t)digit;
+                    p++;
+                }
+                if (p == start) {
+                    return 400;
+                }
+                while (p < eol && (*p == ' ' || *p == '\t')) p++;
+                if (p < eol && *p != ';') {
+                    return 400;  // Chunk extensions after ';' are ignored
+                }
+                c->pos = (size_t)(eol - c->in) + 2;
+                if (size == 0) {
+                    c->state = HTTPD_TRAILER;
+                } else {
+                    if (c->body_len + size > srv->max_body) return 413;
+                    c->remaining = size;
+                    c->state = HTTPD_CHUNK_DATA;
+                }
+                break;
+            }
+
+            case HTTPD_CHUNK_DATA: {
+                size_t n = c->in_len - c->pos;
+                if (n > c->remaining) n = (size_t)c->remaining;
+                if (n == 0) {
+                    return HTTPD_NEED_MORE;
+                }
+                // Decode in place: the data slides down over the framing before it
+                memmove(c->in + c->body_start + c->body_len, c->in + c->pos, n);
+                c->body_len += n;
+                c->pos += n;
+                c->remaining -= n;
+                if (c->remaining > 0) {
+                    return HTTPD_NEED_MORE;
+                }
+                c->state = HTTPD_CHUNK_END;
+                break;
+            }
+
+            case HTTPD_CHUNK_END:
+                if (c->in_len - c->pos < 2) {
+                    return HTTPD_NEED_MORE;
+                }
+                if (c->in[c->pos] != '\r' || c->in[c->pos + 1] != '\n') {
+                    return 400;
+                }
+                c->pos += 2;
+                c->state = HTTPD_CHUNK_SIZE;
+                break;
+
+            case HTTPD_TRAILER: {
+                // Trailer fields are read and dropped
+                char *eol = memmem(c->in + c->pos, c->in_len - c->pos, "\r\n", 2);
+                if (!eol) {
+                    return c->in_len - c->pos > HTTPD_MAX_HEAD ? 431 : HTTPD_NEED_MORE;
+                }
+                size_t line_len = (size_t)(eol - (c->in + c->pos));
+                c->pos += line_len + 2;
+                if (line_len == 0) {
+                    c->state = HTTPD_DONE;
+                }
+                break;
+            }
+
+            case HTTPD_DONE:
+                c->expect_continue = 0;
+                return HTTPD_COMPLETE;
+        }
+    }
+}
+
+// ========== RESPONSE WRITER ==========
+
+static void httpd_out_append(HttpdConn *c, const char *data, size_t len) {
+    if (c->out_len + len > c->out_cap) {
+        size_t cap = c->out_cap ? c->out_cap : 4096;
+        while (cap < c->out_len + len) cap *= 2;
+        char *grown = realloc(c->out, cap);
+        if (!grown) {
+            fprintf(stderr, "Runtime error: Memory allocation failed\n");
+            exit(1);
+        }
+        c->out = grown;
+        c->out_cap = cap;
+    }
+    memcpy(c->out + c->out_len, data, len);
+    c->out_len += len;
+}
+
+static void httpd_out_str(HttpdConn *c, const char *s) {
+    httpd_out_append(c, s, strlen(s));
+}
+
+static void httpd_begin_response(HttpdConn *c, int status) {
+    char line[96];
+    int n = snprintf(line, sizeof(line), "HTTP/1.1 %d %s\r\n", status, httpd_reason(status));
+    httpd_out_append(c, line, (size_t)n);
+}
+
+// Framing headers, the blank line and the body
+static void httpd_end_response(HttpdConn *c, int status, const char *body, size_t len) {
+    int has_body = status != 204 && status != 304;
+    if (has_body) {
+        char line[48];
+        int n = snprintf(line, sizeof(line), "Content-Length: %zu\r\n", len);
+        httpd_out_append(c, line, (size_t)n);
+    }
+    if (c->close_after) {
+        httpd_out_str(c, "Connection: close\r\n");
+    } else if (c->http10) {
+        httpd_out_str(c, "Connection: keep-alive\r\n");
+    }
+    httpd_out_str(c, "\r\n");
+    if (has_body && !c->head_only && len > 0) {
+        httpd_out_append(c, body, len);
+    }
+}
+
+static void httpd_simple_response(HttpdConn *c, int status) {
+    const char *text = httpd_reason(status);
+    httpd_begin_response(c, status);
+    httpd_out_str(c, "Content-Type: text/plain; charset=utf-8\r\n");
+    httpd_end_response(c, status, text, strlen(text));
+}
+
+// ========== REQUEST AND RESPONSE API ==========
+
+const char* httpd_request_method(const HttpdConn *c, size_t *len) {
+    *len = c->method.len;
+    return c->in + c->method.off;
+}
+
+const char* httpd_request_target(const HttpdConn *c, size_t *len) {
+    *len = c->target.len;
+    return c->in + c->target.off;
+}
+
+const char* httpd_request_version(const HttpdConn *c) {
+    return c->http10 ? "HTTP/1.0" : "HTTP/1.1";
+}
+
+int httpd_request_header_count(const HttpdConn *c) {
+    return c->num_headers;
+}
+
+void httpd_request_header(const HttpdConn *c, int i, const char **name, size_t *name_len,
+                          const char **value, size_t *value_len) {
+    *name = c->in + c->names[i].off;
+    *name_len = c->names[i].len;
+    *value = c->in + c->values[i].off;
+    *value_len = c->values[i].len;
+}
+
+const char* httpd_request_body(const HttpdConn *c, size_t *len) {
+    *len = c->body_len;
+    return c->in + c->body_start;
+}
+
+void httpd_response_begin(HttpdConn *c, int status) {
+    c->mark = c->out_len;
+    c->status = status;
+    c->has_type = 0;
+    httpd_begin_response(c, status);
+}
+
+// Append one handler-supplied header. Framing headers are the server's to
+// write and are skipped; names or values that would split the header block
+// are refused.
+int httpd_response_header(HttpdConn *c, const char *name, size_t name_len,
+                          const char *value, size_t value_len) {
+    if (name_len == 0) {
+        return 0;
+    }
+    for (size_t i = 0; i < name_len; i++) {
+        if (!httpd_is_tchar((unsigned char)name[i])) return 0;
+    }
+    for (size_t i = 0; i < value_len; i++) {
+        if (value[i] == '\r' || value[i] == '\n' || value[i] == '\0') return 0;
+    }
+    if ((name_len == 14 && strncasecmp(name, "content-length", 14) == 0) ||
+        (name_len == 17 && strncasecmp(name, "transfer-encoding", 17) == 0) ||
+        (name_len == 10 && strncasecmp(name, "connection", 10) == 0)) {
+        return 1;
+    }
+    if (name_len == 12 && strncasecmp(name, "content-type", 12) == 0) {
+        c->has_type = 1;
+    }
+    httpd_out_append(c, name, name_len);
+    httpd_out_str(c, ": ");
+    httpd_out_append(c, value, value_len);
+    httpd_out_str(c, "\r\n");
+    return 1;
+}
+
+
+// "Name: value", as the client accepts
+int httpd_response_header_line(HttpdConn *c, const char *line, size_t len) {
+    const char *colon = memchr(line, ':', len);
+    if (!colon) {
+        return 0;
+    }
+    const char *v = colon + 1;
+    const char *end = line + len;
+    while (v < end && (*v == ' ' || *v == '\t')) v++;
+    return httpd_response_header(c, line, (size_t)(colon - line), v, (size_t)(end - v));
+}
+
+void httpd_response_end(HttpdConn *c, const char *body, size_t len, const char *type) {
+    if (!c->has_type && type && len > 0) {
+        httpd_out_str(c, "Content-Type: ");
+        httpd_out_str(c, type);
+        httpd_out_str(c, "\r\n");
+    }
+    httpd_end_response(c, c->status, body, len);
+}
+
+void httpd_response_cancel(HttpdConn *c) {
+    c->out_len = c->mark;
+}
+
+// Serve the connection's complete request, then any pipelined requests
+// already buffered behind it
+static void httpd_serve(HttpServer *srv, HttpdConn *c, void *worker) {
+    for (;;) {
+        c->close_after = !c->keep_alive;
+        if (!srv->handler.serve(srv->handler.data, worker, c)) {
+            httpd_simple_response(c, 500);
+        }
+        atomic_fetch_add(&srv->requests, 1);
+
+        httpd_consume(c);
+        if (c->close_after || c->out_len >= HTTPD_BATCH_OUTPUT) {
+            return;
+        }
+        if (httpd_parse(srv, c) != HTTPD_COMPLETE) {
+            return;  // The I/O thread picks up from the saved parser state
+        }
+    }
+}
+
+// ========== I/O THREAD ==========
+
+static void httpd_watch(HttpServer *srv, HttpdConn *c, uint32_t events) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.ptr = c;
+    epoll_ctl(srv->epoll_fd, EPOLL_CTL_MOD, c->fd, &ev);
+}
+
+static void httpd_conn_close(HttpServer *srv, HttpdConn *c) {
+    epoll_ctl(srv->epoll_fd, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    if (c->prev) c->prev->next = c->next;
+    else srv->conns = c->next;
+    if (c->next) c->next->prev = c->prev;
+    free(c->in);
+    free(c->out);
+    free(c);
+    atomic_fetch_sub(&srv->active, 1);
+}
+
+static void httpd_dispatch(HttpServer *srv, HttpdConn *c) {
+    c->busy = 1;
+    httpd_watch(srv, c, 0);
+    c->qnext = NULL;
+    pthread_mutex_lock(&srv->lock);
+    if (srv->work_tail) srv->work_tail->qnext = c;
+    else srv->work_head = c;
+    srv->work_tail = c;
+    pthread_cond_signal(&srv->work_cond);
+    pthread_mutex_unlock(&srv->lock);
+}
+
+static int httpd_flush(HttpServer *srv, HttpdConn *c);
+
+// Parse what is buffered: dispatch a complete request, answer a bad one,
+// or wait for more input
+static void httpd_advance(HttpServer *srv, HttpdConn *c) {
+    int rc = httpd_parse(srv, c);
+    if (rc == HTTPD_COMPLETE) {
+        httpd_dispatch(srv, c);
+        return;
+    }
+    if (rc == HTTPD_NEED_MORE) {
+        if (c->expect_continue) {
+            // Best effort: a client that misses it sends the body after a delay
+            static const char cont[] = "HTTP/1.1 100 Continue\r\n\r\n";
+            send(c->fd, cont, sizeof(cont) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+            c->expect_continue = 0;
+        }
+        httpd_watch(srv, c, EPOLLIN | EPOLLRDHUP);
+        return;
+    }
+    c->close_after = 1;
+    c->head_only = 0;
+    httpd_simple_response(c, rc);
+    httpd_flush(srv, c);
+}
+
+// Write pending output; once it is all out, move on to the next request.
+// Returns -1 if the connection was closed.
+static int httpd_flush(HttpServer *srv, HttpdConn *c) {
+    while (c->out_pos < c->out_len) {
+        ssize_t n = send(c->fd, c->out + c->out_pos, c->out_len - c->out_pos, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                httpd_watch(srv, c, EPOLLOUT);
+                return 0;
+            }
+            httpd_conn_close(srv, c);
+            return -1;
+        }
+        c->out_pos += (size_t)n;
+    }
+    c->out_pos = 0;
+    c->out_len = 0;
+    c->last_active = time(NULL);
+    if (c->close_after) {
+        httpd_conn_close(srv, c);
+        return -1;
+    }
+    httpd_advance(srv, c);
+    return 0;
+}
+
+static void httpd_conn_read(HttpServer *srv, HttpdConn *c) {
+    if (c->in_cap - c->in_len < HTTPD_READ_CHUNK) {
+        size_t cap = c->in_cap ? c->in_cap * 2 : HTTPD_READ_CHUNK * 2;
+        while (cap - c->in_len < HTTPD_READ_CHUNK) cap *= 2;
+        char *grown = realloc(c->in, cap);
+        if (!grown) {
+            httpd_conn_close(srv, c);
+            return;
+        }
+        c->in = grown;
+        c->in_cap = cap;
+    }
+    ssize_t n = recv(c->fd, c->in + c->in_len, c->in_cap - c->in_len, 0);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        return;
+    }
+    if (n <= 0) {
+        httpd_conn_close(srv, c);
+        return;
+    }
+    c->in_len += (size_t)n;
+    c->last_active = time(NULL);
+    httpd_advance(srv, c);
+}
+
+static void httpd_conn_event(HttpServer *srv, HttpdConn *c, uint32_t events) {
+    if (c->busy) {
+        // Only hangups reach a connection a worker owns; close it when the
+        // worker hands it back
+        if (events & (EPOLLHUP | EPOLLERR)) {
+            c->dead = 1;
+            epoll_ctl(srv->epoll_fd, EPOLL_CTL_DEL, c->fd, NULL);
+        }
+        return;
+    }
+    if (events & EPOLLERR) {
+        httpd_conn_close(srv, c);
+        return;
+    }
+    if (c->out_pos < c->out_len) {
+        if (events & (EPOLLOUT | EPOLLHUP)) {
+            httpd_flush(srv, c);
+        }
+        return;
+    }
+    if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) {
+        httpd_conn_read(srv, c);
+    }
+}
+
+static void httpd_accept(HttpServer *srv) {
+    for (;;) {
+        int fd = accept4(srv->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;  // EAGAIN, or out of descriptors until a connection closes
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        HttpdConn *c = calloc(1, sizeof(HttpdConn));
+        if (!c) {
+            close(fd);
+            continue;
+        }
+        c->fd = fd;
+        c->last_active = time(NULL);
+        httpd_reset_request(c);
+
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.ptr = c;
+        if (epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            close(fd);
+            free(c);
+            continue;
+        }
+        c->next = srv->conns;
+        if (srv->conns) srv->conns->prev = c;
+        srv->conns = c;
+        atomic_fetch_add(&srv->accepted, 1);
+        atomic_fetch_add(&srv->active, 1);
+    }
+}
+
+// Take back connections the workers have finished with
+static void httpd_collect(HttpServer *srv) {
+    pthread_mutex_lock(&srv->lock);
+    HttpdConn *c = srv->done;
+    srv->done = NULL;
+    pthread_mutex_unlock(&srv->lock);
+    while (c) {
+        HttpdConn *next = c->qnext;
+        c->busy = 0;
+        if (c->dead) {
+            httpd_conn_close(srv, c);
+        } else {
+            httpd_flush(srv, c);
+        }
+        c = next;
+    }
+}
+
+static void httpd_sweep_idle(HttpServer *srv, time_t now) {
+    HttpdConn *c = srv->conns;
+    while (c) {
+        HttpdConn *next = c->next;
+        if (!c->busy && c->out_len == 0 && now - c->last_active >= srv->idle_timeout) {
+            httpd_conn_close(srv, c);
+        }
+        c = next;
+    }
+}
+
+static void* httpd_io_main(void *arg) {
+    HttpServer *srv = (HttpServer*)arg;
+    sigset_t set;
+    sigfillset(&set);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+    struct epoll_event events[HTTPD_MAX_EVENTS];
+    time_t last_sweep = time(NULL);
+    for (;;) {
+        int n = epoll_wait(srv->epoll_fd, events, HTTPD_MAX_EVENTS, 1000);
+        if (n < 0 && errno != EINTR) {
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            void *tag = events[i].data.ptr;
+            if (tag == &srv->listen_fd) {
+                httpd_accept(srv);
+            } else if (tag == &srv->wake_fd) {
+                uint64_t count;
+                ssize_t r = read(srv->wake_fd, &count, sizeof(count));
+                (void)r;
+            } else {
+                httpd_conn_event(srv, (HttpdConn*)tag, events[i].events);
+            }
+        }
+        httpd_collect(srv);
+
+        pthread_mutex_lock(&srv->lock);
+        int stopping = srv->stopping;
+        pthread_mutex_unlock(&srv->lock);
+        if (stopping) {
+            break;
+        }
+        time_t now = time(NULL);
+        if (srv->idle_timeout > 0 && now != last_sweep) {
+            httpd_sweep_idle(srv, now);
+            last_sweep = now;
+        }
+    }
+    return NULL;
+}
+
+// ========== WORKERS ==========
+
+static void* httpd_worker_main(void *arg) {
+    HttpServer *srv = (HttpServer*)arg;
+    sigset_t set;
+    sigfillset(&set);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+    void *worker = srv->handler.worker_start ? srv->handler.worker_start(srv->handler.data) : NULL;
+    httpd_current = srv;
+    for (;;) {
+        pthread_mutex_lock(&srv->lock);
+        while (!srv->work_head && !srv->stopping) {
+            pthread_cond_wait(&srv->work_cond, &srv->lock);
+        }
+        if (srv->stopping) {
+            pthread_mutex_unlock(&srv->lock);
+            break;
+        }
+        HttpdConn *c = srv->work_head;
+        srv->work_head = c->qnext;
+        if (!srv->work_head) srv->work_tail = NULL;
+        pthread_mutex_unlock(&srv->lock);
+
+        httpd_serve(srv, c, worker);
+
+        pthread_mutex_lock(&srv->lock);
+        c->qnext = srv->done;
+        srv->done = c;
+        pthread_mutex_unlock(&srv->lock);
+        uint64_t one = 1;
+        ssize_t w = write(srv->wake_fd, &one, sizeof(one));
+        (void)w;
+    }
+    httpd_current = NULL;
+    if (srv->handler.worker_stop) {
+        srv->handler.worker_stop(srv->handler.data, worker);
+    }
+    return NULL;
+}
+
+// ========== LIFECYCLE ==========
+
+static int httpd_listen(const char *host, int port, int *bound_port, char *err, size_t err_len) {
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+    char port_str[16];
+    snprintf(port_str, sizeof(port_str), "%d", port);
+
+    struct addrinfo *res = NULL;
+    int rc = getaddrinfo(host[0] ? host : NULL, port_str, &hints, &res);
+    if (rc != 0) {
+        snprintf(err, err_len, "cannot resolve '%s': %s", host, gai_strerror(rc));
+        return -1;
+    }
+    int fd = -1;
+    int saved = 0;
+    for (struct addrinfo *ai = res; ai; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            saved = errno;
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && listen(fd, 511) == 0) {
+            break;
+        }
+        saved = errno;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    if (fd < 0) {
+        snprintf(err, err_len, "cannot listen on %s:%d: %s", host, port, strerror(saved));
+        return -1;
+    }
+    struct sockaddr_storage addr;
+    socklen_t addr_len = sizeof(addr);
+    *bound_port = port;
+    if (getsockname(fd, (struct sockaddr*)&addr, &addr_len) == 0) {
+        *bound_port = addr.ss_family == AF_INET6
+            ? ntohs(((struct sockaddr_in6*)&addr)->sin6_port)
+            : ntohs(((struct sockaddr_in*)&addr)->sin_port);
+    }
+    return fd;
+}
+
+
+HttpServer* httpd_server_start(const char *host, int port, int workers, size_t max_body,
+                               int idle_timeout, const HttpdHandler *handler, char *err) {
+    int bound_port = 0;
+    int listen_fd = httpd_listen(host, port, &bound_port, err, HTTPD_ERR_LEN);
+    if (listen_fd < 0) {
+        return NULL;
+    }
+
+    HttpServer *srv = calloc(1, sizeof(HttpServer));
+    if (!srv) {
+        close(listen_fd);
+        snprintf(err, HTTPD_ERR_LEN, "memory allocation failed");
+        return NULL;
+    }
+    srv->listen_fd = listen_fd;
+    srv->port = bound_port;
+    srv->max_body = max_body;
+    srv->idle_timeout = idle_timeout;
+    srv->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    srv->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (srv->epoll_fd < 0 || srv->wake_fd < 0) {
+        int saved = errno;
+        if (srv->epoll_fd >= 0) close(srv->epoll_fd);
+        if (srv->wake_fd >= 0) close(srv->wake_fd);
+        close(listen_fd);
+        free(srv);
+        snprintf(err, HTTPD_ERR_LEN, "cannot create event loop: %s", strerror(saved));
+        return NULL;
+    }
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = &srv->listen_fd;
+    epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev);
+    ev.data.ptr = &srv->wake_fd;
+    epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, srv->wake_fd, &ev);
+
+    pthread_mutex_init(&srv->lock, NULL);
+    pthread_cond_init(&srv->work_cond, NULL);
+    srv->handler = *handler;
+
+    srv->workers = malloc(sizeof(pthread_t) * (size_t)workers);
+    for (int i = 0; i < workers; i++) {
+        if (pthread_create(&srv->workers[i], NULL, httpd_worker_main, srv) != 0) {
+            fprintf(stderr, "Runtime error: Failed to create thread\n");
+            exit(1);
+        }
+        srv->num_workers++;
+    }
+    if (pthread_create(&srv->io_thread, NULL, httpd_io_main, srv) != 0) {
+        fprintf(stderr, "Runtime error: Failed to create thread\n");
+        exit(1);
+    }
+    return srv;
+}
+
+int httpd_server_closed(HttpServer *srv) {
+    return srv->closed;
+}
+
+int httpd_server_port(HttpServer *srv) {
+    return srv->port;
+}
+
+void httpd_server_stats(HttpServer *srv, long *connections, int *active, long *requests) {
+    *connections = atomic_load(&srv->accepted);
+    *active = atomic_load(&srv->active);
+    *requests = atomic_load(&srv->requests);
+}
+
+int httpd_server_is_current(HttpServer *srv) {
+    return httpd_current == srv;
+}
+
+// Stop the threads, close every connection and release the handler
+void httpd_server_close(HttpServer *srv) {
+    pthread_mutex_lock(&srv->lock);
+    srv->stopping = 1;
+    pthread_cond_broadcast(&srv->work_cond);
+    pthread_mutex_unlock(&srv->lock);
+    uint64_t one = 1;
+    ssize_t w = write(srv->wake_fd, &one, sizeof(one));
+    (void)w;
+
+    pthread_join(srv->io_thread, NULL);
+    for (int i = 0; i < srv->num_workers; i++) {
+        pthread_join(srv->workers[i], NULL);
+    }
+    while (srv->conns) {
+        httpd_conn_close(srv, srv->conns);
+    }
+    close(srv->listen_fd);
+    close(srv->wake_fd);
+    close(srv->epoll_fd);
+    free(srv->workers);
+    srv->workers = NULL;
+    if (srv->handler.release) {
+        srv->handler.release(srv->handler.data);
+    }
+    srv->closed = 1;
+}
+
+#endif  // HTTPD_HAVE_EPOLL
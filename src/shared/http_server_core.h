@@ -0,0 +1,82 @@
+/*
+ * Hemlock HTTP/1.1 Server Core
+ *
+ * Connection handling, request parsing and response framing for the
+ * @stdlib/http server, shared by the interpreter and the runtime library.
+ * The caller supplies an HttpdHandler whose serve hook turns one parsed
+ * request into one response on a worker thread.
+ */
+
+#ifndef HEMLOCK_HTTP_SERVER_CORE_H
+#define HEMLOCK_HTTP_SERVER_CORE_H
+
+#include <stddef.h>
+
+#ifdef __linux__
+#define HTTPD_HAVE_EPOLL 1
+#endif
+
+#define HTTPD_ERR_LEN        320
+
+typedef struct HttpServer HttpServer;
+typedef struct HttpdConn HttpdConn;
+
+/*
+ * Calls into the embedding. worker_start runs on each worker thread before
+ * its first request and its result is passed to serve and worker_stop
+ * (either may be NULL). serve writes one response with the httpd_response_*
+ * functions and returns 0 to have a 500 sent instead. release runs once the
+ * server has stopped (may be NULL).
+ */
+typedef struct {
+    void *data;
+    void* (*worker_start)(void *data);
+    void (*worker_stop)(void *data, void *worker);
+    int (*serve)(void *data, void *worker, HttpdConn *c);
+    void (*release)(void *data);
+} HttpdHandler;
+
+/*
+ * Server lifetime. Start returns NULL with err (HTTPD_ERR_LEN bytes) filled
+ * in. A closed server stays allocated so stale handles can be detected.
+ */
+HttpServer* httpd_server_start(const char *host, int port, int workers, size_t max_body,
+                               int idle_timeout, const HttpdHandler *handler, char *err);
+int httpd_server_closed(HttpServer *srv);
+int httpd_server_port(HttpServer *srv);
+void httpd_server_stats(HttpServer *srv, long *connections, int *active, long *requests);
+
+// Whether the calling thread is one of the server's workers
+int httpd_server_is_current(HttpServer *srv);
+
+// Stop accepting, finish requests in progress and close every connection
+void httpd_server_close(HttpServer *srv);
+
+/*
+ * The request being served. Pointers are into the connection's input
+ * buffer and are not NUL-terminated; header names are lowercased and
+ * repeated headers are listed separately.
+ */
+const char* httpd_request_method(const HttpdConn *c, size_t *len);
+const char* httpd_request_target(const HttpdConn *c, size_t *len);
+const char* httpd_request_version(const HttpdConn *c);
+int httpd_request_header_count(const HttpdConn *c);
+void httpd_request_header(const HttpdConn *c, int i, const char **name, size_t *name_len,
+                          const char **value, size_t *value_len);
+const char* httpd_request_body(const HttpdConn *c, size_t *len);
+
+/*
+ * The response. Headers go between begin and end; header returns 0 for a
+ * name or value that would split the header block (the server's own
+ * framing headers are dropped). end adds a Content-Type of type, if given,
+ * when the handler set none and the body is not empty. cancel discards a
+ * response that was begun.
+ */
+void httpd_response_begin(HttpdConn *c, int status);
+int httpd_response_header(HttpdConn *c, const char *name, size_t name_len,
+                          const char *value, size_t value_len);
+int httpd_response_header_line(HttpdConn *c, const char *line, size_t len);
+void httpd_response_end(HttpdConn *c, const char *body, size_t len, const char *type);
+void httpd_response_cancel(HttpdConn *c);
+
+#endif // HEMLOCK_HTTP_SERVER_CORE_H
@@ -0,0 +1,413 @@
+/*
+ * Hemlock Log Sink Core
+ *
+ * Output backend for @stdlib/logging, compiled into both the interpreter
+ * and the runtime library. A buffered sink owns a bounded multi-producer
+ * ring of formatted lines (one slot per line, each with a sequence number,
+ * so producers on any thread claim slots with a single CAS and never take a
+ * lock) and a writer thread that drains the ring and hands whole batches to
+ * writev. The writer sleeps until flush_ms passes or batch_bytes are
+ * pending, whichever comes first. When the ring is full a line is either
+ * dropped (counted in stats) or the producer blocks until the writer makes
+ * room. An unbuffered sink writes each line on the caller's thread.
+ */
+
+#define _GNU_SOURCE
+#include "log_sink_core.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LOG_SINK_MAX_IOV      256
+
+typedef struct {
+    _Atomic size_t seq;         // == position when free, position + 1 when filled
+    char *line;                 // Owned, ends in '\n'
+    size_t len;
+} LogSlot;
+
+struct LogSink {
+    int fd;
+    int owns_fd;
+    int is_stdout;
+    int buffered;
+    int block;                  // Block producers on a full ring instead of dropping
+    pid_t pid;                  // Process that started the writer thread
+
+    LogSlot *slots;
+    size_t mask;
+    _Atomic size_t head;        // Next position to claim (producers)
+    _Atomic size_t tail;        // Next position to write (writer thread)
+    _Atomic size_t pending_bytes;
+    size_t batch_bytes;
+    int flush_ms;
+
+    _Atomic int64_t written;
+    _Atomic int64_t dropped;
+
+    pthread_mutex_t lock;
+    pthread_cond_t wake;        // Writer: batch full, flush requested or stopping
+    pthread_cond_t space;       // Blocked producers: writer freed slots
+    pthread_cond_t done;        // Flushers: writer finished a batch
+    _Atomic int sleeping;       // Writer is waiting on wake
+    int waiting;                // Producers blocked on a full ring
+    int flush_waiters;
+    int stop;
+    int closed;
+    pthread_t thread;
+
+    struct LogSink *next;
+};
+
+static pthread_mutex_t log_sinks_lock = PTHREAD_MUTEX_INITIALIZER;
+static LogSink *log_sinks = NULL;
+static int log_sinks_atexit = 0;
+
+static void log_sinks_flush_all(void) {
+    pthread_mutex_lock(&log_sinks_lock);
+    for (LogSink *s = log_sinks; s; s = s->next) {
+        // A forked child has the ring but not the writer thread
+        if (s->pid == getpid()) {
+            log_sink_flush(s);
+        }
+    }
+    pthread_mutex_unlock(&log_sinks_lock);
+}
+
+static void log_sinks_add(LogSink *s) {
+    pthread_mutex_lock(&log_sinks_lock);
+    if (!log_sinks_atexit) {
+        atexit(log_sinks_flush_all);
+        log_sinks_atexit = 1;
+    }
+    s->next = log_sinks;
+    log_sinks = s;
+    pthread_mutex_unlock(&log_sinks_lock);
+}
+
+static void log_sinks_remove(LogSink *s) {
+    pthread_mutex_lock(&log_sinks_lock);
+    for (LogSink **p = &log_sinks; *p; p = &(*p)->next) {
+        if (*p == s) {
+            *p = s->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&log_sinks_lock);
+}
+
+// Write every byte of iov[0..count), resuming after short writes
+static int log_sink_writev_all(int fd, struct iovec *iov, int count) {
+    while (count > 0) {
+        ssize_t n = writev(fd, iov, count);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        while (count > 0 && (size_t)n >= iov->iov_len) {
+            n -= (ssize_t)iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char*)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+    }
+    return 0;
+}
+
+static void log_sink_output(LogSink *s, struct iovec *iov, int count) {
+    int rc;
+    if (s->is_stdout) {
+        // Keep lines after anything print() still has buffered
+        flockfile(stdout);
+        fflush(stdout);
+        rc = log_sink_writev_all(s->fd, iov, count);
+        funlockfile(stdout);
+    } else {
+        rc = log_sink_writev_all(s->fd, iov, count);
+    }
+    if (rc == 0) {
+        atomic_fetch_add(&s->written, count);
+    } else {
+        atomic_fetch_add(&s->dropped, count);
+    }
+}
+
+// Claim a slot and publish the line; 0 if the ring is full
+static int log_sink_push(LogSink *s, char *line, size_t len) {
+    size_t pos = atomic_load_explicit(&s->head, memory_order_relaxed);
+    LogSlot *slot;
+    for (;;) {
+        slot = &s->slots[pos & s->mask];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&s->head, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (dif < 0) {
+            return 0;
+        } else {
+            pos = atomic_load_explicit(&s->head, memory_order_relaxed);
+        }
+    }
+    slot->line = line;
+    slot->len = len;
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    return 1;
+}
+
+static int log_sink_ready(LogSink *s) {
+    size_t tail = atomic_load_explicit(&s->tail, memory_order_relaxed);
+    LogSlot *slot = &s->slots[tail & s->mask];
+    return atomic_load_explicit(&slot->seq, memory_order_acquire) == tail + 1;
+}
+
+// Write out every published line (writer thread only)
+static void log_sink_drain(LogSink *s) {
+    struct iovec iov[LOG_SINK_MAX_IOV];
+    char *lines[LOG_SINK_MAX_IOV];
+    for (;;) {
+        size_t tail = atomic_load_explicit(&s->tail, memory_order_relaxed);
+        int count = 0;
+        size_t bytes = 0;
+        while (count < LOG_SINK_MAX_IOV) {
+            LogSlot *slot = &s->slots[(tail + (size_t)count) & s->mask];
+            if (atomic_load_explicit(&slot->seq, memory_order_acquire) != tail + (size_t)count + 1) {
+                break;
+            }
+            lines[count] = slot->line;
+            iov[count].iov_base = slot->line;
+            iov[count].iov_len = slot->len;
+            bytes += slot->len;
+            count++;
+        }
+        if (count == 0) {
+            return;
+        }
+        log_sink_output(s, iov, count);
+        for (int i = 0; i < count; i++) {
+            free(lines[i]);
+            LogSlot *slot = &s->slots[(tail + (size_t)i) & s->mask];
+            atomic_store_explicit(&slot->seq, tail + (size_t)i + s->mask + 1, memory_order_release);
+        }
+        atomic_fetch_sub(&s->pending_bytes, bytes);
+        atomic_store_explicit(&s->tail, tail + (size_t)count, memory_order_release);
+    }
+}
+
+static void log_sink_timedwait(pthread_cond_t *cond, pthread_mutex_t *lock, int ms) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ms / 1000;
+    ts.tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(cond, lock, &ts);
+}
+
+static void* log_sink_main(void *arg) {
+    LogSink *s = (LogSink*)arg;
+
+    // Signals belong to the main thread
+    sigset_t all;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, NULL);
+
+    pthread_mutex_lock(&s->lock);
+    for (;;) {
+        if (s->stop && !log_sink_ready(s)) {
+            break;
+        }
+        if (!s->stop && s->flush_waiters == 0 && s->waiting == 0) {
+            // Producers read this after adding to pending_bytes, so either
+            // they see the writer asleep and signal, or it sees a full batch
+            atomic_store(&s->sleeping, 1);
+            if (atomic_load(&s->pending_bytes) < s->batch_bytes) {
+                log_sink_timedwait(&s->wake, &s->lock, s->flush_ms);
+            }
+            atomic_store(&s->sleeping, 0);
+        } else if (!log_sink_ready(s)) {
+            // A producer has claimed a slot but not filled it yet
+            log_sink_timedwait(&s->wake, &s->lock, 1);
+        }
+        pthread_mutex_unlock(&s->lock);
+        log_sink_drain(s);
+        pthread_mutex_lock(&s->lock);
+        pthread_cond_broadcast(&s->space);
+        pthread_cond_broadcast(&s->done);
+    }
+    pthread_mutex_unlock(&s->lock);
+    return NULL;
+}
+
+int log_sink_write(LogSink *s, char *line, size_t len) {
+    if (!s->buffered) {
+        struct iovec iov = { line, len };
+        pthread_mutex_lock(&s->lock);
+        log_sink_output(s, &iov, 1);
+        pthread_mutex_unlock(&s->lock);
+        free(line);
+        return 1;
+    }
+    if (!log_sink_push(s, line, len)) {
+        if (!s->block) {
+            free(line);
+            atomic_fetch_add(&s->dropped, 1);
+            return 0;
+        }
+        pthread_mutex_lock(&s->lock);
+        s->waiting++;
+        pthread_cond_signal(&s->wake);
+        while (!log_sink_push(s, line, len)) {
+            pthread_cond_wait(&s->space, &s->lock);
+        }
+        s->waiting--;
+        pthread_mutex_unlock(&s->lock);
+    }
+    size_t pending = atomic_fetch_add(&s->pending_bytes, len) + len;
+    if (pending >= s->batch_bytes && atomic_load(&s->sleeping)) {
+        pthread_mutex_lock(&s->lock);
+        pthread_cond_signal(&s->wake);
+        pthread_mutex_unlock(&s->lock);
+    }
+    return 1;
+}
+
+void log_sink_flush(LogSink *s) {
+    if (!s->buffered) {
+        return;
+    }
+    size_t target = atomic_load(&s->head);
+    pthread_mutex_lock(&s->lock);
+    s->flush_waiters++;
+    pthread_cond_signal(&s->wake);
+    while (!s->stop && atomic_load(&s->tail) < target) {
+        pthread_cond_wait(&s->done, &s->lock);
+    }
+    s->flush_waiters--;
+    pthread_mutex_unlock(&s->lock);
+}
+
+void log_sink_close(LogSink *s) {
+    log_sinks_remove(s);
+    if (s->buffered) {
+        pthread_mutex_lock(&s->lock);
+        s->stop = 1;
+        pthread_cond_signal(&s->wake);
+        pthread_mutex_unlock(&s->lock);
+        pthread_join(s->thread, NULL);
+        free(s->slots);
+        s->slots = NULL;
+    }
+    if (s->owns_fd) {
+        close(s->fd);
+    }
+    s->closed = 1;
+}
+
+LogSink* log_sink_open(const char *target, int buffered, int block, size_t capacity,
+                       size_t batch_bytes, int flush_ms, char *err) {
+    int fd;
+    int owns_fd = 0;
+    if (strcmp(target, "stdout") == 0) {
+        fd = STDOUT_FILENO;
+    } else if (strcmp(target, "stderr") == 0) {
+        fd = STDERR_FILENO;
+    } else {
+        fd = open(target, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            snprintf(err, LOG_SINK_ERR_LEN, "Failed to open log file '%s': %s", target, strerror(errno));
+            return NULL;
+        }
+        owns_fd = 1;
+    }
+
+    LogSink *s = calloc(1, sizeof(LogSink));
+    if (!s) {
+        if (owns_fd) close(fd);
+        snprintf(err, LOG_SINK_ERR_LEN, "log_sink_open() memory allocation failed");
+        return NULL;
+    }
+    s->fd = fd;
+    s->owns_fd = owns_fd;
+    s->is_stdout = (fd == STDOUT_FILENO);
+    s->buffered = buffered;
+    s->block = block;
+    s->pid = getpid();
+    s->batch_bytes = batch_bytes;
+    s->flush_ms = flush_ms;
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->wake, NULL);
+    pthread_cond_init(&s->space, NULL);
+    pthread_cond_init(&s->done, NULL);
+
+    if (buffered) {
+        size_t slots = 1;
+        while (slots < capacity) {
+            slots <<= 1;
+        }
+        s->slots = malloc(sizeof(LogSlot) * slots);
+        if (!s->slots) {
+            if (owns_fd) close(fd);
+            free(s);
+            snprintf(err, LOG_SINK_ERR_LEN, "log_sink_open() memory allocation failed");
+            return NULL;
+        }
+        for (size_t i = 0; i < slots; i++) {
+            atomic_init(&s->slots[i].seq, i);
+            s->slots[i].line = NULL;
+            s->slots[i].len = 0;
+        }
+        s->mask = slots - 1;
+        if (pthread_create(&s->thread, NULL, log_sink_main, s) != 0) {
+            fprintf(stderr, "Runtime error: Failed to create thread\n");
+            exit(1);
+        }
+    }
+    log_sinks_add(s);
+    return s;
+}
+
+int log_sink_closed(LogSink *s) {
+    return s->closed;
+}
+
+void log_sink_stats(LogSink *s, int64_t *written, int64_t *dropped, int64_t *pending) {
+    *written = atomic_load(&s->written);
+    *dropped = atomic_load(&s->dropped);
+    *pending = s->buffered ? (int64_t)(atomic_load(&s->head) - atomic_load(&s->tail)) : 0;
+}
+
+// The date and time up to the seconds are cached per thread, so most calls
+// only format the milliseconds
+int log_timestamp_format(char *out) {
+    static __thread time_t cached_sec = -1;
+    static __thread char cached_prefix[24];
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    if (ts.tv_sec != cached_sec) {
+        struct tm tm;
+        gmtime_r(&ts.tv_sec, &tm);
+        strftime(cached_prefix, sizeof(cached_prefix), "%Y-%m-%dT%H:%M:%S", &tm);
+        cached_sec = ts.tv_sec;
+    }
+    return snprintf(out, LOG_TIMESTAMP_LEN, "%s.%03dZ", cached_prefix, (int)(ts.tv_nsec / 1000000));
+}
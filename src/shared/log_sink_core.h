@@ -0,0 +1,50 @@
+/*
+ * Hemlock Log Sink Core
+ *
+ * Buffered line output for @stdlib/logging, shared by the interpreter and
+ * the runtime library. Every sink still open at exit is flushed by an
+ * atexit handler.
+ */
+
+#ifndef HEMLOCK_LOG_SINK_CORE_H
+#define HEMLOCK_LOG_SINK_CORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LOG_SINK_ERR_LEN      512
+#define LOG_SINK_MAX_CAPACITY (1 << 20)
+#define LOG_TIMESTAMP_LEN     32
+
+typedef struct LogSink LogSink;
+
+/*
+ * Open a sink on "stdout", "stderr" or a file path (opened for append).
+ * A buffered sink queues up to capacity lines for a writer thread that
+ * writes them once flush_ms passes or batch_bytes are pending; when the
+ * queue is full a line is dropped, or with block the caller waits. Returns
+ * NULL with err (LOG_SINK_ERR_LEN bytes) filled in.
+ */
+LogSink* log_sink_open(const char *target, int buffered, int block, size_t capacity,
+                       size_t batch_bytes, int flush_ms, char *err);
+
+// A closed sink stays allocated so stale handles can be detected
+int log_sink_closed(LogSink *s);
+
+// Queue (buffered) or write (unbuffered) one line ending in '\n'; takes
+// ownership of the malloc'd line. Returns 0 if the line was dropped.
+int log_sink_write(LogSink *s, char *line, size_t len);
+
+// Wait until every line queued before the call has been written
+void log_sink_flush(LogSink *s);
+
+void log_sink_stats(LogSink *s, int64_t *written, int64_t *dropped, int64_t *pending);
+
+// Flush, stop the writer and close an opened file
+void log_sink_close(LogSink *s);
+
+// Format the current UTC time as "YYYY-MM-DDTHH:MM:SS.mmmZ" into out
+// (LOG_TIMESTAMP_LEN bytes); returns its length
+int log_timestamp_format(char *out);
+
+#endif // HEMLOCK_LOG_SINK_CORE_H
@@ -0,0 +1,1239 @@
+/*
+ * Hemlock Regular Expression Engine
+ *
+ * The value-independent half of @stdlib/regex, compiled into both the
+ * interpreter and the runtime library; each keeps only its own builtin
+ * bindings. Patterns compile to a Thompson NFA program; positions and
+ * captures come from a Pike VM and boolean tests from a lazily built DFA, so
+ * matching is linear in the text for every pattern. A literal prefix is
+ * located with memchr/memmem before any thread runs, and compiled patterns
+ * are shared through an LRU cache keyed by pattern and flags. Matching is
+ * byte-oriented.
+ */
+
+#define _GNU_SOURCE  // For memmem()
+#include "regex_engine.h"
+#include <ctype.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REGEX_ICASE         2       // REG_ICASE
+#define REGEX_NEWLINE       8       // REG_NEWLINE
+
+#define REGEX_MAX_REPEAT    1000    // Largest {n,m} count
+#define REGEX_MAX_PROG      20000   // Largest compiled program
+#define REGEX_MAX_DEPTH     250     // Deepest group/quantifier nesting
+#define REGEX_DFA_STATES    1024    // DFA cache budget before falling back
+#define REGEX_DFA_BUCKETS   1024
+#define REGEX_CACHE_SIZE    64
+
+typedef enum {
+    RI_CHAR,        // Match byte c
+    RI_ANY,         // Match any byte
+    RI_ANYNL,       // Match any byte but '\n' (REG_NEWLINE)
+    RI_CLASS,       // Match a byte in classes[x]
+    RI_MATCH,
+    RI_JMP,         // Continue at x
+    RI_SPLIT,       // Continue at x, then (lower priority) at y
+    RI_SAVE,        // Record the position in capture slot x
+    RI_BOL,
+    RI_EOL,
+    RI_WORDB,
+    RI_NWORDB
+} HmlRegexOp;
+
+typedef struct {
+    uint8_t op;
+    uint8_t c;
+    int x;
+    int y;
+} HmlRegexInst;
+
+typedef struct {
+    uint32_t bits[8];
+} HmlRegexClass;
+
+#define REGEX_DFA_END       256
+#define REGEX_DFA_MATCH     ((HmlRegexDfaState*)1)
+#define REGEX_DFA_DEAD      ((HmlRegexDfaState*)2)
+#define REGEX_CTX_BOL       1       // Previous byte starts a line
+#define REGEX_CTX_WORD      2       // Previous byte is a word character
+
+typedef struct HmlRegexDfaState HmlRegexDfaState;
+struct HmlRegexDfaState {
+    int *pcs;                       // Pending threads, before closure
+    int npcs;
+    int ctx;
+    uint32_t hash;
+    HmlRegexDfaState *chain;
+    HmlRegexDfaState *next[257];       // Transitions, NULL until computed
+};
+
+struct HmlRegex {
+    char *pattern;
+    int pattern_len;
+    int flags;
+    HmlRegexInst *prog;
+    int prog_len;
+    HmlRegexClass *classes;
+    int nclasses;
+    int ngroups;                    // Including group 0 (the whole match)
+    int anchored;                   // Starts with ^ outside REG_NEWLINE
+    char *prefix;                   // Literal every match starts with
+    int prefix_len;
+    int refcount;
+
+    // Lazy DFA, guarded by dfa_lock
+    pthread_mutex_t dfa_lock;
+    int dfa_ctx_mask;               // Context bits the program looks at
+    HmlRegexDfaState **dfa_table;
+    int dfa_count;
+    HmlRegexDfaState *dfa_start[4];
+    int *dfa_mark;
+    int dfa_stamp;
+    int *dfa_stack;
+    int *dfa_set;
+};
+
+// ========== PARSER ==========
+
+typedef enum {
+    RN_EMPTY, RN_CHAR, RN_ANY, RN_CLASS, RN_BOL, RN_EOL, RN_WORDB, RN_NWORDB,
+    RN_CAT,         // Children a, a.next, ...
+    RN_ALT,         // Alternatives a, a.next, ...
+    RN_GROUP,       // Capture group b around a
+    RN_REPEAT       // a{min,max}, max -1 for unbounded
+} HmlRegexNodeType;
+
+typedef struct {
+    uint8_t type;
+    uint8_t c;
+    uint8_t greedy;
+    int a;
+    int b;
+    int next;
+    int min;
+    int max;
+} HmlRegexNode;
+
+typedef struct {
+    const unsigned char *p;
+    const unsigned char *end;
+    int flags;
+    int depth;
+    HmlRegexNode *nodes;
+    int nnodes;
+    int nodes_cap;
+    HmlRegexClass *classes;
+    int nclasses;
+    int classes_cap;
+    int ngroups;
+    HmlRegexInst *prog;
+    int prog_len;
+    int prog_cap;
+    const char *error;
+} HmlRegexParser;
+
+static int regex_is_word(int c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (c >= '0' && c <= '9') || c == '_';
+}
+
+static void regex_class_set(HmlRegexClass *cls, int c) {
+    cls->bits[c >> 5] |= 1u << (c & 31);
+}
+
+static int regex_class_has(const HmlRegexClass *cls, int c) {
+    return (cls->bits[c >> 5] >> (c & 31)) & 1;
+}
+
+static int regex_node(HmlRegexParser *ps, int type) {
+    if (ps->nnodes == ps->nodes_cap) {
+        int cap = ps->nodes_cap ? ps->nodes_cap * 2 : 32;
+        HmlRegexNode *nodes = realloc(ps->nodes, sizeof(HmlRegexNode) * cap);
+        if (!nodes) {
+            ps->error = "out of memory";
+            return -1;
+        }
+        ps->nodes = nodes;
+        ps->nodes_cap = cap;
+    }
+    HmlRegexNode *n = &ps->nodes[ps->nnodes];
+    memset(n, 0, sizeof(HmlRegexNode));
+    n->type = (uint8_t)type;
+    n->next = -1;
+    return ps->nnodes++;
+}
+
+static int regex_new_class(HmlRegexParser *ps) {
+    if (ps->nclasses == ps->classes_cap) {
+        int cap = ps->classes_cap ? ps->classes_cap * 2 : 8;
+        HmlRegexClass *classes = realloc(ps->classes, sizeof(HmlRegexClass) * cap);
+        if (!classes) {
+            ps->error = "out of memory";
+            return -1;
+        }
+        ps->classes = classes;
+        ps->classes_cap = cap;
+    }
+    memset(&ps->classes[ps->nclasses], 0, sizeof(HmlRegexClass));
+    return ps->nclasses++;
+}
+
+static int regex_class_node(HmlRegexParser *ps, int cls) {
+    int n = regex_node(ps, RN_CLASS);
+    if (n >= 0) ps->nodes[n].a = cls;
+    return n;
+}
+
+// A literal byte; under REG_ICASE letters become two-case classes
+static int regex_literal(HmlRegexParser *ps, int c) {
+    if ((ps->flags & REGEX_ICASE) && ((c | 0x20) >= 'a' && (c | 0x20) <= 'z')) {
+        int cls = regex_new_class(ps);
+        if (cls < 0) return -1;
+        regex_class_set(&ps->classes[cls], c | 0x20);
+        regex_class_set(&ps->classes[cls], c & ~0x20);
+        return regex_class_node(ps, cls);
+    }
+    int n = regex_node(ps, RN_CHAR);
+    if (n >= 0) ps->nodes[n].c = (uint8_t)c;
+    return n;
+}
+
+// Add a \d \w \s class (or its negation) to cls
+static void regex_add_perl_class(HmlRegexClass *cls, int kind) {
+    int lower = kind | 0x20;
+    for (int c = 0; c < 256; c++) {
+        int in;
+        if (lower == 'd') in = c >= '0' && c <= '9';
+        else if (lower == 'w') in = regex_is_word(c);
+        else in = c == ' ' || (c >= '\t' && c <= '\r');
+        if (in != (kind != lower)) regex_class_set(cls, c);
+    }
+}
+
+// Add a POSIX [:name:] class (ASCII, as in the C locale). Returns 0 for
+// unknown names.
+static int regex_add_named_class(HmlRegexClass *cls, const char *name, int len) {
+    static const char *names[] = {
+        "alnum", "alpha", "blank", "cntrl", "digit", "graph", "lower",
+        "print", "punct", "space", "upper", "xdigit", "word"
+    };
+    int which = -1;
+    for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++) {
+        if ((int)strlen(names[i]) == len && memcmp(names[i], name, len) == 0) {
+            which = i;
+            break;
+        }
+    }
+    if (which < 0) return 0;
+    for (int c = 0; c < 128; c++) {
+        int in = 0;
+        switch (which) {
+            case 0: in = isalnum(c); break;
+            case 1: in = isalpha(c); break;
+            case 2: in = c == ' ' || c == '\t'; break;
+            case 3: in = iscntrl(c); break;
+            case 4: in = isdigit(c); break;
+            case 5: in = isgraph(c); break;
+            case 6: in = islower(c); break;
+            case 7: in = isprint(c); break;
+            case 8: in = ispunct(c); break;
+            case 9: in = isspace(c); break;
+            case 10: in = isupper(c); break;
+            case 11: in = isxdigit(c); break;
+            case 12: in = regex_is_word(c); break;
+        }
+        if (in) regex_class_set(cls, c);
+    }
+    return 1;
+}
+
+static int regex_hex_digit(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') return (c | 0x20) - 'a' + 10;
+    return -1;
+}
+
+// Decode the escape after a backslash (ps->p points past it). Returns the
+// byte, -2 for a class shorthand stored in *shorthand, or -1 on error.
+static int regex_escape(HmlRegexParser *ps, int in_class, int *shorthand) {
+    if (ps->p >= ps->end) {
+        ps->error = "trailing backslash";
+        return -1;
+    }
+    int e = *ps->p++;
+    switch (e) {
+        case 'd': case 'D': case 'w': case 'W': case 's': case 'S':
+            *shorthand = e;
+            return -2;
+        case 'n': return '\n';
+        case 't': return '\t';
+        case 'r': return '\r';
+        case 'f': return '\f';
+        case 'v': return '\v';
+        case 'b':
+            if (in_class) return '\b';
+            *shorthand = e;
+            return -2;
+        case 'B':
+            if (in_class) break;
+            *shorthand = e;
+            return -2;
+        case 'x': {
+            int v = 0, digits = 0;
+            while (digits < 2 && ps->p < ps->end && regex_hex_digit(*ps->p) >= 0) {
+                v = v * 16 + regex_hex_digit(*ps->p++);
+                digits++;
+            }
+            if (digits == 0) {
+                ps->error = "invalid \\x escape";
+                return -1;
+            }
+            return v;
+        }
+        default:
+            break;
+    }
+    return e;
+}
+
+static int regex_parse_class(HmlRegexParser *ps) {
+    int cls = regex_new_class(ps);
+    if (cls < 0) return -1;
+    int negate = 0;
+    if (ps->p < ps->end && *ps->p == '^') {
+        negate = 1;
+        ps->p++;
+    }
+    int first = 1;
+    for (;;) {
+        if (ps->p >= ps->end) {
+            ps->error = "missing ']'";
+            return -1;
+        }
+        int c = *ps->p;
+        if (c == ']' && !first) {
+            ps->p++;
+            break;
+        }
+        first = 0;
+        if (c == '[' && ps->p + 1 < ps->end && ps->p[1] == ':') {
+            const unsigned char *name = ps->p + 2;
+            const unsigned char *q = name;
+            while (q + 1 < ps->end && !(q[0] == ':' && q[1] == ']')) q++;
+            if (q + 1 >= ps->end) {
+                ps->error = "missing ']'";
+                return -1;
+            }
+            if (!regex_add_named_class(&ps->classes[cls], (const char*)name, (int)(q - name))) {
+                ps->error = "invalid character class";
+                return -1;
+            }
+            ps->p = q + 2;
+            continue;
+        }
+
+        int lo = c, shorthand = 0;
+        ps->p++;
+        if (c == '\\') {
+            lo = regex_escape(ps, 1, &shorthand);
+            if (lo == -1) return -1;
+            if (lo == -2) {
+                regex_add_perl_class(&ps->classes[cls], shorthand);
+                continue;
+            }
+        }
+        int hi = lo;
+        if (ps->p + 1 < ps->end && *ps->p == '-' && ps->p[1] != ']') {
+            ps->p++;
+            hi = *ps->p++;
+            if (hi == '\\') {
+                hi = regex_escape(ps, 1, &shorthand);
+                if (hi == -1) return -1;
+            }
+            if (hi < lo) {
+                ps->error = "invalid range in []";
+                return -1;
+            }
+        }
+        for (int b = lo; b <= hi; b++) {
+            regex_class_set(&ps->classes[cls], b);
+        }
+    }
+
+    HmlRegexClass *set = &ps->classes[cls];
+    if (ps->flags & REGEX_ICASE) {
+        for (int c = 'a'; c <= 'z'; c++) {
+            if (regex_class_has(set, c) || regex_class_has(set, c & ~0x20)) {
+                regex_class_set(set, c);
+                regex_class_set(set, c & ~0x20);
+            }
+        }
+    }
+    if (negate) {
+        for (int i = 0; i < 8; i++) set->bits[i] = ~set->bits[i];
+        if (ps->flags & REGEX_NEWLINE) set->bits['\n' >> 5] &= ~(1u << ('\n' & 31));
+    }
+    return regex_class_node(ps, cls);
+}
+
+static int regex_parse_alt(HmlRegexParser *ps);
+
+static int regex_parse_atom(HmlRegexParser *ps) {
+    int c = *ps->p++;
+    switch (c) {
+        case '(': {
+            int group = -1;
+            if (ps->p < ps->end && *ps->p == '?') {
+                if (ps->p + 1 >= ps->end || ps->p[1] != ':') {
+                    ps->error = "invalid group syntax";
+                    return -1;
+                }
+                ps->p += 2;
+            } else {
+                group = ps->ngroups++;
+            }
+            if (++ps->depth > REGEX_MAX_DEPTH) {
+                ps->error = "pattern nested too deeply";
+                return -1;
+            }
+            int inner = regex_parse_alt(ps);
+            ps->depth--;
+            if (inner < 0) return -1;
+            if (ps->p >= ps->end || *ps->p != ')') {
+                ps->error = "missing ')'";
+                return -1;
+            }
+            ps->p++;
+            if (group < 0) return inner;
+            int n = regex_node(ps, RN_GROUP);
+            if (n < 0) return -1;
+            ps->nodes[n].a = inner;
+            ps->nodes[n].b = group;
+            return n;
+        }
+        case '*': case '+': case '?':
+            ps->error = "nothing to repeat";
+            return -1;
+        case '.':
+            return regex_node(ps, RN_ANY);
+        case '^':
+            return regex_node(ps, RN_BOL);
+        case '$':
+            return regex_node(ps, RN_EOL);
+        case '[':
+            return regex_parse_class(ps);
+        case '\\': {
+            int shorthand = 0;
+            int e = regex_escape(ps, 0, &shorthand);
+            if (e == -1) return -1;
+            if (e >= 0) return regex_literal(ps, e);
+            if (shorthand == 'b') return regex_node(ps, RN_WORDB);
+            if (shorthand == 'B') return regex_node(ps, RN_NWORDB);
+            int cls = regex_new_class(ps);
+            if (cls < 0) return -1;
+            regex_add_perl_class(&ps->classes[cls], shorthand);
+            return regex_class_node(ps, cls);
+        }
+        default:
+            return regex_literal(ps, c);
+    }
+}
+
+// Parse "{n}", "{n,}" or "{n,m}" at ps->p. Returns 1 and advances on
+// success, 0 if the brace does not start a count (it is then a literal),
+// -1 on an invalid count.
+static int regex_parse_braces(HmlRegexParser *ps, int *min, int *max) {
+    const unsigned char *q = ps->p + 1;
+    int lo = 0, hi, digits = 0;
+    while (q < ps->end && *q >= '0' && *q <= '9') {
+        if (lo <= REGEX_MAX_REPEAT) lo = lo * 10 + (*q - '0');
+        q++;
+        digits++;
+    }
+    if (digits == 0 || q >= ps->end) return 0;
+    hi = lo;
+    if (*q == ',') {
+        q++;
+        if (q < ps->end && *q >= '0' && *q <= '9') {
+            hi = 0;
+            while (q < ps->end && *q >= '0' && *q <= '9') {
+                if (hi <= REGEX_MAX_REPEAT) hi = hi * 10 + (*q - '0');
+                q++;
+            }
+        } else {
+            hi = -1;
+        }
+    }
+    if (q >= ps->end || *q != '}') return 0;
+    if (lo > REGEX_MAX_REPEAT || hi > REGEX_MAX_REPEAT || (hi >= 0 && hi < lo)) {
+        ps->error = "invalid repetition count";
+        return -1;
+    }
+    ps->p = q + 1;
+    *min = lo;
+    *max = hi;
+    return 1;
+}
+
+static int regex_parse_repeat(HmlRegexParser *ps) {
+    int atom = regex_parse_atom(ps);
+    int stacked = 0;
+    while (atom >= 0 && ps->p < ps->end) {
+        int min, max;
+        int c = *ps->p;
+        if (c == '*') { min = 0; max = -1; ps->p++; }
+        else if (c == '+') { min = 1; max = -1; ps->p++; }
+        else if (c == '?') { min = 0; max = 1; ps->p++; }
+        else if (c == '{') {
+            int r = regex_parse_braces(ps, &min, &max);
+            if (r < 0) return -1;
+            if (r == 0) break;
+        } else {
+            break;
+        }
+        int greedy = 1;
+        if (ps->p < ps->end && *ps->p == '?') {
+            greedy = 0;
+            ps->p++;
+        }
+        if (ps->depth + ++stacked > REGEX_MAX_DEPTH) {
+            ps->error = "pattern nested too deeply";
+            return -1;
+        }
+        int n = regex_node(ps, RN_REPEAT);
+        if (n < 0) return -1;
+        ps->nodes[n].a = atom;
+        ps->nodes[n].min = min;
+        ps->nodes[n].max = max;
+        ps->nodes[n].greedy = (uint8_t)greedy;
+        atom = n;
+    }
+    return atom;
+}
+
+static int regex_parse_cat(HmlRegexParser *ps) {
+    int first = -1, last = -1, count = 0;
+    while (ps->p < ps->end && *ps->p != '|' && *ps->p != ')') {
+        int n = regex_parse_repeat(ps);
+        if (n < 0) return -1;
+        if (first < 0) first = n;
+        else ps->nodes[last].next = n;
+        last = n;
+        count++;
+    }
+    if (count == 0) return regex_node(ps, RN_EMPTY);
+    if (count == 1) return first;
+    int cat = regex_node(ps, RN_CAT);
+    if (cat >= 0) ps->nodes[cat].a = first;
+    return cat;
+}
+
+static int regex_parse_alt(HmlRegexParser *ps) {
+    int first = regex_parse_cat(ps);
+    if (first < 0 || ps->p >= ps->end || *ps->p != '|') return first;
+    int last = first;
+    while (ps->p < ps->end && *ps->p == '|') {
+        ps->p++;
+        int n = regex_parse_cat(ps);
+        if (n < 0) return -1;
+        ps->nodes[last].next = n;
+        last = n;
+    }
+    int alt = regex_node(ps, RN_ALT);
+    if (alt >= 0) ps->nodes[alt].a = first;
+    return alt;
+}
+
+// ========== COMPILER ==========
+
+static int regex_inst(HmlRegexParser *ps, int op, int x, int y) {
+    if (ps->prog_len >= REGEX_MAX_PROG) {
+        ps->error = "pattern too large";
+        return -1;
+    }
+    if (ps->prog_len == ps->prog_cap) {
+        int cap = ps->prog_cap ? ps->prog_cap * 2 : 64;
+        HmlRegexInst *prog = realloc(ps->prog, sizeof(HmlRegexInst) * cap);
+        if (!prog) {
+            ps->error = "out of memory";
+            return -1;
+        }
+        ps->prog = prog;
+        ps->prog_cap = cap;
+    }
+    HmlRegexInst *in = &ps->prog[ps->prog_len];
+    in->op = (uint8_t)op;
+    in->c = 0;
+    in->x = x;
+    in->y = y;
+    return ps->prog_len++;
+}
+
+static int regex_emit(HmlRegexParser *ps, int n) {
+    HmlRegexNode node = ps->nodes[n];
+    int pc;
+    switch (node.type) {
+        case RN_EMPTY:
+            return 0;
+        case RN_CHAR:
+            pc = regex_inst(ps, RI_CHAR, 0, 0);
+            if (pc < 0) return -1;
+            ps->prog[pc].c = node.c;
+            return 0;
+        case RN_ANY:
+            return regex_inst(ps, (ps->flags & REGEX_NEWLINE) ? RI_ANYNL : RI_ANY, 0, 0) < 0 ? -1 : 0;
+        case RN_CLASS:
+            return regex_inst(ps, RI_CLASS, node.a, 0) < 0 ? -1 : 0;
+        case RN_BOL:
+            return regex_inst(ps, RI_BOL, 0, 0) < 0 ? -1 : 0;
+        case RN_EOL:
+            return regex_inst(ps, RI_EOL, 0, 0) < 0 ? -1 : 0;
+        case RN_WORDB:
+            return regex_inst(ps, RI_WORDB, 0, 0) < 0 ? -1 : 0;
+        case RN_NWORDB:
+            return regex_inst(ps, RI_NWORDB, 0, 0) < 0 ? -1 : 0;
+        case RN_CAT:
+            for (int c = node.a; c >= 0; c = ps->nodes[c].next) {
+                if (regex_emit(ps, c) < 0) return -1;
+            }
+            return 0;
+        case RN_ALT: {
+            // split L1, L2; L1: first; jmp end; L2: split ...; last; end:
+            // The pending jumps are chained through their x fields.
+            int jumps = -1;
+            for (int c = node.a; c >= 0; c = ps->nodes[c].next) {
+                if (ps->nodes[c].next < 0) {
+                    if (regex_emit(ps, c) < 0) return -1;
+                    break;
+                }
+                int split = regex_inst(ps, RI_SPLIT, 0, 0);
+                if (split < 0) return -1;
+                ps->prog[split].x = split + 1;
+                if (regex_emit(ps, c) < 0) return -1;
+                int jmp = regex_inst(ps, RI_JMP, jumps, 0);
+                if (jmp < 0) return -1;
+                jumps = jmp;
+                ps->prog[split].y = ps->prog_len;
+            }
+            while (jumps >= 0) {
+                int prev = ps->prog[jumps].x;
+                ps->prog[jumps].x = ps->prog_len;
+                jumps = prev;
+            }
+            return 0;
+        }
+        case RN_GROUP:
+            if (regex_inst(ps, RI_SAVE, node.b * 2, 0) < 0) return -1;
+            if (regex_emit(ps, node.a) < 0) return -1;
+            return regex_inst(ps, RI_SAVE, node.b * 2 + 1, 0) < 0 ? -1 : 0;
+        case RN_REPEAT: {
+            if (node.max < 0) {
+                if (node.min == 0) {
+                    // L: split body, end; body; jmp L; end:
+                    int split = regex_inst(ps, RI_SPLIT, 0, 0);
+                    if (split < 0) return -1;
+                    if (regex_emit(ps, node.a) < 0) return -1;
+                    if (regex_inst(ps, RI_JMP, split, 0) < 0) return -1;
+                    ps->prog[split].x = node.greedy ? split + 1 : ps->prog_len;
+                    ps->prog[split].y = node.greedy ? ps->prog_len : split + 1;
+                    return 0;
+                }
+                // min-1 copies, then L: body; split L, end
+                for (int i = 0; i < node.min - 1; i++) {
+                    if (regex_emit(ps, node.a) < 0) return -1;
+                }
+                int loop = ps->prog_len;
+                if (regex_emit(ps, node.a) < 0) return -1;
+                int split = regex_inst(ps, RI_SPLIT, 0, 0);
+                if (split < 0) return -1;
+                ps->prog[split].x = node.greedy ? loop : split + 1;
+                ps->prog[split].y = node.greedy ? split + 1 : loop;
+                return 0;
+            }
+            for (int i = 0; i < node.min; i++) {
+                if (regex_emit(ps, node.a) < 0) return -1;
+            }
+            // Optional copies all exit to the same end; chained through y
+            int splits = -1;
+            for (int i = node.min; i < node.max; i++) {
+                int split = regex_inst(ps, RI_SPLIT, 0, splits);
+                if (split < 0) return -1;
+                splits = split;
+                if (regex_emit(ps, node.a) < 0) return -1;
+            }
+            while (splits >= 0) {
+                int prev = ps->prog[splits].y;
+                ps->prog[splits].x = node.greedy ? splits + 1 : ps->prog_len;
+                ps->prog[splits].y = node.greedy ? ps->prog_len : splits + 1;
+                splits = prev;
+            }
+            return 0;
+        }
+    }
+    return 0;
+}
+
+static void regex_destroy(HmlRegex *re) {
+    if (!re) return;
+    if (re->dfa_table) {
+        for (int i = 0; i < REGEX_DFA_BUCKETS; i++) {
+            HmlRegexDfaState *s = re->dfa_table[i];
+            while (s) {
+                HmlRegexDfaState *next = s->chain;
+                free(s->pcs);
+                free(s);
+                s = next;
+            }
+        }
+        free(re->dfa_table);
+    }
+    pthread_mutex_destroy(&re->dfa_lock);
+    free(re->dfa_mark);
+    free(re->dfa_stack);
+    free(re->dfa_set);
+    free(re->pattern);
+    free(re->prog);
+    free(re->classes);
+    free(re->prefix);
+    free(re);
+}
+
+// Compile a pattern. On failure returns NULL and sets *error to a static
+// message.
+static HmlRegex* regex_compile(const char *pattern, int len, int flags, const char **error) {
+    HmlRegexParser ps;
+    memset(&ps, 0, sizeof(ps));
+    ps.p = (const unsigned char*)pattern;
+    ps.end = ps.p + len;
+    ps.flags = flags;
+    ps.ngroups = 1;
+
+    int root = regex_parse_alt(&ps);
+    if (root >= 0 && ps.p < ps.end) {
+        ps.error = "unmatched ')'";
+        root = -1;
+    }
+    if (root >= 0 && (regex_inst(&ps, RI_SAVE, 0, 0) < 0 || regex_emit(&ps, root) < 0 ||
+                      regex_inst(&ps, RI_SAVE, 1, 0) < 0 || regex_inst(&ps, RI_MATCH, 0, 0) < 0)) {
+        root = -1;
+    }
+    free(ps.nodes);
+
+    HmlRegex *re = root >= 0 ? calloc(1, sizeof(HmlRegex)) : NULL;
+    if (!re) {
+        *error = ps.error ? ps.error : "out of memory";
+        free(ps.prog);
+        free(ps.classes);
+        return NULL;
+    }
+    re->pattern = malloc(len + 1);
+    memcpy(re->pattern, pattern, len);
+    re->pattern[len] = '\0';
+    re->pattern_len = len;
+    re->flags = flags;
+    re->prog = ps.prog;
+    re->prog_len = ps.prog_len;
+    re->classes = ps.classes;
+    re->nclasses = ps.nclasses;
+    re->ngroups = ps.ngroups;
+    re->refcount = 1;
+    pthread_mutex_init(&re->dfa_lock, NULL);
+
+    // Literal prefix: the bytes on the forced path from the start
+    int pc = 0;
+    while (pc < re->prog_len && re->prog[pc].op == RI_SAVE) pc++;
+    re->anchored = re->prog[pc].op == RI_BOL && !(flags & REGEX_NEWLINE);
+    int n = 0;
+    re->prefix = malloc(re->prog_len + 1);
+    for (; pc < re->prog_len; pc++) {
+        if (re->prog[pc].op == RI_CHAR) re->prefix[n++] = (char)re->prog[pc].c;
+        else if (re->prog[pc].op != RI_SAVE) break;
+    }
+    re->prefix_len = n;
+
+    for (int i = 0; i < re->prog_len; i++) {
+        int op = re->prog[i].op;
+        if (op == RI_BOL) re->dfa_ctx_mask |= REGEX_CTX_BOL;
+        if (op == RI_WORDB || op == RI_NWORDB) re->dfa_ctx_mask |= REGEX_CTX_WORD;
+    }
+    return re;
+}
+
+// ========== PIKE VM ==========
+
+int hml_re_vm_init(HmlRegexVM *vm, const HmlRegex *re) {
+    int n = re->prog_len;
+    vm->ncap = re->ngroups * 2;
+    for (int i = 0; i < 2; i++) {
+        vm->lists[i].n = 0;
+        vm->lists[i].dense = malloc(sizeof(int) * n);
+        vm->lists[i].sparse = calloc(n, sizeof(int));
+        vm->lists[i].caps = malloc(sizeof(int) * n * vm->ncap);
+    }
+    vm->cur = malloc(sizeof(int) * vm->ncap);
+    vm->init = malloc(sizeof(int) * vm->ncap);
+    vm->stack = malloc(sizeof(int) * 2 * (n + 1));
+    if (!vm->lists[0].dense || !vm->lists[0].sparse || !vm->lists[0].caps ||
+        !vm->lists[1].dense || !vm->lists[1].sparse || !vm->lists[1].caps ||
+        !vm->cur || !vm->init || !vm->stack) {
+        return 0;
+    }
+    for (int i = 0; i < vm->ncap; i++) vm->init[i] = -1;
+    return 1;
+}
+
+void hml_re_vm_free(HmlRegexVM *vm) {
+    for (int i = 0; i < 2; i++) {
+        free(vm->lists[i].dense);
+        free(vm->lists[i].sparse);
+        free(vm->lists[i].caps);
+    }
+    free(vm->cur);
+    free(vm->init);
+    free(vm->stack);
+}
+
+static int regex_assert(const HmlRegex *re, int op, const unsigned char *text, int len, int pos) {
+    int multiline = re->flags & REGEX_NEWLINE;
+    switch (op) {
+        case RI_BOL:
+            return pos == 0 || (multiline && text[pos - 1] == '\n');
+        case RI_EOL:
+            return pos == len || (multiline && text[pos] == '\n');
+        default: {
+            int before = pos > 0 && regex_is_word(text[pos - 1]);
+            int after = pos < len && regex_is_word(text[pos]);
+            return (before != after) == (op == RI_WORDB);
+        }
+    }
+}
+
+// Add the thread at pc0 and everything reachable from it without consuming
+// input, in priority order. Capture slots are updated on the way and
+// restored on backtrack through restore entries on the work stack.
+static void regex_addthread(const HmlRegex *re, HmlRegexVM *vm, HmlRegexThreads *l, int pc0, const int *caps,
+                            const unsigned char *text, int len, int pos) {
+    int ncap = vm->ncap;
+    int *cur = vm->cur;
+    int *stack = vm->stack;
+    int sp = 0;
+    memcpy(cur, caps, sizeof(int) * ncap);
+    stack[sp++] = pc0;
+    stack[sp++] = 0;
+    while (sp > 0) {
+        sp -= 2;
+        int pc = stack[sp];
+        if (pc < 0) {
+            cur[-pc - 1] = stack[sp + 1];
+            continue;
+        }
+        for (;;) {
+            int i = l->sparse[pc];
+            if (i < l->n && l->dense[i] == pc) break;
+            i = l->n++;
+            l->sparse[pc] = i;
+            l->dense[i] = pc;
+            const HmlRegexInst *in = &re->prog[pc];
+            if (in->op == RI_JMP) {
+                pc = in->x;
+            } else if (in->op == RI_SPLIT) {
+                stack[sp++] = in->y;
+                stack[sp++] = 0;
+                pc = in->x;
+            } else if (in->op == RI_SAVE) {
+                stack[sp++] = -in->x - 1;
+                stack[sp++] = cur[in->x];
+                cur[in->x] = pos;
+                pc++;
+            } else if (in->op >= RI_BOL) {
+                if (!regex_assert(re, in->op, text, len, pos)) break;
+                pc++;
+            } else {
+                memcpy(&l->caps[i * ncap], cur, sizeof(int) * ncap);
+                break;
+            }
+        }
+    }
+}
+
+// Next position >= pos where the literal prefix occurs, or -1
+static int regex_skip(const HmlRegex *re, const unsigned char *text, int len, int pos) {
+    if (pos >= len) return -1;
+    const unsigned char *hit;
+    if (re->prefix_len == 1) {
+        hit = memchr(text + pos, (unsigned char)re->prefix[0], len - pos);
+    } else {
+        hit = memmem(text + pos, len - pos, re->prefix, re->prefix_len);
+    }
+    return hit ? (int)(hit - text) : -1;
+}
+
+// Find the leftmost-first match starting at or after start. On success
+// fills out with 2 * ngroups slots (-1 for groups that did not take part).
+int hml_re_search(const HmlRegex *re, HmlRegexVM *vm, const unsigned char *text, int len, int start, int *out) {
+    HmlRegexThreads *clist = &vm->lists[0], *nlist = &vm->lists[1];
+    int ncap = vm->ncap;
+    int matched = 0;
+    clist->n = 0;
+    for (int pos = start; pos <= len; pos++) {
+        if (!matched && (!re->anchored || pos == start)) {
+            if (clist->n == 0 && re->prefix_len > 0 && !re->anchored) {
+                pos = regex_skip(re, text, len, pos);
+                if (pos < 0) break;
+            }
+            regex_addthread(re, vm, clist, 0, vm->init, text, len, pos);
+        }
+        if (clist->n == 0) break;
+        int c = pos < len ? text[pos] : -1;
+        nlist->n = 0;
+        for (int i = 0; i < clist->n; i++) {
+            const HmlRegexInst *in = &re->prog[clist->dense[i]];
+            const int *tc = &clist->caps[i * ncap];
+            int step = 0;
+            switch (in->op) {
+                case RI_MATCH:
+                    // Lower-priority threads can only produce worse matches
+                    matched = 1;
+                    memcpy(out, tc, sizeof(int) * ncap);
+                    i = clist->n;
+                    break;
+                case RI_CHAR: step = c == in->c; break;
+                case RI_ANY: step = c >= 0; break;
+                case RI_ANYNL: step = c >= 0 && c != '\n'; break;
+                case RI_CLASS: step = c >= 0 && regex_class_has(&re->classes[in->x], c); break;
+                default: break;
+            }
+            if (step) regex_addthread(re, vm, nlist, clist->dense[i] + 1, tc, text, len, pos + 1);
+        }
+        HmlRegexThreads *t = clist;
+        clist = nlist;
+        nlist = t;
+    }
+    return matched;
+}
+
+// ========== LAZY DFA ==========
+
+static void regex_dfa_flush(HmlRegex *re) {
+    for (int i = 0; i < REGEX_DFA_BUCKETS; i++) {
+        HmlRegexDfaState *s = re->dfa_table[i];
+        while (s) {
+            HmlRegexDfaState *next = s->chain;
+            free(s->pcs);
+            free(s);
+            s = next;
+        }
+        re->dfa_table[i] = NULL;
+    }
+    re->dfa_count = 0;
+    memset(re->dfa_start, 0, sizeof(re->dfa_start));
+}
+
+static int regex_int_cmp(const void *a, const void *b) {
+    return *(const int*)a - *(const int*)b;
+}
+
+// Intern the state for a sorted pc set. Returns NULL when the state budget
+// is exhausted.
+static HmlRegexDfaState* regex_dfa_state(HmlRegex *re, const int *pcs, int npcs, int ctx) {
+    uint32_t h = 2166136261u ^ (uint32_t)ctx;
+    for (int i = 0; i < npcs; i++) h = (h ^ (uint32_t)pcs[i]) * 16777619u;
+    HmlRegexDfaState **bucket = &re->dfa_table[h % REGEX_DFA_BUCKETS];
+    for (HmlRegexDfaState *s = *bucket; s; s = s->chain) {
+        if (s->hash == h && s->ctx == ctx && s->npcs == npcs &&
+            memcmp(s->pcs, pcs, sizeof(int) * npcs) == 0) {
+            return s;
+        }
+    }
+    if (re->dfa_count >= REGEX_DFA_STATES) return NULL;
+    HmlRegexDfaState *s = calloc(1, sizeof(HmlRegexDfaState));
+    if (!s) return NULL;
+    s->pcs = malloc(sizeof(int) * (npcs ? npcs : 1));
+    if (!s->pcs) {
+        free(s);
+        return NULL;
+    }
+    memcpy(s->pcs, pcs, sizeof(int) * npcs);
+    s->npcs = npcs;
+    s->ctx = ctx;
+    s->hash = h;
+    s->chain = *bucket;
+    *bucket = s;
+    re->dfa_count++;
+    return s;
+}
+
+static HmlRegexDfaState* regex_dfa_start(HmlRegex *re, int ctx) {
+    ctx &= re->dfa_ctx_mask;
+    if (!re->dfa_start[ctx]) {
+        int pc0 = 0;
+        re->dfa_start[ctx] = regex_dfa_state(re, &pc0, 1, ctx);
+    }
+    return re->dfa_start[ctx];
+}
+
+// Compute the transition of s on byte c (REGEX_DFA_END at the end of the
+// text): follow the empty-width closure of the pending threads in the
+// context between the previous byte and c, then step the threads that
+// accept c.
+static HmlRegexDfaState* regex_dfa_step(HmlRegex *re, HmlRegexDfaState *s, int c) {
+    int multiline = re->flags & REGEX_NEWLINE;
+    int *mark = re->dfa_mark;
+    int *stack = re->dfa_stack;
+    int *set = re->dfa_set;
+    int stamp = ++re->dfa_stamp;
+    int sp = 0, n = 0;
+
+    for (int i = s->npcs - 1; i >= 0; i--) stack[sp++] = s->pcs[i];
+    while (sp > 0) {
+        int pc = stack[--sp];
+        if (mark[pc] == stamp) continue;
+        mark[pc] = stamp;
+        const HmlRegexInst *in = &re->prog[pc];
+        int ok = 0;
+        switch (in->op) {
+            case RI_MATCH:
+                return REGEX_DFA_MATCH;
+            case RI_JMP:
+                stack[sp++] = in->x;
+                continue;
+            case RI_SPLIT:
+                stack[sp++] = in->y;
+                stack[sp++] = in->x;
+                continue;
+            case RI_SAVE:
+                stack[sp++] = pc + 1;
+                continue;
+            case RI_BOL:
+                ok = (s->ctx & REGEX_CTX_BOL) != 0;
+                break;
+            case RI_EOL:
+                ok = c == REGEX_DFA_END || (multiline && c == '\n');
+                break;
+            case RI_WORDB:
+            case RI_NWORDB: {
+                int before = (s->ctx & REGEX_CTX_WORD) != 0;
+                int after = c != REGEX_DFA_END && regex_is_word(c);
+                ok = (before != after) == (in->op == RI_WORDB);
+                break;
+            }
+            default:
+                if (c == REGEX_DFA_END) continue;
+                if (in->op == RI_CHAR) ok = c == in->c;
+                else if (in->op == RI_ANY) ok = 1;
+                else if (in->op == RI_ANYNL) ok = c != '\n';
+                else ok = regex_class_has(&re->classes[in->x], c);
+                if (ok) set[n++] = pc + 1;
+                continue;
+        }
+        if (ok) stack[sp++] = pc + 1;
+    }
+
+    if (c == REGEX_DFA_END) return REGEX_DFA_DEAD;
+    if (!re->anchored) set[n++] = 0;
+    if (n == 0) return REGEX_DFA_DEAD;
+    qsort(set, n, sizeof(int), regex_int_cmp);
+    int u = 1;
+    for (int i = 1; i < n; i++) {
+        if (set[i] != set[u - 1]) set[u++] = set[i];
+    }
+    int ctx = ((multiline && c == '\n') ? REGEX_CTX_BOL : 0) | (regex_is_word(c) ? REGEX_CTX_WORD : 0);
+    return regex_dfa_state(re, set, u, ctx & re->dfa_ctx_mask);
+}
+
+// Run the DFA over the whole text. Returns 1 on a match, 0 if there is
+// none, or -1 when the state budget ran out (the cache is then flushed and
+// the caller falls back to the Pike VM). Called with dfa_lock held.
+static int regex_dfa_test(HmlRegex *re, const unsigned char *text, int len) {
+    if (!re->dfa_table) {
+        re->dfa_table = calloc(REGEX_DFA_BUCKETS, sizeof(HmlRegexDfaState*));
+        re->dfa_mark = calloc(re->prog_len, sizeof(int));
+        re->dfa_stack = malloc(sizeof(int) * (3 * re->prog_len + 1));
+        re->dfa_set = malloc(sizeof(int) * (re->prog_len + 1));
+        if (!re->dfa_table || !re->dfa_mark || !re->dfa_stack || !re->dfa_set) return -1;
+    }
+    HmlRegexDfaState *s = regex_dfa_start(re, REGEX_CTX_BOL);
+    for (int pos = 0; s && pos <= len; pos++) {
+        if (re->prefix_len > 0 && !re->anchored && s == re->dfa_start[s->ctx]) {
+            int hit = regex_skip(re, text, len, pos);
+            if (hit < 0) return 0;
+            if (hit != pos) {
+                int prev = text[hit - 1];
+                int ctx = ((re->flags & REGEX_NEWLINE) && prev == '\n' ? REGEX_CTX_BOL : 0) |
+                          (regex_is_word(prev) ? REGEX_CTX_WORD : 0);
+                pos = hit;
+                s = regex_dfa_start(re, ctx);
+                if (!s) break;
+            }
+        }
+        int c = pos < len ? text[pos] : REGEX_DFA_END;
+        HmlRegexDfaState *next = s->next[c];
+        if (!next) {
+            next = regex_dfa_step(re, s, c);
+            if (!next) break;
+            s->next[c] = next;
+        }
+        if (next == REGEX_DFA_MATCH) return 1;
+        if (next == REGEX_DFA_DEAD) return 0;
+        s = next;
+    }
+    regex_dfa_flush(re);
+    return -1;
+}
+
+int hml_re_test(HmlRegex *re, const unsigned char *text, int len) {
+    if (pthread_mutex_trylock(&re->dfa_lock) == 0) {
+        int r = regex_dfa_test(re, text, len);
+        pthread_mutex_unlock(&re->dfa_lock);
+        if (r >= 0) return r;
+    }
+    // Another thread owns the DFA, or it outgrew its budget
+    HmlRegexVM vm;
+    int found = 0;
+    if (hml_re_vm_init(&vm, re)) {
+        int *caps = malloc(sizeof(int) * vm.ncap);
+        if (caps) found = hml_re_search(re, &vm, text, len, 0, caps);
+        free(caps);
+    }
+    hml_re_vm_free(&vm);
+    return found;
+}
+
+// Advance an iteration over successive non-overlapping matches. An empty
+// match right after the previous match is skipped.
+int hml_re_next(const HmlRegex *re, HmlRegexVM *vm, const unsigned char *text, int len,
+                int *pos, int *prev_end, int *caps) {
+    while (*pos <= len) {
+        if (!hml_re_search(re, vm, text, len, *pos, caps)) return 0;
+        int s = caps[0], e = caps[1];
+        if (s == e && s == *prev_end) {
+            *pos = s + 1;
+            continue;
+        }
+        *prev_end = e;
+        *pos = e > s ? e : e + 1;
+        return 1;
+    }
+    return 0;
+}
+
+// ========== PATTERN CACHE ==========
+
+static HmlRegex *regex_cache[REGEX_CACHE_SIZE];
+static uint64_t regex_cache_used[REGEX_CACHE_SIZE];
+static uint64_t regex_cache_tick = 0;
+static pthread_mutex_t regex_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void hml_re_retain(HmlRegex *re) {
+    pthread_mutex_lock(&regex_cache_lock);
+    re->refcount++;
+    pthread_mutex_unlock(&regex_cache_lock);
+}
+
+void hml_re_release(HmlRegex *re) {
+    pthread_mutex_lock(&regex_cache_lock);
+    int dead = --re->refcount == 0;
+    pthread_mutex_unlock(&regex_cache_lock);
+    if (dead) regex_destroy(re);
+}
+
+// Look up or compile a pattern. The caller owns one reference.
+HmlRegex* hml_re_acquire(const char *pattern, int len, int flags, const char **error) {
+    pthread_mutex_lock(&regex_cache_lock);
+    for (int i = 0; i < REGEX_CACHE_SIZE; i++) {
+        HmlRegex *re = regex_cache[i];
+        if (re && re->flags == flags && re->pattern_len == len && memcmp(re->pattern, pattern, len) == 0) {
+            regex_cache_used[i] = ++regex_cache_tick;
+            re->refcount++;
+            pthread_mutex_unlock(&regex_cache_lock);
+            return re;
+        }
+    }
+    pthread_mutex_unlock(&regex_cache_lock);
+
+    HmlRegex *re = regex_compile(pattern, len, flags, error);
+    if (!re) return NULL;
+
+    HmlRegex *evicted = NULL;
+    pthread_mutex_lock(&regex_cache_lock);
+    int slot = 0;
+    for (int i = 0; i < REGEX_CACHE_SIZE; i++) {
+        if (!regex_cache[i]) {
+            slot = i;
+            break;
+        }
+        if (regex_cache_used[i] < regex_cache_used[slot]) slot = i;
+    }
+    if (regex_cache[slot] && --regex_cache[slot]->refcount == 0) evicted = regex_cache[slot];
+    regex_cache[slot] = re;
+    regex_cache_used[slot] = ++regex_cache_tick;
+    re->refcount++;
+    pthread_mutex_unlock(&regex_cache_lock);
+    regex_destroy(evicted);
+    return re;
+}
+
+int hml_re_groups(const HmlRegex *re) {
+    return re->ngroups;
+}
+
+// ========== REPLACEMENT ==========
+
+void hml_re_out(HmlRegexOut *out, const char *s, int n) {
+    if (out->failed) return;
+    if (out->len + n + 1 > out->cap) {
+        int cap = out->cap ? out->cap : 64;
+        while (cap < out->len + n + 1) cap *= 2;
+        char *data = realloc(out->data, cap);
+        if (!data) {
+            out->failed = 1;
+            return;
+        }
+        out->data = data;
+        out->cap = cap;
+    }
+    memcpy(out->data + out->len, s, n);
+    out->len += n;
+    out->data[out->len] = '\0';
+}
+
+void hml_re_expand(HmlRegexOut *out, const char *repl, int repl_len, const char *text, const int *caps, int ngroups) {
+    int i = 0;
+    while (i < repl_len) {
+        const char *dollar = memchr(repl + i, '$', repl_len - i);
+        int lit = dollar ? (int)(dollar - repl) - i : repl_len - i;
+        hml_re_out(out, repl + i, lit);
+        i += lit;
+        if (i >= repl_len) break;
+        int group = -1, j = i + 1;
+        if (j < repl_len && repl[j] == '$') {
+            hml_re_out(out, "$", 1);
+            i = j + 1;
+            continue;
+        }
+        if (j < repl_len && repl[j] >= '0' && repl[j] <= '9') {
+            group = repl[j] - '0';
+            j++;
+        } else if (j < repl_len && repl[j] == '{') {
+            int k = j + 1, v = 0;
+            while (k < repl_len && repl[k] >= '0' && repl[k] <= '9' && v < 100000) v = v * 10 + (repl[k++] - '0');
+            if (k > j + 1 && k < repl_len && repl[k] == '}') {
+                group = v;
+                j = k + 1;
+            }
+        }
+        if (group < 0) {
+            hml_re_out(out, "$", 1);
+            i++;
+            continue;
+        }
+        if (group < ngroups && caps[group * 2] >= 0) {
+            hml_re_out(out, text + caps[group * 2], caps[group * 2 + 1] - caps[group * 2]);
+        }
+        i = j;
+    }
+}
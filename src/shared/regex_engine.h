@@ -0,0 +1,77 @@
+/*
+ * Hemlock Regular Expression Engine
+ *
+ * Pattern compilation and matching shared by the interpreter and the
+ * runtime library. Nothing here knows about Hemlock values: texts are byte
+ * ranges and matches are capture slot arrays, 2 * groups ints holding start
+ * and end offsets (-1 for a group that did not take part).
+ */
+
+#ifndef HEMLOCK_REGEX_ENGINE_H
+#define HEMLOCK_REGEX_ENGINE_H
+
+typedef struct HmlRegex HmlRegex;
+
+typedef struct {
+    int n;
+    int *dense;         // Thread pcs in priority order
+    int *sparse;        // pc -> index into dense
+    int *caps;          // Capture slots, ncap per dense entry
+} HmlRegexThreads;
+
+// Scratch space for searches; one per thread at a time
+typedef struct {
+    HmlRegexThreads lists[2];
+    int *cur;           // Slots of the thread being expanded
+    int *init;          // All -1
+    int *stack;         // addthread work stack of (pc, value) pairs
+    int ncap;
+} HmlRegexVM;
+
+// Growable output string for replacements; failed is set when an
+// allocation fails, after which appends are ignored
+typedef struct {
+    char *data;
+    int len;
+    int cap;
+    int failed;
+} HmlRegexOut;
+
+/*
+ * Look up a compiled pattern in the cache, compiling it on a miss. The
+ * caller owns one reference. On failure returns NULL and sets *error to a
+ * static message.
+ */
+HmlRegex* hml_re_acquire(const char *pattern, int len, int flags, const char **error);
+void hml_re_retain(HmlRegex *re);
+void hml_re_release(HmlRegex *re);
+
+// Number of groups, including group 0 (the whole match)
+int hml_re_groups(const HmlRegex *re);
+
+// Whether the pattern matches anywhere in text
+int hml_re_test(HmlRegex *re, const unsigned char *text, int len);
+
+// Returns 0 when out of memory; hml_re_vm_free is safe either way
+int hml_re_vm_init(HmlRegexVM *vm, const HmlRegex *re);
+void hml_re_vm_free(HmlRegexVM *vm);
+
+// Leftmost-first match starting at or after start, filling caps
+int hml_re_search(const HmlRegex *re, HmlRegexVM *vm, const unsigned char *text, int len, int start, int *caps);
+
+/*
+ * Successive non-overlapping matches: start with *pos = 0 and
+ * *prev_end = -1 and call until it returns 0. An empty match right after
+ * the previous match is skipped.
+ */
+int hml_re_next(const HmlRegex *re, HmlRegexVM *vm, const unsigned char *text, int len,
+                int *pos, int *prev_end, int *caps);
+
+// Append bytes to a replacement
+void hml_re_out(HmlRegexOut *out, const char *s, int n);
+
+// Append the replacement for one match: $0-$9 and ${n} insert groups, $$
+// inserts a dollar sign
+void hml_re_expand(HmlRegexOut *out, const char *repl, int repl_len, const char *text, const int *caps, int ngroups);
+
+#endif // HEMLOCK_REGEX_ENGINE_H
@@ -0,0 +1,146 @@
+/*
+ * Hemlock send_file Core
+ *
+ * The value-independent half of socket.send_file(), compiled into both the
+ * interpreter and the runtime library: the sendfile(2)/splice(2) ladder and
+ * its userspace copy fallback.
+ */
+
+#define _GNU_SOURCE  // For splice()
+#include "send_file_core.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+#define SEND_FILE_CHUNK 0x7ffff000  // Largest transfer Linux accepts per call
+
+// Copy through a userspace buffer when the kernel can't do it for us.
+// Positional reads keep the source offset stateless, so a short send just
+// reports fewer bytes.
+static int64_t send_file_copy(int sock_fd, int in_fd, int64_t offset, int64_t length, int *err) {
+    char buf[65536];
+    int64_t sent = 0;
+    while (length < 0 || sent < length) {
+        size_t want = sizeof(buf);
+        if (length >= 0 && (int64_t)want > length - sent) want = (size_t)(length - sent);
+        ssize_t n = offset >= 0 ? pread(in_fd, buf, want, (off_t)(offset + sent))
+                                : read(in_fd, buf, want);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            *err = errno;
+            return -1;
+        }
+        if (n == 0) break;
+
+        ssize_t off = 0;
+        while (off < n) {
+            ssize_t w = send(sock_fd, buf + off, (size_t)(n - off), MSG_NOSIGNAL);
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) return sent + off;
+                *err = errno;
+                return -1;
+            }
+            off += w;
+        }
+        sent += n;
+    }
+    return sent;
+}
+
+int64_t send_file_fd(int sock_fd, int in_fd, int64_t offset, int64_t length, int *err) {
+    struct stat st;
+    if (fstat(in_fd, &st) < 0) {
+        *err = errno;
+        return -1;
+    }
+
+    if (S_ISFIFO(st.st_mode)) {
+        // A pipe can't be read at an offset; don't silently start elsewhere
+        if (offset != 0) {
+            *err = ESPIPE;
+            return -1;
+        }
+#ifdef __linux__
+        int64_t sent = 0;
+        while (length < 0 || sent < length) {
+            size_t want = SEND_FILE_CHUNK;
+            if (length >= 0 && (int64_t)want > length - sent) want = (size_t)(length - sent);
+            ssize_t n = splice(in_fd, NULL, sock_fd, NULL, want,
+                               SPLICE_F_MOVE | SPLICE_F_MORE | SPLICE_F_NONBLOCK);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN) {
+                    // Either the pipe is empty or the socket is full. Wait
+                    // for the side that isn't ready, unless the socket is
+                    // non-blocking, in which case report partial progress.
+                    struct pollfd pfds[2] = {
+                        { .fd = in_fd, .events = POLLIN },
+                        { .fd = sock_fd, .events = POLLOUT },
+                    };
+                    poll(pfds, 2, 0);
+                    int socket_full = !(pfds[1].revents & POLLOUT);
+                    if (!socket_full && pfds[0].revents) continue;
+                    int sock_flags = fcntl(sock_fd, F_GETFL);
+                    if (sock_flags >= 0 && (sock_flags & O_NONBLOCK)) break;
+                    poll(&pfds[socket_full ? 1 : 0], 1, -1);
+                    continue;
+                }
+                if (errno == EINVAL && sent == 0) {
+                    return send_file_copy(sock_fd, in_fd, -1, length, err);
+                }
+                *err = errno;
+                return -1;
+            }
+            if (n == 0) break;  // Writer closed the pipe
+            sent += n;
+        }
+        return sent;
+#else
+        return send_file_copy(sock_fd, in_fd, -1, length, err);
+#endif
+    }
+
+    if (!S_ISREG(st.st_mode) && !S_ISBLK(st.st_mode)) {
+        *err = EINVAL;
+        return -1;
+    }
+
+    if (length < 0) {
+        length = st.st_size > offset ? st.st_size - offset : 0;
+    }
+
+#ifdef __linux__
+    int64_t sent = 0;
+    off_t pos = (off_t)offset;
+    while (sent < length) {
+        size_t want = SEND_FILE_CHUNK;
+        if ((int64_t)want > length - sent) want = (size_t)(length - sent);
+        ssize_t n = sendfile(sock_fd, in_fd, &pos, want);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            if ((errno == EINVAL || errno == ENOSYS) && sent == 0) {
+                // Filesystem or socket type without sendfile support
+                return send_file_copy(sock_fd, in_fd, offset, length, err);
+            }
+            *err = errno;
+            return -1;
+        }
+        if (n == 0) break;  // File shrank underneath us
+        sent += n;
+    }
+    return sent;
+#else
+    return send_file_copy(sock_fd, in_fd, offset, length, err);
+#endif
+}
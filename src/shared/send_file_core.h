@@ -0,0 +1,23 @@
+/*
+ * Hemlock send_file Core
+ *
+ * Zero-copy file-to-socket transfer for socket.send_file(), shared by the
+ * interpreter and the runtime library.
+ */
+
+#ifndef HEMLOCK_SEND_FILE_CORE_H
+#define HEMLOCK_SEND_FILE_CORE_H
+
+#include <stdint.h>
+
+/*
+ * Send length bytes of in_fd starting at offset (length < 0: to EOF).
+ * Regular files use sendfile(2) and pipes use splice(2), falling back to a
+ * userspace copy where the kernel can't do either. Pipes are read from
+ * their current position, so a nonzero offset fails with ESPIPE. Stops
+ * early, returning the bytes sent so far, when a non-blocking socket would
+ * block. Returns -1 with *err set to an errno value on failure.
+ */
+int64_t send_file_fd(int sock_fd, int in_fd, int64_t offset, int64_t length, int *err);
+
+#endif // HEMLOCK_SEND_FILE_CORE_H
@@ -0,0 +1,617 @@
+/*
+ * Hemlock Subprocess Core
+ *
+ * The value-independent half of @stdlib/process, compiled into both the
+ * interpreter and the runtime library. A child is started with
+ * posix_spawnp() and each of its stdin, stdout and stderr is inherited,
+ * redirected to /dev/null or a file, or connected to a pipe held by the
+ * parent. Piped output is read in pieces (optionally with a poll() timeout)
+ * or line by line, and a child's stdin can be fed straight from another
+ * child's stdout pipe so pipelines never pass data through Hemlock.
+ */
+
+#define _GNU_SOURCE
+#include "subprocess_core.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+extern char **environ;
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+#define PROC_HAVE_ADDCHDIR 1
+#endif
+
+#define PROC_READ_CHUNK  65536
+
+// ========== SPAWNING ==========
+
+static int proc_pipe(int fds[2]) {
+#ifdef __linux__
+    return pipe2(fds, O_CLOEXEC);
+#else
+    if (pipe(fds) < 0) {
+        return -1;
+    }
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return 0;
+#endif
+}
+
+Process* proc_spawn(char *const argv[], char *const envp[], const char *cwd,
+                    ProcRedirect redir[3], char *err, size_t err_len) {
+    int parent_end[3] = {-1, -1, -1};
+    int child_end[3] = {-1, -1, -1};
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawnattr_init(&attr);
+    int rc = 0;
+
+    for (int i = 0; i < 3 && rc == 0; i++) {
+        switch (redir[i].kind) {
+            case PROC_PIPE: {
+                int fds[2];
+                if (proc_pipe(fds) < 0) {
+                    rc = errno;
+                    break;
+                }
+                // The child reads stdin from fds[0] and writes output to fds[1]
+                parent_end[i] = i == 0 ? fds[1] : fds[0];
+                child_end[i] = i == 0 ? fds[0] : fds[1];
+                rc = posix_spawn_file_actions_adddup2(&actions, child_end[i], i);
+                break;
+            }
+            case PROC_NULL:
+                rc = posix_spawn_file_actions_addopen(&actions, i, "/dev/null",
+                                                      i == 0 ? O_RDONLY : O_WRONLY, 0);
+                break;
+            case PROC_FD:
+                rc = posix_spawn_file_actions_adddup2(&actions, redir[i].fd, i);
+                break;
+            case PROC_STDOUT:
+                rc = posix_spawn_file_actions_adddup2(&actions, 1, 2);
+                break;
+            default:
+                break;
+        }
+    }
+    if (rc == 0 && cwd) {
+#ifdef PROC_HAVE_ADDCHDIR
+        rc = posix_spawn_file_actions_addchdir_np(&actions, cwd);
+#else
+        rc = ENOTSUP;
+#endif
+    }
+
+    // The child starts with no blocked signals and default handling for the
+    // signals an embedding program commonly ignores
+    sigset_t mask, defaults;
+    sigemptyset(&mask);
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGPIPE);
+    sigaddset(&defaults, SIGINT);
+    sigaddset(&defaults, SIGQUIT);
+    sigaddset(&defaults, SIGTERM);
+    sigaddset(&defaults, SIGCHLD);
+    posix_spawnattr_setsigmask(&attr, &mask);
+    posix_spawnattr_setsigdefault(&attr, &defaults);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    pid_t pid = -1;
+    if (rc == 0) {
+        rc = posix_spawnp(&pid, argv[0], &actions, &attr, argv, envp ? envp : environ);
+    }
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+
+    for (int i = 0; i < 3; i++) {
+        if (child_end[i] >= 0) {
+            close(child_end[i]);
+        }
+        if (redir[i].own_fd) {
+            close(redir[i].fd);
+            redir[i].own_fd = 0;
+        }
+    }
+
+    Process *proc = rc == 0 ? calloc(1, sizeof(Process)) : NULL;
+    if (!proc) {
+        for (int i = 0; i < 3; i++) {
+            if (parent_end[i] >= 0) {
+                close(parent_end[i]);
+            }
+        }
+        if (rc == 0) {
+            // Started, but there is nothing to track it with
+            kill(pid, SIGKILL);
+            waitpid(pid, NULL, 0);
+            rc = ENOMEM;
+        }
+        snprintf(err, err_len, "%s: %s", argv[0], strerror(rc));
+        return NULL;
+    }
+
+    proc->pid = pid;
+    proc->in_fd = parent_end[0];
+    proc->out.fd = parent_end[1];
+    proc->out.eof = parent_end[1] < 0;
+    proc->err.fd = parent_end[2];
+    proc->err.eof = parent_end[2] < 0;
+
+    // The upstream process's pipe now belongs to this child alone
+    if (redir[0].from) {
+        close(redir[0].from->out.fd);
+        redir[0].from->out.fd = -1;
+        redir[0].from->out.eof = 1;
+    }
+    return proc;
+}
+
+// ========== READING ==========
+
+// Wait up to timeout_ms for fd to become readable (or reach EOF).
+// Returns 1 when readable, 0 on timeout, -1 on error.
+static int proc_wait_readable(int fd, int timeout_ms) {
+    struct pollfd p = { .fd = fd, .events = POLLIN };
+    for (;;) {
+        int n = poll(&p, 1, timeout_ms);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        return n < 0 ? -1 : n > 0;
+    }
+}
+
+ssize_t proc_stream_read(ProcStream *s, char *out, size_t max, int timeout_ms) {
+    if (s->end > s->start) {
+        size_t n = s->end - s->start < max ? s->end - s->start : max;
+        memcpy(out, s->buf + s->start, n);
+        s->start += n;
+        return (ssize_t)n;
+    }
+    if (s->eof || s->fd < 0) {
+        return 0;
+    }
+    if (timeout_ms >= 0) {
+        int ready = proc_wait_readable(s->fd, timeout_ms);
+        if (ready <= 0) {
+            return ready == 0 ? -2 : -1;
+        }
+    }
+    for (;;) {
+        ssize_t n = read(s->fd, out, max);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n == 0) {
+            s->eof = 1;
+        }
+        return n;
+    }
+}
+
+// Read more of the pipe into the read-ahead buffer.
+// Returns bytes read, 0 at EOF, -1 on error.
+static ssize_t proc_stream_fill(ProcStream *s) {
+    if (s->eof || s->fd < 0) {
+        return 0;
+    }
+    if (s->start > 0) {
+        memmove(s->buf, s->buf + s->start, s->end - s->start);
+        s->end -= s->start;
+        s->start = 0;
+    }
+    if (s->cap - s->end < PROC_READ_CHUNK / 4) {
+        size_t cap = s->cap ? s->cap * 2 : PROC_READ_CHUNK;
+        char *grown = realloc(s->buf, cap);
+        if (!grown) {
+            errno = ENOMEM;
+            return -1;
+        }
+        s->buf = grown;
+        s->cap = cap;
+    }
+    for (;;) {
+        ssize_t n = read(s->fd, s->buf + s->end, s->cap - s->end);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n == 0) {
+            s->eof = 1;
+        } else if (n > 0) {
+            s->end += (size_t)n;
+        }
+        return n;
+    }
+}
+
+char* proc_stream_line(ProcStream *s, size_t *len, int *failed) {
+    size_t scanned = 0;         // Bytes after start already searched
+    *failed = 0;
+    for (;;) {
+        size_t avail = s->end - s->start;
+        char *nl = avail > scanned ? memchr(s->buf + s->start + scanned, '\n', avail - scanned) : NULL;
+        size_t n = nl ? (size_t)(nl - (s->buf + s->start)) : avail;
+        if (!nl) {
+            scanned = avail;
+            ssize_t got = proc_stream_fill(s);
+            if (got > 0) {
+                continue;
+            }
+            if (got < 0) {
+                *failed = 1;
+                return NULL;
+            }
+            if (avail == 0) {
+                return NULL;
+            }
+        }
+        char *line = malloc(n + 1);
+        if (!line) {
+            *failed = 1;
+            return NULL;
+        }
+        memcpy(line, s->buf + s->start, n);
+        line[n] = '\0';
+        s->start += nl ? n + 1 : n;
+        *len = n;
+        return line;
+    }
+}
+
+static void proc_stream_close(ProcStream *s) {
+    if (s->fd >= 0) {
+        close(s->fd);
+        s->fd = -1;
+    }
+    free(s->buf);
+    s->buf = NULL;
+    s->start = s->end = s->cap = 0;
+    s->eof = 1;
+}
+
+// ========== WRITING AND WAITING ==========
+
+// Write all of data to fd. SIGPIPE is held back so a child that has exited
+// shows up as EPIPE instead of killing this process.
+// Returns 0 or an errno value.
+static int proc_write_all(int fd, const char *data, size_t len) {
+    sigset_t pipe_set, old_set;
+    sigemptyset(&pipe_set);
+    sigaddset(&pipe_set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipe_set, &old_set);
+    int rc = 0;
+    size_t off = 0;
+    while (off < len) {
+        ssize_t n = write(fd, data + off, len - off);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            rc = errno;
+            break;
+        }
+        off += (size_t)n;
+    }
+    if (rc == EPIPE) {
+        struct timespec zero = {0, 0};
+        sigtimedwait(&pipe_set, NULL, &zero);
+    }
+    pthread_sigmask(SIG_SETMASK, &old_set, NULL);
+    return rc;
+}
+
+static int64_t proc_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+int proc_reap(Process *proc, int timeout_ms) {
+    int64_t deadline = proc_now_ms() + timeout_ms;
+    long nap_ms = 1;
+    while (!proc->reaped) {
+        int status;
+        pid_t r = waitpid(proc->pid, &status, timeout_ms < 0 ? 0 : WNOHANG);
+        if (r == proc->pid) {
+            proc->reaped = 1;
+            proc->status = status;
+            break;
+        }
+        if (r < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        int64_t left = deadline - proc_now_ms();
+        if (left <= 0) {
+            return 0;
+        }
+        // Still running: back off from 1ms to 10ms between checks
+        long nap = nap_ms < left ? nap_ms : (long)left;
+        struct timespec ts = { nap / 1000, (nap % 1000) * 1000000L };
+        nanosleep(&ts, NULL);
+        if (nap_ms < 10) {
+            nap_ms *= 2;
+        }
+    }
+    return 1;
+}
+
+static int proc_buf_reserve(ProcBuf *b, size_t extra) {
+    if (b->cap - b->len >= extra + 1) {
+        return 0;
+    }
+    size_t cap = b->cap ? b->cap : PROC_READ_CHUNK;
+    while (cap - b->len < extra + 1) {
+        cap *= 2;
+    }
+    char *grown = realloc(b->data, cap);
+    if (!grown) {
+        return -1;
+    }
+    b->data = grown;
+    b->cap = cap;
+    return 0;
+}
+
+// Move a stream's read-ahead bytes into b
+static int proc_buf_take_ahead(ProcBuf *b, ProcStream *s) {
+    size_t n = s->end - s->start;
+    if (n == 0) {
+        return 0;
+    }
+    if (proc_buf_reserve(b, n) < 0) {
+        return -1;
+    }
+    memcpy(b->data + b->len, s->buf + s->start, n);
+    b->len += n;
+    s->start = s->end = 0;
+    return 0;
+}
+
+// poll() multiplexes the three pipes, so a child blocked on a full stderr
+// pipe cannot deadlock a parent reading stdout
+int proc_communicate(Process *proc, const char *input, size_t input_len,
+                     ProcBuf *out, ProcBuf *err) {
+    if (proc_buf_take_ahead(out, &proc->out) < 0 || proc_buf_take_ahead(err, &proc->err) < 0) {
+        return ENOMEM;
+    }
+    size_t in_off = 0;
+    if (proc->in_fd >= 0 && input_len > 0) {
+        fcntl(proc->in_fd, F_SETFL, fcntl(proc->in_fd, F_GETFL) | O_NONBLOCK);
+    } else if (proc->in_fd >= 0) {
+        close(proc->in_fd);
+        proc->in_fd = -1;
+    }
+
+    sigset_t pipe_set, old_set;
+    sigemptyset(&pipe_set);
+    sigaddset(&pipe_set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipe_set, &old_set);
+    int rc = 0;
+    int broken_pipe = 0;
+    ProcStream *streams[2] = { &proc->out, &proc->err };
+    ProcBuf *bufs[2] = { out, err };
+
+    while (rc == 0) {
+        struct pollfd fds[3];
+        int slot[3];
+        int nfds = 0;
+        if (proc->in_fd >= 0) {
+            fds[nfds] = (struct pollfd){ .fd = proc->in_fd, .events = POLLOUT };
+            slot[nfds++] = -1;
+        }
+        for (int i = 0; i < 2; i++) {
+            if (streams[i]->fd >= 0 && !streams[i]->eof) {
+                fds[nfds] = (struct pollfd){ .fd = streams[i]->fd, .events = POLLIN };
+                slot[nfds++] = i;
+            }
+        }
+        if (nfds == 0) {
+            break;
+        }
+        if (poll(fds, (nfds_t)nfds, -1) < 0) {
+            if (errno != EINTR) {
+                rc = errno;
+            }
+            continue;
+        }
+        for (int k = 0; k < nfds && rc == 0; k++) {
+            if (!fds[k].revents) {
+                continue;
+            }
+            if (slot[k] < 0) {
+                ssize_t n = write(proc->in_fd, input + in_off, input_len - in_off);
+                if (n > 0) {
+                    in_off += (size_t)n;
+                } else if (n < 0 && errno != EAGAIN && errno != EINTR) {
+                    // The child stopped reading: drop the rest of the input
+                    broken_pipe = errno == EPIPE;
+                    in_off = input_len;
+                    if (!broken_pipe) {
+                        rc = errno;
+                    }
+                }
+                if (in_off == input_len) {
+                    close(proc->in_fd);
+                    proc->in_fd = -1;
+                }
+                continue;
+            }
+            ProcBuf *b = bufs[slot[k]];
+            if (proc_buf_reserve(b, PROC_READ_CHUNK / 2) < 0) {
+                rc = ENOMEM;
+                break;
+            }
+            ssize_t n = read(streams[slot[k]]->fd, b->data + b->len, b->cap - b->len - 1);
+            if (n > 0) {
+                b->len += (size_t)n;
+            } else if (n == 0) {
+                streams[slot[k]]->eof = 1;
+            } else if (errno != EINTR && errno != EAGAIN) {
+                rc = errno;
+            }
+        }
+    }
+    if (broken_pipe) {
+        struct timespec zero = {0, 0};
+        sigtimedwait(&pipe_set, NULL, &zero);
+    }
+    pthread_sigmask(SIG_SETMASK, &old_set, NULL);
+    if (rc == 0 && proc_reap(proc, -1) < 0) {
+        rc = errno;
+    }
+    if (rc == 0 && (proc_buf_reserve(out, 0) < 0 || proc_buf_reserve(err, 0) < 0)) {
+        rc = ENOMEM;
+    }
+    if (rc == 0) {
+        out->data[out->len] = '\0';
+        err->data[err->len] = '\0';
+    }
+    return rc;
+}
+
+// ========== HANDLES ==========
+
+int proc_redirect_file(ProcRedirect *r, int stream, const char *path, int append,
+                       char *err, size_t err_len) {
+    static const char *names[] = {"stdin", "stdout", "stderr"};
+    int flags = O_CLOEXEC;
+    if (stream == 0) {
+        flags |= O_RDONLY;
+    } else {
+        flags |= O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC);
+    }
+    int fd = open(path, flags, 0644);
+    if (fd < 0) {
+        snprintf(err, err_len, "cannot open '%s' for %s: %s", path, names[stream], strerror(errno));
+        return -1;
+    }
+    r->kind = PROC_FD;
+    r->fd = fd;
+    r->own_fd = 1;
+    return 0;
+}
+
+int proc_redirect_from(ProcRedirect *r, Process *from, char *err, size_t err_len) {
+    if (from->closed || from->out.fd < 0) {
+        snprintf(err, err_len, "stdin process has no stdout pipe to read");
+        return -1;
+    }
+    if (from->out.end > from->out.start) {
+        snprintf(err, err_len, "stdin process has unread buffered output");
+        return -1;
+    }
+    r->kind = PROC_FD;
+    r->fd = from->out.fd;
+    r->from = from;
+    return 0;
+}
+
+void proc_redirect_release(ProcRedirect *redir, int count) {
+    for (int i = 0; i < count; i++) {
+        if (redir[i].own_fd) {
+            close(redir[i].fd);
+            redir[i].own_fd = 0;
+        }
+    }
+}
+
+ProcStream* proc_stream_named(Process *proc, const char *name) {
+    if (strcmp(name, "stdout") == 0) {
+        return &proc->out;
+    }
+    if (strcmp(name, "stderr") == 0) {
+        return &proc->err;
+    }
+    return NULL;
+}
+
+int proc_write(Process *proc, const char *data, size_t len) {
+    return proc_write_all(proc->in_fd, data, len);
+}
+
+void proc_close_stdin(Process *proc) {
+    if (proc->in_fd >= 0) {
+        close(proc->in_fd);
+        proc->in_fd = -1;
+    }
+}
+
+int proc_poll(Process **procs, int count, int timeout_ms, int *ready) {
+    struct pollfd *fds = calloc((size_t)count * 2 + 1, sizeof(struct pollfd));
+    int *owner = calloc((size_t)count * 2 + 1, sizeof(int));
+    if (!fds || !owner) {
+        free(fds);
+        free(owner);
+        errno = ENOMEM;
+        return -1;
+    }
+    int nfds = 0;
+    int buffered = 0;
+    for (int i = 0; i < count; i++) {
+        ProcStream *streams[2] = { &procs[i]->out, &procs[i]->err };
+        for (int k = 0; k < 2; k++) {
+            ready[i * 2 + k] = 0;
+            if (streams[k]->end > streams[k]->start) {
+                ready[i * 2 + k] = 1;
+                buffered = 1;
+            } else if (streams[k]->fd >= 0 && !streams[k]->eof) {
+                fds[nfds] = (struct pollfd){ .fd = streams[k]->fd, .events = POLLIN };
+                owner[nfds++] = i * 2 + k;
+            }
+        }
+    }
+    if (nfds > 0) {
+        int n;
+        do {
+            n = poll(fds, (nfds_t)nfds, buffered ? 0 : timeout_ms);
+        } while (n < 0 && errno == EINTR);
+        for (int j = 0; n > 0 && j < nfds; j++) {
+            if (fds[j].revents & (POLLIN | POLLHUP | POLLERR)) {
+                ready[owner[j]] = 1;
+            }
+        }
+    }
+    free(fds);
+    free(owner);
+    return 0;
+}
+
+void proc_exit_status(Process *proc, int *exit_code, int *term_signal) {
+    *exit_code = WIFEXITED(proc->status) ? WEXITSTATUS(proc->status) : -1;
+    *term_signal = WIFSIGNALED(proc->status) ? WTERMSIG(proc->status) : 0;
+}
+
+int proc_kill(Process *proc, int sig) {
+    if (proc->reaped) {
+        return 0;
+    }
+    return kill(proc->pid, sig);
+}
+
+void proc_close(Process *proc) {
+    if (proc->closed) {
+        return;
+    }
+    proc_close_stdin(proc);
+    proc_stream_close(&proc->out);
+    proc_stream_close(&proc->err);
+    proc->closed = 1;
+    // Reap it now if it has already exited, so it does not linger as a zombie
+    proc_reap(proc, 0);
+}
@@ -0,0 +1,121 @@
+/*
+ * Hemlock Subprocess Core
+ *
+ * Streaming child processes for @stdlib/process, shared by the interpreter
+ * and the runtime library. A handle is meant to be driven by one task at a
+ * time. Functions that can fail return -1 (or NULL) with errno set, or
+ * return an errno value, as noted.
+ */
+
+#ifndef HEMLOCK_SUBPROCESS_CORE_H
+#define HEMLOCK_SUBPROCESS_CORE_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#define PROC_ERR_LEN     512
+
+typedef struct {
+    int fd;                     // Parent end of the pipe, -1 if not piped or closed
+    char *buf;                  // Bytes read ahead by read_line()
+    size_t start, end, cap;
+    int eof;
+} ProcStream;
+
+typedef struct {
+    pid_t pid;
+    int in_fd;                  // Write end of the child's stdin pipe, or -1
+    ProcStream out, err;
+    int reaped;
+    int status;                 // waitpid() status once reaped
+    int closed;
+} Process;
+
+enum {
+    PROC_INHERIT,
+    PROC_PIPE,
+    PROC_NULL,
+    PROC_FD,                    // Install an open descriptor
+    PROC_STDOUT                 // stderr only: share the child's stdout
+};
+
+// How one of stdin (0), stdout (1) or stderr (2) is set up; zeroed with
+// fd -1 it inherits the parent's
+typedef struct {
+    int kind;
+    int fd;                     // PROC_FD descriptor
+    int own_fd;                 // fd was opened for this spawn and is closed after it
+    Process *from;              // stdin fed from this process's stdout pipe
+} ProcRedirect;
+
+typedef struct {
+    char *data;
+    size_t len, cap;
+} ProcBuf;
+
+/*
+ * Redirects that need more than a kind. Both return 0, or -1 with a
+ * message in err.
+ */
+int proc_redirect_file(ProcRedirect *r, int stream, const char *path, int append,
+                       char *err, size_t err_len);
+int proc_redirect_from(ProcRedirect *r, Process *from, char *err, size_t err_len);
+
+// Close the descriptors opened for redirects that were never spawned with
+void proc_redirect_release(ProcRedirect *redir, int count);
+
+/*
+ * Start argv[0] (searched in PATH) with the given redirects, which are
+ * released. envp NULL inherits the environment, cwd NULL the working
+ * directory. Returns the new process, or NULL with a message in err.
+ */
+Process* proc_spawn(char *const argv[], char *const envp[], const char *cwd,
+                    ProcRedirect redir[3], char *err, size_t err_len);
+
+// "stdout" or "stderr", NULL for any other name
+ProcStream* proc_stream_named(Process *proc, const char *name);
+
+// Read up to max bytes: read-ahead bytes first, then the pipe.
+// timeout_ms < 0 blocks. Returns bytes read, 0 at EOF, -1 on error, -2 on timeout.
+ssize_t proc_stream_read(ProcStream *s, char *out, size_t max, int timeout_ms);
+
+// Next line without its "\n" (a final line may lack one).
+// Returns a malloc'd string with its length in *len, or NULL at EOF or
+// on error (*failed set).
+char* proc_stream_line(ProcStream *s, size_t *len, int *failed);
+
+// Write all of data to stdin. Returns 0 or an errno value.
+int proc_write(Process *proc, const char *data, size_t len);
+
+void proc_close_stdin(Process *proc);
+
+/*
+ * Wait until any piped output of procs is readable (data or EOF), at most
+ * timeout_ms (-1 waits forever). ready[i * 2] and ready[i * 2 + 1] report
+ * stdout and stderr of procs[i]. Returns 0 or -1.
+ */
+int proc_poll(Process **procs, int count, int timeout_ms, int *ready);
+
+// Reap the child; timeout_ms < 0 blocks until it exits.
+// Returns 1 once reaped, 0 on timeout, -1 on error.
+int proc_reap(Process *proc, int timeout_ms);
+
+// exit_code is -1 and term_signal the signal number when the child was killed
+void proc_exit_status(Process *proc, int *exit_code, int *term_signal);
+
+// Signal the child (a no-op once it is reaped). Returns 0 or -1.
+int proc_kill(Process *proc, int sig);
+
+/*
+ * Write input (if any) to stdin, close it, read stdout and stderr to EOF
+ * into NUL-terminated out and err, and reap the child. Returns 0 or an
+ * errno value; the buffers are the caller's to free either way.
+ */
+int proc_communicate(Process *proc, const char *input, size_t input_len,
+                     ProcBuf *out, ProcBuf *err);
+
+// Close the pipes held by the parent. The child keeps running; reap and
+// kill still work afterwards.
+void proc_close(Process *proc);
+
+#endif // HEMLOCK_SUBPROCESS_CORE_H
@@ -0,0 +1,994 @@
+#include "snapshot.h"
+#include "module.h"
+#include "ast_serialize.h"
+#include "version.h"
+#include "interpreter/internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+// ========== IMAGE FORMAT ==========
+
+// Image layout (host byte order; an image is tied to the interpreter version):
+//   SnapshotHeader
+//   heap section: source path, the number of environments, strings, buffers,
+//     arrays, objects, functions and FFI functions, then their contents in that order, the
+//     enum types and the id of the main module's environment
+//   AST section: a .hmlc blob holding one function expression statement per
+//     distinct function body, one block of `import "lib"` and `extern fn`
+//     per FFI function, one `define` statement per object type, and the main
+//     module's statements after the snapshot point
+// Values are a ValueType byte followed by the raw scalar, a u32 heap id or
+// a builtin name. Environment id NO_ID is the builtin (global) environment.
+
+#define SNAPSHOT_FORMAT 1
+#define NO_ID UINT32_MAX
+#define MARKER_NAME "snapshot_point"
+
+typedef struct {
+    uint32_t magic;
+    uint16_t format;
+    uint16_t reserved;
+    char version[16];
+    uint64_t heap_offset;
+    uint64_t heap_size;
+    uint64_t ast_offset;
+    uint64_t ast_size;
+    uint32_t num_functions;    // Function expressions at the start of the blob
+    uint32_t num_ffi;          // FFI declarations after them
+    uint32_t num_types;        // Object type definitions after those
+    uint32_t num_statements;   // Statements to run after those
+} SnapshotHeader;
+
+// ========== BYTE BUFFERS ==========
+
+typedef struct {
+    uint8_t *data;
+    size_t length;
+    size_t capacity;
+} ByteBuffer;
+
+static void put_bytes(ByteBuffer *buf, const void *bytes, size_t len) {
+    if (buf->length + len > buf->capacity) {
+        size_t capacity = buf->capacity ? buf->capacity : 4096;
+        while (buf->length + len > capacity) {
+            capacity *= 2;
+        }
+        buf->data = realloc(buf->data, capacity);
+        if (!buf->data) {
+            fprintf(stderr, "Error: Out of memory writing snapshot\n");
+            exit(1);
+        }
+        buf->capacity = capacity;
+    }
+    if (len > 0) {
+        memcpy(buf->data + buf->length, bytes, len);
+    }
+    buf->length += len;
+}
+
+static void put_u8(ByteBuffer *buf, uint8_t val) {
+    put_bytes(buf, &val, 1);
+}
+
+static void put_u32(ByteBuffer *buf, uint32_t val) {
+    put_bytes(buf, &val, 4);
+}
+
+// Length-prefixed string; NULL is stored as length NO_ID
+static void put_str(ByteBuffer *buf, const char *str) {
+    if (!str) {
+        put_u32(buf, NO_ID);
+        return;
+    }
+    size_t len = strlen(str);
+    put_u32(buf, (uint32_t)len);
+    put_bytes(buf, str, len);
+}
+
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    size_t offset;
+    int bad;           // Set on the first out-of-bounds read
+} Reader;
+
+static const uint8_t* get_bytes(Reader *r, size_t len) {
+    if (r->bad || len > r->size - r->offset) {
+        r->bad = 1;
+        return NULL;
+    }
+    const uint8_t *p = r->data + r->offset;
+    r->offset += len;
+    return p;
+}
+
+static uint8_t get_u8(Reader *r) {
+    const uint8_t *p = get_bytes(r, 1);
+    return p ? *p : 0;
+}
+
+static uint32_t get_u32(Reader *r) {
+    uint32_t val = 0;
+    const uint8_t *p = get_bytes(r, 4);
+    if (p) {
+        memcpy(&val, p, 4);
+    }
+    return val;
+}
+
+// Returns a malloc'd copy, or NULL for a NULL string (or a bad read)
+static char* get_str(Reader *r, uint32_t *out_len) {
+    uint32_t len = get_u32(r);
+    if (len == NO_ID) {
+        return NULL;
+    }
+    const uint8_t *p = get_bytes(r, len);
+    if (!p) {
+        return NULL;
+    }
+    char *str = malloc(len + 1);
+    memcpy(str, p, len);
+    str[len] = '\0';
+    if (out_len) {
+        *out_len = len;
+    }
+    return str;
+}
+
+// ========== POINTER MAP ==========
+
+// Open-addressing map from heap pointers to snapshot ids
+typedef struct {
+    const void **keys;
+    uint32_t *ids;
+    size_t capacity;     // Power of two
+    size_t count;
+} PtrMap;
+
+static size_t ptr_hash(const void *ptr, size_t capacity) {
+    uint64_t x = (uint64_t)(uintptr_t)ptr;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    return (size_t)x & (capacity - 1);
+}
+
+static void ptr_map_put(PtrMap *map, const void *key, uint32_t id);
+
+static void ptr_map_grow(PtrMap *map) {
+    PtrMap old = *map;
+    map->capacity = old.capacity ? old.capacity * 2 : 256;
+    map->keys = calloc(map->capacity, sizeof(void*));
+    map->ids = malloc(map->capacity * sizeof(uint32_t));
+    map->count = 0;
+    for (size_t i = 0; i < old.capacity; i++) {
+        if (old.keys[i]) {
+            ptr_map_put(map, old.keys[i], old.ids[i]);
+        }
+    }
+    free(old.keys);
+    free(old.ids);
+}
+
+static void ptr_map_put(PtrMap *map, const void *key, uint32_t id) {
+    if ((map->count + 1) * 2 > map->capacity) {
+        ptr_map_grow(map);
+    }
+    size_t i = ptr_hash(key, map->capacity);
+    while (map->keys[i] && map->keys[i] != key) {
+        i = (i + 1) & (map->capacity - 1);
+    }
+    if (!map->keys[i]) {
+        map->keys[i] = key;
+        map->count++;
+    }
+    map->ids[i] = id;
+}
+
+static int ptr_map_get(const PtrMap *map, const void *key, uint32_t *id) {
+    if (map->capacity == 0) {
+        return 0;
+    }
+    size_t i = ptr_hash(key, map->capacity);
+    while (map->keys[i]) {
+        if (map->keys[i] == key) {
+            *id = map->ids[i];
+            return 1;
+        }
+        i = (i + 1) & (map->capacity - 1);
+    }
+    return 0;
+}
+
+static void ptr_map_free(PtrMap *map) {
+    free(map->keys);
+    free(map->ids);
+}
+
+// ========== HEAP WALK ==========
+
+typedef struct {
+    void **items;
+    uint32_t count;
+    uint32_t capacity;
+} PtrList;
+
+static uint32_t ptr_list_add(PtrList *list, void *item) {
+    if (list->count >= list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 64;
+        list->items = realloc(list->items, list->capacity * sizeof(void*));
+    }
+    list->items[list->count] = item;
+    return list->count++;
+}
+
+typedef struct {
+    Environment *global_env;
+    ExecutionContext *ctx;
+    PtrMap ids;              // Heap pointer -> id within its kind
+    PtrList envs;
+    PtrList strings;
+    PtrList buffers;
+    PtrList arrays;
+    PtrList objects;
+    PtrList functions;
+    PtrList ffi;
+    PtrMap bodies;           // Function body -> index into fn_stmts
+    PtrList fn_stmts;        // Synthetic `fn` expression statements
+    uint32_t *fn_ast;        // Per function: index into fn_stmts
+    int failed;
+} HeapWalk;
+
+static uint32_t walk_add(HeapWalk *w, PtrList *list, void *ptr) {
+    uint32_t id;
+    if (!ptr_map_get(&w->ids, ptr, &id)) {
+        id = ptr_list_add(list, ptr);
+        ptr_map_put(&w->ids, ptr, id);
+    }
+    return id;
+}
+
+static uint32_t walk_env(HeapWalk *w, Environment *env) {
+    if (!env || env == w->global_env) {
+        return NO_ID;
+    }
+    return walk_add(w, &w->envs, env);
+}
+
+static const char* unsupported_kind(ValueType type) {
+    switch (type) {
+        case VAL_PTR: return "a pointer";
+        case VAL_FILE: return "a file handle";
+        case VAL_SOCKET: return "a socket";
+        case VAL_TASK: return "a task";
+        case VAL_CHANNEL: return "a channel";
+        default: return NULL;
+    }
+}
+
+// Write a value, numbering any heap object it refers to
+static void put_value(HeapWalk *w, ByteBuffer *buf, Value val, const char *where) {
+    const char *kind = unsupported_kind(val.type);
+    if (kind) {
+        if (!w->failed) {
+            fprintf(stderr, "Error: Cannot snapshot %s (reached from '%s')\n", kind, where);
+        }
+        w->failed = 1;
+        return;
+    }
+
+    put_u8(buf, (uint8_t)val.type);
+    switch (val.type) {
+        case VAL_STRING:
+            put_u32(buf, walk_add(w, &w->strings, val.as.as_string));
+            break;
+        case VAL_BUFFER:
+            put_u32(buf, walk_add(w, &w->buffers, val.as.as_buffer));
+            break;
+        case VAL_ARRAY:
+            put_u32(buf, walk_add(w, &w->arrays, val.as.as_array));
+            break;
+        case VAL_OBJECT:
+            put_u32(buf, walk_add(w, &w->objects, val.as.as_object));
+            break;
+        case VAL_FUNCTION:
+            put_u32(buf, walk_add(w, &w->functions, val.as.as_function));
+            break;
+        case VAL_FFI_FUNCTION:
+            put_u32(buf, walk_add(w, &w->ffi, val.as.as_ffi_function));
+            break;
+        case VAL_BUILTIN_FN: {
+            const char *name = builtin_name(val.as.as_builtin_fn);
+            if (!name) {
+                if (!w->failed) {
+                    fprintf(stderr, "Error: Cannot snapshot an unregistered builtin (reached from '%s')\n", where);
+                }
+                w->failed = 1;
+            }
+            put_str(buf, name);
+            break;
+        }
+        case VAL_NULL:
+            break;
+        default:
+            // Scalars: the raw payload
+            put_bytes(buf, &val.as, sizeof(val.as));
+            break;
+    }
+}
+
+static void put_type(ByteBuffer *buf, Type *type) {
+    put_u8(buf, type ? 1 : 0);
+    if (type) {
+        put_u32(buf, (uint32_t)type->kind);
+        put_str(buf, type->type_name);
+        put_type(buf, type->element_type);
+    }
+}
+
+// Record the AST a function was created from, once per body
+static void walk_function_ast(HeapWalk *w, Function *fn, uint32_t id) {
+    Stmt *body = function_body(fn, w->ctx);
+    uint32_t index;
+    if (!ptr_map_get(&w->bodies, body, &index)) {
+        // The expression borrows the function's own parameter arrays
+        Expr *expr = expr_function(fn->is_async, fn->param_names, fn->param_types,
+                                   fn->param_defaults, fn->num_params, fn->return_type, body);
+        index = ptr_list_add(&w->fn_stmts, stmt_expr(expr));
+        ptr_map_put(&w->bodies, body, index);
+    }
+    w->fn_ast = realloc(w->fn_ast, (id + 1) * sizeof(uint32_t));
+    w->fn_ast[id] = index;
+}
+
+// Write the heap section. Containers are written after every id is known,
+// so each kind goes to its own buffer while the walk discovers new objects.
+static void put_heap(HeapWalk *w, ByteBuffer *out, Environment *main_env, const char *source_path) {
+    ByteBuffer envs = {0}, strings = {0}, buffers = {0}, arrays = {0}, objects = {0}, functions = {0};
+    uint32_t main_id = walk_env(w, main_env);
+    uint32_t done_envs = 0, done_strings = 0, done_buffers = 0;
+    uint32_t done_arrays = 0, done_objects = 0, done_functions = 0;
+
+    int progress = 1;
+    while (progress) {
+        progress = 0;
+        for (; done_envs < w->envs.count; done_envs++, progress = 1) {
+            Environment *env = w->envs.items[done_envs];
+            put_u32(&envs, walk_env(w, env->parent));
+            put_u32(&envs, (uint32_t)env->count);
+            for (int i = 0; i < env->count; i++) {
+                put_str(&envs, env->names[i]);
+                put_u8(&envs, (uint8_t)env->is_const[i]);
+                put_value(w, &envs, env->values[i], env->names[i]);
+            }
+        }
+        for (; done_strings < w->strings.count; done_strings++, progress = 1) {
+            String *str = w->strings.items[done_strings];
+            put_u32(&strings, (uint32_t)str->length);
+            put_bytes(&strings, str->data, (size_t)str->length);
+        }
+        for (; done_buffers < w->buffers.count; done_buffers++, progress = 1) {
+            Buffer *b = w->buffers.items[done_buffers];
+            put_u32(&buffers, (uint32_t)b->length);
+            put_bytes(&buffers, b->data, (size_t)b->length);
+        }
+        for (; done_arrays < w->arrays.count; done_arrays++, progress = 1) {
+            Array *arr = w->arrays.items[done_arrays];
+            put_type(&arrays, arr->element_type);
+            put_u32(&arrays, (uint32_t)arr->length);
+            for (int i = 0; i < arr->length; i++) {
+                put_value(w, &arrays, arr->elements[i], "array element");
+            }
+        }
+        for (; done_objects < w->objects.count; done_objects++, progress = 1) {
+            Object *obj = w->objects.items[done_objects];
+            put_str(&objects, obj->type_name);
+            put_u32(&objects, (uint32_t)obj->num_fields);
+            for (int i = 0; i < obj->num_fields; i++) {
+                put_str(&objects, obj->field_names[i]);
+                put_value(w, &objects, obj->field_values[i], obj->field_names[i]);
+            }
+        }
+        for (; done_functions < w->functions.count; done_functions++, progress = 1) {
+            Function *fn = w->functions.items[done_functions];
+            walk_function_ast(w, fn, done_functions);
+            put_u32(&functions, w->fn_ast[done_functions]);
+            put_u32(&functions, walk_env(w, fn->closure_env));
+        }
+    }
+
+    put_str(out, source_path);
+    put_u32(out, w->envs.count);
+    put_u32(out, w->strings.count);
+    put_u32(out, w->buffers.count);
+    put_u32(out, w->arrays.count);
+    put_u32(out, w->objects.count);
+    put_u32(out, w->functions.count);
+    put_u32(out, w->ffi.count);
+    put_bytes(out, strings.data, strings.length);
+    put_bytes(out, buffers.data, buffers.length);
+    put_bytes(out, functions.data, functions.length);
+    put_bytes(out, envs.data, envs.length);
+    put_bytes(out, arrays.data, arrays.length);
+    put_bytes(out, objects.data, objects.length);
+
+    put_u32(out, (uint32_t)enum_types.count);
+    for (int i = 0; i < enum_types.count; i++) {
+        EnumType *type = enum_types.types[i];
+        put_str(out, type->name);
+        put_u32(out, (uint32_t)type->num_variants);
+        for (int j = 0; j < type->num_variants; j++) {
+            put_str(out, type->variant_names[j]);
+            put_u32(out, (uint32_t)type->variant_values[j]);
+        }
+    }
+    put_u32(out, main_id);
+
+    free(envs.data);
+    free(strings.data);
+    free(buffers.data);
+    free(arrays.data);
+    free(objects.data);
+    free(functions.data);
+}
+
+// ========== CREATING SNAPSHOTS ==========
+
+typedef struct {
+    const char *file_path;
+    const char *output_path;
+    Environment *global_env;
+    ExecutionContext *ctx;
+    int prefix;                // Statements run before the snapshot
+} SnapshotJob;
+
+static int is_marker(Stmt *stmt) {
+    if (stmt->type != STMT_EXPR || stmt->as.expr->type != EXPR_CALL) {
+        return 0;
+    }
+    Expr *callee = stmt->as.expr->as.call.func;
+    return callee->type == EXPR_IDENT && strcmp(callee->as.ident, MARKER_NAME) == 0;
+}
+
+static int snapshot_prefix_length(Module *main_module, void *data) {
+    SnapshotJob *job = data;
+    int prefix = 0;
+    for (int i = 0; i < main_module->num_statements; i++) {
+        Stmt *stmt = main_module->statements[i];
+        if (is_marker(stmt)) {
+            prefix = i + 1;
+            break;
+        }
+        if (stmt->type == STMT_IMPORT) {
+            prefix = i + 1;
+        }
+    }
+
+    for (int i = prefix; i < main_module->num_statements; i++) {
+        Stmt *stmt = main_module->statements[i];
+        if (stmt->type == STMT_IMPORT || stmt->type == STMT_EXPORT) {
+            fprintf(stderr, "Error: %s: imports and exports must come before the snapshot point\n",
+                    job->file_path);
+            return -1;
+        }
+    }
+    job->prefix = prefix;
+    return prefix;
+}
+
+static int write_image(const char *path, const SnapshotHeader *header,
+                       const ByteBuffer *heap, const uint8_t *ast, size_t ast_size) {
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot open '%s' for writing\n", path);
+        return 1;
+    }
+    int ok = fwrite(header, sizeof(*header), 1, file) == 1 &&
+             fwrite(heap->data, 1, heap->length, file) == heap->length &&
+             fwrite(ast, 1, ast_size, file) == ast_size;
+    if (fclose(file) != 0) {
+        ok = 0;
+    }
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to write '%s'\n", path);
+        remove(path);
+        return 1;
+    }
+    return 0;
+}
+
+static int snapshot_finish(Module *main_module, Environment *main_env, void *data) {
+    SnapshotJob *job = data;
+    ExecutionContext *ctx = job->ctx;
+    if (ctx->exception_state.is_throwing) {
+        char *msg = value_to_string(ctx->exception_state.exception_value);
+        fprintf(stderr, "Uncaught exception: %s\n", msg);
+        free(msg);
+        return 1;
+    }
+
+    // Synthetic statements borrow the program's AST; they live in a scratch
+    // arena that is dropped once the blob is written
+    AstArena *scratch = ast_arena_new();
+    AstArena *previous = ast_arena_use(scratch);
+
+    HeapWalk walk = {0};
+    walk.global_env = job->global_env;
+    walk.ctx = ctx;
+    ByteBuffer heap = {0};
+    put_heap(&walk, &heap, main_env, main_module->absolute_path);
+
+    int result = 1;
+    if (!walk.failed) {
+        int num_types = object_types.count;
+        int num_rest = main_module->num_statements - job->prefix;
+        int total = (int)walk.fn_stmts.count + (int)walk.ffi.count + num_types + num_rest;
+        Stmt **stmts = malloc(sizeof(Stmt*) * (total > 0 ? total : 1));
+        int n = 0;
+        for (uint32_t i = 0; i < walk.fn_stmts.count; i++) {
+            stmts[n++] = walk.fn_stmts.items[i];
+        }
+        for (uint32_t i = 0; i < walk.ffi.count; i++) {
+            // Re-declared on load, which looks the symbol up again
+            FFIFunction *func = walk.ffi.items[i];
+            Stmt **decl = ast_alloc(sizeof(Stmt*) * 2);
+            decl[0] = stmt_import_ffi(func->library_path);
+            decl[1] = stmt_extern_fn(func->name, func->hemlock_params, func->num_params,
+                                     func->hemlock_return);
+            stmts[n++] = stmt_block(decl, 2);
+        }
+        for (int i = 0; i < num_types; i++) {
+            ObjectType *type = object_types.types[i];
+            stmts[n++] = stmt_define_object(type->name, type->field_names, type->field_types,
+                                            type->field_optional, type->field_defaults,
+                                            type->num_fields);
+        }
+        for (int i = job->prefix; i < main_module->num_statements; i++) {
+            stmts[n++] = main_module->statements[i];
+        }
+
+        size_t ast_size = 0;
+        uint8_t *ast = ast_serialize(stmts, total, 0, &ast_size);
+        free(stmts);
+        if (ast) {
+            SnapshotHeader header = {0};
+            header.magic = SNAPSHOT_MAGIC;
+            header.format = SNAPSHOT_FORMAT;
+            snprintf(header.version, sizeof(header.version), "%s", HEMLOCK_VERSION);
+            header.heap_offset = sizeof(header);
+            header.heap_size = heap.length;
+            header.ast_offset = header.heap_offset + heap.length;
+            header.ast_size = ast_size;
+            header.num_functions = walk.fn_stmts.count;
+            header.num_ffi = walk.ffi.count;
+            header.num_types = (uint32_t)num_types;
+            header.num_statements = (uint32_t)num_rest;
+            result = write_image(job->output_path, &header, &heap, ast, ast_size);
+            free(ast);
+        } else {
+            fprintf(stderr, "Error: Failed to serialize the program\n");
+        }
+    }
+
+    ast_arena_use(previous);
+    ast_arena_free(scratch);
+    free(heap.data);
+    ptr_map_free(&walk.ids);
+    ptr_map_free(&walk.bodies);
+    free(walk.envs.items);
+    free(walk.strings.items);
+    free(walk.buffers.items);
+    free(walk.arrays.items);
+    free(walk.objects.items);
+    free(walk.functions.items);
+    free(walk.ffi.items);
+    free(walk.fn_stmts.items);
+    free(walk.fn_ast);
+    return result;
+}
+
+int snapshot_create(const char *file_path, const char *output_path, int argc, char **argv) {
+    set_current_source_file(file_path);
+
+    ExecutionContext *ctx = exec_context_new();
+    Environment *global_env = env_new(NULL);
+    register_builtins(global_env, argc, argv, ctx);
+
+    SnapshotJob job = { file_path, output_path, global_env, ctx, 0 };
+    ModulePrefixHook hook = { snapshot_prefix_length, snapshot_finish, &job };
+    int result = execute_file_prefix(file_path, global_env, &hook, ctx);
+
+    env_break_cycles(global_env);
+    env_release(global_env);
+    clear_manually_freed_pointers();
+    exec_context_free(ctx);
+    set_current_source_file(NULL);
+    return result;
+}
+
+// ========== LOADING SNAPSHOTS ==========
+
+int is_snapshot_data(const uint8_t *data, size_t size) {
+    uint32_t magic;
+    if (size < sizeof(SnapshotHeader)) {
+        return 0;
+    }
+    memcpy(&magic, data, sizeof(magic));
+    return magic == SNAPSHOT_MAGIC;
+}
+
+int is_snapshot_file(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return 0;
+    }
+    uint32_t magic = 0;
+    size_t n = fread(&magic, sizeof(magic), 1, file);
+    fclose(file);
+    return n == 1 && magic == SNAPSHOT_MAGIC;
+}
+
+typedef struct {
+    Reader r;
+    Environment *global_env;
+    Environment **envs;
+    Value *strings;
+    Value *buffers;
+    Value *arrays;
+    Value *objects;
+    Value *functions;
+    Value *ffi;
+    uint32_t num_envs, num_strings, num_buffers, num_arrays, num_objects, num_functions, num_ffi;
+} HeapLoad;
+
+static Environment* load_env_ref(HeapLoad *h, uint32_t id) {
+    if (id == NO_ID) {
+        return h->global_env;
+    }
+    if (id >= h->num_envs) {
+        h->r.bad = 1;
+        return h->global_env;
+    }
+    return h->envs[id];
+}
+
+static Value load_ref(HeapLoad *h, Value *table, uint32_t count) {
+    uint32_t id = get_u32(&h->r);
+    if (id >= count) {
+        h->r.bad = 1;
+        return val_null();
+    }
+    return table[id];
+}
+
+// Read a value; the result borrows the loader's reference
+static Value load_value(HeapLoad *h) {
+    Value val = val_null();
+    uint8_t type = get_u8(&h->r);
+    switch (type) {
+        case VAL_STRING: return load_ref(h, h->strings, h->num_strings);
+        case VAL_BUFFER: return load_ref(h, h->buffers, h->num_buffers);
+        case VAL_ARRAY: return load_ref(h, h->arrays, h->num_arrays);
+        case VAL_OBJECT: return load_ref(h, h->objects, h->num_objects);
+        case VAL_FUNCTION: return load_ref(h, h->functions, h->num_functions);
+        case VAL_FFI_FUNCTION: return load_ref(h, h->ffi, h->num_ffi);
+        case VAL_BUILTIN_FN: {
+            char *name = get_str(&h->r, NULL);
+            BuiltinFn fn = name ? builtin_lookup(name) : NULL;
+            free(name);
+            if (!fn) {
+                h->r.bad = 1;
+                return val_null();
+            }
+            return val_builtin_fn(fn);
+        }
+        case VAL_NULL:
+            return val;
+        case VAL_I8: case VAL_I16: case VAL_I32: case VAL_I64:
+        case VAL_U8: case VAL_U16: case VAL_U32: case VAL_U64:
+        case VAL_F32: case VAL_F64: case VAL_BOOL: case VAL_RUNE: case VAL_TYPE: {
+            const uint8_t *p = get_bytes(&h->r, sizeof(val.as));
+            if (p) {
+                val.type = (ValueType)type;
+                memcpy(&val.as, p, sizeof(val.as));
+            }
+            return val;
+        }
+        default:
+            h->r.bad = 1;
+            return val;
+    }
+}
+
+static Type* load_type(HeapLoad *h, int depth) {
+    if (!get_u8(&h->r) || h->r.bad || depth > 8) {
+        return NULL;
+    }
+    Type *type = type_new((TypeKind)get_u32(&h->r));
+    type->type_name = get_str(&h->r, NULL);
+    type->element_type = load_type(h, depth + 1);
+    return type;
+}
+
+// Rebuild the heap. Every object is created first so references can point
+// anywhere; the loader holds one reference to each until the end.
+static Environment* load_heap(HeapLoad *h, Stmt **fn_stmts, uint32_t num_fn_stmts,
+                              Stmt **ffi_stmts, uint32_t num_ffi_stmts, ExecutionContext *ctx) {
+    Reader *r = &h->r;
+    h->num_envs = get_u32(r);
+    h->num_strings = get_u32(r);
+    h->num_buffers = get_u32(r);
+    h->num_arrays = get_u32(r);
+    h->num_objects = get_u32(r);
+    h->num_functions = get_u32(r);
+    h->num_ffi = get_u32(r);
+    // Each entry takes at least four bytes, which bounds the counts
+    size_t limit = r->size / 4;
+    if (r->bad || h->num_envs > limit || h->num_strings > limit || h->num_buffers > limit ||
+        h->num_arrays > limit || h->num_objects > limit || h->num_functions > limit ||
+        h->num_ffi != num_ffi_stmts) {
+        HeapLoad empty = { .r = *r, .global_env = h->global_env };
+        *h = empty;
+        h->r.bad = 1;
+        return NULL;
+    }
+
+    h->envs = calloc(h->num_envs + 1, sizeof(Environment*));
+    h->strings = calloc(h->num_strings + 1, sizeof(Value));
+    h->buffers = calloc(h->num_buffers + 1, sizeof(Value));
+    h->arrays = calloc(h->num_arrays + 1, sizeof(Value));
+    h->objects = calloc(h->num_objects + 1, sizeof(Value));
+    h->functions = calloc(h->num_functions + 1, sizeof(Value));
+    h->ffi = calloc(h->num_ffi + 1, sizeof(Value));
+
+    for (uint32_t i = 0; i < h->num_envs; i++) {
+        h->envs[i] = env_new(NULL);
+    }
+    for (uint32_t i = 0; i < h->num_arrays; i++) {
+        h->arrays[i] = val_array(array_new());
+    }
+    for (uint32_t i = 0; i < h->num_objects; i++) {
+        h->objects[i] = val_object(object_new(NULL, 1));
+    }
+
+    for (uint32_t i = 0; i < h->num_strings; i++) {
+        uint32_t len = 0;
+        char *data = get_str(r, &len);
+        h->strings[i] = data ? val_string_take(data, (int)len, (int)len + 1) : val_string("");
+    }
+    for (uint32_t i = 0; i < h->num_buffers; i++) {
+        uint32_t len = get_u32(r);
+        const uint8_t *p = get_bytes(r, len);
+        h->buffers[i] = val_buffer(p && len > 0 ? (int)len : 1);
+        if (p && len > 0) {
+            memcpy(h->buffers[i].as.as_buffer->data, p, len);
+        }
+    }
+    for (uint32_t i = 0; i < h->num_functions; i++) {
+        uint32_t index = get_u32(r);
+        Environment *closure = load_env_ref(h, get_u32(r));
+        if (r->bad || index >= num_fn_stmts || fn_stmts[index]->type != STMT_EXPR ||
+            fn_stmts[index]->as.expr->type != EXPR_FUNCTION) {
+            r->bad = 1;
+            h->functions[i] = val_null();
+            continue;
+        }
+        // Evaluating the expression builds the function exactly as the
+        // original declaration did, capturing its environment
+        h->functions[i] = eval_expr(fn_stmts[index]->as.expr, closure, ctx);
+    }
+    for (uint32_t i = 0; i < h->num_ffi && !r->bad; i++) {
+        Stmt *decl = ffi_stmts[i];
+        if (decl->type != STMT_BLOCK || decl->as.block.count != 2 ||
+            decl->as.block.statements[0]->type != STMT_IMPORT_FFI ||
+            decl->as.block.statements[1]->type != STMT_EXTERN_FN) {
+            r->bad = 1;
+            break;
+        }
+        // Declare into a scratch scope and keep the function value
+        Environment *scratch = env_new(NULL);
+        eval_stmt(decl->as.block.statements[0], scratch, ctx);
+        if (!ctx->exception_state.is_throwing) {
+            eval_stmt(decl->as.block.statements[1], scratch, ctx);
+        }
+        if (ctx->exception_state.is_throwing || scratch->count != 1) {
+            env_release(scratch);
+            return NULL;
+        }
+        h->ffi[i] = scratch->values[0];
+        env_release(scratch);
+    }
+
+    for (uint32_t i = 0; i < h->num_envs && !r->bad; i++) {
+        Environment *env = h->envs[i];
+        env->parent = load_env_ref(h, get_u32(r));
+        env_retain(env->parent);
+        uint32_t count = get_u32(r);
+        for (uint32_t j = 0; j < count && !r->bad; j++) {
+            char *name = get_str(r, NULL);
+            int is_const = get_u8(r);
+            Value val = load_value(h);
+            if (name && !r->bad) {
+                env_define(env, name, val, is_const, ctx);
+            } else {
+                r->bad = 1;
+            }
+            free(name);
+        }
+    }
+    for (uint32_t i = 0; i < h->num_arrays && !r->bad; i++) {
+        Array *arr = h->arrays[i].as.as_array;
+        arr->element_type = load_type(h, 0);
+        uint32_t length = get_u32(r);
+        // Elements were checked against the element type when stored
+        for (uint32_t j = 0; j < length && !r->bad; j++) {
+            Value val = load_value(h);
+            if (arr->length >= arr->capacity) {
+                arr->capacity = arr->capacity ? arr->capacity * 2 : 8;
+                arr->elements = realloc(arr->elements, sizeof(Value) * arr->capacity);
+            }
+            value_retain(val);
+            arr->elements[arr->length++] = val;
+        }
+    }
+    for (uint32_t i = 0; i < h->num_objects && !r->bad; i++) {
+        Object *obj = h->objects[i].as.as_object;
+        obj->type_name = get_str(r, NULL);
+        uint32_t count = get_u32(r);
+        if (count > limit) {
+            r->bad = 1;
+            break;
+        }
+        if ((int)count > obj->capacity) {
+            obj->capacity = (int)count;
+            obj->field_names = realloc(obj->field_names, sizeof(char*) * count);
+            obj->field_values = realloc(obj->field_values, sizeof(Value) * count);
+        }
+        for (uint32_t j = 0; j < count && !r->bad; j++) {
+            char *name = get_str(r, NULL);
+            Value val = load_value(h);
+            if (!name) {
+                r->bad = 1;
+                break;
+            }
+            value_retain(val);
+            obj->field_names[obj->num_fields] = name;
+            obj->field_values[obj->num_fields] = val;
+            obj->num_fields++;
+        }
+    }
+
+    uint32_t num_enums = r->bad ? 0 : get_u32(r);
+    for (uint32_t i = 0; i < num_enums && !r->bad; i++) {
+        char *name = get_str(r, NULL);
+        uint32_t count = get_u32(r);
+        if (!name || count > limit) {
+            free(name);
+            r->bad = 1;
+            break;
+        }
+        EnumType *type = malloc(sizeof(EnumType));
+        type->name = name;
+        type->num_variants = (int)count;
+        type->variant_names = malloc(sizeof(char*) * (count + 1));
+        type->variant_values = malloc(sizeof(int32_t) * (count + 1));
+        for (uint32_t j = 0; j < count; j++) {
+            char *variant = get_str(r, NULL);
+            type->variant_names[j] = variant ? variant : strdup("");
+            type->variant_values[j] = (int32_t)get_u32(r);
+        }
+        register_enum_type(type);
+    }
+
+    uint32_t main_id = get_u32(r);
+    if (r->bad || main_id >= h->num_envs) {
+        r->bad = 1;
+        return NULL;
+    }
+    Environment *main_env = h->envs[main_id];
+    env_retain(main_env);
+    return main_env;
+}
+
+// Drop the loader's references; whatever the program can reach stays alive
+static void release_heap(HeapLoad *h) {
+    for (uint32_t i = 0; i < h->num_strings; i++) value_release(h->strings[i]);
+    for (uint32_t i = 0; i < h->num_buffers; i++) value_release(h->buffers[i]);
+    for (uint32_t i = 0; i < h->num_arrays; i++) value_release(h->arrays[i]);
+    for (uint32_t i = 0; i < h->num_objects; i++) value_release(h->objects[i]);
+    for (uint32_t i = 0; i < h->num_functions; i++) value_release(h->functions[i]);
+    for (uint32_t i = 0; i < h->num_envs; i++) env_release(h->envs[i]);
+    free(h->envs);
+    free(h->strings);
+    free(h->buffers);
+    free(h->arrays);
+    free(h->objects);
+    free(h->functions);
+    free(h->ffi);
+}
+
+int snapshot_run(const uint8_t *data, size_t size, int argc, char **argv) {
+    SnapshotHeader header;
+    if (!is_snapshot_data(data, size)) {
+        fprintf(stderr, "Error: Not a snapshot image\n");
+        return 1;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.format != SNAPSHOT_FORMAT ||
+        strncmp(header.version, HEMLOCK_VERSION, sizeof(header.version)) != 0) {
+        fprintf(stderr, "Error: Snapshot was made by a different Hemlock version; recreate it with --snapshot\n");
+        return 1;
+    }
+    if (header.heap_offset > size || header.heap_size > size - header.heap_offset ||
+        header.ast_offset > size || header.ast_size > size - header.ast_offset) {
+        fprintf(stderr, "Error: Snapshot image is truncated\n");
+        return 1;
+    }
+
+    // Function bodies stay encoded in the mapping until first called
+    int stmt_count = 0;
+    HmlcImage *image = NULL;
+    AstArena *arena = ast_arena_new();
+    AstArena *previous = ast_arena_use(arena);
+    Stmt **stmts = ast_deserialize_lazy(data + header.ast_offset, (size_t)header.ast_size,
+                                        &stmt_count, &image);
+    ast_arena_use(previous);
+    uint64_t expected = (uint64_t)header.num_functions + header.num_ffi + header.num_types +
+                        header.num_statements;
+    if (!stmts || (uint64_t)stmt_count != expected) {
+        fprintf(stderr, "Error: Snapshot image is corrupt\n");
+        hmlc_image_free(image);
+        ast_arena_free(arena);
+        return 1;
+    }
+    Stmt **ffi_stmts = stmts + header.num_functions;
+    Stmt **type_stmts = ffi_stmts + header.num_ffi;
+    Stmt **rest = type_stmts + header.num_types;
+
+    HeapLoad heap = {0};
+    heap.r.data = data + header.heap_offset;
+    heap.r.size = (size_t)header.heap_size;
+    char *source_path = get_str(&heap.r, NULL);
+    set_current_source_file(source_path);
+
+    ExecutionContext *ctx = exec_context_new();
+    Environment *global_env = env_new(NULL);
+    register_builtins(global_env, argc, argv, ctx);
+    heap.global_env = global_env;
+
+    for (uint32_t i = 0; i < header.num_types; i++) {
+        if (type_stmts[i]->type == STMT_DEFINE_OBJECT) {
+            eval_stmt(type_stmts[i], global_env, ctx);
+        }
+    }
+    Environment *main_env = load_heap(&heap, stmts, header.num_functions, ffi_stmts,
+                                      header.num_ffi, ctx);
+    release_heap(&heap);
+
+    int result = 0;
+    if (!main_env) {
+        if (ctx->exception_state.is_throwing) {
+            char *msg = value_to_string(ctx->exception_state.exception_value);
+            fprintf(stderr, "Error: Cannot restore snapshot: %s\n", msg);
+            free(msg);
+        } else {
+            fprintf(stderr, "Error: Snapshot image is corrupt\n");
+        }
+        result = 1;
+    } else {
+        eval_program(rest, (int)header.num_statements, main_env, ctx);
+        env_break_cycles(main_env);
+        env_release(main_env);
+    }
+
+    exec_context_free(ctx);
+    env_break_cycles(global_env);
+    env_release(global_env);
+    clear_manually_freed_pointers();
+    hmlc_image_free(image);
+    ast_arena_free(arena);
+    set_current_source_file(NULL);
+    free(source_path);
+    return result;
+}
@@ -100,6 +100,126 @@ for test_file in "${EXTRA_TESTS[@]}"; do
     fi
 done
 
+# Packaged executables decode function bodies from the mapped payload
+echo ""
+echo "Testing packaged executables..."
+LAZY_TEST="$TEST_DIR/test_lazy_bodies.hml"
+$HEMLOCK "$LAZY_TEST" > "$TEMP_DIR/lazy_expected.out" 2>&1
+for MODE in compressed uncompressed; do
+    echo -n "Testing package_$MODE... "
+    PKG_FLAGS=""
+    if [ "$MODE" == "uncompressed" ]; then
+        PKG_FLAGS="--no-compress"
+    fi
+    if $HEMLOCK --package "$LAZY_TEST" $PKG_FLAGS -o "$TEMP_DIR/lazy_$MODE" > /dev/null 2>&1 &&
+       "$TEMP_DIR/lazy_$MODE" > "$TEMP_DIR/lazy_$MODE.out" 2>&1 &&
+       diff -q "$TEMP_DIR/lazy_expected.out" "$TEMP_DIR/lazy_$MODE.out" > /dev/null 2>&1; then
+        echo -e "${GREEN}PASS${NC}"
+        PASSED=$((PASSED + 1))
+    else
+        echo -e "${RED}FAIL${NC}"
+        FAILED=$((FAILED + 1))
+    fi
+done
+
+# Module cache: the main file and its imports are stored as .hmlc entries
+echo ""
+echo "Testing module cache..."
+CACHE_HOME="$TEMP_DIR/cache"
+CACHE_DIR="$CACHE_HOME/hemlock/modules"
+MOD_DIR="$TEMP_DIR/cache_mod"
+mkdir -p "$MOD_DIR"
+printf 'export fn greet() { return "v1"; }\n' > "$MOD_DIR/lib.hml"
+printf 'import { greet } from "./lib.hml";\nprint(greet());\n' > "$MOD_DIR/main.hml"
+
+check_cache() {
+    local name="$1"
+    local expected="$2"
+    echo -n "Testing module_cache_$name... "
+    local output
+    output=$(XDG_CACHE_HOME="$CACHE_HOME" $HEMLOCK "$MOD_DIR/main.hml" 2>&1)
+    local entries
+    entries=$(ls "$CACHE_DIR" 2>/dev/null | grep -c '\.hmlc$')
+    if [ "$output" == "$expected" ] && [ "$entries" == "2" ]; then
+        echo -e "${GREEN}PASS${NC}"
+        PASSED=$((PASSED + 1))
+    else
+        echo -e "${RED}FAIL${NC} (output '$output', $entries entries)"
+        FAILED=$((FAILED + 1))
+    fi
+}
+
+check_cache "cold" "v1"
+check_cache "warm" "v1"
+
+# Changed source is a miss and replaces the entry
+printf 'export fn greet() { return "v2"; }\n' > "$MOD_DIR/lib.hml"
+check_cache "changed_source" "v2"
+
+# Corrupt and truncated entries fall back to parsing
+for ENTRY in "$CACHE_DIR"/*.hmlc; do
+    SIZE=$(stat -c %s "$ENTRY")
+    printf '\x55' | dd of="$ENTRY" bs=1 seek=$((SIZE - 8)) conv=notrunc 2>/dev/null
+done
+check_cache "corrupt_entry" "v2"
+for ENTRY in "$CACHE_DIR"/*.hmlc; do
+    truncate -s 24 "$ENTRY"
+done
+check_cache "truncated_entry" "v2"
+
+echo -n "Testing module_cache_disabled... "
+rm -rf "$CACHE_HOME"
+OUTPUT=$(HEMLOCK_NO_CACHE=1 XDG_CACHE_HOME="$CACHE_HOME" $HEMLOCK "$MOD_DIR/main.hml" 2>&1)
+if [ "$OUTPUT" == "v2" ] && [ ! -d "$CACHE_DIR" ]; then
+    echo -e "${GREEN}PASS${NC}"
+    PASSED=$((PASSED + 1))
+else
+    echo -e "${RED}FAIL${NC}"
+    FAILED=$((FAILED + 1))
+fi
+
+# Heap snapshots: module init runs once at --snapshot, the restored run
+# prints only what comes after snapshot_point()
+echo ""
+echo "Testing heap snapshots..."
+SNAP_APP="$TEST_DIR/fixtures/snapshot/app.hml"
+SNAP_FILE="$TEMP_DIR/app.hsnap"
+$HEMLOCK "$SNAP_APP" > "$TEMP_DIR/snap_expected.out" 2>&1
+
+echo -n "Testing snapshot_restore... "
+if $HEMLOCK --snapshot "$SNAP_FILE" "$SNAP_APP" > "$TEMP_DIR/snap_create.out" 2>&1 &&
+   $HEMLOCK "$SNAP_FILE" > "$TEMP_DIR/snap_restore.out" 2>&1 &&
+   cat "$TEMP_DIR/snap_create.out" "$TEMP_DIR/snap_restore.out" |
+       diff -q "$TEMP_DIR/snap_expected.out" - > /dev/null 2>&1 &&
+   ! grep -q "lib init" "$TEMP_DIR/snap_restore.out"; then
+    echo -e "${GREEN}PASS${NC}"
+    PASSED=$((PASSED + 1))
+else
+    echo -e "${RED}FAIL${NC}"
+    FAILED=$((FAILED + 1))
+fi
+
+echo -n "Testing snapshot_rejects_handles... "
+printf 'let f = open("%s", "r");\nsnapshot_point();\n' "$SNAP_APP" > "$TEMP_DIR/snap_file.hml"
+if ! $HEMLOCK --snapshot "$TEMP_DIR/snap_file.hsnap" "$TEMP_DIR/snap_file.hml" > /dev/null 2>&1 &&
+   [ ! -f "$TEMP_DIR/snap_file.hsnap" ]; then
+    echo -e "${GREEN}PASS${NC}"
+    PASSED=$((PASSED + 1))
+else
+    echo -e "${RED}FAIL${NC}"
+    FAILED=$((FAILED + 1))
+fi
+
+echo -n "Testing snapshot_truncated... "
+head -c 100 "$SNAP_FILE" > "$TEMP_DIR/truncated.hsnap"
+if ! $HEMLOCK "$TEMP_DIR/truncated.hsnap" > /dev/null 2>&1; then
+    echo -e "${GREEN}PASS${NC}"
+    PASSED=$((PASSED + 1))
+else
+    echo -e "${RED}FAIL${NC}"
+    FAILED=$((FAILED + 1))
+fi
+
 # Summary
 echo ""
 echo "========================================"
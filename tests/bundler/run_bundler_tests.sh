@@ -245,6 +245,70 @@ else
     fail "Package with stdlib" "Package command failed"
 fi
 
+# Test 21: Tree shaking drops unused stdlib declarations
+echo "Test 21: Tree shaking"
+cat > "$TMPDIR/shake.hml" << 'EOF'
+import { HashMap } from "@stdlib/collections";
+let m = HashMap();
+m.set("a", 1);
+print(m.get("a"));
+EOF
+if $HEMLOCK --bundle "$TMPDIR/shake.hml" -o "$TMPDIR/shake.hmlc" 2>/dev/null &&
+   $HEMLOCK --bundle "$TMPDIR/shake.hml" --no-tree-shake -o "$TMPDIR/noshake.hmlc" 2>/dev/null; then
+    SHAKEN_SIZE=$(stat -c%s "$TMPDIR/shake.hmlc" 2>/dev/null || stat -f%z "$TMPDIR/shake.hmlc")
+    FULL_SIZE=$(stat -c%s "$TMPDIR/noshake.hmlc" 2>/dev/null || stat -f%z "$TMPDIR/noshake.hmlc")
+    if [ "$SHAKEN_SIZE" -lt "$FULL_SIZE" ]; then
+        pass "Tree-shaken bundle is smaller ($SHAKEN_SIZE < $FULL_SIZE)"
+    else
+        fail "Tree shaking" "Expected $SHAKEN_SIZE < $FULL_SIZE"
+    fi
+else
+    fail "Tree shaking" "Bundle command failed"
+fi
+
+# Test 22: Tree-shaken bundle runs and reports what was removed
+echo "Test 22: Run tree-shaken bundle"
+OUTPUT=$($HEMLOCK "$TMPDIR/shake.hmlc" 2>&1)
+SUMMARY=$($HEMLOCK --bundle "$TMPDIR/shake.hml" -o "$TMPDIR/shake.hmlc" --verbose 2>/dev/null)
+if [ "$OUTPUT" == "1" ] && echo "$SUMMARY" | grep -q "Tree shaking: removed [1-9]"; then
+    pass "Tree-shaken bundle runs correctly"
+else
+    fail "Tree-shaken bundle" "Got output '$OUTPUT'"
+fi
+
+# Test 23: Side effects and transitively used declarations are kept
+echo "Test 23: Tree shaking keeps side effects"
+mkdir -p "$TMPDIR/shake_mod"
+cat > "$TMPDIR/shake_mod/lib.hml" << 'EOF'
+let counter = { calls: 0 };
+fn helper(x) { counter.calls = counter.calls + 1; return x * 2; }
+fn unused() { return helper(0); }
+define Point { x: i32, y: i32 }
+export fn make(x): Point {
+    let p: Point = { x: helper(x), y: 0 };
+    return p;
+}
+export fn count() { return counter.calls; }
+print("lib loaded");
+EOF
+cat > "$TMPDIR/shake_mod/main.hml" << 'EOF'
+import { make, count } from "./lib";
+let p = make(21);
+print(p.x);
+print(count());
+EOF
+if $HEMLOCK --bundle "$TMPDIR/shake_mod/main.hml" -o "$TMPDIR/shake_mod.hmlc" 2>/dev/null; then
+    OUTPUT=$($HEMLOCK "$TMPDIR/shake_mod.hmlc" 2>&1 | tr '\n' ' ')
+    SUMMARY=$($HEMLOCK --bundle "$TMPDIR/shake_mod/main.hml" -o "$TMPDIR/shake_mod.hmlc" --verbose 2>/dev/null)
+    if [ "$OUTPUT" == "lib loaded 42 1 " ] && echo "$SUMMARY" | grep -q "Removed: unused$"; then
+        pass "Tree shaking keeps what is used"
+    else
+        fail "Tree shaking keeps what is used" "Got output '$OUTPUT'"
+    fi
+else
+    fail "Tree shaking keeps what is used" "Bundle command failed"
+fi
+
 echo ""
 echo "=== Results ==="
 echo -e "Passed: ${GREEN}$PASSED${NC}"
@@ -100,8 +100,15 @@ for test_file in "$TEST_DIR"/*.hml; do
     if echo 'int main(){return 0;}' | gcc -x c - -lwebsockets -o /dev/null 2>/dev/null; then
         LWS_FLAG="-lwebsockets"
     fi
+    # Check if OpenSSL libssl/libcrypto are available (HTTPS, hash digests)
+    CRYPTO_FLAG=""
+    if echo 'int main(){return 0;}' | gcc -x c - -lssl -lcrypto -o /dev/null 2>/dev/null; then
+        CRYPTO_FLAG="-lssl -lcrypto"
+    elif echo 'int main(){return 0;}' | gcc -x c - -lcrypto -o /dev/null 2>/dev/null; then
+        CRYPTO_FLAG="-lcrypto"
+    fi
     exe_file="$TEMP_DIR/${test_name}"
-    if ! gcc -o "$exe_file" "$c_file" -I./runtime/include -L. -lhemlock_runtime -lm -lpthread -lffi -ldl $ZLIB_FLAG $LWS_FLAG > /tmp/gcc_err.log 2>&1; then
+    if ! gcc -o "$exe_file" "$c_file" -I./runtime/include -L. -lhemlock_runtime -lm -lpthread -lffi -ldl $ZLIB_FLAG $LWS_FLAG $CRYPTO_FLAG > /tmp/gcc_err.log 2>&1; then
         echo -e "${RED}✗${NC} $test_name ${RED}(C compilation failed)${NC}"
         cat /tmp/gcc_err.log
         ((FAIL_COUNT++))
@@ -126,6 +133,41 @@ for test_file in "$TEST_DIR"/*.hml; do
     fi
 done
 
+# Incremental builds: only the edited module's unit is recompiled
+echo ""
+echo -e "${BLUE}Running incremental build tests...${NC}"
+echo ""
+INC_DIR="$TEMP_DIR/incremental"
+mkdir -p "$INC_DIR"
+printf 'export fn greet(name) { return "hi " + name; }\n' > "$INC_DIR/greet.hml"
+printf 'export fn twice(n) { return n * 2; }\n' > "$INC_DIR/math.hml"
+printf 'import { greet } from "./greet.hml";\nimport { twice } from "./math.hml";\nprint(greet("hemlock"));\nprint(twice(21));\n' > "$INC_DIR/main.hml"
+
+check_incremental() {
+    local name="$1"
+    local expected_output="$2"
+    local expected_compiled="$3"
+    local log
+    log=$(XDG_CACHE_HOME="$INC_DIR/cache" ./hemlockc -v -j 2 "$INC_DIR/main.hml" -o "$INC_DIR/main" 2>&1)
+    local compiled
+    compiled=$(echo "$log" | grep -c '^Compiling unit')
+    local actual_output
+    actual_output=$(LD_LIBRARY_PATH="$PWD:$LD_LIBRARY_PATH" "$INC_DIR/main" 2>&1)
+    if [ "$actual_output" = "$expected_output" ] && [ "$compiled" = "$expected_compiled" ]; then
+        echo -e "${GREEN}✓${NC} incremental_$name"
+        ((PASS_COUNT++))
+    else
+        echo -e "${RED}✗${NC} incremental_$name (compiled $compiled units, expected $expected_compiled)"
+        echo "$actual_output" | sed 's/^/    /'
+        ((FAIL_COUNT++))
+    fi
+}
+
+check_incremental "cold" "$(printf 'hi hemlock\n42')" 3
+check_incremental "warm" "$(printf 'hi hemlock\n42')" 0
+printf 'export fn greet(name) { return "hello " + name; }\n' > "$INC_DIR/greet.hml"
+check_incremental "one_module_changed" "$(printf 'hello hemlock\n42')" 1
+
 echo ""
 echo "======================================"
 echo "              Summary"
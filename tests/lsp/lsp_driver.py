@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+"""
+Replay a JSON-RPC session against `hemlock lsp --stdio` and check the replies.
+
+A session is a .jsonl file, one step per line:
+
+    {"workspace": "../fixtures/project"} optional, first line: the root to
+                                        index, relative to the session
+                                        (default: the session's directory)
+    {"send": {...}}                     write a message (a request if it has an id)
+    {"raw": "..."}                      write a message body exactly as given
+    {"expect": {...}}                   read until a matching message arrives
+    # ...                               comment
+
+An expected response is matched by its "id", a notification by its
+"method"; messages that match neither are skipped. The expected message
+is a pattern: objects match when every listed key matches (extra keys are
+ignored), arrays must have the same length and match element-wise in any
+order, and other values must be equal.
+
+In strings, $ROOT is replaced with the workspace URI (file:///...) and
+$ROOTPATH with its path. "jsonrpc" is filled in on sent messages, which
+carry non-ASCII text as UTF-8; a raw body can use \\u escapes instead.
+
+Usage: lsp_driver.py HEMLOCK SESSION
+"""
+
+import json
+import os
+import select
+import subprocess
+import sys
+
+TIMEOUT = 20
+
+
+class SessionError(Exception):
+    pass
+
+
+def substitute(value, vars):
+    if isinstance(value, str):
+        for name in sorted(vars, key=len, reverse=True):
+            value = value.replace(name, vars[name])
+        return value
+    if isinstance(value, list):
+        return [substitute(v, vars) for v in value]
+    if isinstance(value, dict):
+        return {k: substitute(v, vars) for k, v in value.items()}
+    return value
+
+
+def matches(expected, actual):
+    if isinstance(expected, dict):
+        if not isinstance(actual, dict):
+            return False
+        return all(k in actual and matches(v, actual[k]) for k, v in expected.items())
+    if isinstance(expected, list):
+        if not isinstance(actual, list) or len(expected) != len(actual):
+            return False
+        remaining = list(actual)
+        for e in expected:
+            for i, a in enumerate(remaining):
+                if matches(e, a):
+                    del remaining[i]
+                    break
+            else:
+                return False
+        return True
+    return expected == actual
+
+
+class Server:
+    def __init__(self, hemlock, root):
+        args = [hemlock, "lsp", "--stdio"]
+        self.proc = subprocess.Popen(args, stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                                     stderr=subprocess.DEVNULL, cwd=root)
+        self.buf = b""
+
+    def send(self, message):
+        self.send_body(json.dumps(message, ensure_ascii=False), message.get("method"))
+
+    def send_body(self, body, method):
+        body = body.encode("utf-8")
+        try:
+            self.proc.stdin.write(b"Content-Length: %d\r\n\r\n" % len(body) + body)
+            self.proc.stdin.flush()
+        except BrokenPipeError:
+            # The server stops reading once shutdown is answered
+            if method != "exit":
+                raise SessionError("server closed its input")
+
+    def _fill(self):
+        fd = self.proc.stdout.fileno()
+        ready, _, _ = select.select([fd], [], [], TIMEOUT)
+        if not ready:
+            raise SessionError("timed out waiting for the server")
+        chunk = os.read(fd, 65536)
+        if not chunk:
+            raise SessionError("server closed its output")
+        self.buf += chunk
+
+    def receive(self):
+        while b"\r\n\r\n" not in self.buf:
+            self._fill()
+        header, self.buf = self.buf.split(b"\r\n\r\n", 1)
+        length = None
+        for line in header.split(b"\r\n"):
+            name, _, value = line.partition(b":")
+            if name.strip().lower() == b"content-length":
+                length = int(value)
+        if length is None:
+            raise SessionError("message without Content-Length: %r" % header)
+        while len(self.buf) < length:
+            self._fill()
+        body, self.buf = self.buf[:length], self.buf[length:]
+        return json.loads(body.decode("utf-8"))
+
+    def close(self):
+        try:
+            self.proc.stdin.close()
+        except BrokenPipeError:
+            pass
+        try:
+            return self.proc.wait(timeout=TIMEOUT)
+        except subprocess.TimeoutExpired:
+            self.proc.kill()
+            self.proc.wait()
+            raise SessionError("server did not exit")
+
+
+def load_steps(path):
+    steps = []
+    with open(path, encoding="utf-8") as f:
+        for number, line in enumerate(f, 1):
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            try:
+                steps.append((number, json.loads(line)))
+            except ValueError as e:
+                raise SessionError("%s:%d: %s" % (path, number, e))
+    return steps
+
+
+def run(hemlock, session):
+    steps = load_steps(session)
+    root = os.path.dirname(os.path.abspath(session))
+    if steps and "workspace" in steps[0][1]:
+        root = os.path.join(root, steps.pop(0)[1]["workspace"])
+    root = os.path.realpath(root)
+    vars = {"$ROOTPATH": root, "$ROOT": "file://" + root}
+
+    server = Server(hemlock, root)
+    exited = False
+    try:
+        for number, step in steps:
+            if "send" in step:
+                message = dict(substitute(step["send"], vars), jsonrpc="2.0")
+                server.send(message)
+                exited = exited or message.get("method") == "exit"
+            elif "raw" in step:
+                server.send_body(substitute(step["raw"], vars), None)
+            elif "expect" in step:
+                expected = substitute(step["expect"], vars)
+                key = "id" if "id" in expected else "method"
+                while True:
+                    actual = server.receive()
+                    if actual.get(key) == expected.get(key):
+                        break
+                if not matches(expected, actual):
+                    raise SessionError("line %d: unexpected reply\n  expected: %s\n  got:      %s"
+                                       % (number, json.dumps(expected), json.dumps(actual)))
+            else:
+                raise SessionError("line %d: unknown step" % number)
+    finally:
+        status = server.close()
+    if exited and status != 0:
+        raise SessionError("server exited with status %d" % status)
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.stderr.write("usage: lsp_driver.py HEMLOCK SESSION\n")
+        return 2
+    try:
+        run(sys.argv[1], sys.argv[2])
+    except (SessionError, OSError) as e:
+        sys.stderr.write("%s\n" % e)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,60 @@
+#!/bin/bash
+# LSP Test Suite
+# Replays the JSON-RPC sessions in tests/lsp/sessions against `hemlock lsp`
+# (see lsp_driver.py for the session format). Each session runs twice with
+# its own cache directory: once building the workspace index from scratch,
+# once loading it from the cache the first run saved.
+
+HEMLOCK="$(pwd)/hemlock"
+TEST_DIR="tests/lsp"
+TMPDIR=$(mktemp -d)
+trap "rm -rf $TMPDIR" EXIT
+
+PASSED=0
+FAILED=0
+
+# Color codes
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+NC='\033[0m' # No Color
+
+pass() {
+    echo -e "${GREEN}PASS${NC}: $1"
+    ((PASSED++))
+}
+
+fail() {
+    echo -e "${RED}FAIL${NC}: $1"
+    echo "$2" | sed 's/^/  /'
+    ((FAILED++))
+}
+
+echo "=== Hemlock LSP Test Suite ==="
+echo ""
+
+if ! command -v python3 > /dev/null 2>&1; then
+    echo -e "${YELLOW}SKIP${NC}: python3 is needed to drive the sessions"
+    exit 0
+fi
+
+for SESSION in "$TEST_DIR"/sessions/*.jsonl; do
+    NAME=$(basename "$SESSION" .jsonl)
+    CACHE_HOME="$TMPDIR/$NAME"
+    for RUN in cold warm; do
+        if OUTPUT=$(XDG_CACHE_HOME="$CACHE_HOME" python3 "$TEST_DIR/lsp_driver.py" "$HEMLOCK" "$SESSION" 2>&1); then
+            pass "$NAME ($RUN cache)"
+        else
+            fail "$NAME ($RUN cache)" "$OUTPUT"
+        fi
+    done
+done
+
+echo ""
+echo "=== Results ==="
+echo -e "Passed: ${GREEN}$PASSED${NC}"
+echo -e "Failed: ${RED}$FAILED${NC}"
+
+if [ $FAILED -gt 0 ]; then
+    exit 1
+fi
@@ -26,6 +26,7 @@ FAILED=0
 SKIPPED=0
 INTERP_ONLY=0
 COMPILER_ONLY=0
+OPT_MISMATCH=0
 
 # Temp directory for compiled binaries
 TEMP_DIR=$(mktemp -d)
@@ -49,6 +50,7 @@ echo "    Hemlock Parity Test Suite"
 echo "======================================"
 echo ""
 echo "Testing interpreter ($HEMLOCK) vs compiler ($HEMLOCKC)"
+echo "Each backend also runs with --no-optimize and must print the same output"
 echo ""
 
 run_test() {
@@ -96,6 +98,25 @@ run_test() {
         fi
     fi
 
+    # The AST optimizer must not change behavior: run both backends again
+    # with it disabled and compare against the optimized runs
+    local unopt_interp
+    unopt_interp=$(timeout "$TEST_TIMEOUT" "$HEMLOCK" --no-optimize "$test_file" 2>&1)
+    if [ "$unopt_interp" != "$interp_output" ]; then
+        echo -e "${RED}✗${NC} $test_name (interpreter output changes with --no-optimize)"
+        ((OPT_MISMATCH++))
+    fi
+    if [ $compile_exit -eq 0 ]; then
+        local unopt_compiler=""
+        if timeout "$TEST_TIMEOUT" "$HEMLOCKC" --no-optimize "$test_file" -o "$TEMP_DIR/${test_name}_noopt" 2>/dev/null; then
+            unopt_compiler=$(timeout "$TEST_TIMEOUT" env LD_LIBRARY_PATH="$ROOT_DIR" "$TEMP_DIR/${test_name}_noopt" 2>&1)
+        fi
+        if [ "$unopt_compiler" != "$compiler_output" ]; then
+            echo -e "${RED}✗${NC} $test_name (compiler output changes with --no-optimize)"
+            ((OPT_MISMATCH++))
+        fi
+    fi
+
     # Compare results
     local interp_match=false
     local compiler_match=false
@@ -182,6 +203,7 @@ echo -e "${YELLOW}Interpreter Only:${NC} $INTERP_ONLY"
 echo -e "${YELLOW}Compiler Only:${NC}   $COMPILER_ONLY"
 echo -e "${RED}Both Failed:${NC}     $FAILED"
 echo -e "${BLUE}Skipped:${NC}         $SKIPPED"
+echo -e "${RED}Optimizer Diffs:${NC} $OPT_MISMATCH"
 echo "--------------------------------------"
 echo "Total:           $TOTAL"
 echo ""
@@ -194,7 +216,7 @@ fi
 echo "======================================"
 
 # Exit with error if any tests failed completely
-if [ $FAILED -gt 0 ]; then
+if [ $FAILED -gt 0 ] || [ $OPT_MISMATCH -gt 0 ]; then
     exit 1
 fi
 
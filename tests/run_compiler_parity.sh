@@ -135,6 +135,14 @@ if echo 'int main(){return 0;}' | gcc -x c - -lz -o /dev/null 2>/dev/null; then
     ZLIB_FLAG="-lz"
 fi
 
+# Check if OpenSSL libssl/libcrypto are available (HTTPS, hash digests)
+CRYPTO_FLAG=""
+if echo 'int main(){return 0;}' | gcc -x c - -lssl -lcrypto -o /dev/null 2>/dev/null; then
+    CRYPTO_FLAG="-lssl -lcrypto"
+elif echo 'int main(){return 0;}' | gcc -x c - -lcrypto -o /dev/null 2>/dev/null; then
+    CRYPTO_FLAG="-lcrypto"
+fi
+
 # Function to check if a test is expected to fail (error test)
 is_error_test() {
     local test_file="$1"
@@ -162,8 +170,8 @@ should_skip() {
 echo -e "${BLUE}Running parity tests...${NC}"
 echo ""
 
-# Find all test files (excluding compiler and parity directories)
-TEST_FILES=$(find "$TEST_DIR" -name "*.hml" -not -path "*/compiler/*" -not -path "*/parity/*" | sort)
+# Find all test files (excluding compiler and parity directories, and fixtures)
+TEST_FILES=$(find "$TEST_DIR" -name "*.hml" -not -path "*/compiler/*" -not -path "*/parity/*" -not -path "*/fixtures/*" | sort)
 
 CURRENT_CATEGORY=""
 CATEGORY_SKIP_REPORTED=""
@@ -252,7 +260,7 @@ for test_file in $TEST_FILES; do
     fi
 
     # Compile C to executable
-    gcc_output=$(gcc -o "$exe_file" "$c_file" -I./runtime/include -L. -lhemlock_runtime -lm -lpthread -lffi -ldl $ZLIB_FLAG 2>&1)
+    gcc_output=$(gcc -o "$exe_file" "$c_file" -I./runtime/include -L. -lhemlock_runtime -lm -lpthread -lffi -ldl $ZLIB_FLAG $CRYPTO_FLAG 2>&1)
     gcc_exit=$?
 
     if [ $gcc_exit -ne 0 ]; then
@@ -69,6 +69,14 @@ if echo 'int main(){return 0;}' | gcc -x c - -lwebsockets -o /dev/null 2>/dev/nu
     LWS_FLAG="-lwebsockets"
 fi
 
+# Check if OpenSSL libssl/libcrypto are available (HTTPS, hash digests)
+CRYPTO_FLAG=""
+if echo 'int main(){return 0;}' | gcc -x c - -lssl -lcrypto -o /dev/null 2>/dev/null; then
+    CRYPTO_FLAG="-lssl -lcrypto"
+elif echo 'int main(){return 0;}' | gcc -x c - -lcrypto -o /dev/null 2>/dev/null; then
+    CRYPTO_FLAG="-lcrypto"
+fi
+
 echo "======================================"
 echo "   Hemlock Full Parity Test Suite"
 echo "======================================"
@@ -212,7 +220,7 @@ run_test() {
 
     # Compile C to executable
     if ! gcc -o "$exe_file" "$c_file" -I"$ROOT_DIR/runtime/include" -L"$ROOT_DIR" \
-         -lhemlock_runtime -lm -lpthread -lffi -ldl $ZLIB_FLAG $LWS_FLAG 2>/dev/null; then
+         -lhemlock_runtime -lm -lpthread -lffi -ldl $ZLIB_FLAG $LWS_FLAG $CRYPTO_FLAG 2>/dev/null; then
         echo -e "${YELLOW}◐${NC} $test_name (gcc failed)"
         GCC_ERROR=$((GCC_ERROR + 1))
         rm -f "$c_file"
@@ -260,7 +268,7 @@ echo "Running tests..."
 echo ""
 
 current_category=""
-for test_file in $(find "$SCRIPT_DIR" -name "*.hml" -type f | sort); do
+for test_file in $(find "$SCRIPT_DIR" -name "*.hml" -type f -not -path "*/fixtures/*" | sort); do
     category=$(dirname "$test_file" | xargs basename)
 
     # Print category header when it changes